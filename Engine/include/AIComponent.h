@@ -11,6 +11,8 @@ namespace Sparky {
     // Forward declarations for behavior tree
     class BehaviorNode;
     class BehaviorTree;
+    class BehaviorTreeBatch;
+    class FlowField;
     
     enum class AIState {
         IDLE,
@@ -52,6 +54,7 @@ namespace Sparky {
 
         void update(float deltaTime) override;
         void render() override;
+        UpdatePhase getUpdatePhase() const override { return UpdatePhase::AI; }
 
         // AI state management
         void setState(AIState state);
@@ -70,6 +73,10 @@ namespace Sparky {
         void setMoveSpeed(float speed) { moveSpeed = speed; }
         float getMoveSpeed() const { return moveSpeed; }
         
+        // Shared flow field towards the target; chasing follows it when set
+        void setFlowField(const FlowField* field) { flowField = field; }
+        const FlowField* getFlowField() const { return flowField; }
+        
         // Detection properties
         void setDetectionRange(float range) { detectionRange = range; }
         float getDetectionRange() const { return detectionRange; }
@@ -88,6 +95,13 @@ namespace Sparky {
         void setBehaviorTree(std::unique_ptr<BehaviorTree> tree);
         BehaviorTree* getBehaviorTree() const { return behaviorTree.get(); }
         
+        // Compiled tree shared with other agents. Joins the batch with this
+        // component as the agent data; the batch's owner ticks every member at
+        // once, so update() leaves it alone.
+        void setBehaviorTreeBatch(BehaviorTreeBatch* batch);
+        BehaviorTreeBatch* getBehaviorTreeBatch() const { return behaviorTreeBatch; }
+        int getBehaviorTreeAgent() const { return behaviorTreeAgent; }
+        
         // Advanced AI properties
         void setAIProperties(const AIProperties& properties) { aiProperties = properties; }
         const AIProperties& getAIProperties() const { return aiProperties; }
@@ -132,6 +146,7 @@ namespace Sparky {
         
         // Movement properties
         float moveSpeed;
+        const FlowField* flowField;
         
         // Detection properties
         float detectionRange;
@@ -149,6 +164,8 @@ namespace Sparky {
         
         // Behavior tree
         std::unique_ptr<BehaviorTree> behaviorTree;
+        BehaviorTreeBatch* behaviorTreeBatch;
+        int behaviorTreeAgent;
         
         // Private helper methods
         void updateIdle(float deltaTime);
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace Sparky {
+    using AILODAgentId = int32_t;
+    constexpr AILODAgentId INVALID_AI_LOD_AGENT = -1;
+
+    enum class AILODLevel {
+        FULL,       // Every frame: in combat or close to the viewer
+        REDUCED,    // On screen or at middle distance
+        LOW         // Far away and out of view
+    };
+
+    // Called with the time since the agent's last update and its current level
+    using AILODUpdateFn = std::function<void(float deltaTime, AILODLevel level)>;
+
+    struct AILODSettings {
+        float fullDistance;         // Closer than this is FULL
+        float reducedDistance;      // Closer than this, or on screen, is REDUCED
+        float hysteresis;           // Extra fraction of a distance before an agent drops a level
+        int reducedInterval;        // Frames between REDUCED updates
+        int lowInterval;            // Frames between LOW updates
+        double frameBudgetMs;       // AI time per frame; 0 means unlimited
+
+        AILODSettings()
+            : fullDistance(25.0f), reducedDistance(80.0f), hysteresis(0.1f), reducedInterval(4), lowInterval(30),
+              frameBudgetMs(2.0) {}
+    };
+
+    struct AILODStats {
+        int agentsDue;              // Due this frame, including agents carried over
+        int agentsUpdated;
+        int agentsDeferred;         // Left for the next frame by the budget
+        int levelCounts[3];         // Agents per AILODLevel
+        double updateMs;
+    };
+
+    /**
+     * @brief Decides which AI agents think each frame
+     *
+     * Every agent gets a level from its distance to the viewer, whether it is
+     * inside the viewer's field of view and whether it is in combat, and each
+     * level has its own update interval. Within a level agents get a phase
+     * (the frame offset they update on) from the least loaded one when they
+     * enter it, so a level's agents are split evenly across its interval
+     * instead of all updating on the same frame. Dropping a level waits
+     * until the agent is a little past the threshold so agents on a boundary
+     * do not flip back and forth.
+     *
+     * update() runs the due agents, carried-over ones first and then by
+     * level, until the frame budget is spent. The rest are carried over to
+     * the next frame. An agent that is skipped keeps accumulating time, so
+     * its next update gets the full delta since the previous one. At least
+     * one agent runs every frame, which keeps the carried-over queue moving
+     * even with a budget that is too small.
+     *
+     * The update callbacks run on the calling thread. They may remove agents,
+     * their own included: a removed agent does not run again, and its slot
+     * is released once update() returns. They must not add agents.
+     */
+    class AILODScheduler {
+    public:
+        AILODScheduler();
+
+        // Constructor for dependency injection
+        explicit AILODScheduler(const AILODSettings& settings);
+
+        // Method to create a new AILODScheduler instance for dependency injection
+        static std::unique_ptr<AILODScheduler> create(const AILODSettings& settings = AILODSettings());
+
+        // Viewer (usually the player camera); forward must be normalized
+        void setViewer(const glm::vec3& position, const glm::vec3& forward, float fieldOfView);
+
+        AILODAgentId addAgent(const glm::vec3& position, AILODUpdateFn update);
+        void removeAgent(AILODAgentId agent);
+        void setAgentState(AILODAgentId agent, const glm::vec3& position, bool inCombat);
+        int getAgentCount() const { return m_agentCount; }
+
+        AILODLevel getAgentLevel(AILODAgentId agent) const { return m_level[agent]; }
+        int getInterval(AILODLevel level) const;
+
+        // Reassigns levels and runs the agents due this frame
+        void update(float deltaTime);
+
+        const AILODStats& getStats() const { return m_stats; }
+
+    private:
+        AILODSettings m_settings;
+        glm::vec3 m_viewerPosition;
+        glm::vec3 m_viewerForward;
+        float m_viewerCosHalfFov;
+        uint32_t m_frame;
+
+        // Agent slots
+        std::vector<glm::vec3> m_position;
+        std::vector<uint8_t> m_inCombat;
+        std::vector<AILODLevel> m_level;
+        std::vector<int> m_phase;
+        std::vector<float> m_pendingTime;
+        std::vector<uint8_t> m_deferred;
+        std::vector<AILODUpdateFn> m_update;
+        std::vector<uint8_t> m_active;
+        std::vector<int> m_freeSlots;
+        int m_agentCount;
+
+        // Agents per phase of each level
+        std::vector<int> m_phaseLoad[3];
+
+        std::vector<int> m_carried;     // Deferred agents, oldest first
+        std::vector<int> m_due[3];      // Due this frame per level
+        std::vector<int> m_order;
+        std::vector<int> m_pendingRemovals;    // Removed by callbacks, released after update()
+        bool m_updating;
+
+        AILODStats m_stats;
+
+        AILODLevel chooseLevel(int agent) const;
+        void assignLevel(int agent, AILODLevel level);
+        void releasePhase(int agent);
+        void releaseAgent(int agent);
+    };
+}
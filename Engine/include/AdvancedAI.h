@@ -1,9 +1,19 @@
 #pragma once
 
 #include "AIComponent.h"
+#include "AILODScheduler.h"
 #include "CharacterController.h"
+#include "CrowdAvoidance.h"
 #include "GameObject.h"
+#include "InfluenceMap.h"
+#include "NavGraph.h"
+#include "NavPolyMesh.h"
+#include "PathQueryService.h"
+#include "PerceptionSystem.h"
 #include <glm/glm.hpp>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
 #include <vector>
 #include <memory>
 #include <queue>
@@ -64,6 +74,7 @@ namespace Sparky {
         virtual void update(float deltaTime) override;
         virtual void destroy();
         virtual void render() override;
+        virtual UpdatePhase getUpdatePhase() const override { return UpdatePhase::AI; }
         
         // Perception settings
         void setVisionRange(float range);
@@ -80,6 +91,13 @@ namespace Sparky {
         std::vector<Stimulus> getStimuli() const;
         void clearStimuli();
         
+        // Shared batched sight. The owner is registered as an observer and
+        // canSee() answers from the system's last refresh, including line of
+        // sight; without it canSee() only checks range and field of view.
+        void setPerceptionSystem(PerceptionSystem* system, PerceptionPriority priority = PerceptionPriority::NORMAL);
+        PerceptionSystem* getPerceptionSystem() const { return m_perceptionSystem; }
+        void setPerceptionPriority(PerceptionPriority priority);
+        
         // Perception queries
         bool canSee(const GameObject* target) const;
         bool canHear(const GameObject* source) const;
@@ -91,6 +109,8 @@ namespace Sparky {
         float m_fieldOfView;
         std::vector<Stimulus> m_stimuli;
         GameObject* m_primaryThreat;
+        PerceptionSystem* m_perceptionSystem;
+        PerceptionObserverId m_observer;
     };
     
     /**
@@ -102,36 +122,65 @@ namespace Sparky {
         NavigationMesh();
         ~NavigationMesh();
         
-        // Navigation mesh management
+        // Navigation mesh management. Edits are not thread-safe; the search
+        // graph is rebuilt on the first query after an edit.
         void addNode(const NavNode& node);
         void addConnection(int from, int to);
         void removeNode(int nodeId);
         void clear();
         
-        // Pathfinding
+        // Dynamic obstacles: patches the search graph in place instead of rebuilding it.
+        // Safe while other threads run path queries; the patch waits for them.
+        void setNodeWalkable(int nodeId, bool walkable);
+        
+        // Polygon navmesh from NavMeshBuilder. Replaces the nodes with one per
+        // polygon, and findPath then string-pulls paths through the polygons.
+        // removeNode() and clear() drop it.
+        void setPolyMesh(std::shared_ptr<const NavPolyMesh> polyMesh);
+        const std::shared_ptr<const NavPolyMesh>& getPolyMesh() const { return m_polyMesh; }
+        
+        // Pathfinding; safe to call from several threads at once
         std::vector<glm::vec3> findPath(const glm::vec3& start, const glm::vec3& end) const;
         glm::vec3 getClosestNodePosition(const glm::vec3& position) const;
         
+        // Node-level queries; safe to call from several threads at once
+        int findNearestNode(const glm::vec3& position) const;
+        bool findNodePath(int startNode, int endNode, std::vector<int>& path) const;
+        int getNodeCount() const { return static_cast<int>(m_nodes.size()); }
+        const NavNode& getNode(int nodeId) const { return m_nodes[nodeId]; }
+        // Not locked: the graph must not be edited while the reference is in use
+        const NavGraph& getGraph() const;
+        
         // Navigation queries
         bool isPositionWalkable(const glm::vec3& position) const;
         float getDistance(int from, int to) const;
         
+        // Bumped by every edit, so cached paths can tell they are out of date
+        uint32_t getRevision() const { return m_revision; }
+        
     private:
         std::vector<NavNode> m_nodes;
         std::unordered_map<int, std::vector<int>> m_connections;
+        std::shared_ptr<const NavPolyMesh> m_polyMesh;
         
-        // A* pathfinding helper
-        struct Node {
-            int id;
-            float gCost;
-            float hCost;
-            int parent;
-            
-            float getFCost() const { return gCost + hCost; }
-        };
-        
-        std::vector<glm::vec3> reconstructPath(int start, int end, const std::unordered_map<int, int>& cameFrom) const;
-        float heuristic(int from, int to) const;
+        // Search structures derived from m_nodes and m_connections
+        mutable NavGraph m_graph;
+        mutable NavSpatialGrid m_spatialGrid;
+        mutable std::atomic<bool> m_graphDirty;
+        // Shared by queries, exclusive for rebuilds and walkability patches
+        mutable std::shared_mutex m_graphMutex;
+        uint32_t m_revision;
+        
+        void markGraphDirty() {
+            m_graphDirty.store(true, std::memory_order_release);
+            m_revision++;
+        }
+        void ensureGraph() const;
+        
+        // Callers hold m_graphMutex shared
+        int nearestNodeLocked(const glm::vec3& position) const;
+        bool nodePathLocked(int startNode, int endNode, std::vector<int>& path) const;
+        std::vector<glm::vec3> findPolyPath(const glm::vec3& start, const glm::vec3& end) const;
     };
     
     /**
@@ -141,7 +190,7 @@ namespace Sparky {
     class AdvancedAI : public AIComponent {
     public:
         AdvancedAI();
-        virtual ~AdvancedAI() = default;
+        virtual ~AdvancedAI();
         
         // Component interface
         virtual void initialize();
@@ -161,6 +210,22 @@ namespace Sparky {
         
         // Navigation
         void setNavigationMesh(NavigationMesh* navMesh);
+        // With a query service, moveTo() queues the search and the agent holds
+        // its current waypoint until the path arrives
+        void setPathQueryService(PathQueryService* service);
+        // With crowd avoidance, movement goes through the crowd's ORCA solve.
+        // The crowd is stepped once per frame by its owner; agents use the
+        // velocity from the previous step.
+        void setCrowdAvoidance(CrowdAvoidance* crowd, float radius = 0.5f);
+        // Cover and flank positions are scored on the influence map when one is set
+        void setInfluenceMap(const InfluenceMap* influenceMap) { m_influenceMap = influenceMap; }
+        
+        // With an LOD scheduler, update() only reports position and combat state
+        // and the scheduler runs the AI at the rate of its level. FULL runs
+        // everything, REDUCED skips group coordination and LOW only perceives
+        // and follows its path; perception refresh priority follows the level.
+        void setLODScheduler(AILODScheduler* scheduler);
+        AILODLevel getLODLevel() const { return m_lodLevel; }
         void moveTo(const glm::vec3& target);
         void stopMovement();
         
@@ -190,10 +255,20 @@ namespace Sparky {
         
         // Navigation
         NavigationMesh* m_navMesh;
+        PathQueryService* m_pathQueryService;
+        PathTicket m_pathTicket;
         std::vector<glm::vec3> m_currentPath;
         size_t m_currentPathIndex;
         glm::vec3 m_targetPosition;
         bool m_isMoving;
+        CrowdAvoidance* m_crowd;
+        CrowdAgentId m_crowdAgent;
+        const InfluenceMap* m_influenceMap;
+        
+        // Level of detail
+        AILODScheduler* m_lodScheduler;
+        AILODAgentId m_lodAgent;
+        AILODLevel m_lodLevel;
         
         // Combat state
         GameObject* m_currentTarget;
@@ -211,8 +286,10 @@ namespace Sparky {
         CharacterController* m_characterController;
         
         // Internal methods
+        void updateLOD(float deltaTime, AILODLevel level);
         void updatePerception(float deltaTime);
         void updateMovement(float deltaTime);
+        void steer(const glm::vec3& direction);
         void updateCombat(float deltaTime);
         void updateGroupBehavior(float deltaTime);
         
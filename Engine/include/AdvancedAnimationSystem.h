@@ -1,6 +1,9 @@
 #pragma once
 
 #include "Animation.h"
+#include "AnimationSampler.h"
+#include "IKSolvers.h"
+#include "PoseRuntime.h"
 #include "Component.h"
 #include "GameObject.h"
 #include <glm/glm.hpp>
@@ -15,6 +18,7 @@ namespace Sparky {
     class SkeletalAnimation;
     class AnimationController;
     class InverseKinematics;
+    class AnimationGraphBatch;
     
     // Animation blend modes
     enum class BlendMode {
@@ -50,6 +54,11 @@ namespace Sparky {
         
         // Animation evaluation
         void evaluate(float time, std::unordered_map<int, glm::mat4>& boneTransforms) const;
+        bool evaluateBone(int boneId, float time, glm::mat4& transform) const;
+        
+        // Animated bones in ascending order, and a counter bumped whenever keyframes change
+        const std::vector<int>& getBoneIds() const { return m_boneIds; }
+        uint32_t getRevision() const { return m_revision; }
         
         // Events
         void addEvent(const AnimationEvent& event);
@@ -59,10 +68,13 @@ namespace Sparky {
         std::string m_name;
         float m_duration;
         std::unordered_map<int, std::vector<Keyframe>> m_keyframes;
+        std::vector<int> m_boneIds;
+        uint32_t m_revision;
         std::vector<AnimationEvent> m_events;
         
         // Helper methods
         Keyframe interpolateKeyframes(const Keyframe& a, const Keyframe& b, float t) const;
+        glm::mat4 evaluateKeyframes(const std::vector<Keyframe>& keyframes, float time) const;
     };
     
     // Skeletal animation system
@@ -76,6 +88,7 @@ namespace Sparky {
         virtual void update(float deltaTime) override;
         virtual void destroy();
         virtual void render() override;
+        virtual UpdatePhase getUpdatePhase() const override { return UpdatePhase::ANIMATION; }
         
         // Skeleton structure
         struct Bone {
@@ -111,13 +124,47 @@ namespace Sparky {
         const std::string& getCurrentAnimation() const { return m_currentAnimation; }
         float getCurrentTime() const { return m_currentTime; }
         
-        // Bone transformations
+        // Bone transformations: skinning matrices (model transform * offset matrix)
         const glm::mat4& getBoneTransform(int boneId) const;
         std::vector<glm::mat4> getBoneTransforms() const;
         
+        // Model-space bone transforms and the local pose they were built from, indexed by bone id
+        const glm::mat4& getBoneModelTransform(int boneId) const;
+        const AnimationPose& getLocalPose() const { return m_pose; }
+        
+        // Skinning matrices indexed by bone id, as written to finalTransformation
+        const std::vector<glm::mat4>& getSkinningMatrices() const { return m_skinningMatrices; }
+        
         // Events
         void setAnimationEventCallback(const std::string& eventName, std::function<void()> callback);
         
+        // update() split in two for AnimationSystem. evaluate() advances playback and builds
+        // the pose without calling any callbacks, so different instances can evaluate on
+        // different threads; dispatchEvents() then calls the callbacks of the events it
+        // crossed and returns how many there were.
+        void evaluate(float deltaTime);
+        int dispatchEvents();
+        
+        // Set while an AnimationSystem drives this component; update() does nothing then
+        void setUpdatedBySystem(bool updatedBySystem) { m_updatedBySystem = updatedBySystem; }
+        bool isUpdatedBySystem() const { return m_updatedBySystem; }
+        
+        // Level of detail. With leaf bones skipped, bones without children keep their last
+        // local transform and only move with their parents. With pose history on, evaluate()
+        // keeps the pose it replaces, and interpolatePose() rebuilds the bone matrices part
+        // way (alpha) from that pose to the current one.
+        void setLeafBonesSkipped(bool skipped) { m_skipLeafBones = skipped; }
+        void setPoseHistory(bool enabled);
+        void interpolatePose(float alpha);
+        
+        // Bones sampled by the last evaluate(), 0 if nothing was playing
+        int getEvaluatedBoneCount() const { return m_evaluatedBones; }
+        
+        // The local pose the bone matrices were last built from (the interpolated one between
+        // updates), for post-processing such as IK, and a rebuild of the matrices after changing it
+        AnimationPose& getOutputPose() { return m_outputInterpolated ? m_interpolatedPose : m_pose; }
+        void rebuildBoneMatrices();
+        
     private:
         // Skeleton
         std::vector<Bone> m_bones;
@@ -134,6 +181,31 @@ namespace Sparky {
         bool m_isPaused;
         bool m_isLooping;
         
+        // Sampling state for the current clip; the pose is indexed by bone id
+        AnimationSampler m_sampler;
+        AnimationPose m_pose;
+        
+        // Target clip while blending, which plays from the start of the blend
+        AnimationSampler m_blendSampler;
+        AnimationPose m_blendPose;
+        float m_blendingTime;
+        
+        // Hierarchy, rebuilt when bones are added
+        AnimationSkeleton m_skeleton;
+        bool m_skeletonDirty;
+        std::vector<glm::mat4> m_modelTransforms;
+        std::vector<glm::mat4> m_skinningMatrices;
+        
+        // Level of detail: bones with children, and the poses interpolated between
+        std::vector<uint8_t> m_innerBones;
+        int m_innerBoneCount;
+        bool m_skipLeafBones;
+        bool m_poseHistory;
+        AnimationPose m_previousPose;
+        AnimationPose m_interpolatedPose;
+        bool m_outputInterpolated;
+        int m_evaluatedBones;
+        
         // Blending
         std::string m_blendingToAnimation;
         float m_blendTime;
@@ -141,12 +213,18 @@ namespace Sparky {
         BlendMode m_blendMode;
         bool m_isBlending;
         
-        // Events
+        // Events, and the ones crossed by the last evaluate() as indices into its clip's events
         std::unordered_map<std::string, std::function<void()>> m_eventCallbacks;
+        const AnimationClip* m_eventClip;
+        std::vector<int> m_firedEvents;
+        
+        bool m_updatedBySystem;
         
         // Internal methods
         void updateAnimation(float deltaTime);
         void updateBlending(float deltaTime);
+        void rebuildSkeleton();
+        void buildBoneMatrices(const AnimationPose& pose);
         glm::mat4 calculateBoneTransform(int boneId, float time, AnimationClip* clip) const;
         float getBlendFactor(float progress, BlendMode mode) const;
     };
@@ -162,6 +240,7 @@ namespace Sparky {
         virtual void update(float deltaTime) override;
         virtual void destroy();
         virtual void render() override;
+        virtual UpdatePhase getUpdatePhase() const override { return UpdatePhase::ANIMATION; }
         
         // IK chain
         struct IKJoint {
@@ -183,39 +262,67 @@ namespace Sparky {
         void removeIKChain(int chainId);
         IKChain* getIKChain(int chainId);
         
-        // IK solving
+        // IK solving. Chains list their joints root first, each the parent of the next, with
+        // the effector a child of the last; two-joint chains are solved in closed form and longer
+        // ones with FABRIK. Solving writes joint rotations into the skeletal animation's pose.
         void setTargetPosition(int chainId, const glm::vec3& target);
         void setPolePosition(int chainId, const glm::vec3& pole);
         void solveIK(int chainId);
         
-        // Constraints
+        // Solves every chain with a target as one batch, which is what update() does
+        void solveChains();
+        
+        void setSolverSettings(const IKSolverSettings& settings) { m_solverSettings = settings; }
+        const IKSolverSettings& getSolverSettings() const { return m_solverSettings; }
+        
+        // Chains, passes and remaining error of the last solve
+        const IKSolveStats& getStats() const { return m_stats; }
+        
+        // Constraints: bend limits in radians between the bone into a joint and the bone out of it
         void setJointConstraints(int chainId, int jointIndex, float minAngle, float maxAngle);
         
+        // Set while an AnimationSystem drives this component; update() does nothing then
+        void setUpdatedBySystem(bool updatedBySystem) { m_updatedBySystem = updatedBySystem; }
+        bool isUpdatedBySystem() const { return m_updatedBySystem; }
+        
     private:
         std::vector<IKChain> m_chains;
         std::unordered_map<int, glm::vec3> m_targets;
         std::unordered_map<int, glm::vec3> m_poles;
+        bool m_updatedBySystem;
         
         // Skeletal animation reference
         SkeletalAnimation* m_skeletalAnimation;
         
+        // Solver state; chains are gathered into model-space positions, solved together and
+        // written back as rotations
+        IKSolverSettings m_solverSettings;
+        IKSolveStats m_stats;
+        IKChainBatch m_batch;
+        std::vector<int> m_batchChains;
+        std::vector<glm::vec3> m_points;
+        std::vector<float> m_minBends;
+        std::vector<float> m_maxBends;
+        
         // Internal methods
-        void solveCCD(int chainId);
+        void gatherChain(int chainId);
+        void solveBatch();
+        void applyChain(int batchChain, AnimationPose& pose);
         glm::vec3 getBonePosition(int boneId) const;
-        void setBoneRotation(int boneId, const glm::quat& rotation);
     };
     
     // Advanced animation controller with state machine
     class AdvancedAnimationController : public Component {
     public:
         AdvancedAnimationController();
-        virtual ~AdvancedAnimationController() = default;
+        virtual ~AdvancedAnimationController();
         
         // Component interface
         virtual void initialize();
         virtual void update(float deltaTime) override;
         virtual void destroy();
         virtual void render() override;
+        virtual UpdatePhase getUpdatePhase() const override { return UpdatePhase::ANIMATION; }
         
         // Animation states
         struct AnimationState {
@@ -237,7 +344,7 @@ namespace Sparky {
         void addState(const AnimationState& state);
         void addTransition(const AnimationTransition& transition);
         void setState(const std::string& stateName);
-        const std::string& getCurrentState() const { return m_currentState; }
+        const std::string& getCurrentState() const;
         
         // Parameters
         void setFloatParameter(const std::string& name, float value);
@@ -267,6 +374,21 @@ namespace Sparky {
         void setBlendTree(const std::string& name, const BlendTreeNode& root);
         void useBlendTree(const std::string& name);
         
+        // Advances the state machine, which is what update() does
+        void advance(float deltaTime);
+        
+        // Set while an AnimationSystem drives this component; update() does nothing then
+        void setUpdatedBySystem(bool updatedBySystem) { m_updatedBySystem = updatedBySystem; }
+        bool isUpdatedBySystem() const { return m_updatedBySystem; }
+        
+        // Compiled graph shared with other controllers. Joins the batch with this
+        // component's skeletal animation; the batch's owner updates every member at
+        // once, so advance() leaves it alone. Parameter setters and getters and
+        // getCurrentState() go to the batch while joined.
+        void setAnimationGraphBatch(AnimationGraphBatch* batch);
+        AnimationGraphBatch* getAnimationGraphBatch() const { return m_graphBatch; }
+        int getAnimationGraphController() const { return m_graphController; }
+        
     private:
         // State machine
         std::vector<AnimationState> m_states;
@@ -289,6 +411,11 @@ namespace Sparky {
         
         // Skeletal animation reference
         SkeletalAnimation* m_skeletalAnimation;
+        bool m_updatedBySystem;
+        
+        // Compiled graph batch this controller belongs to
+        AnimationGraphBatch* m_graphBatch;
+        int m_graphController;
         
         // Internal methods
         void updateState(float deltaTime);
@@ -297,5 +424,6 @@ namespace Sparky {
         AnimationState* getState(const std::string& name);
         bool canTransition(const std::string& from, const std::string& to) const;
         void startTransition(const std::string& toState, float duration);
+        int findGraphParameter(const std::string& name) const;
     };
 }
\ No newline at end of file
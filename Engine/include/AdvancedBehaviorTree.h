@@ -9,6 +9,7 @@
 #pragma once
 
 #include "BehaviorTree.h"
+#include <glm/glm.hpp>
 #include <memory>
 #include <vector>
 #include <functional>
@@ -15,6 +15,11 @@ namespace Sparky {
         float scale[3];       // Scale at this keyframe (x, y, z)
     };
     
+    // Index of the last keyframe at or before time in a time-sorted array, or -1 if time is
+    // before the first one. hint is a previous result for the same array: playback that
+    // moves forward a few keyframes is found by stepping from it, anything else by binary search.
+    int findKeyframe(const Keyframe* keyframes, int count, float time, int hint = -1);
+    
     // Animation track for a single bone or object
     class AnimationTrack {
     public:
@@ -23,6 +28,8 @@ namespace Sparky {
         
         void addKeyframe(const Keyframe& keyframe);
         Keyframe getKeyframeAtTime(float time) const;
+        // Same as above, reusing and updating a caller-owned cursor (start it at 0)
+        Keyframe getKeyframeAtTime(float time, int& cursor) const;
         Keyframe interpolateKeyframes(const Keyframe& a, const Keyframe& b, float t) const;
         
         const std::string& getName() const { return name; }
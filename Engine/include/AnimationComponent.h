@@ -14,6 +14,8 @@ namespace Sparky {
         
         void update(float deltaTime) override;
         void render() override;
+        UpdatePhase getUpdatePhase() const override { return UpdatePhase::ANIMATION; }
+        bool supportsParallelUpdate() const override { return true; }
         
         // Animation management
         void addAnimation(std::unique_ptr<Animation> animation);
@@ -42,6 +44,7 @@ namespace Sparky {
     private:
         std::unordered_map<std::string, std::unique_ptr<Animation>> animations;
         Animation* currentAnimation;
+        int trackCursor; // Keyframe cursor into the current animation's first track
         std::unordered_map<std::string, float[16]> boneTransforms; // 4x4 matrices stored as arrays
         AnimationBlender blender;
     };
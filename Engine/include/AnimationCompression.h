@@ -0,0 +1,150 @@
+#pragma once
+
+#include "AnimationSampler.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Sparky {
+    class AnimationClip;
+
+    struct AnimationCompressionSettings {
+        float translationTolerance;     // Largest translation error a removed key may cause
+        float rotationTolerance;        // Largest rotation error in radians
+        float scaleTolerance;           // Largest scale error
+        float segmentDuration;          // Seconds of animation per segment
+        float shellDistance;            // Distance from each joint the error report measures at
+
+        AnimationCompressionSettings()
+            : translationTolerance(0.0005f), rotationTolerance(0.0005f), scaleTolerance(0.0005f),
+              segmentDuration(1.0f), shellDistance(0.1f) {}
+    };
+
+    // Largest errors of one bone over the clip, compared with the uncompressed clip
+    struct AnimationBoneError {
+        int boneId;
+        int parentId;
+        float translationError;         // Local
+        float rotationError;            // Local, radians
+        float scaleError;               // Local
+        float modelError;               // Model space at the joint's shell, so it includes every parent in the chain
+    };
+
+    struct AnimationCompressionReport {
+        std::vector<AnimationBoneError> bones;  // Indexed by bone id
+        int worstBone;                          // Largest model error, or -1
+        float maxModelError;
+        int originalKeys;
+        int storedKeys;
+        size_t originalBytes;
+        size_t compressedBytes;
+    };
+
+    /**
+     * @brief An AnimationClip in quantized, key-reduced, segmented form
+     *
+     * Each bone's translation, rotation and scale are separate channels.
+     * A channel that never moves beyond tolerance is stored once as a
+     * constant. Animated channels keep only the keys linear interpolation
+     * cannot rebuild within tolerance, with rotations packed as the
+     * smallest three quaternion components (15 bits each plus a 2 bit index)
+     * and translations and scales as 16 bit values in the channel's range.
+     *
+     * The clip is split into fixed-length segments. A segment stores every
+     * animated channel's keys for its time span back to back, each channel
+     * starting and ending with a key on the segment boundaries, so sampling
+     * decodes from one small contiguous block without looking at neighbours.
+     * Rotations interpolate with a normalized lerp, which the key reduction
+     * accounts for.
+     */
+    class CompressedAnimationClip {
+    public:
+        const std::string& getName() const { return m_name; }
+        float getDuration() const { return m_duration; }
+        int getSegmentCount() const { return static_cast<int>(m_segmentStart.size()); }
+        int getStoredKeyCount() const { return m_storedKeys; }
+
+        // Bytes held by the compressed data
+        size_t getMemoryUsage() const;
+
+        // Writes every animated bone at time into pose, like AnimationSampler::sample
+        void sample(float time, AnimationPose& pose) const;
+
+    private:
+        friend class AnimationCompressor;
+
+        enum ChannelType : uint8_t {
+            TRANSLATION,
+            ROTATION,
+            SCALE
+        };
+
+        struct Track {
+            int boneId;
+            int channels[3];            // Index into the segment channel table, or -1 when constant
+            glm::vec3 translation;      // Constant values
+            glm::quat rotation;
+            glm::vec3 scale;
+            glm::vec3 translationMin;   // Quantization ranges of animated translation and scale
+            glm::vec3 translationExtent;
+            glm::vec3 scaleMin;
+            glm::vec3 scaleExtent;
+        };
+
+        CompressedAnimationClip() : m_duration(0.0f), m_segmentDuration(1.0f), m_storedKeys(0), m_channelCount(0) {}
+
+        std::string m_name;
+        float m_duration;
+        float m_segmentDuration;
+        int m_storedKeys;
+        std::vector<Track> m_tracks;
+        int m_channelCount;
+
+        // Per segment: start and length in seconds; per segment and channel: offset of
+        // [key count, key times, key values] in m_data
+        std::vector<float> m_segmentStart;
+        std::vector<float> m_segmentLength;
+        std::vector<uint32_t> m_channelOffsets;
+        std::vector<uint16_t> m_data;
+
+        // Values of the key before segmentTime (0-1 through the segment); the next key's follow them
+        const uint16_t* findKeys(int segment, int channel, float segmentTime, float& t) const;
+    };
+
+    /**
+     * @brief Builds CompressedAnimationClips and measures their error
+     *
+     * compress() works per segment: every channel is sampled at the segment
+     * boundaries and at its own keys in between, keys that linear
+     * interpolation rebuilds within tolerance are removed greedily, and the
+     * rest are quantized. measureError() samples both clips at a fixed rate
+     * and reports local and model-space error per bone; the model-space
+     * error is taken at points a shell distance away from the joint along
+     * each axis, so rotation error on a leaf bone shows up too.
+     */
+    class AnimationCompressor {
+    public:
+        AnimationCompressor();
+
+        // Constructor for dependency injection
+        explicit AnimationCompressor(const AnimationCompressionSettings& settings);
+
+        // Method to create a new AnimationCompressor instance for dependency injection
+        static std::unique_ptr<AnimationCompressor> create(const AnimationCompressionSettings& settings = AnimationCompressionSettings());
+
+        std::unique_ptr<CompressedAnimationClip> compress(const AnimationClip& clip) const;
+
+        // parents holds each bone's parent id (or -1), indexed by bone id, in any order
+        AnimationCompressionReport measureError(const AnimationClip& original, const CompressedAnimationClip& compressed,
+                                                const std::vector<int>& parents, float sampleRate = 60.0f) const;
+
+        const AnimationCompressionSettings& getSettings() const { return m_settings; }
+
+    private:
+        AnimationCompressionSettings m_settings;
+    };
+}
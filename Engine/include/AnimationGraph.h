@@ -0,0 +1,271 @@
+#pragma once
+
+#include "AdvancedAnimationSystem.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Sparky {
+    class JobSystem;
+
+    // Every parameter is one float in a controller's parameter row: bools and
+    // triggers are 0 or 1, and ints are exact up to 2^24
+    enum class AnimationParameterType : uint8_t {
+        FLOAT,
+        INT,
+        BOOL,
+        TRIGGER         // Set by the game, cleared when a transition that reads it fires
+    };
+
+    // Transition conditions run on a small float stack
+    enum class AnimationConditionOp : uint8_t {
+        LOAD_PARAMETER,     // operand: parameter index
+        LOAD_CONSTANT,      // value
+        LOAD_STATE_TIME,    // Seconds spent in the current state, scaled by its speed
+        LESS,
+        LESS_EQUAL,
+        GREATER,
+        GREATER_EQUAL,
+        EQUAL,
+        NOT_EQUAL,
+        AND,
+        OR,
+        NOT
+    };
+
+    struct AnimationConditionInstruction {
+        AnimationConditionOp op;
+        uint32_t operand;
+        float value;
+    };
+
+    // Blend tree node flattened from AdvancedAnimationController::BlendTreeNode.
+    // Children of a node are contiguous; those of a 1D node are sorted by position.x.
+    struct CompiledBlendNode {
+        AdvancedAnimationController::BlendTreeNode::NodeType type;
+        uint32_t clip;              // CLIP nodes
+        uint32_t firstChild;
+        uint32_t childCount;
+        uint32_t parameterX;        // Blend nodes; 2D ones also use parameterY
+        uint32_t parameterY;
+        glm::vec2 position;         // Where this node sits in its parent's blend space
+    };
+
+    struct CompiledAnimationState {
+        uint32_t clip;              // A clip, or
+        uint32_t blendTree;         // the root blend node; the other is UINT32_MAX
+        float speed;
+        bool loop;
+        uint32_t transitionBegin;   // This state's transitions, in priority order
+        uint32_t transitionEnd;
+    };
+
+    struct CompiledAnimationTransition {
+        uint32_t target;
+        float duration;
+        uint32_t codeBegin;         // Empty code always passes
+        uint32_t codeEnd;
+        uint32_t triggerBegin;      // Triggers the condition reads, cleared when it fires
+        uint32_t triggerEnd;
+    };
+
+    /**
+     * @brief Immutable animation state machine with every name resolved
+     *
+     * Produced by AnimationGraphCompiler and shared by every controller that
+     * runs it. States, clips and parameters are indices, conditions are
+     * bytecode and blend trees are flat node arrays; the names are kept only
+     * for lookups while setting up.
+     */
+    class CompiledAnimationGraph {
+    public:
+        // -1 when there is no such name
+        int findParameter(const std::string& name) const;
+        int findState(const std::string& name) const;
+
+        int getParameterCount() const { return static_cast<int>(m_parameterTypes.size()); }
+        int getStateCount() const { return static_cast<int>(m_states.size()); }
+        int getClipCount() const { return static_cast<int>(m_clipNames.size()); }
+        int getDefaultState() const { return static_cast<int>(m_defaultState); }
+
+        AnimationParameterType getParameterType(int parameter) const { return m_parameterTypes[parameter]; }
+        const std::string& getStateName(int state) const { return m_stateNames[state]; }
+        const std::string& getClipName(int clip) const { return m_clipNames[clip]; }
+        const CompiledAnimationState& getState(int state) const { return m_states[state]; }
+        const std::vector<float>& getDefaultValues() const { return m_defaultValues; }
+
+    private:
+        friend class AnimationGraphCompiler;
+        friend class AnimationGraphBatch;
+
+        std::vector<AnimationParameterType> m_parameterTypes;
+        std::vector<float> m_defaultValues;
+        std::vector<CompiledAnimationState> m_states;
+        std::vector<CompiledAnimationTransition> m_transitions;
+        uint32_t m_anyStateBegin;       // Transitions from any state, tried first
+        uint32_t m_anyStateEnd;
+        std::vector<AnimationConditionInstruction> m_code;
+        std::vector<uint32_t> m_triggers;
+        std::vector<CompiledBlendNode> m_blendNodes;
+        uint32_t m_defaultState;
+
+        std::unordered_map<std::string, int> m_parameterIndex;
+        std::unordered_map<std::string, int> m_stateIndex;
+        std::vector<std::string> m_stateNames;
+        std::vector<std::string> m_clipNames;
+    };
+
+    /**
+     * @brief Builds a CompiledAnimationGraph
+     *
+     * Parameters and states are declared by name and transitions refer to
+     * them by name; compile() resolves everything to indices. Conditions
+     * are expressions over parameters, numbers, true, false and stateTime:
+     *
+     *     compiler.addParameter("speed", AnimationParameterType::FLOAT);
+     *     compiler.addParameter("jump", AnimationParameterType::TRIGGER);
+     *     compiler.addState("Idle", "idle");
+     *     compiler.addBlendTreeState("Move", locomotion);
+     *     compiler.addTransition("Idle", "Move", 0.2f, "speed > 0.1");
+     *     compiler.addAnyStateTransition("Jump", 0.1f, "jump && !(stateTime < 0.5)");
+     *
+     * with comparisons (< <= > >= == !=), !, && and || and parentheses.
+     * The first state added is the default unless setDefaultState() says
+     * otherwise. compile() logs an error and returns nullptr for unknown
+     * names or conditions that do not parse.
+     */
+    class AnimationGraphCompiler {
+    public:
+        AnimationGraphCompiler();
+
+        void addParameter(const std::string& name, AnimationParameterType type, float defaultValue = 0.0f);
+        void addState(const std::string& name, const std::string& clipName, bool loop = true, float speed = 1.0f);
+        void addBlendTreeState(const std::string& name, const AdvancedAnimationController::BlendTreeNode& root, float speed = 1.0f);
+        void setDefaultState(const std::string& name) { m_defaultState = name; }
+
+        // Transitions are tried in the order they were added
+        void addTransition(const std::string& from, const std::string& to, float duration, const std::string& condition = "");
+        void addAnyStateTransition(const std::string& to, float duration, const std::string& condition = "");
+
+        std::shared_ptr<const CompiledAnimationGraph> compile() const;
+
+    private:
+        struct ParameterDesc {
+            std::string name;
+            AnimationParameterType type;
+            float defaultValue;
+        };
+
+        struct StateDesc {
+            std::string name;
+            std::string clipName;
+            bool hasBlendTree;
+            AdvancedAnimationController::BlendTreeNode blendTree;
+            bool loop;
+            float speed;
+        };
+
+        struct TransitionDesc {
+            std::string from;       // Empty for any state
+            std::string to;
+            float duration;
+            std::string condition;
+        };
+
+        std::vector<ParameterDesc> m_parameters;
+        std::vector<StateDesc> m_states;
+        std::vector<TransitionDesc> m_transitions;
+        std::string m_defaultState;
+    };
+
+    /**
+     * @brief Runs one compiled graph for many controllers
+     *
+     * Each controller owns a row of parameters and a row of clip weights in
+     * flat arrays, plus its current state, the state it is blending to and
+     * how far along. update() walks the controllers in a tight loop, in
+     * batches on the JobSystem when one is set, and allocates nothing: a
+     * controller that is not blending runs its state's transition
+     * conditions (any-state ones first) and starts the first that passes,
+     * and then every controller's clip weights are rebuilt from its blend
+     * trees. A transition runs to the end once started.
+     *
+     * Weights cover every clip of the graph and sum to 1, for a pose
+     * blender to consume. Controllers added with a SkeletalAnimation also
+     * drive it, after the parallel part and on the calling thread: since it
+     * blends only two clips, it is cross-faded to the heaviest clip of the
+     * state being entered (or the current one) whenever that changes.
+     */
+    class AnimationGraphBatch {
+    public:
+        explicit AnimationGraphBatch(std::shared_ptr<const CompiledAnimationGraph> graph);
+
+        void setJobSystem(JobSystem* jobSystem) { m_jobSystem = jobSystem; }
+
+        // Slots of removed controllers are reused
+        int addController(SkeletalAnimation* animation = nullptr);
+        void removeController(int controller);
+        int getControllerCount() const { return m_controllerCount; }
+
+        // Parameters by index from CompiledAnimationGraph::findParameter()
+        void setFloat(int controller, int parameter, float value) { m_parameters[controller * m_parameterStride + parameter] = value; }
+        void setInt(int controller, int parameter, int value) { setFloat(controller, parameter, static_cast<float>(value)); }
+        void setBool(int controller, int parameter, bool value) { setFloat(controller, parameter, value ? 1.0f : 0.0f); }
+        void setTrigger(int controller, int parameter) { setFloat(controller, parameter, 1.0f); }
+        float getFloat(int controller, int parameter) const { return m_parameters[controller * m_parameterStride + parameter]; }
+        float* getParameters(int controller) { return &m_parameters[controller * m_parameterStride]; }
+
+        int getCurrentState(int controller) const { return m_current[controller]; }
+        int getNextState(int controller) const { return m_next[controller]; }  // -1 unless blending
+        float getStateTime(int controller) const { return m_stateTime[controller]; }
+        float getTransitionProgress(int controller) const;
+
+        // One weight per clip of the graph
+        const float* getClipWeights(int controller) const { return &m_weights[controller * m_weightStride]; }
+
+        // Back to the default state with default parameters
+        void resetController(int controller);
+
+        void update(float deltaTime);
+        void updateController(int controller, float deltaTime);
+
+        // Transitions started by the last update()
+        int getTransitionsStarted() const { return m_transitionsStarted; }
+
+        const std::shared_ptr<const CompiledAnimationGraph>& getGraph() const { return m_graph; }
+
+    private:
+        std::shared_ptr<const CompiledAnimationGraph> m_graph;
+        JobSystem* m_jobSystem;
+        uint32_t m_parameterStride;
+        uint32_t m_weightStride;
+
+        std::vector<float> m_parameters;
+        std::vector<float> m_weights;
+        std::vector<int> m_current;
+        std::vector<int> m_next;
+        std::vector<float> m_stateTime;
+        std::vector<float> m_nextStateTime;
+        std::vector<float> m_transitionTime;
+        std::vector<float> m_transitionDuration;
+        std::vector<uint8_t> m_started;         // Started a transition in the last update
+        std::vector<uint8_t> m_active;
+        std::vector<int> m_freeSlots;
+        int m_controllerCount;
+        int m_transitionsStarted;
+
+        // Driven animations and the clip each was last told to play
+        std::vector<SkeletalAnimation*> m_animations;
+        std::vector<int> m_playingClip;
+        std::vector<float> m_scratchWeights;
+
+        bool passes(const CompiledAnimationTransition& transition, const float* parameters, float stateTime) const;
+        void startTransition(int controller, uint32_t transition, float* parameters);
+        void addStateWeights(uint32_t state, float weight, const float* parameters, float* weights) const;
+        void addBlendWeights(uint32_t node, float weight, const float* parameters, float* weights) const;
+        void driveAnimation(int controller);
+    };
+}
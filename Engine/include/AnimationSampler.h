@@ -0,0 +1,74 @@
+#pragma once
+
+#include "Animation.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace Sparky {
+    class AnimationClip;
+
+    /**
+     * @brief Local transforms of a skeleton, indexed by bone id
+     *
+     * Translations, rotations and scales live in separate arrays sized once
+     * for the skeleton, so sampling writes straight into them instead of
+     * building a map per frame.
+     */
+    struct AnimationPose {
+        std::vector<glm::vec3> translations;
+        std::vector<glm::quat> rotations;
+        std::vector<glm::vec3> scales;
+
+        // Resizes to boneCount bones, all at the identity transform
+        void reset(int boneCount);
+        int getBoneCount() const { return static_cast<int>(translations.size()); }
+
+        // translation * rotation * scale, as AnimationClip::evaluate builds it
+        glm::mat4 getMatrix(int bone) const;
+    };
+
+    /**
+     * @brief Samples an AnimationClip into an AnimationPose with cached keyframe cursors
+     *
+     * Each sampler belongs to one playing instance and remembers, per track,
+     * the keyframe it used last. Playback moving forward finds the next
+     * keyframe by stepping from there, which is constant time per track on
+     * average no matter how long the clip is. Seeks and loop wraps fall back
+     * to a binary search.
+     *
+     * The track list is taken from the clip when it is bound and rebuilt if
+     * keyframes are added to the clip afterwards. Bones outside the pose are
+     * skipped, and bones the clip does not animate are left untouched.
+     */
+    class AnimationSampler {
+    public:
+        AnimationSampler();
+
+        // Binds a clip (or nullptr) and rewinds the cursors
+        void bind(const AnimationClip* clip);
+        const AnimationClip* getClip() const { return m_clip; }
+
+        // Writes every animated bone at time into pose. Time wraps at the clip duration.
+        void sample(float time, AnimationPose& pose);
+
+        // Same, but only bones whose boneMask entry is non-zero; the rest are left untouched
+        void sample(float time, AnimationPose& pose, const std::vector<uint8_t>& boneMask);
+
+        // Rewinds the cursors; the next sample does a full search
+        void resetCursors();
+
+    private:
+        const AnimationClip* m_clip;
+        uint32_t m_revision;
+
+        // Per track
+        std::vector<int> m_trackBone;
+        std::vector<const std::vector<Keyframe>*> m_trackKeyframes;
+        std::vector<int> m_cursor;
+
+        void rebuildTracks();
+        void sampleTracks(float time, AnimationPose& pose, const uint8_t* boneMask, int maskSize);
+    };
+}
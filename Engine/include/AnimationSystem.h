@@ -0,0 +1,176 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace Sparky {
+    class Camera;
+    class JobSystem;
+    class GameObject;
+    class SkeletalAnimation;
+    class AdvancedAnimationController;
+    class InverseKinematics;
+
+    using AnimatorId = int32_t;
+    constexpr AnimatorId INVALID_ANIMATOR = -1;
+
+    struct AnimationSystemSettings {
+        int batchSize;              // Animators per job
+
+        // Level of detail, applied once a camera is set
+        float rateDistances[3];     // Beyond each, the update rate halves again: 1/2, 1/4, 1/8
+        float leafBoneDistance;     // Beyond this, leaf bones are not sampled
+        float ikDistance;           // Beyond this, IK is off
+        float cullDistance;         // Beyond this, or outside the view, nothing is evaluated
+        float boundingRadius;       // Of a character, for the view test
+        float aspectRatio;          // Of the view; the camera gives the vertical field of view
+        float hysteresis;           // Extra fraction of a distance before an animator gets coarser
+
+        AnimationSystemSettings()
+            : batchSize(8), rateDistances{20.0f, 40.0f, 80.0f}, leafBoneDistance(30.0f), ikDistance(25.0f),
+              cullDistance(150.0f), boundingRadius(2.0f), aspectRatio(16.0f / 9.0f), hysteresis(0.1f) {}
+    };
+
+    struct AnimationSystemStats {
+        int animatorsUpdated;
+        int animatorsEvaluated;     // Sampled this frame
+        int animatorsInterpolated;  // Between updates at a reduced rate
+        int animatorsCulled;
+        int rateCounts[4];          // Animators at 1, 1/2, 1/4 and 1/8 rate, culled ones excluded
+        int ikSolved;               // Animators whose IK ran
+        int ikChains;
+        int ikIterations;           // FABRIK passes plus one per two-bone chain
+        int ikConverged;            // Chains that reached their target
+        int bonesEvaluated;         // Bones sampled this frame
+        int bonesTotal;             // Bones of every animator
+        int batches;                // Jobs the evaluation was split into
+        int eventsFired;
+        double controllerMs;        // State machines, on the calling thread
+        double evaluateMs;          // Sampling, blending, hierarchy and IK
+        double publishMs;           // Copying poses into the arena
+        double eventMs;
+        double updateMs;
+    };
+
+    /**
+     * @brief Updates every character's animation in parallel batches
+     *
+     * Animators are a SkeletalAnimation with an optional state machine
+     * controller and IK solver from the same character. While registered,
+     * their components stop updating themselves and update() drives them
+     * instead, in four steps:
+     *
+     * 1. Controllers advance on the calling thread, since their transition
+     *    conditions are arbitrary callbacks.
+     * 2. Sampling, blending, the hierarchy pass and then IK run for each
+     *    animator, split into batches across the JobSystem's workers.
+     * 3. Every animator's skinning matrices are copied into the back half of
+     *    a double-buffered pose arena, which then becomes the front.
+     * 4. Animation event callbacks run on the calling thread in animator id
+     *    order, so they fire in the same order however the work was split.
+     *
+     * Rendering reads the front arena, which update() does not touch until
+     * the swap, so it can upload last frame's poses while the next frame
+     * evaluates. Without a JobSystem, or one with no workers, everything runs
+     * on the calling thread with identical results.
+     *
+     * With a camera set, each animator's distance from it picks a level of
+     * detail. Further away the update rate halves at each rate distance, and
+     * in between updates the pose is interpolated from the previous update
+     * to the latest, which keeps motion smooth at the cost of lagging by up
+     * to one interval. Updates at a reduced rate are staggered by id so they
+     * spread evenly over frames. Leaf bones (fingers, toes, props) and IK
+     * switch off at their own distances, and animators beyond the cull
+     * distance or outside the view are not evaluated at all. Skipped time is
+     * carried to the next update, so clips stay in step and events crossed
+     * in between still fire, just late. Controllers always run.
+     *
+     * Components must be removed before they are destroyed. Event callbacks
+     * may add or remove animators.
+     */
+    class AnimationSystem {
+    public:
+        AnimationSystem();
+
+        // Constructor for dependency injection
+        explicit AnimationSystem(const AnimationSystemSettings& settings);
+
+        // Method to create a new AnimationSystem instance for dependency injection
+        static std::unique_ptr<AnimationSystem> create(const AnimationSystemSettings& settings = AnimationSystemSettings());
+
+        void setJobSystem(JobSystem* jobSystem) { m_jobSystem = jobSystem; }
+
+        // Viewer for level of detail; nullptr (the default) runs everything at full detail
+        void setCamera(const Camera* camera) { m_camera = camera; }
+
+        // controller and ik are optional and must act on animation's skeleton
+        AnimatorId addAnimator(SkeletalAnimation* animation, AdvancedAnimationController* controller = nullptr,
+                               InverseKinematics* ik = nullptr);
+
+        // Registers object's animation components; INVALID_ANIMATOR if it has no SkeletalAnimation
+        AnimatorId addAnimator(GameObject* object);
+        void removeAnimator(AnimatorId animator);
+        int getAnimatorCount() const { return m_animatorCount; }
+
+        // Frames between the animator's updates as of the last update(), 0 while culled
+        int getAnimatorInterval(AnimatorId animator) const;
+
+        void update(float deltaTime);
+
+        // Skinning matrices published by the last update(), indexed by bone id; nullptr for
+        // an animator that was not part of it
+        const glm::mat4* getSkinningMatrices(AnimatorId animator, int& boneCount) const;
+
+        // The whole front arena, for uploading in one go, and where each animator starts in it
+        const std::vector<glm::mat4>& getPoseArena() const { return m_arena[m_front]; }
+        int getPoseOffset(AnimatorId animator) const;
+
+        const AnimationSystemSettings& getSettings() const { return m_settings; }
+        const AnimationSystemStats& getStats() const { return m_stats; }
+
+    private:
+        AnimationSystemSettings m_settings;
+        JobSystem* m_jobSystem;
+        const Camera* m_camera;
+
+        // Animator slots; a free slot has no animation
+        std::vector<SkeletalAnimation*> m_animation;
+        std::vector<AdvancedAnimationController*> m_controller;
+        std::vector<InverseKinematics*> m_ik;
+        std::vector<int> m_freeSlots;
+        int m_animatorCount;
+
+        // Level of detail per slot. The interval is -1 until the first update, and the span
+        // is the frames from the last update to the next. After a level change the animator
+        // updates at once and holds that pose (snapped) instead of interpolating to it.
+        std::vector<int> m_interval;
+        std::vector<int> m_span;
+        std::vector<int> m_sinceUpdate;
+        std::vector<float> m_pendingTime;
+        std::vector<uint8_t> m_snapped;
+        std::vector<uint8_t> m_ikActive;
+
+        // This frame's work per slot
+        std::vector<uint8_t> m_action;
+        std::vector<float> m_stepTime;
+        std::vector<float> m_alpha;
+
+        // Slots updated this frame, in id order
+        std::vector<int> m_batch;
+
+        // Pose arena halves, with each slot's offset (-1 when absent) and bone count
+        std::vector<glm::mat4> m_arena[2];
+        std::vector<int> m_offset[2];
+        std::vector<int> m_boneCount[2];
+        int m_front;
+
+        AnimationSystemStats m_stats;
+
+        // Runs body over [0, count) in batches; returns the number of batches
+        int runBatches(size_t count, const std::function<void(size_t, size_t)>& body);
+        void chooseDetail(int slot, float deltaTime, float viewHalfAngle);
+    };
+}
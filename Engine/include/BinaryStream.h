@@ -0,0 +1,137 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace Sparky {
+    /**
+     * @brief Compact binary serialization helpers
+     *
+     * Values are written in host byte order, which is little-endian on every
+     * platform the engine targets. Readers are bounds-checked: a failed read
+     * leaves the value untouched, returns false and latches hasError().
+     */
+    class BinaryWriter {
+    public:
+        BinaryWriter() = default;
+
+        void writeU8(uint8_t value) { writeRaw(&value, sizeof(value)); }
+        void writeU16(uint16_t value) { writeRaw(&value, sizeof(value)); }
+        void writeU32(uint32_t value) { writeRaw(&value, sizeof(value)); }
+        void writeU64(uint64_t value) { writeRaw(&value, sizeof(value)); }
+        void writeI32(int32_t value) { writeRaw(&value, sizeof(value)); }
+        void writeFloat(float value) { writeRaw(&value, sizeof(value)); }
+        void writeBool(bool value) { writeU8(value ? 1 : 0); }
+        void writeVec3(const glm::vec3& value) { writeFloat(value.x); writeFloat(value.y); writeFloat(value.z); }
+
+        // Length-prefixed (u32) string
+        void writeString(const std::string& value) {
+            writeU32(static_cast<uint32_t>(value.size()));
+            writeRaw(value.data(), value.size());
+        }
+
+        void writeBytes(const void* data, size_t size) { writeRaw(data, size); }
+
+        // Reserve a u32 now and fill it in later (e.g. a block size)
+        size_t reserveU32() {
+            size_t position = m_buffer.size();
+            writeU32(0);
+            return position;
+        }
+        void patchU32(size_t position, uint32_t value) {
+            std::memcpy(m_buffer.data() + position, &value, sizeof(value));
+        }
+
+        size_t size() const { return m_buffer.size(); }
+        const std::vector<char>& getBuffer() const { return m_buffer; }
+        std::vector<char> takeBuffer() { return std::move(m_buffer); }
+        void clear() { m_buffer.clear(); }
+
+    private:
+        std::vector<char> m_buffer;
+
+        void writeRaw(const void* data, size_t size) {
+            const char* bytes = static_cast<const char*>(data);
+            m_buffer.insert(m_buffer.end(), bytes, bytes + size);
+        }
+    };
+
+    class BinaryReader {
+    public:
+        BinaryReader(const char* data, size_t size) : m_data(data), m_size(size), m_position(0), m_error(false) {}
+        explicit BinaryReader(const std::vector<char>& buffer)
+            : m_data(buffer.data()), m_size(buffer.size()), m_position(0), m_error(false) {}
+
+        bool readU8(uint8_t& value) { return readRaw(&value, sizeof(value)); }
+        bool readU16(uint16_t& value) { return readRaw(&value, sizeof(value)); }
+        bool readU32(uint32_t& value) { return readRaw(&value, sizeof(value)); }
+        bool readU64(uint64_t& value) { return readRaw(&value, sizeof(value)); }
+        bool readI32(int32_t& value) { return readRaw(&value, sizeof(value)); }
+        bool readFloat(float& value) { return readRaw(&value, sizeof(value)); }
+
+        bool readBool(bool& value) {
+            uint8_t byte = 0;
+            if (!readU8(byte)) return false;
+            value = byte != 0;
+            return true;
+        }
+
+        bool readVec3(glm::vec3& value) {
+            glm::vec3 result;
+            if (!readFloat(result.x) || !readFloat(result.y) || !readFloat(result.z)) return false;
+            value = result;
+            return true;
+        }
+
+        bool readString(std::string& value) {
+            uint32_t length = 0;
+            if (!readU32(length) || !canRead(length)) return fail();
+            value.assign(m_data + m_position, length);
+            m_position += length;
+            return true;
+        }
+
+        bool readBytes(void* data, size_t size) { return readRaw(data, size); }
+
+        // Pointer to the next size bytes without copying; nullptr if out of range
+        const char* view(size_t size) {
+            if (!canRead(size)) {
+                fail();
+                return nullptr;
+            }
+            const char* result = m_data + m_position;
+            m_position += size;
+            return result;
+        }
+
+        bool skip(size_t size) {
+            if (!canRead(size)) return fail();
+            m_position += size;
+            return true;
+        }
+
+        size_t position() const { return m_position; }
+        size_t remaining() const { return m_size - m_position; }
+        bool hasError() const { return m_error; }
+
+    private:
+        const char* m_data;
+        size_t m_size;
+        size_t m_position;
+        bool m_error;
+
+        bool canRead(size_t size) const { return !m_error && size <= m_size - m_position; }
+        bool fail() { m_error = true; return false; }
+
+        bool readRaw(void* data, size_t size) {
+            if (!canRead(size)) return fail();
+            std::memcpy(data, m_data + m_position, size);
+            m_position += size;
+            return true;
+        }
+    };
+}
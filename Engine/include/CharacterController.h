@@ -27,6 +27,8 @@ namespace Sparky {
         virtual void update(float deltaTime) override;
         virtual void destroy();
         virtual void render() override;
+        virtual UpdatePhase getUpdatePhase() const override { return UpdatePhase::PHYSICS; }
+        virtual bool supportsParallelUpdate() const override { return true; }
 
         // Movement controls
         void move(const glm::vec3& direction);
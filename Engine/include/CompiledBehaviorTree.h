@@ -0,0 +1,294 @@
+#pragma once
+
+#include "BehaviorTree.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Sparky {
+    class JobSystem;
+
+    enum class BlackboardType : uint8_t {
+        FLOAT,
+        INT,
+        BOOL,
+        VECTOR3
+    };
+
+    // Same meaning as ParallelNode::Policy
+    enum class ParallelPolicy : uint8_t {
+        REQUIRE_ONE,    // Succeeds if one child succeeds, fails if all fail
+        REQUIRE_ALL     // Succeeds if all children succeed, fails if one fails
+    };
+
+    // Interned blackboard entry: a word offset into each agent's buffer
+    struct BlackboardKey {
+        uint32_t offset;
+        BlackboardType type;
+
+        BlackboardKey() : offset(UINT32_MAX), type(BlackboardType::FLOAT) {}
+        BlackboardKey(uint32_t offset, BlackboardType type) : offset(offset), type(type) {}
+        bool isValid() const { return offset != UINT32_MAX; }
+    };
+
+    /**
+     * @brief Maps blackboard key names to slots in a flat buffer
+     *
+     * Names are looked up once, when a tree is compiled or a system starts,
+     * and every read afterwards is an array index. Floats, ints and bools
+     * take one 32-bit word and vectors three.
+     */
+    class BlackboardLayout {
+    public:
+        BlackboardLayout();
+
+        // Returns the existing key when the name is already declared with the same type
+        BlackboardKey declare(const std::string& name, BlackboardType type);
+        BlackboardKey find(const std::string& name) const;
+        uint32_t getWordCount() const { return m_wordCount; }
+
+    private:
+        std::unordered_map<std::string, BlackboardKey> m_keys;
+        uint32_t m_wordCount;
+    };
+
+    // Typed view of one agent's blackboard words. Keys are not checked
+    // against the type of the accessor.
+    class FlatBlackboard {
+    public:
+        explicit FlatBlackboard(uint32_t* words) : m_words(words) {}
+
+        float getFloat(BlackboardKey key) const { return read<float>(key.offset); }
+        int getInt(BlackboardKey key) const { return read<int32_t>(key.offset); }
+        bool getBool(BlackboardKey key) const { return m_words[key.offset] != 0; }
+        glm::vec3 getVector3(BlackboardKey key) const {
+            return glm::vec3(read<float>(key.offset), read<float>(key.offset + 1), read<float>(key.offset + 2));
+        }
+
+        void setFloat(BlackboardKey key, float value) { write(key.offset, value); }
+        void setInt(BlackboardKey key, int value) { write(key.offset, static_cast<int32_t>(value)); }
+        void setBool(BlackboardKey key, bool value) { m_words[key.offset] = value ? 1u : 0u; }
+        void setVector3(BlackboardKey key, const glm::vec3& value) {
+            write(key.offset, value.x);
+            write(key.offset + 1, value.y);
+            write(key.offset + 2, value.z);
+        }
+
+    private:
+        uint32_t* m_words;
+
+        template <typename T>
+        T read(uint32_t offset) const {
+            T value;
+            std::memcpy(&value, &m_words[offset], sizeof(T));
+            return value;
+        }
+
+        template <typename T>
+        void write(uint32_t offset, T value) {
+            std::memcpy(&m_words[offset], &value, sizeof(T));
+        }
+    };
+
+    struct BehaviorTaskContext {
+        FlatBlackboard blackboard;
+        void* agentData;        // Passed to BehaviorTreeBatch::addAgent()
+        void* taskData;         // Passed to BehaviorTreeCompiler::registerTask()
+        float deltaTime;
+        int agent;
+    };
+
+    // Leaf tasks are plain functions; a batch may call them from several threads
+    // at once, for different agents.
+    using BehaviorTaskFn = NodeStatus (*)(BehaviorTaskContext& context);
+
+    enum class CompiledNodeType : uint8_t {
+        SEQUENCE,
+        SELECTOR,
+        REACTIVE_SELECTOR,  // Re-checks earlier children while a later one runs
+        PARALLEL,
+        INVERTER,
+        SUCCEEDER,
+        REPEATER,
+        TIMER,
+        TASK,
+        CHECK_BOOL,
+        CHECK_FLOAT_LESS,
+        CHECK_FLOAT_GREATER,
+        SET_BOOL
+    };
+
+    // One node of a flattened tree. Children follow their parent directly and
+    // a subtree spans [index, end), so the next sibling of a node is at end.
+    struct CompiledBehaviorNode {
+        CompiledNodeType type;
+        uint8_t flags;          // Parallel policies or the bool operand
+        uint16_t childCount;
+        uint32_t end;
+        uint32_t parent;
+        uint32_t state;         // First per-agent state word
+        uint32_t operand;       // Task index, blackboard offset or repeat limit
+        float value;            // Timer duration or comparison constant
+    };
+
+    /**
+     * @brief Immutable flattened behavior tree
+     *
+     * Produced by BehaviorTreeCompiler and shared by every agent that runs
+     * it; agents keep their progress and blackboards in a BehaviorTreeBatch.
+     */
+    class CompiledBehaviorTree {
+    public:
+        struct Task {
+            BehaviorTaskFn function;
+            void* userData;
+        };
+
+        const std::vector<CompiledBehaviorNode>& getNodes() const { return m_nodes; }
+        const BlackboardLayout& getLayout() const { return m_layout; }
+        uint32_t getStateWordCount() const { return m_stateWords; }
+        uint32_t getMaxDepth() const { return m_maxDepth; }
+
+    private:
+        friend class BehaviorTreeCompiler;
+        friend class BehaviorTreeBatch;
+
+        std::vector<CompiledBehaviorNode> m_nodes;
+        std::vector<Task> m_tasks;
+        BlackboardLayout m_layout;
+        uint32_t m_stateWords;
+        uint32_t m_maxDepth;
+    };
+
+    /**
+     * @brief Builds a CompiledBehaviorTree
+     *
+     * Composites and decorators are opened by their method and closed with
+     * end(); leaves are added in between. Nodes are appended in depth-first
+     * order as they are declared, so compile() only has to validate the
+     * shape, resolve task names and lay out per-agent state:
+     *
+     *     compiler.reactiveSelector()
+     *                 .sequence().checkBool("enemyVisible").task("Attack").end()
+     *                 .task("Patrol")
+     *             .end();
+     *
+     * compile() logs an error and returns nullptr for malformed trees.
+     */
+    class BehaviorTreeCompiler {
+    public:
+        BehaviorTreeCompiler();
+
+        void registerTask(const std::string& name, BehaviorTaskFn function, void* userData = nullptr);
+        BlackboardKey declareKey(const std::string& name, BlackboardType type);
+
+        // Composites and decorators
+        BehaviorTreeCompiler& sequence();
+        BehaviorTreeCompiler& selector();
+        BehaviorTreeCompiler& reactiveSelector();
+        BehaviorTreeCompiler& parallel(ParallelPolicy successPolicy = ParallelPolicy::REQUIRE_ONE,
+                                       ParallelPolicy failurePolicy = ParallelPolicy::REQUIRE_ONE);
+        BehaviorTreeCompiler& inverter();
+        BehaviorTreeCompiler& succeeder();
+        BehaviorTreeCompiler& repeater(int limit = -1); // -1 means infinite
+        BehaviorTreeCompiler& timer(float duration);
+        BehaviorTreeCompiler& end();
+
+        // Leaves
+        BehaviorTreeCompiler& task(const std::string& name);
+        BehaviorTreeCompiler& checkBool(const std::string& key, bool expected = true);
+        BehaviorTreeCompiler& checkFloatLess(const std::string& key, float value);
+        BehaviorTreeCompiler& checkFloatGreater(const std::string& key, float value);
+        BehaviorTreeCompiler& setBool(const std::string& key, bool value);
+
+        std::shared_ptr<const CompiledBehaviorTree> compile() const;
+
+    private:
+        std::vector<CompiledBehaviorNode> m_nodes;
+        std::vector<std::string> m_taskNames;       // Per TASK node, by operand
+        std::vector<uint32_t> m_open;
+        std::vector<std::string> m_taskRegistryNames;
+        std::vector<CompiledBehaviorTree::Task> m_taskRegistry;
+        BlackboardLayout m_layout;
+        std::string m_error;
+
+        BehaviorTreeCompiler& push(CompiledNodeType type, bool opens);
+        BehaviorTreeCompiler& pushKeyLeaf(CompiledNodeType type, const std::string& key, BlackboardType keyType);
+    };
+
+    /**
+     * @brief Runs one compiled tree for many agents
+     *
+     * Each agent owns a row of state words (where it is running, repeat
+     * counts, timers, parallel child progress) and a row of blackboard words,
+     * both in flat arrays. tick() walks the agents in a tight loop, in
+     * batches on the JobSystem when one is set.
+     *
+     * A tick that returns RUNNING remembers the node that is running. The
+     * next tick resumes there and walks up its parents, so earlier siblings
+     * are not re-evaluated from the root. Two things are re-checked on the
+     * way: reactive selectors on that path try their higher-priority
+     * children first and switch branches when one of them no longer fails,
+     * and blackboard checks (checkBool, checkFloat*) ahead of the running
+     * child in a sequence fail the sequence once they stop holding. Tasks
+     * ahead of it are never re-run. Inside a parallel node each running
+     * child keeps its own resume point.
+     */
+    class BehaviorTreeBatch {
+    public:
+        explicit BehaviorTreeBatch(std::shared_ptr<const CompiledBehaviorTree> tree);
+
+        void setJobSystem(JobSystem* jobSystem) { m_jobSystem = jobSystem; }
+
+        // Slots of removed agents are reused
+        int addAgent(void* agentData = nullptr);
+        void removeAgent(int agent);
+        int getAgentCount() const { return m_agentCount; }
+
+        FlatBlackboard getBlackboard(int agent) { return FlatBlackboard(&m_blackboards[agent * m_blackboardStride]); }
+        NodeStatus getLastStatus(int agent) const { return m_lastStatus[agent]; }
+
+        // Restarts the agent from the root on its next tick
+        void resetAgent(int agent);
+
+        void tick(float deltaTime);
+        void tickAgent(int agent, float deltaTime);
+
+        const std::shared_ptr<const CompiledBehaviorTree>& getTree() const { return m_tree; }
+
+    private:
+        struct Frame {
+            int agent;
+            float deltaTime;
+            uint32_t* state;
+            uint32_t* blackboard;
+            uint32_t resume;
+        };
+
+        std::shared_ptr<const CompiledBehaviorTree> m_tree;
+        const CompiledBehaviorNode* m_nodes;
+        JobSystem* m_jobSystem;
+        uint32_t m_stateStride;         // Resume word plus the tree's state words
+        uint32_t m_blackboardStride;
+        std::vector<uint32_t> m_states;
+        std::vector<uint32_t> m_blackboards;
+        std::vector<void*> m_agentData;
+        std::vector<NodeStatus> m_lastStatus;
+        std::vector<uint8_t> m_active;
+        std::vector<int> m_freeSlots;
+        int m_agentCount;
+
+        NodeStatus enter(uint32_t node, Frame& frame) const;
+        NodeStatus resume(uint32_t node, uint32_t stop, Frame& frame) const;
+        NodeStatus continueNode(uint32_t node, Frame& frame) const;
+        NodeStatus climb(uint32_t parent, uint32_t child, NodeStatus status, Frame& frame) const;
+        NodeStatus runLeaf(uint32_t node, Frame& frame) const;
+        NodeStatus repeatStep(uint32_t node, NodeStatus childStatus, Frame& frame) const;
+        NodeStatus timerStep(uint32_t node, NodeStatus childStatus, Frame& frame) const;
+        NodeStatus parallelStep(uint32_t node, Frame& frame) const;
+    };
+}
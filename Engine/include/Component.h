@@ -3,6 +3,17 @@
 namespace Sparky {
     class GameObject;
 
+    // Frame phases used by the scene update scheduler, in execution order
+    enum class UpdatePhase {
+        INPUT,
+        AI,
+        ANIMATION,
+        PHYSICS,
+        LATE_UPDATE,
+        RENDER_PREP,
+        COUNT
+    };
+
     class Component {
     public:
         Component();
@@ -11,10 +22,21 @@ namespace Sparky {
         virtual void update(float deltaTime) = 0;
         virtual void render() = 0;
 
+        // Scheduling hints. Components default to the serial late-update phase,
+        // which matches the classic per-object update order.
+        virtual UpdatePhase getUpdatePhase() const { return UpdatePhase::LATE_UPDATE; }
+
+        // Return true only if update() touches nothing but this component and its owner's transform,
+        // so instances of the same type can be updated concurrently.
+        virtual bool supportsParallelUpdate() const { return false; }
+
         void setOwner(GameObject* owner);
         GameObject* getOwner() const;
 
     protected:
         GameObject* owner;
+
+        // Call after changing state that snapshots persist
+        void markOwnerDirty();
     };
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <unordered_map>
 #include <any>
 #include <memory>
+#include <vector>
 
 namespace Sparky {
     class Config {
@@ -41,5 +42,7 @@ namespace Sparky {
     private:
         std::unordered_map<std::string, std::any> configMap;
         std::string configFile;
+
+        bool readArchive(const std::vector<char>& data);
     };
 }
\ No newline at end of file
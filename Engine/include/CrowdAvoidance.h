@@ -0,0 +1,134 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Sparky {
+    class JobSystem;
+
+    using CrowdAgentId = int32_t;
+    constexpr CrowdAgentId INVALID_CROWD_AGENT = -1;
+
+    struct CrowdAvoidanceSettings {
+        float neighborRadius;   // Agents further apart than this are ignored
+        int maxNeighbors;       // Closest neighbours considered per agent
+        float timeHorizon;      // Seconds ahead in which collisions are avoided
+
+        CrowdAvoidanceSettings() : neighborRadius(6.0f), maxNeighbors(10), timeHorizon(2.0f) {}
+    };
+
+    struct CrowdAvoidanceStats {
+        int agentCount;
+        int gridCells;
+        size_t neighborPairs;   // Neighbours considered in the last step
+        int fallbackSolves;     // Agents whose constraints were infeasible (dense crowds)
+        double gridMs;
+        double solveMs;
+    };
+
+    /**
+     * @brief ORCA local avoidance for crowds
+     *
+     * Agents are discs moving in the XZ plane. Each step() buckets them into a
+     * uniform grid, then for every agent derives one half-plane of allowed
+     * velocities per nearby agent (optimal reciprocal collision avoidance:
+     * each side takes half of the correction) and picks the velocity closest
+     * to the preferred one with a small 2D linear program. When the
+     * constraints cannot all be met, the velocity that violates them least is
+     * used instead.
+     *
+     * Agent data is kept as separate arrays per field, and the solve runs on
+     * the JobSystem in batches of agents. Ids are slot indices that stay
+     * valid until removeAgent().
+     *
+     * Per-agent setters may be called from different threads for different
+     * agents, but not while step() runs or agents are added and removed.
+     */
+    class CrowdAvoidance {
+    public:
+        CrowdAvoidance();
+
+        // Constructor for dependency injection
+        explicit CrowdAvoidance(const CrowdAvoidanceSettings& settings);
+
+        // Method to create a new CrowdAvoidance instance for dependency injection
+        static std::unique_ptr<CrowdAvoidance> create(const CrowdAvoidanceSettings& settings = CrowdAvoidanceSettings());
+
+        void setJobSystem(JobSystem* jobSystem) { m_jobSystem = jobSystem; }
+
+        // Agents
+        CrowdAgentId addAgent(const glm::vec3& position, float radius, float maxSpeed);
+        void removeAgent(CrowdAgentId agent);
+        int getAgentCount() const { return m_agentCount; }
+
+        // Current state and goal velocity, usually once per frame before step()
+        void setAgentState(CrowdAgentId agent, const glm::vec3& position, const glm::vec3& velocity);
+        void setPreferredVelocity(CrowdAgentId agent, const glm::vec3& velocity);
+        void setMaxSpeed(CrowdAgentId agent, float maxSpeed);
+
+        // Computes every agent's avoidance velocity
+        void step(float deltaTime);
+        // Result of the last step(); zero before the first
+        glm::vec3 getAvoidanceVelocity(CrowdAgentId agent) const;
+
+        // Neighbours of one agent as the solver sees them, closest first
+        void findNeighbors(CrowdAgentId agent, std::vector<CrowdAgentId>& neighbors) const;
+
+        const CrowdAvoidanceStats& getStats() const { return m_stats; }
+
+    private:
+        struct Line {
+            glm::vec2 point;
+            glm::vec2 direction;
+        };
+
+        struct Neighbor {
+            float distanceSq;
+            int agent;
+        };
+
+        CrowdAvoidanceSettings m_settings;
+        JobSystem* m_jobSystem;
+
+        // Agent slots
+        std::vector<float> m_positionX;
+        std::vector<float> m_positionZ;
+        std::vector<float> m_velocityX;
+        std::vector<float> m_velocityZ;
+        std::vector<float> m_preferredX;
+        std::vector<float> m_preferredZ;
+        std::vector<float> m_resultX;
+        std::vector<float> m_resultZ;
+        std::vector<float> m_radius;
+        std::vector<float> m_maxSpeed;
+        std::vector<uint8_t> m_active;
+        std::vector<int> m_freeSlots;
+        int m_agentCount;
+
+        // Uniform grid (CSR over cells), rebuilt each step
+        glm::vec2 m_gridOrigin;
+        float m_cellSize;
+        int m_gridWidth;
+        int m_gridHeight;
+        std::vector<uint32_t> m_cellStart;
+        std::vector<int> m_cellAgents;
+        std::vector<int> m_agentCell;
+
+        std::vector<size_t> m_batchPairs;
+        std::vector<int> m_batchFallbacks;
+
+        CrowdAvoidanceStats m_stats;
+
+        void rebuildGrid();
+        int gatherNeighbors(int agent, Neighbor* neighbors) const;
+        void solveAgent(int agent, float deltaTime, std::vector<Line>& lines, size_t& pairs, int& fallbacks);
+
+        static bool linearProgram1(const std::vector<Line>& lines, size_t lineNo, float radius,
+                                   const glm::vec2& optVelocity, bool directionOpt, glm::vec2& result);
+        static size_t linearProgram2(const std::vector<Line>& lines, float radius, const glm::vec2& optVelocity,
+                                     bool directionOpt, glm::vec2& result);
+        static void linearProgram3(const std::vector<Line>& lines, size_t beginLine, float radius, glm::vec2& result);
+    };
+}
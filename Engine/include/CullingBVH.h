@@ -0,0 +1,149 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace Sparky {
+    class GameObject;
+
+    /**
+     * @brief Six planes bounding what a camera sees
+     *
+     * Planes point inwards and are normalized, so a point p is inside a
+     * plane when dot(plane.xyz, p) + plane.w >= 0.
+     */
+    struct Frustum {
+        enum Plane { LEFT, RIGHT, BOTTOM, TOP, NEAR_PLANE, FAR_PLANE, PLANE_COUNT };
+
+        glm::vec4 planes[PLANE_COUNT];
+
+        // Planes of projection * view, for either clip depth range
+        static Frustum fromMatrix(const glm::mat4& viewProjection);
+
+        // False only when the box lies entirely outside one of the planes
+        bool intersectsBox(const glm::vec3& minBounds, const glm::vec3& maxBounds) const;
+    };
+
+    // World space box around a transformed local box
+    void transformBounds(const glm::vec3& localMin, const glm::vec3& localMax, const glm::mat4& transform,
+                         glm::vec3& worldMin, glm::vec3& worldMax);
+
+    struct CullingStats {
+        int proxies = 0;
+        int visible = 0;
+        int nodesTested = 0;        // Each tests its four children at once
+        int boxesTested = 0;        // Proxy boxes, in groups of four
+        int subtreesAccepted = 0;   // Entirely inside, taken without testing further
+    };
+
+    /**
+     * @brief Bounding volume hierarchy for frustum culling moving objects
+     *
+     * Proxies are world space boxes. build() sorts them into a four-wide
+     * tree with a binned surface area heuristic; each node keeps the boxes
+     * of its four children side by side, so one SSE pass tests all four
+     * against a plane, and leaf boxes are laid out the same way in groups
+     * of four. A subtree found entirely inside the frustum is taken whole,
+     * and planes a node is entirely inside are not tested below it.
+     *
+     * Moving a proxy writes its new box in place and update() refits the
+     * nodes above it. Proxies added since the last build wait in a list
+     * that cull() tests linearly; update() rebuilds the tree once that list,
+     * the proxies removed from the tree or the refitted node area grows too
+     * large.
+     *
+     * cull() is const and may run from several threads at once, but not
+     * while proxies change or update() runs.
+     */
+    class CullingBVH {
+    public:
+        CullingBVH();
+
+        // Slots of removed proxies are reused
+        int addProxy(const glm::vec3& minBounds, const glm::vec3& maxBounds, GameObject* object = nullptr);
+        void moveProxy(int proxy, const glm::vec3& minBounds, const glm::vec3& maxBounds);
+        void removeProxy(int proxy);
+        void clear();
+
+        // Rebuilds or refits after proxies changed; call before cull()
+        void update();
+        void build();
+
+        // Proxies at least partly inside the frustum, in no particular order
+        void cull(const Frustum& frustum, std::vector<int>& visible, CullingStats* stats = nullptr) const;
+
+        int getProxyCount() const { return m_proxyCount; }
+        GameObject* getProxyObject(int proxy) const { return m_proxyObject[proxy]; }
+        void getProxyBounds(int proxy, glm::vec3& minBounds, glm::vec3& maxBounds) const;
+
+        int getNodeCount() const { return static_cast<int>(m_nodes.size()); }
+        int getPendingCount() const { return static_cast<int>(m_positionCount - m_treeCount); }
+        int getRebuildCount() const { return m_rebuilds; }
+        int getRefitCount() const { return m_refits; }
+
+    private:
+        // Four children in structure of arrays form. A child is an inner node
+        // (child >= 0), a leaf (child < 0) or empty (count == 0); first and
+        // count give the positions under it either way.
+        struct alignas(16) Node {
+            float minX[4];
+            float minY[4];
+            float minZ[4];
+            float maxX[4];
+            float maxY[4];
+            float maxZ[4];
+            int32_t child[4];
+            uint32_t first[4];
+            uint32_t count[4];
+        };
+
+        // Boxes by position: the tree's leaves in order, each padded to a
+        // multiple of four, then the pending proxies. Unused positions hold
+        // an inverted box that never passes a plane test.
+        std::vector<float> m_minX;
+        std::vector<float> m_minY;
+        std::vector<float> m_minZ;
+        std::vector<float> m_maxX;
+        std::vector<float> m_maxY;
+        std::vector<float> m_maxZ;
+        std::vector<int> m_positionProxy;       // -1 when unused
+        std::vector<int> m_positionNode;        // Leaf node holding the position, -1 when pending
+        uint32_t m_treeCount;
+        uint32_t m_positionCount;
+
+        std::vector<int> m_proxyPosition;       // -1 for free slots
+        std::vector<GameObject*> m_proxyObject;
+        std::vector<int> m_freeSlots;
+        int m_proxyCount;
+
+        std::vector<Node> m_nodes;              // Parents come before their children
+        std::vector<int> m_nodeParent;
+        std::vector<uint8_t> m_nodeDirty;
+        bool m_anyDirty;
+        int m_treeRemoved;                      // Tree positions freed since the build
+        double m_surfaceArea;                   // Of every child box, at the build and now
+        double m_builtSurfaceArea;
+        int m_rebuilds;
+        int m_refits;
+
+        struct BuildItem {
+            glm::vec3 minBounds;
+            glm::vec3 maxBounds;
+            glm::vec3 centroid;
+            int proxy;
+        };
+
+        void setPosition(uint32_t position, const glm::vec3& minBounds, const glm::vec3& maxBounds, int proxy);
+        void clearPosition(uint32_t position);
+        void growPositions();
+        void markDirty(int node);
+        void refit();
+        void refitNode(int node);
+        void rangeBounds(uint32_t first, uint32_t count, glm::vec3& minBounds, glm::vec3& maxBounds) const;
+        void cullRange(const Frustum& frustum, uint32_t first, uint32_t count, uint32_t planeMask,
+                       std::vector<int>& visible, CullingStats& stats) const;
+        int buildNode(std::vector<BuildItem>& items, uint32_t begin, uint32_t end, int parent, int depth);
+        uint32_t splitItems(std::vector<BuildItem>& items, uint32_t begin, uint32_t end, int depth) const;
+    };
+}
@@ -9,6 +9,9 @@ namespace Sparky {
         static bool fileExists(const std::string& filepath);
         static std::vector<char> readFile(const std::string& filepath);
         static bool writeFile(const std::string& filepath, const std::vector<char>& data);
+        // Writes to a temporary file and renames it over filepath, so readers see
+        // either the old file or the complete new one
+        static bool writeFileAtomic(const std::string& filepath, const std::vector<char>& data);
         static std::string getFileName(const std::string& filepath);
         static std::string getFileExtension(const std::string& filepath);
         static std::string getDirectory(const std::string& filepath);
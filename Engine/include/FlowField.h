@@ -0,0 +1,128 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Sparky {
+    class JobSystem;
+    class NavigationMesh;
+
+    struct FlowFieldSettings {
+        float cellSize;             // Cell edge length in world units (XZ)
+        int tileSize;               // Cells per tile edge; tiles are the unit of parallel work
+        float tolerance;            // Changes below this do not wake neighbouring tiles
+        bool incremental;           // Warm-start from the previous field when the goal moves
+
+        FlowFieldSettings() : cellSize(1.0f), tileSize(16), tolerance(1e-3f), incremental(true) {}
+    };
+
+    struct FlowFieldStats {
+        int rounds;                 // Parallel passes of the last recompute
+        int tileSolves;             // Tile solves of the last recompute
+        bool incremental;           // Whether the last recompute reused the previous field
+        double computeMs;
+        int recomputes;
+    };
+
+    /**
+     * @brief Shared goal navigation for crowds
+     *
+     * The level is a grid of per-cell traversal costs (1-254, BLOCKED for
+     * walls). setGoal() solves the eikonal equation |grad T| = cost from the
+     * goal cell, giving every cell its travel distance to the goal, and
+     * stores the downhill direction per cell. Any number of agents then
+     * steer with sampleDirection() at constant cost per agent instead of
+     * searching their own paths.
+     *
+     * The grid is split into square tiles. A recompute runs rounds of tile
+     * solves over the JobSystem: each round snapshots the border of its
+     * active tiles, relaxes them in parallel and wakes the neighbours of
+     * tiles whose border values changed. When the goal moves to another
+     * cell, the previous distances plus the old distance to the new goal
+     * seed the solve, so tiles whose values barely move settle at once.
+     * Moving within the same cell costs nothing.
+     *
+     * Sampling is read-only and may run from many threads, but not during
+     * setGoal() or cost edits.
+     */
+    class FlowField {
+    public:
+        static constexpr uint8_t BLOCKED = 255;
+
+        FlowField();
+
+        // Constructor for dependency injection
+        explicit FlowField(const FlowFieldSettings& settings);
+
+        // Method to create a new FlowField instance for dependency injection
+        static std::unique_ptr<FlowField> create(const FlowFieldSettings& settings = FlowFieldSettings());
+
+        // Tile solves run here when set and it has workers, else on the calling thread
+        void setJobSystem(JobSystem* jobSystem) { m_jobSystem = jobSystem; }
+
+        // Grid. resize() opens every cell at cost 1 and drops the field.
+        void resize(const glm::vec3& minBounds, const glm::vec3& maxBounds);
+        void setCellCost(int x, int z, uint8_t cost);
+        uint8_t getCellCost(int x, int z) const { return m_costs[index(x, z)]; }
+        // Walkability from the navigation polygons, or from the walkable nodes
+        // (a cell is open when one lies within it) if the mesh has none
+        void rasterize(const NavigationMesh& navMesh, const glm::vec3& minBounds, const glm::vec3& maxBounds);
+
+        int getWidth() const { return m_width; }
+        int getHeight() const { return m_height; }
+        bool worldToCell(const glm::vec3& position, int& x, int& z) const;
+        glm::vec3 cellCenter(int x, int z) const;
+
+        // Recomputes when the goal enters another cell or costs changed since the
+        // last solve; returns false if the goal is outside the grid or blocked
+        bool setGoal(const glm::vec3& goal);
+        bool hasGoal() const { return m_goalCell >= 0; }
+        // Forces a full recompute on the next setGoal()
+        void invalidate() { m_fieldValid = false; }
+
+        // Unit XZ direction towards the goal, blended between the four nearest
+        // open cells; zero at the goal, off the grid or where it is unreachable
+        glm::vec3 sampleDirection(const glm::vec3& position) const;
+        // Travel distance to the goal, or a negative value if unreachable
+        float sampleDistance(const glm::vec3& position) const;
+        float getDistance(int x, int z) const;
+
+        const FlowFieldStats& getStats() const { return m_stats; }
+
+    private:
+        FlowFieldSettings m_settings;
+        JobSystem* m_jobSystem;
+
+        glm::vec2 m_origin;
+        int m_width;
+        int m_height;
+        int m_tilesX;
+        int m_tilesZ;
+
+        std::vector<uint8_t> m_costs;
+        std::vector<float> m_distances;
+        std::vector<glm::vec2> m_directions;
+        int m_goalCell;
+        bool m_fieldValid;
+
+        // Recompute scratch
+        std::vector<uint8_t> m_tileActive;
+        std::vector<int> m_activeTiles;
+        std::vector<float> m_tileBuffers;   // Per active tile: cells plus a one-cell border
+        std::vector<uint8_t> m_tileWake;    // Per active tile: borders that changed (bit per side)
+        std::vector<uint8_t> m_tileSolved;  // Tiles whose directions need refreshing
+        std::vector<int> m_solvedTiles;
+
+        FlowFieldStats m_stats;
+
+        int index(int x, int z) const { return z * m_width + x; }
+        int tileOf(int cell) const;
+        void solve();
+        void gatherTile(int slot);
+        void relaxTile(int slot);
+        void updateDirections(int slot);
+        void forEach(size_t count, void (FlowField::*body)(int));
+    };
+}
@@ -6,6 +6,8 @@
 #include <vector>
 #include <memory>
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
 
 #include "Component.h"
 
@@ -17,6 +19,8 @@ namespace Sparky {
         glm::vec3 scale;
         std::string name;
         std::vector<std::unique_ptr<Component>> components;
+        bool phasedUpdate;
+        std::atomic<uint32_t> revision;
 
     public:
         GameObject(const std::string& name = "GameObject");
@@ -24,16 +28,16 @@ namespace Sparky {
 
         // Getters and setters
         const glm::vec3& getPosition() const { return position; }
-        void setPosition(const glm::vec3& pos) { position = pos; }
+        void setPosition(const glm::vec3& pos) { position = pos; markDirty(); }
 
         const glm::vec3& getRotation() const { return rotation; }
-        void setRotation(const glm::vec3& rot) { rotation = rot; }
+        void setRotation(const glm::vec3& rot) { rotation = rot; markDirty(); }
 
         const glm::vec3& getScale() const { return scale; }
-        void setScale(const glm::vec3& s) { scale = s; }
+        void setScale(const glm::vec3& s) { scale = s; markDirty(); }
 
         const std::string& getName() const { return name; }
-        void setName(const std::string& n) { name = n; }
+        void setName(const std::string& n) { name = n; markDirty(); }
 
         // Transform matrix calculation
         glm::mat4 getTransformMatrix() const {
@@ -54,6 +58,7 @@ namespace Sparky {
             T* componentPtr = component.get();
             components.push_back(std::move(component));
             componentPtr->setOwner(this);
+            markDirty();
             return componentPtr;
         }
 
@@ -89,6 +94,7 @@ namespace Sparky {
                     }),
                 components.end()
             );
+            markDirty();
         }
 
         // Get all components
@@ -96,6 +102,17 @@ namespace Sparky {
             return components;
         }
 
+        // When set, update() only runs LATE_UPDATE components; the scene's
+        // UpdateScheduler runs the other phases
+        void setPhasedUpdate(bool phased) { phasedUpdate = phased; }
+        bool isPhasedUpdate() const { return phasedUpdate; }
+
+        // State revision, bumped whenever the transform, the component list or
+        // a serializable component changes. Snapshots use it to skip unchanged
+        // objects and the RenderSystem to refresh world bounds.
+        void markDirty() { revision.fetch_add(1, std::memory_order_relaxed); }
+        uint32_t getRevision() const { return revision.load(std::memory_order_relaxed); }
+
         // Virtual methods
         virtual void update(float deltaTime);
         virtual void render();
@@ -1,13 +1,14 @@
 #pragma once
 
 #include "Component.h"
+#include "SnapshotSerializable.h"
 #include <functional>
 
 namespace Sparky {
     // Forward declaration
     class DamageFeedbackComponent;
     
-    class HealthComponent : public Component {
+    class HealthComponent : public Component, public SnapshotSerializable {
     public:
         HealthComponent(float maxHealth = 100.0f);
         ~HealthComponent();
@@ -37,6 +38,12 @@ namespace Sparky {
         void setDamageFeedbackComponent(DamageFeedbackComponent* feedback) { damageFeedback = feedback; }
         DamageFeedbackComponent* getDamageFeedbackComponent() const { return damageFeedback; }
 
+        // Snapshot serialization
+        static constexpr const char* SnapshotTypeName = "HealthComponent";
+        const char* getSnapshotTypeName() const override { return SnapshotTypeName; }
+        void serialize(BinaryWriter& writer) const override;
+        bool deserialize(BinaryReader& reader, uint16_t version) override;
+
     private:
         float currentHealth;
         float maxHealth;
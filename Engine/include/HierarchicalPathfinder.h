@@ -0,0 +1,176 @@
+#pragma once
+
+#include "NavGraph.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Sparky {
+    class NavigationMesh;
+
+    struct HierarchicalPathSettings {
+        float clusterSize;      // Cluster edge length in world units (XZ)
+        int maxEntranceWidth;   // Wider entrances get a transition at each end instead of the middle
+
+        HierarchicalPathSettings() : clusterSize(16.0f), maxEntranceWidth(6) {}
+    };
+
+    struct HierarchicalPathStats {
+        int clusterCount;
+        int entranceCount;          // Abstract graph nodes
+        size_t abstractEdgeCount;
+        int abstractNodesExpanded;  // Last abstract search
+        int updatedClusters;        // Last update()
+        double buildMs;
+        double updateMs;
+    };
+
+    // Result of findAbstractPath(): low-level waypoints from start to goal.
+    // Consecutive waypoints are either in the same cluster or joined by an
+    // edge, and refineNextSegment() turns them into nodes one at a time.
+    struct HierarchicalPath {
+        std::vector<int> waypoints;
+        size_t nextSegment;
+        float cost;
+
+        HierarchicalPath() : nextSegment(0), cost(0.0f) {}
+    };
+
+    /**
+     * @brief HPA* layer over a NavigationMesh for large levels
+     *
+     * Nodes are grouped into square XZ clusters. Where walkable nodes on both
+     * sides of a cluster border form a continuous entrance, one or two edges
+     * across it become transitions, and the transition nodes (entrances) are
+     * the abstract graph. Inside each cluster the entrances are connected by
+     * their shortest path cost within the cluster. A query links start and
+     * goal to the entrances of their clusters, searches the small abstract
+     * graph and refines each abstract step lazily with an A* confined to one
+     * cluster, so agents only pay for the part of the path they walk.
+     *
+     * After NavigationMesh::setNodeWalkable() (dynamic obstacles, level
+     * edits), mark the changed nodes or area; LevelEditor reports edited
+     * areas through setOnAreaChangeCallback(). The next query rebuilds only
+     * the touched clusters and the entrances on their borders. Adding or
+     * removing nodes or connections needs a full build().
+     *
+     * One pathfinder serves one thread.
+     */
+    class HierarchicalPathfinder {
+    public:
+        // Constructor for dependency injection
+        explicit HierarchicalPathfinder(const NavigationMesh* navMesh,
+                                        const HierarchicalPathSettings& settings = HierarchicalPathSettings());
+
+        // Method to create a new HierarchicalPathfinder instance for dependency injection
+        static std::unique_ptr<HierarchicalPathfinder> create(const NavigationMesh* navMesh,
+                                                              const HierarchicalPathSettings& settings = HierarchicalPathSettings());
+
+        // Clusters, transitions and intra-cluster costs for the whole mesh
+        void build();
+        bool isBuilt() const { return m_built; }
+
+        // Incremental updates after walkability changes
+        void markNodeChanged(int node);
+        void markAreaChanged(const glm::vec3& minBounds, const glm::vec3& maxBounds);
+        // Rebuilds marked clusters now; returns how many clusters were rebuilt
+        int update();
+
+        // Queries apply pending updates first
+        bool findAbstractPath(int startNode, int goalNode, HierarchicalPath& path);
+        // Appends the nodes of the next segment (the first call includes the start).
+        // Returns false once the path is fully refined, or if the segment is blocked.
+        bool refineNextSegment(HierarchicalPath& path, std::vector<int>& nodes);
+        bool isFullyRefined(const HierarchicalPath& path) const;
+
+        // Fully refined node path
+        bool findNodePath(int startNode, int goalNode, std::vector<int>& path);
+        // Same contract as NavigationMesh::findPath
+        std::vector<glm::vec3> findPath(const glm::vec3& start, const glm::vec3& end);
+
+        int getClusterOf(int node) const { return m_nodeCluster[node]; }
+        const HierarchicalPathStats& getStats() const { return m_stats; }
+
+    private:
+        struct Transition {
+            int from;
+            int to;
+            float cost;
+        };
+
+        struct Link {
+            int target;
+            float cost;
+        };
+
+        struct Cluster {
+            std::vector<int> neighbors;             // Clusters joined to this one by an edge
+            std::vector<int> entrances;             // Abstract nodes, as mesh node ids
+            std::vector<float> intraCosts;          // entrances x entrances, row = from
+            std::vector<std::vector<Link>> exits;   // Transitions leaving each entrance
+        };
+
+        struct SearchState {
+            uint32_t generation;
+            float cost;
+            int parent;
+            bool closed;
+        };
+
+        const NavigationMesh* m_navMesh;
+        HierarchicalPathSettings m_settings;
+        bool m_built;
+
+        // Cluster grid
+        glm::vec2 m_origin;
+        int m_clustersX;
+        int m_clustersZ;
+        std::vector<int> m_nodeCluster;
+        std::vector<uint32_t> m_clusterNodeStart;
+        std::vector<int> m_clusterNodes;
+        std::vector<Cluster> m_clusters;
+        std::vector<int> m_entranceIndex;   // Mesh node -> index in its cluster's entrances, or -1
+        std::unordered_map<uint64_t, std::vector<Transition>> m_transitions; // Keyed by (from, to) cluster
+
+        // Incoming edges (CSR), for searches towards the goal
+        std::vector<uint32_t> m_reverseStart;
+        std::vector<int> m_reverseSources;
+        std::vector<float> m_reverseCosts;
+
+        std::vector<uint8_t> m_clusterDirty;
+        std::vector<int> m_dirtyClusters;
+
+        // Cluster-local Dijkstra scratch
+        std::vector<uint32_t> m_localGeneration;
+        std::vector<float> m_localCost;
+        std::vector<std::pair<float, int>> m_localHeap;
+        uint32_t m_localStamp;
+
+        // Abstract A* scratch; the extra last slot is the goal
+        std::vector<SearchState> m_search;
+        std::vector<std::pair<float, int>> m_searchHeap;
+        std::vector<float> m_goalCosts;
+        uint32_t m_searchStamp;
+
+        AStarSearch m_refiner;
+        std::vector<int> m_segment;
+        std::vector<int> m_nodePath;
+        HierarchicalPathStats m_stats;
+
+        static uint64_t pairKey(int fromCluster, int toCluster) {
+            return (static_cast<uint64_t>(static_cast<uint32_t>(fromCluster)) << 32) | static_cast<uint32_t>(toCluster);
+        }
+
+        int clusterAt(float x, float z) const;
+        void computeTransitions(const NavGraph& graph, int fromCluster, int toCluster);
+        void rebuildCluster(const NavGraph& graph, int cluster);
+        void clusterDijkstra(const NavGraph& graph, int source, int cluster, bool reverse);
+        float localCost(int node) const;
+        void relax(const NavGraph& graph, int node, float cost, int parent, int goal);
+        void refreshCounts();
+        bool ensureCurrent();
+    };
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace Sparky {
+    struct IKSolverSettings {
+        int maxIterations;      // FABRIK passes per chain
+        float tolerance;        // Distance from the target that counts as reached
+
+        IKSolverSettings()
+            : maxIterations(10), tolerance(0.001f) {}
+    };
+
+    struct IKSolveStats {
+        int chainsSolved;
+        int twoBoneChains;      // Solved in closed form
+        int fabrikChains;
+        int converged;          // Ended within tolerance of the target
+        int unreachable;        // Target out of reach; the chain points straight at it
+        int iterations;         // FABRIK passes plus one per two-bone chain
+        float maxError;         // Largest distance left between an end and its target
+    };
+
+    // Joint limits are bend angles in radians: the angle between the bone coming into a joint
+    // and the bone leaving it, 0 when straight. A limit with min > max is ignored, and the
+    // first joint of a chain has no incoming bone so it is never limited.
+
+    // Closed-form two-bone IK (hip, knee, ankle). Moves mid and end so end is as close to target
+    // as the bone lengths and the middle joint's bend limits allow, bending in the plane towards
+    // pole; with usePole false the current bend plane is kept. Returns the distance left.
+    float solveTwoBone(const glm::vec3& root, glm::vec3& mid, glm::vec3& end, const glm::vec3& target,
+                       const glm::vec3& pole, bool usePole, float minBend, float maxBend);
+
+    // FABRIK over count joint positions, root first and end effector last, with lengths[i]
+    // between positions i and i + 1 and bend limits per position. The root stays put.
+    // Returns the passes used and sets error to the distance left.
+    int solveFABRIK(glm::vec3* positions, const float* lengths, int count, const glm::vec3& target,
+                    const float* minBends, const float* maxBends, const IKSolverSettings& settings, float& error);
+
+    /**
+     * @brief Many IK chains packed into flat arrays and solved in one pass
+     *
+     * Each chain is its joint positions in model space, root first and the
+     * end effector last, with a target, an optional pole and bend limits.
+     * Chains of three positions (two bones) are solved in closed form and
+     * longer ones with FABRIK, all in place in the shared position buffer,
+     * so solving never goes back to the skeleton. Afterwards positions holds
+     * the solved joints, ready to be turned back into rotations.
+     */
+    struct IKChainBatch {
+        std::vector<glm::vec3> positions;
+        std::vector<float> lengths;         // From each position to the next within its chain
+        std::vector<float> minBends;
+        std::vector<float> maxBends;
+
+        // Per chain
+        std::vector<int> offsets;           // First position
+        std::vector<int> counts;
+        std::vector<glm::vec3> targets;
+        std::vector<glm::vec3> poles;
+        std::vector<unsigned char> hasPole;
+        std::vector<int> iterations;        // Filled in by solveIKBatch
+        std::vector<float> errors;
+
+        void clear();
+
+        // Adds a chain of count positions (at least two), with count bend limits; returns its index
+        int addChain(const glm::vec3* points, int count, const glm::vec3& target, const glm::vec3* pole,
+                     const float* minBend, const float* maxBend);
+        int getChainCount() const { return static_cast<int>(offsets.size()); }
+    };
+
+    // Solves every chain in batch; stats are added to
+    void solveIKBatch(IKChainBatch& batch, const IKSolverSettings& settings, IKSolveStats& stats);
+}
@@ -0,0 +1,245 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Sparky {
+    class JobSystem;
+    class StaticBVH;
+
+    using InfluenceSourceId = int32_t;
+    constexpr InfluenceSourceId INVALID_INFLUENCE_SOURCE = -1;
+
+    enum class InfluenceLayer {
+        THREAT,         // Propagated from threat sources, fading with distance
+        VISIBILITY,     // Summed strength of the threat sources that can see the cell
+        COVER           // Fraction of directions blocked at cover height, from the level
+    };
+
+    // Response curve for one consideration; inputs and outputs are in [0, 1]
+    struct UtilityCurve {
+        enum class Type : uint8_t {
+            LINEAR,         // slope * (x - xShift) + yShift
+            POLYNOMIAL,     // slope * (x - xShift)^exponent + yShift
+            LOGISTIC        // exponent / (1 + e^(-slope * (x - xShift))) + yShift
+        };
+
+        Type type;
+        float slope;
+        float exponent;
+        float xShift;
+        float yShift;
+
+        UtilityCurve() : type(Type::LINEAR), slope(1.0f), exponent(1.0f), xShift(0.0f), yShift(0.0f) {}
+        UtilityCurve(Type type, float slope, float exponent, float xShift, float yShift)
+            : type(type), slope(slope), exponent(exponent), xShift(xShift), yShift(yShift) {}
+
+        static UtilityCurve rising() { return UtilityCurve(); }
+        static UtilityCurve falling() { return UtilityCurve(Type::LINEAR, -1.0f, 1.0f, 0.0f, 1.0f); }
+        // Peaks at 1 when x equals center and falls off quadratically
+        static UtilityCurve bell(float center, float width) {
+            return UtilityCurve(Type::POLYNOMIAL, -1.0f / (width * width), 2.0f, center, 1.0f);
+        }
+
+        float evaluate(float x) const;
+        // evaluate() over an array
+        void evaluate(const float* x, float* y, size_t count) const;
+    };
+
+    // Inputs a tactical query can weigh, each normalized to [0, 1]
+    enum class TacticalConsideration {
+        THREAT,
+        VISIBILITY,
+        COVER,              // Directional cover against the query target when it has one
+        DISTANCE_TO_SELF,   // Divided by the query radius
+        DISTANCE_TO_TARGET, // Divided by the query radius
+        FLANK_ANGLE,        // Angle at the target between the agent and the candidate, over 180 degrees
+        COUNT
+    };
+
+    /**
+     * @brief Weighted utility scoring for candidate positions
+     *
+     * A candidate's score is the weighted mean of each consideration's curve
+     * output. Considerations with zero weight are skipped entirely.
+     */
+    struct TacticalQuery {
+        glm::vec3 self;
+        glm::vec3 target;
+        bool hasTarget;
+        float radius;
+        UtilityCurve curves[static_cast<int>(TacticalConsideration::COUNT)];
+        float weights[static_cast<int>(TacticalConsideration::COUNT)];
+
+        TacticalQuery();
+
+        void consider(TacticalConsideration consideration, const UtilityCurve& curve, float weight);
+
+        // Presets used by AdvancedAI
+        static TacticalQuery cover(const glm::vec3& self, const glm::vec3& threat, float radius);
+        static TacticalQuery flank(const glm::vec3& self, const glm::vec3& target, float radius);
+    };
+
+    struct InfluenceMapSettings {
+        glm::vec3 origin;           // Minimum corner of the grid; cells lie in the XZ plane at origin.y
+        float cellSize;
+        int width;                  // Cells along X
+        int height;                 // Cells along Z
+        float threatDecay;          // Falloff per metre as threat spreads
+        float threatMomentum;       // Share of the old value kept per propagation step
+        int propagationSteps;       // Propagation steps per update()
+        float eyeHeight;            // Added to threat sources for visibility rays
+        float targetHeight;         // Added to cell centres for visibility rays
+        float coverHeight;          // Height of the cover probes
+        float coverProbeDistance;   // Length of the cover probes
+
+        InfluenceMapSettings()
+            : origin(0.0f), cellSize(2.0f), width(128), height(128), threatDecay(0.15f), threatMomentum(0.5f),
+              propagationSteps(2), eyeHeight(1.6f), targetHeight(1.0f), coverHeight(1.0f), coverProbeDistance(1.5f) {}
+    };
+
+    struct InfluenceMapStats {
+        int tilesPropagated;        // Summed over this update's propagation steps
+        int activeTiles;            // Tiles still changing after the update
+        size_t visibilityRays;
+        double propagationMs;
+        double visibilityMs;
+    };
+
+    /**
+     * @brief Grid layers of tactical information over a level
+     *
+     * Three layers share one XZ grid. Cover is computed once, at load time,
+     * by buildCover(): eight horizontal probes per cell at cover height
+     * against the static geometry BVH give a mask of the directions that
+     * have cover, and cells inside geometry are marked blocked. Visibility is
+     * the strength of the threat sources that have line of sight to each
+     * cell, seen from the centre of the source's cell; a source's footprint
+     * is re-raycast (in one batch) only when it moves to another cell or its
+     * strength or range changes. Threat spreads from the
+     * sources, fades with distance and does not cross blocked cells.
+     *
+     * Threat propagation is incremental. The grid is split into 16x16 tiles
+     * and each step only recomputes tiles that changed in the previous step,
+     * their neighbours, and tiles whose sources changed, so a settled map
+     * costs nothing. Steps are double-buffered per tile, which lets the
+     * active tiles run in parallel on the JobSystem with the same result as
+     * a serial update.
+     *
+     * Tactical queries score candidate positions with a TacticalQuery in
+     * batches: inputs are gathered into arrays per consideration and each
+     * curve runs over the whole array.
+     */
+    class InfluenceMap {
+    public:
+        InfluenceMap();
+
+        // Constructor for dependency injection
+        explicit InfluenceMap(const InfluenceMapSettings& settings);
+
+        // Method to create a new InfluenceMap instance for dependency injection
+        static std::unique_ptr<InfluenceMap> create(const InfluenceMapSettings& settings = InfluenceMapSettings());
+
+        void setJobSystem(JobSystem* jobSystem) { m_jobSystem = jobSystem; }
+
+        // Occluders for visibility; nullptr sees through everything
+        void setOccluders(const StaticBVH* occluders) { m_occluders = occluders; }
+
+        // Precomputes cover and blocked cells from level geometry
+        void buildCover(const StaticBVH& geometry);
+
+        // Threat sources; strength is in [0, 1] and sight range in metres
+        InfluenceSourceId addThreatSource(const glm::vec3& position, float strength = 1.0f, float sightRange = 30.0f);
+        void removeThreatSource(InfluenceSourceId source);
+        void setThreatSourcePosition(InfluenceSourceId source, const glm::vec3& position);
+        void setThreatSource(InfluenceSourceId source, float strength, float sightRange);
+        int getThreatSourceCount() const { return m_sourceCount; }
+
+        // Refreshes visibility for changed sources and propagates threat
+        void update();
+
+        // Layer values at a world position, 0 outside the grid
+        float sample(InfluenceLayer layer, const glm::vec3& position) const;
+        bool isBlocked(const glm::vec3& position) const;
+        // Directions with cover as bits; bit k points along (cos, 0, sin) of k * 45 degrees
+        uint8_t getCoverMask(const glm::vec3& position) const;
+        bool hasCoverFrom(const glm::vec3& position, const glm::vec3& threat) const;
+
+        // Scores positions; blocked or off-grid positions score 0
+        void scorePositions(const TacticalQuery& query, const glm::vec3* positions, size_t count, float* scores) const;
+        // Best unblocked cell centre within the query radius of query.self
+        bool findBestPosition(const TacticalQuery& query, glm::vec3& result, float* score = nullptr) const;
+        // Best precomputed cover point against the threat
+        bool findCoverPosition(const glm::vec3& self, const glm::vec3& threat, float radius, glm::vec3& result) const;
+        bool findFlankPosition(const glm::vec3& self, const glm::vec3& target, float radius, glm::vec3& result) const;
+
+        int getCoverPointCount() const { return m_coverPointCount; }
+        glm::vec3 getCellCenter(int cell) const;
+        int getCell(const glm::vec3& position) const;
+        const InfluenceMapSettings& getSettings() const { return m_settings; }
+        const InfluenceMapStats& getStats() const { return m_stats; }
+
+    private:
+        struct ThreatSource {
+            glm::vec3 position;
+            float strength;
+            float sightRange;
+            int cell;
+            bool visibilityDirty;
+            float visibleStrength;              // Strength added to visibleCells
+            std::vector<uint32_t> visibleCells;
+        };
+
+        InfluenceMapSettings m_settings;
+        JobSystem* m_jobSystem;
+        const StaticBVH* m_occluders;
+        int m_tilesX;
+        int m_tilesZ;
+        float m_edgeFalloff;
+        float m_diagonalFalloff;
+
+        // Cell layers
+        std::vector<float> m_threat;
+        std::vector<float> m_threatNext;
+        std::vector<float> m_sourceValue;
+        std::vector<uint32_t> m_stampedCells;
+        std::vector<float> m_stampedValues;
+        std::vector<float> m_visibility;
+        std::vector<uint16_t> m_visibilityCount;
+        std::vector<uint8_t> m_coverMask;
+        std::vector<uint8_t> m_blocked;
+        int m_coverPointCount;
+
+        // Tiles to propagate next step
+        std::vector<uint8_t> m_tileActive;
+        std::vector<uint32_t> m_tileList;
+        std::vector<float> m_tileDelta;
+
+        // Source slots
+        std::vector<ThreatSource> m_sources;
+        std::vector<uint8_t> m_sourceActive;
+        std::vector<int> m_freeSources;
+        int m_sourceCount;
+        bool m_sourcesDirty;
+
+        std::vector<glm::vec3> m_rayFrom;
+        std::vector<glm::vec3> m_rayTo;
+        std::vector<uint8_t> m_rayOccluded;
+
+        InfluenceMapStats m_stats;
+
+        void activateTileAt(int cell);
+        void restampSources();
+        void refreshVisibility(ThreatSource& source);
+        void clearVisibility(ThreatSource& source);
+        void propagateTile(uint32_t tile);
+        void propagateStep();
+        void gatherInputs(TacticalConsideration consideration, const TacticalQuery& query, const glm::vec3* positions,
+                          const int* cells, size_t count, float* inputs) const;
+        void scoreBatch(const TacticalQuery& query, const glm::vec3* positions, const int* cells, size_t count,
+                        float* scores) const;
+        bool findBest(const TacticalQuery& query, bool coverOnly, glm::vec3& result, float* score) const;
+    };
+}
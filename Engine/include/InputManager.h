@@ -128,8 +128,19 @@ const int GLFW_ACTION_REPEAT = 2;
 #endif
 
 #include <glm/glm.hpp>
+#include <cstdint>
 
 namespace Sparky {
+    // Raw input state for one tick, as recorded and replayed by the replay system
+    struct InputFrame {
+        static const int KEY_WORDS = 512 / 32;
+
+        uint32_t keys[KEY_WORDS]; // One bit per key code
+        uint8_t mouseButtons;     // One bit per button
+        float mouseX, mouseY;
+        float scrollX, scrollY;
+    };
+
     class InputManager {
     public:
         static InputManager& getInstance();
@@ -153,6 +164,13 @@ namespace Sparky {
         void setCursorMode(int mode); // GLFW_CURSOR_DISABLED, GLFW_CURSOR_HIDDEN, GLFW_CURSOR_NORMAL
         int getCursorMode() const { return cursorMode; }
 
+        // Replay support. applyFrame() sets the state the window callbacks would
+        // have set; while playback is enabled the real callbacks are ignored.
+        void captureFrame(InputFrame& frame) const;
+        void applyFrame(const InputFrame& frame);
+        void setPlaybackEnabled(bool enabled) { playbackEnabled = enabled; }
+        bool isPlaybackEnabled() const { return playbackEnabled; }
+
         // Callbacks
         static void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
         static void mouseCallback(GLFWwindow* window, double xpos, double ypos);
@@ -173,6 +191,7 @@ namespace Sparky {
         float prevScrollX, prevScrollY;
         GLFWwindow* window;
         int cursorMode;
+        bool playbackEnabled;
         
         static InputManager* instance;
     };
@@ -54,5 +54,7 @@ namespace Sparky {
     private:
         int size;
         std::vector<std::unique_ptr<Item>> items;
+
+        bool readArchive(const std::vector<char>& data);
     };
 }
\ No newline at end of file
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Sparky {
+    /**
+     * @brief Work-stealing job system
+     *
+     * Every worker owns a Chase-Lev deque. A worker pushes and pops at the bottom
+     * of its own deque without locking, and idle workers steal from the top of
+     * other deques. Jobs submitted from non-worker threads go through a shared
+     * injection queue.
+     *
+     * Dependencies are expressed with JobCounters: waiting on a counter executes
+     * other jobs instead of blocking, and runAfter() queues a continuation that is
+     * released when a counter reaches zero, so a job never has to park a worker.
+     * Blocking I/O goes to dedicated I/O threads that never take compute jobs.
+     */
+    using Job = std::function<void()>;
+
+    struct JobRecord;
+
+    // Tracks the number of outstanding jobs in a group
+    class JobCounter {
+    public:
+        JobCounter() : m_pending(0), m_finishing(0) {}
+        ~JobCounter();
+
+        JobCounter(const JobCounter&) = delete;
+        JobCounter& operator=(const JobCounter&) = delete;
+
+        bool isDone() const {
+            return m_pending.load(std::memory_order_acquire) == 0 &&
+                   m_finishing.load(std::memory_order_acquire) == 0;
+        }
+        int getPending() const { return m_pending.load(std::memory_order_acquire); }
+
+    private:
+        friend class JobSystem;
+        std::atomic<int> m_pending;
+        std::atomic<int> m_finishing;
+        std::mutex m_continuationMutex;
+        std::vector<JobRecord*> m_continuations;
+    };
+
+    // Lock-free single-owner deque (Chase & Lev, with the C11 orderings of Le et al.)
+    class WorkStealingDeque {
+    public:
+        explicit WorkStealingDeque(int64_t capacity = 1024);
+        ~WorkStealingDeque();
+
+        WorkStealingDeque(const WorkStealingDeque&) = delete;
+        WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+        // Owner thread only
+        void push(JobRecord* job);
+        JobRecord* pop();
+
+        // Any thread
+        JobRecord* steal();
+        bool empty() const;
+
+    private:
+        struct Buffer {
+            int64_t capacity;
+            int64_t mask;
+            std::unique_ptr<std::atomic<JobRecord*>[]> slots;
+
+            explicit Buffer(int64_t size);
+            JobRecord* get(int64_t index) const { return slots[index & mask].load(std::memory_order_relaxed); }
+            void put(int64_t index, JobRecord* job) { slots[index & mask].store(job, std::memory_order_relaxed); }
+        };
+
+        std::atomic<int64_t> m_top;
+        std::atomic<int64_t> m_bottom;
+        std::atomic<Buffer*> m_buffer;
+        std::vector<std::unique_ptr<Buffer>> m_buffers; // Retired buffers stay alive for in-flight thieves
+    };
+
+    // Optional instrumentation; hooks are called on the thread that runs the job
+    struct JobProfilerHooks {
+        std::function<void(const char* jobName, int workerIndex)> onJobBegin;
+        std::function<void(const char* jobName, int workerIndex)> onJobEnd;
+    };
+
+    struct JobSystemStats {
+        uint64_t jobsExecuted;
+        uint64_t jobsStolen;
+        uint64_t ioJobsExecuted;
+        uint64_t workerSleeps;
+    };
+
+    class JobSystem {
+    public:
+        JobSystem();
+        ~JobSystem();
+
+        // Constructor for dependency injection
+        explicit JobSystem(unsigned int workerCount, unsigned int ioThreadCount = 1);
+
+        static JobSystem& getInstance();
+
+        // Method to create a new JobSystem instance for dependency injection
+        static std::unique_ptr<JobSystem> create(unsigned int workerCount = 0, unsigned int ioThreadCount = 1);
+
+        // Lifecycle (workerCount 0 = hardware threads minus the calling thread)
+        void initialize(unsigned int workerCount = 0, unsigned int ioThreadCount = 1);
+        void shutdown();
+        bool isRunning() const { return m_running; }
+        unsigned int getWorkerCount() const { return static_cast<unsigned int>(m_workers.size()); }
+        unsigned int getIOThreadCount() const { return static_cast<unsigned int>(m_ioThreads.size()); }
+
+        // Index of the calling worker thread, -1 for non-worker threads
+        int getCurrentWorkerIndex() const;
+
+        // Job submission
+        void run(Job job, JobCounter* counter = nullptr, const char* name = nullptr);
+        void wait(JobCounter& counter);
+
+        // Queues job once dependency reaches zero (immediately if it already has)
+        void runAfter(JobCounter& dependency, Job job, JobCounter* counter = nullptr, const char* name = nullptr);
+
+        // Runs job on a dedicated I/O thread, never on a compute worker
+        void runIO(Job job, JobCounter* counter = nullptr, const char* name = nullptr);
+
+        // Splits [0, count) into ranges and runs them in parallel. A grainSize of 0
+        // picks the grain from the worker count and lets idle workers split
+        // ranges further by stealing. Returns once every range has finished.
+        void parallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& body);
+
+        // Instrumentation
+        void setProfilerHooks(const JobProfilerHooks& hooks) { m_hooks = hooks; }
+        JobSystemStats getStats() const;
+        void resetStats();
+
+    private:
+        struct Worker {
+            WorkStealingDeque deque;
+            std::thread thread;
+            std::atomic<uint64_t> jobsExecuted{0};
+            std::atomic<uint64_t> jobsStolen{0};
+            std::atomic<uint64_t> sleeps{0};
+        };
+
+        std::vector<std::unique_ptr<Worker>> m_workers;
+        std::atomic<bool> m_running;
+        std::atomic<int> m_queuedJobs;
+
+        // Jobs submitted from non-worker threads
+        std::deque<JobRecord*> m_injectionQueue;
+        std::mutex m_injectionMutex;
+
+        // Sleeping workers
+        std::mutex m_sleepMutex;
+        std::condition_variable m_wakeCondition;
+
+        // Dedicated I/O threads
+        std::vector<std::thread> m_ioThreads;
+        std::deque<JobRecord*> m_ioQueue;
+        std::mutex m_ioMutex;
+        std::condition_variable m_ioCondition;
+        std::atomic<uint64_t> m_ioJobsExecuted;
+
+        JobProfilerHooks m_hooks;
+
+        void workerLoop(unsigned int workerIndex);
+        void ioLoop();
+        void submit(JobRecord* job);
+        JobRecord* findJob(int workerIndex);
+        JobRecord* takeInjected();
+        JobRecord* stealJob(int thiefIndex);
+        bool tryRunPendingJob();
+        void execute(JobRecord* job, int workerIndex);
+        void finishJob(JobCounter* counter);
+        void parallelForRange(size_t begin, size_t end, size_t grainSize,
+                              const std::function<void(size_t, size_t)>& body, JobCounter& counter);
+    };
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace Sparky {
+    /**
+     * @brief Fast LZ77 block compressor
+     *
+     * Uses the LZ4 block layout: each sequence is a token (literal length and
+     * match length nibbles), optional length extension bytes, the literals and
+     * a 16-bit match offset. Matches are found with a single-probe hash table,
+     * which trades ratio for speed - save data compresses 2-5x at several
+     * hundred MB/s. The uncompressed size is not stored; callers keep it.
+     */
+    class LZCompressor {
+    public:
+        // Appends the compressed form of [data, data + size) to output
+        static void compress(const char* data, size_t size, std::vector<char>& output);
+
+        // Appends exactly expectedSize decompressed bytes to output; on malformed
+        // input returns false and leaves output as it was
+        static bool decompress(const char* data, size_t size, size_t expectedSize, std::vector<char>& output);
+
+        // Worst-case compressed size for an input of the given size
+        static size_t maxCompressedSize(size_t size) { return size + size / 255 + 16; }
+    };
+}
@@ -56,6 +56,13 @@ namespace Sparky {
         EditorCameraSettings() : moveSpeed(5.0f), rotationSpeed(0.1f), zoomSpeed(1.0f), invertY(false) {}
     };
     
+    // World-space box touched by an edit, for systems that cache level data
+    // by area (navigation clusters, for example)
+    struct EditorChangeBounds {
+        float min[3];
+        float max[3];
+    };
+    
     // Object creation parameters
     struct ObjectCreationParams {
         std::string type;
@@ -168,6 +175,9 @@ namespace Sparky {
         void setOnLevelChangeCallback(std::function<void()> callback) { onLevelChangeCallback = callback; }
         void setOnSelectionChangeCallback(std::function<void()> callback) { onSelectionChangeCallback = callback; }
         void setOnObjectModifyCallback(std::function<void()> callback) { onObjectModifyCallback = callback; }
+        // Called with an object's bounds before and after every edit that moves,
+        // adds or removes it
+        void setOnAreaChangeCallback(std::function<void(const EditorChangeBounds&)> callback) { onAreaChangeCallback = callback; }
         
         // Utility functions
         void snapToGrid(float& x, float& y, float& z);
@@ -253,6 +263,7 @@ namespace Sparky {
         std::function<void()> onLevelChangeCallback;
         std::function<void()> onSelectionChangeCallback;
         std::function<void()> onObjectModifyCallback;
+        std::function<void(const EditorChangeBounds&)> onAreaChangeCallback;
         
         // Private helper methods
         void handleInput(float deltaTime);
@@ -268,6 +279,7 @@ namespace Sparky {
         
         // Action recording for undo/redo
         void recordAction(const EditorAction& action);
+        void notifyAreaChange(const LevelObject& object);
         void clearUndoStack();
         
         // Auto-save
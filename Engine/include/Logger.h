@@ -3,6 +3,7 @@
 #include <string>
 #include <iostream>
 #include <memory>
+#include <mutex>
 
 namespace Sparky {
     enum class LogLevel {
@@ -35,6 +36,7 @@ namespace Sparky {
 
     private:
         LogLevel currentLevel;
+        std::mutex logMutex; // Jobs on worker and I/O threads log too
         
         std::string levelToString(LogLevel level);
     };
@@ -28,6 +28,12 @@ namespace Sparky {
         std::vector<Vertex> vertices;
         std::vector<uint32_t> indices;
         
+        // Local space bounds for culling, from computeBounds()
+        glm::vec3 boundsMin;
+        glm::vec3 boundsMax;
+        glm::vec3 boundsCenter;
+        float boundsRadius;
+        
 #ifdef HAS_VULKAN
         // Vulkan resources
         VkBuffer vertexBuffer;
@@ -43,6 +49,9 @@ namespace Sparky {
         void cleanup(VkDevice device);
 #endif
         
+        // Recomputes the bounds from the vertices; the factories and loaders call it
+        void computeBounds();
+        
         // Factory methods for creating basic shapes
         static std::unique_ptr<Mesh> createCube(float size);
         static std::unique_ptr<Mesh> createPlane(float width, float height);
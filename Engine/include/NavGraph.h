@@ -0,0 +1,150 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace Sparky {
+    /**
+     * @brief Immutable navigation graph in compressed sparse row (CSR) layout
+     *
+     * Node data lives in parallel arrays and the outgoing edges of node i are
+     * m_edgeTargets[m_edgeOffsets[i] .. m_edgeOffsets[i + 1]), with the edge
+     * cost (length times the target node's cost multiplier) stored alongside.
+     * A search touches two flat arrays per expansion instead of chasing a hash
+     * map per neighbour.
+     */
+    class NavGraph {
+    public:
+        NavGraph();
+
+        struct Edge {
+            int from;
+            int to;
+        };
+
+        // Node multipliers <= 0 are treated as 1. Duplicate and invalid edges are dropped.
+        void build(const std::vector<glm::vec3>& positions, const std::vector<float>& costs,
+                   const std::vector<bool>& walkable, const std::vector<Edge>& edges);
+        void clear();
+
+        int getNodeCount() const { return static_cast<int>(m_positions.size()); }
+        size_t getEdgeCount() const { return m_edgeTargets.size(); }
+
+        const glm::vec3& getPosition(int node) const { return m_positions[node]; }
+        bool isWalkable(int node) const { return m_walkable[node] != 0; }
+        // Opens or blocks a node in place (dynamic obstacles); not safe during a search
+        void setWalkable(int node, bool walkable) { m_walkable[node] = walkable ? 1 : 0; }
+
+        uint32_t getEdgeBegin(int node) const { return m_edgeOffsets[node]; }
+        uint32_t getEdgeEnd(int node) const { return m_edgeOffsets[node + 1]; }
+        int getEdgeTarget(uint32_t edge) const { return m_edgeTargets[edge]; }
+        float getEdgeCost(uint32_t edge) const { return m_edgeCosts[edge]; }
+
+        // Admissible A* estimate: straight-line distance times the cheapest multiplier
+        float heuristic(int from, int to) const {
+            return glm::distance(m_positions[from], m_positions[to]) * m_minCostMultiplier;
+        }
+
+    private:
+        std::vector<glm::vec3> m_positions;
+        std::vector<uint8_t> m_walkable;
+        std::vector<uint32_t> m_edgeOffsets;
+        std::vector<int> m_edgeTargets;
+        std::vector<float> m_edgeCosts;
+        float m_minCostMultiplier;
+    };
+
+    /**
+     * @brief Uniform XZ grid over graph nodes for nearest-node queries
+     *
+     * Cells are stored CSR-style (cell start offsets plus a flat node list).
+     * A query searches rings of cells outward from the query cell and stops
+     * once the next ring cannot hold anything closer than the best node found.
+     */
+    class NavSpatialGrid {
+    public:
+        NavSpatialGrid();
+
+        // cellSize <= 0 picks a size that averages about two nodes per cell
+        void build(const NavGraph& graph, float cellSize = 0.0f);
+        void clear();
+
+        // Nearest walkable node, or -1 if there is none
+        int findNearest(const NavGraph& graph, const glm::vec3& position) const;
+
+    private:
+        glm::vec2 m_origin;
+        float m_cellSize;
+        float m_inverseCellSize;
+        int m_width;
+        int m_height;
+        std::vector<uint32_t> m_cellStart;
+        std::vector<int> m_cellNodes;
+
+        int cellX(float x) const;
+        int cellZ(float z) const;
+    };
+
+    struct PathSearchStats {
+        int nodesExpanded;
+        int nodesTouched;
+    };
+
+    /**
+     * @brief A* over a NavGraph with reusable scratch memory
+     *
+     * The open set is an indexed binary min-heap on f cost that supports
+     * decrease-key, so each node appears in it at most once. Per-node scratch
+     * (g cost, parent, heap slot, open/closed state) is stamped with a search
+     * generation: starting a search bumps the generation instead of clearing
+     * the arrays, and nothing is allocated once the arrays fit the graph.
+     *
+     * One searcher serves one thread; NavigationMesh keeps one per thread.
+     */
+    class AStarSearch {
+    public:
+        AStarSearch();
+
+        // Writes the node sequence from start to goal into path. Returns false if
+        // the goal is unreachable or either node is invalid or blocked.
+        bool findPath(const NavGraph& graph, int start, int goal, std::vector<int>& path);
+
+        // As findPath, but only through nodes whose nodeRegions entry equals region
+        bool findPathInRegion(const NavGraph& graph, int start, int goal, const std::vector<int>& nodeRegions,
+                              int region, std::vector<int>& path);
+
+        // Cost of the last path found
+        float getPathCost() const { return m_pathCost; }
+        const PathSearchStats& getLastStats() const { return m_stats; }
+
+    private:
+        struct NodeState {
+            uint32_t generation;
+            float gCost;
+            int parent;
+            int heapIndex; // -1 once the node is closed
+        };
+
+        struct HeapEntry {
+            float fCost;
+            int node;
+        };
+
+        std::vector<NodeState> m_nodes;
+        std::vector<HeapEntry> m_heap;
+        uint32_t m_generation;
+        float m_pathCost;
+        PathSearchStats m_stats;
+
+        template <typename NodeFilter>
+        bool search(const NavGraph& graph, int start, int goal, std::vector<int>& path, NodeFilter allowed);
+        void prepare(int nodeCount);
+        void heapPush(int node, float fCost);
+        int heapPop();
+        void heapDecrease(int node, float fCost);
+        void siftUp(int index);
+        void siftDown(int index);
+    };
+}
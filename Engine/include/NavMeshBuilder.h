@@ -0,0 +1,104 @@
+#pragma once
+
+#include "NavPolyMesh.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Sparky {
+    struct Mesh;
+    class Scene;
+    class JobSystem;
+
+    // Navmesh generation settings. Distances are in world units, the slope in degrees.
+    struct NavMeshBuildConfig {
+        float cellSize;             // Voxel size on X and Z
+        float cellHeight;           // Voxel size on Y
+        float agentHeight;          // Minimum clearance above walkable ground
+        float agentRadius;          // Walkable area is eroded by this much
+        float agentMaxClimb;        // Largest step the agent walks up
+        float agentMaxSlope;        // Steepest walkable surface
+        int minRegionArea;          // Islands smaller than this many cells are dropped
+        float maxEdgeError;         // How far simplified wall edges may stray from the voxels
+        int maxVertsPerPoly;        // At most NavPoly::MAX_VERTS
+        float detailSampleDistance; // Height sample spacing for the detail mesh, 0 disables
+        float detailSampleMaxError; // Height error that makes a sample part of the detail mesh
+
+        NavMeshBuildConfig()
+            : cellSize(0.3f), cellHeight(0.2f), agentHeight(2.0f), agentRadius(0.6f),
+              agentMaxClimb(0.9f), agentMaxSlope(45.0f), minRegionArea(8), maxEdgeError(0.4f),
+              maxVertsPerPoly(6), detailSampleDistance(1.8f), detailSampleMaxError(0.3f) {}
+    };
+
+    struct NavMeshBuildStats {
+        int gridWidth;
+        int gridHeight;
+        size_t triangleCount;
+        size_t spanCount;
+        int regionCount;
+        int polyCount;
+        size_t detailTriangleCount;
+        bool loadedFromCache;
+
+        // Stage timings in milliseconds
+        double rasterizeMs;
+        double filterMs;
+        double regionMs;
+        double contourMs;
+        double polyMs;
+        double detailMs;
+        double totalMs;
+    };
+
+    /**
+     * @brief Builds a NavPolyMesh from level triangles, Recast style
+     *
+     * The pipeline voxelizes the input into a heightfield, filters out spans
+     * the agent cannot stand on (steep, low ceilings, ledges, too close to a
+     * wall), partitions what is left into monotone regions, traces and
+     * simplifies each region's outline and triangulates it into convex
+     * polygons, then samples the heightfield for a per-polygon detail mesh.
+     * Input is treated as surfaces, not solids: the floor inside a closed box
+     * with enough head room stays walkable, as an island of its own.
+     *
+     * Every stage except erosion and region partitioning is split across the
+     * JobSystem by rows, regions or polygons, and the output does not depend
+     * on the worker count.
+     */
+    class NavMeshBuilder {
+    public:
+        NavMeshBuilder();
+
+        // nullptr uses JobSystem::getInstance()
+        void setJobSystem(JobSystem* jobSystem) { m_jobSystem = jobSystem; }
+
+        // Input geometry. addTriangles expects counter-clockwise winding seen from
+        // above for upward-facing surfaces; addMesh orients each triangle from its
+        // vertex normals, so engine meshes can be added as they are.
+        void addTriangles(const std::vector<glm::vec3>& vertices, const std::vector<uint32_t>& indices);
+        void addMesh(const Mesh& mesh, const glm::mat4& transform);
+        void addScene(const Scene& scene);
+        void clearGeometry();
+        size_t getTriangleCount() const { return m_indices.size() / 3; }
+
+        // Builds a mesh from the current geometry, or nullptr if nothing is walkable
+        std::shared_ptr<NavPolyMesh> build(const NavMeshBuildConfig& config);
+
+        // Loads cachePath if it was built from the same geometry and config,
+        // otherwise builds and writes the result to cachePath
+        std::shared_ptr<NavPolyMesh> buildCached(const NavMeshBuildConfig& config, const std::string& cachePath);
+
+        // Identifies geometry plus config; stored in the mesh as its source hash
+        uint64_t computeInputHash(const NavMeshBuildConfig& config) const;
+
+        const NavMeshBuildStats& getStats() const { return m_stats; }
+
+    private:
+        JobSystem* m_jobSystem;
+        std::vector<glm::vec3> m_vertices;
+        std::vector<uint32_t> m_indices;
+        NavMeshBuildStats m_stats;
+    };
+}
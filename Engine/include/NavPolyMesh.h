@@ -0,0 +1,93 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Sparky {
+    class SaveArchive;
+
+    // Convex walkable polygon. Vertices have positive signed area in the XZ
+    // plane (sum of x[i] * z[i + 1] - x[i + 1] * z[i]), which is clockwise seen
+    // from above like the engine's meshes. neighbors[i] is the polygon across
+    // edge verts[i] -> verts[i + 1], or -1 on a wall.
+    struct NavPoly {
+        static constexpr int MAX_VERTS = 6;
+
+        uint8_t vertCount;
+        uint16_t region;
+        int verts[MAX_VERTS];
+        int neighbors[MAX_VERTS];
+        uint32_t detailTriangleStart;
+        uint32_t detailTriangleCount;
+    };
+
+    /**
+     * @brief Polygon navigation mesh produced by NavMeshBuilder
+     *
+     * The polygons give connectivity and the path corridor; the detail mesh
+     * (a small triangulation per polygon) gives the surface height inside
+     * each polygon. A uniform grid over polygon bounds makes point location
+     * independent of mesh size.
+     */
+    class NavPolyMesh {
+    public:
+        NavPolyMesh();
+
+        int getPolyCount() const { return static_cast<int>(m_polys.size()); }
+        const NavPoly& getPoly(int poly) const { return m_polys[poly]; }
+        size_t getVertexCount() const { return m_vertices.size(); }
+        const glm::vec3& getVertex(int vertex) const { return m_vertices[vertex]; }
+        const std::vector<glm::vec3>& getDetailVertices() const { return m_detailVertices; }
+        const std::vector<uint32_t>& getDetailTriangles() const { return m_detailTriangles; }
+        glm::vec3 getPolyCenter(int poly) const;
+
+        // Point queries (XZ containment, detail-mesh height)
+        bool containsPoint(int poly, const glm::vec3& position) const;
+        bool getPolyHeight(int poly, const glm::vec3& position, float& height) const;
+        glm::vec3 closestPointOnPoly(int poly, const glm::vec3& position) const;
+
+        // Polygon under position (closest in height if several overlap), else the
+        // closest polygon within searchRadius, else -1
+        int findPoly(const glm::vec3& position, float searchRadius = 2.0f) const;
+
+        // Shared edge between two neighbouring polygons, as seen moving from -> to
+        bool getPortal(int from, int to, glm::vec3& left, glm::vec3& right) const;
+
+        // Funnel (string pulling) over a polygon corridor from start to end.
+        // start and end should lie in the first and last corridor polygons.
+        void findStraightPath(const glm::vec3& start, const glm::vec3& end, const std::vector<int>& corridor,
+                              std::vector<glm::vec3>& path) const;
+
+        // Identifies the input the mesh was built from, for cache validation
+        void setSourceHash(uint64_t hash) { m_sourceHash = hash; }
+        uint64_t getSourceHash() const { return m_sourceHash; }
+
+        // Storage, as a SaveArchive chunk
+        void writeTo(SaveArchive& archive) const;
+        bool readFrom(const SaveArchive& archive);
+        bool saveToFile(const std::string& filepath) const;
+        bool loadFromFile(const std::string& filepath);
+
+        // Rebuilds the point-location grid; call after filling the mesh
+        void buildSearchIndex();
+
+    private:
+        friend class NavMeshBuilder;
+
+        std::vector<glm::vec3> m_vertices;
+        std::vector<NavPoly> m_polys;
+        std::vector<glm::vec3> m_detailVertices;
+        std::vector<uint32_t> m_detailTriangles; // Three detail vertex indices per triangle
+        uint64_t m_sourceHash;
+
+        // Point-location grid over polygon XZ bounds (CSR cell lists)
+        glm::vec2 m_gridOrigin;
+        float m_gridCellSize;
+        int m_gridWidth;
+        int m_gridHeight;
+        std::vector<uint32_t> m_gridCellStart;
+        std::vector<int> m_gridPolys;
+    };
+}
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+namespace Sparky {
+    class NavigationMesh;
+    class JobSystem;
+    class JobCounter;
+
+    using PathTicket = uint32_t;
+    constexpr PathTicket INVALID_PATH_TICKET = 0;
+
+    enum class PathQueryStatus {
+        PENDING,    // Queued or being searched
+        READY,      // Path found, collect it with takeResult()
+        FAILED,     // No path between start and end
+        UNKNOWN     // Never issued, cancelled or already taken
+    };
+
+    enum class PathQueryPriority {
+        LOW,
+        NORMAL,
+        HIGH
+    };
+
+    enum class PathQueryMode {
+        WORKER_THREADS, // Searches run as JobSystem jobs
+        TIME_SLICED     // Searches run inside update() until the frame budget is spent
+    };
+
+    struct PathQuerySettings {
+        PathQueryMode mode;
+        float frameBudgetMs;        // Main thread time per update() in TIME_SLICED mode
+        int maxConcurrentQueries;   // Searches in flight at once in WORKER_THREADS mode
+        size_t cacheCapacity;       // Recent results kept for reuse, 0 disables the cache
+        float cellSize;             // Starts and ends in the same cell share a search
+
+        PathQuerySettings()
+            : mode(PathQueryMode::WORKER_THREADS), frameBudgetMs(1.0f), maxConcurrentQueries(4),
+              cacheCapacity(128), cellSize(0.5f) {}
+    };
+
+    struct PathQueryStats {
+        size_t queueDepth;          // Searches waiting to start
+        size_t peakQueueDepth;
+        size_t inFlight;            // Searches running on workers
+        uint64_t submitted;
+        uint64_t deduplicated;      // Tickets that joined a search already queued or running
+        uint64_t cacheHits;
+        uint64_t completed;         // Searches finished, one per shared search
+        uint64_t failed;
+        uint64_t cancelled;
+        double averageLatencyMs;    // Submit to result, per ticket
+        double maxLatencyMs;
+        double lastUpdateMs;        // Main thread time spent in the last update()
+    };
+
+    /**
+     * @brief Asynchronous path queries for AI agents
+     *
+     * Agents submit a start and end and get a ticket back instead of searching
+     * inside their own update. Requests whose start and end fall in the same
+     * cells are merged into one search, and a small LRU cache of recent
+     * results answers repeats without searching at all. Queued searches run in
+     * priority order, oldest first, either as jobs on the JobSystem or on the
+     * main thread within a per-frame millisecond budget.
+     *
+     * Searches read the NavigationMesh from worker threads, so call flush()
+     * before editing the mesh; only setNodeWalkable() may run while searches
+     * are in flight. Edits bump the mesh revision, which retires cached
+     * results.
+     */
+    class PathQueryService {
+    public:
+        // Constructor for dependency injection
+        explicit PathQueryService(NavigationMesh* navMesh, const PathQuerySettings& settings = PathQuerySettings());
+        ~PathQueryService();
+
+        PathQueryService(const PathQueryService&) = delete;
+        PathQueryService& operator=(const PathQueryService&) = delete;
+
+        // Method to create a new PathQueryService instance for dependency injection
+        static std::unique_ptr<PathQueryService> create(NavigationMesh* navMesh,
+                                                        const PathQuerySettings& settings = PathQuerySettings());
+
+        // nullptr uses JobSystem::getInstance(). Without workers, WORKER_THREADS
+        // mode falls back to time slicing.
+        void setJobSystem(JobSystem* jobSystem) { m_jobSystem = jobSystem; }
+        const PathQuerySettings& getSettings() const { return m_settings; }
+
+        // Requests
+        PathTicket submit(const glm::vec3& start, const glm::vec3& end,
+                          PathQueryPriority priority = PathQueryPriority::NORMAL);
+        PathQueryStatus getStatus(PathTicket ticket) const;
+        // Moves the path out and releases the ticket. Returns false while the
+        // query is pending; a failed query releases the ticket with an empty path.
+        bool takeResult(PathTicket ticket, std::vector<glm::vec3>& path);
+        void cancel(PathTicket ticket);
+
+        // Starts queued searches; call once per frame from the main thread
+        void update();
+        // Finishes every queued and running search
+        void flush();
+        void invalidateCache();
+
+        PathQueryStats getStats() const;
+        void resetStats();
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        // Start and end quantized to cells
+        struct CellKey {
+            int32_t cells[6];
+
+            bool operator==(const CellKey& other) const;
+        };
+
+        struct CellKeyHash {
+            size_t operator()(const CellKey& key) const;
+        };
+
+        struct Request {
+            glm::vec3 start;
+            glm::vec3 end;
+            PathQueryPriority priority;
+            uint64_t sequence;
+            uint32_t revision;
+            bool dispatched;
+            std::vector<PathTicket> tickets;
+        };
+
+        struct TicketState {
+            PathQueryStatus status;
+            glm::vec3 start;
+            glm::vec3 end;
+            CellKey key;
+            Clock::time_point submitTime;
+            std::vector<glm::vec3> path;
+        };
+
+        // Heap entry; stale when the request was dropped, started or re-prioritized
+        struct QueueEntry {
+            PathQueryPriority priority;
+            uint64_t sequence;
+            CellKey key;
+
+            bool operator<(const QueueEntry& other) const;
+        };
+
+        struct CacheEntry {
+            CellKey key;
+            glm::vec3 start;
+            glm::vec3 end;
+            uint32_t revision;
+            std::vector<glm::vec3> path;
+        };
+
+        NavigationMesh* m_navMesh;
+        JobSystem* m_jobSystem;
+        PathQuerySettings m_settings;
+
+        mutable std::mutex m_mutex;
+        PathTicket m_nextTicket;
+        uint64_t m_nextSequence;
+        std::unordered_map<PathTicket, TicketState> m_tickets;
+        std::unordered_map<CellKey, Request, CellKeyHash> m_requests;
+        std::priority_queue<QueueEntry> m_queue;
+        size_t m_queuedCount;
+        size_t m_inFlight;
+        std::unique_ptr<JobCounter> m_jobCounter;
+
+        // LRU: most recent at the front
+        std::list<CacheEntry> m_cache;
+        std::unordered_map<CellKey, std::list<CacheEntry>::iterator, CellKeyHash> m_cacheIndex;
+
+        PathQueryStats m_stats;
+        double m_totalLatencyMs;
+        uint64_t m_latencySamples;
+
+        CellKey makeKey(const glm::vec3& start, const glm::vec3& end) const;
+        bool popRequest(CellKey& key);
+        void runSearch(const CellKey& key);
+        void completeRequest(const CellKey& key, std::vector<glm::vec3>& path);
+        void deliver(TicketState& state, const glm::vec3& start, const glm::vec3& end,
+                     const std::vector<glm::vec3>& path, Clock::time_point now);
+        bool lookupCache(const CellKey& key, uint32_t revision, CacheEntry*& entry);
+        void storeCache(const CellKey& key, const Request& request, const std::vector<glm::vec3>& path);
+        JobSystem& getJobSystem() const;
+    };
+}
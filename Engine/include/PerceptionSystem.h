@@ -0,0 +1,160 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Sparky {
+    class GameObject;
+    class JobSystem;
+    class StaticBVH;
+
+    using PerceptionObserverId = int32_t;
+    using PerceptionTargetId = int32_t;
+    constexpr PerceptionObserverId INVALID_PERCEPTION_OBSERVER = -1;
+    constexpr PerceptionTargetId INVALID_PERCEPTION_TARGET = -1;
+
+    // How often an observer's sight is refreshed
+    enum class PerceptionPriority {
+        HIGH,       // Every frame (engaged, on screen)
+        NORMAL,
+        LOW         // Distant or idle
+    };
+
+    struct PerceptionSettings {
+        float cellSize;         // Target grid cell edge in the XZ plane
+        int normalInterval;     // Frames between updates for NORMAL observers
+        int lowInterval;        // Frames between updates for LOW observers
+        float eyeHeight;        // Added to observer positions for line-of-sight rays
+        float targetHeight;     // Added to target positions for line-of-sight rays
+
+        PerceptionSettings()
+            : cellSize(16.0f), normalInterval(3), lowInterval(8), eyeHeight(1.6f), targetHeight(1.0f) {}
+    };
+
+    struct PerceptionStats {
+        int observersUpdated;   // Observers whose turn it was this frame
+        size_t candidatePairs;  // Targets found in the grid cells around them
+        size_t conePairs;       // Of those, inside range and field of view
+        size_t occludedPairs;   // Of those, blocked by static geometry
+        double gridMs;
+        double cullMs;
+        double raycastMs;
+    };
+
+    /**
+     * @brief Batched line-of-sight for many observers
+     *
+     * Answers "which targets can each AI see" for the whole level at once.
+     * update() buckets targets into a uniform XZ grid, and each observer due
+     * this frame only looks at the cells its vision range overlaps. Those
+     * candidates go through a range and field-of-view cone test four at a
+     * time with SSE (a scalar loop elsewhere), and the survivors become one
+     * batch of line-of-sight segments tested against the static geometry BVH.
+     *
+     * Observers are refreshed every frame, or every few frames according to
+     * their priority, staggered by id so the work spreads evenly over frames.
+     * Between refreshes the last visible set is kept.
+     *
+     * Targets that carry a GameObject read its position at the start of
+     * update(); others are moved with setTargetPosition(). Nothing here is
+     * thread-safe except that update() itself runs on the JobSystem.
+     */
+    class PerceptionSystem {
+    public:
+        PerceptionSystem();
+
+        // Constructor for dependency injection
+        explicit PerceptionSystem(const PerceptionSettings& settings);
+
+        // Method to create a new PerceptionSystem instance for dependency injection
+        static std::unique_ptr<PerceptionSystem> create(const PerceptionSettings& settings = PerceptionSettings());
+
+        void setJobSystem(JobSystem* jobSystem) { m_jobSystem = jobSystem; }
+
+        // Occluders for line of sight; nullptr sees through everything
+        void setOccluders(const StaticBVH* occluders) { m_occluders = occluders; }
+
+        // Observers. Forward must be normalized; FOV is the full cone angle in degrees.
+        PerceptionObserverId addObserver(const glm::vec3& position, const glm::vec3& forward, float range,
+                                         float fieldOfView, PerceptionPriority priority = PerceptionPriority::NORMAL,
+                                         GameObject* object = nullptr);
+        void removeObserver(PerceptionObserverId observer);
+        void setObserverTransform(PerceptionObserverId observer, const glm::vec3& position, const glm::vec3& forward);
+        void setObserverVision(PerceptionObserverId observer, float range, float fieldOfView);
+        void setObserverPriority(PerceptionObserverId observer, PerceptionPriority priority);
+        int getObserverCount() const { return m_observerCount; }
+
+        // Targets. An observer never sees a target carrying its own object.
+        PerceptionTargetId addTarget(const glm::vec3& position, GameObject* object = nullptr);
+        void removeTarget(PerceptionTargetId target);
+        void setTargetPosition(PerceptionTargetId target, const glm::vec3& position);
+        int getTargetCount() const { return m_targetCount; }
+
+        // Refreshes the observers whose turn it is
+        void update();
+
+        // Targets seen at the observer's last refresh, in id order
+        const std::vector<PerceptionTargetId>& getVisibleTargets(PerceptionObserverId observer) const;
+        bool canSee(PerceptionObserverId observer, PerceptionTargetId target) const;
+        bool canSee(PerceptionObserverId observer, const GameObject* object) const;
+        GameObject* getTargetObject(PerceptionTargetId target) const { return m_targetObject[target]; }
+
+        const PerceptionStats& getStats() const { return m_stats; }
+
+    private:
+        struct Batch {
+            std::vector<int> observers;
+            std::vector<int> pairObserver;
+            std::vector<int> pairTarget;
+            size_t candidates;
+        };
+
+        PerceptionSettings m_settings;
+        JobSystem* m_jobSystem;
+        const StaticBVH* m_occluders;
+        uint32_t m_frame;
+
+        // Observer slots
+        std::vector<glm::vec3> m_observerPosition;
+        std::vector<glm::vec3> m_observerForward;
+        std::vector<float> m_observerRange;
+        std::vector<float> m_observerCosHalfFov;
+        std::vector<PerceptionPriority> m_observerPriority;
+        std::vector<GameObject*> m_observerObject;
+        std::vector<uint8_t> m_observerActive;
+        std::vector<std::vector<PerceptionTargetId>> m_visible;
+        std::vector<int> m_freeObservers;
+        int m_observerCount;
+
+        // Target slots
+        std::vector<glm::vec3> m_targetPosition;
+        std::vector<GameObject*> m_targetObject;
+        std::vector<uint8_t> m_targetActive;
+        std::vector<int> m_freeTargets;
+        int m_targetCount;
+
+        // Uniform grid (CSR over cells) with targets copied out per axis in cell order
+        glm::vec2 m_gridOrigin;
+        float m_cellSize;
+        int m_gridWidth;
+        int m_gridHeight;
+        std::vector<uint32_t> m_cellStart;
+        std::vector<float> m_cellX;
+        std::vector<float> m_cellY;
+        std::vector<float> m_cellZ;
+        std::vector<int> m_cellTarget;
+
+        std::vector<Batch> m_batches;
+        std::vector<glm::vec3> m_rayFrom;
+        std::vector<glm::vec3> m_rayTo;
+        std::vector<uint8_t> m_rayOccluded;
+
+        PerceptionStats m_stats;
+
+        int getInterval(PerceptionPriority priority) const;
+        void rebuildGrid();
+        void cullObserver(int observer, Batch& batch) const;
+    };
+}
@@ -1,16 +1,19 @@
 #pragma once
 
 #include "Component.h"
+#include "SnapshotSerializable.h"
 #include <glm/glm.hpp>
 
 namespace Sparky {
-    class PhysicsComponent : public Component {
+    class PhysicsComponent : public Component, public SnapshotSerializable {
     public:
         PhysicsComponent();
         virtual ~PhysicsComponent();
 
         void update(float deltaTime) override;
         void render() override;
+        UpdatePhase getUpdatePhase() const override { return UpdatePhase::PHYSICS; }
+        bool supportsParallelUpdate() const override { return true; }
 
         // Physics properties
         void setVelocity(const glm::vec3& velocity);
@@ -27,6 +30,12 @@ namespace Sparky {
         void setOnGround(bool onGround);
         bool isOnGround() const { return onGround; }
 
+        // Snapshot serialization
+        static constexpr const char* SnapshotTypeName = "PhysicsComponent";
+        const char* getSnapshotTypeName() const override { return SnapshotTypeName; }
+        void serialize(BinaryWriter& writer) const override;
+        bool deserialize(BinaryReader& reader, uint16_t version) override;
+
     private:
         glm::vec3 velocity;
         glm::vec3 acceleration;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "StaticBVH.h"
 #include <vector>
 #include <memory>
 #include <glm/glm.hpp>
@@ -65,10 +66,16 @@ namespace Sparky {
         void addRigidBody(RigidBodyComponent* rigidBody);
         void removeRigidBody(RigidBodyComponent* rigidBody);
 
+        // Level geometry that never moves; kept in a BVH rebuilt on the next query
+        int addStaticCollider(const glm::vec3& minBounds, const glm::vec3& maxBounds, GameObject* object = nullptr);
+        void clearStaticColliders();
+        const StaticBVH& getStaticGeometry();
+
         void update(float deltaTime);
         void setGravity(const glm::vec3& gravity);
 
-        // Collision detection
+        // Collision detection. Rays hit static colliders and the boxes of
+        // physics components' owners; direction should be normalized.
         RaycastHit raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance);
         std::vector<CollisionData> detectCollisions();
         bool checkCollision(PhysicsComponent* componentA, PhysicsComponent* componentB);
@@ -88,6 +95,7 @@ namespace Sparky {
         std::vector<PhysicsComponent*> components;
         std::vector<RigidBodyComponent*> rigidBodies;
         glm::vec3 gravity;
+        StaticBVH staticGeometry;
         
         // Broadphase collision optimization
         std::vector<std::pair<PhysicsComponent*, PhysicsComponent*>> broadphasePairs;
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "AnimationSampler.h"
+#include "Mesh.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace Sparky {
+    // Pose kernels. Poses are indexed by bone id and must all have the same bone count;
+    // result may alias an input. Rotations blend with a shortest-path normalized lerp.
+    void blendPoses(const AnimationPose& from, const AnimationPose& to, float weight, AnimationPose& result);
+
+    // The difference that takes reference to pose, for use as an additive layer
+    void makeAdditivePose(const AnimationPose& pose, const AnimationPose& reference, AnimationPose& additive);
+
+    // base with weight of an additive layer on top: translations add, rotations multiply
+    // on the right, scales multiply
+    void applyAdditivePose(const AnimationPose& base, const AnimationPose& additive, float weight, AnimationPose& result);
+
+    // Up to four bone influences per vertex; weights should sum to one
+    struct VertexSkin {
+        uint16_t bones[4];
+        float weights[4];
+    };
+
+    /**
+     * @brief Bone hierarchy and bind pose for turning local poses into skinning matrices
+     *
+     * Bones are visited in an order where every parent comes before its
+     * children, worked out once in build(), so concatenating local
+     * transforms into model space is one pass with no recursion. When bone
+     * ids already list parents first the order is just the ids and the pass
+     * streams through memory.
+     */
+    class AnimationSkeleton {
+    public:
+        AnimationSkeleton();
+
+        // parents holds each bone's parent id (or -1) and inverseBindPose each bone's
+        // model-to-bone matrix, both indexed by bone id. A parent that is out of range or
+        // part of a cycle is treated as -1.
+        void build(const std::vector<int>& parents, const std::vector<glm::mat4>& inverseBindPose);
+
+        int getBoneCount() const { return static_cast<int>(m_parents.size()); }
+        const std::vector<int>& getParents() const { return m_parents; }
+        const std::vector<int>& getOrder() const { return m_order; }
+
+        // Model-space transform of every bone from a local pose
+        void computeModelTransforms(const AnimationPose& local, std::vector<glm::mat4>& model) const;
+
+        // model * inverse bind pose, ready for skinning
+        void computeSkinningMatrices(const std::vector<glm::mat4>& model, std::vector<glm::mat4>& skinning) const;
+
+    private:
+        std::vector<int> m_parents;
+        std::vector<int> m_order;
+        std::vector<glm::mat4> m_inverseBindPose;
+    };
+
+    // CPU linear blend skinning, for running without a GPU. Positions, normals, tangents and
+    // bitangents of bindVertices are transformed into skinned; the rest is copied.
+    void skinVertices(const std::vector<Vertex>& bindVertices, const std::vector<VertexSkin>& skin,
+                      const std::vector<glm::mat4>& skinning, std::vector<Vertex>& skinned);
+}
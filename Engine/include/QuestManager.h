@@ -42,5 +42,7 @@ namespace Sparky {
         ~QuestManager();
 
         std::unordered_map<std::string, std::unique_ptr<Quest>> quests;
+
+        bool readArchive(const std::vector<char>& data);
     };
 }
\ No newline at end of file
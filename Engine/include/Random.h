@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+namespace Sparky {
+    /**
+     * @brief Seedable gameplay random number generator
+     *
+     * All simulation randomness should come from here so a run can be replayed
+     * from its seed (see ReplayRecorder). The generator is xorshift64*: tiny
+     * state, fast, and bit-identical on every platform, unlike the std
+     * distributions whose output is implementation-defined.
+     *
+     * Not thread-safe. Use it from main-thread update code; components that
+     * opt into parallel update must not draw from the shared instance.
+     */
+    class Random {
+    public:
+        static Random& getInstance();
+
+        // Method to create a new Random instance for dependency injection
+        static std::unique_ptr<Random> create(uint64_t seed);
+
+        Random();
+        // Constructor for dependency injection
+        explicit Random(uint64_t seed);
+
+        // Restarts the sequence; counted so recorders can notice reseeds
+        void setSeed(uint64_t seed);
+        uint64_t getSeed() const { return m_seed; }
+        uint32_t getReseedCount() const { return m_reseedCount; }
+
+        // Full generator state, for restoring a run mid-sequence
+        uint64_t getState() const { return m_state; }
+        void setState(uint64_t state) { m_state = state != 0 ? state : kDefaultSeed; }
+
+        uint64_t nextU64();
+        uint32_t nextU32() { return static_cast<uint32_t>(nextU64() >> 32); }
+
+        // Uniform in [0, 1)
+        float nextFloat() { return static_cast<float>(nextU32() >> 8) * (1.0f / 16777216.0f); }
+        // Uniform in [min, max)
+        float range(float min, float max) { return min + (max - min) * nextFloat(); }
+        // Uniform integer in [min, max)
+        int rangeInt(int min, int max);
+
+    private:
+        static constexpr uint64_t kDefaultSeed = 0x9E3779B97F4A7C15ull;
+
+        uint64_t m_seed;
+        uint64_t m_state;
+        uint32_t m_reseedCount;
+    };
+}
@@ -3,6 +3,7 @@
 #include "Component.h"
 #include "Mesh.h"
 #include "Material.h"
+#include "RenderQueue.h"
 #include <memory>
 
 #ifdef HAS_GLFW
@@ -17,6 +18,8 @@ namespace Sparky {
 
         void update(float deltaTime) override;
         void render() override;
+        UpdatePhase getUpdatePhase() const override { return UpdatePhase::RENDER_PREP; }
+        bool supportsParallelUpdate() const override { return true; }
 
         // Mesh management
         void setMesh(std::unique_ptr<Mesh> mesh);
@@ -30,6 +33,10 @@ namespace Sparky {
         bool isVisible() const { return visible; }
         void setVisible(bool vis) { visible = vis; }
         
+        // Decides draw order; see RenderQueue
+        void setRenderLayer(RenderLayer layer);
+        RenderLayer getRenderLayer() const { return renderLayer; }
+        
         // Vulkan-specific methods
 #ifdef HAS_GLFW
         void createVertexBuffer(VkPhysicalDevice physicalDevice, VkDevice device, VkCommandPool commandPool, VkQueue graphicsQueue);
@@ -41,5 +48,6 @@ namespace Sparky {
         std::unique_ptr<Mesh> mesh;
         std::unique_ptr<Material> material;
         bool visible;
+        RenderLayer renderLayer;
     };
 }
\ No newline at end of file
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace Sparky {
+    class GameObject;
+    class Material;
+    struct Mesh;
+
+    // Layers draw in this order
+    enum class RenderLayer : uint8_t {
+        BACKGROUND,
+        OPAQUE_GEOMETRY,        // Front to back, so hidden pixels fail the depth test early
+        TRANSPARENT_GEOMETRY,   // Back to front, so blending composes correctly
+        OVERLAY                 // Back to front
+    };
+
+    // Binds a draw needs because its state differs from the draw before it
+    enum RenderStateChange : uint8_t {
+        RENDER_CHANGE_PIPELINE = 1 << 0,
+        RENDER_CHANGE_MATERIAL = 1 << 1,
+        RENDER_CHANGE_MESH = 1 << 2     // Vertex buffer, and index buffer when the mesh has indices
+    };
+
+    // What an object draws with. Ids only order the sort; binds compare the pointers.
+    struct RenderItem {
+        GameObject* object;
+        const Mesh* mesh;
+        const Material* material;
+        uint32_t pipeline;
+        uint32_t meshId;
+        uint32_t materialId;
+        RenderLayer layer;
+    };
+
+    struct RenderDraw {
+        uint64_t key;
+        RenderItem item;
+        uint8_t changes;        // RenderStateChange bits
+    };
+
+    // Consecutive draws with the same pipeline, material and mesh, issued as one instanced draw.
+    // Instance data is laid out in draw order, so the first draw is also the first instance.
+    struct RenderBatch {
+        uint32_t firstDraw;
+        uint32_t drawCount;
+    };
+
+    struct RenderQueueStats {
+        int draws = 0;
+        int pipelineBinds = 0;
+        int materialBinds = 0;
+        int vertexBufferBinds = 0;
+        int indexBufferBinds = 0;
+        int stateChanges = 0;       // Draws preceded by at least one bind
+        int unsortedBinds = 0;      // Binds the same draws would need in the order they were added
+        int sortPasses = 0;         // Radix passes run; bytes every key shares are skipped
+        int batches = 0;            // Instanced draws the batched draws need
+        int collapsedDraws = 0;     // Draws folded into the batch before them
+
+        int getBinds() const { return pipelineBinds + materialBinds + vertexBufferBinds + indexBufferBinds; }
+    };
+
+    /**
+     * @brief Per-frame list of draws, sorted to minimize state changes
+     *
+     * Each draw gets a 64-bit key. Opaque layers sort by pipeline, then
+     * material, then mesh, then depth front to back; transparent layers
+     * sort by depth back to front first and by state only among draws at
+     * the same depth:
+     *
+     *     opaque:       layer:2 | pipeline:8 | material:16 | mesh:16 | depth:22
+     *     transparent:  layer:2 | far-to-near depth:22 | pipeline:8 | material:16 | mesh:16
+     *
+     * sort() radix sorts the keys a byte at a time into scratch buffers
+     * that persist between frames, then marks the binds each draw needs so
+     * command recording can skip the rest. Runs of draws that need no binds
+     * between them are grouped into batches for instanced drawing.
+     */
+    class RenderQueue {
+    public:
+        RenderQueue();
+
+        // Depth is the distance along forward from eye, quantized over [0, farDistance]
+        void begin(const glm::vec3& eye, const glm::vec3& forward, float farDistance);
+        void add(const RenderItem& item, const glm::vec3& center);
+        void sort();
+
+        const std::vector<RenderDraw>& getDraws() const { return m_draws; }
+        const std::vector<RenderBatch>& getBatches() const { return m_batches; }
+        const RenderQueueStats& getStats() const { return m_stats; }
+
+        // Small ids for the sort keys. A mesh or material keeps its id while
+        // anything holds it; the last release frees the id for reuse, so the
+        // tables only hold live resources and a freed address never keeps an
+        // old id. More than 65536 live ids at once do not fit the key.
+        uint32_t acquireMeshId(const Mesh* mesh);
+        void releaseMeshId(const Mesh* mesh);
+        uint32_t acquireMaterialId(const Material* material);
+        void releaseMaterialId(const Material* material);
+        // Drops every id, for when all holders are dropped at once
+        void clearIds();
+        size_t getMeshIdCount() const { return m_meshIds.entries.size(); }
+        size_t getMaterialIdCount() const { return m_materialIds.entries.size(); }
+
+        static uint64_t makeKey(RenderLayer layer, uint32_t pipeline, uint32_t materialId, uint32_t meshId, float depth);
+
+    private:
+        struct SortEntry {
+            uint64_t key;
+            uint32_t item;
+        };
+
+        glm::vec3 m_eye;
+        glm::vec3 m_forward;
+        float m_depthScale;
+
+        std::vector<RenderItem> m_items;
+        std::vector<uint64_t> m_keys;
+        std::vector<SortEntry> m_sort;
+        std::vector<SortEntry> m_scratch;
+        std::vector<RenderDraw> m_draws;
+        std::vector<RenderBatch> m_batches;
+        RenderQueueStats m_stats;
+
+        // Pointer to id, with how many holders it has
+        struct IdTable {
+            struct Entry {
+                uint32_t id;
+                uint32_t holders;
+            };
+            std::unordered_map<const void*, Entry> entries;
+            std::vector<uint32_t> freeIds;
+            uint32_t nextId = 0;
+
+            uint32_t acquire(const void* resource);
+            void release(const void* resource);
+            void clear();
+        };
+
+        IdTable m_meshIds;
+        IdTable m_materialIds;
+
+        void radixSort();
+    };
+}
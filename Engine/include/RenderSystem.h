@@ -4,6 +4,8 @@
 #include <memory>
 #include "VulkanRenderer.h"
 #include "GameObject.h"
+#include "CullingBVH.h"
+#include "RenderQueue.h"
 
 namespace Sparky {
     class RenderSystem {
@@ -25,11 +27,45 @@ namespace Sparky {
         
         // Getter for game objects
         const std::vector<GameObject*>& getGameObjects() const { return gameObjects; }
+        
+        // Frustum culling. cull() refreshes the world bounds of objects whose
+        // revision changed, refits the BVH and collects the objects with a
+        // mesh that the camera can see; with culling disabled that is every
+        // object with a mesh.
+        void cull(const glm::mat4& viewProjection);
+        const std::vector<GameObject*>& getVisibleObjects() const { return visibleObjects; }
+        const CullingStats& getCullingStats() const { return cullingStats; }
+        const CullingBVH& getCullingBVH() const { return cullingBVH; }
+        void setCullingEnabled(bool enabled) { cullingEnabled = enabled; }
+        bool isCullingEnabled() const { return cullingEnabled; }
+        
+        // Sorts the objects found by the last cull() into the render queue,
+        // with depths measured from eye along forward
+        void buildRenderQueue(const glm::vec3& eye, const glm::vec3& forward, float farDistance);
+        const RenderQueue& getRenderQueue() const { return renderQueue; }
 
     private:
+        // Culling state of a registered object, kept in step with gameObjects
+        struct CullEntry {
+            int proxy;              // -1 while the object has no mesh
+            uint32_t revision;      // Object revision the bounds were taken at
+            bool resolved;
+        };
+
         VulkanRenderer* renderer;
         std::vector<GameObject*> gameObjects;
+        std::vector<CullEntry> cullEntries;
+        CullingBVH cullingBVH;
+        std::vector<int> visibleProxies;
+        std::vector<GameObject*> visibleObjects;
+        CullingStats cullingStats;
+        bool cullingEnabled;
+        std::vector<RenderItem> proxyItems;     // By culling proxy; each holds its mesh and material ids
+        RenderQueue renderQueue;
         
         void renderGameObject(GameObject* gameObject);
+        void refreshBounds(GameObject* gameObject, CullEntry& entry);
+        // Gives back the ids a proxy's item holds and empties it
+        void releaseProxyItem(int proxy);
     };
 }
\ No newline at end of file
@@ -0,0 +1,188 @@
+#pragma once
+
+#include "InputManager.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Sparky {
+    class Scene;
+    class Random;
+    class SaveArchive;
+
+    // One decoded tick of a recording
+    struct ReplayTick {
+        uint32_t index;
+        float deltaTime;
+        InputFrame input;
+        bool hasRandomState; // Random state to restore before simulating this tick
+        uint64_t randomState;
+        bool hasStateHash;   // Hash of the simulation state after this tick
+        uint64_t stateHash;
+    };
+
+    /**
+     * @brief Compact, ring-buffered log of recorded ticks
+     *
+     * Each tick is delta-encoded against the one before it: a flags byte, then
+     * only what changed (toggled key codes, button mask, mouse position,
+     * scroll, delta time). A tick where nothing changed costs one byte.
+     *
+     * Ticks are grouped into blocks. A block is encoded against a blank frame
+     * and its first tick always carries the Random state, so when the log is
+     * full the oldest block is dropped and the rest still decodes. Playing a
+     * log that has wrapped (getFirstTick() > 0) needs the scene restored to
+     * that tick by other means, e.g. a SnapshotManager save taken alongside.
+     */
+    class ReplayLog {
+    public:
+        ReplayLog();
+        ~ReplayLog();
+
+        // Minimum number of most recent ticks kept
+        void setCapacity(uint32_t maxTicks) { m_maxTicks = maxTicks; }
+        uint32_t getCapacity() const { return m_maxTicks; }
+
+        void clear();
+        void setSeed(uint64_t seed) { m_seed = seed; }
+        uint64_t getSeed() const { return m_seed; }
+
+        // Appends the next tick; tick.index is assigned by the log
+        void append(const ReplayTick& tick);
+
+        uint32_t getFirstTick() const { return m_blocks.empty() ? m_nextTick : m_blocks.front().firstTick; }
+        uint32_t getTickCount() const { return m_nextTick - getFirstTick(); }
+        size_t getByteSize() const;
+
+        // Decodes retained ticks in order; the visitor returns false to stop early
+        bool forEachTick(const std::function<bool(const ReplayTick&)>& visitor) const;
+
+        // Storage, as a SaveArchive chunk
+        void writeTo(SaveArchive& archive) const;
+        bool readFrom(const SaveArchive& archive);
+        bool saveToFile(const std::string& filepath) const;
+        bool loadFromFile(const std::string& filepath);
+
+    private:
+        struct Block {
+            uint32_t firstTick;
+            uint32_t tickCount;
+            std::vector<char> data;
+        };
+
+        std::deque<Block> m_blocks;
+        uint64_t m_seed;
+        uint32_t m_maxTicks;
+        uint32_t m_nextTick;
+
+        // Encoder state for the open block
+        bool m_blockOpen;
+        InputFrame m_lastInput;
+        float m_lastDeltaTime;
+
+        static bool decodeBlock(const Block& block, const std::function<bool(const ReplayTick&)>& visitor);
+    };
+
+    /**
+     * @brief Records per-tick input and simulation checkpoints
+     *
+     * Call beginTick() after the window events are polled and before the
+     * simulation runs, and endTick() once the tick is done. Random is seeded
+     * when recording starts; if something reseeds it between ticks the new
+     * state is recorded with the next tick. Reseeds made by simulation code
+     * need no record, since playback runs the same code.
+     *
+     * Every hash interval, endTick() hashes the scene (transforms and every
+     * SnapshotSerializable component) together with the Random state, so
+     * playback can report the first checkpoint where it diverged.
+     */
+    class ReplayRecorder {
+    public:
+        ReplayRecorder();
+        ~ReplayRecorder();
+
+        void setRandom(Random* random) { m_random = random; }
+        void setScene(const Scene* scene) { m_scene = scene; }
+        // Ticks between state hashes; 0 disables hashing
+        void setHashInterval(uint32_t ticks) { m_hashInterval = ticks; }
+        uint32_t getHashInterval() const { return m_hashInterval; }
+        void setCapacity(uint32_t maxTicks) { m_log.setCapacity(maxTicks); }
+
+        // Clears the log and reseeds Random with seed
+        void start(uint64_t seed);
+        void stop();
+        bool isRecording() const { return m_recording; }
+
+        void beginTick(float deltaTime, const InputManager& input);
+        void endTick();
+
+        const ReplayLog& getLog() const { return m_log; }
+        bool saveToFile(const std::string& filepath) const { return m_log.saveToFile(filepath); }
+
+        // FNV-1a over the scene state and randomState, in scene order
+        static uint64_t computeStateHash(const Scene& scene, uint64_t randomState);
+
+    private:
+        ReplayLog m_log;
+        Random* m_random;
+        const Scene* m_scene;
+        uint32_t m_hashInterval;
+        bool m_recording;
+        bool m_tickOpen;
+        uint32_t m_reseedCount;
+        ReplayTick m_pendingTick;
+
+        Random& getRandom() const;
+    };
+
+    struct ReplayResult {
+        uint32_t ticksPlayed;
+        uint32_t hashesChecked;
+        bool diverged;
+        uint32_t divergedTick;
+        uint64_t expectedHash;
+        uint64_t actualHash;
+
+        // Simulation cost per tick, excluding input injection and hashing
+        double totalMs;
+        double minTickMs;
+        double maxTickMs;
+        uint32_t slowestTick;
+        double ticksPerSecond;
+    };
+
+    /**
+     * @brief Replays a ReplayLog headless, as fast as the simulation allows
+     *
+     * Each tick restores any recorded Random state, feeds the recorded input
+     * through InputManager (with the window callbacks disabled) and runs the
+     * tick function with the recorded delta time; there is no frame pacing.
+     * Recorded state hashes are compared as they come up. Per-tick timings
+     * make recordings usable as a repeatable performance benchmark.
+     */
+    class ReplayPlayer {
+    public:
+        using TickFunction = std::function<void(Scene& scene, const ReplayTick& tick)>;
+
+        ReplayPlayer();
+        ~ReplayPlayer();
+
+        void setRandom(Random* random) { m_random = random; }
+        void setInputManager(InputManager* input) { m_input = input; }
+        // Defaults to scene.update(tick.deltaTime)
+        void setTickFunction(TickFunction tickFunction) { m_tickFunction = std::move(tickFunction); }
+        void setStopOnDivergence(bool stop) { m_stopOnDivergence = stop; }
+
+        // The scene must hold the state it had at log.getFirstTick()
+        ReplayResult play(const ReplayLog& log, Scene& scene);
+
+    private:
+        Random* m_random;
+        InputManager* m_input;
+        TickFunction m_tickFunction;
+        bool m_stopOnDivergence;
+    };
+}
@@ -55,6 +55,12 @@ namespace Sparky {
         void integrateForces(float deltaTime);
         void integrateVelocity(float deltaTime);
 
+        // Snapshot serialization (extends the PhysicsComponent record)
+        static constexpr const char* SnapshotTypeName = "RigidBodyComponent";
+        const char* getSnapshotTypeName() const override { return SnapshotTypeName; }
+        void serialize(BinaryWriter& writer) const override;
+        bool deserialize(BinaryReader& reader, uint16_t version) override;
+
     private:
         BodyType bodyType;
         
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "BinaryStream.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Sparky {
+    class JobCounter;
+    class JobSystem;
+
+    // One block of subsystem data. Each subsystem owns its chunk ids and bumps
+    // version when the chunk layout changes.
+    struct SaveChunk {
+        uint32_t id;
+        uint16_t version;
+        std::vector<char> data;
+    };
+
+    /**
+     * @brief Chunked, versioned, compressed binary container for save data
+     *
+     * File layout (little-endian):
+     *   header  "SPKA", u16 format version, u16 reserved, u32 chunk count
+     *   chunk   u32 id (FourCC), u16 schema version, u16 flags,
+     *           u32 raw size, u32 stored size, u32 CRC-32 of the raw bytes,
+     *           stored bytes (LZ-compressed when flagged)
+     *
+     * Chunks are compressed with LZCompressor only when that shrinks them,
+     * and every chunk is CRC-checked after decompression. Files are written
+     * atomically through FileUtils::writeFileAtomic, so an interrupted save
+     * never replaces a good file with a truncated one.
+     */
+    class SaveArchive {
+    public:
+        SaveArchive();
+        ~SaveArchive();
+
+        static constexpr uint32_t makeChunkId(char a, char b, char c, char d) {
+            return static_cast<uint32_t>(static_cast<uint8_t>(a)) |
+                   (static_cast<uint32_t>(static_cast<uint8_t>(b)) << 8) |
+                   (static_cast<uint32_t>(static_cast<uint8_t>(c)) << 16) |
+                   (static_cast<uint32_t>(static_cast<uint8_t>(d)) << 24);
+        }
+
+        // Chunk access; setting an existing id replaces that chunk
+        void setChunk(uint32_t id, uint16_t version, std::vector<char> data);
+        void setChunk(uint32_t id, uint16_t version, BinaryWriter& writer) { setChunk(id, version, writer.takeBuffer()); }
+        const SaveChunk* getChunk(uint32_t id) const;
+        bool hasChunk(uint32_t id) const { return getChunk(id) != nullptr; }
+        const std::vector<SaveChunk>& getChunks() const { return m_chunks; }
+        void clear() { m_chunks.clear(); }
+
+        void setCompressionEnabled(bool enabled) { m_compressionEnabled = enabled; }
+        bool isCompressionEnabled() const { return m_compressionEnabled; }
+
+        // In-memory form
+        void encode(std::vector<char>& output) const;
+        bool decode(const std::vector<char>& input);
+        static bool isArchive(const std::vector<char>& data);
+
+        // Files
+        bool saveToFile(const std::string& filepath) const;
+        bool loadFromFile(const std::string& filepath);
+
+        // Encodes and writes the archive on a JobSystem I/O thread (the global one
+        // unless jobSystem is given). counter is released when the write
+        // finishes; onComplete also runs on the I/O thread.
+        static void saveToFileAsync(std::shared_ptr<const SaveArchive> archive, const std::string& filepath,
+                                    JobCounter* counter = nullptr, std::function<void(bool)> onComplete = nullptr,
+                                    JobSystem* jobSystem = nullptr);
+
+        // CRC-32 (IEEE 802.3)
+        static uint32_t crc32(const char* data, size_t size);
+
+    private:
+        std::vector<SaveChunk> m_chunks;
+        bool m_compressionEnabled;
+    };
+}
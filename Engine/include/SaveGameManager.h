@@ -1,14 +1,18 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <memory>
+#include <mutex>
 
 namespace Sparky {
     // Forward declarations
     class Player;
     class Level;
     class Inventory;
+    class SaveArchive;
+    class JobCounter;
     
     struct GameSaveData {
         // Player data
@@ -43,6 +47,10 @@ namespace Sparky {
         bool saveGame(const std::string& saveName, Player* player, Level* level, Inventory* inventory);
         bool saveGame(const std::string& saveName, const GameSaveData& data);
         
+        // Serializes now and writes the file on an I/O thread. counter is
+        // released when the write finishes; the last save only changes if it succeeded.
+        void saveGameAsync(const std::string& saveName, const GameSaveData& data, JobCounter* counter = nullptr);
+        
         // Load game methods
         bool loadGame(const std::string& saveName, Player* player, Level* level, Inventory* inventory);
         bool loadGame(const std::string& saveName, GameSaveData& data);
@@ -57,7 +65,7 @@ namespace Sparky {
         std::string getSaveDirectory() const;
         
         // Getters and setters
-        const std::string& getLastSave() const { return lastSave; }
+        std::string getLastSave() const;
         void setAutoSave(bool autoSave) { this->autoSave = autoSave; }
         bool getAutoSave() const { return autoSave; }
         
@@ -67,11 +75,17 @@ namespace Sparky {
         
         // Helper methods
         std::string getSaveFilePath(const std::string& saveName) const;
-        bool serializeSaveData(const GameSaveData& data, std::vector<char>& buffer) const;
-        bool deserializeSaveData(const std::vector<char>& buffer, GameSaveData& data) const;
+        void buildSaveArchive(const GameSaveData& data, SaveArchive& archive) const;
+        bool readSaveArchive(const SaveArchive& archive, GameSaveData& data) const;
+        bool deserializeLegacySaveData(const std::vector<char>& buffer, GameSaveData& data) const;
+        // Async writes can finish out of order, so an older save never replaces a newer one
+        void setLastSave(const std::string& saveName, uint64_t sequence);
         
         std::string saveDirectory;
         std::string lastSave;
+        uint64_t lastSaveSequence;
+        uint64_t nextSaveSequence;
+        mutable std::mutex lastSaveMutex;
         bool autoSave;
     };
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "GameObject.h"
+#include "UpdateScheduler.h"
 #include <vector>
 #include <memory>
 #include <string>
@@ -40,6 +41,11 @@ namespace Sparky {
         void setGravity(const glm::vec3& gravity);
         glm::vec3 getGravity() const;
         
+        // Phase-based parallel update (see UpdateScheduler)
+        void setParallelUpdateEnabled(bool enabled);
+        bool isParallelUpdateEnabled() const;
+        UpdateScheduler& getUpdateScheduler() { return *updateScheduler; }
+        
         // Scene tagging for organization
         void setTag(const std::string& tag);
         const std::string& getTag() const;
@@ -58,6 +64,8 @@ namespace Sparky {
         bool physicsEnabled;
         glm::vec3 gravity;
         std::string tag;
+        std::unique_ptr<UpdateScheduler> updateScheduler;
+        bool parallelUpdateEnabled;
         
         // Helper methods
         void registerGameObjectWithSystems(GameObject* object);
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "BinaryStream.h"
+#include "GameObject.h"
+#include "SnapshotSerializable.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Sparky {
+    class Scene;
+    class JobSystem;
+    class JobCounter;
+
+    /**
+     * @brief Serialized state of one GameObject inside a snapshot
+     *
+     * The data blob holds the transform followed by one record per
+     * SnapshotSerializable component (type id, version, size, payload). Blobs
+     * are immutable and shared: an object that has not changed since the
+     * previous capture reuses the blob from that capture instead of being
+     * serialized again.
+     */
+    struct SnapshotObject {
+        std::string name;
+        uint32_t revision;
+        bool removed; // Tombstone in a delta snapshot
+        std::shared_ptr<const std::vector<char>> data;
+    };
+
+    struct SceneSnapshot {
+        bool delta;
+        uint32_t sequence;
+        uint32_t baseSequence; // Snapshot this delta applies on top of
+        std::vector<SnapshotObject> objects;
+    };
+
+    enum class SnapshotMode {
+        FULL,
+        DELTA
+    };
+
+    struct SnapshotStats {
+        size_t objectsSerialized;
+        size_t objectsReused;
+        size_t objectsRemoved;
+        size_t payloadBytes;
+        double captureMs;
+    };
+
+    /**
+     * @brief Captures, writes and restores scene snapshots
+     *
+     * capture() runs on the main thread between frames and only serializes
+     * objects whose GameObject revision changed since the previous capture;
+     * everything else is shared with the previous snapshot. Encoding,
+     * compression and the file write happen on a JobSystem I/O thread, so an
+     * autosave costs the main thread roughly the time to serialize what
+     * changed.
+     *
+     * A save set is one FULL snapshot followed by DELTA snapshots, each of which
+     * records the objects changed or removed since the snapshot before it.
+     * Loading applies the chain in order. Objects are matched by name, so
+     * names must be unique: capture() returns null, and apply() changes
+     * nothing and fails, when two objects in the scene share a name.
+     */
+    class SnapshotManager {
+    public:
+        SnapshotManager();
+        ~SnapshotManager();
+
+        void setJobSystem(JobSystem* jobSystem) { m_jobSystem = jobSystem; }
+
+        // Lets load() recreate components on objects that do not exist yet
+        template<typename T>
+        void registerComponentType() {
+            m_factories[SnapshotSerializable::hashTypeName(T::SnapshotTypeName)] =
+                [](GameObject& object) -> SnapshotSerializable* { return object.addComponent<T>(); };
+        }
+
+        // Capture (main thread, no update in flight); null if object names are not unique
+        std::shared_ptr<const SceneSnapshot> capture(const Scene& scene, SnapshotMode mode);
+
+        // Capture now, then encode, compress and write on an I/O thread
+        void saveAsync(const Scene& scene, const std::string& filepath, SnapshotMode mode);
+        bool save(const Scene& scene, const std::string& filepath, SnapshotMode mode);
+
+        // Blocks until every saveAsync() issued so far has finished
+        void waitForWrites();
+        bool didLastWriteSucceed() const;
+
+        // Loads a FULL snapshot followed by its deltas, in order. The loaded
+        // state becomes the base for the next DELTA save.
+        bool load(Scene& scene, const std::vector<std::string>& filepaths);
+        bool apply(const SceneSnapshot& snapshot, Scene& scene);
+
+        // Forgets the previous capture; the next capture serializes every object
+        void invalidate();
+
+        // Encoding
+        static void encode(const SceneSnapshot& snapshot, std::vector<char>& output);
+        static std::shared_ptr<SceneSnapshot> decode(const std::vector<char>& input);
+
+        const SnapshotStats& getStats() const { return m_stats; }
+        uint32_t getSequence() const { return m_sequence; }
+
+    private:
+        // What the previous capture recorded for an object
+        struct CachedObject {
+            const GameObject* object;
+            uint32_t revision;
+            std::shared_ptr<const std::vector<char>> data;
+            bool seen;
+        };
+
+        JobSystem* m_jobSystem;
+        std::unordered_map<std::string, CachedObject> m_cache;
+        std::unordered_map<uint32_t, std::function<SnapshotSerializable*(GameObject&)>> m_factories;
+        uint32_t m_sequence;
+        SnapshotStats m_stats;
+
+        std::unique_ptr<JobCounter> m_writeCounter;
+        std::shared_ptr<std::atomic<bool>> m_lastWriteSucceeded;
+
+        static std::shared_ptr<const std::vector<char>> serializeObject(const GameObject& object);
+        bool applyObject(const SnapshotObject& record, Scene& scene,
+                         std::unordered_map<std::string, GameObject*>& index);
+        static bool writeSnapshotFile(const SceneSnapshot& snapshot, const std::string& filepath);
+    };
+}
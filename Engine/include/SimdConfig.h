@@ -0,0 +1,8 @@
+#pragma once
+
+// SSE is available on every x64 build and on x86 builds that enable it. SIMD
+// kernels test SPARKY_SSE and fall back to scalar code without it.
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define SPARKY_SSE 1
+#include <xmmintrin.h>
+#endif
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "BinaryStream.h"
+#include <cstdint>
+
+namespace Sparky {
+    /**
+     * @brief Opt-in interface for components that persist in scene snapshots
+     *
+     * A component mixes this in alongside Component, declares a
+     * SnapshotTypeName and writes its state in serialize(). Each component
+     * record carries the version that wrote it, so deserialize() can read older
+     * layouts after the format grows. Implementations should call
+     * markOwnerDirty() whenever persisted state changes so delta snapshots pick
+     * the object up.
+     */
+    class SnapshotSerializable {
+    public:
+        virtual ~SnapshotSerializable() = default;
+
+        // Stable name, hashed into the type id stored in snapshots
+        virtual const char* getSnapshotTypeName() const = 0;
+        virtual uint16_t getSnapshotVersion() const { return 1; }
+
+        virtual void serialize(BinaryWriter& writer) const = 0;
+        virtual bool deserialize(BinaryReader& reader, uint16_t version) = 0;
+
+        uint32_t getSnapshotTypeId() const { return hashTypeName(getSnapshotTypeName()); }
+
+        // FNV-1a
+        static uint32_t hashTypeName(const char* name) {
+            uint32_t hash = 2166136261u;
+            for (const char* c = name; *c; ++c) {
+                hash ^= static_cast<uint8_t>(*c);
+                hash *= 16777619u;
+            }
+            return hash;
+        }
+    };
+}
@@ -9,6 +9,7 @@
 #include "Camera.h"
 #include "RenderSystem.h"
 #include "Logger.h"
+#include "Replay.h"
 
 // Core engine namespace
 namespace Sparky {
@@ -29,6 +30,11 @@ namespace Sparky {
         Camera& getCamera() { return camera; }
         RenderSystem& getRenderSystem() { return renderSystem; }
         Logger& getLogger() { return logger; }
+        ReplayRecorder& getReplayRecorder() { return replayRecorder; }
+
+        // Scene the game is simulating; the replay recorder hashes its state
+        void setScene(Scene* scene);
+        Scene* getScene() const { return activeScene; }
 
     private:
         VulkanRenderer renderer;
@@ -37,6 +43,8 @@ namespace Sparky {
         Camera camera;
         RenderSystem renderSystem;
         Logger logger;
+        ReplayRecorder replayRecorder;
+        Scene* activeScene;
 
         bool isRunning;
     };
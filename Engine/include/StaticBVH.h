@@ -0,0 +1,73 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Sparky {
+    class GameObject;
+    class JobSystem;
+
+    struct StaticBVHHit {
+        float distance;
+        glm::vec3 normal;
+        int box;            // Index passed back by addBox()
+    };
+
+    /**
+     * @brief Bounding volume hierarchy over static boxes
+     *
+     * Level geometry that never moves (walls, crates, terrain blocks) is added
+     * as axis-aligned boxes and build() sorts them into a binary tree with a
+     * binned surface area heuristic. Nodes are 32 bytes in one flat array and
+     * leaves hold a few boxes each, so a ray visits a handful of cache lines
+     * instead of testing every box.
+     *
+     * Queries are const and safe to run from several threads at once once the
+     * tree is built. Adding boxes marks the tree stale; queries on a stale
+     * tree see only the boxes present at the last build().
+     */
+    class StaticBVH {
+    public:
+        StaticBVH();
+
+        int addBox(const glm::vec3& minBounds, const glm::vec3& maxBounds, GameObject* object = nullptr);
+        void clear();
+        void build();
+
+        bool isBuilt() const { return !m_dirty; }
+        int getBoxCount() const { return static_cast<int>(m_boxMin.size()); }
+        int getNodeCount() const { return static_cast<int>(m_nodes.size()); }
+        GameObject* getBoxObject(int box) const { return m_boxObject[box]; }
+
+        // Closest box along a normalized direction, up to maxDistance
+        bool raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, StaticBVHHit& hit) const;
+
+        // True when any box lies between the two points
+        bool isOccluded(const glm::vec3& from, const glm::vec3& to) const;
+
+        // isOccluded() for many segments, split across the JobSystem when one is given
+        void isOccludedBatch(const glm::vec3* from, const glm::vec3* to, size_t count, uint8_t* occluded,
+                             JobSystem* jobSystem = nullptr) const;
+
+    private:
+        struct Node {
+            glm::vec3 minBounds;
+            uint32_t leftOrFirst;   // Left child index, or first box for leaves
+            glm::vec3 maxBounds;
+            uint32_t count;         // Box count; zero for inner nodes
+        };
+
+        std::vector<glm::vec3> m_boxMin;
+        std::vector<glm::vec3> m_boxMax;
+        std::vector<GameObject*> m_boxObject;
+        std::vector<uint32_t> m_order;     // Boxes in leaf order
+        std::vector<Node> m_nodes;
+        bool m_dirty;
+
+        void subdivide(uint32_t nodeIndex, int depth, std::vector<glm::vec3>& centroids);
+        template <bool AnyHit>
+        bool traverse(const glm::vec3& origin, const glm::vec3& direction, float maxT, StaticBVHHit* hit) const;
+    };
+}
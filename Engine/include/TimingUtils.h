@@ -0,0 +1,10 @@
+#pragma once
+
+#include <chrono>
+
+namespace Sparky {
+    // Milliseconds since start, for the stage timings systems report in their stats and for benchmarks
+    inline double elapsedMs(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
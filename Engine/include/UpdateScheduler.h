@@ -0,0 +1,115 @@
+#pragma once
+
+#include "Component.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+namespace Sparky {
+    class GameObject;
+    class JobSystem;
+
+    /**
+     * @brief Phase-based scene update scheduler
+     *
+     * Splits a scene update into the phases of UpdatePhase. Inside a phase,
+     * components are grouped by concrete type and each group is updated in
+     * fixed-size batches on the JobSystem (or serially if the type does not
+     * support parallel updates). Phases declare the shared state they read and
+     * write; phases that do not conflict run concurrently in the same wave.
+     *
+     * Results are deterministic: type groups run in first-seen order, serial
+     * components keep scene order, and parallel components only touch their own state.
+     * Components are gathered as each wave starts, so components removed by an
+     * earlier wave (late update, death callbacks) are never updated afterwards.
+     */
+
+    // Shared state a phase may read or write
+    enum UpdateResource : uint32_t {
+        RESOURCE_NONE      = 0,
+        RESOURCE_INPUT     = 1u << 0,
+        RESOURCE_TRANSFORM = 1u << 1,
+        RESOURCE_AI        = 1u << 2,
+        RESOURCE_POSE      = 1u << 3,
+        RESOURCE_PHYSICS   = 1u << 4,
+        RESOURCE_RENDER    = 1u << 5,
+        RESOURCE_GAMEPLAY  = 1u << 6,
+        RESOURCE_ALL       = 0xFFFFFFFFu
+    };
+
+    struct UpdatePhaseDesc {
+        std::string name;
+        uint32_t reads;
+        uint32_t writes;
+    };
+
+    // Per-frame statistics
+    struct UpdateSchedulerStats {
+        size_t waveCount;
+        size_t parallelComponents;
+        size_t serialComponents;
+        size_t batchCount;
+        std::array<size_t, static_cast<size_t>(UpdatePhase::COUNT)> componentsPerPhase; // LATE_UPDATE counts objects
+    };
+
+    class UpdateScheduler {
+    public:
+        UpdateScheduler();
+        ~UpdateScheduler();
+
+        // Job system used for batches (defaults to JobSystem::getInstance())
+        void setJobSystem(JobSystem* jobSystem) { m_jobSystem = jobSystem; }
+
+        // Phase access declarations; changing them rebuilds the wave schedule
+        void setPhaseAccess(UpdatePhase phase, uint32_t reads, uint32_t writes);
+        const UpdatePhaseDesc& getPhaseDesc(UpdatePhase phase) const;
+
+        // Number of components per parallel batch
+        void setBatchSize(size_t batchSize) { m_batchSize = batchSize > 0 ? batchSize : 1; }
+        size_t getBatchSize() const { return m_batchSize; }
+
+        // Update every object in the list, phase by phase
+        void update(const std::vector<std::unique_ptr<GameObject>>& objects, float deltaTime);
+
+        // Phases grouped into waves that may run concurrently
+        const std::vector<std::vector<UpdatePhase>>& getWaves() const { return m_waves; }
+        const UpdateSchedulerStats& getStats() const { return m_stats; }
+
+    private:
+        struct TypeGroup {
+            std::type_index type;
+            bool parallel;
+            std::vector<Component*> components;
+        };
+
+        struct PhaseCounters {
+            size_t parallelComponents = 0;
+            size_t serialComponents = 0;
+            size_t batchCount = 0;
+        };
+
+        struct PhaseBucket {
+            std::vector<TypeGroup> groups;
+            std::unordered_map<std::type_index, size_t> groupLookup;
+        };
+
+        JobSystem* m_jobSystem;
+        size_t m_batchSize;
+        std::array<UpdatePhaseDesc, static_cast<size_t>(UpdatePhase::COUNT)> m_phases;
+        std::array<PhaseBucket, static_cast<size_t>(UpdatePhase::COUNT)> m_buckets;
+        std::array<PhaseCounters, static_cast<size_t>(UpdatePhase::COUNT)> m_phaseCounters;
+        std::vector<std::vector<UpdatePhase>> m_waves;
+        UpdateSchedulerStats m_stats;
+
+        void buildWaves();
+        bool phasesConflict(UpdatePhase a, UpdatePhase b) const;
+        void gatherComponents(const std::vector<std::unique_ptr<GameObject>>& objects, const std::vector<UpdatePhase>& wave);
+        void runPhase(UpdatePhase phase, const std::vector<std::unique_ptr<GameObject>>& objects, float deltaTime);
+        JobSystem& jobSystem();
+    };
+}
@@ -28,6 +28,7 @@ namespace Sparky {
     struct SwapChainSupportDetails;
     struct UniformBufferObject;
     struct PushConstantData;
+    struct InstanceData;
     struct MaterialUniformBufferObject;
 #endif
 }
@@ -45,6 +46,14 @@ namespace Sparky {
         glm::mat4 model;
     };
 
+    // Per-instance data for the instanced pipeline, read from vertex binding 1
+    struct InstanceData {
+        glm::mat4 model;
+
+        static VkVertexInputBindingDescription getBindingDescription();
+        static std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions();
+    };
+
     // Add material uniform buffer structure
     struct MaterialUniformBufferObject {
         glm::vec4 ambient;
@@ -140,6 +149,7 @@ namespace Sparky {
         VkRenderPass renderPass;
         VkPipelineLayout pipelineLayout;
         VkPipeline graphicsPipeline;
+        VkPipeline instancedPipeline;       // Null when the instanced shader variant is missing
         VkCommandPool commandPool;
         
         // Framebuffers
@@ -174,6 +184,12 @@ namespace Sparky {
         std::vector<VkDeviceMemory> lightingUniformBuffersMemory;
         std::vector<void*> lightingUniformBuffersMapped;
         
+        // Instance buffers, one per swap chain image, grown to the largest frame
+        std::vector<VkBuffer> instanceBuffers;
+        std::vector<VkDeviceMemory> instanceBuffersMemory;
+        std::vector<void*> instanceBuffersMapped;
+        std::vector<size_t> instanceBufferCapacities;
+        
         // Descriptor pools and sets
         VkDescriptorPool descriptorPool;
         VkDescriptorPool materialDescriptorPool;
@@ -235,6 +251,8 @@ namespace Sparky {
         void cleanupSwapChain();
         void recreateSwapChain();
         void cleanupUniformBuffers();
+        void ensureInstanceBuffer(uint32_t imageIndex, size_t instanceCount);
+        void cleanupInstanceBuffers();
         void updateUniformBuffer(uint32_t currentImage);
         void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
         uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
@@ -32,6 +32,15 @@ if %ERRORLEVEL% EQU 0 (
     exit /b %ERRORLEVEL%
 )
 
+echo Compiling material instanced vertex shader...
+%VULKAN_SDK%\Bin\glslc.exe material_instanced.vert -o material_instanced.vert.spv
+if %ERRORLEVEL% EQU 0 (
+    echo Material instanced vertex shader compiled successfully!
+) else (
+    echo Failed to compile material instanced vertex shader!
+    exit /b %ERRORLEVEL%
+)
+
 echo Compiling PBR vertex shader...
 %VULKAN_SDK%\Bin\glslc.exe pbr.vert -o pbr.vert.spv
 if %ERRORLEVEL% EQU 0 (
@@ -41,6 +50,15 @@ if %ERRORLEVEL% EQU 0 (
     exit /b %ERRORLEVEL%
 )
 
+echo Compiling PBR instanced vertex shader...
+%VULKAN_SDK%\Bin\glslc.exe pbr_instanced.vert -o pbr_instanced.vert.spv
+if %ERRORLEVEL% EQU 0 (
+    echo PBR instanced vertex shader compiled successfully!
+) else (
+    echo Failed to compile PBR instanced vertex shader!
+    exit /b %ERRORLEVEL%
+)
+
 echo Compiling advanced PBR vertex shader...
 %VULKAN_SDK%\Bin\glslc.exe advanced_pbr.vert -o advanced_pbr.vert.spv
 if %ERRORLEVEL% EQU 0 (
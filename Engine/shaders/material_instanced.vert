@@ -0,0 +1,30 @@
+#version 450
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inNormal;
+layout(location = 2) in vec2 inTexCoord;
+
+// Per-instance model matrix, one location per column
+layout(location = 5) in mat4 inModel;
+
+layout(location = 0) out vec3 fragPosition;
+layout(location = 1) out vec3 fragNormal;
+layout(location = 2) out vec2 fragTexCoord;
+
+// UBO with view and proj matrices
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 view;
+    mat4 proj;
+} ubo;
+
+void main() {
+    vec4 worldPosition = inModel * vec4(inPosition, 1.0);
+    fragPosition = worldPosition.xyz;
+    
+    // Transform normal to world space
+    fragNormal = mat3(transpose(inverse(inModel))) * inNormal;
+    
+    fragTexCoord = inTexCoord;
+    
+    gl_Position = ubo.proj * ubo.view * worldPosition;
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+#version 450
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inNormal;
+layout(location = 2) in vec2 inTexCoord;
+layout(location = 3) in vec3 inTangent;
+layout(location = 4) in vec3 inBitangent;
+
+// Per-instance model matrix, one location per column
+layout(location = 5) in mat4 inModel;
+
+layout(location = 0) out vec3 fragPosition;
+layout(location = 1) out vec3 fragNormal;
+layout(location = 2) out vec2 fragTexCoord;
+layout(location = 3) out vec3 fragTangent;
+layout(location = 4) out vec3 fragBitangent;
+
+// UBO with view and proj matrices
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 view;
+    mat4 proj;
+} ubo;
+
+void main() {
+    vec4 worldPosition = inModel * vec4(inPosition, 1.0);
+    fragPosition = worldPosition.xyz;
+    
+    // Transform normal, tangent, and bitangent to world space
+    fragNormal = normalize(mat3(transpose(inverse(inModel))) * inNormal);
+    fragTangent = normalize(mat3(inModel) * inTangent);
+    fragBitangent = normalize(mat3(inModel) * inBitangent);
+    
+    fragTexCoord = inTexCoord;
+    
+    gl_Position = ubo.proj * ubo.view * worldPosition;
+}
\ No newline at end of file
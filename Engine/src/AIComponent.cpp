@@ -3,6 +3,8 @@
 #include "../include/PhysicsComponent.h"
 #include "../include/HealthComponent.h"
 #include "../include/BehaviorTree.h"
+#include "../include/CompiledBehaviorTree.h"
+#include "../include/FlowField.h"
 
 #ifdef HAS_GLFW
 #include <GLFW/glfw3.h>
@@ -16,9 +18,10 @@
 namespace Sparky {
 
     AIComponent::AIComponent() : Component(), currentState(AIState::IDLE), target(nullptr),
-                               currentPatrolIndex(0), moveSpeed(2.0f), detectionRange(10.0f),
+                               currentPatrolIndex(0), moveSpeed(2.0f), flowField(nullptr), detectionRange(10.0f),
                                attackRange(2.0f), attackDamage(10.0f), attackRate(1.0f),
-                               lastAttackTime(0.0f), searchTime(0.0f), maxSearchTime(10.0f) {
+                               lastAttackTime(0.0f), searchTime(0.0f), maxSearchTime(10.0f),
+                               behaviorTreeBatch(nullptr), behaviorTreeAgent(-1) {
         // Initialize default AI properties
         aiProperties.aggression = 0.5f;
         aiProperties.intelligence = 0.5f;
@@ -36,6 +39,7 @@ namespace Sparky {
     }
 
     AIComponent::~AIComponent() {
+        setBehaviorTreeBatch(nullptr);
     }
 
     void AIComponent::update(float deltaTime) {
@@ -126,6 +130,17 @@ namespace Sparky {
         behaviorTree = std::move(tree);
     }
 
+    void AIComponent::setBehaviorTreeBatch(BehaviorTreeBatch* batch) {
+        if (behaviorTreeBatch) {
+            behaviorTreeBatch->removeAgent(behaviorTreeAgent);
+            behaviorTreeAgent = -1;
+        }
+        behaviorTreeBatch = batch;
+        if (behaviorTreeBatch) {
+            behaviorTreeAgent = behaviorTreeBatch->addAgent(this);
+        }
+    }
+
     // Advanced AI methods
     void AIComponent::addTacticalPosition(float x, float y, float z, float coverQuality, float visibility, float strategicValue) {
         tacticalPositions.push_back(x);
@@ -236,7 +251,13 @@ namespace Sparky {
             return;
         }
         
-        // In a full implementation, we would move towards the target
+        // Follow the shared flow field; one field serves every chaser of the same target
+        if (flowField && owner) {
+            glm::vec3 direction = flowField->sampleDirection(owner->getPosition());
+            if (direction.x != 0.0f || direction.z != 0.0f) {
+                owner->setPosition(owner->getPosition() + direction * (moveSpeed * deltaTime));
+            }
+        }
     }
 
     void AIComponent::updateAttack(float deltaTime) {
@@ -363,9 +384,7 @@ namespace Sparky {
             return std::numeric_limits<float>::max();
         }
         
-        // In a full implementation, we would calculate the actual distance
-        // For now, we'll return a placeholder value
-        return 5.0f;
+        return glm::distance(owner->getPosition(), target->getPosition());
     }
 
     bool AIComponent::canAttack() const {
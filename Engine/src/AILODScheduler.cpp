@@ -0,0 +1,226 @@
+#include "../include/AILODScheduler.h"
+#include "../include/Logger.h"
+#include "../include/TimingUtils.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace Sparky {
+    namespace {
+        int levelIndex(AILODLevel level) {
+            return static_cast<int>(level);
+        }
+    }
+
+    AILODScheduler::AILODScheduler()
+        : AILODScheduler(AILODSettings()) {
+    }
+
+    AILODScheduler::AILODScheduler(const AILODSettings& settings)
+        : m_settings(settings)
+        , m_viewerPosition(0.0f)
+        , m_viewerForward(0.0f, 0.0f, -1.0f)
+        , m_viewerCosHalfFov(-1.0f)
+        , m_frame(0)
+        , m_agentCount(0)
+        , m_updating(false)
+        , m_stats() {
+        if (m_settings.reducedInterval < 1) {
+            SPARKY_LOG_WARNING("AILODScheduler: reduced interval must be at least 1, using 4");
+            m_settings.reducedInterval = 4;
+        }
+        if (m_settings.lowInterval < 1) {
+            SPARKY_LOG_WARNING("AILODScheduler: low interval must be at least 1, using 30");
+            m_settings.lowInterval = 30;
+        }
+        if (m_settings.reducedDistance < m_settings.fullDistance) {
+            SPARKY_LOG_WARNING("AILODScheduler: reduced distance is closer than full distance, using full distance");
+            m_settings.reducedDistance = m_settings.fullDistance;
+        }
+        for (int level = 0; level < 3; ++level) {
+            m_phaseLoad[level].assign(getInterval(static_cast<AILODLevel>(level)), 0);
+        }
+    }
+
+    std::unique_ptr<AILODScheduler> AILODScheduler::create(const AILODSettings& settings) {
+        return std::make_unique<AILODScheduler>(settings);
+    }
+
+    void AILODScheduler::setViewer(const glm::vec3& position, const glm::vec3& forward, float fieldOfView) {
+        m_viewerPosition = position;
+        m_viewerForward = forward;
+        m_viewerCosHalfFov = std::cos(glm::radians(std::min(std::max(fieldOfView, 0.0f), 360.0f) * 0.5f));
+    }
+
+    int AILODScheduler::getInterval(AILODLevel level) const {
+        switch (level) {
+            case AILODLevel::FULL:
+                return 1;
+            case AILODLevel::REDUCED:
+                return m_settings.reducedInterval;
+            case AILODLevel::LOW:
+                return m_settings.lowInterval;
+        }
+        return 1;
+    }
+
+    AILODAgentId AILODScheduler::addAgent(const glm::vec3& position, AILODUpdateFn update) {
+        int slot;
+        if (!m_freeSlots.empty()) {
+            slot = m_freeSlots.back();
+            m_freeSlots.pop_back();
+        } else {
+            slot = static_cast<int>(m_active.size());
+            m_position.push_back(glm::vec3(0.0f));
+            m_inCombat.push_back(0);
+            m_level.push_back(AILODLevel::FULL);
+            m_phase.push_back(-1);
+            m_pendingTime.push_back(0.0f);
+            m_deferred.push_back(0);
+            m_update.emplace_back();
+            m_active.push_back(0);
+        }
+
+        m_position[slot] = position;
+        m_inCombat[slot] = 0;
+        m_pendingTime[slot] = 0.0f;
+        m_deferred[slot] = 0;
+        m_update[slot] = std::move(update);
+        m_active[slot] = 1;
+        m_phase[slot] = -1;
+        assignLevel(slot, chooseLevel(slot));
+        ++m_agentCount;
+        return slot;
+    }
+
+    void AILODScheduler::removeAgent(AILODAgentId agent) {
+        if (agent < 0 || agent >= static_cast<int>(m_active.size()) || !m_active[agent]) return;
+        m_active[agent] = 0;
+        --m_agentCount;
+
+        // The running callback may be this agent's, and the carried list is in the middle of being rebuilt
+        if (m_updating) {
+            m_pendingRemovals.push_back(agent);
+            return;
+        }
+        releaseAgent(agent);
+    }
+
+    void AILODScheduler::releaseAgent(int agent) {
+        releasePhase(agent);
+        m_update[agent] = nullptr;
+        if (m_deferred[agent]) {
+            auto it = std::find(m_carried.begin(), m_carried.end(), agent);
+            if (it != m_carried.end()) m_carried.erase(it);
+            m_deferred[agent] = 0;
+        }
+        m_freeSlots.push_back(agent);
+    }
+
+    void AILODScheduler::setAgentState(AILODAgentId agent, const glm::vec3& position, bool inCombat) {
+        if (agent < 0 || agent >= static_cast<int>(m_active.size())) return;
+        m_position[agent] = position;
+        m_inCombat[agent] = inCombat ? 1 : 0;
+    }
+
+    AILODLevel AILODScheduler::chooseLevel(int agent) const {
+        if (m_inCombat[agent]) return AILODLevel::FULL;
+
+        // Thresholds move out by the hysteresis margin while the agent is at a finer level
+        AILODLevel current = m_phase[agent] >= 0 ? m_level[agent] : AILODLevel::LOW;
+        float fullDistance = m_settings.fullDistance;
+        float reducedDistance = m_settings.reducedDistance;
+        if (current == AILODLevel::FULL) fullDistance *= 1.0f + m_settings.hysteresis;
+        if (current != AILODLevel::LOW) reducedDistance *= 1.0f + m_settings.hysteresis;
+
+        glm::vec3 offset = m_position[agent] - m_viewerPosition;
+        float distanceSq = glm::dot(offset, offset);
+        if (distanceSq < fullDistance * fullDistance) return AILODLevel::FULL;
+        if (distanceSq < reducedDistance * reducedDistance) return AILODLevel::REDUCED;
+
+        float distance = std::sqrt(distanceSq);
+        bool onScreen = glm::dot(offset, m_viewerForward) >= m_viewerCosHalfFov * distance;
+        return onScreen ? AILODLevel::REDUCED : AILODLevel::LOW;
+    }
+
+    void AILODScheduler::releasePhase(int agent) {
+        if (m_phase[agent] >= 0) {
+            --m_phaseLoad[levelIndex(m_level[agent])][m_phase[agent]];
+            m_phase[agent] = -1;
+        }
+    }
+
+    void AILODScheduler::assignLevel(int agent, AILODLevel level) {
+        if (m_phase[agent] >= 0 && m_level[agent] == level) return;
+        releasePhase(agent);
+
+        std::vector<int>& load = m_phaseLoad[levelIndex(level)];
+        int phase = static_cast<int>(std::min_element(load.begin(), load.end()) - load.begin());
+        ++load[phase];
+        m_level[agent] = level;
+        m_phase[agent] = phase;
+    }
+
+    void AILODScheduler::update(float deltaTime) {
+        auto start = std::chrono::steady_clock::now();
+        m_stats = AILODStats();
+        ++m_frame;
+
+        for (int level = 0; level < 3; ++level) {
+            m_due[level].clear();
+        }
+        for (int agent = 0; agent < static_cast<int>(m_active.size()); ++agent) {
+            if (!m_active[agent]) continue;
+            m_pendingTime[agent] += deltaTime;
+            assignLevel(agent, chooseLevel(agent));
+
+            int level = levelIndex(m_level[agent]);
+            ++m_stats.levelCounts[level];
+            if (m_deferred[agent]) continue;
+            int interval = static_cast<int>(m_phaseLoad[level].size());
+            if (static_cast<int>(m_frame % static_cast<uint32_t>(interval)) == m_phase[agent]) {
+                m_due[level].push_back(agent);
+            }
+        }
+
+        // Carried-over agents first, then finer levels first
+        std::vector<int>& order = m_order;
+        order.swap(m_carried);
+        m_carried.clear();
+        for (int level = 0; level < 3; ++level) {
+            order.insert(order.end(), m_due[level].begin(), m_due[level].end());
+        }
+        m_stats.agentsDue = static_cast<int>(order.size());
+
+        const bool budgeted = m_settings.frameBudgetMs > 0.0;
+        m_updating = true;
+        size_t next = 0;
+        for (; next < order.size(); ++next) {
+            int agent = order[next];
+            if (!m_active[agent]) continue;
+            if (budgeted && next > 0 && elapsedMs(start) >= m_settings.frameBudgetMs) break;
+
+            m_deferred[agent] = 0;
+            float agentDelta = m_pendingTime[agent];
+            m_pendingTime[agent] = 0.0f;
+            m_update[agent](agentDelta, m_level[agent]);
+            ++m_stats.agentsUpdated;
+        }
+
+        // Out of budget: the rest go first next frame, in the same order
+        for (; next < order.size(); ++next) {
+            int agent = order[next];
+            if (!m_active[agent]) continue;
+            m_deferred[agent] = 1;
+            m_carried.push_back(agent);
+        }
+        order.clear();
+        m_updating = false;
+        for (int agent : m_pendingRemovals) {
+            releaseAgent(agent);
+        }
+        m_pendingRemovals.clear();
+        m_stats.agentsDeferred = static_cast<int>(m_carried.size());
+        m_stats.updateMs = elapsedMs(start);
+    }
+}
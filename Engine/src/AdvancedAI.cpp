@@ -1,5 +1,6 @@
 #include "../include/AdvancedAI.h"
 #include "../include/GameObject.h"
+#include "../include/Random.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <algorithm>
@@ -7,12 +8,22 @@
 #include <limits>
 
 namespace Sparky {
+    namespace {
+        // Objects face -Z before their yaw is applied, as in getTransformMatrix()
+        glm::vec3 facingDirection(const GameObject* object) {
+            float yaw = glm::radians(object->getRotation().y);
+            return glm::vec3(-std::sin(yaw), 0.0f, -std::cos(yaw));
+        }
+    }
+    
     // PerceptionComponent implementation
     PerceptionComponent::PerceptionComponent()
         : m_visionRange(20.0f)
         , m_hearingRange(30.0f)
         , m_fieldOfView(90.0f)
-        , m_primaryThreat(nullptr) {
+        , m_primaryThreat(nullptr)
+        , m_perceptionSystem(nullptr)
+        , m_observer(INVALID_PERCEPTION_OBSERVER) {
     }
     
     void PerceptionComponent::initialize() {
@@ -27,6 +38,22 @@ namespace Sparky {
         GameObject* bestThreat = nullptr;
         float bestThreatScore = 0.0f;
         
+        // Targets in sight count as full-intensity stimuli, and the observer
+        // follows the owner for the system's next refresh
+        if (m_perceptionSystem && owner) {
+            glm::vec3 ownerPos = owner->getPosition();
+            for (PerceptionTargetId target : m_perceptionSystem->getVisibleTargets(m_observer)) {
+                GameObject* seen = m_perceptionSystem->getTargetObject(target);
+                if (!seen) continue;
+                float score = 1.0f / (glm::distance(ownerPos, seen->getPosition()) + 1.0f);
+                if (score > bestThreatScore) {
+                    bestThreatScore = score;
+                    bestThreat = seen;
+                }
+            }
+            m_perceptionSystem->setObserverTransform(m_observer, ownerPos, facingDirection(owner));
+        }
+        
         for (const auto& stimulus : m_stimuli) {
             if (stimulus.source && owner) {
                 glm::vec3 ownerPos = owner->getPosition();
@@ -45,6 +72,7 @@ namespace Sparky {
     
     void PerceptionComponent::destroy() {
         // Cleanup perception system
+        setPerceptionSystem(nullptr);
     }
     
     void PerceptionComponent::render() {
@@ -53,6 +81,9 @@ namespace Sparky {
     
     void PerceptionComponent::setVisionRange(float range) {
         m_visionRange = range;
+        if (m_perceptionSystem) {
+            m_perceptionSystem->setObserverVision(m_observer, m_visionRange, m_fieldOfView);
+        }
     }
     
     float PerceptionComponent::getVisionRange() const {
@@ -69,6 +100,9 @@ namespace Sparky {
     
     void PerceptionComponent::setFieldOfView(float fov) {
         m_fieldOfView = fov;
+        if (m_perceptionSystem) {
+            m_perceptionSystem->setObserverVision(m_observer, m_visionRange, m_fieldOfView);
+        }
     }
     
     float PerceptionComponent::getFieldOfView() const {
@@ -87,21 +121,43 @@ namespace Sparky {
         m_stimuli.clear();
     }
     
+    void PerceptionComponent::setPerceptionSystem(PerceptionSystem* system, PerceptionPriority priority) {
+        if (m_perceptionSystem) {
+            m_perceptionSystem->removeObserver(m_observer);
+            m_observer = INVALID_PERCEPTION_OBSERVER;
+        }
+        m_perceptionSystem = system;
+        if (m_perceptionSystem) {
+            glm::vec3 position = owner ? owner->getPosition() : glm::vec3(0.0f);
+            glm::vec3 forward = owner ? facingDirection(owner) : glm::vec3(0.0f, 0.0f, -1.0f);
+            m_observer = m_perceptionSystem->addObserver(position, forward, m_visionRange, m_fieldOfView, priority, owner);
+        }
+    }
+    
+    void PerceptionComponent::setPerceptionPriority(PerceptionPriority priority) {
+        if (m_perceptionSystem) {
+            m_perceptionSystem->setObserverPriority(m_observer, priority);
+        }
+    }
+    
     bool PerceptionComponent::canSee(const GameObject* target) const {
         if (!owner || !target) return false;
         
+        // Batched result, line of sight included
+        if (m_perceptionSystem) {
+            return m_perceptionSystem->canSee(m_observer, target);
+        }
+        
         glm::vec3 ownerPos = owner->getPosition();
         glm::vec3 targetPos = target->getPosition();
         
         float distance = glm::distance(ownerPos, targetPos);
         if (distance > m_visionRange) return false;
-        
-        // Simple line-of-sight check (in a real implementation, this would use raycasting)
-        glm::vec3 direction = glm::normalize(targetPos - ownerPos);
+        if (distance <= 0.0f) return true;
         
         // Check if target is within field of view
-        // This is a simplified implementation
-        return true;
+        glm::vec3 direction = (targetPos - ownerPos) / distance;
+        return glm::dot(direction, facingDirection(owner)) >= std::cos(glm::radians(m_fieldOfView * 0.5f));
     }
     
     bool PerceptionComponent::canHear(const GameObject* source) const {
@@ -119,7 +175,7 @@ namespace Sparky {
     }
     
     // NavigationMesh implementation
-    NavigationMesh::NavigationMesh() {
+    NavigationMesh::NavigationMesh() : m_graphDirty(false), m_revision(0) {
     }
     
     NavigationMesh::~NavigationMesh() {
@@ -127,12 +183,14 @@ namespace Sparky {
     
     void NavigationMesh::addNode(const NavNode& node) {
         m_nodes.push_back(node);
+        markGraphDirty();
     }
     
     void NavigationMesh::addConnection(int from, int to) {
         if (from >= 0 && from < static_cast<int>(m_nodes.size()) &&
             to >= 0 && to < static_cast<int>(m_nodes.size())) {
             m_connections[from].push_back(to);
+            markGraphDirty();
         }
     }
     
@@ -158,41 +216,147 @@ namespace Sparky {
                 }
             }
             m_connections = newConnections;
+            
+            // Per-node connection lists use the same ids
+            for (auto& node : m_nodes) {
+                std::vector<int> remapped;
+                for (int connectedId : node.connections) {
+                    if (connectedId != nodeId) {
+                        remapped.push_back(connectedId > nodeId ? connectedId - 1 : connectedId);
+                    }
+                }
+                node.connections = remapped;
+            }
+            m_polyMesh.reset();
+            markGraphDirty();
         }
     }
     
+    void NavigationMesh::setNodeWalkable(int nodeId, bool walkable) {
+        if (nodeId < 0 || nodeId >= static_cast<int>(m_nodes.size()) || m_nodes[nodeId].walkable == walkable) {
+            return;
+        }
+        
+        {
+            std::unique_lock<std::shared_mutex> lock(m_graphMutex);
+            m_nodes[nodeId].walkable = walkable;
+            if (!m_graphDirty.load(std::memory_order_relaxed)) {
+                m_graph.setWalkable(nodeId, walkable);
+            }
+        }
+        m_revision++;
+    }
+    
     void NavigationMesh::clear() {
         m_nodes.clear();
         m_connections.clear();
+        m_polyMesh.reset();
+        markGraphDirty();
     }
     
-    std::vector<glm::vec3> NavigationMesh::findPath(const glm::vec3& start, const glm::vec3& end) const {
-        // Simplified A* implementation
-        // In a real implementation, this would be much more sophisticated
-        
-        std::vector<glm::vec3> path;
+    void NavigationMesh::setPolyMesh(std::shared_ptr<const NavPolyMesh> polyMesh) {
+        m_nodes.clear();
+        m_connections.clear();
+        m_polyMesh = std::move(polyMesh);
+        if (m_polyMesh) {
+            m_nodes.reserve(m_polyMesh->getPolyCount());
+            for (int i = 0; i < m_polyMesh->getPolyCount(); ++i) {
+                const NavPoly& poly = m_polyMesh->getPoly(i);
+                NavNode node;
+                node.position = m_polyMesh->getPolyCenter(i);
+                node.cost = 1.0f;
+                node.walkable = true;
+                for (int k = 0; k < poly.vertCount; ++k) {
+                    if (poly.neighbors[k] >= 0) {
+                        node.connections.push_back(poly.neighbors[k]);
+                    }
+                }
+                m_nodes.push_back(node);
+            }
+        }
+        markGraphDirty();
+    }
+    
+    void NavigationMesh::ensureGraph() const {
+        if (!m_graphDirty.load(std::memory_order_acquire)) {
+            return;
+        }
         
-        // Find closest nodes to start and end positions
-        int startNode = -1;
-        int endNode = -1;
-        float minStartDistance = std::numeric_limits<float>::max();
-        float minEndDistance = std::numeric_limits<float>::max();
+        std::unique_lock<std::shared_mutex> lock(m_graphMutex);
+        if (!m_graphDirty.load(std::memory_order_relaxed)) {
+            return;
+        }
         
+        std::vector<glm::vec3> positions;
+        std::vector<float> costs;
+        std::vector<bool> walkable;
+        std::vector<NavGraph::Edge> edges;
+        positions.reserve(m_nodes.size());
+        costs.reserve(m_nodes.size());
+        walkable.reserve(m_nodes.size());
         for (size_t i = 0; i < m_nodes.size(); ++i) {
-            float startDistance = glm::distance(start, m_nodes[i].position);
-            float endDistance = glm::distance(end, m_nodes[i].position);
-            
-            if (startDistance < minStartDistance) {
-                minStartDistance = startDistance;
-                startNode = static_cast<int>(i);
+            const NavNode& node = m_nodes[i];
+            positions.push_back(node.position);
+            costs.push_back(node.cost);
+            walkable.push_back(node.walkable);
+            for (int connectedId : node.connections) {
+                edges.push_back({static_cast<int>(i), connectedId});
             }
-            
-            if (endDistance < minEndDistance) {
-                minEndDistance = endDistance;
-                endNode = static_cast<int>(i);
+        }
+        for (const auto& pair : m_connections) {
+            for (int connectedId : pair.second) {
+                edges.push_back({pair.first, connectedId});
             }
         }
         
+        m_graph.build(positions, costs, walkable, edges);
+        m_spatialGrid.build(m_graph);
+        m_graphDirty.store(false, std::memory_order_release);
+    }
+    
+    const NavGraph& NavigationMesh::getGraph() const {
+        ensureGraph();
+        return m_graph;
+    }
+    
+    int NavigationMesh::findNearestNode(const glm::vec3& position) const {
+        ensureGraph();
+        std::shared_lock<std::shared_mutex> lock(m_graphMutex);
+        return nearestNodeLocked(position);
+    }
+    
+    bool NavigationMesh::findNodePath(int startNode, int endNode, std::vector<int>& path) const {
+        ensureGraph();
+        std::shared_lock<std::shared_mutex> lock(m_graphMutex);
+        return nodePathLocked(startNode, endNode, path);
+    }
+    
+    int NavigationMesh::nearestNodeLocked(const glm::vec3& position) const {
+        return m_spatialGrid.findNearest(m_graph, position);
+    }
+    
+    bool NavigationMesh::nodePathLocked(int startNode, int endNode, std::vector<int>& path) const {
+        // Scratch is per thread and grows to the largest graph searched, so
+        // steady-state queries do not allocate
+        thread_local AStarSearch search;
+        return search.findPath(m_graph, startNode, endNode, path);
+    }
+    
+    std::vector<glm::vec3> NavigationMesh::findPath(const glm::vec3& start, const glm::vec3& end) const {
+        std::vector<glm::vec3> path;
+        
+        // One shared lock for the whole query, so a walkability patch cannot
+        // land between the search and reading back its node positions
+        ensureGraph();
+        std::shared_lock<std::shared_mutex> lock(m_graphMutex);
+        
+        if (m_polyMesh) {
+            return findPolyPath(start, end);
+        }
+        
+        int startNode = nearestNodeLocked(start);
+        int endNode = nearestNodeLocked(end);
+        
         if (startNode == -1 || endNode == -1) {
             // No valid nodes found, return direct path
             path.push_back(start);
@@ -200,32 +364,62 @@ namespace Sparky {
             return path;
         }
         
-        // Simple path - just connect start to end node
-        // In a real implementation, this would use A* pathfinding
+        thread_local std::vector<int> nodePath;
+        if (!nodePathLocked(startNode, endNode, nodePath)) {
+            // Unreachable
+            return path;
+        }
+        
+        path.reserve(nodePath.size() + 1);
         path.push_back(start);
-        path.push_back(m_nodes[endNode].position);
+        for (int node : nodePath) {
+            path.push_back(m_graph.getPosition(node));
+        }
         
         return path;
     }
     
-    glm::vec3 NavigationMesh::getClosestNodePosition(const glm::vec3& position) const {
-        if (m_nodes.empty()) return position;
+    std::vector<glm::vec3> NavigationMesh::findPolyPath(const glm::vec3& start, const glm::vec3& end) const {
+        std::vector<glm::vec3> path;
+        
+        int startPoly = m_polyMesh->findPoly(start);
+        int endPoly = m_polyMesh->findPoly(end);
+        if (startPoly == -1) startPoly = nearestNodeLocked(start);
+        if (endPoly == -1) endPoly = nearestNodeLocked(end);
         
-        glm::vec3 closest = m_nodes[0].position;
-        float minDistance = glm::distance(position, closest);
+        thread_local std::vector<int> corridor;
+        if (startPoly == -1 || endPoly == -1 || !nodePathLocked(startPoly, endPoly, corridor)) {
+            return path;
+        }
         
-        for (const auto& node : m_nodes) {
-            float distance = glm::distance(position, node.position);
-            if (distance < minDistance) {
-                minDistance = distance;
-                closest = node.position;
+        // Nodes added by hand after setPolyMesh() have no polygon to funnel through
+        for (int node : corridor) {
+            if (node >= m_polyMesh->getPolyCount()) {
+                path.push_back(start);
+                for (int pathNode : corridor) {
+                    path.push_back(m_graph.getPosition(pathNode));
+                }
+                return path;
             }
         }
         
-        return closest;
+        m_polyMesh->findStraightPath(m_polyMesh->closestPointOnPoly(startPoly, start),
+                                     m_polyMesh->closestPointOnPoly(endPoly, end), corridor, path);
+        return path;
+    }
+    
+    glm::vec3 NavigationMesh::getClosestNodePosition(const glm::vec3& position) const {
+        ensureGraph();
+        std::shared_lock<std::shared_mutex> lock(m_graphMutex);
+        int node = nearestNodeLocked(position);
+        return node >= 0 ? m_graph.getPosition(node) : position;
     }
     
     bool NavigationMesh::isPositionWalkable(const glm::vec3& position) const {
+        if (m_polyMesh) {
+            return m_polyMesh->findPoly(position, 0.0f) != -1;
+        }
+        
         // Simplified check
         // In a real implementation, this would check against the navigation mesh
         return true;
@@ -239,35 +433,22 @@ namespace Sparky {
         return std::numeric_limits<float>::max();
     }
     
-    std::vector<glm::vec3> NavigationMesh::reconstructPath(int start, int end, const std::unordered_map<int, int>& cameFrom) const {
-        std::vector<glm::vec3> path;
-        int current = end;
-        
-        while (current != start) {
-            path.push_back(m_nodes[current].position);
-            auto it = cameFrom.find(current);
-            if (it == cameFrom.end()) break;
-            current = it->second;
-        }
-        
-        path.push_back(m_nodes[start].position);
-        std::reverse(path.begin(), path.end());
-        
-        return path;
-    }
-    
-    float NavigationMesh::heuristic(int from, int to) const {
-        return glm::distance(m_nodes[from].position, m_nodes[to].position);
-    }
-    
     // AdvancedAI implementation
     AdvancedAI::AdvancedAI()
         : m_difficulty(1.0f)
         , m_aggression(0.5f)
         , m_tacticalAwareness(0.5f)
         , m_navMesh(nullptr)
+        , m_pathQueryService(nullptr)
+        , m_pathTicket(INVALID_PATH_TICKET)
         , m_currentPathIndex(0)
         , m_isMoving(false)
+        , m_crowd(nullptr)
+        , m_crowdAgent(INVALID_CROWD_AGENT)
+        , m_influenceMap(nullptr)
+        , m_lodScheduler(nullptr)
+        , m_lodAgent(INVALID_AI_LOD_AGENT)
+        , m_lodLevel(AILODLevel::FULL)
         , m_currentTarget(nullptr)
         , m_inCombat(false)
         , m_takingCover(false)
@@ -276,6 +457,11 @@ namespace Sparky {
         , m_groupLeader(nullptr) {
     }
     
+    AdvancedAI::~AdvancedAI() {
+        // The scheduler holds a callback into this object
+        setLODScheduler(nullptr);
+    }
+    
     void AdvancedAI::initialize() {
         // Get required components
         m_perception = owner->getComponent<PerceptionComponent>();
@@ -293,6 +479,14 @@ namespace Sparky {
     }
     
     void AdvancedAI::update(float deltaTime) {
+        if (m_lodScheduler && m_lodAgent != INVALID_AI_LOD_AGENT) {
+            // The scheduler runs updateLOD() when this agent is due
+            if (owner) {
+                m_lodScheduler->setAgentState(m_lodAgent, owner->getPosition(), m_inCombat);
+            }
+            return;
+        }
+        
         // Update all AI subsystems
         updatePerception(deltaTime);
         updateMovement(deltaTime);
@@ -300,8 +494,34 @@ namespace Sparky {
         updateGroupBehavior(deltaTime);
     }
     
+    void AdvancedAI::updateLOD(float deltaTime, AILODLevel level) {
+        if (level != m_lodLevel) {
+            m_lodLevel = level;
+            if (m_perception) {
+                m_perception->setPerceptionPriority(level == AILODLevel::FULL ? PerceptionPriority::HIGH :
+                                                    level == AILODLevel::REDUCED ? PerceptionPriority::NORMAL :
+                                                    PerceptionPriority::LOW);
+            }
+        }
+        
+        updatePerception(deltaTime);
+        updateMovement(deltaTime);
+        if (level != AILODLevel::LOW) {
+            updateCombat(deltaTime);
+        }
+        if (level == AILODLevel::FULL) {
+            updateGroupBehavior(deltaTime);
+        }
+    }
+    
     void AdvancedAI::destroy() {
         // Cleanup AI system
+        if (m_pathQueryService && m_pathTicket != INVALID_PATH_TICKET) {
+            m_pathQueryService->cancel(m_pathTicket);
+            m_pathTicket = INVALID_PATH_TICKET;
+        }
+        setCrowdAvoidance(nullptr);
+        setLODScheduler(nullptr);
     }
     
     void AdvancedAI::render() {
@@ -336,8 +556,52 @@ namespace Sparky {
         m_navMesh = navMesh;
     }
     
+    void AdvancedAI::setPathQueryService(PathQueryService* service) {
+        if (m_pathQueryService && m_pathTicket != INVALID_PATH_TICKET) {
+            m_pathQueryService->cancel(m_pathTicket);
+            m_pathTicket = INVALID_PATH_TICKET;
+        }
+        m_pathQueryService = service;
+    }
+    
+    void AdvancedAI::setLODScheduler(AILODScheduler* scheduler) {
+        if (m_lodScheduler && m_lodAgent != INVALID_AI_LOD_AGENT) {
+            m_lodScheduler->removeAgent(m_lodAgent);
+        }
+        m_lodScheduler = scheduler;
+        m_lodAgent = INVALID_AI_LOD_AGENT;
+        m_lodLevel = AILODLevel::FULL;
+        if (m_lodScheduler) {
+            glm::vec3 position = owner ? owner->getPosition() : glm::vec3(0.0f);
+            m_lodAgent = m_lodScheduler->addAgent(position, [this](float deltaTime, AILODLevel level) {
+                updateLOD(deltaTime, level);
+            });
+        }
+    }
+    
+    void AdvancedAI::setCrowdAvoidance(CrowdAvoidance* crowd, float radius) {
+        if (m_crowd && m_crowdAgent != INVALID_CROWD_AGENT) {
+            m_crowd->removeAgent(m_crowdAgent);
+        }
+        m_crowd = crowd;
+        m_crowdAgent = INVALID_CROWD_AGENT;
+        if (m_crowd) {
+            glm::vec3 position = owner ? owner->getPosition() : glm::vec3(0.0f);
+            float speed = m_characterController ? m_characterController->getWalkSpeed() : 0.0f;
+            m_crowdAgent = m_crowd->addAgent(position, radius, speed);
+        }
+    }
+    
     void AdvancedAI::moveTo(const glm::vec3& target) {
-        if (m_navMesh) {
+        if (m_navMesh && m_pathQueryService) {
+            // Only the latest target matters
+            if (m_pathTicket != INVALID_PATH_TICKET) {
+                m_pathQueryService->cancel(m_pathTicket);
+            }
+            m_pathTicket = m_pathQueryService->submit(owner->getPosition(), target);
+            m_targetPosition = target;
+            m_isMoving = m_pathTicket != INVALID_PATH_TICKET;
+        } else if (m_navMesh) {
             glm::vec3 currentPosition = owner->getPosition();
             m_currentPath = m_navMesh->findPath(currentPosition, target);
             m_currentPathIndex = 0;
@@ -351,10 +615,18 @@ namespace Sparky {
     }
     
     void AdvancedAI::stopMovement() {
+        if (m_pathQueryService && m_pathTicket != INVALID_PATH_TICKET) {
+            m_pathQueryService->cancel(m_pathTicket);
+            m_pathTicket = INVALID_PATH_TICKET;
+        }
+        
         m_isMoving = false;
         m_currentPath.clear();
         m_currentPathIndex = 0;
         
+        if (m_crowd && m_crowdAgent != INVALID_CROWD_AGENT) {
+            m_crowd->setPreferredVelocity(m_crowdAgent, glm::vec3(0.0f));
+        }
         if (m_characterController) {
             m_characterController->move(glm::vec3(0.0f, 0.0f, 0.0f));
         }
@@ -448,9 +720,45 @@ namespace Sparky {
     }
     
     void AdvancedAI::updateMovement(float deltaTime) {
-        if (!m_isMoving || !m_characterController) return;
+        if (!m_characterController) return;
         
         glm::vec3 currentPosition = owner->getPosition();
+        bool inCrowd = m_crowd && m_crowdAgent != INVALID_CROWD_AGENT;
+        if (inCrowd) {
+            m_crowd->setAgentState(m_crowdAgent, currentPosition, m_characterController->getVelocity());
+        }
+        
+        if (!m_isMoving) {
+            // Idle crowd members still step aside for agents passing through
+            if (inCrowd) {
+                steer(glm::vec3(0.0f));
+            }
+            return;
+        }
+        
+        if (m_pathTicket != INVALID_PATH_TICKET) {
+            if (m_pathQueryService->getStatus(m_pathTicket) == PathQueryStatus::PENDING) {
+                // Keep heading for the old path's waypoint until the new path arrives
+                if (m_currentPathIndex < m_currentPath.size() &&
+                    glm::distance(currentPosition, m_currentPath[m_currentPathIndex]) >= 0.5f) {
+                    steer(glm::normalize(m_currentPath[m_currentPathIndex] - currentPosition));
+                } else {
+                    steer(glm::vec3(0.0f, 0.0f, 0.0f));
+                }
+                return;
+            }
+            
+            m_pathQueryService->takeResult(m_pathTicket, m_currentPath);
+            m_pathTicket = INVALID_PATH_TICKET;
+            m_currentPathIndex = 0;
+            
+            if (m_currentPath.empty()) {
+                // No path to the target
+                m_isMoving = false;
+                steer(glm::vec3(0.0f, 0.0f, 0.0f));
+                return;
+            }
+        }
         
         if (!m_currentPath.empty() && m_currentPathIndex < m_currentPath.size()) {
             glm::vec3 targetPosition = m_currentPath[m_currentPathIndex];
@@ -464,7 +772,7 @@ namespace Sparky {
                 if (m_currentPathIndex >= m_currentPath.size()) {
                     // Reached the end of the path
                     m_isMoving = false;
-                    m_characterController->move(glm::vec3(0.0f, 0.0f, 0.0f));
+                    steer(glm::vec3(0.0f, 0.0f, 0.0f));
                     return;
                 }
                 
@@ -473,7 +781,7 @@ namespace Sparky {
             
             // Calculate movement direction
             glm::vec3 direction = glm::normalize(targetPosition - currentPosition);
-            m_characterController->move(direction);
+            steer(direction);
         } else {
             // Direct movement to target position
             glm::vec3 direction = glm::normalize(m_targetPosition - currentPosition);
@@ -482,13 +790,26 @@ namespace Sparky {
             if (distance < 0.5f) {
                 // Reached target
                 m_isMoving = false;
-                m_characterController->move(glm::vec3(0.0f, 0.0f, 0.0f));
+                steer(glm::vec3(0.0f, 0.0f, 0.0f));
             } else {
-                m_characterController->move(direction);
+                steer(direction);
             }
         }
     }
     
+    void AdvancedAI::steer(const glm::vec3& direction) {
+        if (!m_crowd || m_crowdAgent == INVALID_CROWD_AGENT) {
+            m_characterController->move(direction);
+            return;
+        }
+        
+        float speed = m_characterController->getWalkSpeed();
+        m_crowd->setMaxSpeed(m_crowdAgent, speed);
+        m_crowd->setPreferredVelocity(m_crowdAgent, direction * speed);
+        glm::vec3 velocity = m_crowd->getAvoidanceVelocity(m_crowdAgent);
+        m_characterController->move(speed > 0.0f ? velocity / speed : glm::vec3(0.0f));
+    }
+    
     void AdvancedAI::updateCombat(float deltaTime) {
         if (!m_inCombat) return;
         
@@ -535,7 +856,7 @@ namespace Sparky {
                     // Continue taking cover
                 } else {
                     // Decide between cover and flanking
-                    if (rand() % 2 == 0) {
+                    if (Random::getInstance().rangeInt(0, 2) == 0) {
                         takeCover();
                     } else {
                         flank(m_currentTarget);
@@ -553,13 +874,15 @@ namespace Sparky {
     }
     
     glm::vec3 AdvancedAI::findCoverPosition() {
-        // Simplified cover finding
-        // In a real implementation, this would analyze the environment for cover
-        
         if (owner && m_currentTarget) {
             glm::vec3 ownerPos = owner->getPosition();
             glm::vec3 targetPos = m_currentTarget->getPosition();
             
+            glm::vec3 coverPosition;
+            if (m_influenceMap && m_influenceMap->findCoverPosition(ownerPos, targetPos, 15.0f, coverPosition)) {
+                return coverPosition;
+            }
+            
             // Move perpendicular to the line between owner and target
             glm::vec3 direction = glm::normalize(targetPos - ownerPos);
             glm::vec3 perpendicular(-direction.z, 0.0f, direction.x);
@@ -571,13 +894,17 @@ namespace Sparky {
     }
     
     glm::vec3 AdvancedAI::findFlankPosition() {
-        // Simplified flanking position calculation
-        // In a real implementation, this would find optimal flanking positions
-        
         if (owner && m_currentTarget) {
             glm::vec3 ownerPos = owner->getPosition();
             glm::vec3 targetPos = m_currentTarget->getPosition();
             
+            // Search far enough to reach the target's sides
+            glm::vec3 flankPosition;
+            float radius = std::max(15.0f, glm::distance(ownerPos, targetPos) * 1.5f);
+            if (m_influenceMap && m_influenceMap->findFlankPosition(ownerPos, targetPos, radius, flankPosition)) {
+                return flankPosition;
+            }
+            
             // Move to the side of the target
             glm::vec3 direction = glm::normalize(targetPos - ownerPos);
             glm::vec3 flankDirection(-direction.z, 0.0f, direction.x);
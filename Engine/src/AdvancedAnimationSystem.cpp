@@ -1,4 +1,5 @@
 #include "../include/AdvancedAnimationSystem.h"
+#include "../include/AnimationGraph.h"
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -12,11 +13,17 @@ namespace Sparky {
     // AnimationClip implementation
     AnimationClip::AnimationClip(const std::string& name)
         : m_name(name)
-        , m_duration(0.0f) {
+        , m_duration(0.0f)
+        , m_revision(0) {
     }
     
     void AnimationClip::addKeyframe(int boneId, const Keyframe& keyframe) {
-        m_keyframes[boneId].push_back(keyframe);
+        auto found = m_keyframes.find(boneId);
+        if (found == m_keyframes.end()) {
+            found = m_keyframes.emplace(boneId, std::vector<Keyframe>()).first;
+            m_boneIds.insert(std::lower_bound(m_boneIds.begin(), m_boneIds.end(), boneId), boneId);
+        }
+        std::vector<Keyframe>& keyframes = found->second;
         
         // Update duration if this keyframe is later
         if (keyframe.time > m_duration) {
@@ -24,10 +31,12 @@ namespace Sparky {
         }
         
         // Keep keyframes sorted by time
-        std::sort(m_keyframes[boneId].begin(), m_keyframes[boneId].end(),
+        auto it = std::upper_bound(keyframes.begin(), keyframes.end(), keyframe,
             [](const Keyframe& a, const Keyframe& b) {
                 return a.time < b.time;
             });
+        keyframes.insert(it, keyframe);
+        ++m_revision;
     }
     
     const std::vector<Keyframe>& AnimationClip::getKeyframes(int boneId) const {
@@ -41,65 +50,53 @@ namespace Sparky {
     
     void AnimationClip::evaluate(float time, std::unordered_map<int, glm::mat4>& boneTransforms) const {
         for (const auto& pair : m_keyframes) {
-            int boneId = pair.first;
-            const std::vector<Keyframe>& keyframes = pair.second;
-            
-            if (keyframes.empty()) continue;
-            
-            // Handle time wrapping for looping animations
-            float evalTime = time;
-            if (m_duration > 0.0f) {
-                evalTime = fmod(time, m_duration);
-            }
-            
-            // Find the keyframes to interpolate between
-            const Keyframe* prev = nullptr;
-            const Keyframe* next = nullptr;
-            
-            for (const auto& keyframe : keyframes) {
-                if (keyframe.time <= evalTime) {
-                    prev = &keyframe;
-                } else {
-                    next = &keyframe;
-                    break;
-                }
-            }
-            
-            // If we're past the last keyframe, use it
-            if (!next && !keyframes.empty()) {
-                next = &keyframes.back();
-                prev = next;
-            }
-            
-            // If we're before the first keyframe, use it
-            if (!prev && !keyframes.empty()) {
-                prev = &keyframes.front();
-                next = prev;
-            }
-            
-            // Interpolate between keyframes
-            if (prev && next) {
-                float t = 0.0f;
-                if (prev != next) {
-                    t = (evalTime - prev->time) / (next->time - prev->time);
-                }
-                
-                Keyframe interpolated = interpolateKeyframes(*prev, *next, t);
-                
-                // Create transformation matrix
-                glm::vec3 posVec(interpolated.position[0], interpolated.position[1], interpolated.position[2]);
-                glm::quat rotQuat(interpolated.rotation[3], interpolated.rotation[0], interpolated.rotation[1], interpolated.rotation[2]);
-                glm::vec3 scaleVec(interpolated.scale[0], interpolated.scale[1], interpolated.scale[2]);
-                
-                glm::mat4 translation = glm::translate(glm::mat4(1.0f), posVec);
-                glm::mat4 rotation = glm::mat4_cast(rotQuat);
-                glm::mat4 scale = glm::scale(glm::mat4(1.0f), scaleVec);
-                
-                boneTransforms[boneId] = translation * rotation * scale;
-            }
+            if (pair.second.empty()) continue;
+            boneTransforms[pair.first] = evaluateKeyframes(pair.second, time);
         }
     }
     
+    bool AnimationClip::evaluateBone(int boneId, float time, glm::mat4& transform) const {
+        auto it = m_keyframes.find(boneId);
+        if (it == m_keyframes.end() || it->second.empty()) {
+            return false;
+        }
+        transform = evaluateKeyframes(it->second, time);
+        return true;
+    }
+    
+    glm::mat4 AnimationClip::evaluateKeyframes(const std::vector<Keyframe>& keyframes, float time) const {
+        // Handle time wrapping for looping animations
+        float evalTime = time;
+        if (m_duration > 0.0f) {
+            evalTime = fmod(time, m_duration);
+        }
+        
+        // Find the keyframes to interpolate between; before the first or past the last one, hold it
+        int count = static_cast<int>(keyframes.size());
+        int index = findKeyframe(keyframes.data(), count, evalTime);
+        const Keyframe* prev = &keyframes[std::max(index, 0)];
+        const Keyframe* next = (index >= 0 && index + 1 < count) ? &keyframes[index + 1] : prev;
+        
+        // Interpolate between keyframes
+        float t = 0.0f;
+        if (prev != next) {
+            t = (evalTime - prev->time) / (next->time - prev->time);
+        }
+        
+        Keyframe interpolated = interpolateKeyframes(*prev, *next, t);
+        
+        // Create transformation matrix
+        glm::vec3 posVec(interpolated.position[0], interpolated.position[1], interpolated.position[2]);
+        glm::quat rotQuat(interpolated.rotation[3], interpolated.rotation[0], interpolated.rotation[1], interpolated.rotation[2]);
+        glm::vec3 scaleVec(interpolated.scale[0], interpolated.scale[1], interpolated.scale[2]);
+        
+        glm::mat4 translation = glm::translate(glm::mat4(1.0f), posVec);
+        glm::mat4 rotation = glm::mat4_cast(rotQuat);
+        glm::mat4 scale = glm::scale(glm::mat4(1.0f), scaleVec);
+        
+        return translation * rotation * scale;
+    }
+    
     void AnimationClip::addEvent(const AnimationEvent& event) {
         m_events.push_back(event);
         
@@ -142,10 +139,19 @@ namespace Sparky {
         , m_isPlaying(false)
         , m_isPaused(false)
         , m_isLooping(true)
+        , m_blendingTime(0.0f)
+        , m_skeletonDirty(true)
+        , m_innerBoneCount(0)
+        , m_skipLeafBones(false)
+        , m_poseHistory(false)
+        , m_outputInterpolated(false)
+        , m_evaluatedBones(0)
         , m_blendTime(0.2f)
         , m_blendProgress(0.0f)
         , m_blendMode(BlendMode::LINEAR)
-        , m_isBlending(false) {
+        , m_isBlending(false)
+        , m_eventClip(nullptr)
+        , m_updatedBySystem(false) {
     }
     
     void SkeletalAnimation::initialize() {
@@ -153,6 +159,16 @@ namespace Sparky {
     }
     
     void SkeletalAnimation::update(float deltaTime) {
+        if (m_updatedBySystem) return;
+        
+        evaluate(deltaTime);
+        dispatchEvents();
+    }
+    
+    void SkeletalAnimation::evaluate(float deltaTime) {
+        m_eventClip = nullptr;
+        m_firedEvents.clear();
+        m_evaluatedBones = 0;
         if (!m_isPlaying || m_isPaused) return;
         
         updateAnimation(deltaTime);
@@ -162,6 +178,26 @@ namespace Sparky {
         }
     }
     
+    int SkeletalAnimation::dispatchEvents() {
+        if (!m_eventClip) return 0;
+        
+        // A callback may change playback, so take the list first
+        const AnimationClip* clip = m_eventClip;
+        m_eventClip = nullptr;
+        int fired = 0;
+        for (int index : m_firedEvents) {
+            const std::vector<AnimationEvent>& events = clip->getEvents();
+            if (index >= static_cast<int>(events.size())) break;
+            auto callbackIt = m_eventCallbacks.find(events[index].name);
+            if (callbackIt != m_eventCallbacks.end() && callbackIt->second) {
+                callbackIt->second();
+                ++fired;
+            }
+        }
+        m_firedEvents.clear();
+        return fired;
+    }
+    
     void SkeletalAnimation::destroy() {
         // Cleanup skeletal animation system
     }
@@ -173,6 +209,7 @@ namespace Sparky {
     void SkeletalAnimation::addBone(const Bone& bone) {
         m_bones.push_back(bone);
         m_boneNameToId[bone.name] = bone.id;
+        m_skeletonDirty = true;
     }
     
     SkeletalAnimation::Bone* SkeletalAnimation::getBone(int id) {
@@ -247,6 +284,7 @@ namespace Sparky {
         m_blendProgress = 0.0f;
         m_blendMode = mode;
         m_isBlending = true;
+        m_blendingTime = 0.0f;
     }
     
     const glm::mat4& SkeletalAnimation::getBoneTransform(int boneId) const {
@@ -257,6 +295,14 @@ namespace Sparky {
         return identity;
     }
     
+    const glm::mat4& SkeletalAnimation::getBoneModelTransform(int boneId) const {
+        static glm::mat4 identity(1.0f);
+        if (boneId >= 0 && boneId < static_cast<int>(m_modelTransforms.size())) {
+            return m_modelTransforms[boneId];
+        }
+        return identity;
+    }
+    
     std::vector<glm::mat4> SkeletalAnimation::getBoneTransforms() const {
         std::vector<glm::mat4> transforms;
         transforms.reserve(m_bones.size());
@@ -284,55 +330,138 @@ namespace Sparky {
             m_currentTime = fmod(m_currentTime, clip->getDuration());
         }
         
-        // Evaluate animation
-        std::unordered_map<int, glm::mat4> boneTransforms;
-        clip->evaluate(m_currentTime, boneTransforms);
+        // Sample into the bone-indexed pose; cursors make forward playback cheap on long clips
+        if (m_skeletonDirty) {
+            rebuildSkeleton();
+        }
+        if (m_sampler.getClip() != clip || m_pose.getBoneCount() != m_skeleton.getBoneCount()) {
+            m_sampler.bind(clip);
+            m_pose.reset(m_skeleton.getBoneCount());
+        }
+        if (m_poseHistory) {
+            m_previousPose = m_pose;
+        }
+        if (m_skipLeafBones) {
+            m_sampler.sample(m_currentTime, m_pose, m_innerBones);
+            m_evaluatedBones = m_innerBoneCount;
+        } else {
+            m_sampler.sample(m_currentTime, m_pose);
+            m_evaluatedBones = m_pose.getBoneCount();
+        }
         
-        // Update bone transformations
-        for (auto& bone : m_bones) {
-            auto it = boneTransforms.find(bone.id);
-            if (it != boneTransforms.end()) {
-                bone.finalTransformation = it->second;
-            } else {
-                // Use identity if no keyframe
-                bone.finalTransformation = glm::mat4(1.0f);
+        // Crossfade towards the target clip
+        if (m_isBlending) {
+            AnimationClip* target = getAnimationClip(m_blendingToAnimation);
+            if (target) {
+                if (m_blendSampler.getClip() != target || m_blendPose.getBoneCount() != m_skeleton.getBoneCount()) {
+                    m_blendSampler.bind(target);
+                    m_blendPose.reset(m_skeleton.getBoneCount());
+                }
+                m_blendingTime += deltaTime;
+                if (m_skipLeafBones) {
+                    m_blendSampler.sample(m_blendingTime, m_blendPose, m_innerBones);
+                } else {
+                    m_blendSampler.sample(m_blendingTime, m_blendPose);
+                }
+                float factor = getBlendFactor(std::min(m_blendProgress, 1.0f), m_blendMode);
+                blendPoses(m_pose, m_blendPose, factor, m_pose);
             }
         }
         
-        // Handle events
+        m_outputInterpolated = false;
+        buildBoneMatrices(m_pose);
+        
+        // Record events; dispatchEvents() calls their callbacks
         const std::vector<AnimationEvent>& events = clip->getEvents();
-        for (const auto& event : events) {
-            if (fabs(m_currentTime - event.time) < deltaTime) {
-                // Trigger event
-                auto callbackIt = m_eventCallbacks.find(event.name);
-                if (callbackIt != m_eventCallbacks.end() && callbackIt->second) {
-                    callbackIt->second();
-                }
+        for (size_t i = 0; i < events.size(); ++i) {
+            if (fabs(m_currentTime - events[i].time) < deltaTime) {
+                m_firedEvents.push_back(static_cast<int>(i));
             }
         }
+        if (!m_firedEvents.empty()) {
+            m_eventClip = clip;
+        }
     }
     
     void SkeletalAnimation::updateBlending(float deltaTime) {
         m_blendProgress += deltaTime / m_blendTime;
         
         if (m_blendProgress >= 1.0f) {
-            // Blending complete
+            // Blending complete; the target carries on from where the blend left it
             m_currentAnimation = m_blendingToAnimation;
-            m_currentTime = 0.0f;
+            m_currentTime = m_blendingTime;
             m_isBlending = false;
             m_blendingToAnimation.clear();
         }
     }
     
+    void SkeletalAnimation::setPoseHistory(bool enabled) {
+        m_poseHistory = enabled;
+        if (!enabled) {
+            m_previousPose.reset(0);
+            m_outputInterpolated = false;
+        }
+    }
+    
+    void SkeletalAnimation::interpolatePose(float alpha) {
+        if (m_previousPose.getBoneCount() == 0 || m_previousPose.getBoneCount() != m_pose.getBoneCount()) return;
+        
+        blendPoses(m_previousPose, m_pose, alpha, m_interpolatedPose);
+        m_outputInterpolated = true;
+        buildBoneMatrices(m_interpolatedPose);
+    }
+    
+    void SkeletalAnimation::rebuildBoneMatrices() {
+        if (m_skeletonDirty) {
+            rebuildSkeleton();
+        }
+        buildBoneMatrices(getOutputPose());
+    }
+    
+    void SkeletalAnimation::buildBoneMatrices(const AnimationPose& pose) {
+        // Concatenate down the hierarchy; bones without keyframes keep the identity local transform
+        m_skeleton.computeModelTransforms(pose, m_modelTransforms);
+        m_skeleton.computeSkinningMatrices(m_modelTransforms, m_skinningMatrices);
+        for (auto& bone : m_bones) {
+            if (bone.id >= 0 && bone.id < static_cast<int>(m_skinningMatrices.size())) {
+                bone.finalTransformation = m_skinningMatrices[bone.id];
+            } else {
+                bone.finalTransformation = glm::mat4(1.0f);
+            }
+        }
+    }
+    
+    void SkeletalAnimation::rebuildSkeleton() {
+        // Bones are indexed by id, as getBone(int) expects
+        int boneCount = 0;
+        for (const auto& bone : m_bones) {
+            boneCount = std::max(boneCount, bone.id + 1);
+        }
+        std::vector<int> parents(boneCount, -1);
+        std::vector<glm::mat4> inverseBindPose(boneCount, glm::mat4(1.0f));
+        for (const auto& bone : m_bones) {
+            if (bone.id < 0) continue;
+            parents[bone.id] = bone.parentId;
+            inverseBindPose[bone.id] = bone.offsetMatrix;
+        }
+        m_skeleton.build(parents, inverseBindPose);
+        m_skeletonDirty = false;
+        
+        // Leaf bones are the ones no bone names as its parent
+        const std::vector<int>& builtParents = m_skeleton.getParents();
+        m_innerBones.assign(boneCount, 0);
+        for (int parent : builtParents) {
+            if (parent >= 0) m_innerBones[parent] = 1;
+        }
+        m_innerBoneCount = static_cast<int>(std::count(m_innerBones.begin(), m_innerBones.end(), 1));
+    }
+    
     glm::mat4 SkeletalAnimation::calculateBoneTransform(int boneId, float time, AnimationClip* clip) const {
         if (!clip) return glm::mat4(1.0f);
         
-        std::unordered_map<int, glm::mat4> boneTransforms;
-        clip->evaluate(time, boneTransforms);
-        
-        auto it = boneTransforms.find(boneId);
-        if (it != boneTransforms.end()) {
-            return it->second;
+        glm::mat4 transform;
+        if (clip->evaluateBone(boneId, time, transform)) {
+            return transform;
         }
         
         return glm::mat4(1.0f);
@@ -356,7 +485,9 @@ namespace Sparky {
     
     // InverseKinematics implementation
     InverseKinematics::InverseKinematics()
-        : m_skeletalAnimation(nullptr) {
+        : m_updatedBySystem(false)
+        , m_skeletalAnimation(nullptr)
+        , m_stats() {
     }
     
     void InverseKinematics::initialize() {
@@ -367,10 +498,19 @@ namespace Sparky {
     }
     
     void InverseKinematics::update(float deltaTime) {
-        // Solve all IK chains
+        if (m_updatedBySystem) return;
+        
+        solveChains();
+    }
+    
+    void InverseKinematics::solveChains() {
+        // Solve all IK chains together
+        m_batch.clear();
+        m_batchChains.clear();
         for (size_t i = 0; i < m_chains.size(); ++i) {
-            solveIK(static_cast<int>(i));
+            gatherChain(static_cast<int>(i));
         }
+        solveBatch();
     }
     
     void InverseKinematics::destroy() {
@@ -407,7 +547,10 @@ namespace Sparky {
     }
     
     void InverseKinematics::solveIK(int chainId) {
-        solveCCD(chainId);
+        m_batch.clear();
+        m_batchChains.clear();
+        gatherChain(chainId);
+        solveBatch();
     }
     
     void InverseKinematics::setJointConstraints(int chainId, int jointIndex, float minAngle, float maxAngle) {
@@ -420,65 +563,100 @@ namespace Sparky {
         }
     }
     
-    void InverseKinematics::solveCCD(int chainId) {
+    void InverseKinematics::gatherChain(int chainId) {
         if (!m_skeletalAnimation) return;
         
         IKChain* chain = getIKChain(chainId);
-        if (!chain) return;
+        if (!chain || chain->joints.empty()) return;
         
         auto targetIt = m_targets.find(chainId);
         if (targetIt == m_targets.end()) return;
         
-        glm::vec3 target = targetIt->second;
+        // Model-space positions are read once; the solvers work on the copy
+        m_points.clear();
+        m_minBends.clear();
+        m_maxBends.clear();
+        for (const auto& joint : chain->joints) {
+            m_points.push_back(getBonePosition(joint.boneId));
+            m_minBends.push_back(joint.minAngle);
+            m_maxBends.push_back(joint.maxAngle);
+        }
+        m_points.push_back(getBonePosition(chain->effectorBoneId));
+        m_minBends.push_back(1.0f);
+        m_maxBends.push_back(0.0f);
+        
+        auto poleIt = m_poles.find(chainId);
+        const glm::vec3* pole = poleIt != m_poles.end() ? &poleIt->second : nullptr;
+        m_batch.addChain(m_points.data(), static_cast<int>(m_points.size()), targetIt->second, pole,
+                         m_minBends.data(), m_maxBends.data());
+        m_batchChains.push_back(chainId);
+    }
+    
+    void InverseKinematics::solveBatch() {
+        m_stats = IKSolveStats();
+        if (!m_skeletalAnimation || m_batch.getChainCount() == 0) return;
+        
+        AnimationPose& pose = m_skeletalAnimation->getOutputPose();
+        if (pose.getBoneCount() == 0) return;
+        
+        solveIKBatch(m_batch, m_solverSettings, m_stats);
+        for (int batchChain = 0; batchChain < m_batch.getChainCount(); ++batchChain) {
+            applyChain(batchChain, pose);
+        }
+        m_skeletalAnimation->rebuildBoneMatrices();
+    }
+    
+    void InverseKinematics::applyChain(int batchChain, AnimationPose& pose) {
+        const IKChain& chain = m_chains[m_batchChains[batchChain]];
+        const glm::vec3* solved = m_batch.positions.data() + m_batch.offsets[batchChain];
+        const int boneCount = pose.getBoneCount();
         
-        // CCD (Cyclic Coordinate Descent) algorithm
-        const int maxIterations = 10;
-        const float epsilon = 0.01f;
+        // Model rotation of the first joint's parent, which IK leaves alone
+        glm::quat parentRotation(1.0f, 0.0f, 0.0f, 0.0f);
+        const SkeletalAnimation::Bone* first = m_skeletalAnimation->getBone(chain.joints[0].boneId);
+        if (first && first->parentId >= 0) {
+            glm::mat3 parent(m_skeletalAnimation->getBoneModelTransform(first->parentId));
+            for (int axis = 0; axis < 3; ++axis) {
+                parent[axis] = glm::normalize(parent[axis]);
+            }
+            parentRotation = glm::quat_cast(parent);
+        }
         
-        for (int iteration = 0; iteration < maxIterations; ++iteration) {
-            glm::vec3 effectorPos = getBonePosition(chain->effectorBoneId);
-            float distance = glm::distance(effectorPos, target);
+        // Turn each bone from where the joints above left it onto its solved direction. The
+        // model matrices still hold the pose from before IK, so the original joints come from there.
+        glm::quat applied(1.0f, 0.0f, 0.0f, 0.0f);
+        glm::vec3 from = getBonePosition(chain.joints[0].boneId);
+        for (size_t i = 0; i < chain.joints.size(); ++i) {
+            int bone = chain.joints[i].boneId;
+            if (bone < 0 || bone >= boneCount) break;
             
-            if (distance < epsilon) break;
+            int childBone = i + 1 < chain.joints.size() ? chain.joints[i + 1].boneId : chain.effectorBoneId;
+            glm::vec3 to = getBonePosition(childBone);
+            glm::vec3 current = applied * (to - from);
+            glm::vec3 desired = solved[i + 1] - solved[i];
+            from = to;
             
-            // Iterate backwards through the chain
-            for (int i = static_cast<int>(chain->joints.size()) - 1; i >= 0; --i) {
-                int boneId = chain->joints[i].boneId;
-                
-                glm::vec3 jointPos = getBonePosition(boneId);
-                glm::vec3 toEffector = glm::normalize(effectorPos - jointPos);
-                glm::vec3 toTarget = glm::normalize(target - jointPos);
-                
-                float angle = acos(glm::clamp(glm::dot(toEffector, toTarget), -1.0f, 1.0f));
-                
-                // Apply angle constraints
-                angle = glm::clamp(angle, chain->joints[i].minAngle, chain->joints[i].maxAngle);
-                
-                if (angle > epsilon) {
-                    glm::vec3 axis = glm::normalize(glm::cross(toEffector, toTarget));
-                    glm::quat rotation = glm::angleAxis(angle, axis);
-                    setBoneRotation(boneId, rotation);
-                }
+            glm::quat delta = applied;
+            if (glm::length(current) > 1e-6f && glm::length(desired) > 1e-6f) {
+                delta = glm::rotation(glm::normalize(current), glm::normalize(desired)) * applied;
             }
+            
+            // New local rotation = inverse(new parent model rotation) * new model rotation
+            glm::quat local = pose.rotations[bone];
+            pose.rotations[bone] = glm::normalize(glm::inverse(applied * parentRotation) * delta * parentRotation * local);
+            parentRotation = parentRotation * local;
+            applied = delta;
         }
     }
     
     glm::vec3 InverseKinematics::getBonePosition(int boneId) const {
         if (m_skeletalAnimation) {
-            SkeletalAnimation::Bone* bone = m_skeletalAnimation->getBone(boneId);
-            if (bone) {
-                glm::vec4 pos = bone->finalTransformation * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
-                return glm::vec3(pos);
-            }
+            glm::vec4 pos = m_skeletalAnimation->getBoneModelTransform(boneId) * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+            return glm::vec3(pos);
         }
         return glm::vec3(0.0f);
     }
     
-    void InverseKinematics::setBoneRotation(int boneId, const glm::quat& rotation) {
-        // In a real implementation, this would update the bone's rotation
-        // For now, we'll just acknowledge the call
-    }
-    
     // AdvancedAnimationController implementation
     AdvancedAnimationController::AdvancedAnimationController()
         : m_currentState("Default")
@@ -486,7 +664,14 @@ namespace Sparky {
         , m_transitionTimer(0.0f)
         , m_transitionDuration(0.0f)
         , m_isTransitioning(false)
-        , m_skeletalAnimation(nullptr) {
+        , m_skeletalAnimation(nullptr)
+        , m_updatedBySystem(false)
+        , m_graphBatch(nullptr)
+        , m_graphController(-1) {
+    }
+    
+    AdvancedAnimationController::~AdvancedAnimationController() {
+        setAnimationGraphBatch(nullptr);
     }
     
     void AdvancedAnimationController::initialize() {
@@ -505,6 +690,14 @@ namespace Sparky {
     }
     
     void AdvancedAnimationController::update(float deltaTime) {
+        if (m_updatedBySystem) return;
+        
+        advance(deltaTime);
+    }
+    
+    void AdvancedAnimationController::advance(float deltaTime) {
+        if (m_graphBatch) return;
+        
         updateState(deltaTime);
         updateTransitions(deltaTime);
         updateBlendTree(deltaTime);
@@ -562,19 +755,59 @@ namespace Sparky {
         }
     }
     
+    const std::string& AdvancedAnimationController::getCurrentState() const {
+        if (m_graphBatch && m_graphBatch->getGraph()) {
+            return m_graphBatch->getGraph()->getStateName(m_graphBatch->getCurrentState(m_graphController));
+        }
+        return m_currentState;
+    }
+    
+    void AdvancedAnimationController::setAnimationGraphBatch(AnimationGraphBatch* batch) {
+        if (m_graphBatch) {
+            m_graphBatch->removeController(m_graphController);
+            m_graphController = -1;
+        }
+        m_graphBatch = batch;
+        if (m_graphBatch) {
+            m_graphController = m_graphBatch->addController(m_skeletalAnimation);
+        }
+    }
+    
+    int AdvancedAnimationController::findGraphParameter(const std::string& name) const {
+        return m_graphBatch && m_graphBatch->getGraph() ? m_graphBatch->getGraph()->findParameter(name) : -1;
+    }
+    
     void AdvancedAnimationController::setFloatParameter(const std::string& name, float value) {
+        int parameter = findGraphParameter(name);
+        if (parameter >= 0) {
+            m_graphBatch->setFloat(m_graphController, parameter, value);
+            return;
+        }
         m_floatParameters[name] = value;
     }
     
     void AdvancedAnimationController::setBoolParameter(const std::string& name, bool value) {
+        int parameter = findGraphParameter(name);
+        if (parameter >= 0) {
+            m_graphBatch->setBool(m_graphController, parameter, value);
+            return;
+        }
         m_boolParameters[name] = value;
     }
     
     void AdvancedAnimationController::setIntParameter(const std::string& name, int value) {
+        int parameter = findGraphParameter(name);
+        if (parameter >= 0) {
+            m_graphBatch->setInt(m_graphController, parameter, value);
+            return;
+        }
         m_intParameters[name] = value;
     }
     
     float AdvancedAnimationController::getFloatParameter(const std::string& name) const {
+        int parameter = findGraphParameter(name);
+        if (parameter >= 0) return m_graphBatch->getFloat(m_graphController, parameter);
+        
         auto it = m_floatParameters.find(name);
         if (it != m_floatParameters.end()) {
             return it->second;
@@ -583,6 +816,9 @@ namespace Sparky {
     }
     
     bool AdvancedAnimationController::getBoolParameter(const std::string& name) const {
+        int parameter = findGraphParameter(name);
+        if (parameter >= 0) return m_graphBatch->getFloat(m_graphController, parameter) != 0.0f;
+        
         auto it = m_boolParameters.find(name);
         if (it != m_boolParameters.end()) {
             return it->second;
@@ -591,6 +827,9 @@ namespace Sparky {
     }
     
     int AdvancedAnimationController::getIntParameter(const std::string& name) const {
+        int parameter = findGraphParameter(name);
+        if (parameter >= 0) return static_cast<int>(m_graphBatch->getFloat(m_graphController, parameter));
+        
         auto it = m_intParameters.find(name);
         if (it != m_intParameters.end()) {
             return it->second;
@@ -245,7 +245,7 @@ namespace Sparky {
             return status;
         }
         
-        NodeStatus childStatus = child->update(deltaTime);
+        child->update(deltaTime);
         elapsed += deltaTime;
         
         // If time is up now, succeed
@@ -1,10 +1,10 @@
 #include "../include/AdvancedWeaponSystem.h"
 #include "../include/GameObject.h"
 #include "../include/BallisticsSystem.h"
+#include "../include/Random.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <algorithm>
-#include <random>
 #include <cmath>
 
 namespace Sparky {
@@ -470,14 +470,11 @@ namespace Sparky {
         if (effectiveSpread <= 0.0f) return direction;
         
         // Generate random spread
-        static std::random_device rd;
-        static std::mt19937 gen(rd());
-        static std::uniform_real_distribution<float> dis(-1.0f, 1.0f);
-        
+        Random& random = Random::getInstance();
         glm::vec3 spreadOffset(
-            dis(gen) * effectiveSpread,
-            dis(gen) * effectiveSpread,
-            dis(gen) * effectiveSpread
+            random.range(-1.0f, 1.0f) * effectiveSpread,
+            random.range(-1.0f, 1.0f) * effectiveSpread,
+            random.range(-1.0f, 1.0f) * effectiveSpread
         );
         
         return glm::normalize(direction + spreadOffset);
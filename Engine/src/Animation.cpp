@@ -37,7 +37,41 @@ namespace Sparky {
         keyframes.insert(it, keyframe);
     }
     
+    int findKeyframe(const Keyframe* keyframes, int count, float time, int hint) {
+        // Steps a forward-moving cursor takes before giving up and searching
+        const int maxForwardSteps = 4;
+        
+        int first = 0;
+        int last = count;
+        if (hint >= 0 && hint < count) {
+            if (keyframes[hint].time <= time) {
+                int index = hint;
+                for (int step = 0; step < maxForwardSteps; ++step) {
+                    if (index + 1 >= count || keyframes[index + 1].time > time) {
+                        return index;
+                    }
+                    ++index;
+                }
+                first = index + 1;
+            } else {
+                // Moved backwards (seek or loop): the answer is before the hint
+                last = hint;
+            }
+        }
+        
+        const Keyframe* it = std::upper_bound(keyframes + first, keyframes + last, time,
+                                              [](float t, const Keyframe& keyframe) {
+                                                  return t < keyframe.time;
+                                              });
+        return static_cast<int>(it - keyframes) - 1;
+    }
+    
     Keyframe AnimationTrack::getKeyframeAtTime(float time) const {
+        int cursor = -1;
+        return getKeyframeAtTime(time, cursor);
+    }
+    
+    Keyframe AnimationTrack::getKeyframeAtTime(float time, int& cursor) const {
         if (keyframes.empty()) {
             Keyframe emptyKeyframe;
             emptyKeyframe.time = 0.0f;
@@ -50,25 +84,21 @@ namespace Sparky {
         
         // If time is before the first keyframe, return the first keyframe
         if (time <= keyframes.front().time) {
+            cursor = 0;
             return keyframes.front();
         }
         
         // If time is after the last keyframe, return the last keyframe
         if (time >= keyframes.back().time) {
+            cursor = static_cast<int>(keyframes.size()) - 1;
             return keyframes.back();
         }
         
-        // Find the two keyframes that bracket the time
-        for (size_t i = 0; i < keyframes.size() - 1; ++i) {
-            if (time >= keyframes[i].time && time <= keyframes[i+1].time) {
-                // Interpolate between these two keyframes
-                float t = (time - keyframes[i].time) / (keyframes[i+1].time - keyframes[i].time);
-                return interpolateKeyframes(keyframes[i], keyframes[i+1], t);
-            }
-        }
-        
-        // Fallback - should not reach here
-        return keyframes.back();
+        // Find the two keyframes that bracket the time and interpolate between them
+        size_t i = static_cast<size_t>(findKeyframe(keyframes.data(), static_cast<int>(keyframes.size()), time, cursor));
+        cursor = static_cast<int>(i);
+        float t = (time - keyframes[i].time) / (keyframes[i+1].time - keyframes[i].time);
+        return interpolateKeyframes(keyframes[i], keyframes[i+1], t);
     }
     
     Keyframe AnimationTrack::interpolateKeyframes(const Keyframe& a, const Keyframe& b, float t) const {
@@ -4,7 +4,7 @@
 
 namespace Sparky {
     
-    AnimationComponent::AnimationComponent() : Component(), currentAnimation(nullptr) {
+    AnimationComponent::AnimationComponent() : Component(), currentAnimation(nullptr), trackCursor(0) {
         SPARKY_LOG_DEBUG("AnimationComponent created");
     }
     
@@ -28,7 +28,7 @@ namespace Sparky {
             if (currentAnimation->getTrackCount() > 0) {
                 AnimationTrack* track = currentAnimation->getTrack(0);
                 if (track) {
-                    Keyframe keyframe = track->getKeyframeAtTime(currentAnimation->getCurrentTime());
+                    Keyframe keyframe = track->getKeyframeAtTime(currentAnimation->getCurrentTime(), trackCursor);
                     // In a full implementation, we would set the position using glm
                     // For now, we'll just log that we're applying the animation
                     SPARKY_LOG_DEBUG("Applying animation frame to owner object");
@@ -66,6 +66,7 @@ namespace Sparky {
         Animation* animation = getAnimation(name);
         if (animation) {
             currentAnimation = animation;
+            trackCursor = 0;
             currentAnimation->play(loop);
             SPARKY_LOG_DEBUG("Playing animation: " + name);
         } else {
@@ -0,0 +1,407 @@
+#include "../include/AnimationCompression.h"
+#include "../include/AdvancedAnimationSystem.h"
+#include "../include/Logger.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Sparky {
+    namespace {
+        const float kQuantizedMax = 65535.0f;
+        const float kRotationMax = 32767.0f;                // 15 bits per smallest-three component
+        const float kRotationRange = 0.70710678f;           // Smallest three components lie in [-1/sqrt(2), 1/sqrt(2)]
+
+        glm::vec3 toVec3(const float* values) {
+            return glm::vec3(values[0], values[1], values[2]);
+        }
+
+        glm::quat toQuat(const float* values) {
+            return glm::quat(values[3], values[0], values[1], values[2]);
+        }
+
+        glm::quat nlerp(const glm::quat& a, const glm::quat& b, float t) {
+            float sign = glm::dot(a, b) < 0.0f ? -1.0f : 1.0f;
+            return glm::normalize(a * (1.0f - t) + b * (sign * t));
+        }
+
+        // Angle between two rotations, accurate for the small angles tolerances deal with
+        float rotationError(const glm::quat& a, const glm::quat& b) {
+            glm::quat difference = glm::conjugate(a) * b;
+            float sine = std::sqrt(difference.x * difference.x + difference.y * difference.y + difference.z * difference.z);
+            return 2.0f * std::atan2(sine, std::fabs(difference.w));
+        }
+
+        float vectorError(const glm::vec3& a, const glm::vec3& b) {
+            glm::vec3 difference = a - b;
+            return std::max(std::fabs(difference.x), std::max(std::fabs(difference.y), std::fabs(difference.z)));
+        }
+
+        // A track sampled the way AnimationSampler does it
+        void sampleTrack(const std::vector<Keyframe>& keyframes, float time,
+                         glm::vec3& translation, glm::quat& rotation, glm::vec3& scale) {
+            int count = static_cast<int>(keyframes.size());
+            int index = findKeyframe(keyframes.data(), count, time);
+            const Keyframe& a = keyframes[std::max(index, 0)];
+            if (index < 0 || index + 1 >= count) {
+                translation = toVec3(a.position);
+                rotation = toQuat(a.rotation);
+                scale = toVec3(a.scale);
+                return;
+            }
+            const Keyframe& b = keyframes[index + 1];
+            float t = (time - a.time) / (b.time - a.time);
+            translation = toVec3(a.position) + (toVec3(b.position) - toVec3(a.position)) * t;
+            rotation = glm::slerp(toQuat(a.rotation), toQuat(b.rotation), t);
+            scale = toVec3(a.scale) + (toVec3(b.scale) - toVec3(a.scale)) * t;
+        }
+
+        uint16_t quantize(float value, float minimum, float extent) {
+            if (extent <= 0.0f) return 0;
+            float unit = std::min(std::max((value - minimum) / extent, 0.0f), 1.0f);
+            return static_cast<uint16_t>(unit * kQuantizedMax + 0.5f);
+        }
+
+        glm::vec3 dequantize(const uint16_t* values, const glm::vec3& minimum, const glm::vec3& extent) {
+            const float scale = 1.0f / kQuantizedMax;
+            return minimum + glm::vec3(values[0] * extent.x, values[1] * extent.y, values[2] * extent.z) * scale;
+        }
+
+        // Smallest three: the largest component is dropped and rebuilt from unit length. Its index
+        // goes in the top bits of the first two words.
+        void packRotation(const glm::quat& rotation, uint16_t* out) {
+            float components[4] = {rotation.x, rotation.y, rotation.z, rotation.w};
+            int largest = 0;
+            for (int i = 1; i < 4; ++i) {
+                if (std::fabs(components[i]) > std::fabs(components[largest])) largest = i;
+            }
+            float sign = components[largest] < 0.0f ? -1.0f : 1.0f;
+            int word = 0;
+            for (int i = 0; i < 4; ++i) {
+                if (i == largest) continue;
+                float unit = (components[i] * sign / kRotationRange + 1.0f) * 0.5f;
+                unit = std::min(std::max(unit, 0.0f), 1.0f);
+                out[word++] = static_cast<uint16_t>(unit * kRotationMax + 0.5f);
+            }
+            out[0] |= static_cast<uint16_t>((largest >> 1) << 15);
+            out[1] |= static_cast<uint16_t>((largest & 1) << 15);
+        }
+
+        glm::quat unpackRotation(const uint16_t* values) {
+            const float scale = 2.0f * kRotationRange / kRotationMax;
+            int largest = ((values[0] >> 15) << 1) | (values[1] >> 15);
+            float small[3];
+            float sumSquares = 0.0f;
+            for (int i = 0; i < 3; ++i) {
+                small[i] = (values[i] & 0x7fff) * scale - kRotationRange;
+                sumSquares += small[i] * small[i];
+            }
+            float components[4];
+            int word = 0;
+            for (int i = 0; i < 4; ++i) {
+                components[i] = i == largest ? std::sqrt(std::max(1.0f - sumSquares, 0.0f)) : small[word++];
+            }
+            return glm::quat(components[3], components[0], components[1], components[2]);
+        }
+
+        // Greedily drops keys that interpolating their neighbours rebuilds within tolerance. The first and
+        // last keys are always kept.
+        template <typename T, typename Interpolate, typename Error>
+        void reduceKeys(const std::vector<float>& times, const std::vector<T>& values, float tolerance,
+                        Interpolate interpolate, Error error, std::vector<int>& kept) {
+            kept.clear();
+            int count = static_cast<int>(times.size());
+            int start = 0;
+            kept.push_back(0);
+            for (int end = 2; end < count; ++end) {
+                float span = times[end] - times[start];
+                bool fits = true;
+                for (int i = start + 1; i < end && fits; ++i) {
+                    float t = span > 0.0f ? (times[i] - times[start]) / span : 0.0f;
+                    fits = error(interpolate(values[start], values[end], t), values[i]) <= tolerance;
+                }
+                if (!fits) {
+                    start = end - 1;
+                    kept.push_back(start);
+                }
+            }
+            if (count > 1) kept.push_back(count - 1);
+        }
+    }
+
+    size_t CompressedAnimationClip::getMemoryUsage() const {
+        return sizeof(*this) + m_name.capacity() + m_tracks.size() * sizeof(Track) +
+               (m_segmentStart.size() + m_segmentLength.size()) * sizeof(float) +
+               m_channelOffsets.size() * sizeof(uint32_t) + m_data.size() * sizeof(uint16_t);
+    }
+
+    const uint16_t* CompressedAnimationClip::findKeys(int segment, int channel, float segmentTime, float& t) const {
+        const uint16_t* keys = &m_data[m_channelOffsets[segment * m_channelCount + channel]];
+        int count = keys[0];
+        const uint16_t* times = keys + 1;
+
+        // A second of animation holds a few dozen keys at most, so a linear scan beats a search
+        float position = segmentTime * kQuantizedMax;
+        int index = 0;
+        while (index + 2 < count && times[index + 1] <= position) {
+            ++index;
+        }
+        float span = static_cast<float>(times[index + 1] - times[index]);
+        t = span > 0.0f ? std::min(std::max((position - times[index]) / span, 0.0f), 1.0f) : 0.0f;
+        return times + count + index * 3;
+    }
+
+    void CompressedAnimationClip::sample(float time, AnimationPose& pose) const {
+        if (m_segmentStart.empty()) return;
+
+        // Same wrapping as AnimationClip::evaluate
+        float evalTime = m_duration > 0.0f ? std::fmod(time, m_duration) : time;
+        evalTime = std::max(evalTime, 0.0f);
+        int segment = std::min(static_cast<int>(evalTime / m_segmentDuration), getSegmentCount() - 1);
+        float length = m_segmentLength[segment];
+        float segmentTime = length > 0.0f ? std::min((evalTime - m_segmentStart[segment]) / length, 1.0f) : 0.0f;
+
+        const int boneCount = pose.getBoneCount();
+        for (const Track& track : m_tracks) {
+            if (track.boneId < 0 || track.boneId >= boneCount) continue;
+            float t;
+
+            if (track.channels[TRANSLATION] >= 0) {
+                const uint16_t* keys = findKeys(segment, track.channels[TRANSLATION], segmentTime, t);
+                glm::vec3 a = dequantize(keys, track.translationMin, track.translationExtent);
+                glm::vec3 b = dequantize(keys + 3, track.translationMin, track.translationExtent);
+                pose.translations[track.boneId] = a + (b - a) * t;
+            } else {
+                pose.translations[track.boneId] = track.translation;
+            }
+
+            if (track.channels[ROTATION] >= 0) {
+                const uint16_t* keys = findKeys(segment, track.channels[ROTATION], segmentTime, t);
+                pose.rotations[track.boneId] = nlerp(unpackRotation(keys), unpackRotation(keys + 3), t);
+            } else {
+                pose.rotations[track.boneId] = track.rotation;
+            }
+
+            if (track.channels[SCALE] >= 0) {
+                const uint16_t* keys = findKeys(segment, track.channels[SCALE], segmentTime, t);
+                glm::vec3 a = dequantize(keys, track.scaleMin, track.scaleExtent);
+                glm::vec3 b = dequantize(keys + 3, track.scaleMin, track.scaleExtent);
+                pose.scales[track.boneId] = a + (b - a) * t;
+            } else {
+                pose.scales[track.boneId] = track.scale;
+            }
+        }
+    }
+
+    AnimationCompressor::AnimationCompressor()
+        : AnimationCompressor(AnimationCompressionSettings()) {
+    }
+
+    AnimationCompressor::AnimationCompressor(const AnimationCompressionSettings& settings)
+        : m_settings(settings) {
+        if (m_settings.segmentDuration <= 0.0f) {
+            SPARKY_LOG_WARNING("AnimationCompressor: segment duration must be positive, using 1");
+            m_settings.segmentDuration = 1.0f;
+        }
+        m_settings.translationTolerance = std::max(m_settings.translationTolerance, 0.0f);
+        m_settings.rotationTolerance = std::max(m_settings.rotationTolerance, 0.0f);
+        m_settings.scaleTolerance = std::max(m_settings.scaleTolerance, 0.0f);
+    }
+
+    std::unique_ptr<AnimationCompressor> AnimationCompressor::create(const AnimationCompressionSettings& settings) {
+        return std::make_unique<AnimationCompressor>(settings);
+    }
+
+    std::unique_ptr<CompressedAnimationClip> AnimationCompressor::compress(const AnimationClip& clip) const {
+        typedef CompressedAnimationClip Clip;
+        std::unique_ptr<Clip> compressed(new Clip());
+        compressed->m_name = clip.getName();
+        compressed->m_duration = clip.getDuration();
+        compressed->m_segmentDuration = m_settings.segmentDuration;
+
+        // Constant channels and quantization ranges over the whole track
+        std::vector<const std::vector<Keyframe>*> trackKeyframes;
+        for (int boneId : clip.getBoneIds()) {
+            const std::vector<Keyframe>& keyframes = clip.getKeyframes(boneId);
+            if (keyframes.empty()) continue;
+
+            Clip::Track track;
+            track.boneId = boneId;
+            track.translation = toVec3(keyframes[0].position);
+            track.rotation = glm::normalize(toQuat(keyframes[0].rotation));
+            track.scale = toVec3(keyframes[0].scale);
+            track.translationMin = track.translation;
+            track.scaleMin = track.scale;
+            glm::vec3 translationMax = track.translation;
+            glm::vec3 scaleMax = track.scale;
+            bool moves[3] = {false, false, false};
+            for (const Keyframe& keyframe : keyframes) {
+                glm::vec3 translation = toVec3(keyframe.position);
+                glm::vec3 scale = toVec3(keyframe.scale);
+                moves[Clip::TRANSLATION] = moves[Clip::TRANSLATION] ||
+                                           vectorError(translation, track.translation) > m_settings.translationTolerance;
+                moves[Clip::ROTATION] = moves[Clip::ROTATION] ||
+                                        rotationError(toQuat(keyframe.rotation), track.rotation) > m_settings.rotationTolerance;
+                moves[Clip::SCALE] = moves[Clip::SCALE] || vectorError(scale, track.scale) > m_settings.scaleTolerance;
+                track.translationMin = glm::min(track.translationMin, translation);
+                translationMax = glm::max(translationMax, translation);
+                track.scaleMin = glm::min(track.scaleMin, scale);
+                scaleMax = glm::max(scaleMax, scale);
+            }
+            track.translationExtent = translationMax - track.translationMin;
+            track.scaleExtent = scaleMax - track.scaleMin;
+            for (int type = 0; type < 3; ++type) {
+                track.channels[type] = moves[type] ? compressed->m_channelCount++ : -1;
+            }
+            compressed->m_tracks.push_back(track);
+            trackKeyframes.push_back(&keyframes);
+        }
+
+        float duration = compressed->m_duration;
+        int segmentCount = std::max(1, static_cast<int>(std::ceil(duration / m_settings.segmentDuration)));
+        compressed->m_channelOffsets.resize(static_cast<size_t>(segmentCount) * compressed->m_channelCount);
+
+        std::vector<float> times;
+        std::vector<glm::vec3> vectors;
+        std::vector<glm::quat> rotations;
+        std::vector<int> kept;
+        auto lerp = [](const glm::vec3& a, const glm::vec3& b, float t) { return a + (b - a) * t; };
+        for (int segment = 0; segment < segmentCount; ++segment) {
+            float start = segment * m_settings.segmentDuration;
+            float end = segment + 1 == segmentCount ? duration : std::min(start + m_settings.segmentDuration, duration);
+            float length = std::max(end - start, 0.0f);
+            compressed->m_segmentStart.push_back(start);
+            compressed->m_segmentLength.push_back(length);
+
+            for (size_t trackIndex = 0; trackIndex < compressed->m_tracks.size(); ++trackIndex) {
+                const Clip::Track& track = compressed->m_tracks[trackIndex];
+                const std::vector<Keyframe>& keyframes = *trackKeyframes[trackIndex];
+
+                // Segment boundaries plus the track's own keys in between
+                times.clear();
+                times.push_back(start);
+                for (const Keyframe& keyframe : keyframes) {
+                    if (keyframe.time > start && keyframe.time < end) times.push_back(keyframe.time);
+                }
+                times.push_back(end);
+
+                for (int type = 0; type < 3; ++type) {
+                    int channel = track.channels[type];
+                    if (channel < 0) continue;
+
+                    vectors.clear();
+                    rotations.clear();
+                    for (float time : times) {
+                        glm::vec3 translation, scale;
+                        glm::quat rotation;
+                        sampleTrack(keyframes, time, translation, rotation, scale);
+                        if (type == Clip::ROTATION) {
+                            rotations.push_back(rotation);
+                        } else {
+                            vectors.push_back(type == Clip::TRANSLATION ? translation : scale);
+                        }
+                    }
+                    if (type == Clip::ROTATION) {
+                        reduceKeys(times, rotations, m_settings.rotationTolerance, nlerp, rotationError, kept);
+                    } else {
+                        float tolerance = type == Clip::TRANSLATION ? m_settings.translationTolerance : m_settings.scaleTolerance;
+                        reduceKeys(times, vectors, tolerance, lerp, vectorError, kept);
+                    }
+
+                    // [key count, key times, key values]
+                    std::vector<uint16_t>& data = compressed->m_data;
+                    compressed->m_channelOffsets[segment * compressed->m_channelCount + channel] = static_cast<uint32_t>(data.size());
+                    data.push_back(static_cast<uint16_t>(kept.size()));
+                    for (int index : kept) {
+                        data.push_back(quantize(times[index], start, length));
+                    }
+                    for (int index : kept) {
+                        uint16_t packed[3];
+                        if (type == Clip::ROTATION) {
+                            packRotation(rotations[index], packed);
+                        } else {
+                            const glm::vec3& minimum = type == Clip::TRANSLATION ? track.translationMin : track.scaleMin;
+                            const glm::vec3& extent = type == Clip::TRANSLATION ? track.translationExtent : track.scaleExtent;
+                            for (int axis = 0; axis < 3; ++axis) {
+                                packed[axis] = quantize(vectors[index][axis], minimum[axis], extent[axis]);
+                            }
+                        }
+                        data.insert(data.end(), packed, packed + 3);
+                    }
+                    compressed->m_storedKeys += static_cast<int>(kept.size());
+                }
+            }
+        }
+        return compressed;
+    }
+
+    AnimationCompressionReport AnimationCompressor::measureError(const AnimationClip& original, const CompressedAnimationClip& compressed,
+                                                                 const std::vector<int>& parents, float sampleRate) const {
+        AnimationCompressionReport report = AnimationCompressionReport();
+        const int boneCount = static_cast<int>(parents.size());
+        report.worstBone = -1;
+        report.storedKeys = compressed.getStoredKeyCount();
+        report.compressedBytes = compressed.getMemoryUsage();
+        for (int boneId : original.getBoneIds()) {
+            size_t keys = original.getKeyframes(boneId).size();
+            report.originalKeys += static_cast<int>(keys);
+            report.originalBytes += keys * sizeof(Keyframe);
+        }
+        report.bones.resize(boneCount);
+        for (int bone = 0; bone < boneCount; ++bone) {
+            report.bones[bone] = {bone, parents[bone], 0.0f, 0.0f, 0.0f, 0.0f};
+        }
+
+        // Parents before children; a parent outside the skeleton or a cycle ends the chain
+        std::vector<int> depth(boneCount, 0);
+        for (int bone = 0; bone < boneCount; ++bone) {
+            for (int parent = parents[bone]; parent >= 0 && parent < boneCount && depth[bone] < boneCount;
+                 parent = parents[parent]) {
+                ++depth[bone];
+            }
+        }
+        std::vector<int> order(boneCount);
+        for (int bone = 0; bone < boneCount; ++bone) order[bone] = bone;
+        std::stable_sort(order.begin(), order.end(), [&depth](int a, int b) { return depth[a] < depth[b]; });
+
+        AnimationSampler sampler;
+        sampler.bind(&original);
+        AnimationPose expected, actual;
+        expected.reset(boneCount);
+        actual.reset(boneCount);
+        std::vector<glm::mat4> expectedModel(boneCount), actualModel(boneCount);
+        const float shell = m_settings.shellDistance;
+        const glm::vec4 shellPoints[4] = {glm::vec4(0.0f, 0.0f, 0.0f, 1.0f), glm::vec4(shell, 0.0f, 0.0f, 1.0f),
+                                          glm::vec4(0.0f, shell, 0.0f, 1.0f), glm::vec4(0.0f, 0.0f, shell, 1.0f)};
+
+        int sampleCount = static_cast<int>(original.getDuration() * sampleRate) + 1;
+        for (int i = 0; i < sampleCount; ++i) {
+            float time = std::min(i / sampleRate, std::nextafter(original.getDuration(), 0.0f));
+            sampler.sample(time, expected);
+            compressed.sample(time, actual);
+
+            for (int bone : order) {
+                AnimationBoneError& error = report.bones[bone];
+                error.translationError = std::max(error.translationError, vectorError(expected.translations[bone], actual.translations[bone]));
+                error.rotationError = std::max(error.rotationError, rotationError(expected.rotations[bone], actual.rotations[bone]));
+                error.scaleError = std::max(error.scaleError, vectorError(expected.scales[bone], actual.scales[bone]));
+
+                int parent = parents[bone];
+                bool hasParent = parent >= 0 && parent < boneCount && depth[parent] < depth[bone];
+                expectedModel[bone] = hasParent ? expectedModel[parent] * expected.getMatrix(bone) : expected.getMatrix(bone);
+                actualModel[bone] = hasParent ? actualModel[parent] * actual.getMatrix(bone) : actual.getMatrix(bone);
+                for (const glm::vec4& point : shellPoints) {
+                    glm::vec4 difference = expectedModel[bone] * point - actualModel[bone] * point;
+                    float distance = std::sqrt(difference.x * difference.x + difference.y * difference.y + difference.z * difference.z);
+                    error.modelError = std::max(error.modelError, distance);
+                }
+            }
+        }
+
+        for (const AnimationBoneError& error : report.bones) {
+            if (report.worstBone < 0 || error.modelError > report.maxModelError) {
+                report.worstBone = error.boneId;
+                report.maxModelError = error.modelError;
+            }
+        }
+        return report;
+    }
+}
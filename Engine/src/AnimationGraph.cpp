@@ -0,0 +1,636 @@
+#include "../include/AnimationGraph.h"
+#include "../include/JobSystem.h"
+#include "../include/Logger.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <functional>
+
+namespace Sparky {
+    namespace {
+        const uint32_t kNone = UINT32_MAX;
+        const int kMaxStack = 16;           // Condition stack depth
+        const int kMaxBlendDepth = 16;
+        const size_t kBatchSize = 64;       // Controllers per update job
+        const float kDefaultFade = 0.2f;    // Cross-fade when a blend tree's heaviest clip changes
+
+        using NodeType = AdvancedAnimationController::BlendTreeNode::NodeType;
+
+        // Recursive descent over a condition, emitting stack code as it goes:
+        //   or := and ('||' and)*    and := unary ('&&' unary)*    unary := '!' unary | compare
+        //   compare := operand (('<' | '<=' | '>' | '>=' | '==' | '!=') operand)?
+        //   operand := number | true | false | stateTime | parameter | '(' or ')'
+        class ConditionParser {
+        public:
+            ConditionParser(const std::string& text, const std::unordered_map<std::string, int>& parameters,
+                            const std::vector<AnimationParameterType>& types, std::vector<AnimationConditionInstruction>& code,
+                            std::vector<uint32_t>& triggers)
+                : m_text(text), m_parameters(parameters), m_types(types), m_code(code), m_triggers(triggers), m_pos(0) {}
+
+            // Returns an empty string on success
+            std::string parse() {
+                skipSpace();
+                if (m_pos == m_text.size()) return m_error;
+                parseOr();
+                if (m_error.empty() && m_pos != m_text.size()) fail("unexpected '" + m_text.substr(m_pos, 1) + "'");
+                return m_error;
+            }
+
+        private:
+            const std::string& m_text;
+            const std::unordered_map<std::string, int>& m_parameters;
+            const std::vector<AnimationParameterType>& m_types;
+            std::vector<AnimationConditionInstruction>& m_code;
+            std::vector<uint32_t>& m_triggers;
+            size_t m_pos;
+            std::string m_error;
+
+            void fail(const std::string& error) {
+                if (m_error.empty()) m_error = error;
+                m_pos = m_text.size();
+            }
+
+            void skipSpace() {
+                while (m_pos < m_text.size() && std::isspace(static_cast<unsigned char>(m_text[m_pos]))) ++m_pos;
+            }
+
+            bool accept(const char* token) {
+                size_t length = std::char_traits<char>::length(token);
+                if (m_text.compare(m_pos, length, token) != 0) return false;
+                m_pos += length;
+                skipSpace();
+                return true;
+            }
+
+            void emit(AnimationConditionOp op, uint32_t operand = 0, float value = 0.0f) {
+                AnimationConditionInstruction instruction = {op, operand, value};
+                m_code.push_back(instruction);
+            }
+
+            void parseOr() {
+                parseAnd();
+                while (m_error.empty() && accept("||")) {
+                    parseAnd();
+                    emit(AnimationConditionOp::OR);
+                }
+            }
+
+            void parseAnd() {
+                parseUnary();
+                while (m_error.empty() && accept("&&")) {
+                    parseUnary();
+                    emit(AnimationConditionOp::AND);
+                }
+            }
+
+            void parseUnary() {
+                // "!=" never starts an operand, so a leading '!' is always a not
+                if (accept("!")) {
+                    parseUnary();
+                    emit(AnimationConditionOp::NOT);
+                    return;
+                }
+                parseCompare();
+            }
+
+            void parseCompare() {
+                parseOperand();
+                // Two-character operators first, so "<=" is not read as "<"
+                static const struct { const char* token; AnimationConditionOp op; } operators[] = {
+                    {"<=", AnimationConditionOp::LESS_EQUAL}, {">=", AnimationConditionOp::GREATER_EQUAL},
+                    {"==", AnimationConditionOp::EQUAL}, {"!=", AnimationConditionOp::NOT_EQUAL},
+                    {"<", AnimationConditionOp::LESS}, {">", AnimationConditionOp::GREATER}};
+                for (const auto& entry : operators) {
+                    if (m_error.empty() && accept(entry.token)) {
+                        parseOperand();
+                        emit(entry.op);
+                        return;
+                    }
+                }
+            }
+
+            void parseOperand() {
+                if (m_pos >= m_text.size()) {
+                    fail("condition ends early");
+                    return;
+                }
+                if (accept("(")) {
+                    parseOr();
+                    if (m_error.empty() && !accept(")")) fail("missing ')'");
+                    return;
+                }
+
+                char first = m_text[m_pos];
+                if (std::isdigit(static_cast<unsigned char>(first)) || first == '.' || first == '-') {
+                    const char* start = m_text.c_str() + m_pos;
+                    char* end = nullptr;
+                    float value = std::strtof(start, &end);
+                    if (end == start) {
+                        fail("bad number");
+                        return;
+                    }
+                    m_pos += end - start;
+                    skipSpace();
+                    emit(AnimationConditionOp::LOAD_CONSTANT, 0, value);
+                    return;
+                }
+
+                size_t begin = m_pos;
+                while (m_pos < m_text.size() && (std::isalnum(static_cast<unsigned char>(m_text[m_pos])) || m_text[m_pos] == '_')) {
+                    ++m_pos;
+                }
+                std::string name = m_text.substr(begin, m_pos - begin);
+                skipSpace();
+                if (name.empty()) {
+                    fail("unexpected '" + m_text.substr(begin, 1) + "'");
+                } else if (name == "true" || name == "false") {
+                    emit(AnimationConditionOp::LOAD_CONSTANT, 0, name == "true" ? 1.0f : 0.0f);
+                } else if (name == "stateTime") {
+                    emit(AnimationConditionOp::LOAD_STATE_TIME);
+                } else {
+                    auto it = m_parameters.find(name);
+                    if (it == m_parameters.end()) {
+                        fail("unknown parameter '" + name + "'");
+                        return;
+                    }
+                    uint32_t parameter = static_cast<uint32_t>(it->second);
+                    emit(AnimationConditionOp::LOAD_PARAMETER, parameter);
+                    if (m_types[parameter] == AnimationParameterType::TRIGGER &&
+                        std::find(m_triggers.begin(), m_triggers.end(), parameter) == m_triggers.end()) {
+                        m_triggers.push_back(parameter);
+                    }
+                }
+            }
+        };
+
+        int stackDepth(const AnimationConditionInstruction* code, size_t count) {
+            int depth = 0, deepest = 0;
+            for (size_t i = 0; i < count; ++i) {
+                AnimationConditionOp op = code[i].op;
+                if (op <= AnimationConditionOp::LOAD_STATE_TIME) {
+                    deepest = std::max(deepest, ++depth);
+                } else if (op != AnimationConditionOp::NOT) {
+                    --depth;
+                }
+            }
+            return deepest;
+        }
+    }
+
+    // CompiledAnimationGraph implementation
+    int CompiledAnimationGraph::findParameter(const std::string& name) const {
+        auto it = m_parameterIndex.find(name);
+        return it != m_parameterIndex.end() ? it->second : -1;
+    }
+
+    int CompiledAnimationGraph::findState(const std::string& name) const {
+        auto it = m_stateIndex.find(name);
+        return it != m_stateIndex.end() ? it->second : -1;
+    }
+
+    // AnimationGraphCompiler implementation
+    AnimationGraphCompiler::AnimationGraphCompiler() {
+    }
+
+    void AnimationGraphCompiler::addParameter(const std::string& name, AnimationParameterType type, float defaultValue) {
+        for (auto& parameter : m_parameters) {
+            if (parameter.name == name) {
+                parameter.type = type;
+                parameter.defaultValue = defaultValue;
+                return;
+            }
+        }
+        m_parameters.push_back({name, type, defaultValue});
+    }
+
+    void AnimationGraphCompiler::addState(const std::string& name, const std::string& clipName, bool loop, float speed) {
+        StateDesc state;
+        state.name = name;
+        state.clipName = clipName;
+        state.hasBlendTree = false;
+        state.loop = loop;
+        state.speed = speed;
+        m_states.push_back(state);
+    }
+
+    void AnimationGraphCompiler::addBlendTreeState(const std::string& name, const AdvancedAnimationController::BlendTreeNode& root, float speed) {
+        StateDesc state;
+        state.name = name;
+        state.hasBlendTree = true;
+        state.blendTree = root;
+        state.loop = true;
+        state.speed = speed;
+        m_states.push_back(state);
+    }
+
+    void AnimationGraphCompiler::addTransition(const std::string& from, const std::string& to, float duration, const std::string& condition) {
+        m_transitions.push_back({from, to, duration, condition});
+    }
+
+    void AnimationGraphCompiler::addAnyStateTransition(const std::string& to, float duration, const std::string& condition) {
+        m_transitions.push_back({std::string(), to, duration, condition});
+    }
+
+    std::shared_ptr<const CompiledAnimationGraph> AnimationGraphCompiler::compile() const {
+        auto failed = [](const std::string& error) {
+            SPARKY_LOG_ERROR("AnimationGraphCompiler: " + error);
+            return std::shared_ptr<const CompiledAnimationGraph>();
+        };
+        if (m_states.empty()) return failed("graph has no states");
+
+        std::shared_ptr<CompiledAnimationGraph> graph = std::make_shared<CompiledAnimationGraph>();
+        for (const auto& parameter : m_parameters) {
+            graph->m_parameterIndex[parameter.name] = static_cast<int>(graph->m_parameterTypes.size());
+            graph->m_parameterTypes.push_back(parameter.type);
+            graph->m_defaultValues.push_back(parameter.defaultValue);
+        }
+
+        std::unordered_map<std::string, int> clipIndex;
+        auto internClip = [&](const std::string& name) {
+            auto it = clipIndex.find(name);
+            if (it != clipIndex.end()) return static_cast<uint32_t>(it->second);
+            clipIndex[name] = static_cast<int>(graph->m_clipNames.size());
+            graph->m_clipNames.push_back(name);
+            return static_cast<uint32_t>(graph->m_clipNames.size() - 1);
+        };
+        auto parameterOf = [&](const std::string& name, uint32_t& index) {
+            int parameter = graph->findParameter(name);
+            if (parameter < 0) return false;
+            index = static_cast<uint32_t>(parameter);
+            return true;
+        };
+
+        // Blend trees flatten breadth-first within each node so that children stay contiguous
+        std::string error;
+        std::function<void(const AdvancedAnimationController::BlendTreeNode&, uint32_t, int)> flatten =
+            [&](const AdvancedAnimationController::BlendTreeNode& source, uint32_t index, int depth) {
+                if (!error.empty()) return;
+                if (depth > kMaxBlendDepth) {
+                    error = "blend tree is deeper than " + std::to_string(kMaxBlendDepth) + " levels";
+                    return;
+                }
+                CompiledBlendNode node = {source.type, kNone, 0, 0, kNone, kNone, source.position};
+                if (source.type == NodeType::CLIP) {
+                    node.clip = internClip(source.clipName);
+                } else {
+                    if (source.children.empty()) {
+                        error = "blend node without children";
+                        return;
+                    }
+                    if (!parameterOf(source.parameterX, node.parameterX) ||
+                        (source.type == NodeType::BLEND_2D && !parameterOf(source.parameterY, node.parameterY))) {
+                        error = "blend tree uses an unknown parameter";
+                        return;
+                    }
+                    std::vector<const AdvancedAnimationController::BlendTreeNode*> children;
+                    for (const auto& child : source.children) children.push_back(&child);
+                    if (source.type == NodeType::BLEND_1D) {
+                        std::stable_sort(children.begin(), children.end(), [](const auto* a, const auto* b) {
+                            return a->position.x < b->position.x;
+                        });
+                    }
+                    node.firstChild = static_cast<uint32_t>(graph->m_blendNodes.size());
+                    node.childCount = static_cast<uint32_t>(children.size());
+                    graph->m_blendNodes.resize(graph->m_blendNodes.size() + children.size());
+                    for (size_t i = 0; i < children.size(); ++i) {
+                        flatten(*children[i], node.firstChild + static_cast<uint32_t>(i), depth + 1);
+                    }
+                }
+                graph->m_blendNodes[index] = node;
+            };
+
+        for (const auto& state : m_states) {
+            if (graph->m_stateIndex.count(state.name)) return failed("state '" + state.name + "' added twice");
+            graph->m_stateIndex[state.name] = static_cast<int>(graph->m_states.size());
+            graph->m_stateNames.push_back(state.name);
+
+            CompiledAnimationState compiled = {kNone, kNone, state.speed, state.loop, 0, 0};
+            if (state.hasBlendTree) {
+                compiled.blendTree = static_cast<uint32_t>(graph->m_blendNodes.size());
+                graph->m_blendNodes.emplace_back();
+                flatten(state.blendTree, compiled.blendTree, 1);
+                if (!error.empty()) return failed("state '" + state.name + "': " + error);
+            } else {
+                compiled.clip = internClip(state.clipName);
+            }
+            graph->m_states.push_back(compiled);
+        }
+
+        int defaultState = m_defaultState.empty() ? 0 : graph->findState(m_defaultState);
+        if (defaultState < 0) return failed("default state '" + m_defaultState + "' does not exist");
+        graph->m_defaultState = static_cast<uint32_t>(defaultState);
+
+        // Transitions grouped by source, any-state ones first, each group in the order added
+        auto compileTransition = [&](const TransitionDesc& desc) {
+            int target = graph->findState(desc.to);
+            if (target < 0) {
+                error = "transition to unknown state '" + desc.to + "'";
+                return;
+            }
+            CompiledAnimationTransition transition = {};
+            transition.target = static_cast<uint32_t>(target);
+            transition.duration = std::max(desc.duration, 0.0f);
+            transition.codeBegin = static_cast<uint32_t>(graph->m_code.size());
+            transition.triggerBegin = static_cast<uint32_t>(graph->m_triggers.size());
+            std::vector<uint32_t> triggers;
+            ConditionParser parser(desc.condition, graph->m_parameterIndex, graph->m_parameterTypes, graph->m_code, triggers);
+            std::string parseError = parser.parse();
+            if (!parseError.empty()) {
+                error = "condition \"" + desc.condition + "\": " + parseError;
+                return;
+            }
+            transition.codeEnd = static_cast<uint32_t>(graph->m_code.size());
+            if (stackDepth(graph->m_code.data() + transition.codeBegin, transition.codeEnd - transition.codeBegin) > kMaxStack) {
+                error = "condition \"" + desc.condition + "\" is too deeply nested";
+                return;
+            }
+            graph->m_triggers.insert(graph->m_triggers.end(), triggers.begin(), triggers.end());
+            transition.triggerEnd = static_cast<uint32_t>(graph->m_triggers.size());
+            graph->m_transitions.push_back(transition);
+        };
+
+        graph->m_anyStateBegin = 0;
+        for (const auto& desc : m_transitions) {
+            if (desc.from.empty()) compileTransition(desc);
+            if (!error.empty()) return failed(error);
+        }
+        graph->m_anyStateEnd = static_cast<uint32_t>(graph->m_transitions.size());
+        for (size_t state = 0; state < m_states.size(); ++state) {
+            graph->m_states[state].transitionBegin = static_cast<uint32_t>(graph->m_transitions.size());
+            for (const auto& desc : m_transitions) {
+                if (desc.from == m_states[state].name) compileTransition(desc);
+                if (!error.empty()) return failed(error);
+            }
+            graph->m_states[state].transitionEnd = static_cast<uint32_t>(graph->m_transitions.size());
+        }
+        for (const auto& desc : m_transitions) {
+            if (!desc.from.empty() && graph->findState(desc.from) < 0) {
+                return failed("transition from unknown state '" + desc.from + "'");
+            }
+        }
+        return graph;
+    }
+
+    // AnimationGraphBatch implementation
+    AnimationGraphBatch::AnimationGraphBatch(std::shared_ptr<const CompiledAnimationGraph> graph)
+        : m_graph(std::move(graph))
+        , m_jobSystem(nullptr)
+        , m_parameterStride(0)
+        , m_weightStride(0)
+        , m_controllerCount(0)
+        , m_transitionsStarted(0) {
+        if (m_graph) {
+            m_parameterStride = static_cast<uint32_t>(m_graph->getParameterCount());
+            m_weightStride = static_cast<uint32_t>(m_graph->getClipCount());
+            m_scratchWeights.resize(m_weightStride);
+        } else {
+            SPARKY_LOG_WARNING("AnimationGraphBatch: created without a graph, controllers will never run");
+        }
+    }
+
+    int AnimationGraphBatch::addController(SkeletalAnimation* animation) {
+        int slot;
+        if (!m_freeSlots.empty()) {
+            slot = m_freeSlots.back();
+            m_freeSlots.pop_back();
+        } else {
+            slot = static_cast<int>(m_active.size());
+            m_parameters.resize(m_parameters.size() + m_parameterStride);
+            m_weights.resize(m_weights.size() + m_weightStride);
+            m_current.push_back(0);
+            m_next.push_back(-1);
+            m_stateTime.push_back(0.0f);
+            m_nextStateTime.push_back(0.0f);
+            m_transitionTime.push_back(0.0f);
+            m_transitionDuration.push_back(0.0f);
+            m_started.push_back(0);
+            m_active.push_back(0);
+            m_animations.push_back(nullptr);
+            m_playingClip.push_back(-1);
+        }
+
+        m_active[slot] = 1;
+        m_animations[slot] = animation;
+        m_playingClip[slot] = -1;
+        resetController(slot);
+        ++m_controllerCount;
+        return slot;
+    }
+
+    void AnimationGraphBatch::removeController(int controller) {
+        if (controller < 0 || controller >= static_cast<int>(m_active.size()) || !m_active[controller]) return;
+        m_active[controller] = 0;
+        m_animations[controller] = nullptr;
+        m_freeSlots.push_back(controller);
+        --m_controllerCount;
+    }
+
+    void AnimationGraphBatch::resetController(int controller) {
+        if (!m_graph || controller < 0 || controller >= static_cast<int>(m_active.size())) return;
+        std::copy(m_graph->m_defaultValues.begin(), m_graph->m_defaultValues.end(), m_parameters.begin() + controller * m_parameterStride);
+        m_current[controller] = m_graph->getDefaultState();
+        m_next[controller] = -1;
+        m_stateTime[controller] = 0.0f;
+        m_nextStateTime[controller] = 0.0f;
+        m_transitionTime[controller] = 0.0f;
+        m_transitionDuration[controller] = 0.0f;
+        m_started[controller] = 0;
+        float* weights = &m_weights[controller * m_weightStride];
+        std::fill(weights, weights + m_weightStride, 0.0f);
+        addStateWeights(static_cast<uint32_t>(m_current[controller]), 1.0f, getParameters(controller), weights);
+    }
+
+    float AnimationGraphBatch::getTransitionProgress(int controller) const {
+        if (m_next[controller] < 0) return 0.0f;
+        return m_transitionDuration[controller] > 0.0f ? m_transitionTime[controller] / m_transitionDuration[controller] : 1.0f;
+    }
+
+    void AnimationGraphBatch::update(float deltaTime) {
+        if (!m_graph) return;
+        size_t slotCount = m_active.size();
+        auto updateRange = [this, deltaTime, slotCount](size_t begin, size_t end) {
+            for (size_t batch = begin; batch < end; ++batch) {
+                size_t last = std::min(slotCount, (batch + 1) * kBatchSize);
+                for (size_t controller = batch * kBatchSize; controller < last; ++controller) {
+                    if (m_active[controller]) updateController(static_cast<int>(controller), deltaTime);
+                }
+            }
+        };
+        size_t batchCount = (slotCount + kBatchSize - 1) / kBatchSize;
+        if (m_jobSystem && m_jobSystem->getWorkerCount() > 0 && batchCount > 1) {
+            m_jobSystem->parallelFor(batchCount, 1, updateRange);
+        } else {
+            updateRange(0, batchCount);
+        }
+
+        // Counting and driving animations stay on the calling thread
+        m_transitionsStarted = 0;
+        for (size_t controller = 0; controller < slotCount; ++controller) {
+            if (!m_active[controller]) continue;
+            m_transitionsStarted += m_started[controller];
+            if (m_animations[controller]) driveAnimation(static_cast<int>(controller));
+        }
+    }
+
+    void AnimationGraphBatch::updateController(int controller, float deltaTime) {
+        const CompiledAnimationGraph& graph = *m_graph;
+        float* parameters = getParameters(controller);
+        m_started[controller] = 0;
+
+        const CompiledAnimationState& current = graph.m_states[m_current[controller]];
+        m_stateTime[controller] += deltaTime * current.speed;
+        if (m_next[controller] >= 0) {
+            // Blending: finish the transition once its time is up
+            m_nextStateTime[controller] += deltaTime * graph.m_states[m_next[controller]].speed;
+            m_transitionTime[controller] += deltaTime;
+            if (m_transitionTime[controller] >= m_transitionDuration[controller]) {
+                m_current[controller] = m_next[controller];
+                m_stateTime[controller] = m_nextStateTime[controller];
+                m_next[controller] = -1;
+            }
+        } else {
+            // Any-state transitions, then the current state's, first that passes wins
+            float stateTime = m_stateTime[controller];
+            uint32_t fired = kNone;
+            for (uint32_t t = graph.m_anyStateBegin; t < graph.m_anyStateEnd && fired == kNone; ++t) {
+                const CompiledAnimationTransition& transition = graph.m_transitions[t];
+                if (static_cast<int>(transition.target) != m_current[controller] && passes(transition, parameters, stateTime)) fired = t;
+            }
+            for (uint32_t t = current.transitionBegin; t < current.transitionEnd && fired == kNone; ++t) {
+                if (passes(graph.m_transitions[t], parameters, stateTime)) fired = t;
+            }
+            if (fired != kNone) startTransition(controller, fired, parameters);
+        }
+
+        // Weights: the current state fades out as the next fades in
+        float* weights = &m_weights[controller * m_weightStride];
+        std::fill(weights, weights + m_weightStride, 0.0f);
+        float progress = getTransitionProgress(controller);
+        addStateWeights(static_cast<uint32_t>(m_current[controller]), 1.0f - progress, parameters, weights);
+        if (m_next[controller] >= 0) {
+            addStateWeights(static_cast<uint32_t>(m_next[controller]), progress, parameters, weights);
+        }
+    }
+
+    bool AnimationGraphBatch::passes(const CompiledAnimationTransition& transition, const float* parameters, float stateTime) const {
+        const AnimationConditionInstruction* code = m_graph->m_code.data();
+        float stack[kMaxStack];
+        int top = 0;
+        for (uint32_t i = transition.codeBegin; i < transition.codeEnd; ++i) {
+            const AnimationConditionInstruction& instruction = code[i];
+            switch (instruction.op) {
+                case AnimationConditionOp::LOAD_PARAMETER: stack[top++] = parameters[instruction.operand]; break;
+                case AnimationConditionOp::LOAD_CONSTANT: stack[top++] = instruction.value; break;
+                case AnimationConditionOp::LOAD_STATE_TIME: stack[top++] = stateTime; break;
+                case AnimationConditionOp::NOT: stack[top - 1] = stack[top - 1] != 0.0f ? 0.0f : 1.0f; break;
+                default: {
+                    float b = stack[--top];
+                    float a = stack[top - 1];
+                    bool result = false;
+                    switch (instruction.op) {
+                        case AnimationConditionOp::LESS: result = a < b; break;
+                        case AnimationConditionOp::LESS_EQUAL: result = a <= b; break;
+                        case AnimationConditionOp::GREATER: result = a > b; break;
+                        case AnimationConditionOp::GREATER_EQUAL: result = a >= b; break;
+                        case AnimationConditionOp::EQUAL: result = a == b; break;
+                        case AnimationConditionOp::NOT_EQUAL: result = a != b; break;
+                        case AnimationConditionOp::AND: result = a != 0.0f && b != 0.0f; break;
+                        case AnimationConditionOp::OR: result = a != 0.0f || b != 0.0f; break;
+                        default: break;
+                    }
+                    stack[top - 1] = result ? 1.0f : 0.0f;
+                    break;
+                }
+            }
+        }
+        return top == 0 || stack[top - 1] != 0.0f;
+    }
+
+    void AnimationGraphBatch::startTransition(int controller, uint32_t transition, float* parameters) {
+        const CompiledAnimationTransition& fired = m_graph->m_transitions[transition];
+        for (uint32_t t = fired.triggerBegin; t < fired.triggerEnd; ++t) {
+            parameters[m_graph->m_triggers[t]] = 0.0f;
+        }
+        m_started[controller] = 1;
+        if (fired.duration <= 0.0f) {
+            m_current[controller] = static_cast<int>(fired.target);
+            m_stateTime[controller] = 0.0f;
+            return;
+        }
+        m_next[controller] = static_cast<int>(fired.target);
+        m_nextStateTime[controller] = 0.0f;
+        m_transitionTime[controller] = 0.0f;
+        m_transitionDuration[controller] = fired.duration;
+    }
+
+    void AnimationGraphBatch::addStateWeights(uint32_t state, float weight, const float* parameters, float* weights) const {
+        if (weight <= 0.0f) return;
+        const CompiledAnimationState& compiled = m_graph->m_states[state];
+        if (compiled.blendTree != kNone) {
+            addBlendWeights(compiled.blendTree, weight, parameters, weights);
+        } else {
+            weights[compiled.clip] += weight;
+        }
+    }
+
+    void AnimationGraphBatch::addBlendWeights(uint32_t node, float weight, const float* parameters, float* weights) const {
+        const CompiledBlendNode* nodes = m_graph->m_blendNodes.data();
+        const CompiledBlendNode& current = nodes[node];
+        if (current.type == NodeType::CLIP) {
+            weights[current.clip] += weight;
+            return;
+        }
+
+        const uint32_t first = current.firstChild;
+        const uint32_t count = current.childCount;
+        if (current.type == NodeType::BLEND_1D) {
+            // Between the two neighbouring thresholds, clamped at the ends
+            float x = parameters[current.parameterX];
+            if (count == 1 || x <= nodes[first].position.x) {
+                addBlendWeights(first, weight, parameters, weights);
+                return;
+            }
+            uint32_t upper = 1;
+            while (upper < count - 1 && x > nodes[first + upper].position.x) ++upper;
+            float low = nodes[first + upper - 1].position.x;
+            float high = nodes[first + upper].position.x;
+            float t = high > low ? std::min((x - low) / (high - low), 1.0f) : 1.0f;
+            addBlendWeights(first + upper - 1, weight * (1.0f - t), parameters, weights);
+            addBlendWeights(first + upper, weight * t, parameters, weights);
+            return;
+        }
+
+        // 2D: inverse squared distance, exact on a sample point
+        glm::vec2 point(parameters[current.parameterX], parameters[current.parameterY]);
+        float total = 0.0f;
+        for (uint32_t child = first; child < first + count; ++child) {
+            glm::vec2 offset = nodes[child].position - point;
+            float distanceSquared = glm::dot(offset, offset);
+            if (distanceSquared < 1e-8f) {
+                addBlendWeights(child, weight, parameters, weights);
+                return;
+            }
+            total += 1.0f / distanceSquared;
+        }
+        for (uint32_t child = first; child < first + count; ++child) {
+            glm::vec2 offset = nodes[child].position - point;
+            addBlendWeights(child, weight / (glm::dot(offset, offset) * total), parameters, weights);
+        }
+    }
+
+    void AnimationGraphBatch::driveAnimation(int controller) {
+        // The state being entered, or the current one, decides what plays
+        int state = m_next[controller] >= 0 ? m_next[controller] : m_current[controller];
+        std::fill(m_scratchWeights.begin(), m_scratchWeights.end(), 0.0f);
+        addStateWeights(static_cast<uint32_t>(state), 1.0f, getParameters(controller), m_scratchWeights.data());
+        int clip = static_cast<int>(std::max_element(m_scratchWeights.begin(), m_scratchWeights.end()) - m_scratchWeights.begin());
+        if (clip == m_playingClip[controller] || m_scratchWeights.empty()) return;
+
+        float fade = kDefaultFade;
+        if (m_started[controller]) {
+            fade = m_next[controller] >= 0 ? m_transitionDuration[controller] - m_transitionTime[controller] : 0.0f;
+        }
+        m_animations[controller]->playAnimation(m_graph->getClipName(clip), m_graph->getState(state).loop, fade);
+        m_playingClip[controller] = clip;
+    }
+}
@@ -0,0 +1,105 @@
+#include "../include/AnimationSampler.h"
+#include "../include/AdvancedAnimationSystem.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Sparky {
+    void AnimationPose::reset(int boneCount) {
+        int count = std::max(boneCount, 0);
+        translations.assign(count, glm::vec3(0.0f));
+        rotations.assign(count, glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+        scales.assign(count, glm::vec3(1.0f));
+    }
+
+    glm::mat4 AnimationPose::getMatrix(int bone) const {
+        // Scaling the rotation's columns and setting the translation column is the same product without the multiplies
+        glm::mat4 matrix = glm::mat4_cast(rotations[bone]);
+        matrix[0] *= scales[bone].x;
+        matrix[1] *= scales[bone].y;
+        matrix[2] *= scales[bone].z;
+        matrix[3] = glm::vec4(translations[bone], 1.0f);
+        return matrix;
+    }
+
+    AnimationSampler::AnimationSampler()
+        : m_clip(nullptr)
+        , m_revision(0) {
+    }
+
+    void AnimationSampler::bind(const AnimationClip* clip) {
+        m_clip = clip;
+        rebuildTracks();
+    }
+
+    void AnimationSampler::resetCursors() {
+        std::fill(m_cursor.begin(), m_cursor.end(), -1);
+    }
+
+    void AnimationSampler::rebuildTracks() {
+        m_trackBone.clear();
+        m_trackKeyframes.clear();
+        if (m_clip) {
+            m_revision = m_clip->getRevision();
+            for (int boneId : m_clip->getBoneIds()) {
+                const std::vector<Keyframe>& keyframes = m_clip->getKeyframes(boneId);
+                if (keyframes.empty()) continue;
+                m_trackBone.push_back(boneId);
+                m_trackKeyframes.push_back(&keyframes);
+            }
+        }
+        m_cursor.assign(m_trackBone.size(), -1);
+    }
+
+    void AnimationSampler::sample(float time, AnimationPose& pose) {
+        sampleTracks(time, pose, nullptr, 0);
+    }
+
+    void AnimationSampler::sample(float time, AnimationPose& pose, const std::vector<uint8_t>& boneMask) {
+        sampleTracks(time, pose, boneMask.data(), static_cast<int>(boneMask.size()));
+    }
+
+    void AnimationSampler::sampleTracks(float time, AnimationPose& pose, const uint8_t* boneMask, int maskSize) {
+        if (!m_clip) return;
+        if (m_clip->getRevision() != m_revision) {
+            rebuildTracks();
+        }
+
+        // Same wrapping as AnimationClip::evaluate
+        float duration = m_clip->getDuration();
+        float evalTime = duration > 0.0f ? std::fmod(time, duration) : time;
+
+        const int boneCount = pose.getBoneCount();
+        const int trackCount = static_cast<int>(m_trackBone.size());
+        for (int track = 0; track < trackCount; ++track) {
+            int bone = m_trackBone[track];
+            if (bone < 0 || bone >= boneCount) continue;
+            if (boneMask && (bone >= maskSize || !boneMask[bone])) continue;
+
+            const Keyframe* keyframes = m_trackKeyframes[track]->data();
+            int count = static_cast<int>(m_trackKeyframes[track]->size());
+            int index = findKeyframe(keyframes, count, evalTime, m_cursor[track]);
+            m_cursor[track] = index;
+
+            // Before the first or past the last keyframe the pose holds it
+            const Keyframe& a = keyframes[std::max(index, 0)];
+            glm::quat rotationA(a.rotation[3], a.rotation[0], a.rotation[1], a.rotation[2]);
+            if (index < 0 || index + 1 >= count) {
+                pose.translations[bone] = glm::vec3(a.position[0], a.position[1], a.position[2]);
+                pose.rotations[bone] = rotationA;
+                pose.scales[bone] = glm::vec3(a.scale[0], a.scale[1], a.scale[2]);
+                continue;
+            }
+
+            const Keyframe& b = keyframes[index + 1];
+            float t = (evalTime - a.time) / (b.time - a.time);
+            glm::quat rotationB(b.rotation[3], b.rotation[0], b.rotation[1], b.rotation[2]);
+            pose.translations[bone] = glm::vec3(a.position[0] + (b.position[0] - a.position[0]) * t,
+                                                a.position[1] + (b.position[1] - a.position[1]) * t,
+                                                a.position[2] + (b.position[2] - a.position[2]) * t);
+            pose.rotations[bone] = glm::slerp(rotationA, rotationB, t);
+            pose.scales[bone] = glm::vec3(a.scale[0] + (b.scale[0] - a.scale[0]) * t,
+                                          a.scale[1] + (b.scale[1] - a.scale[1]) * t,
+                                          a.scale[2] + (b.scale[2] - a.scale[2]) * t);
+        }
+    }
+}
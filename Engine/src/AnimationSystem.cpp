@@ -0,0 +1,309 @@
+#include "../include/AnimationSystem.h"
+#include "../include/AdvancedAnimationSystem.h"
+#include "../include/Camera.h"
+#include "../include/JobSystem.h"
+#include "../include/Logger.h"
+#include "../include/TimingUtils.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace Sparky {
+    namespace {
+        // What an animator does this frame
+        enum : uint8_t {
+            ACTION_NONE,
+            ACTION_EVALUATE,
+            ACTION_INTERPOLATE
+        };
+
+        const int kMaxLevel = 3;    // 1/8 rate
+    }
+
+    AnimationSystem::AnimationSystem()
+        : AnimationSystem(AnimationSystemSettings()) {
+    }
+
+    AnimationSystem::AnimationSystem(const AnimationSystemSettings& settings)
+        : m_settings(settings)
+        , m_jobSystem(nullptr)
+        , m_camera(nullptr)
+        , m_animatorCount(0)
+        , m_front(0)
+        , m_stats() {
+        if (m_settings.batchSize < 1) {
+            SPARKY_LOG_WARNING("AnimationSystem: batch size must be at least 1, using 8");
+            m_settings.batchSize = 8;
+        }
+        for (int level = 1; level < kMaxLevel; ++level) {
+            if (m_settings.rateDistances[level] < m_settings.rateDistances[level - 1]) {
+                SPARKY_LOG_WARNING("AnimationSystem: rate distances must not decrease, using the previous distance");
+                m_settings.rateDistances[level] = m_settings.rateDistances[level - 1];
+            }
+        }
+    }
+
+    std::unique_ptr<AnimationSystem> AnimationSystem::create(const AnimationSystemSettings& settings) {
+        return std::make_unique<AnimationSystem>(settings);
+    }
+
+    AnimatorId AnimationSystem::addAnimator(SkeletalAnimation* animation, AdvancedAnimationController* controller,
+                                            InverseKinematics* ik) {
+        if (!animation) return INVALID_ANIMATOR;
+
+        int slot;
+        if (!m_freeSlots.empty()) {
+            slot = m_freeSlots.back();
+            m_freeSlots.pop_back();
+        } else {
+            slot = static_cast<int>(m_animation.size());
+            m_animation.push_back(nullptr);
+            m_controller.push_back(nullptr);
+            m_ik.push_back(nullptr);
+            m_interval.push_back(-1);
+            m_span.push_back(1);
+            m_sinceUpdate.push_back(0);
+            m_pendingTime.push_back(0.0f);
+            m_snapped.push_back(0);
+            m_ikActive.push_back(0);
+            m_action.push_back(ACTION_NONE);
+            m_stepTime.push_back(0.0f);
+            m_alpha.push_back(1.0f);
+        }
+
+        m_animation[slot] = animation;
+        m_controller[slot] = controller;
+        m_ik[slot] = ik;
+        m_interval[slot] = -1;
+        m_sinceUpdate[slot] = 0;
+        m_pendingTime[slot] = 0.0f;
+        animation->setUpdatedBySystem(true);
+        if (controller) controller->setUpdatedBySystem(true);
+        if (ik) ik->setUpdatedBySystem(true);
+        ++m_animatorCount;
+        return slot;
+    }
+
+    AnimatorId AnimationSystem::addAnimator(GameObject* object) {
+        if (!object) return INVALID_ANIMATOR;
+        return addAnimator(object->getComponent<SkeletalAnimation>(), object->getComponent<AdvancedAnimationController>(),
+                           object->getComponent<InverseKinematics>());
+    }
+
+    void AnimationSystem::removeAnimator(AnimatorId animator) {
+        if (animator < 0 || animator >= static_cast<int>(m_animation.size()) || !m_animation[animator]) return;
+        m_animation[animator]->setUpdatedBySystem(false);
+        m_animation[animator]->setLeafBonesSkipped(false);
+        m_animation[animator]->setPoseHistory(false);
+        if (m_controller[animator]) m_controller[animator]->setUpdatedBySystem(false);
+        if (m_ik[animator]) m_ik[animator]->setUpdatedBySystem(false);
+        m_animation[animator] = nullptr;
+        m_controller[animator] = nullptr;
+        m_ik[animator] = nullptr;
+        m_freeSlots.push_back(animator);
+        --m_animatorCount;
+    }
+
+    int AnimationSystem::getAnimatorInterval(AnimatorId animator) const {
+        if (animator < 0 || animator >= static_cast<int>(m_animation.size()) || !m_animation[animator]) return 0;
+        return std::max(m_interval[animator], 0);
+    }
+
+    const glm::mat4* AnimationSystem::getSkinningMatrices(AnimatorId animator, int& boneCount) const {
+        boneCount = 0;
+        const std::vector<int>& offsets = m_offset[m_front];
+        if (animator < 0 || animator >= static_cast<int>(offsets.size()) || offsets[animator] < 0) return nullptr;
+        boneCount = m_boneCount[m_front][animator];
+        return m_arena[m_front].data() + offsets[animator];
+    }
+
+    int AnimationSystem::getPoseOffset(AnimatorId animator) const {
+        const std::vector<int>& offsets = m_offset[m_front];
+        if (animator < 0 || animator >= static_cast<int>(offsets.size())) return -1;
+        return offsets[animator];
+    }
+
+    int AnimationSystem::runBatches(size_t count, const std::function<void(size_t, size_t)>& body) {
+        if (count == 0) return 0;
+        size_t batchSize = static_cast<size_t>(m_settings.batchSize);
+        size_t batchCount = (count + batchSize - 1) / batchSize;
+        if (m_jobSystem && m_jobSystem->getWorkerCount() > 0 && batchCount > 1) {
+            m_jobSystem->parallelFor(count, batchSize, body);
+            return static_cast<int>(batchCount);
+        }
+        body(0, count);
+        return 1;
+    }
+
+    void AnimationSystem::chooseDetail(int slot, float deltaTime, float viewHalfAngle) {
+        SkeletalAnimation* animation = m_animation[slot];
+        const int previous = m_interval[slot];
+        int interval = 1;
+        bool leafBones = true;
+        bool ik = true;
+
+        if (m_camera) {
+            GameObject* object = animation->getOwner();
+            glm::vec3 offset = object ? object->getPosition() - m_camera->getPosition() : glm::vec3(0.0f);
+            float distance = glm::length(offset);
+
+            // Bounding sphere against a cone around the view's diagonal
+            bool inView = distance <= m_settings.boundingRadius;
+            if (!inView) {
+                float cosAngle = glm::dot(offset, m_camera->getFront()) / distance;
+                float angle = std::acos(std::min(std::max(cosAngle, -1.0f), 1.0f));
+                inView = angle <= viewHalfAngle + std::asin(m_settings.boundingRadius / distance);
+            }
+
+            if (!inView || distance > m_settings.cullDistance) {
+                interval = 0;
+            } else {
+                // Coarsening waits for the hysteresis margin past a distance
+                int current = previous > 0 ? static_cast<int>(std::log2(static_cast<float>(previous)) + 0.5f) : kMaxLevel;
+                int level = 0;
+                while (level < kMaxLevel) {
+                    float threshold = m_settings.rateDistances[level];
+                    if (current <= level) threshold *= 1.0f + m_settings.hysteresis;
+                    if (distance <= threshold) break;
+                    ++level;
+                }
+                interval = 1 << level;
+                leafBones = distance <= m_settings.leafBoneDistance;
+                ik = distance <= m_settings.ikDistance;
+            }
+        }
+
+        m_interval[slot] = interval;
+        m_ikActive[slot] = ik && m_ik[slot] ? 1 : 0;
+        animation->setLeafBonesSkipped(!leafBones);
+        if ((interval > 1) != (previous > 1)) {
+            animation->setPoseHistory(interval > 1);
+        }
+
+        if (interval == 0) {
+            m_action[slot] = ACTION_NONE;
+            m_pendingTime[slot] += deltaTime;
+            ++m_stats.animatorsCulled;
+            return;
+        }
+        int level = 0;
+        while ((1 << level) < interval) ++level;
+        ++m_stats.rateCounts[level];
+
+        if (interval != previous || interval == 1 || m_sinceUpdate[slot] + 1 >= m_span[slot]) {
+            // A new level starts at a staggered phase so animators do not all update together
+            bool changed = interval != previous;
+            m_action[slot] = ACTION_EVALUATE;
+            m_stepTime[slot] = m_pendingTime[slot] + deltaTime;
+            m_pendingTime[slot] = 0.0f;
+            m_sinceUpdate[slot] = 0;
+            m_snapped[slot] = changed || interval == 1 ? 1 : 0;
+            m_span[slot] = changed && interval > 1 ? interval + slot % interval : interval;
+            m_alpha[slot] = 1.0f / static_cast<float>(m_span[slot]);
+        } else {
+            m_action[slot] = m_snapped[slot] ? ACTION_NONE : ACTION_INTERPOLATE;
+            m_pendingTime[slot] += deltaTime;
+            ++m_sinceUpdate[slot];
+            m_alpha[slot] = static_cast<float>(m_sinceUpdate[slot] + 1) / static_cast<float>(m_span[slot]);
+        }
+    }
+
+    void AnimationSystem::update(float deltaTime) {
+        auto frameStart = std::chrono::steady_clock::now();
+        m_stats = AnimationSystemStats();
+
+        m_batch.clear();
+        for (int slot = 0; slot < static_cast<int>(m_animation.size()); ++slot) {
+            if (m_animation[slot]) m_batch.push_back(slot);
+        }
+        m_stats.animatorsUpdated = static_cast<int>(m_batch.size());
+
+        // State machines may start clips and blends, so they go first
+        auto start = std::chrono::steady_clock::now();
+        for (int slot : m_batch) {
+            if (m_controller[slot]) m_controller[slot]->advance(deltaTime);
+        }
+        m_stats.controllerMs = elapsedMs(start);
+
+        // Level of detail, then each animator only touches its own components
+        start = std::chrono::steady_clock::now();
+        float viewHalfAngle = 0.0f;
+        if (m_camera) {
+            float tanHalfFov = std::tan(glm::radians(m_camera->getFOV()) * 0.5f);
+            viewHalfAngle = std::atan(tanHalfFov * std::sqrt(1.0f + m_settings.aspectRatio * m_settings.aspectRatio));
+        }
+        for (int slot : m_batch) {
+            chooseDetail(slot, deltaTime, viewHalfAngle);
+        }
+        m_stats.batches = runBatches(m_batch.size(), [this](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                int slot = m_batch[i];
+                SkeletalAnimation* animation = m_animation[slot];
+                if (m_action[slot] == ACTION_EVALUATE) {
+                    animation->evaluate(m_stepTime[slot]);
+                    if (!m_snapped[slot]) animation->interpolatePose(m_alpha[slot]);
+                } else if (m_action[slot] == ACTION_INTERPOLATE) {
+                    animation->interpolatePose(m_alpha[slot]);
+                } else {
+                    continue;
+                }
+                // IK goes on top of whichever pose is shown, interpolated ones included
+                if (m_ikActive[slot]) m_ik[slot]->solveChains();
+            }
+        });
+        for (int slot : m_batch) {
+            if (m_action[slot] == ACTION_EVALUATE) {
+                ++m_stats.animatorsEvaluated;
+                m_stats.bonesEvaluated += m_animation[slot]->getEvaluatedBoneCount();
+            } else if (m_action[slot] == ACTION_INTERPOLATE) {
+                ++m_stats.animatorsInterpolated;
+            }
+            if (m_action[slot] != ACTION_NONE && m_ikActive[slot]) {
+                const IKSolveStats& ik = m_ik[slot]->getStats();
+                ++m_stats.ikSolved;
+                m_stats.ikChains += ik.chainsSolved;
+                m_stats.ikIterations += ik.iterations;
+                m_stats.ikConverged += ik.converged;
+            }
+            m_stats.bonesTotal += static_cast<int>(m_animation[slot]->getBones().size());
+        }
+        m_stats.evaluateMs = elapsedMs(start);
+
+        // Lay out the back arena, then fill it
+        start = std::chrono::steady_clock::now();
+        const int back = 1 - m_front;
+        std::vector<int>& offsets = m_offset[back];
+        std::vector<int>& boneCounts = m_boneCount[back];
+        offsets.assign(m_animation.size(), -1);
+        boneCounts.assign(m_animation.size(), 0);
+        int total = 0;
+        for (int slot : m_batch) {
+            offsets[slot] = total;
+            boneCounts[slot] = static_cast<int>(m_animation[slot]->getSkinningMatrices().size());
+            total += boneCounts[slot];
+        }
+        m_arena[back].resize(total);
+        runBatches(m_batch.size(), [this, back](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                int slot = m_batch[i];
+                const std::vector<glm::mat4>& skinning = m_animation[slot]->getSkinningMatrices();
+                if (!skinning.empty()) {
+                    std::memcpy(m_arena[back].data() + m_offset[back][slot], skinning.data(), skinning.size() * sizeof(glm::mat4));
+                }
+            }
+        });
+        m_front = back;
+        m_stats.publishMs = elapsedMs(start);
+
+        // Callbacks in id order; one of them may have removed a later animator
+        start = std::chrono::steady_clock::now();
+        for (int slot : m_batch) {
+            if (slot < static_cast<int>(m_animation.size()) && m_animation[slot]) {
+                m_stats.eventsFired += m_animation[slot]->dispatchEvents();
+            }
+        }
+        m_stats.eventMs = elapsedMs(start);
+        m_stats.updateMs = elapsedMs(frameStart);
+    }
+}
@@ -3,6 +3,7 @@
 #include "../include/Logger.h"
 #include "../include/FastEnemy.h"
 #include "../include/HealthComponent.h"
+#include "../include/Random.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <memory>
@@ -58,7 +59,7 @@ namespace Sparky {
         lastSpecialAttackTime += deltaTime;
         if (lastSpecialAttackTime >= specialAttackCooldown) {
             // Randomly choose a special attack
-            int attackType = rand() % 3;
+            int attackType = Random::getInstance().rangeInt(0, 3);
             switch (attackType) {
                 case 0:
                     performAreaAttack();
@@ -0,0 +1,554 @@
+#include "../include/CompiledBehaviorTree.h"
+#include "../include/JobSystem.h"
+#include "../include/Logger.h"
+#include <algorithm>
+
+namespace Sparky {
+    namespace {
+        const uint32_t kNoNode = UINT32_MAX;
+        const uint32_t kMaxDepth = 64;
+        const size_t kBatchSize = 64;   // Agents per tick job
+
+        const uint8_t kSuccessRequiresAll = 1;
+        const uint8_t kFailureRequiresAll = 2;
+
+        bool isLeaf(CompiledNodeType type) {
+            return type >= CompiledNodeType::TASK;
+        }
+
+        bool isCheck(CompiledNodeType type) {
+            return type == CompiledNodeType::CHECK_BOOL || type == CompiledNodeType::CHECK_FLOAT_LESS ||
+                   type == CompiledNodeType::CHECK_FLOAT_GREATER;
+        }
+
+        bool isDecorator(CompiledNodeType type) {
+            return type == CompiledNodeType::INVERTER || type == CompiledNodeType::SUCCEEDER ||
+                   type == CompiledNodeType::REPEATER || type == CompiledNodeType::TIMER;
+        }
+
+        uint32_t wordsFor(BlackboardType type) {
+            return type == BlackboardType::VECTOR3 ? 3u : 1u;
+        }
+
+        float asFloat(uint32_t word) {
+            float value;
+            std::memcpy(&value, &word, sizeof(value));
+            return value;
+        }
+
+        uint32_t asWord(float value) {
+            uint32_t word;
+            std::memcpy(&word, &value, sizeof(word));
+            return word;
+        }
+    }
+
+    // BlackboardLayout implementation
+    BlackboardLayout::BlackboardLayout() : m_wordCount(0) {
+    }
+
+    BlackboardKey BlackboardLayout::declare(const std::string& name, BlackboardType type) {
+        auto it = m_keys.find(name);
+        if (it != m_keys.end()) {
+            return it->second.type == type ? it->second : BlackboardKey();
+        }
+        BlackboardKey key(m_wordCount, type);
+        m_wordCount += wordsFor(type);
+        m_keys[name] = key;
+        return key;
+    }
+
+    BlackboardKey BlackboardLayout::find(const std::string& name) const {
+        auto it = m_keys.find(name);
+        return it != m_keys.end() ? it->second : BlackboardKey();
+    }
+
+    // BehaviorTreeCompiler implementation
+    BehaviorTreeCompiler::BehaviorTreeCompiler() {
+    }
+
+    void BehaviorTreeCompiler::registerTask(const std::string& name, BehaviorTaskFn function, void* userData) {
+        CompiledBehaviorTree::Task task = {function, userData};
+        auto it = std::find(m_taskRegistryNames.begin(), m_taskRegistryNames.end(), name);
+        if (it != m_taskRegistryNames.end()) {
+            m_taskRegistry[it - m_taskRegistryNames.begin()] = task;
+            return;
+        }
+        m_taskRegistryNames.push_back(name);
+        m_taskRegistry.push_back(task);
+    }
+
+    BlackboardKey BehaviorTreeCompiler::declareKey(const std::string& name, BlackboardType type) {
+        BlackboardKey key = m_layout.declare(name, type);
+        if (!key.isValid() && m_error.empty()) {
+            m_error = "blackboard key '" + name + "' declared with two types";
+        }
+        return key;
+    }
+
+    BehaviorTreeCompiler& BehaviorTreeCompiler::push(CompiledNodeType type, bool opens) {
+        if (!m_error.empty()) return *this;
+        if (m_open.empty() && !m_nodes.empty()) {
+            m_error = "tree has more than one root";
+            return *this;
+        }
+        if (m_open.size() >= kMaxDepth) {
+            m_error = "tree is deeper than " + std::to_string(kMaxDepth) + " levels";
+            return *this;
+        }
+
+        CompiledBehaviorNode node = {};
+        node.type = type;
+        node.end = static_cast<uint32_t>(m_nodes.size()) + 1;
+        node.parent = m_open.empty() ? kNoNode : m_open.back();
+        if (node.parent != kNoNode) {
+            CompiledBehaviorNode& parent = m_nodes[node.parent];
+            if (isDecorator(parent.type) && parent.childCount > 0) {
+                m_error = "decorator with more than one child";
+                return *this;
+            }
+            ++parent.childCount;
+        }
+        m_nodes.push_back(node);
+        if (opens) {
+            m_open.push_back(static_cast<uint32_t>(m_nodes.size()) - 1);
+        }
+        return *this;
+    }
+
+    BehaviorTreeCompiler& BehaviorTreeCompiler::pushKeyLeaf(CompiledNodeType type, const std::string& key, BlackboardType keyType) {
+        BlackboardKey slot = declareKey(key, keyType);
+        push(type, false);
+        if (m_error.empty()) {
+            m_nodes.back().operand = slot.offset;
+        }
+        return *this;
+    }
+
+    BehaviorTreeCompiler& BehaviorTreeCompiler::sequence() {
+        return push(CompiledNodeType::SEQUENCE, true);
+    }
+
+    BehaviorTreeCompiler& BehaviorTreeCompiler::selector() {
+        return push(CompiledNodeType::SELECTOR, true);
+    }
+
+    BehaviorTreeCompiler& BehaviorTreeCompiler::reactiveSelector() {
+        return push(CompiledNodeType::REACTIVE_SELECTOR, true);
+    }
+
+    BehaviorTreeCompiler& BehaviorTreeCompiler::parallel(ParallelPolicy successPolicy, ParallelPolicy failurePolicy) {
+        push(CompiledNodeType::PARALLEL, true);
+        if (m_error.empty()) {
+            m_nodes.back().flags = (successPolicy == ParallelPolicy::REQUIRE_ALL ? kSuccessRequiresAll : 0) |
+                                   (failurePolicy == ParallelPolicy::REQUIRE_ALL ? kFailureRequiresAll : 0);
+        }
+        return *this;
+    }
+
+    BehaviorTreeCompiler& BehaviorTreeCompiler::inverter() {
+        return push(CompiledNodeType::INVERTER, true);
+    }
+
+    BehaviorTreeCompiler& BehaviorTreeCompiler::succeeder() {
+        return push(CompiledNodeType::SUCCEEDER, true);
+    }
+
+    BehaviorTreeCompiler& BehaviorTreeCompiler::repeater(int limit) {
+        push(CompiledNodeType::REPEATER, true);
+        if (m_error.empty()) {
+            m_nodes.back().operand = static_cast<uint32_t>(limit);
+        }
+        return *this;
+    }
+
+    BehaviorTreeCompiler& BehaviorTreeCompiler::timer(float duration) {
+        push(CompiledNodeType::TIMER, true);
+        if (m_error.empty()) {
+            m_nodes.back().value = duration;
+        }
+        return *this;
+    }
+
+    BehaviorTreeCompiler& BehaviorTreeCompiler::end() {
+        if (!m_error.empty()) return *this;
+        if (m_open.empty()) {
+            m_error = "end() without an open node";
+            return *this;
+        }
+        CompiledBehaviorNode& node = m_nodes[m_open.back()];
+        m_open.pop_back();
+        node.end = static_cast<uint32_t>(m_nodes.size());
+        if (isDecorator(node.type) && node.childCount != 1) {
+            m_error = "decorator without a child";
+        } else if (node.type == CompiledNodeType::PARALLEL && node.childCount == 0) {
+            m_error = "parallel node without children";
+        }
+        return *this;
+    }
+
+    BehaviorTreeCompiler& BehaviorTreeCompiler::task(const std::string& name) {
+        push(CompiledNodeType::TASK, false);
+        if (m_error.empty()) {
+            m_nodes.back().operand = static_cast<uint32_t>(m_taskNames.size());
+            m_taskNames.push_back(name);
+        }
+        return *this;
+    }
+
+    BehaviorTreeCompiler& BehaviorTreeCompiler::checkBool(const std::string& key, bool expected) {
+        pushKeyLeaf(CompiledNodeType::CHECK_BOOL, key, BlackboardType::BOOL);
+        if (m_error.empty()) m_nodes.back().flags = expected ? 1 : 0;
+        return *this;
+    }
+
+    BehaviorTreeCompiler& BehaviorTreeCompiler::checkFloatLess(const std::string& key, float value) {
+        pushKeyLeaf(CompiledNodeType::CHECK_FLOAT_LESS, key, BlackboardType::FLOAT);
+        if (m_error.empty()) m_nodes.back().value = value;
+        return *this;
+    }
+
+    BehaviorTreeCompiler& BehaviorTreeCompiler::checkFloatGreater(const std::string& key, float value) {
+        pushKeyLeaf(CompiledNodeType::CHECK_FLOAT_GREATER, key, BlackboardType::FLOAT);
+        if (m_error.empty()) m_nodes.back().value = value;
+        return *this;
+    }
+
+    BehaviorTreeCompiler& BehaviorTreeCompiler::setBool(const std::string& key, bool value) {
+        pushKeyLeaf(CompiledNodeType::SET_BOOL, key, BlackboardType::BOOL);
+        if (m_error.empty()) m_nodes.back().flags = value ? 1 : 0;
+        return *this;
+    }
+
+    std::shared_ptr<const CompiledBehaviorTree> BehaviorTreeCompiler::compile() const {
+        std::string error = m_error;
+        if (error.empty() && m_nodes.empty()) error = "tree is empty";
+        if (error.empty() && !m_open.empty()) error = "missing end() for an open node";
+        if (!error.empty()) {
+            SPARKY_LOG_ERROR("BehaviorTreeCompiler: " + error);
+            return nullptr;
+        }
+
+        std::shared_ptr<CompiledBehaviorTree> tree = std::make_shared<CompiledBehaviorTree>();
+        tree->m_nodes = m_nodes;
+        tree->m_layout = m_layout;
+        tree->m_stateWords = 0;
+        tree->m_maxDepth = 0;
+
+        std::vector<uint32_t> depth(m_nodes.size(), 1);
+        for (size_t index = 0; index < tree->m_nodes.size(); ++index) {
+            CompiledBehaviorNode& node = tree->m_nodes[index];
+            if (node.parent != kNoNode) depth[index] = depth[node.parent] + 1;
+            tree->m_maxDepth = std::max(tree->m_maxDepth, depth[index]);
+
+            // Per-agent state: repeat count, timer elapsed, or status and resume point per parallel child
+            node.state = tree->m_stateWords;
+            if (node.type == CompiledNodeType::REPEATER || node.type == CompiledNodeType::TIMER) {
+                tree->m_stateWords += 1;
+            } else if (node.type == CompiledNodeType::PARALLEL) {
+                tree->m_stateWords += 2u * node.childCount;
+            }
+
+            // Task names become indices into the tree's own task table
+            if (node.type == CompiledNodeType::TASK) {
+                const std::string& name = m_taskNames[node.operand];
+                auto it = std::find(m_taskRegistryNames.begin(), m_taskRegistryNames.end(), name);
+                if (it == m_taskRegistryNames.end() || !m_taskRegistry[it - m_taskRegistryNames.begin()].function) {
+                    SPARKY_LOG_ERROR("BehaviorTreeCompiler: task '" + name + "' is not registered");
+                    return nullptr;
+                }
+                node.operand = static_cast<uint32_t>(tree->m_tasks.size());
+                tree->m_tasks.push_back(m_taskRegistry[it - m_taskRegistryNames.begin()]);
+            }
+        }
+        return tree;
+    }
+
+    // BehaviorTreeBatch implementation
+    BehaviorTreeBatch::BehaviorTreeBatch(std::shared_ptr<const CompiledBehaviorTree> tree)
+        : m_tree(std::move(tree))
+        , m_nodes(nullptr)
+        , m_jobSystem(nullptr)
+        , m_stateStride(1)
+        , m_blackboardStride(0)
+        , m_agentCount(0) {
+        if (m_tree) {
+            m_nodes = m_tree->m_nodes.data();
+            m_stateStride = 1 + m_tree->m_stateWords;
+            m_blackboardStride = m_tree->m_layout.getWordCount();
+        } else {
+            SPARKY_LOG_WARNING("BehaviorTreeBatch: created without a tree, agents will never run");
+        }
+    }
+
+    int BehaviorTreeBatch::addAgent(void* agentData) {
+        int slot;
+        if (!m_freeSlots.empty()) {
+            slot = m_freeSlots.back();
+            m_freeSlots.pop_back();
+        } else {
+            slot = static_cast<int>(m_active.size());
+            m_states.resize(m_states.size() + m_stateStride);
+            m_blackboards.resize(m_blackboards.size() + m_blackboardStride);
+            m_agentData.push_back(nullptr);
+            m_lastStatus.push_back(NodeStatus::RUNNING);
+            m_active.push_back(0);
+        }
+
+        std::fill(m_blackboards.begin() + slot * m_blackboardStride, m_blackboards.begin() + (slot + 1) * m_blackboardStride, 0u);
+        m_agentData[slot] = agentData;
+        m_active[slot] = 1;
+        resetAgent(slot);
+        ++m_agentCount;
+        return slot;
+    }
+
+    void BehaviorTreeBatch::removeAgent(int agent) {
+        if (agent < 0 || agent >= static_cast<int>(m_active.size()) || !m_active[agent]) return;
+        m_active[agent] = 0;
+        m_agentData[agent] = nullptr;
+        m_freeSlots.push_back(agent);
+        --m_agentCount;
+    }
+
+    void BehaviorTreeBatch::resetAgent(int agent) {
+        if (agent < 0 || agent >= static_cast<int>(m_active.size())) return;
+        m_states[agent * m_stateStride] = kNoNode;
+        m_lastStatus[agent] = NodeStatus::RUNNING;
+    }
+
+    void BehaviorTreeBatch::tick(float deltaTime) {
+        if (!m_tree) return;
+        size_t slotCount = m_active.size();
+        auto tickRange = [this, deltaTime, slotCount](size_t begin, size_t end) {
+            for (size_t batch = begin; batch < end; ++batch) {
+                size_t last = std::min(slotCount, (batch + 1) * kBatchSize);
+                for (size_t agent = batch * kBatchSize; agent < last; ++agent) {
+                    if (m_active[agent]) tickAgent(static_cast<int>(agent), deltaTime);
+                }
+            }
+        };
+        size_t batchCount = (slotCount + kBatchSize - 1) / kBatchSize;
+        if (m_jobSystem && m_jobSystem->getWorkerCount() > 0 && batchCount > 1) {
+            m_jobSystem->parallelFor(batchCount, 1, tickRange);
+        } else {
+            tickRange(0, batchCount);
+        }
+    }
+
+    void BehaviorTreeBatch::tickAgent(int agent, float deltaTime) {
+        if (!m_tree) return;
+        Frame frame;
+        frame.agent = agent;
+        frame.deltaTime = deltaTime;
+        frame.state = &m_states[agent * m_stateStride];
+        frame.blackboard = m_blackboardStride ? &m_blackboards[agent * m_blackboardStride] : nullptr;
+        frame.resume = kNoNode;
+
+        uint32_t resumeNode = frame.state[0];
+        NodeStatus status = resumeNode != kNoNode ? resume(resumeNode, 0, frame) : enter(0, frame);
+
+        // Finished trees start again from the root, as BehaviorTree::update() does
+        frame.state[0] = status == NodeStatus::RUNNING ? frame.resume : kNoNode;
+        m_lastStatus[agent] = status;
+    }
+
+    NodeStatus BehaviorTreeBatch::enter(uint32_t node, Frame& frame) const {
+        const CompiledBehaviorNode& current = m_nodes[node];
+        uint32_t* state = frame.state + 1 + current.state;
+        switch (current.type) {
+            case CompiledNodeType::SEQUENCE:
+                for (uint32_t child = node + 1; child < current.end; child = m_nodes[child].end) {
+                    NodeStatus status = enter(child, frame);
+                    if (status != NodeStatus::SUCCESS) return status;
+                }
+                return NodeStatus::SUCCESS;
+            case CompiledNodeType::SELECTOR:
+            case CompiledNodeType::REACTIVE_SELECTOR:
+                for (uint32_t child = node + 1; child < current.end; child = m_nodes[child].end) {
+                    NodeStatus status = enter(child, frame);
+                    if (status != NodeStatus::FAILURE) return status;
+                }
+                return NodeStatus::FAILURE;
+            case CompiledNodeType::PARALLEL:
+                for (uint32_t child = 0; child < current.childCount; ++child) {
+                    state[2 * child] = static_cast<uint32_t>(NodeStatus::RUNNING);
+                    state[2 * child + 1] = kNoNode;
+                }
+                return parallelStep(node, frame);
+            case CompiledNodeType::REPEATER:
+                state[0] = 0;
+                return repeatStep(node, enter(node + 1, frame), frame);
+            case CompiledNodeType::TIMER:
+                state[0] = asWord(0.0f);
+                return timerStep(node, enter(node + 1, frame), frame);
+            case CompiledNodeType::INVERTER:
+            case CompiledNodeType::SUCCEEDER:
+                return climb(node, node + 1, enter(node + 1, frame), frame);
+            default:
+                return runLeaf(node, frame);
+        }
+    }
+
+    NodeStatus BehaviorTreeBatch::resume(uint32_t node, uint32_t stop, Frame& frame) const {
+        // Path from the resume point up to the stop node, root-most last
+        uint32_t path[kMaxDepth];
+        uint32_t length = 0;
+        for (uint32_t current = node; ; current = m_nodes[current].parent) {
+            path[length++] = current;
+            if (current == stop) break;
+        }
+
+        // Top-down, higher-priority branches of reactive selectors get a chance
+        // to take over, and blackboard checks guarding the running branch in a
+        // sequence are re-read so it stops once they no longer hold
+        for (uint32_t level = length - 1; level > 0; --level) {
+            uint32_t ancestor = path[level];
+            CompiledNodeType type = m_nodes[ancestor].type;
+            for (uint32_t child = ancestor + 1; child != path[level - 1]; child = m_nodes[child].end) {
+                NodeStatus status;
+                if (type == CompiledNodeType::REACTIVE_SELECTOR) {
+                    status = enter(child, frame);
+                    if (status == NodeStatus::FAILURE) continue;
+                    status = climb(ancestor, child, status, frame);
+                } else if (type == CompiledNodeType::SEQUENCE && isCheck(m_nodes[child].type)) {
+                    if (runLeaf(child, frame) == NodeStatus::SUCCESS) continue;
+                    status = NodeStatus::FAILURE;
+                } else {
+                    continue;
+                }
+                for (uint32_t up = level + 1; up < length; ++up) {
+                    status = climb(path[up], path[up - 1], status, frame);
+                }
+                return status;
+            }
+        }
+
+        NodeStatus status = continueNode(node, frame);
+        for (uint32_t up = 1; up < length; ++up) {
+            status = climb(path[up], path[up - 1], status, frame);
+        }
+        return status;
+    }
+
+    NodeStatus BehaviorTreeBatch::continueNode(uint32_t node, Frame& frame) const {
+        switch (m_nodes[node].type) {
+            case CompiledNodeType::PARALLEL:
+                return parallelStep(node, frame);
+            case CompiledNodeType::REPEATER:
+                // The previous iteration finished; run the child again from the start
+                return repeatStep(node, enter(node + 1, frame), frame);
+            case CompiledNodeType::TIMER:
+                return timerStep(node, enter(node + 1, frame), frame);
+            default:
+                return isLeaf(m_nodes[node].type) ? runLeaf(node, frame) : enter(node, frame);
+        }
+    }
+
+    NodeStatus BehaviorTreeBatch::climb(uint32_t parent, uint32_t child, NodeStatus status, Frame& frame) const {
+        const CompiledBehaviorNode& current = m_nodes[parent];
+        switch (current.type) {
+            case CompiledNodeType::SEQUENCE:
+                for (child = m_nodes[child].end; status == NodeStatus::SUCCESS && child < current.end; child = m_nodes[child].end) {
+                    status = enter(child, frame);
+                }
+                return status;
+            case CompiledNodeType::SELECTOR:
+            case CompiledNodeType::REACTIVE_SELECTOR:
+                for (child = m_nodes[child].end; status == NodeStatus::FAILURE && child < current.end; child = m_nodes[child].end) {
+                    status = enter(child, frame);
+                }
+                return status;
+            case CompiledNodeType::INVERTER:
+                if (status == NodeStatus::SUCCESS) return NodeStatus::FAILURE;
+                if (status == NodeStatus::FAILURE) return NodeStatus::SUCCESS;
+                return status;
+            case CompiledNodeType::SUCCEEDER:
+                return status == NodeStatus::RUNNING ? status : NodeStatus::SUCCESS;
+            case CompiledNodeType::REPEATER:
+                return repeatStep(parent, status, frame);
+            case CompiledNodeType::TIMER:
+                return timerStep(parent, status, frame);
+            default:
+                // Parallel children resume below the parallel node and never climb past it
+                return status;
+        }
+    }
+
+    NodeStatus BehaviorTreeBatch::runLeaf(uint32_t node, Frame& frame) const {
+        const CompiledBehaviorNode& current = m_nodes[node];
+        FlatBlackboard blackboard(frame.blackboard);
+        switch (current.type) {
+            case CompiledNodeType::TASK: {
+                const CompiledBehaviorTree::Task& task = m_tree->m_tasks[current.operand];
+                BehaviorTaskContext context = {blackboard, m_agentData[frame.agent], task.userData, frame.deltaTime, frame.agent};
+                NodeStatus status = task.function(context);
+                if (status == NodeStatus::RUNNING) frame.resume = node;
+                return status;
+            }
+            case CompiledNodeType::CHECK_BOOL: {
+                bool value = frame.blackboard[current.operand] != 0;
+                return value == (current.flags != 0) ? NodeStatus::SUCCESS : NodeStatus::FAILURE;
+            }
+            case CompiledNodeType::CHECK_FLOAT_LESS:
+                return asFloat(frame.blackboard[current.operand]) < current.value ? NodeStatus::SUCCESS : NodeStatus::FAILURE;
+            case CompiledNodeType::CHECK_FLOAT_GREATER:
+                return asFloat(frame.blackboard[current.operand]) > current.value ? NodeStatus::SUCCESS : NodeStatus::FAILURE;
+            case CompiledNodeType::SET_BOOL:
+                frame.blackboard[current.operand] = current.flags;
+                return NodeStatus::SUCCESS;
+            default:
+                return NodeStatus::FAILURE;
+        }
+    }
+
+    NodeStatus BehaviorTreeBatch::repeatStep(uint32_t node, NodeStatus childStatus, Frame& frame) const {
+        if (childStatus != NodeStatus::SUCCESS) return childStatus;
+
+        // One iteration per tick, like RepeaterNode
+        uint32_t& count = frame.state[1 + m_nodes[node].state];
+        int32_t limit = static_cast<int32_t>(m_nodes[node].operand);
+        ++count;
+        if (limit >= 0 && count >= static_cast<uint32_t>(limit)) return NodeStatus::SUCCESS;
+        frame.resume = node;
+        return NodeStatus::RUNNING;
+    }
+
+    NodeStatus BehaviorTreeBatch::timerStep(uint32_t node, NodeStatus childStatus, Frame& frame) const {
+        // Runs the child until the duration is up, like TimerNode
+        uint32_t& elapsed = frame.state[1 + m_nodes[node].state];
+        float time = asFloat(elapsed) + frame.deltaTime;
+        elapsed = asWord(time);
+        if (time >= m_nodes[node].value) return NodeStatus::SUCCESS;
+        if (childStatus != NodeStatus::RUNNING) frame.resume = node;
+        return NodeStatus::RUNNING;
+    }
+
+    NodeStatus BehaviorTreeBatch::parallelStep(uint32_t node, Frame& frame) const {
+        const CompiledBehaviorNode& current = m_nodes[node];
+        uint32_t* state = frame.state + 1 + current.state;
+        uint32_t successCount = 0;
+        uint32_t failureCount = 0;
+        uint32_t index = 0;
+        for (uint32_t child = node + 1; child < current.end; child = m_nodes[child].end, ++index) {
+            NodeStatus status = static_cast<NodeStatus>(state[2 * index]);
+            if (status == NodeStatus::RUNNING) {
+                // Each running child keeps its own resume point below this node
+                frame.resume = kNoNode;
+                uint32_t childResume = state[2 * index + 1];
+                status = childResume != kNoNode ? resume(childResume, child, frame) : enter(child, frame);
+                state[2 * index] = static_cast<uint32_t>(status);
+                state[2 * index + 1] = status == NodeStatus::RUNNING ? frame.resume : kNoNode;
+            }
+            if (status == NodeStatus::SUCCESS) ++successCount;
+            if (status == NodeStatus::FAILURE) ++failureCount;
+        }
+
+        bool success = (current.flags & kSuccessRequiresAll) ? successCount == current.childCount : successCount > 0;
+        bool failure = (current.flags & kFailureRequiresAll) ? failureCount == current.childCount : failureCount > 0;
+        if (success) return NodeStatus::SUCCESS;
+        if (failure) return NodeStatus::FAILURE;
+        frame.resume = node;
+        return NodeStatus::RUNNING;
+    }
+}
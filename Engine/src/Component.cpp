@@ -1,4 +1,5 @@
 #include "../include/Component.h"
+#include "../include/GameObject.h"
 
 namespace Sparky {
 
@@ -15,4 +16,10 @@ namespace Sparky {
     GameObject* Component::getOwner() const {
         return owner;
     }
+
+    void Component::markOwnerDirty() {
+        if (owner) {
+            owner->markDirty();
+        }
+    }
 }
\ No newline at end of file
@@ -1,12 +1,25 @@
 #include "../include/Config.h"
 #include "../include/FileUtils.h"
 #include "../include/Logger.h"
+#include "../include/SaveArchive.h"
 #include <fstream>
 #include <sstream>
 #include <memory>
 
 namespace Sparky {
 
+    namespace {
+        const uint32_t kConfigChunk = SaveArchive::makeChunkId('C', 'O', 'N', 'F');
+        const uint16_t kConfigChunkVersion = 1;
+
+        enum ConfigValueType : uint8_t {
+            CONFIG_INT,
+            CONFIG_FLOAT,
+            CONFIG_BOOL,
+            CONFIG_STRING
+        };
+    }
+
     // Default constructor
     Config::Config() : configFile("") {
     }
@@ -114,6 +127,14 @@ namespace Sparky {
 
         try {
             std::vector<char> data = FileUtils::readFile(filepath);
+            if (SaveArchive::isArchive(data)) {
+                if (readArchive(data)) {
+                    SPARKY_LOG_INFO("Config loaded successfully");
+                }
+                return;
+            }
+            
+            // Hand-written key=value text
             std::string content(data.begin(), data.end());
             
             std::istringstream iss(content);
@@ -165,31 +186,104 @@ namespace Sparky {
     void Config::saveToFile(const std::string& filepath) {
         SPARKY_LOG_INFO("Saving config to file: " + filepath);
         
-        std::ofstream file(filepath);
-        if (!file.is_open()) {
-            SPARKY_LOG_ERROR("Failed to open config file for writing: " + filepath);
-            return;
-        }
-        
+        // Values keep their exact type, unlike the text format where 1.0f reads back as an int
+        BinaryWriter writer;
+        size_t countPosition = writer.reserveU32();
+        uint32_t entryCount = 0;
         for (const auto& pair : configMap) {
             const std::string& key = pair.first;
             
             try {
                 if (pair.second.type() == typeid(int)) {
-                    file << key << "=" << std::any_cast<int>(pair.second) << "\n";
+                    writer.writeString(key);
+                    writer.writeU8(CONFIG_INT);
+                    writer.writeI32(std::any_cast<int>(pair.second));
                 } else if (pair.second.type() == typeid(float)) {
-                    file << key << "=" << std::any_cast<float>(pair.second) << "\n";
+                    writer.writeString(key);
+                    writer.writeU8(CONFIG_FLOAT);
+                    writer.writeFloat(std::any_cast<float>(pair.second));
                 } else if (pair.second.type() == typeid(bool)) {
-                    file << key << "=" << (std::any_cast<bool>(pair.second) ? "true" : "false") << "\n";
+                    writer.writeString(key);
+                    writer.writeU8(CONFIG_BOOL);
+                    writer.writeBool(std::any_cast<bool>(pair.second));
                 } else if (pair.second.type() == typeid(std::string)) {
-                    file << key << "=" << std::any_cast<std::string>(pair.second) << "\n";
+                    writer.writeString(key);
+                    writer.writeU8(CONFIG_STRING);
+                    writer.writeString(std::any_cast<std::string>(pair.second));
+                } else {
+                    continue;
                 }
+                entryCount++;
             } catch (const std::bad_any_cast& e) {
                 SPARKY_LOG_WARNING("Failed to save config value for key: " + key);
             }
         }
+        writer.patchU32(countPosition, entryCount);
+        
+        SaveArchive archive;
+        archive.setChunk(kConfigChunk, kConfigChunkVersion, writer);
+        if (!archive.saveToFile(filepath)) {
+            SPARKY_LOG_ERROR("Failed to write config file: " + filepath);
+            return;
+        }
         
-        file.close();
         SPARKY_LOG_INFO("Config saved successfully");
     }
+
+    bool Config::readArchive(const std::vector<char>& data) {
+        SaveArchive archive;
+        const SaveChunk* chunk = archive.decode(data) ? archive.getChunk(kConfigChunk) : nullptr;
+        if (!chunk || chunk->version > kConfigChunkVersion) {
+            SPARKY_LOG_ERROR("Invalid config save archive");
+            return false;
+        }
+        
+        BinaryReader reader(chunk->data);
+        uint32_t entryCount = 0;
+        if (!reader.readU32(entryCount)) {
+            SPARKY_LOG_ERROR("Invalid config file format");
+            return false;
+        }
+        
+        for (uint32_t i = 0; i < entryCount; i++) {
+            std::string key;
+            uint8_t type = 0;
+            if (!reader.readString(key) || !reader.readU8(type)) {
+                SPARKY_LOG_ERROR("Invalid config entry");
+                return false;
+            }
+            
+            bool valid = false;
+            switch (type) {
+                case CONFIG_INT: {
+                    int32_t value = 0;
+                    if ((valid = reader.readI32(value))) setInt(key, value);
+                    break;
+                }
+                case CONFIG_FLOAT: {
+                    float value = 0.0f;
+                    if ((valid = reader.readFloat(value))) setFloat(key, value);
+                    break;
+                }
+                case CONFIG_BOOL: {
+                    bool value = false;
+                    if ((valid = reader.readBool(value))) setBool(key, value);
+                    break;
+                }
+                case CONFIG_STRING: {
+                    std::string value;
+                    if ((valid = reader.readString(value))) setString(key, value);
+                    break;
+                }
+                default:
+                    break;
+            }
+            
+            if (!valid) {
+                SPARKY_LOG_ERROR("Invalid config value for key: " + key);
+                return false;
+            }
+        }
+        return true;
+    }
 }
\ No newline at end of file
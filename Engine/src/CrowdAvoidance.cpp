@@ -0,0 +1,421 @@
+#include "../include/CrowdAvoidance.h"
+#include "../include/JobSystem.h"
+#include "../include/Logger.h"
+#include "../include/TimingUtils.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace Sparky {
+    namespace {
+        const float kEpsilon = 1e-5f;
+        const size_t kBatchSize = 64;   // Agents per solver job
+        const int kMaxNeighbors = 32;
+        const float kSymmetryTurn = 0.05f;   // Radians across all agents
+
+        float det(const glm::vec2& a, const glm::vec2& b) {
+            return a.x * b.y - a.y * b.x;
+        }
+    }
+
+    CrowdAvoidance::CrowdAvoidance()
+        : CrowdAvoidance(CrowdAvoidanceSettings()) {
+    }
+
+    CrowdAvoidance::CrowdAvoidance(const CrowdAvoidanceSettings& settings)
+        : m_settings(settings)
+        , m_jobSystem(nullptr)
+        , m_agentCount(0)
+        , m_gridOrigin(0.0f)
+        , m_cellSize(1.0f)
+        , m_gridWidth(0)
+        , m_gridHeight(0)
+        , m_stats() {
+        if (m_settings.neighborRadius <= 0.0f) {
+            SPARKY_LOG_WARNING("CrowdAvoidance: neighbor radius must be positive, using 6");
+            m_settings.neighborRadius = 6.0f;
+        }
+        if (m_settings.timeHorizon <= 0.0f) {
+            SPARKY_LOG_WARNING("CrowdAvoidance: time horizon must be positive, using 2");
+            m_settings.timeHorizon = 2.0f;
+        }
+        m_settings.maxNeighbors = std::min(std::max(m_settings.maxNeighbors, 1), kMaxNeighbors);
+    }
+
+    std::unique_ptr<CrowdAvoidance> CrowdAvoidance::create(const CrowdAvoidanceSettings& settings) {
+        return std::make_unique<CrowdAvoidance>(settings);
+    }
+
+    CrowdAgentId CrowdAvoidance::addAgent(const glm::vec3& position, float radius, float maxSpeed) {
+        int slot;
+        if (!m_freeSlots.empty()) {
+            slot = m_freeSlots.back();
+            m_freeSlots.pop_back();
+        } else {
+            slot = static_cast<int>(m_active.size());
+            for (std::vector<float>* field : {&m_positionX, &m_positionZ, &m_velocityX, &m_velocityZ, &m_preferredX,
+                                              &m_preferredZ, &m_resultX, &m_resultZ, &m_radius, &m_maxSpeed}) {
+                field->push_back(0.0f);
+            }
+            m_active.push_back(0);
+            m_agentCell.push_back(-1);
+        }
+
+        m_positionX[slot] = position.x;
+        m_positionZ[slot] = position.z;
+        m_velocityX[slot] = m_velocityZ[slot] = 0.0f;
+        m_preferredX[slot] = m_preferredZ[slot] = 0.0f;
+        m_resultX[slot] = m_resultZ[slot] = 0.0f;
+        m_radius[slot] = std::max(radius, 0.0f);
+        m_maxSpeed[slot] = std::max(maxSpeed, 0.0f);
+        m_active[slot] = 1;
+        ++m_agentCount;
+        return slot;
+    }
+
+    void CrowdAvoidance::removeAgent(CrowdAgentId agent) {
+        if (agent < 0 || agent >= static_cast<int>(m_active.size()) || !m_active[agent]) return;
+        m_active[agent] = 0;
+        m_freeSlots.push_back(agent);
+        --m_agentCount;
+    }
+
+    void CrowdAvoidance::setAgentState(CrowdAgentId agent, const glm::vec3& position, const glm::vec3& velocity) {
+        if (agent < 0 || agent >= static_cast<int>(m_active.size())) return;
+        m_positionX[agent] = position.x;
+        m_positionZ[agent] = position.z;
+        m_velocityX[agent] = velocity.x;
+        m_velocityZ[agent] = velocity.z;
+    }
+
+    void CrowdAvoidance::setPreferredVelocity(CrowdAgentId agent, const glm::vec3& velocity) {
+        if (agent < 0 || agent >= static_cast<int>(m_active.size())) return;
+        m_preferredX[agent] = velocity.x;
+        m_preferredZ[agent] = velocity.z;
+    }
+
+    void CrowdAvoidance::setMaxSpeed(CrowdAgentId agent, float maxSpeed) {
+        if (agent < 0 || agent >= static_cast<int>(m_active.size())) return;
+        m_maxSpeed[agent] = std::max(maxSpeed, 0.0f);
+    }
+
+    glm::vec3 CrowdAvoidance::getAvoidanceVelocity(CrowdAgentId agent) const {
+        if (agent < 0 || agent >= static_cast<int>(m_active.size()) || !m_active[agent]) return glm::vec3(0.0f);
+        return glm::vec3(m_resultX[agent], 0.0f, m_resultZ[agent]);
+    }
+
+    void CrowdAvoidance::step(float deltaTime) {
+        auto start = std::chrono::steady_clock::now();
+        rebuildGrid();
+        m_stats.gridMs = elapsedMs(start);
+        m_stats.agentCount = m_agentCount;
+        m_stats.gridCells = m_gridWidth * m_gridHeight;
+
+        start = std::chrono::steady_clock::now();
+        deltaTime = std::max(deltaTime, kEpsilon);
+        size_t slotCount = m_active.size();
+        size_t batchCount = (slotCount + kBatchSize - 1) / kBatchSize;
+        m_batchPairs.assign(batchCount, 0);
+        m_batchFallbacks.assign(batchCount, 0);
+
+        auto solveBatches = [this, deltaTime, slotCount](size_t begin, size_t end) {
+            std::vector<Line> lines;
+            lines.reserve(m_settings.maxNeighbors);
+            for (size_t batch = begin; batch < end; ++batch) {
+                size_t last = std::min(slotCount, (batch + 1) * kBatchSize);
+                for (size_t agent = batch * kBatchSize; agent < last; ++agent) {
+                    if (m_active[agent]) {
+                        solveAgent(static_cast<int>(agent), deltaTime, lines, m_batchPairs[batch], m_batchFallbacks[batch]);
+                    }
+                }
+            }
+        };
+        if (m_jobSystem && m_jobSystem->getWorkerCount() > 0) {
+            m_jobSystem->parallelFor(batchCount, 1, solveBatches);
+        } else {
+            solveBatches(0, batchCount);
+        }
+
+        m_stats.neighborPairs = 0;
+        m_stats.fallbackSolves = 0;
+        for (size_t batch = 0; batch < batchCount; ++batch) {
+            m_stats.neighborPairs += m_batchPairs[batch];
+            m_stats.fallbackSolves += m_batchFallbacks[batch];
+        }
+        m_stats.solveMs = elapsedMs(start);
+    }
+
+    void CrowdAvoidance::rebuildGrid() {
+        glm::vec2 minBounds(0.0f), maxBounds(0.0f);
+        bool first = true;
+        for (size_t agent = 0; agent < m_active.size(); ++agent) {
+            if (!m_active[agent]) continue;
+            glm::vec2 position(m_positionX[agent], m_positionZ[agent]);
+            minBounds = first ? position : glm::min(minBounds, position);
+            maxBounds = first ? position : glm::max(maxBounds, position);
+            first = false;
+        }
+
+        // Cells at least as large as the search radius, so a query reads 3x3 cells;
+        // coarser when agents are so spread out that cells would outnumber them
+        m_cellSize = m_settings.neighborRadius;
+        glm::vec2 extent = maxBounds - minBounds;
+        size_t cellLimit = std::max<size_t>(64, static_cast<size_t>(m_agentCount) * 4);
+        while ((static_cast<size_t>(extent.x / m_cellSize) + 1) * (static_cast<size_t>(extent.y / m_cellSize) + 1) > cellLimit) {
+            m_cellSize *= 2.0f;
+        }
+        m_gridOrigin = minBounds;
+        m_gridWidth = static_cast<int>(extent.x / m_cellSize) + 1;
+        m_gridHeight = static_cast<int>(extent.y / m_cellSize) + 1;
+
+        // Counting sort of agents by cell
+        size_t cellCount = static_cast<size_t>(m_gridWidth) * m_gridHeight;
+        m_cellStart.assign(cellCount + 1, 0);
+        for (size_t agent = 0; agent < m_active.size(); ++agent) {
+            if (!m_active[agent]) {
+                m_agentCell[agent] = -1;
+                continue;
+            }
+            int cx = std::min(static_cast<int>((m_positionX[agent] - m_gridOrigin.x) / m_cellSize), m_gridWidth - 1);
+            int cz = std::min(static_cast<int>((m_positionZ[agent] - m_gridOrigin.y) / m_cellSize), m_gridHeight - 1);
+            int cell = cz * m_gridWidth + cx;
+            m_agentCell[agent] = cell;
+            ++m_cellStart[cell + 1];
+        }
+        for (size_t cell = 0; cell < cellCount; ++cell) {
+            m_cellStart[cell + 1] += m_cellStart[cell];
+        }
+        m_cellAgents.resize(m_agentCount);
+        std::vector<uint32_t> cursor(m_cellStart.begin(), m_cellStart.end() - 1);
+        for (size_t agent = 0; agent < m_active.size(); ++agent) {
+            if (m_agentCell[agent] >= 0) {
+                m_cellAgents[cursor[m_agentCell[agent]]++] = static_cast<int>(agent);
+            }
+        }
+    }
+
+    int CrowdAvoidance::gatherNeighbors(int agent, Neighbor* neighbors) const {
+        const float rangeSq = m_settings.neighborRadius * m_settings.neighborRadius;
+        const int maxNeighbors = m_settings.maxNeighbors;
+        float px = m_positionX[agent];
+        float pz = m_positionZ[agent];
+        int cell = m_agentCell[agent];
+        int cx = cell % m_gridWidth;
+        int cz = cell / m_gridWidth;
+
+        // Keep the closest maxNeighbors, sorted by distance
+        int count = 0;
+        float limitSq = rangeSq;
+        for (int z = std::max(cz - 1, 0); z <= std::min(cz + 1, m_gridHeight - 1); ++z) {
+            for (int x = std::max(cx - 1, 0); x <= std::min(cx + 1, m_gridWidth - 1); ++x) {
+                int scan = z * m_gridWidth + x;
+                for (uint32_t i = m_cellStart[scan]; i < m_cellStart[scan + 1]; ++i) {
+                    int other = m_cellAgents[i];
+                    if (other == agent) continue;
+                    float dx = m_positionX[other] - px;
+                    float dz = m_positionZ[other] - pz;
+                    float distanceSq = dx * dx + dz * dz;
+                    if (distanceSq >= limitSq) continue;
+
+                    int slot = count < maxNeighbors ? count++ : maxNeighbors - 1;
+                    while (slot > 0 && (neighbors[slot - 1].distanceSq > distanceSq ||
+                                        (neighbors[slot - 1].distanceSq == distanceSq && neighbors[slot - 1].agent > other))) {
+                        neighbors[slot] = neighbors[slot - 1];
+                        --slot;
+                    }
+                    neighbors[slot].distanceSq = distanceSq;
+                    neighbors[slot].agent = other;
+                    if (count == maxNeighbors) {
+                        limitSq = neighbors[maxNeighbors - 1].distanceSq;
+                    }
+                }
+            }
+        }
+        return count;
+    }
+
+    void CrowdAvoidance::findNeighbors(CrowdAgentId agent, std::vector<CrowdAgentId>& neighbors) const {
+        neighbors.clear();
+        if (agent < 0 || agent >= static_cast<int>(m_agentCell.size()) || m_agentCell[agent] < 0) return;
+        Neighbor found[kMaxNeighbors];
+        int count = gatherNeighbors(agent, found);
+        for (int i = 0; i < count; ++i) {
+            neighbors.push_back(found[i].agent);
+        }
+    }
+
+    void CrowdAvoidance::solveAgent(int agent, float deltaTime, std::vector<Line>& lines, size_t& pairs, int& fallbacks) {
+        Neighbor neighbors[kMaxNeighbors];
+        int count = gatherNeighbors(agent, neighbors);
+        pairs += static_cast<size_t>(count);
+
+        const float invTimeHorizon = 1.0f / m_settings.timeHorizon;
+        const float invTimeStep = 1.0f / deltaTime;
+        glm::vec2 position(m_positionX[agent], m_positionZ[agent]);
+        glm::vec2 velocity(m_velocityX[agent], m_velocityZ[agent]);
+        float radius = m_radius[agent];
+
+        // One half-plane of permitted velocities per neighbour
+        lines.clear();
+        for (int i = 0; i < count; ++i) {
+            int other = neighbors[i].agent;
+            glm::vec2 relativePosition = glm::vec2(m_positionX[other], m_positionZ[other]) - position;
+            glm::vec2 relativeVelocity = velocity - glm::vec2(m_velocityX[other], m_velocityZ[other]);
+            float distanceSq = glm::dot(relativePosition, relativePosition);
+            float combinedRadius = radius + m_radius[other];
+            float combinedRadiusSq = combinedRadius * combinedRadius;
+
+            Line line;
+            glm::vec2 u;
+            if (distanceSq > combinedRadiusSq) {
+                // No collision yet: velocity obstacle is a truncated cone
+                glm::vec2 w = relativeVelocity - invTimeHorizon * relativePosition;
+                float wLengthSq = glm::dot(w, w);
+                float dotProduct = glm::dot(w, relativePosition);
+                if (dotProduct < 0.0f && dotProduct * dotProduct > combinedRadiusSq * wLengthSq) {
+                    // Closest to the cut-off circle
+                    float wLength = std::sqrt(wLengthSq);
+                    glm::vec2 unitW = w / wLength;
+                    line.direction = glm::vec2(unitW.y, -unitW.x);
+                    u = (combinedRadius * invTimeHorizon - wLength) * unitW;
+                } else {
+                    // Closest to one of the legs
+                    float leg = std::sqrt(distanceSq - combinedRadiusSq);
+                    if (det(relativePosition, w) > 0.0f) {
+                        line.direction = glm::vec2(relativePosition.x * leg - relativePosition.y * combinedRadius,
+                                                   relativePosition.x * combinedRadius + relativePosition.y * leg) / distanceSq;
+                    } else {
+                        line.direction = -glm::vec2(relativePosition.x * leg + relativePosition.y * combinedRadius,
+                                                    -relativePosition.x * combinedRadius + relativePosition.y * leg) / distanceSq;
+                    }
+                    u = glm::dot(relativeVelocity, line.direction) * line.direction - relativeVelocity;
+                }
+            } else {
+                // Already overlapping: separate within this step
+                glm::vec2 w = relativeVelocity - invTimeStep * relativePosition;
+                float wLength = glm::length(w);
+                glm::vec2 unitW = wLength > kEpsilon ? w / wLength : glm::vec2(1.0f, 0.0f);
+                line.direction = glm::vec2(unitW.y, -unitW.x);
+                u = (combinedRadius * invTimeStep - wLength) * unitW;
+            }
+            // Each agent takes half of the responsibility
+            line.point = velocity + 0.5f * u;
+            lines.push_back(line);
+        }
+
+        // A slight, fixed turn per agent breaks the symmetric standoffs that
+        // exactly opposed agents otherwise settle into
+        float turn = (static_cast<float>((static_cast<uint32_t>(agent) * 2654435761u) >> 24) / 255.0f - 0.5f) * kSymmetryTurn;
+        glm::vec2 preferred(m_preferredX[agent], m_preferredZ[agent]);
+        preferred = glm::vec2(preferred.x * std::cos(turn) - preferred.y * std::sin(turn),
+                              preferred.x * std::sin(turn) + preferred.y * std::cos(turn));
+        glm::vec2 result;
+        float maxSpeed = m_maxSpeed[agent];
+        size_t failedLine = linearProgram2(lines, maxSpeed, preferred, false, result);
+        if (failedLine < lines.size()) {
+            linearProgram3(lines, failedLine, maxSpeed, result);
+            ++fallbacks;
+        }
+        m_resultX[agent] = result.x;
+        m_resultZ[agent] = result.y;
+    }
+
+    bool CrowdAvoidance::linearProgram1(const std::vector<Line>& lines, size_t lineNo, float radius,
+                                        const glm::vec2& optVelocity, bool directionOpt, glm::vec2& result) {
+        const Line& line = lines[lineNo];
+        float dotProduct = glm::dot(line.point, line.direction);
+        float discriminant = dotProduct * dotProduct + radius * radius - glm::dot(line.point, line.point);
+        if (discriminant < 0.0f) {
+            // The speed disc misses this line entirely
+            return false;
+        }
+
+        float sqrtDiscriminant = std::sqrt(discriminant);
+        float tLeft = -dotProduct - sqrtDiscriminant;
+        float tRight = -dotProduct + sqrtDiscriminant;
+        for (size_t i = 0; i < lineNo; ++i) {
+            float denominator = det(line.direction, lines[i].direction);
+            float numerator = det(lines[i].direction, line.point - lines[i].point);
+            if (std::fabs(denominator) <= kEpsilon) {
+                // Parallel lines
+                if (numerator < 0.0f) return false;
+                continue;
+            }
+            float t = numerator / denominator;
+            if (denominator >= 0.0f) {
+                tRight = std::min(tRight, t);
+            } else {
+                tLeft = std::max(tLeft, t);
+            }
+            if (tLeft > tRight) return false;
+        }
+
+        if (directionOpt) {
+            result = line.point + (glm::dot(optVelocity, line.direction) > 0.0f ? tRight : tLeft) * line.direction;
+        } else {
+            float t = glm::dot(line.direction, optVelocity - line.point);
+            result = line.point + std::min(std::max(t, tLeft), tRight) * line.direction;
+        }
+        return true;
+    }
+
+    size_t CrowdAvoidance::linearProgram2(const std::vector<Line>& lines, float radius, const glm::vec2& optVelocity,
+                                          bool directionOpt, glm::vec2& result) {
+        if (directionOpt) {
+            // optVelocity is a unit direction here
+            result = optVelocity * radius;
+        } else if (glm::dot(optVelocity, optVelocity) > radius * radius) {
+            result = glm::normalize(optVelocity) * radius;
+        } else {
+            result = optVelocity;
+        }
+
+        for (size_t i = 0; i < lines.size(); ++i) {
+            if (det(lines[i].direction, lines[i].point - result) > 0.0f) {
+                // Result violates this constraint: best point on its line
+                glm::vec2 previous = result;
+                if (!linearProgram1(lines, i, radius, optVelocity, directionOpt, result)) {
+                    result = previous;
+                    return i;
+                }
+            }
+        }
+        return lines.size();
+    }
+
+    void CrowdAvoidance::linearProgram3(const std::vector<Line>& lines, size_t beginLine, float radius, glm::vec2& result) {
+        // Infeasible: minimise the largest violation instead (a 3D program
+        // solved as a sequence of 2D ones over the line directions)
+        float distance = 0.0f;
+        std::vector<Line> projected;
+        for (size_t i = beginLine; i < lines.size(); ++i) {
+            if (det(lines[i].direction, lines[i].point - result) <= distance) continue;
+
+            projected.clear();
+            for (size_t j = 0; j < i; ++j) {
+                Line line;
+                float determinant = det(lines[i].direction, lines[j].direction);
+                if (std::fabs(determinant) <= kEpsilon) {
+                    if (glm::dot(lines[i].direction, lines[j].direction) > 0.0f) {
+                        // Same direction
+                        continue;
+                    }
+                    line.point = 0.5f * (lines[i].point + lines[j].point);
+                } else {
+                    line.point = lines[i].point +
+                                 (det(lines[j].direction, lines[i].point - lines[j].point) / determinant) * lines[i].direction;
+                }
+                line.direction = glm::normalize(lines[j].direction - lines[i].direction);
+                projected.push_back(line);
+            }
+
+            glm::vec2 previous = result;
+            if (linearProgram2(projected, radius, glm::vec2(-lines[i].direction.y, lines[i].direction.x), true, result) <
+                projected.size()) {
+                // Can only fail through rounding; keep the last result
+                result = previous;
+            }
+            distance = det(lines[i].direction, lines[i].point - result);
+        }
+    }
+}
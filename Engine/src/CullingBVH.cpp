@@ -0,0 +1,610 @@
+#include "../include/CullingBVH.h"
+#include "../include/SimdConfig.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Sparky {
+    namespace {
+        // Unused positions and empty children span +kEmpty to -kEmpty, so every plane puts
+        // them far outside. Finite, since 0 * infinity would make the tests NaN.
+        const float kEmpty = 1e30f;
+        const uint32_t kMaxLeafProxies = 8;
+        const int kSplitBins = 16;
+        const int kMaxSahDepth = 24;        // Deeper nodes split at the median, which bounds the depth
+        const int kMaxStack = 256;
+        const uint32_t kMinRebuildCount = 64;
+        const double kMaxRefitGrowth = 2.0;
+        const uint32_t kAllPlanes = (1u << Frustum::PLANE_COUNT) - 1;
+
+        float surfaceArea(const glm::vec3& minBounds, const glm::vec3& maxBounds) {
+            glm::vec3 extent = maxBounds - minBounds;
+            if (extent.x < 0.0f || extent.y < 0.0f || extent.z < 0.0f) return 0.0f;
+            return extent.x * extent.y + extent.y * extent.z + extent.z * extent.x;
+        }
+
+        // Tests four boxes against the planes in planeMask. Returns a bit for each box not
+        // entirely outside any of them, and clears from inside[i] the planes box i is entirely
+        // inside. The sums run in the same order as Frustum::intersectsBox() so both agree exactly.
+        uint32_t testBoxes(const float* minX, const float* minY, const float* minZ, const float* maxX,
+                           const float* maxY, const float* maxZ, const Frustum& frustum, uint32_t planeMask,
+                           uint32_t* inside) {
+            uint32_t hit = 0xF;
+#ifdef SPARKY_SSE
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 lowX = _mm_loadu_ps(minX);
+            const __m128 lowY = _mm_loadu_ps(minY);
+            const __m128 lowZ = _mm_loadu_ps(minZ);
+            const __m128 highX = _mm_loadu_ps(maxX);
+            const __m128 highY = _mm_loadu_ps(maxY);
+            const __m128 highZ = _mm_loadu_ps(maxZ);
+            for (int plane = 0; plane < Frustum::PLANE_COUNT; ++plane) {
+                if (!(planeMask & (1u << plane))) continue;
+                const glm::vec4& p = frustum.planes[plane];
+                const __m128 nx = _mm_set1_ps(p.x);
+                const __m128 ny = _mm_set1_ps(p.y);
+                const __m128 nz = _mm_set1_ps(p.z);
+                const __m128 d = _mm_set1_ps(p.w);
+
+                // The corner furthest along the normal decides outside, the nearest inside
+                __m128 farthest = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, p.x >= 0.0f ? highX : lowX),
+                                                              _mm_mul_ps(ny, p.y >= 0.0f ? highY : lowY)),
+                                                   _mm_mul_ps(nz, p.z >= 0.0f ? highZ : lowZ)), d);
+                hit &= static_cast<uint32_t>(_mm_movemask_ps(_mm_cmpge_ps(farthest, zero)));
+                if (!hit) return 0;
+                if (!inside) continue;
+
+                __m128 nearest = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, p.x >= 0.0f ? lowX : highX),
+                                                               _mm_mul_ps(ny, p.y >= 0.0f ? lowY : highY)),
+                                                    _mm_mul_ps(nz, p.z >= 0.0f ? lowZ : highZ)), d);
+                uint32_t within = static_cast<uint32_t>(_mm_movemask_ps(_mm_cmpge_ps(nearest, zero)));
+                for (int lane = 0; lane < 4; ++lane) {
+                    if (within & (1u << lane)) inside[lane] &= ~(1u << plane);
+                }
+            }
+#else
+            for (int plane = 0; plane < Frustum::PLANE_COUNT; ++plane) {
+                if (!(planeMask & (1u << plane))) continue;
+                const glm::vec4& p = frustum.planes[plane];
+                for (int lane = 0; lane < 4; ++lane) {
+                    if (!(hit & (1u << lane))) continue;
+                    float farthest = p.x * (p.x >= 0.0f ? maxX[lane] : minX[lane]) + p.y * (p.y >= 0.0f ? maxY[lane] : minY[lane]) +
+                                p.z * (p.z >= 0.0f ? maxZ[lane] : minZ[lane]) + p.w;
+                    if (farthest < 0.0f) {
+                        hit &= ~(1u << lane);
+                        continue;
+                    }
+                    float nearest = p.x * (p.x >= 0.0f ? minX[lane] : maxX[lane]) + p.y * (p.y >= 0.0f ? minY[lane] : maxY[lane]) +
+                                 p.z * (p.z >= 0.0f ? minZ[lane] : maxZ[lane]) + p.w;
+                    if (inside && nearest >= 0.0f) inside[lane] &= ~(1u << plane);
+                }
+                if (!hit) return 0;
+            }
+#endif
+            return hit;
+        }
+
+#ifdef SPARKY_SSE
+        float horizontalMin(__m128 v) {
+            v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+            v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+            return _mm_cvtss_f32(v);
+        }
+
+        float horizontalMax(__m128 v) {
+            v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+            v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+            return _mm_cvtss_f32(v);
+        }
+#endif
+    }
+
+    Frustum Frustum::fromMatrix(const glm::mat4& viewProjection) {
+        // Gribb and Hartmann: each plane is the last row of the matrix plus or minus another
+        const glm::mat4& m = viewProjection;
+        glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+        glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+        glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+        glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+        Frustum frustum;
+        frustum.planes[LEFT] = row3 + row0;
+        frustum.planes[RIGHT] = row3 - row0;
+        frustum.planes[BOTTOM] = row3 + row1;
+        frustum.planes[TOP] = row3 - row1;
+#ifdef GLM_FORCE_DEPTH_ZERO_TO_ONE
+        frustum.planes[NEAR_PLANE] = row2;
+#else
+        // Also holds for zero to one depth, only a little behind the true near plane
+        frustum.planes[NEAR_PLANE] = row3 + row2;
+#endif
+        frustum.planes[FAR_PLANE] = row3 - row2;
+        for (glm::vec4& plane : frustum.planes) {
+            float length = glm::length(glm::vec3(plane));
+            if (length > 0.0f) plane /= length;
+        }
+        return frustum;
+    }
+
+    bool Frustum::intersectsBox(const glm::vec3& minBounds, const glm::vec3& maxBounds) const {
+        for (const glm::vec4& p : planes) {
+            float farthest = p.x * (p.x >= 0.0f ? maxBounds.x : minBounds.x) + p.y * (p.y >= 0.0f ? maxBounds.y : minBounds.y) +
+                        p.z * (p.z >= 0.0f ? maxBounds.z : minBounds.z) + p.w;
+            if (farthest < 0.0f) return false;
+        }
+        return true;
+    }
+
+    void transformBounds(const glm::vec3& localMin, const glm::vec3& localMax, const glm::mat4& transform,
+                         glm::vec3& worldMin, glm::vec3& worldMax) {
+        // Arvo: the centre moves with the transform, the half extent with its absolute values
+        glm::vec3 center = (localMin + localMax) * 0.5f;
+        glm::vec3 extent = (localMax - localMin) * 0.5f;
+        glm::vec3 worldCenter = glm::vec3(transform * glm::vec4(center, 1.0f));
+        glm::vec3 worldExtent;
+        for (int axis = 0; axis < 3; ++axis) {
+            worldExtent[axis] = std::fabs(transform[0][axis]) * extent.x + std::fabs(transform[1][axis]) * extent.y +
+                                std::fabs(transform[2][axis]) * extent.z;
+        }
+        worldMin = worldCenter - worldExtent;
+        worldMax = worldCenter + worldExtent;
+    }
+
+    CullingBVH::CullingBVH()
+        : m_treeCount(0), m_positionCount(0), m_proxyCount(0), m_anyDirty(false), m_treeRemoved(0),
+          m_surfaceArea(0.0), m_builtSurfaceArea(0.0), m_rebuilds(0), m_refits(0) {
+    }
+
+    int CullingBVH::addProxy(const glm::vec3& minBounds, const glm::vec3& maxBounds, GameObject* object) {
+        int proxy;
+        if (!m_freeSlots.empty()) {
+            proxy = m_freeSlots.back();
+            m_freeSlots.pop_back();
+        } else {
+            proxy = static_cast<int>(m_proxyPosition.size());
+            m_proxyPosition.push_back(-1);
+            m_proxyObject.push_back(nullptr);
+        }
+
+        if (m_positionCount == m_minX.size()) growPositions();
+        uint32_t position = m_positionCount++;
+        setPosition(position, glm::min(minBounds, maxBounds), glm::max(minBounds, maxBounds), proxy);
+        m_positionNode[position] = -1;
+        m_proxyPosition[proxy] = static_cast<int>(position);
+        m_proxyObject[proxy] = object;
+        ++m_proxyCount;
+        return proxy;
+    }
+
+    void CullingBVH::moveProxy(int proxy, const glm::vec3& minBounds, const glm::vec3& maxBounds) {
+        if (proxy < 0 || proxy >= static_cast<int>(m_proxyPosition.size()) || m_proxyPosition[proxy] < 0) return;
+        uint32_t position = static_cast<uint32_t>(m_proxyPosition[proxy]);
+        setPosition(position, glm::min(minBounds, maxBounds), glm::max(minBounds, maxBounds), proxy);
+        if (position < m_treeCount) markDirty(m_positionNode[position]);
+    }
+
+    void CullingBVH::removeProxy(int proxy) {
+        if (proxy < 0 || proxy >= static_cast<int>(m_proxyPosition.size()) || m_proxyPosition[proxy] < 0) return;
+        uint32_t position = static_cast<uint32_t>(m_proxyPosition[proxy]);
+        if (position < m_treeCount) {
+            // The slot stays in its leaf, empty, until the next build
+            clearPosition(position);
+            markDirty(m_positionNode[position]);
+            ++m_treeRemoved;
+        } else {
+            // Keep the pending proxies packed
+            uint32_t last = m_positionCount - 1;
+            if (position != last) {
+                setPosition(position, glm::vec3(m_minX[last], m_minY[last], m_minZ[last]),
+                            glm::vec3(m_maxX[last], m_maxY[last], m_maxZ[last]), m_positionProxy[last]);
+                m_proxyPosition[m_positionProxy[position]] = static_cast<int>(position);
+            }
+            clearPosition(last);
+            --m_positionCount;
+        }
+        m_proxyPosition[proxy] = -1;
+        m_proxyObject[proxy] = nullptr;
+        m_freeSlots.push_back(proxy);
+        --m_proxyCount;
+    }
+
+    void CullingBVH::clear() {
+        m_minX.clear();
+        m_minY.clear();
+        m_minZ.clear();
+        m_maxX.clear();
+        m_maxY.clear();
+        m_maxZ.clear();
+        m_positionProxy.clear();
+        m_positionNode.clear();
+        m_treeCount = 0;
+        m_positionCount = 0;
+        m_proxyPosition.clear();
+        m_proxyObject.clear();
+        m_freeSlots.clear();
+        m_proxyCount = 0;
+        m_nodes.clear();
+        m_nodeParent.clear();
+        m_nodeDirty.clear();
+        m_anyDirty = false;
+        m_treeRemoved = 0;
+        m_surfaceArea = 0.0;
+        m_builtSurfaceArea = 0.0;
+    }
+
+    void CullingBVH::getProxyBounds(int proxy, glm::vec3& minBounds, glm::vec3& maxBounds) const {
+        uint32_t position = static_cast<uint32_t>(m_proxyPosition[proxy]);
+        minBounds = glm::vec3(m_minX[position], m_minY[position], m_minZ[position]);
+        maxBounds = glm::vec3(m_maxX[position], m_maxY[position], m_maxZ[position]);
+    }
+
+    void CullingBVH::setPosition(uint32_t position, const glm::vec3& minBounds, const glm::vec3& maxBounds, int proxy) {
+        m_minX[position] = minBounds.x;
+        m_minY[position] = minBounds.y;
+        m_minZ[position] = minBounds.z;
+        m_maxX[position] = maxBounds.x;
+        m_maxY[position] = maxBounds.y;
+        m_maxZ[position] = maxBounds.z;
+        m_positionProxy[position] = proxy;
+    }
+
+    void CullingBVH::clearPosition(uint32_t position) {
+        setPosition(position, glm::vec3(kEmpty), glm::vec3(-kEmpty), -1);
+    }
+
+    void CullingBVH::growPositions() {
+        // Always by four, so every group of four positions can be loaded whole
+        for (int i = 0; i < 4; ++i) {
+            m_minX.push_back(kEmpty);
+            m_minY.push_back(kEmpty);
+            m_minZ.push_back(kEmpty);
+            m_maxX.push_back(-kEmpty);
+            m_maxY.push_back(-kEmpty);
+            m_maxZ.push_back(-kEmpty);
+            m_positionProxy.push_back(-1);
+            m_positionNode.push_back(-1);
+        }
+    }
+
+    void CullingBVH::markDirty(int node) {
+        while (node >= 0 && !m_nodeDirty[node]) {
+            m_nodeDirty[node] = 1;
+            node = m_nodeParent[node];
+        }
+        m_anyDirty = true;
+    }
+
+    void CullingBVH::update() {
+        const uint32_t pending = m_positionCount - m_treeCount;
+        const uint32_t inTree = static_cast<uint32_t>(m_proxyCount) - pending;
+        if (pending > std::max(kMinRebuildCount, inTree / 8) ||
+            static_cast<uint32_t>(m_treeRemoved) > std::max(kMinRebuildCount, inTree / 4)) {
+            build();
+            return;
+        }
+
+        if (m_anyDirty) {
+            refit();
+            // Objects that scattered since the build leave nodes overlapping heavily
+            if (m_builtSurfaceArea > 0.0 && m_surfaceArea > m_builtSurfaceArea * kMaxRefitGrowth) {
+                build();
+            }
+        }
+    }
+
+    void CullingBVH::refit() {
+        // Children come after their parents, so one backwards pass refits bottom up
+        for (int node = static_cast<int>(m_nodes.size()) - 1; node >= 0; --node) {
+            if (!m_nodeDirty[node]) continue;
+            refitNode(node);
+            m_nodeDirty[node] = 0;
+        }
+        m_anyDirty = false;
+        ++m_refits;
+    }
+
+    void CullingBVH::refitNode(int nodeIndex) {
+        Node& node = m_nodes[nodeIndex];
+        for (int lane = 0; lane < 4; ++lane) {
+            if (node.count[lane] == 0) continue;
+            glm::vec3 minBounds(kEmpty), maxBounds(-kEmpty);
+            if (node.child[lane] >= 0) {
+                const Node& child = m_nodes[node.child[lane]];
+                for (int i = 0; i < 4; ++i) {
+                    minBounds = glm::min(minBounds, glm::vec3(child.minX[i], child.minY[i], child.minZ[i]));
+                    maxBounds = glm::max(maxBounds, glm::vec3(child.maxX[i], child.maxY[i], child.maxZ[i]));
+                }
+            } else {
+                rangeBounds(node.first[lane], node.count[lane], minBounds, maxBounds);
+            }
+
+            m_surfaceArea -= surfaceArea(glm::vec3(node.minX[lane], node.minY[lane], node.minZ[lane]),
+                                         glm::vec3(node.maxX[lane], node.maxY[lane], node.maxZ[lane]));
+            m_surfaceArea += surfaceArea(minBounds, maxBounds);
+            node.minX[lane] = minBounds.x;
+            node.minY[lane] = minBounds.y;
+            node.minZ[lane] = minBounds.z;
+            node.maxX[lane] = maxBounds.x;
+            node.maxY[lane] = maxBounds.y;
+            node.maxZ[lane] = maxBounds.z;
+        }
+    }
+
+    void CullingBVH::rangeBounds(uint32_t first, uint32_t count, glm::vec3& minBounds, glm::vec3& maxBounds) const {
+        // Leaf ranges are whole groups of four, and unused positions never widen the result
+#ifdef SPARKY_SSE
+        __m128 lowX = _mm_set1_ps(kEmpty), lowY = lowX, lowZ = lowX;
+        __m128 highX = _mm_set1_ps(-kEmpty), highY = highX, highZ = highX;
+        for (uint32_t position = first; position < first + count; position += 4) {
+            lowX = _mm_min_ps(lowX, _mm_loadu_ps(&m_minX[position]));
+            lowY = _mm_min_ps(lowY, _mm_loadu_ps(&m_minY[position]));
+            lowZ = _mm_min_ps(lowZ, _mm_loadu_ps(&m_minZ[position]));
+            highX = _mm_max_ps(highX, _mm_loadu_ps(&m_maxX[position]));
+            highY = _mm_max_ps(highY, _mm_loadu_ps(&m_maxY[position]));
+            highZ = _mm_max_ps(highZ, _mm_loadu_ps(&m_maxZ[position]));
+        }
+        minBounds = glm::vec3(horizontalMin(lowX), horizontalMin(lowY), horizontalMin(lowZ));
+        maxBounds = glm::vec3(horizontalMax(highX), horizontalMax(highY), horizontalMax(highZ));
+#else
+        minBounds = glm::vec3(kEmpty);
+        maxBounds = glm::vec3(-kEmpty);
+        for (uint32_t position = first; position < first + count; ++position) {
+            minBounds = glm::min(minBounds, glm::vec3(m_minX[position], m_minY[position], m_minZ[position]));
+            maxBounds = glm::max(maxBounds, glm::vec3(m_maxX[position], m_maxY[position], m_maxZ[position]));
+        }
+#endif
+    }
+
+    void CullingBVH::build() {
+        std::vector<BuildItem> items;
+        items.reserve(m_proxyCount);
+        for (uint32_t position = 0; position < m_positionCount; ++position) {
+            if (m_positionProxy[position] < 0) continue;
+            BuildItem item;
+            item.minBounds = glm::vec3(m_minX[position], m_minY[position], m_minZ[position]);
+            item.maxBounds = glm::vec3(m_maxX[position], m_maxY[position], m_maxZ[position]);
+            item.centroid = (item.minBounds + item.maxBounds) * 0.5f;
+            item.proxy = m_positionProxy[position];
+            items.push_back(item);
+        }
+
+        m_minX.clear();
+        m_minY.clear();
+        m_minZ.clear();
+        m_maxX.clear();
+        m_maxY.clear();
+        m_maxZ.clear();
+        m_positionProxy.clear();
+        m_positionNode.clear();
+        m_positionCount = 0;
+        m_nodes.clear();
+        m_nodeParent.clear();
+        m_nodeDirty.clear();
+        m_anyDirty = false;
+        m_treeRemoved = 0;
+        m_surfaceArea = 0.0;
+
+        if (!items.empty()) {
+            // Four-wide nodes over leaves of at least a few proxies: well under one node per two
+            m_nodes.reserve(items.size() / 2 + 1);
+            buildNode(items, 0, static_cast<uint32_t>(items.size()), -1, 0);
+        }
+        m_treeCount = m_positionCount;
+        m_builtSurfaceArea = m_surfaceArea;
+        ++m_rebuilds;
+    }
+
+    int CullingBVH::buildNode(std::vector<BuildItem>& items, uint32_t begin, uint32_t end, int parent, int depth) {
+        const int nodeIndex = static_cast<int>(m_nodes.size());
+        Node empty;
+        for (int lane = 0; lane < 4; ++lane) {
+            empty.minX[lane] = empty.minY[lane] = empty.minZ[lane] = kEmpty;
+            empty.maxX[lane] = empty.maxY[lane] = empty.maxZ[lane] = -kEmpty;
+            empty.child[lane] = -1;
+            empty.first[lane] = 0;
+            empty.count[lane] = 0;
+        }
+        m_nodes.push_back(empty);
+        m_nodeParent.push_back(parent);
+        m_nodeDirty.push_back(0);
+
+        // Split into up to four groups, each time splitting the largest that is too big for a leaf
+        uint32_t bounds[5] = {begin, end};
+        int groups = 1;
+        while (groups < 4) {
+            int largest = -1;
+            uint32_t largestCount = kMaxLeafProxies;
+            for (int group = 0; group < groups; ++group) {
+                if (bounds[group + 1] - bounds[group] > largestCount) {
+                    largest = group;
+                    largestCount = bounds[group + 1] - bounds[group];
+                }
+            }
+            if (largest < 0) break;
+
+            uint32_t middle = splitItems(items, bounds[largest], bounds[largest + 1], depth);
+            for (int i = groups; i > largest; --i) {
+                bounds[i + 1] = bounds[i];
+            }
+            bounds[largest + 1] = middle;
+            ++groups;
+        }
+
+        for (int lane = 0; lane < groups; ++lane) {
+            const uint32_t groupBegin = bounds[lane];
+            const uint32_t groupEnd = bounds[lane + 1];
+            const uint32_t first = m_positionCount;
+            int child = -1;
+            if (groupEnd - groupBegin <= kMaxLeafProxies) {
+                for (uint32_t i = groupBegin; i < groupEnd; ++i) {
+                    if (m_positionCount == m_minX.size()) growPositions();
+                    setPosition(m_positionCount, items[i].minBounds, items[i].maxBounds, items[i].proxy);
+                    m_positionNode[m_positionCount] = nodeIndex;
+                    m_proxyPosition[items[i].proxy] = static_cast<int>(m_positionCount);
+                    ++m_positionCount;
+                }
+                // Pad the leaf to whole groups of four with unused positions
+                while (m_positionCount % 4 != 0) {
+                    m_positionNode[m_positionCount++] = nodeIndex;
+                }
+            } else {
+                child = buildNode(items, groupBegin, groupEnd, nodeIndex, depth + 1);
+            }
+
+            glm::vec3 minBounds(kEmpty), maxBounds(-kEmpty);
+            for (uint32_t i = groupBegin; i < groupEnd; ++i) {
+                minBounds = glm::min(minBounds, items[i].minBounds);
+                maxBounds = glm::max(maxBounds, items[i].maxBounds);
+            }
+            Node& node = m_nodes[nodeIndex];
+            node.minX[lane] = minBounds.x;
+            node.minY[lane] = minBounds.y;
+            node.minZ[lane] = minBounds.z;
+            node.maxX[lane] = maxBounds.x;
+            node.maxY[lane] = maxBounds.y;
+            node.maxZ[lane] = maxBounds.z;
+            node.child[lane] = child;
+            node.first[lane] = first;
+            node.count[lane] = m_positionCount - first;
+            m_surfaceArea += surfaceArea(minBounds, maxBounds);
+        }
+        return nodeIndex;
+    }
+
+    uint32_t CullingBVH::splitItems(std::vector<BuildItem>& items, uint32_t begin, uint32_t end, int depth) const {
+        glm::vec3 centroidMin(kEmpty), centroidMax(-kEmpty);
+        for (uint32_t i = begin; i < end; ++i) {
+            centroidMin = glm::min(centroidMin, items[i].centroid);
+            centroidMax = glm::max(centroidMax, items[i].centroid);
+        }
+        glm::vec3 extent = centroidMax - centroidMin;
+        const int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+
+        if (depth < kMaxSahDepth && extent[axis] > 0.0f) {
+            // Binned SAH along the widest axis. The range is too big for a leaf, so it is split
+            // at the cheapest plane even when keeping it whole would cost less.
+            const float scale = kSplitBins / extent[axis];
+            const float origin = centroidMin[axis];
+            auto binOf = [&](const BuildItem& item) {
+                return std::min(kSplitBins - 1, static_cast<int>((item.centroid[axis] - origin) * scale));
+            };
+
+            uint32_t binCount[kSplitBins] = {};
+            glm::vec3 binMin[kSplitBins], binMax[kSplitBins];
+            std::fill(binMin, binMin + kSplitBins, glm::vec3(kEmpty));
+            std::fill(binMax, binMax + kSplitBins, glm::vec3(-kEmpty));
+            for (uint32_t i = begin; i < end; ++i) {
+                int bin = binOf(items[i]);
+                ++binCount[bin];
+                binMin[bin] = glm::min(binMin[bin], items[i].minBounds);
+                binMax[bin] = glm::max(binMax[bin], items[i].maxBounds);
+            }
+
+            float leftCost[kSplitBins - 1];
+            glm::vec3 sweepMin(kEmpty), sweepMax(-kEmpty);
+            uint32_t sweepCount = 0;
+            for (int plane = 0; plane < kSplitBins - 1; ++plane) {
+                sweepCount += binCount[plane];
+                sweepMin = glm::min(sweepMin, binMin[plane]);
+                sweepMax = glm::max(sweepMax, binMax[plane]);
+                leftCost[plane] = sweepCount ? surfaceArea(sweepMin, sweepMax) * sweepCount : 0.0f;
+            }
+
+            const uint32_t count = end - begin;
+            float bestCost = 0.0f;
+            int bestPlane = -1;
+            sweepMin = glm::vec3(kEmpty);
+            sweepMax = glm::vec3(-kEmpty);
+            sweepCount = 0;
+            for (int plane = kSplitBins - 2; plane >= 0; --plane) {
+                sweepCount += binCount[plane + 1];
+                sweepMin = glm::min(sweepMin, binMin[plane + 1]);
+                sweepMax = glm::max(sweepMax, binMax[plane + 1]);
+                if (sweepCount == 0 || sweepCount == count) continue;
+                float cost = leftCost[plane] + surfaceArea(sweepMin, sweepMax) * sweepCount;
+                if (bestPlane < 0 || cost < bestCost) {
+                    bestCost = cost;
+                    bestPlane = plane;
+                }
+            }
+
+            if (bestPlane >= 0) {
+                auto middle = std::partition(items.begin() + begin, items.begin() + end,
+                                             [&](const BuildItem& item) { return binOf(item) <= bestPlane; });
+                return static_cast<uint32_t>(middle - items.begin());
+            }
+        }
+
+        // Median split, also for ranges whose centroids all coincide
+        const uint32_t middle = begin + (end - begin) / 2;
+        std::nth_element(items.begin() + begin, items.begin() + middle, items.begin() + end,
+                         [axis](const BuildItem& a, const BuildItem& b) { return a.centroid[axis] < b.centroid[axis]; });
+        return middle;
+    }
+
+    void CullingBVH::cull(const Frustum& frustum, std::vector<int>& visible, CullingStats* stats) const {
+        visible.clear();
+        CullingStats counts;
+
+        if (!m_nodes.empty()) {
+            // Nodes are at most a few dozen levels deep, and each level pushes at most three siblings
+            struct StackEntry {
+                int node;
+                uint32_t planeMask;
+            };
+            StackEntry stack[kMaxStack];
+            int top = 0;
+            stack[top++] = {0, kAllPlanes};
+
+            while (top > 0) {
+                const StackEntry entry = stack[--top];
+                const Node& node = m_nodes[entry.node];
+                uint32_t inside[4] = {entry.planeMask, entry.planeMask, entry.planeMask, entry.planeMask};
+                uint32_t hit = 0xF;
+                if (entry.planeMask) {
+                    hit = testBoxes(node.minX, node.minY, node.minZ, node.maxX, node.maxY, node.maxZ, frustum,
+                                    entry.planeMask, inside);
+                }
+                ++counts.nodesTested;
+
+                for (int lane = 0; lane < 4; ++lane) {
+                    if (!(hit & (1u << lane)) || node.count[lane] == 0) continue;
+                    if (inside[lane] == 0) {
+                        // Entirely inside: take every proxy below without testing
+                        for (uint32_t position = node.first[lane]; position < node.first[lane] + node.count[lane]; ++position) {
+                            if (m_positionProxy[position] >= 0) visible.push_back(m_positionProxy[position]);
+                        }
+                        ++counts.subtreesAccepted;
+                    } else if (node.child[lane] >= 0) {
+                        stack[top++] = {node.child[lane], inside[lane]};
+                    } else {
+                        cullRange(frustum, node.first[lane], node.count[lane], inside[lane], visible, counts);
+                    }
+                }
+            }
+        }
+
+        // Proxies added since the build, four at a time; the positions past the last are unused
+        const uint32_t pending = m_positionCount - m_treeCount;
+        cullRange(frustum, m_treeCount, (pending + 3) & ~3u, kAllPlanes, visible, counts);
+
+        if (stats) {
+            *stats = counts;
+            stats->proxies = m_proxyCount;
+            stats->visible = static_cast<int>(visible.size());
+        }
+    }
+
+    void CullingBVH::cullRange(const Frustum& frustum, uint32_t first, uint32_t count, uint32_t planeMask,
+                               std::vector<int>& visible, CullingStats& stats) const {
+        for (uint32_t position = first; position < first + count; position += 4) {
+            uint32_t hit = testBoxes(&m_minX[position], &m_minY[position], &m_minZ[position], &m_maxX[position],
+                                     &m_maxY[position], &m_maxZ[position], frustum, planeMask, nullptr);
+            stats.boxesTested += 4;
+            for (int lane = 0; lane < 4; ++lane) {
+                if ((hit & (1u << lane)) && m_positionProxy[position + lane] >= 0) {
+                    visible.push_back(m_positionProxy[position + lane]);
+                }
+            }
+        }
+    }
+}
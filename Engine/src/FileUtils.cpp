@@ -6,6 +6,7 @@
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <filesystem>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -63,11 +64,6 @@ namespace Sparky {
         file.read(buffer.data(), fileSize);
         file.close();
 
-        // Log first part of file content for debugging
-        size_t previewSize = fileSize < 200 ? fileSize : 200;
-        std::string content(buffer.data(), previewSize);
-        SPARKY_LOG_DEBUG("File content preview: " + content);
-        
         SPARKY_LOG_DEBUG("File read successfully, size: " + std::to_string(fileSize) + " bytes");
         return buffer;
     }
@@ -101,6 +97,45 @@ namespace Sparky {
         return true;
     }
 
+    bool FileUtils::writeFileAtomic(const std::string& filepath, const std::vector<char>& data) {
+        SPARKY_LOG_DEBUG("Writing file atomically: " + filepath);
+
+        // u8path keeps UTF-8 paths intact on Windows
+        std::filesystem::path target = std::filesystem::u8path(filepath);
+        std::filesystem::path temporary = target;
+        temporary += ".tmp";
+
+        {
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) {
+                SPARKY_LOG_ERROR("Failed to open file for writing: " + temporary.u8string());
+                return false;
+            }
+
+            file.write(data.data(), static_cast<std::streamsize>(data.size()));
+            file.flush();
+            if (!file.good()) {
+                file.close();
+                std::error_code removeError;
+                std::filesystem::remove(temporary, removeError);
+                SPARKY_LOG_ERROR("Failed to write file: " + temporary.u8string());
+                return false;
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename(temporary, target, error);
+        if (error) {
+            std::error_code removeError;
+            std::filesystem::remove(temporary, removeError);
+            SPARKY_LOG_ERROR("Failed to replace " + filepath + ": " + error.message());
+            return false;
+        }
+
+        SPARKY_LOG_DEBUG("File written successfully, size: " + std::to_string(data.size()) + " bytes");
+        return true;
+    }
+
     std::string FileUtils::getFileName(const std::string& filepath) {
         size_t lastSlash = filepath.find_last_of("/\\");
         if (lastSlash == std::string::npos) {
@@ -0,0 +1,397 @@
+#include "../include/FlowField.h"
+#include "../include/AdvancedAI.h"
+#include "../include/JobSystem.h"
+#include "../include/Logger.h"
+#include "../include/TimingUtils.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+namespace Sparky {
+    namespace {
+        const float kInfinity = std::numeric_limits<float>::infinity();
+
+        // Border bits in the per-tile wake mask
+        const uint8_t kWakeWest = 1;
+        const uint8_t kWakeEast = 2;
+        const uint8_t kWakeSouth = 4;
+        const uint8_t kWakeNorth = 8;
+        const uint8_t kWakeSelf = 16;
+
+        // First-order upwind (Godunov) update from the smallest neighbour in x
+        // and in z for a cell of travel cost f
+        float eikonalUpdate(float a, float b, float f) {
+            if (a > b) std::swap(a, b);
+            if (a == kInfinity) return kInfinity;
+            if (b - a >= f) return a + f;
+            return 0.5f * (a + b + std::sqrt(2.0f * f * f - (b - a) * (b - a)));
+        }
+
+        bool changed(float before, float after, float tolerance) {
+            return before != after && !(std::fabs(after - before) <= tolerance);
+        }
+    }
+
+    FlowField::FlowField()
+        : FlowField(FlowFieldSettings()) {
+    }
+
+    FlowField::FlowField(const FlowFieldSettings& settings)
+        : m_settings(settings)
+        , m_jobSystem(nullptr)
+        , m_origin(0.0f)
+        , m_width(0)
+        , m_height(0)
+        , m_tilesX(0)
+        , m_tilesZ(0)
+        , m_goalCell(-1)
+        , m_fieldValid(false)
+        , m_stats() {
+        if (m_settings.cellSize <= 0.0f) {
+            SPARKY_LOG_WARNING("FlowField: cell size must be positive, using 1");
+            m_settings.cellSize = 1.0f;
+        }
+        m_settings.tileSize = std::max(m_settings.tileSize, 2);
+        m_settings.tolerance = std::max(m_settings.tolerance, 0.0f);
+    }
+
+    std::unique_ptr<FlowField> FlowField::create(const FlowFieldSettings& settings) {
+        return std::make_unique<FlowField>(settings);
+    }
+
+    void FlowField::resize(const glm::vec3& minBounds, const glm::vec3& maxBounds) {
+        m_origin = glm::vec2(minBounds.x, minBounds.z);
+        m_width = std::max(1, static_cast<int>(std::ceil((maxBounds.x - minBounds.x) / m_settings.cellSize)));
+        m_height = std::max(1, static_cast<int>(std::ceil((maxBounds.z - minBounds.z) / m_settings.cellSize)));
+        m_tilesX = (m_width + m_settings.tileSize - 1) / m_settings.tileSize;
+        m_tilesZ = (m_height + m_settings.tileSize - 1) / m_settings.tileSize;
+
+        size_t cellCount = static_cast<size_t>(m_width) * m_height;
+        m_costs.assign(cellCount, 1);
+        m_distances.assign(cellCount, kInfinity);
+        m_directions.assign(cellCount, glm::vec2(0.0f));
+        m_tileActive.assign(static_cast<size_t>(m_tilesX) * m_tilesZ, 0);
+        m_tileSolved.assign(m_tileActive.size(), 0);
+        m_goalCell = -1;
+        m_fieldValid = false;
+    }
+
+    void FlowField::setCellCost(int x, int z, uint8_t cost) {
+        if (x < 0 || x >= m_width || z < 0 || z >= m_height) return;
+        uint8_t& cell = m_costs[index(x, z)];
+        cost = std::max<uint8_t>(cost, 1);
+        if (cell != cost) {
+            cell = cost;
+            m_fieldValid = false;
+        }
+    }
+
+    void FlowField::rasterize(const NavigationMesh& navMesh, const glm::vec3& minBounds, const glm::vec3& maxBounds) {
+        resize(minBounds, maxBounds);
+        const std::shared_ptr<const NavPolyMesh>& polyMesh = navMesh.getPolyMesh();
+        if (polyMesh) {
+            for (int z = 0; z < m_height; ++z) {
+                for (int x = 0; x < m_width; ++x) {
+                    if (polyMesh->findPoly(cellCenter(x, z), 0.0f) == -1) {
+                        m_costs[index(x, z)] = BLOCKED;
+                    }
+                }
+            }
+            return;
+        }
+
+        std::fill(m_costs.begin(), m_costs.end(), BLOCKED);
+        for (int i = 0; i < navMesh.getNodeCount(); ++i) {
+            const NavNode& node = navMesh.getNode(i);
+            int x, z;
+            if (!node.walkable || !worldToCell(node.position, x, z)) continue;
+            // Cheapest node wins where several share a cell
+            float cost = std::min(std::max(node.cost, 1.0f), 254.0f);
+            uint8_t& cell = m_costs[index(x, z)];
+            cell = std::min(cell, static_cast<uint8_t>(std::lround(cost)));
+        }
+    }
+
+    bool FlowField::worldToCell(const glm::vec3& position, int& x, int& z) const {
+        x = static_cast<int>(std::floor((position.x - m_origin.x) / m_settings.cellSize));
+        z = static_cast<int>(std::floor((position.z - m_origin.y) / m_settings.cellSize));
+        return x >= 0 && x < m_width && z >= 0 && z < m_height;
+    }
+
+    glm::vec3 FlowField::cellCenter(int x, int z) const {
+        return glm::vec3(m_origin.x + (x + 0.5f) * m_settings.cellSize, 0.0f,
+                         m_origin.y + (z + 0.5f) * m_settings.cellSize);
+    }
+
+    int FlowField::tileOf(int cell) const {
+        int x = cell % m_width;
+        int z = cell / m_width;
+        return (z / m_settings.tileSize) * m_tilesX + x / m_settings.tileSize;
+    }
+
+    bool FlowField::setGoal(const glm::vec3& goal) {
+        int x, z;
+        if (!worldToCell(goal, x, z) || m_costs[index(x, z)] == BLOCKED) {
+            return false;
+        }
+        int cell = index(x, z);
+        if (m_fieldValid && cell == m_goalCell) {
+            return true;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        int previousGoal = m_goalCell;
+        bool warmStart = m_settings.incremental && m_fieldValid && previousGoal >= 0 && m_distances[cell] != kInfinity;
+
+        m_activeTiles.clear();
+        if (warmStart) {
+            // T_old + T_old(new goal) bounds the new distances from above almost
+            // everywhere; only the surroundings of both goals are out of balance
+            float offset = m_distances[cell];
+            for (float& distance : m_distances) {
+                distance += offset;
+            }
+            m_activeTiles.push_back(tileOf(previousGoal));
+        } else {
+            std::fill(m_distances.begin(), m_distances.end(), kInfinity);
+            std::fill(m_directions.begin(), m_directions.end(), glm::vec2(0.0f));
+        }
+        m_distances[cell] = 0.0f;
+        m_goalCell = cell;
+        if (m_activeTiles.empty() || m_activeTiles[0] != tileOf(cell)) {
+            m_activeTiles.push_back(tileOf(cell));
+        }
+
+        solve();
+        m_fieldValid = true;
+
+        m_stats.incremental = warmStart;
+        m_stats.computeMs = elapsedMs(start);
+        ++m_stats.recomputes;
+        return true;
+    }
+
+    void FlowField::solve() {
+        const int tileSize = m_settings.tileSize;
+        const size_t bufferSize = static_cast<size_t>(tileSize + 2) * (tileSize + 2);
+
+        std::fill(m_tileSolved.begin(), m_tileSolved.end(), 0);
+        m_solvedTiles.clear();
+        for (int tile : m_activeTiles) {
+            m_tileActive[tile] = 1;
+        }
+        m_stats.rounds = 0;
+        m_stats.tileSolves = 0;
+
+        std::vector<int> nextTiles;
+        while (!m_activeTiles.empty()) {
+            // Snapshot first, then relax: a tile only writes its own cells, and
+            // no tile writes while borders are being read
+            m_tileBuffers.resize(m_activeTiles.size() * bufferSize);
+            m_tileWake.assign(m_activeTiles.size(), 0);
+            forEach(m_activeTiles.size(), &FlowField::gatherTile);
+            forEach(m_activeTiles.size(), &FlowField::relaxTile);
+            ++m_stats.rounds;
+            m_stats.tileSolves += static_cast<int>(m_activeTiles.size());
+
+            for (int tile : m_activeTiles) {
+                m_tileActive[tile] = 0;
+                if (!m_tileSolved[tile]) {
+                    m_tileSolved[tile] = 1;
+                    m_solvedTiles.push_back(tile);
+                }
+            }
+
+            nextTiles.clear();
+            for (size_t slot = 0; slot < m_activeTiles.size(); ++slot) {
+                uint8_t wake = m_tileWake[slot];
+                if (!wake) continue;
+                int tile = m_activeTiles[slot];
+                int tx = tile % m_tilesX;
+                int tz = tile / m_tilesX;
+                int candidates[5] = {
+                    (wake & kWakeWest) && tx > 0 ? tile - 1 : -1,
+                    (wake & kWakeEast) && tx + 1 < m_tilesX ? tile + 1 : -1,
+                    (wake & kWakeSouth) && tz > 0 ? tile - m_tilesX : -1,
+                    (wake & kWakeNorth) && tz + 1 < m_tilesZ ? tile + m_tilesX : -1,
+                    (wake & kWakeSelf) ? tile : -1
+                };
+                for (int neighbor : candidates) {
+                    if (neighbor >= 0 && !m_tileActive[neighbor]) {
+                        m_tileActive[neighbor] = 1;
+                        nextTiles.push_back(neighbor);
+                    }
+                }
+            }
+            m_activeTiles.swap(nextTiles);
+        }
+
+        // A full solve starts from cleared directions, so only reached tiles need
+        // them. A warm start shifted untouched tiles by a constant, which leaves
+        // their directions as they were.
+        forEach(m_solvedTiles.size(), &FlowField::updateDirections);
+    }
+
+    void FlowField::gatherTile(int slot) {
+        const int tileSize = m_settings.tileSize;
+        const int stride = tileSize + 2;
+        int tile = m_activeTiles[slot];
+        int x0 = (tile % m_tilesX) * tileSize - 1;
+        int z0 = (tile / m_tilesX) * tileSize - 1;
+        float* buffer = &m_tileBuffers[static_cast<size_t>(slot) * stride * stride];
+
+        for (int lz = 0; lz < stride; ++lz) {
+            int z = z0 + lz;
+            for (int lx = 0; lx < stride; ++lx) {
+                int x = x0 + lx;
+                bool inside = x >= 0 && x < m_width && z >= 0 && z < m_height;
+                buffer[lz * stride + lx] = inside ? m_distances[index(x, z)] : kInfinity;
+            }
+        }
+    }
+
+    void FlowField::relaxTile(int slot) {
+        const int tileSize = m_settings.tileSize;
+        const int stride = tileSize + 2;
+        const float tolerance = m_settings.tolerance;
+        int tile = m_activeTiles[slot];
+        int x0 = (tile % m_tilesX) * tileSize;
+        int z0 = (tile / m_tilesX) * tileSize;
+        int w = std::min(tileSize, m_width - x0);
+        int h = std::min(tileSize, m_height - z0);
+        float* buffer = &m_tileBuffers[static_cast<size_t>(slot) * stride * stride];
+
+        // Gauss-Seidel sweeps in the four diagonal orders until the tile settles
+        // against its (fixed) border snapshot
+        const int maxSweeps = 4 * tileSize;
+        bool settled = false;
+        for (int sweep = 0; sweep < maxSweeps && !settled; ++sweep) {
+            bool flipX = (sweep & 1) != 0;
+            bool flipZ = (sweep & 2) != 0;
+            float largestChange = 0.0f;
+            for (int iz = 0; iz < h; ++iz) {
+                int lz = flipZ ? h - iz : iz + 1;
+                for (int ix = 0; ix < w; ++ix) {
+                    int lx = flipX ? w - ix : ix + 1;
+                    int cell = index(x0 + lx - 1, z0 + lz - 1);
+                    uint8_t cost = m_costs[cell];
+                    if (cost == BLOCKED || cell == m_goalCell) continue;
+
+                    float* value = &buffer[lz * stride + lx];
+                    float a = std::min(value[-1], value[1]);
+                    float b = std::min(value[-stride], value[stride]);
+                    float updated = eikonalUpdate(a, b, cost * m_settings.cellSize);
+                    if (updated != *value) {
+                        largestChange = std::max(largestChange, std::fabs(updated - *value));
+                        *value = updated;
+                    }
+                }
+            }
+            settled = largestChange <= tolerance;
+        }
+
+        uint8_t wake = settled ? 0 : kWakeSelf;
+        for (int lz = 1; lz <= h; ++lz) {
+            for (int lx = 1; lx <= w; ++lx) {
+                float& stored = m_distances[index(x0 + lx - 1, z0 + lz - 1)];
+                float updated = buffer[lz * stride + lx];
+                if (changed(stored, updated, tolerance)) {
+                    if (lx == 1) wake |= kWakeWest;
+                    if (lx == w) wake |= kWakeEast;
+                    if (lz == 1) wake |= kWakeSouth;
+                    if (lz == h) wake |= kWakeNorth;
+                }
+                stored = updated;
+            }
+        }
+        m_tileWake[slot] = wake;
+    }
+
+    void FlowField::updateDirections(int slot) {
+        const int tileSize = m_settings.tileSize;
+        int tile = m_solvedTiles[slot];
+        int x0 = (tile % m_tilesX) * tileSize;
+        int z0 = (tile / m_tilesX) * tileSize;
+        int x1 = std::min(x0 + tileSize, m_width);
+        int z1 = std::min(z0 + tileSize, m_height);
+
+        for (int z = z0; z < z1; ++z) {
+            for (int x = x0; x < x1; ++x) {
+                int cell = index(x, z);
+                float here = m_distances[cell];
+                glm::vec2 direction(0.0f);
+                if (here != kInfinity && cell != m_goalCell) {
+                    // Step towards the lower neighbour on each axis, weighted by the drop
+                    float west = x > 0 ? m_distances[cell - 1] : kInfinity;
+                    float east = x + 1 < m_width ? m_distances[cell + 1] : kInfinity;
+                    float south = z > 0 ? m_distances[cell - m_width] : kInfinity;
+                    float north = z + 1 < m_height ? m_distances[cell + m_width] : kInfinity;
+                    direction.x = west < east ? -std::max(here - west, 0.0f) : std::max(here - east, 0.0f);
+                    direction.y = south < north ? -std::max(here - south, 0.0f) : std::max(here - north, 0.0f);
+                    float length = glm::length(direction);
+                    direction = length > 0.0f ? direction / length : glm::vec2(0.0f);
+                }
+                m_directions[cell] = direction;
+            }
+        }
+    }
+
+    void FlowField::forEach(size_t count, void (FlowField::*body)(int)) {
+        if (m_jobSystem && m_jobSystem->getWorkerCount() > 0 && count > 1) {
+            m_jobSystem->parallelFor(count, 1, [this, body](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    (this->*body)(static_cast<int>(i));
+                }
+            });
+            return;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            (this->*body)(static_cast<int>(i));
+        }
+    }
+
+    glm::vec3 FlowField::sampleDirection(const glm::vec3& position) const {
+        if (!m_fieldValid) return glm::vec3(0.0f);
+        float fx = (position.x - m_origin.x) / m_settings.cellSize - 0.5f;
+        float fz = (position.z - m_origin.y) / m_settings.cellSize - 0.5f;
+        int x0 = static_cast<int>(std::floor(fx));
+        int z0 = static_cast<int>(std::floor(fz));
+        float tx = fx - x0;
+        float tz = fz - z0;
+
+        // Bilinear blend of the four surrounding cell centres; blocked or
+        // unreachable cells drop out
+        glm::vec2 blended(0.0f);
+        for (int corner = 0; corner < 4; ++corner) {
+            int x = x0 + (corner & 1);
+            int z = z0 + (corner >> 1);
+            if (x < 0 || x >= m_width || z < 0 || z >= m_height) continue;
+            int cell = index(x, z);
+            if (m_distances[cell] == kInfinity) continue;
+            float weight = ((corner & 1) ? tx : 1.0f - tx) * ((corner >> 1) ? tz : 1.0f - tz);
+            blended += m_directions[cell] * weight;
+        }
+
+        float length = glm::length(blended);
+        if (length < 1e-4f) {
+            int x, z;
+            if (!worldToCell(position, x, z)) return glm::vec3(0.0f);
+            const glm::vec2& own = m_directions[index(x, z)];
+            return glm::vec3(own.x, 0.0f, own.y);
+        }
+        return glm::vec3(blended.x / length, 0.0f, blended.y / length);
+    }
+
+    float FlowField::sampleDistance(const glm::vec3& position) const {
+        int x, z;
+        if (!worldToCell(position, x, z)) return -1.0f;
+        return getDistance(x, z);
+    }
+
+    float FlowField::getDistance(int x, int z) const {
+        if (!m_fieldValid || x < 0 || x >= m_width || z < 0 || z >= m_height) return -1.0f;
+        float distance = m_distances[index(x, z)];
+        return distance == kInfinity ? -1.0f : distance;
+    }
+}
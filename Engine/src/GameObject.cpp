@@ -3,7 +3,7 @@
 
 namespace Sparky {
 
-    GameObject::GameObject(const std::string& name) : position(0.0f), rotation(0.0f), scale(1.0f), name(name) {
+    GameObject::GameObject(const std::string& name) : position(0.0f), rotation(0.0f), scale(1.0f), name(name), phasedUpdate(false), revision(0) {
     }
 
     GameObject::~GameObject() {
@@ -11,6 +11,9 @@ namespace Sparky {
 
     void GameObject::update(float deltaTime) {
         for (auto& component : components) {
+            if (phasedUpdate && component->getUpdatePhase() != UpdatePhase::LATE_UPDATE) {
+                continue;
+            }
             component->update(deltaTime);
         }
     }
@@ -9,6 +9,7 @@
 #include "../include/ParticleComponent.h"
 #include "../include/ParticleSystem.h"
 #include "../include/Camera.h"
+#include "../include/Random.h"
 
 #ifdef ENABLE_AUDIO
 #include "../include/AudioEngine.h"
@@ -16,7 +17,6 @@
 #endif
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
-#include <random>
 #include <algorithm>
 
 #ifdef HAS_GLFW
@@ -197,13 +197,8 @@ namespace Sparky {
         
         // Apply recoil to camera
         if (camera) {
-            // Add some randomness to the recoil direction
-            static std::random_device rd;
-            static std::ranlux24 gen(rd());
-            static std::uniform_real_distribution<float> dis(-0.5f, 0.5f);
-            
-            // Apply recoil pattern
-            float recoilYaw = dis(gen) * currentRecoil * recoilPattern.horizontalRecoil;
+            // Apply recoil pattern, with some randomness in the direction
+            float recoilYaw = Random::getInstance().range(-0.5f, 0.5f) * currentRecoil * recoilPattern.horizontalRecoil;
             float recoilPitch = -currentRecoil * recoilPattern.verticalRecoil;
             
             camera->ProcessMouseMovement(recoilYaw, recoilPitch);
@@ -225,14 +220,10 @@ namespace Sparky {
         
         // Add spread by randomly perturbing the direction
         if (spread > 0.0f) {
-            // Create a random number generator
-            static std::random_device rd;
-            static std::ranlux24 gen(rd());
-            static std::uniform_real_distribution<float> dis(-1.0f, 1.0f);
-            
             // Generate random offsets
-            float offsetX = dis(gen) * spread * 0.01f;
-            float offsetY = dis(gen) * spread * 0.01f;
+            Random& random = Random::getInstance();
+            float offsetX = random.range(-1.0f, 1.0f) * spread * 0.01f;
+            float offsetY = random.range(-1.0f, 1.0f) * spread * 0.01f;
             
             // Apply the offsets
             direction[0] += offsetX;
@@ -422,12 +413,8 @@ namespace Sparky {
     
     void GunImpl::updateJamming() {
         // Simple jamming probability based on wear and heat
-        static std::random_device rd;
-        static std::ranlux24 gen(rd());
-        static std::uniform_real_distribution<float> dis(0.0f, 1.0f);
-        
         float jamChance = jamProbability * (wear * 0.5f + heat * 0.5f);
-        if (dis(gen) < jamChance) {
+        if (Random::getInstance().nextFloat() < jamChance) {
             jam();
         }
     }
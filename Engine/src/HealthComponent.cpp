@@ -40,6 +40,9 @@ namespace Sparky {
             if (currentHealth > maxHealth) {
                 currentHealth = maxHealth;
             }
+            if (healthToRegenerate > 0.0f) {
+                markOwnerDirty();
+            }
             
             lastRegenerationTime = currentTime;
             
@@ -67,6 +70,7 @@ namespace Sparky {
         if (currentHealth < 0) {
             currentHealth = 0;
         }
+        markOwnerDirty();
         
         SPARKY_LOG_DEBUG("HealthComponent took " + std::to_string(damage) + " damage. Health: " + std::to_string(currentHealth));
         
@@ -100,6 +104,7 @@ namespace Sparky {
         if (currentHealth > maxHealth) {
             currentHealth = maxHealth;
         }
+        markOwnerDirty();
         
         SPARKY_LOG_DEBUG("HealthComponent healed " + std::to_string(amount) + " health. Health: " + std::to_string(currentHealth));
         
@@ -127,6 +132,7 @@ namespace Sparky {
         
         // Trigger callbacks if health changed
         if (currentHealth != oldHealth) {
+            markOwnerDirty();
             float difference = currentHealth - oldHealth;
             if (difference > 0 && onHealCallback) {
                 onHealCallback(difference);
@@ -161,9 +167,33 @@ namespace Sparky {
         if (currentHealth > this->maxHealth) {
             currentHealth = this->maxHealth;
         }
+        markOwnerDirty();
     }
 
     void HealthComponent::setRegenerationRate(float rate) {
         this->regenerationRate = rate;
+        markOwnerDirty();
+    }
+
+    void HealthComponent::serialize(BinaryWriter& writer) const {
+        writer.writeFloat(currentHealth);
+        writer.writeFloat(maxHealth);
+        writer.writeFloat(regenerationRate);
+    }
+
+    bool HealthComponent::deserialize(BinaryReader& reader, uint16_t version) {
+        (void)version;
+        float health = 0.0f, max = 0.0f, rate = 0.0f;
+        if (!reader.readFloat(health) || !reader.readFloat(max) || !reader.readFloat(rate)) {
+            return false;
+        }
+
+        // Restore directly; replaying damage/heal callbacks on load would be wrong
+        maxHealth = max;
+        currentHealth = health;
+        regenerationRate = rate;
+        lastRegenerationTime = 0.0f;
+        markOwnerDirty();
+        return true;
     }
 }
\ No newline at end of file
@@ -0,0 +1,666 @@
+#include "../include/HierarchicalPathfinder.h"
+#include "../include/AdvancedAI.h"
+#include "../include/Logger.h"
+#include "../include/TimingUtils.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <numeric>
+
+namespace Sparky {
+    namespace {
+        const float kInfinity = std::numeric_limits<float>::infinity();
+        const int kFromStart = -2; // Search parent of nodes linked straight to the start
+
+        bool hasEdge(const NavGraph& graph, int from, int to) {
+            for (uint32_t edge = graph.getEdgeBegin(from); edge < graph.getEdgeEnd(from); ++edge) {
+                if (graph.getEdgeTarget(edge) == to) return true;
+            }
+            return false;
+        }
+
+        int findRoot(std::vector<int>& parents, int item) {
+            while (parents[item] != item) {
+                parents[item] = parents[parents[item]];
+                item = parents[item];
+            }
+            return item;
+        }
+    }
+
+    HierarchicalPathfinder::HierarchicalPathfinder(const NavigationMesh* navMesh, const HierarchicalPathSettings& settings)
+        : m_navMesh(navMesh)
+        , m_settings(settings)
+        , m_built(false)
+        , m_origin(0.0f)
+        , m_clustersX(0)
+        , m_clustersZ(0)
+        , m_localStamp(0)
+        , m_searchStamp(0)
+        , m_stats() {
+        if (m_settings.clusterSize <= 0.0f) {
+            SPARKY_LOG_WARNING("HierarchicalPathfinder: cluster size must be positive, using 16");
+            m_settings.clusterSize = 16.0f;
+        }
+        m_settings.maxEntranceWidth = std::max(m_settings.maxEntranceWidth, 1);
+    }
+
+    std::unique_ptr<HierarchicalPathfinder> HierarchicalPathfinder::create(const NavigationMesh* navMesh,
+                                                                           const HierarchicalPathSettings& settings) {
+        return std::make_unique<HierarchicalPathfinder>(navMesh, settings);
+    }
+
+    int HierarchicalPathfinder::clusterAt(float x, float z) const {
+        int cx = static_cast<int>(std::floor((x - m_origin.x) / m_settings.clusterSize));
+        int cz = static_cast<int>(std::floor((z - m_origin.y) / m_settings.clusterSize));
+        cx = std::min(std::max(cx, 0), m_clustersX - 1);
+        cz = std::min(std::max(cz, 0), m_clustersZ - 1);
+        return cz * m_clustersX + cx;
+    }
+
+    void HierarchicalPathfinder::build() {
+        auto start = std::chrono::steady_clock::now();
+
+        m_clusters.clear();
+        m_transitions.clear();
+        m_dirtyClusters.clear();
+        m_built = true;
+
+        if (!m_navMesh) {
+            SPARKY_LOG_ERROR("HierarchicalPathfinder: no navigation mesh to build from");
+            m_nodeCluster.clear();
+            m_clustersX = m_clustersZ = 0;
+            refreshCounts();
+            return;
+        }
+
+        const NavGraph& graph = m_navMesh->getGraph();
+        const int nodeCount = graph.getNodeCount();
+
+        // Cluster grid over the node bounds
+        glm::vec2 minBounds(std::numeric_limits<float>::max());
+        glm::vec2 maxBounds(-std::numeric_limits<float>::max());
+        for (int i = 0; i < nodeCount; ++i) {
+            const glm::vec3& position = graph.getPosition(i);
+            minBounds = glm::min(minBounds, glm::vec2(position.x, position.z));
+            maxBounds = glm::max(maxBounds, glm::vec2(position.x, position.z));
+        }
+        if (nodeCount == 0) {
+            minBounds = maxBounds = glm::vec2(0.0f);
+        }
+        m_origin = minBounds;
+        m_clustersX = static_cast<int>((maxBounds.x - minBounds.x) / m_settings.clusterSize) + 1;
+        m_clustersZ = static_cast<int>((maxBounds.y - minBounds.y) / m_settings.clusterSize) + 1;
+        const int clusterCount = m_clustersX * m_clustersZ;
+
+        m_nodeCluster.resize(nodeCount);
+        m_clusterNodeStart.assign(static_cast<size_t>(clusterCount) + 1, 0);
+        for (int i = 0; i < nodeCount; ++i) {
+            const glm::vec3& position = graph.getPosition(i);
+            m_nodeCluster[i] = clusterAt(position.x, position.z);
+            ++m_clusterNodeStart[m_nodeCluster[i] + 1];
+        }
+        for (int cluster = 0; cluster < clusterCount; ++cluster) {
+            m_clusterNodeStart[cluster + 1] += m_clusterNodeStart[cluster];
+        }
+        m_clusterNodes.resize(nodeCount);
+        std::vector<uint32_t> cursor(m_clusterNodeStart.begin(), m_clusterNodeStart.end() - 1);
+        for (int i = 0; i < nodeCount; ++i) {
+            m_clusterNodes[cursor[m_nodeCluster[i]]++] = i;
+        }
+
+        // Incoming edges
+        m_reverseStart.assign(static_cast<size_t>(nodeCount) + 1, 0);
+        for (int i = 0; i < nodeCount; ++i) {
+            for (uint32_t edge = graph.getEdgeBegin(i); edge < graph.getEdgeEnd(i); ++edge) {
+                ++m_reverseStart[graph.getEdgeTarget(edge) + 1];
+            }
+        }
+        for (int i = 0; i < nodeCount; ++i) {
+            m_reverseStart[i + 1] += m_reverseStart[i];
+        }
+        m_reverseSources.resize(graph.getEdgeCount());
+        m_reverseCosts.resize(graph.getEdgeCount());
+        cursor.assign(m_reverseStart.begin(), m_reverseStart.end() - 1);
+        for (int i = 0; i < nodeCount; ++i) {
+            for (uint32_t edge = graph.getEdgeBegin(i); edge < graph.getEdgeEnd(i); ++edge) {
+                uint32_t slot = cursor[graph.getEdgeTarget(edge)]++;
+                m_reverseSources[slot] = i;
+                m_reverseCosts[slot] = graph.getEdgeCost(edge);
+            }
+        }
+
+        // Cluster adjacency follows the edges, walkable or not, so it survives obstacle changes
+        m_clusters.resize(clusterCount);
+        for (int i = 0; i < nodeCount; ++i) {
+            for (uint32_t edge = graph.getEdgeBegin(i); edge < graph.getEdgeEnd(i); ++edge) {
+                int from = m_nodeCluster[i];
+                int to = m_nodeCluster[graph.getEdgeTarget(edge)];
+                if (from != to) {
+                    m_clusters[from].neighbors.push_back(to);
+                    m_clusters[to].neighbors.push_back(from);
+                }
+            }
+        }
+        for (Cluster& cluster : m_clusters) {
+            std::sort(cluster.neighbors.begin(), cluster.neighbors.end());
+            cluster.neighbors.erase(std::unique(cluster.neighbors.begin(), cluster.neighbors.end()), cluster.neighbors.end());
+        }
+
+        m_entranceIndex.assign(nodeCount, -1);
+        m_localGeneration.assign(nodeCount, 0);
+        m_localCost.assign(nodeCount, kInfinity);
+        m_localStamp = 0;
+        m_search.assign(static_cast<size_t>(nodeCount) + 1, SearchState{0, 0.0f, -1, false});
+        m_searchStamp = 0;
+        m_clusterDirty.assign(clusterCount, 0);
+
+        for (int cluster = 0; cluster < clusterCount; ++cluster) {
+            for (int neighbor : m_clusters[cluster].neighbors) {
+                computeTransitions(graph, cluster, neighbor);
+            }
+        }
+        for (int cluster = 0; cluster < clusterCount; ++cluster) {
+            rebuildCluster(graph, cluster);
+        }
+
+        refreshCounts();
+        m_stats.updatedClusters = clusterCount;
+        m_stats.buildMs = elapsedMs(start);
+    }
+
+    void HierarchicalPathfinder::markNodeChanged(int node) {
+        if (!m_built || node < 0 || node >= static_cast<int>(m_nodeCluster.size())) {
+            return;
+        }
+        int cluster = m_nodeCluster[node];
+        if (!m_clusterDirty[cluster]) {
+            m_clusterDirty[cluster] = 1;
+            m_dirtyClusters.push_back(cluster);
+        }
+    }
+
+    void HierarchicalPathfinder::markAreaChanged(const glm::vec3& minBounds, const glm::vec3& maxBounds) {
+        if (!m_built || m_clusters.empty()) {
+            return;
+        }
+        int minCluster = clusterAt(minBounds.x, minBounds.z);
+        int maxCluster = clusterAt(maxBounds.x, maxBounds.z);
+        for (int cz = minCluster / m_clustersX; cz <= maxCluster / m_clustersX; ++cz) {
+            for (int cx = minCluster % m_clustersX; cx <= maxCluster % m_clustersX; ++cx) {
+                int cluster = cz * m_clustersX + cx;
+                if (!m_clusterDirty[cluster]) {
+                    m_clusterDirty[cluster] = 1;
+                    m_dirtyClusters.push_back(cluster);
+                }
+            }
+        }
+    }
+
+    int HierarchicalPathfinder::update() {
+        if (!m_built || !m_navMesh) {
+            build();
+            return m_stats.updatedClusters;
+        }
+
+        const NavGraph& graph = m_navMesh->getGraph();
+        if (graph.getNodeCount() != static_cast<int>(m_nodeCluster.size())) {
+            SPARKY_LOG_WARNING("HierarchicalPathfinder: navigation mesh topology changed, rebuilding");
+            build();
+            return m_stats.updatedClusters;
+        }
+        if (m_dirtyClusters.empty()) {
+            return 0;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+
+        // Entrances on every border of a changed cluster may have moved, which
+        // changes the entrance set of the cluster on the other side too
+        std::vector<int> affected;
+        for (int cluster : m_dirtyClusters) {
+            affected.push_back(cluster);
+            for (int neighbor : m_clusters[cluster].neighbors) {
+                computeTransitions(graph, cluster, neighbor);
+                computeTransitions(graph, neighbor, cluster);
+                affected.push_back(neighbor);
+            }
+        }
+        std::sort(affected.begin(), affected.end());
+        affected.erase(std::unique(affected.begin(), affected.end()), affected.end());
+        for (int cluster : affected) {
+            rebuildCluster(graph, cluster);
+        }
+
+        for (int cluster : m_dirtyClusters) {
+            m_clusterDirty[cluster] = 0;
+        }
+        m_dirtyClusters.clear();
+
+        refreshCounts();
+        m_stats.updatedClusters = static_cast<int>(affected.size());
+        m_stats.updateMs = elapsedMs(start);
+        return m_stats.updatedClusters;
+    }
+
+    void HierarchicalPathfinder::computeTransitions(const NavGraph& graph, int fromCluster, int toCluster) {
+        struct Crossing {
+            int from;
+            int to;
+            float cost;
+        };
+
+        std::vector<Crossing> crossings;
+        for (uint32_t i = m_clusterNodeStart[fromCluster]; i < m_clusterNodeStart[fromCluster + 1]; ++i) {
+            int node = m_clusterNodes[i];
+            if (!graph.isWalkable(node)) continue;
+            for (uint32_t edge = graph.getEdgeBegin(node); edge < graph.getEdgeEnd(node); ++edge) {
+                int target = graph.getEdgeTarget(edge);
+                if (m_nodeCluster[target] == toCluster && graph.isWalkable(target)) {
+                    crossings.push_back({node, target, graph.getEdgeCost(edge)});
+                }
+            }
+        }
+
+        const uint64_t key = pairKey(fromCluster, toCluster);
+        if (crossings.empty()) {
+            m_transitions.erase(key);
+            return;
+        }
+
+        // Two crossings belong to the same entrance when their nodes are adjacent
+        // on both sides of the border. Any crossing of an entrance can then be
+        // swapped for the chosen transition by walking along the entrance.
+        std::unordered_map<int, std::vector<int>> crossingsFrom;
+        for (int i = 0; i < static_cast<int>(crossings.size()); ++i) {
+            crossingsFrom[crossings[i].from].push_back(i);
+        }
+        std::vector<int> parents(crossings.size());
+        std::iota(parents.begin(), parents.end(), 0);
+        auto joinCrossings = [&](int a, int b) {
+            const Crossing& first = crossings[a];
+            const Crossing& second = crossings[b];
+            if (first.to == second.to || hasEdge(graph, first.to, second.to)) {
+                parents[findRoot(parents, a)] = findRoot(parents, b);
+            }
+        };
+        for (int i = 0; i < static_cast<int>(crossings.size()); ++i) {
+            int node = crossings[i].from;
+            for (int j : crossingsFrom[node]) {
+                if (j != i) joinCrossings(i, j);
+            }
+            for (uint32_t edge = graph.getEdgeBegin(node); edge < graph.getEdgeEnd(node); ++edge) {
+                auto it = crossingsFrom.find(graph.getEdgeTarget(edge));
+                if (it == crossingsFrom.end()) continue;
+                for (int j : it->second) {
+                    joinCrossings(i, j);
+                }
+            }
+        }
+
+        std::unordered_map<int, std::vector<int>> entrances;
+        for (int i = 0; i < static_cast<int>(crossings.size()); ++i) {
+            entrances[findRoot(parents, i)].push_back(i);
+        }
+
+        std::vector<Transition>& transitions = m_transitions[key];
+        transitions.clear();
+        std::vector<int> roots;
+        for (const auto& entrance : entrances) {
+            roots.push_back(entrance.first);
+        }
+        std::sort(roots.begin(), roots.end()); // Deterministic order
+
+        for (int root : roots) {
+            std::vector<int>& members = entrances[root];
+
+            // Cheapest crossing per border node
+            std::sort(members.begin(), members.end(), [&](int a, int b) {
+                if (crossings[a].from != crossings[b].from) return crossings[a].from < crossings[b].from;
+                return crossings[a].cost < crossings[b].cost;
+            });
+            members.erase(std::unique(members.begin(), members.end(), [&](int a, int b) {
+                return crossings[a].from == crossings[b].from;
+            }), members.end());
+
+            // Order along the entrance
+            glm::vec2 low(std::numeric_limits<float>::max());
+            glm::vec2 high(-std::numeric_limits<float>::max());
+            for (int member : members) {
+                const glm::vec3& position = graph.getPosition(crossings[member].from);
+                low = glm::min(low, glm::vec2(position.x, position.z));
+                high = glm::max(high, glm::vec2(position.x, position.z));
+            }
+            const int axis = (high.x - low.x) >= (high.y - low.y) ? 0 : 2;
+            std::stable_sort(members.begin(), members.end(), [&](int a, int b) {
+                return graph.getPosition(crossings[a].from)[axis] < graph.getPosition(crossings[b].from)[axis];
+            });
+
+            if (static_cast<int>(members.size()) <= m_settings.maxEntranceWidth) {
+                const Crossing& middle = crossings[members[members.size() / 2]];
+                transitions.push_back({middle.from, middle.to, middle.cost});
+            } else {
+                const Crossing& first = crossings[members.front()];
+                const Crossing& last = crossings[members.back()];
+                transitions.push_back({first.from, first.to, first.cost});
+                transitions.push_back({last.from, last.to, last.cost});
+            }
+        }
+    }
+
+    void HierarchicalPathfinder::rebuildCluster(const NavGraph& graph, int clusterIndex) {
+        Cluster& cluster = m_clusters[clusterIndex];
+        for (int entrance : cluster.entrances) {
+            m_entranceIndex[entrance] = -1;
+        }
+
+        cluster.entrances.clear();
+        for (int neighbor : cluster.neighbors) {
+            auto outgoing = m_transitions.find(pairKey(clusterIndex, neighbor));
+            if (outgoing != m_transitions.end()) {
+                for (const Transition& transition : outgoing->second) {
+                    cluster.entrances.push_back(transition.from);
+                }
+            }
+            auto incoming = m_transitions.find(pairKey(neighbor, clusterIndex));
+            if (incoming != m_transitions.end()) {
+                for (const Transition& transition : incoming->second) {
+                    cluster.entrances.push_back(transition.to);
+                }
+            }
+        }
+        std::sort(cluster.entrances.begin(), cluster.entrances.end());
+        cluster.entrances.erase(std::unique(cluster.entrances.begin(), cluster.entrances.end()), cluster.entrances.end());
+
+        const size_t entranceCount = cluster.entrances.size();
+        for (size_t i = 0; i < entranceCount; ++i) {
+            m_entranceIndex[cluster.entrances[i]] = static_cast<int>(i);
+        }
+
+        cluster.exits.assign(entranceCount, std::vector<Link>());
+        for (int neighbor : cluster.neighbors) {
+            auto outgoing = m_transitions.find(pairKey(clusterIndex, neighbor));
+            if (outgoing == m_transitions.end()) continue;
+            for (const Transition& transition : outgoing->second) {
+                cluster.exits[m_entranceIndex[transition.from]].push_back({transition.to, transition.cost});
+            }
+        }
+
+        cluster.intraCosts.assign(entranceCount * entranceCount, kInfinity);
+        for (size_t i = 0; i < entranceCount; ++i) {
+            clusterDijkstra(graph, cluster.entrances[i], clusterIndex, false);
+            for (size_t j = 0; j < entranceCount; ++j) {
+                cluster.intraCosts[i * entranceCount + j] = localCost(cluster.entrances[j]);
+            }
+        }
+    }
+
+    void HierarchicalPathfinder::clusterDijkstra(const NavGraph& graph, int source, int cluster, bool reverse) {
+        if (++m_localStamp == 0) {
+            std::fill(m_localGeneration.begin(), m_localGeneration.end(), 0);
+            m_localStamp = 1;
+        }
+
+        auto heapOrder = std::greater<std::pair<float, int>>();
+        m_localHeap.clear();
+        m_localGeneration[source] = m_localStamp;
+        m_localCost[source] = 0.0f;
+        m_localHeap.push_back({0.0f, source});
+
+        auto visit = [&](int node, float cost) {
+            if (m_nodeCluster[node] != cluster || !graph.isWalkable(node)) return;
+            if (m_localGeneration[node] != m_localStamp || cost < m_localCost[node]) {
+                m_localGeneration[node] = m_localStamp;
+                m_localCost[node] = cost;
+                m_localHeap.push_back({cost, node});
+                std::push_heap(m_localHeap.begin(), m_localHeap.end(), heapOrder);
+            }
+        };
+
+        while (!m_localHeap.empty()) {
+            std::pop_heap(m_localHeap.begin(), m_localHeap.end(), heapOrder);
+            std::pair<float, int> entry = m_localHeap.back();
+            m_localHeap.pop_back();
+            if (entry.first > m_localCost[entry.second]) continue;
+
+            const int node = entry.second;
+            if (reverse) {
+                for (uint32_t edge = m_reverseStart[node]; edge < m_reverseStart[node + 1]; ++edge) {
+                    visit(m_reverseSources[edge], entry.first + m_reverseCosts[edge]);
+                }
+            } else {
+                for (uint32_t edge = graph.getEdgeBegin(node); edge < graph.getEdgeEnd(node); ++edge) {
+                    visit(graph.getEdgeTarget(edge), entry.first + graph.getEdgeCost(edge));
+                }
+            }
+        }
+    }
+
+    float HierarchicalPathfinder::localCost(int node) const {
+        return m_localGeneration[node] == m_localStamp ? m_localCost[node] : kInfinity;
+    }
+
+    void HierarchicalPathfinder::relax(const NavGraph& graph, int node, float cost, int parent, int goal) {
+        SearchState& state = m_search[node];
+        if (state.generation == m_searchStamp && (state.closed || cost >= state.cost)) {
+            return;
+        }
+        state = SearchState{m_searchStamp, cost, parent, false};
+
+        const bool isGoal = node == static_cast<int>(m_search.size()) - 1;
+        float estimate = cost + (isGoal ? 0.0f : graph.heuristic(node, goal));
+        m_searchHeap.push_back({estimate, node});
+        std::push_heap(m_searchHeap.begin(), m_searchHeap.end(), std::greater<std::pair<float, int>>());
+    }
+
+    bool HierarchicalPathfinder::ensureCurrent() {
+        if (!m_built || !m_dirtyClusters.empty() ||
+            (m_navMesh && m_navMesh->getGraph().getNodeCount() != static_cast<int>(m_nodeCluster.size()))) {
+            update();
+        }
+        return m_navMesh != nullptr;
+    }
+
+    bool HierarchicalPathfinder::findAbstractPath(int startNode, int goalNode, HierarchicalPath& path) {
+        path.waypoints.clear();
+        path.nextSegment = 0;
+        path.cost = 0.0f;
+        m_stats.abstractNodesExpanded = 0;
+
+        if (!ensureCurrent()) {
+            return false;
+        }
+
+        const NavGraph& graph = m_navMesh->getGraph();
+        const int nodeCount = graph.getNodeCount();
+        if (startNode < 0 || startNode >= nodeCount || goalNode < 0 || goalNode >= nodeCount ||
+            !graph.isWalkable(startNode) || !graph.isWalkable(goalNode)) {
+            return false;
+        }
+        if (startNode == goalNode) {
+            path.waypoints.push_back(startNode);
+            return true;
+        }
+
+        const int startCluster = m_nodeCluster[startNode];
+        const int goalCluster = m_nodeCluster[goalNode];
+        const Cluster& goalSide = m_clusters[goalCluster];
+
+        // Cost from each goal-cluster entrance to the goal, searching backwards
+        clusterDijkstra(graph, goalNode, goalCluster, true);
+        m_goalCosts.resize(goalSide.entrances.size());
+        for (size_t i = 0; i < goalSide.entrances.size(); ++i) {
+            m_goalCosts[i] = localCost(goalSide.entrances[i]);
+        }
+
+        // Cost from the start to its cluster's entrances, and to the goal if it is in the same cluster
+        clusterDijkstra(graph, startNode, startCluster, false);
+
+        if (++m_searchStamp == 0) {
+            for (SearchState& state : m_search) {
+                state.generation = 0;
+            }
+            m_searchStamp = 1;
+        }
+        m_searchHeap.clear();
+        const int goalSlot = nodeCount;
+
+        if (startCluster == goalCluster && localCost(goalNode) < kInfinity) {
+            relax(graph, goalSlot, localCost(goalNode), kFromStart, goalNode);
+        }
+        for (int entrance : m_clusters[startCluster].entrances) {
+            float cost = localCost(entrance);
+            if (cost < kInfinity) {
+                relax(graph, entrance, cost, kFromStart, goalNode);
+            }
+        }
+
+        auto heapOrder = std::greater<std::pair<float, int>>();
+        while (!m_searchHeap.empty()) {
+            std::pop_heap(m_searchHeap.begin(), m_searchHeap.end(), heapOrder);
+            const int node = m_searchHeap.back().second;
+            m_searchHeap.pop_back();
+
+            SearchState& state = m_search[node];
+            if (state.closed) continue;
+            state.closed = true;
+            ++m_stats.abstractNodesExpanded;
+
+            if (node == goalSlot) {
+                path.cost = state.cost;
+                path.waypoints.push_back(goalNode);
+                for (int parent = state.parent; parent >= 0; parent = m_search[parent].parent) {
+                    if (parent != path.waypoints.back()) {
+                        path.waypoints.push_back(parent);
+                    }
+                }
+                if (path.waypoints.back() != startNode) {
+                    path.waypoints.push_back(startNode);
+                }
+                std::reverse(path.waypoints.begin(), path.waypoints.end());
+                return true;
+            }
+
+            const float cost = state.cost;
+            const int clusterIndex = m_nodeCluster[node];
+            const Cluster& cluster = m_clusters[clusterIndex];
+            const size_t entranceCount = cluster.entrances.size();
+            const int local = m_entranceIndex[node];
+
+            for (size_t j = 0; j < entranceCount; ++j) {
+                float step = cluster.intraCosts[local * entranceCount + j];
+                if (static_cast<int>(j) != local && step < kInfinity) {
+                    relax(graph, cluster.entrances[j], cost + step, node, goalNode);
+                }
+            }
+            for (const Link& link : cluster.exits[local]) {
+                relax(graph, link.target, cost + link.cost, node, goalNode);
+            }
+            if (clusterIndex == goalCluster && m_goalCosts[local] < kInfinity) {
+                relax(graph, goalSlot, cost + m_goalCosts[local], node, goalNode);
+            }
+        }
+        return false;
+    }
+
+    bool HierarchicalPathfinder::isFullyRefined(const HierarchicalPath& path) const {
+        return path.waypoints.size() <= 1 ? path.nextSegment > 0 || path.waypoints.empty()
+                                          : path.nextSegment + 1 >= path.waypoints.size();
+    }
+
+    bool HierarchicalPathfinder::refineNextSegment(HierarchicalPath& path, std::vector<int>& nodes) {
+        if (isFullyRefined(path) || !m_navMesh) {
+            return false;
+        }
+
+        if (path.waypoints.size() == 1) {
+            nodes.push_back(path.waypoints[0]);
+            path.nextSegment = 1;
+            return true;
+        }
+
+        const NavGraph& graph = m_navMesh->getGraph();
+        const int from = path.waypoints[path.nextSegment];
+        const int to = path.waypoints[path.nextSegment + 1];
+        const bool first = path.nextSegment == 0;
+
+        if (m_nodeCluster[from] != m_nodeCluster[to]) {
+            // A transition edge
+            if (!graph.isWalkable(to)) {
+                return false;
+            }
+            if (first) nodes.push_back(from);
+            nodes.push_back(to);
+        } else {
+            if (!m_refiner.findPathInRegion(graph, from, to, m_nodeCluster, m_nodeCluster[from], m_segment)) {
+                return false;
+            }
+            nodes.insert(nodes.end(), m_segment.begin() + (first ? 0 : 1), m_segment.end());
+        }
+
+        ++path.nextSegment;
+        return true;
+    }
+
+    bool HierarchicalPathfinder::findNodePath(int startNode, int goalNode, std::vector<int>& path) {
+        path.clear();
+        HierarchicalPath abstractPath;
+        if (!findAbstractPath(startNode, goalNode, abstractPath)) {
+            return false;
+        }
+        while (!isFullyRefined(abstractPath)) {
+            if (!refineNextSegment(abstractPath, path)) {
+                path.clear();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::vector<glm::vec3> HierarchicalPathfinder::findPath(const glm::vec3& start, const glm::vec3& end) {
+        std::vector<glm::vec3> path;
+        if (!m_navMesh) {
+            return path;
+        }
+
+        int startNode = m_navMesh->findNearestNode(start);
+        int endNode = m_navMesh->findNearestNode(end);
+        if (startNode == -1 || endNode == -1) {
+            // No valid nodes found, return direct path
+            path.push_back(start);
+            path.push_back(end);
+            return path;
+        }
+
+        if (!findNodePath(startNode, endNode, m_nodePath)) {
+            return path;
+        }
+
+        const NavGraph& graph = m_navMesh->getGraph();
+        path.reserve(m_nodePath.size() + 1);
+        path.push_back(start);
+        for (int node : m_nodePath) {
+            path.push_back(graph.getPosition(node));
+        }
+        return path;
+    }
+
+    void HierarchicalPathfinder::refreshCounts() {
+        m_stats.clusterCount = static_cast<int>(m_clusters.size());
+        m_stats.entranceCount = 0;
+        m_stats.abstractEdgeCount = 0;
+        for (const Cluster& cluster : m_clusters) {
+            m_stats.entranceCount += static_cast<int>(cluster.entrances.size());
+            for (size_t i = 0; i < cluster.intraCosts.size(); ++i) {
+                if (cluster.intraCosts[i] < kInfinity && i % (cluster.entrances.size() + 1) != 0) {
+                    ++m_stats.abstractEdgeCount;
+                }
+            }
+            for (const auto& exits : cluster.exits) {
+                m_stats.abstractEdgeCount += exits.size();
+            }
+        }
+    }
+}
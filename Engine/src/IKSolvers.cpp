@@ -0,0 +1,188 @@
+#include "../include/IKSolvers.h"
+#include <glm/gtc/constants.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace Sparky {
+    namespace {
+        const float kEpsilon = 1e-6f;
+
+        // Unit vector from a to b, or fallback when they coincide
+        glm::vec3 direction(const glm::vec3& a, const glm::vec3& b, const glm::vec3& fallback) {
+            glm::vec3 offset = b - a;
+            float length = glm::length(offset);
+            return length > kEpsilon ? offset / length : fallback;
+        }
+
+        // Any unit vector perpendicular to v
+        glm::vec3 perpendicular(const glm::vec3& v) {
+            glm::vec3 axis = std::fabs(v.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+            return glm::normalize(glm::cross(v, axis));
+        }
+
+        // Turns the unit direction next so its angle from the unit direction incoming lies in
+        // [minBend, maxBend], staying in the plane of the two
+        glm::vec3 limitBend(const glm::vec3& incoming, const glm::vec3& next, float minBend, float maxBend) {
+            if (minBend > maxBend) return next;
+            float bend = std::acos(std::min(std::max(glm::dot(incoming, next), -1.0f), 1.0f));
+            if (bend >= minBend && bend <= maxBend) return next;
+
+            glm::vec3 side = next - incoming * glm::dot(incoming, next);
+            float sideLength = glm::length(side);
+            side = sideLength > kEpsilon ? side / sideLength : perpendicular(incoming);
+            float limited = std::min(std::max(bend, minBend), maxBend);
+            return incoming * std::cos(limited) + side * std::sin(limited);
+        }
+    }
+
+    float solveTwoBone(const glm::vec3& root, glm::vec3& mid, glm::vec3& end, const glm::vec3& target,
+                       const glm::vec3& pole, bool usePole, float minBend, float maxBend) {
+        const float upper = glm::length(mid - root);
+        const float lower = glm::length(end - mid);
+        glm::vec3 toTarget = direction(root, target, direction(root, end, glm::vec3(0.0f, -1.0f, 0.0f)));
+
+        // Bend plane: towards the pole, or wherever the middle joint already points
+        glm::vec3 bendHint = usePole ? pole - root : mid - root;
+        glm::vec3 bendDir = bendHint - toTarget * glm::dot(bendHint, toTarget);
+        float bendLength = glm::length(bendDir);
+        bendDir = bendLength > kEpsilon ? bendDir / bendLength : perpendicular(toTarget);
+
+        // Knee bend from the law of cosines, limited, then the reach it gives
+        float reach = std::min(std::max(glm::length(target - root), std::fabs(upper - lower)), upper + lower);
+        float cosInterior = upper > kEpsilon && lower > kEpsilon
+                                ? (upper * upper + lower * lower - reach * reach) / (2.0f * upper * lower)
+                                : -1.0f;
+        float bend = glm::pi<float>() - std::acos(std::min(std::max(cosInterior, -1.0f), 1.0f));
+        if (minBend <= maxBend) {
+            bend = std::min(std::max(bend, minBend), maxBend);
+        }
+        reach = std::sqrt(std::max(upper * upper + lower * lower + 2.0f * upper * lower * std::cos(bend), 0.0f));
+
+        // Angle at the root between the target direction and the upper bone
+        float cosRoot = upper > kEpsilon && reach > kEpsilon
+                            ? (upper * upper + reach * reach - lower * lower) / (2.0f * upper * reach)
+                            : 1.0f;
+        float rootAngle = std::acos(std::min(std::max(cosRoot, -1.0f), 1.0f));
+        mid = root + (toTarget * std::cos(rootAngle) + bendDir * std::sin(rootAngle)) * upper;
+        end = root + toTarget * reach;
+        return glm::length(end - target);
+    }
+
+    int solveFABRIK(glm::vec3* positions, const float* lengths, int count, const glm::vec3& target,
+                    const float* minBends, const float* maxBends, const IKSolverSettings& settings, float& error) {
+        error = 0.0f;
+        if (count < 2) return 0;
+
+        const glm::vec3 root = positions[0];
+        float total = 0.0f;
+        for (int i = 0; i + 1 < count; ++i) {
+            total += lengths[i];
+        }
+
+        // Out of reach: every bone points at the target, as far as the limits let it
+        bool reachable = glm::length(target - root) < total;
+        int iteration = 0;
+        while (iteration < settings.maxIterations) {
+            ++iteration;
+            if (reachable) {
+                // Backward: pin the end to the target and pull each joint towards the next. The
+                // bend at a joint is the same angle seen from either side, so it is limited here too.
+                positions[count - 1] = target;
+                glm::vec3 outgoing(0.0f);
+                for (int i = count - 2; i >= 0; --i) {
+                    glm::vec3 previous = direction(positions[i + 1], positions[i], i < count - 2 ? outgoing : glm::vec3(0.0f, -1.0f, 0.0f));
+                    if (i < count - 2) {
+                        previous = limitBend(outgoing, previous, minBends[i + 1], maxBends[i + 1]);
+                    }
+                    positions[i] = positions[i + 1] + previous * lengths[i];
+                    outgoing = previous;
+                }
+            }
+
+            // Forward: pin the root and lay the bones back out at their lengths, limiting each bend
+            positions[0] = root;
+            glm::vec3 incoming(0.0f);
+            for (int i = 0; i + 1 < count; ++i) {
+                glm::vec3 aim = reachable ? positions[i + 1] : target;
+                glm::vec3 next = direction(positions[i], aim, i > 0 ? incoming : glm::vec3(0.0f, 1.0f, 0.0f));
+                if (i > 0) {
+                    next = limitBend(incoming, next, minBends[i], maxBends[i]);
+                }
+                positions[i + 1] = positions[i] + next * lengths[i];
+                incoming = next;
+            }
+
+            error = glm::length(positions[count - 1] - target);
+            if (error <= settings.tolerance || !reachable) break;
+        }
+        return iteration;
+    }
+
+    void IKChainBatch::clear() {
+        positions.clear();
+        lengths.clear();
+        minBends.clear();
+        maxBends.clear();
+        offsets.clear();
+        counts.clear();
+        targets.clear();
+        poles.clear();
+        hasPole.clear();
+        iterations.clear();
+        errors.clear();
+    }
+
+    int IKChainBatch::addChain(const glm::vec3* points, int count, const glm::vec3& target, const glm::vec3* pole,
+                               const float* minBend, const float* maxBend) {
+        int chain = getChainCount();
+        offsets.push_back(static_cast<int>(positions.size()));
+        counts.push_back(count);
+        for (int i = 0; i < count; ++i) {
+            positions.push_back(points[i]);
+            lengths.push_back(i + 1 < count ? glm::length(points[i + 1] - points[i]) : 0.0f);
+            minBends.push_back(minBend[i]);
+            maxBends.push_back(maxBend[i]);
+        }
+        targets.push_back(target);
+        poles.push_back(pole ? *pole : glm::vec3(0.0f));
+        hasPole.push_back(pole ? 1 : 0);
+        iterations.push_back(0);
+        errors.push_back(0.0f);
+        return chain;
+    }
+
+    void solveIKBatch(IKChainBatch& batch, const IKSolverSettings& settings, IKSolveStats& stats) {
+        const int chainCount = batch.getChainCount();
+        for (int chain = 0; chain < chainCount; ++chain) {
+            const int offset = batch.offsets[chain];
+            const int count = batch.counts[chain];
+            if (count < 2) continue;
+            glm::vec3* positions = batch.positions.data() + offset;
+            const glm::vec3& target = batch.targets[chain];
+
+            float total = 0.0f;
+            for (int i = 0; i + 1 < count; ++i) {
+                total += batch.lengths[offset + i];
+            }
+            if (glm::length(target - positions[0]) >= total) ++stats.unreachable;
+
+            float error;
+            if (count == 3) {
+                error = solveTwoBone(positions[0], positions[1], positions[2], target, batch.poles[chain],
+                                     batch.hasPole[chain] != 0, batch.minBends[offset + 1], batch.maxBends[offset + 1]);
+                batch.iterations[chain] = 1;
+                ++stats.twoBoneChains;
+            } else {
+                batch.iterations[chain] = solveFABRIK(positions, batch.lengths.data() + offset, count, target,
+                                                      batch.minBends.data() + offset, batch.maxBends.data() + offset,
+                                                      settings, error);
+                ++stats.fabrikChains;
+            }
+            batch.errors[chain] = error;
+            ++stats.chainsSolved;
+            stats.iterations += batch.iterations[chain];
+            if (error <= settings.tolerance) ++stats.converged;
+            stats.maxError = std::max(stats.maxError, error);
+        }
+    }
+}
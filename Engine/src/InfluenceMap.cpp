@@ -0,0 +1,703 @@
+#include "../include/InfluenceMap.h"
+#include "../include/JobSystem.h"
+#include "../include/Logger.h"
+#include "../include/StaticBVH.h"
+#include "../include/TimingUtils.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace Sparky {
+    namespace {
+        const int kTileSize = 16;
+        const size_t kBatchSize = 64;           // Candidates scored together
+        const float kThreatFloor = 0.01f;       // Threat below this is cleared
+        const float kSettleDelta = 0.001f;      // Tiles changing less than this stop propagating
+        const float kPi = 3.14159265f;
+
+        // Clamps to [0, 1]; NaN becomes 0
+        float saturate(float value) {
+            return value > 0.0f ? (value < 1.0f ? value : 1.0f) : 0.0f;
+        }
+
+        int popCount(uint8_t bits) {
+            int count = 0;
+            for (; bits; bits &= bits - 1) ++count;
+            return count;
+        }
+
+        // Cover probe direction k, k * 45 degrees from +X toward +Z
+        glm::vec3 probeDirection(int k) {
+            float angle = static_cast<float>(k) * kPi * 0.25f;
+            return glm::vec3(std::cos(angle), 0.0f, std::sin(angle));
+        }
+
+        int probeIndex(float dx, float dz) {
+            int k = static_cast<int>(std::lround(std::atan2(dz, dx) / (kPi * 0.25f)));
+            return (k + 8) & 7;
+        }
+    }
+
+    // UtilityCurve implementation
+    float UtilityCurve::evaluate(float x) const {
+        float y;
+        evaluate(&x, &y, 1);
+        return y;
+    }
+
+    void UtilityCurve::evaluate(const float* x, float* y, size_t count) const {
+        switch (type) {
+            case Type::LINEAR:
+                for (size_t i = 0; i < count; ++i) {
+                    y[i] = saturate(slope * (x[i] - xShift) + yShift);
+                }
+                break;
+            case Type::POLYNOMIAL:
+                if (exponent == 2.0f) {
+                    for (size_t i = 0; i < count; ++i) {
+                        float d = x[i] - xShift;
+                        y[i] = saturate(slope * d * d + yShift);
+                    }
+                } else {
+                    for (size_t i = 0; i < count; ++i) {
+                        y[i] = saturate(slope * std::pow(x[i] - xShift, exponent) + yShift);
+                    }
+                }
+                break;
+            case Type::LOGISTIC:
+                for (size_t i = 0; i < count; ++i) {
+                    y[i] = saturate(exponent / (1.0f + std::exp(-slope * (x[i] - xShift))) + yShift);
+                }
+                break;
+        }
+    }
+
+    // TacticalQuery implementation
+    TacticalQuery::TacticalQuery() : self(0.0f), target(0.0f), hasTarget(false), radius(10.0f) {
+        std::fill(weights, weights + static_cast<int>(TacticalConsideration::COUNT), 0.0f);
+    }
+
+    void TacticalQuery::consider(TacticalConsideration consideration, const UtilityCurve& curve, float weight) {
+        curves[static_cast<int>(consideration)] = curve;
+        weights[static_cast<int>(consideration)] = std::max(weight, 0.0f);
+    }
+
+    TacticalQuery TacticalQuery::cover(const glm::vec3& self, const glm::vec3& threat, float radius) {
+        TacticalQuery query;
+        query.self = self;
+        query.target = threat;
+        query.hasTarget = true;
+        query.radius = radius;
+        query.consider(TacticalConsideration::COVER, UtilityCurve::rising(), 3.0f);
+        query.consider(TacticalConsideration::VISIBILITY, UtilityCurve::falling(), 2.0f);
+        query.consider(TacticalConsideration::THREAT, UtilityCurve::falling(), 1.0f);
+        query.consider(TacticalConsideration::DISTANCE_TO_SELF, UtilityCurve::falling(), 1.0f);
+        query.consider(TacticalConsideration::DISTANCE_TO_TARGET, UtilityCurve::rising(), 0.5f);
+        return query;
+    }
+
+    TacticalQuery TacticalQuery::flank(const glm::vec3& self, const glm::vec3& target, float radius) {
+        TacticalQuery query;
+        query.self = self;
+        query.target = target;
+        query.hasTarget = true;
+        query.radius = radius;
+        query.consider(TacticalConsideration::FLANK_ANGLE, UtilityCurve::bell(0.5f, 0.35f), 3.0f);
+        query.consider(TacticalConsideration::DISTANCE_TO_TARGET, UtilityCurve::bell(0.4f, 0.3f), 2.0f);
+        query.consider(TacticalConsideration::VISIBILITY, UtilityCurve::falling(), 1.0f);
+        query.consider(TacticalConsideration::THREAT, UtilityCurve::falling(), 1.0f);
+        query.consider(TacticalConsideration::DISTANCE_TO_SELF, UtilityCurve::falling(), 1.0f);
+        return query;
+    }
+
+    // InfluenceMap implementation
+    InfluenceMap::InfluenceMap()
+        : InfluenceMap(InfluenceMapSettings()) {
+    }
+
+    InfluenceMap::InfluenceMap(const InfluenceMapSettings& settings)
+        : m_settings(settings)
+        , m_jobSystem(nullptr)
+        , m_occluders(nullptr)
+        , m_tilesX(0)
+        , m_tilesZ(0)
+        , m_edgeFalloff(0.0f)
+        , m_diagonalFalloff(0.0f)
+        , m_coverPointCount(0)
+        , m_sourceCount(0)
+        , m_sourcesDirty(false)
+        , m_stats() {
+        if (m_settings.cellSize <= 0.0f) {
+            SPARKY_LOG_WARNING("InfluenceMap: cell size must be positive, using 2");
+            m_settings.cellSize = 2.0f;
+        }
+        if (m_settings.width < 1 || m_settings.height < 1) {
+            SPARKY_LOG_WARNING("InfluenceMap: grid must have at least one cell, using 128x128");
+            m_settings.width = 128;
+            m_settings.height = 128;
+        }
+        if (m_settings.threatMomentum < 0.0f || m_settings.threatMomentum >= 1.0f) {
+            SPARKY_LOG_WARNING("InfluenceMap: threat momentum must be in [0, 1), using 0.5");
+            m_settings.threatMomentum = 0.5f;
+        }
+        if (m_settings.propagationSteps < 1) {
+            SPARKY_LOG_WARNING("InfluenceMap: propagation steps must be at least 1, using 2");
+            m_settings.propagationSteps = 2;
+        }
+
+        size_t cellCount = static_cast<size_t>(m_settings.width) * m_settings.height;
+        m_threat.assign(cellCount, 0.0f);
+        m_threatNext.assign(cellCount, 0.0f);
+        m_sourceValue.assign(cellCount, 0.0f);
+        m_visibility.assign(cellCount, 0.0f);
+        m_visibilityCount.assign(cellCount, 0);
+        m_coverMask.assign(cellCount, 0);
+        m_blocked.assign(cellCount, 0);
+
+        m_tilesX = (m_settings.width + kTileSize - 1) / kTileSize;
+        m_tilesZ = (m_settings.height + kTileSize - 1) / kTileSize;
+        m_tileActive.assign(static_cast<size_t>(m_tilesX) * m_tilesZ, 0);
+        m_tileDelta.assign(m_tileActive.size(), 0.0f);
+
+        m_edgeFalloff = std::exp(-std::max(m_settings.threatDecay, 0.0f) * m_settings.cellSize);
+        m_diagonalFalloff = std::exp(-std::max(m_settings.threatDecay, 0.0f) * m_settings.cellSize * 1.41421356f);
+    }
+
+    std::unique_ptr<InfluenceMap> InfluenceMap::create(const InfluenceMapSettings& settings) {
+        return std::make_unique<InfluenceMap>(settings);
+    }
+
+    void InfluenceMap::buildCover(const StaticBVH& geometry) {
+        if (!geometry.isBuilt()) {
+            SPARKY_LOG_WARNING("InfluenceMap: cover geometry has not been built, cover uses its last build");
+        }
+
+        const int width = m_settings.width;
+        auto probeRows = [this, &geometry, width](size_t begin, size_t end) {
+            for (size_t z = begin; z < end; ++z) {
+                for (int x = 0; x < width; ++x) {
+                    int cell = static_cast<int>(z) * width + x;
+                    glm::vec3 center = getCellCenter(cell) + glm::vec3(0.0f, m_settings.coverHeight, 0.0f);
+                    uint8_t mask = 0;
+                    bool inside = false;
+                    for (int k = 0; k < 8 && !inside; ++k) {
+                        StaticBVHHit hit;
+                        if (!geometry.raycast(center, probeDirection(k), m_settings.coverProbeDistance, hit)) continue;
+                        inside = hit.distance <= 0.0f;
+                        mask |= static_cast<uint8_t>(1u << k);
+                    }
+                    m_blocked[cell] = inside ? 1 : 0;
+                    m_coverMask[cell] = inside ? 0 : mask;
+                }
+            }
+        };
+
+        if (m_jobSystem && m_jobSystem->getWorkerCount() > 0) {
+            m_jobSystem->parallelFor(static_cast<size_t>(m_settings.height), 4, probeRows);
+        } else {
+            probeRows(0, static_cast<size_t>(m_settings.height));
+        }
+
+        m_coverPointCount = 0;
+        for (size_t cell = 0; cell < m_coverMask.size(); ++cell) {
+            m_coverPointCount += m_coverMask[cell] != 0 ? 1 : 0;
+            if (m_blocked[cell]) {
+                m_threat[cell] = 0.0f;
+            }
+        }
+
+        // Blocked cells change where threat and visibility can reach
+        for (size_t source = 0; source < m_sources.size(); ++source) {
+            if (m_sourceActive[source]) m_sources[source].visibilityDirty = true;
+        }
+        std::fill(m_tileActive.begin(), m_tileActive.end(), 1);
+        m_sourcesDirty = true;
+    }
+
+    InfluenceSourceId InfluenceMap::addThreatSource(const glm::vec3& position, float strength, float sightRange) {
+        int slot;
+        if (!m_freeSources.empty()) {
+            slot = m_freeSources.back();
+            m_freeSources.pop_back();
+        } else {
+            slot = static_cast<int>(m_sources.size());
+            m_sources.emplace_back();
+            m_sourceActive.push_back(0);
+        }
+
+        ThreatSource& source = m_sources[slot];
+        source.position = position;
+        source.strength = saturate(strength);
+        source.sightRange = std::max(sightRange, 0.0f);
+        source.cell = getCell(position);
+        source.visibilityDirty = true;
+        source.visibleStrength = 0.0f;
+        source.visibleCells.clear();
+        m_sourceActive[slot] = 1;
+        m_sourcesDirty = true;
+        ++m_sourceCount;
+        return slot;
+    }
+
+    void InfluenceMap::removeThreatSource(InfluenceSourceId source) {
+        if (source < 0 || source >= static_cast<int>(m_sources.size()) || !m_sourceActive[source]) return;
+        clearVisibility(m_sources[source]);
+        m_sourceActive[source] = 0;
+        m_freeSources.push_back(source);
+        m_sourcesDirty = true;
+        --m_sourceCount;
+    }
+
+    void InfluenceMap::setThreatSourcePosition(InfluenceSourceId source, const glm::vec3& position) {
+        if (source < 0 || source >= static_cast<int>(m_sources.size()) || !m_sourceActive[source]) return;
+        ThreatSource& threat = m_sources[source];
+        threat.position = position;
+        int cell = getCell(position);
+        if (cell != threat.cell) {
+            threat.cell = cell;
+            threat.visibilityDirty = true;
+            m_sourcesDirty = true;
+        }
+    }
+
+    void InfluenceMap::setThreatSource(InfluenceSourceId source, float strength, float sightRange) {
+        if (source < 0 || source >= static_cast<int>(m_sources.size()) || !m_sourceActive[source]) return;
+        ThreatSource& threat = m_sources[source];
+        threat.strength = saturate(strength);
+        threat.sightRange = std::max(sightRange, 0.0f);
+        threat.visibilityDirty = true;
+        m_sourcesDirty = true;
+    }
+
+    void InfluenceMap::update() {
+        m_stats = InfluenceMapStats();
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t source = 0; source < m_sources.size(); ++source) {
+            if (m_sourceActive[source] && m_sources[source].visibilityDirty) {
+                refreshVisibility(m_sources[source]);
+            }
+        }
+        m_stats.visibilityMs = elapsedMs(start);
+
+        start = std::chrono::steady_clock::now();
+        if (m_sourcesDirty) {
+            restampSources();
+        }
+        for (int step = 0; step < m_settings.propagationSteps; ++step) {
+            propagateStep();
+        }
+        for (uint8_t active : m_tileActive) {
+            m_stats.activeTiles += active;
+        }
+        m_stats.propagationMs = elapsedMs(start);
+    }
+
+    void InfluenceMap::activateTileAt(int cell) {
+        int x = cell % m_settings.width;
+        int z = cell / m_settings.width;
+        m_tileActive[(z / kTileSize) * m_tilesX + x / kTileSize] = 1;
+    }
+
+    void InfluenceMap::restampSources() {
+        // Only tiles whose source values actually change need to propagate
+        m_stampedValues.clear();
+        for (uint32_t cell : m_stampedCells) {
+            m_stampedValues.push_back(m_sourceValue[cell]);
+            m_sourceValue[cell] = 0.0f;
+        }
+        size_t oldCount = m_stampedCells.size();
+
+        for (size_t slot = 0; slot < m_sources.size(); ++slot) {
+            const ThreatSource& source = m_sources[slot];
+            if (!m_sourceActive[slot] || source.cell < 0 || m_blocked[source.cell]) continue;
+            float& value = m_sourceValue[source.cell];
+            if (value == 0.0f) {
+                m_stampedCells.push_back(static_cast<uint32_t>(source.cell));
+            }
+            value = std::max(value, source.strength);
+        }
+
+        for (size_t i = 0; i < oldCount; ++i) {
+            if (m_sourceValue[m_stampedCells[i]] != m_stampedValues[i]) activateTileAt(static_cast<int>(m_stampedCells[i]));
+        }
+        size_t kept = 0;
+        for (size_t i = 0; i < m_stampedCells.size(); ++i) {
+            uint32_t cell = m_stampedCells[i];
+            if (m_sourceValue[cell] == 0.0f) continue;
+            // Cells stamped for the first time were 0 before
+            if (i >= oldCount) activateTileAt(static_cast<int>(cell));
+            m_stampedCells[kept++] = cell;
+        }
+        m_stampedCells.resize(kept);
+        m_sourcesDirty = false;
+    }
+
+    void InfluenceMap::clearVisibility(ThreatSource& source) {
+        for (uint32_t cell : source.visibleCells) {
+            if (--m_visibilityCount[cell] == 0) {
+                m_visibility[cell] = 0.0f;
+            } else {
+                m_visibility[cell] = std::max(m_visibility[cell] - source.visibleStrength, 0.0f);
+            }
+        }
+        source.visibleCells.clear();
+        source.visibleStrength = 0.0f;
+    }
+
+    void InfluenceMap::refreshVisibility(ThreatSource& source) {
+        clearVisibility(source);
+        source.visibilityDirty = false;
+        if (source.strength <= 0.0f || source.sightRange <= 0.0f) return;
+
+        // Cells within sight range of the source's cell centre, as one batch of rays
+        if (source.cell < 0) return;
+        const float cellSize = m_settings.cellSize;
+        const glm::vec3 origin = getCellCenter(source.cell);
+        const glm::vec3 eye = origin + glm::vec3(0.0f, m_settings.eyeHeight, 0.0f);
+        const float rangeSq = source.sightRange * source.sightRange;
+        int minX = std::max(static_cast<int>(std::floor((origin.x - source.sightRange - m_settings.origin.x) / cellSize)), 0);
+        int maxX = std::min(static_cast<int>(std::floor((origin.x + source.sightRange - m_settings.origin.x) / cellSize)),
+                            m_settings.width - 1);
+        int minZ = std::max(static_cast<int>(std::floor((origin.z - source.sightRange - m_settings.origin.z) / cellSize)), 0);
+        int maxZ = std::min(static_cast<int>(std::floor((origin.z + source.sightRange - m_settings.origin.z) / cellSize)),
+                            m_settings.height - 1);
+
+        m_rayFrom.clear();
+        m_rayTo.clear();
+        std::vector<uint32_t>& cells = source.visibleCells;
+        for (int z = minZ; z <= maxZ; ++z) {
+            for (int x = minX; x <= maxX; ++x) {
+                int cell = z * m_settings.width + x;
+                if (m_blocked[cell]) continue;
+                glm::vec3 center = getCellCenter(cell);
+                float dx = center.x - origin.x;
+                float dz = center.z - origin.z;
+                if (dx * dx + dz * dz > rangeSq) continue;
+                cells.push_back(static_cast<uint32_t>(cell));
+                m_rayFrom.push_back(eye);
+                m_rayTo.push_back(center + glm::vec3(0.0f, m_settings.targetHeight, 0.0f));
+            }
+        }
+
+        m_rayOccluded.assign(cells.size(), 0);
+        if (m_occluders && !cells.empty()) {
+            m_occluders->isOccludedBatch(m_rayFrom.data(), m_rayTo.data(), cells.size(), m_rayOccluded.data(), m_jobSystem);
+        }
+        m_stats.visibilityRays += cells.size();
+
+        size_t visible = 0;
+        for (size_t i = 0; i < cells.size(); ++i) {
+            if (m_rayOccluded[i]) continue;
+            uint32_t cell = cells[i];
+            cells[visible++] = cell;
+            ++m_visibilityCount[cell];
+            m_visibility[cell] += source.strength;
+        }
+        cells.resize(visible);
+        source.visibleStrength = source.strength;
+    }
+
+    void InfluenceMap::propagateTile(uint32_t tile) {
+        const int width = m_settings.width;
+        const int height = m_settings.height;
+        const float keep = m_settings.threatMomentum;
+        const int x0 = static_cast<int>(tile % m_tilesX) * kTileSize;
+        const int z0 = static_cast<int>(tile / m_tilesX) * kTileSize;
+        const int x1 = std::min(x0 + kTileSize, width);
+        const int z1 = std::min(z0 + kTileSize, height);
+
+        float delta = 0.0f;
+        for (int z = z0; z < z1; ++z) {
+            for (int x = x0; x < x1; ++x) {
+                int cell = z * width + x;
+                float current = m_threat[cell];
+                float value = 0.0f;
+                if (!m_blocked[cell]) {
+                    // Strongest influence reaching this cell from itself or a neighbour
+                    float best = m_sourceValue[cell];
+                    if (x > 0 && z > 0 && x < width - 1 && z < height - 1) {
+                        const float* above = &m_threat[cell - width];
+                        const float* row = &m_threat[cell];
+                        const float* below = &m_threat[cell + width];
+                        float edge = std::max(std::max(above[0], below[0]), std::max(row[-1], row[1]));
+                        float diagonal = std::max(std::max(above[-1], above[1]), std::max(below[-1], below[1]));
+                        best = std::max(best, std::max(edge * m_edgeFalloff, diagonal * m_diagonalFalloff));
+                    } else {
+                        for (int dz = -1; dz <= 1; ++dz) {
+                            int nz = z + dz;
+                            if (nz < 0 || nz >= height) continue;
+                            for (int dx = -1; dx <= 1; ++dx) {
+                                int nx = x + dx;
+                                if ((dx == 0 && dz == 0) || nx < 0 || nx >= width) continue;
+                                float falloff = dx != 0 && dz != 0 ? m_diagonalFalloff : m_edgeFalloff;
+                                best = std::max(best, m_threat[nz * width + nx] * falloff);
+                            }
+                        }
+                    }
+                    value = best + (current - best) * keep;
+                    if (value < kThreatFloor) value = 0.0f;
+                }
+                m_threatNext[cell] = value;
+                delta = std::max(delta, std::abs(value - current));
+            }
+        }
+        m_tileDelta[tile] = delta;
+    }
+
+    void InfluenceMap::propagateStep() {
+        m_tileList.clear();
+        for (size_t tile = 0; tile < m_tileActive.size(); ++tile) {
+            if (m_tileActive[tile]) m_tileList.push_back(static_cast<uint32_t>(tile));
+        }
+        if (m_tileList.empty()) return;
+
+        // Every active tile reads m_threat and writes its own cells of m_threatNext
+        if (m_jobSystem && m_jobSystem->getWorkerCount() > 0) {
+            m_jobSystem->parallelFor(m_tileList.size(), 4, [this](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    propagateTile(m_tileList[i]);
+                }
+            });
+        } else {
+            for (uint32_t tile : m_tileList) {
+                propagateTile(tile);
+            }
+        }
+
+        const int width = m_settings.width;
+        std::fill(m_tileActive.begin(), m_tileActive.end(), 0);
+        for (uint32_t tile : m_tileList) {
+            int tileX = static_cast<int>(tile % m_tilesX);
+            int tileZ = static_cast<int>(tile / m_tilesX);
+            int x0 = tileX * kTileSize;
+            int rowLength = std::min(x0 + kTileSize, width) - x0;
+            int z1 = std::min((tileZ + 1) * kTileSize, m_settings.height);
+            for (int z = tileZ * kTileSize; z < z1; ++z) {
+                size_t offset = static_cast<size_t>(z) * width + x0;
+                std::memcpy(&m_threat[offset], &m_threatNext[offset], rowLength * sizeof(float));
+            }
+
+            if (m_tileDelta[tile] <= kSettleDelta) continue;
+            for (int nz = std::max(tileZ - 1, 0); nz <= std::min(tileZ + 1, m_tilesZ - 1); ++nz) {
+                for (int nx = std::max(tileX - 1, 0); nx <= std::min(tileX + 1, m_tilesX - 1); ++nx) {
+                    m_tileActive[nz * m_tilesX + nx] = 1;
+                }
+            }
+        }
+        m_stats.tilesPropagated += static_cast<int>(m_tileList.size());
+    }
+
+    float InfluenceMap::sample(InfluenceLayer layer, const glm::vec3& position) const {
+        int cell = getCell(position);
+        if (cell < 0) return 0.0f;
+        switch (layer) {
+            case InfluenceLayer::THREAT:
+                return m_threat[cell];
+            case InfluenceLayer::VISIBILITY:
+                return m_visibility[cell];
+            case InfluenceLayer::COVER:
+                return static_cast<float>(popCount(m_coverMask[cell])) / 8.0f;
+        }
+        return 0.0f;
+    }
+
+    bool InfluenceMap::isBlocked(const glm::vec3& position) const {
+        int cell = getCell(position);
+        return cell >= 0 && m_blocked[cell] != 0;
+    }
+
+    uint8_t InfluenceMap::getCoverMask(const glm::vec3& position) const {
+        int cell = getCell(position);
+        return cell >= 0 ? m_coverMask[cell] : 0;
+    }
+
+    bool InfluenceMap::hasCoverFrom(const glm::vec3& position, const glm::vec3& threat) const {
+        int cell = getCell(position);
+        if (cell < 0) return false;
+        return (m_coverMask[cell] >> probeIndex(threat.x - position.x, threat.z - position.z)) & 1;
+    }
+
+    glm::vec3 InfluenceMap::getCellCenter(int cell) const {
+        int x = cell % m_settings.width;
+        int z = cell / m_settings.width;
+        return m_settings.origin + glm::vec3((x + 0.5f) * m_settings.cellSize, 0.0f, (z + 0.5f) * m_settings.cellSize);
+    }
+
+    int InfluenceMap::getCell(const glm::vec3& position) const {
+        float fx = (position.x - m_settings.origin.x) / m_settings.cellSize;
+        float fz = (position.z - m_settings.origin.z) / m_settings.cellSize;
+        if (!(fx >= 0.0f && fz >= 0.0f)) return -1;
+        int x = static_cast<int>(fx);
+        int z = static_cast<int>(fz);
+        if (x >= m_settings.width || z >= m_settings.height) return -1;
+        return z * m_settings.width + x;
+    }
+
+    void InfluenceMap::gatherInputs(TacticalConsideration consideration, const TacticalQuery& query,
+                                    const glm::vec3* positions, const int* cells, size_t count, float* inputs) const {
+        const float inverseRadius = query.radius > 0.0f ? 1.0f / query.radius : 0.0f;
+        switch (consideration) {
+            case TacticalConsideration::THREAT:
+                for (size_t i = 0; i < count; ++i) inputs[i] = m_threat[cells[i]];
+                break;
+            case TacticalConsideration::VISIBILITY:
+                for (size_t i = 0; i < count; ++i) inputs[i] = std::min(m_visibility[cells[i]], 1.0f);
+                break;
+            case TacticalConsideration::COVER:
+                for (size_t i = 0; i < count; ++i) {
+                    uint8_t mask = m_coverMask[cells[i]];
+                    if (query.hasTarget) {
+                        int k = probeIndex(query.target.x - positions[i].x, query.target.z - positions[i].z);
+                        inputs[i] = static_cast<float>((mask >> k) & 1);
+                    } else {
+                        inputs[i] = static_cast<float>(popCount(mask)) / 8.0f;
+                    }
+                }
+                break;
+            case TacticalConsideration::DISTANCE_TO_SELF:
+            case TacticalConsideration::DISTANCE_TO_TARGET: {
+                if (consideration == TacticalConsideration::DISTANCE_TO_TARGET && !query.hasTarget) {
+                    std::fill(inputs, inputs + count, 0.0f);
+                    break;
+                }
+                const glm::vec3& from = consideration == TacticalConsideration::DISTANCE_TO_SELF ? query.self : query.target;
+                for (size_t i = 0; i < count; ++i) {
+                    float dx = positions[i].x - from.x;
+                    float dz = positions[i].z - from.z;
+                    inputs[i] = std::min(std::sqrt(dx * dx + dz * dz) * inverseRadius, 1.0f);
+                }
+                break;
+            }
+            case TacticalConsideration::FLANK_ANGLE: {
+                if (!query.hasTarget) {
+                    std::fill(inputs, inputs + count, 0.0f);
+                    break;
+                }
+                float ax = query.self.x - query.target.x;
+                float az = query.self.z - query.target.z;
+                float lengthA = std::sqrt(ax * ax + az * az);
+                for (size_t i = 0; i < count; ++i) {
+                    float bx = positions[i].x - query.target.x;
+                    float bz = positions[i].z - query.target.z;
+                    float lengths = lengthA * std::sqrt(bx * bx + bz * bz);
+                    float cosine = lengths > 0.0f ? (ax * bx + az * bz) / lengths : 1.0f;
+                    inputs[i] = std::acos(std::min(std::max(cosine, -1.0f), 1.0f)) / kPi;
+                }
+                break;
+            }
+            case TacticalConsideration::COUNT:
+                break;
+        }
+    }
+
+    void InfluenceMap::scoreBatch(const TacticalQuery& query, const glm::vec3* positions, const int* cells, size_t count,
+                                  float* scores) const {
+        float inputs[kBatchSize];
+        float outputs[kBatchSize];
+        float weightSum = 0.0f;
+        std::fill(scores, scores + count, 0.0f);
+        for (int c = 0; c < static_cast<int>(TacticalConsideration::COUNT); ++c) {
+            float weight = query.weights[c];
+            if (weight <= 0.0f) continue;
+            weightSum += weight;
+            gatherInputs(static_cast<TacticalConsideration>(c), query, positions, cells, count, inputs);
+            query.curves[c].evaluate(inputs, outputs, count);
+            for (size_t i = 0; i < count; ++i) {
+                scores[i] += weight * outputs[i];
+            }
+        }
+        float normalize = weightSum > 0.0f ? 1.0f / weightSum : 0.0f;
+        for (size_t i = 0; i < count; ++i) {
+            scores[i] *= normalize;
+        }
+    }
+
+    void InfluenceMap::scorePositions(const TacticalQuery& query, const glm::vec3* positions, size_t count, float* scores) const {
+        int cells[kBatchSize];
+        glm::vec3 valid[kBatchSize];
+        float validScores[kBatchSize];
+        size_t slot[kBatchSize];
+        for (size_t begin = 0; begin < count; begin += kBatchSize) {
+            size_t end = std::min(begin + kBatchSize, count);
+            size_t batchCount = 0;
+            for (size_t i = begin; i < end; ++i) {
+                int cell = getCell(positions[i]);
+                scores[i] = 0.0f;
+                if (cell < 0 || m_blocked[cell]) continue;
+                cells[batchCount] = cell;
+                valid[batchCount] = positions[i];
+                slot[batchCount++] = i;
+            }
+            scoreBatch(query, valid, cells, batchCount, validScores);
+            for (size_t i = 0; i < batchCount; ++i) {
+                scores[slot[i]] = validScores[i];
+            }
+        }
+    }
+
+    bool InfluenceMap::findBest(const TacticalQuery& query, bool coverOnly, glm::vec3& result, float* score) const {
+        const float cellSize = m_settings.cellSize;
+        const float radiusSq = query.radius * query.radius;
+        int minX = std::max(static_cast<int>(std::floor((query.self.x - query.radius - m_settings.origin.x) / cellSize)), 0);
+        int maxX = std::min(static_cast<int>(std::floor((query.self.x + query.radius - m_settings.origin.x) / cellSize)),
+                            m_settings.width - 1);
+        int minZ = std::max(static_cast<int>(std::floor((query.self.z - query.radius - m_settings.origin.z) / cellSize)), 0);
+        int maxZ = std::min(static_cast<int>(std::floor((query.self.z + query.radius - m_settings.origin.z) / cellSize)),
+                            m_settings.height - 1);
+
+        int cells[kBatchSize];
+        glm::vec3 positions[kBatchSize];
+        float scores[kBatchSize];
+        size_t batchCount = 0;
+        float bestScore = 0.0f;
+        bool found = false;
+
+        auto flush = [&]() {
+            scoreBatch(query, positions, cells, batchCount, scores);
+            for (size_t i = 0; i < batchCount; ++i) {
+                if (scores[i] > bestScore) {
+                    bestScore = scores[i];
+                    result = positions[i];
+                    found = true;
+                }
+            }
+            batchCount = 0;
+        };
+
+        for (int z = minZ; z <= maxZ; ++z) {
+            for (int x = minX; x <= maxX; ++x) {
+                int cell = z * m_settings.width + x;
+                if (m_blocked[cell]) continue;
+                glm::vec3 center = getCellCenter(cell);
+                float dx = center.x - query.self.x;
+                float dz = center.z - query.self.z;
+                if (dx * dx + dz * dz > radiusSq) continue;
+                if (coverOnly) {
+                    int k = probeIndex(query.target.x - center.x, query.target.z - center.z);
+                    if (!((m_coverMask[cell] >> k) & 1)) continue;
+                }
+                cells[batchCount] = cell;
+                positions[batchCount++] = glm::vec3(center.x, query.self.y, center.z);
+                if (batchCount == kBatchSize) flush();
+            }
+        }
+        if (batchCount > 0) flush();
+
+        if (score) *score = bestScore;
+        return found;
+    }
+
+    bool InfluenceMap::findBestPosition(const TacticalQuery& query, glm::vec3& result, float* score) const {
+        return findBest(query, false, result, score);
+    }
+
+    bool InfluenceMap::findCoverPosition(const glm::vec3& self, const glm::vec3& threat, float radius, glm::vec3& result) const {
+        return findBest(TacticalQuery::cover(self, threat, radius), true, result, nullptr);
+    }
+
+    bool InfluenceMap::findFlankPosition(const glm::vec3& self, const glm::vec3& target, float radius, glm::vec3& result) const {
+        return findBest(TacticalQuery::flank(self, target, radius), false, result, nullptr);
+    }
+}
@@ -18,7 +18,7 @@ namespace Sparky {
 
     InputManager::InputManager() : mouseX(0), mouseY(0), prevMouseX(0), prevMouseY(0), 
                                  scrollX(0), scrollY(0), prevScrollX(0), prevScrollY(0),
-                                 window(nullptr), cursorMode(0) {
+                                 window(nullptr), cursorMode(0), playbackEnabled(false) {
         memset(keys, 0, sizeof(keys));
         memset(prevKeys, 0, sizeof(prevKeys));
         memset(mouseButtons, 0, sizeof(mouseButtons));
@@ -99,9 +99,41 @@ namespace Sparky {
 #endif
     }
 
+    void InputManager::captureFrame(InputFrame& frame) const {
+        memset(frame.keys, 0, sizeof(frame.keys));
+        for (int key = 0; key < KEY_COUNT; ++key) {
+            if (keys[key]) {
+                frame.keys[key >> 5] |= 1u << (key & 31);
+            }
+        }
+        frame.mouseButtons = 0;
+        for (int button = 0; button < MOUSE_BUTTON_COUNT; ++button) {
+            if (mouseButtons[button]) {
+                frame.mouseButtons |= static_cast<uint8_t>(1u << button);
+            }
+        }
+        frame.mouseX = mouseX;
+        frame.mouseY = mouseY;
+        frame.scrollX = scrollX;
+        frame.scrollY = scrollY;
+    }
+
+    void InputManager::applyFrame(const InputFrame& frame) {
+        for (int key = 0; key < KEY_COUNT; ++key) {
+            keys[key] = (frame.keys[key >> 5] >> (key & 31)) & 1u;
+        }
+        for (int button = 0; button < MOUSE_BUTTON_COUNT; ++button) {
+            mouseButtons[button] = (frame.mouseButtons >> button) & 1u;
+        }
+        mouseX = frame.mouseX;
+        mouseY = frame.mouseY;
+        scrollX = frame.scrollX;
+        scrollY = frame.scrollY;
+    }
+
     void InputManager::keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
 #ifdef HAS_GLFW
-        if (instance && key >= 0 && key < KEY_COUNT) {
+        if (instance && !instance->playbackEnabled && key >= 0 && key < KEY_COUNT) {
             if (action == 0x00040001) { // GLFW_PRESS
                 instance->keys[key] = true;
             } else if (action == 0x00040002) { // GLFW_RELEASE
@@ -112,7 +144,7 @@ namespace Sparky {
     }
 
     void InputManager::mouseCallback(GLFWwindow* window, double xpos, double ypos) {
-        if (instance) {
+        if (instance && !instance->playbackEnabled) {
             instance->mouseX = static_cast<float>(xpos);
             instance->mouseY = static_cast<float>(ypos);
         }
@@ -120,7 +152,7 @@ namespace Sparky {
 
     void InputManager::mouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
 #ifdef HAS_GLFW
-        if (instance && button >= 0 && button < MOUSE_BUTTON_COUNT) {
+        if (instance && !instance->playbackEnabled && button >= 0 && button < MOUSE_BUTTON_COUNT) {
             if (action == 0x00040001) { // GLFW_PRESS
                 instance->mouseButtons[button] = true;
             } else if (action == 0x00040002) { // GLFW_RELEASE
@@ -131,7 +163,7 @@ namespace Sparky {
     }
 
     void InputManager::scrollCallback(GLFWwindow* window, double xoffset, double yoffset) {
-        if (instance) {
+        if (instance && !instance->playbackEnabled) {
             instance->scrollX += static_cast<float>(xoffset);
             instance->scrollY += static_cast<float>(yoffset);
         }
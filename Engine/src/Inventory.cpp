@@ -1,11 +1,17 @@
 #include "../include/Inventory.h"
 #include "../include/FileUtils.h"
 #include "../include/Logger.h"
+#include "../include/SaveArchive.h"
 #include <fstream>
 #include <sstream>
 
 namespace Sparky {
 
+    namespace {
+        const uint32_t kInventoryChunk = SaveArchive::makeChunkId('I', 'N', 'V', 'T');
+        const uint16_t kInventoryChunkVersion = 1;
+    }
+
     // Item implementation
     Item::Item(const std::string& name, int maxStack) : 
         name(name), maxStack(maxStack), quantity(1) {
@@ -163,28 +169,30 @@ namespace Sparky {
     bool Inventory::saveToFile(const std::string& filepath) {
         SPARKY_LOG_DEBUG("Saving inventory to file: " + filepath);
         
-        try {
-            std::ofstream file(filepath);
-            if (!file.is_open()) {
-                SPARKY_LOG_ERROR("Failed to open inventory file for writing: " + filepath);
-                return false;
-            }
-
-            file << size << "\n";
-            
-            for (size_t i = 0; i < items.size(); i++) {
-                if (items[i]) {
-                    file << i << " " << items[i]->getName() << " " << items[i]->getQuantity() << " " << items[i]->getMaxStack() << "\n";
-                }
+        BinaryWriter writer;
+        writer.writeI32(size);
+        size_t countPosition = writer.reserveU32();
+        uint32_t itemCount = 0;
+        for (size_t i = 0; i < items.size(); i++) {
+            if (items[i]) {
+                writer.writeU32(static_cast<uint32_t>(i));
+                writer.writeString(items[i]->getName());
+                writer.writeI32(items[i]->getQuantity());
+                writer.writeI32(items[i]->getMaxStack());
+                itemCount++;
             }
-            
-            file.close();
-            SPARKY_LOG_DEBUG("Inventory saved successfully");
-            return true;
-        } catch (const std::exception& e) {
-            SPARKY_LOG_ERROR("Failed to save inventory: " + std::string(e.what()));
+        }
+        writer.patchU32(countPosition, itemCount);
+        
+        SaveArchive archive;
+        archive.setChunk(kInventoryChunk, kInventoryChunkVersion, writer);
+        if (!archive.saveToFile(filepath)) {
+            SPARKY_LOG_ERROR("Failed to save inventory: " + filepath);
             return false;
         }
+        
+        SPARKY_LOG_DEBUG("Inventory saved successfully");
+        return true;
     }
 
     bool Inventory::loadFromFile(const std::string& filepath) {
@@ -197,6 +205,11 @@ namespace Sparky {
             }
 
             std::vector<char> data = FileUtils::readFile(filepath);
+            if (SaveArchive::isArchive(data)) {
+                return readArchive(data);
+            }
+            
+            // Text format written before the save archive
             std::string content(data.begin(), data.end());
             
             std::istringstream iss(content);
@@ -242,4 +255,43 @@ namespace Sparky {
             return false;
         }
     }
+
+    bool Inventory::readArchive(const std::vector<char>& data) {
+        SaveArchive archive;
+        const SaveChunk* chunk = archive.decode(data) ? archive.getChunk(kInventoryChunk) : nullptr;
+        if (!chunk || chunk->version > kInventoryChunkVersion) {
+            SPARKY_LOG_ERROR("Invalid inventory save archive");
+            return false;
+        }
+        
+        BinaryReader reader(chunk->data);
+        int32_t loadedSize = 0;
+        uint32_t itemCount = 0;
+        if (!reader.readI32(loadedSize) || loadedSize < 0 || !reader.readU32(itemCount)) {
+            SPARKY_LOG_ERROR("Invalid inventory file format");
+            return false;
+        }
+        
+        items.clear();
+        size = loadedSize;
+        items.resize(size);
+        
+        for (uint32_t i = 0; i < itemCount; i++) {
+            uint32_t index = 0;
+            std::string name;
+            int32_t quantity = 0, maxStack = 0;
+            if (!reader.readU32(index) || !reader.readString(name) || !reader.readI32(quantity) || !reader.readI32(maxStack)) {
+                SPARKY_LOG_ERROR("Invalid inventory item data");
+                return false;
+            }
+            if (index < static_cast<uint32_t>(size)) {
+                auto item = std::make_unique<Item>(name, maxStack);
+                item->setQuantity(quantity);
+                items[index] = std::move(item);
+            }
+        }
+        
+        SPARKY_LOG_DEBUG("Inventory loaded successfully");
+        return true;
+    }
 }
\ No newline at end of file
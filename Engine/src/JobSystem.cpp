@@ -0,0 +1,468 @@
+#include "../include/JobSystem.h"
+#include "../include/Logger.h"
+#include <algorithm>
+
+namespace Sparky {
+
+    struct JobRecord {
+        Job function;
+        JobCounter* counter;
+        const char* name;
+    };
+
+    namespace {
+        // Identifies which worker (of which job system) the current thread is
+        thread_local const JobSystem* t_ownerSystem = nullptr;
+        thread_local int t_workerIndex = -1;
+
+        const char* const kUnnamedJob = "Job";
+    }
+
+    // JobCounter implementation
+    JobCounter::~JobCounter() {
+        // Continuations only remain if the counter never reached zero
+        for (JobRecord* job : m_continuations) {
+            delete job;
+        }
+    }
+
+    // WorkStealingDeque implementation
+    WorkStealingDeque::Buffer::Buffer(int64_t size)
+        : capacity(size)
+        , mask(size - 1)
+        , slots(new std::atomic<JobRecord*>[static_cast<size_t>(size)]) {
+        for (int64_t i = 0; i < size; ++i) {
+            slots[i].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    WorkStealingDeque::WorkStealingDeque(int64_t capacity)
+        : m_top(0)
+        , m_bottom(0) {
+        // Capacity must be a power of two for the index mask
+        int64_t size = 1;
+        while (size < capacity) size <<= 1;
+
+        m_buffers.push_back(std::make_unique<Buffer>(size));
+        m_buffer.store(m_buffers.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque::~WorkStealingDeque() {
+    }
+
+    void WorkStealingDeque::push(JobRecord* job) {
+        int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+        int64_t top = m_top.load(std::memory_order_acquire);
+        Buffer* buffer = m_buffer.load(std::memory_order_relaxed);
+
+        if (bottom - top > buffer->capacity - 1) {
+            // Grow; the old buffer is kept because a thief may still be reading it
+            auto grown = std::make_unique<Buffer>(buffer->capacity * 2);
+            for (int64_t i = top; i < bottom; ++i) {
+                grown->put(i, buffer->get(i));
+            }
+            buffer = grown.get();
+            m_buffers.push_back(std::move(grown));
+            m_buffer.store(buffer, std::memory_order_release);
+        }
+
+        buffer->put(bottom, job);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+
+    JobRecord* WorkStealingDeque::pop() {
+        int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+        Buffer* buffer = m_buffer.load(std::memory_order_relaxed);
+        m_bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = m_top.load(std::memory_order_relaxed);
+
+        if (top > bottom) {
+            // Empty
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        JobRecord* job = buffer->get(bottom);
+        if (top == bottom) {
+            // Last element - race thieves for it
+            if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                job = nullptr;
+            }
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    JobRecord* WorkStealingDeque::steal() {
+        int64_t top = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t bottom = m_bottom.load(std::memory_order_acquire);
+
+        if (top >= bottom) return nullptr;
+
+        Buffer* buffer = m_buffer.load(std::memory_order_acquire);
+        JobRecord* job = buffer->get(top);
+        if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            // Lost the race to another thief or the owner
+            return nullptr;
+        }
+        return job;
+    }
+
+    bool WorkStealingDeque::empty() const {
+        int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+        int64_t top = m_top.load(std::memory_order_relaxed);
+        return bottom <= top;
+    }
+
+    // JobSystem implementation
+    JobSystem::JobSystem() : m_running(false), m_queuedJobs(0), m_ioJobsExecuted(0) {
+    }
+
+    // Constructor for dependency injection
+    JobSystem::JobSystem(unsigned int workerCount, unsigned int ioThreadCount)
+        : m_running(false), m_queuedJobs(0), m_ioJobsExecuted(0) {
+        initialize(workerCount, ioThreadCount);
+    }
+
+    JobSystem::~JobSystem() {
+        shutdown();
+    }
+
+    // Singleton instance accessor
+    JobSystem& JobSystem::getInstance() {
+        static JobSystem instance;
+        return instance;
+    }
+
+    // Factory method for dependency injection
+    std::unique_ptr<JobSystem> JobSystem::create(unsigned int workerCount, unsigned int ioThreadCount) {
+        return std::make_unique<JobSystem>(workerCount, ioThreadCount);
+    }
+
+    void JobSystem::initialize(unsigned int workerCount, unsigned int ioThreadCount) {
+        if (m_running) return;
+
+        if (workerCount == 0) {
+            unsigned int hardwareThreads = std::thread::hardware_concurrency();
+            workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+        }
+
+        m_running = true;
+        for (unsigned int i = 0; i < workerCount; ++i) {
+            m_workers.push_back(std::make_unique<Worker>());
+        }
+        for (unsigned int i = 0; i < workerCount; ++i) {
+            m_workers[i]->thread = std::thread(&JobSystem::workerLoop, this, i);
+        }
+        for (unsigned int i = 0; i < ioThreadCount; ++i) {
+            m_ioThreads.emplace_back(&JobSystem::ioLoop, this);
+        }
+
+        SPARKY_LOG_DEBUG("JobSystem started with " + std::to_string(workerCount) + " workers and " +
+                         std::to_string(ioThreadCount) + " I/O threads");
+    }
+
+    void JobSystem::shutdown() {
+        if (!m_running) return;
+
+        {
+            std::lock_guard<std::mutex> sleepLock(m_sleepMutex);
+            std::lock_guard<std::mutex> ioLock(m_ioMutex);
+            m_running = false;
+        }
+        m_wakeCondition.notify_all();
+        m_ioCondition.notify_all();
+
+        for (auto& worker : m_workers) {
+            if (worker->thread.joinable()) {
+                worker->thread.join();
+            }
+        }
+        for (auto& thread : m_ioThreads) {
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+
+        // Drain anything that was queued after the threads stopped
+        for (auto& worker : m_workers) {
+            while (JobRecord* job = worker->deque.steal()) {
+                execute(job, -1);
+            }
+        }
+        while (JobRecord* job = takeInjected()) {
+            execute(job, -1);
+        }
+        for (JobRecord* job : m_ioQueue) {
+            execute(job, -1);
+        }
+
+        m_ioQueue.clear();
+        m_ioThreads.clear();
+        m_workers.clear();
+        m_queuedJobs = 0;
+    }
+
+    int JobSystem::getCurrentWorkerIndex() const {
+        return t_ownerSystem == this ? t_workerIndex : -1;
+    }
+
+    void JobSystem::run(Job job, JobCounter* counter, const char* name) {
+        if (counter) {
+            counter->m_pending.fetch_add(1, std::memory_order_relaxed);
+        }
+        submit(new JobRecord{std::move(job), counter, name ? name : kUnnamedJob});
+    }
+
+    void JobSystem::wait(JobCounter& counter) {
+        while (!counter.isDone()) {
+            if (!tryRunPendingJob()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void JobSystem::runAfter(JobCounter& dependency, Job job, JobCounter* counter, const char* name) {
+        if (counter) {
+            counter->m_pending.fetch_add(1, std::memory_order_relaxed);
+        }
+        JobRecord* record = new JobRecord{std::move(job), counter, name ? name : kUnnamedJob};
+
+        {
+            std::lock_guard<std::mutex> lock(dependency.m_continuationMutex);
+            if (dependency.m_pending.load(std::memory_order_acquire) > 0) {
+                dependency.m_continuations.push_back(record);
+                return;
+            }
+        }
+
+        // Dependency already satisfied
+        submit(record);
+    }
+
+    void JobSystem::runIO(Job job, JobCounter* counter, const char* name) {
+        if (counter) {
+            counter->m_pending.fetch_add(1, std::memory_order_relaxed);
+        }
+        JobRecord* record = new JobRecord{std::move(job), counter, name ? name : kUnnamedJob};
+
+        if (m_ioThreads.empty()) {
+            execute(record, getCurrentWorkerIndex());
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_ioMutex);
+            m_ioQueue.push_back(record);
+        }
+        m_ioCondition.notify_one();
+    }
+
+    void JobSystem::parallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& body) {
+        if (count == 0) return;
+
+        if (grainSize == 0) {
+            // Roughly eight ranges per thread gives stealing room to balance uneven work
+            size_t threads = m_workers.size() + 1;
+            grainSize = std::max<size_t>(1, count / (threads * 8));
+        }
+
+        if (m_workers.empty() || count <= grainSize) {
+            body(0, count);
+            return;
+        }
+
+        JobCounter counter;
+        parallelForRange(0, count, grainSize, body, counter);
+        wait(counter);
+    }
+
+    void JobSystem::parallelForRange(size_t begin, size_t end, size_t grainSize,
+                                     const std::function<void(size_t, size_t)>& body, JobCounter& counter) {
+        // Split off the upper half until the range fits the grain; thieves take the
+        // big halves first and split them further on their own worker
+        while (end - begin > grainSize) {
+            size_t middle = begin + (end - begin) / 2;
+            run([this, middle, end, grainSize, &body, &counter]() {
+                parallelForRange(middle, end, grainSize, body, counter);
+            }, &counter, "parallelFor");
+            end = middle;
+        }
+        body(begin, end);
+    }
+
+    JobSystemStats JobSystem::getStats() const {
+        JobSystemStats stats{};
+        for (const auto& worker : m_workers) {
+            stats.jobsExecuted += worker->jobsExecuted.load(std::memory_order_relaxed);
+            stats.jobsStolen += worker->jobsStolen.load(std::memory_order_relaxed);
+            stats.workerSleeps += worker->sleeps.load(std::memory_order_relaxed);
+        }
+        stats.ioJobsExecuted = m_ioJobsExecuted.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    void JobSystem::resetStats() {
+        for (auto& worker : m_workers) {
+            worker->jobsExecuted = 0;
+            worker->jobsStolen = 0;
+            worker->sleeps = 0;
+        }
+        m_ioJobsExecuted = 0;
+    }
+
+    void JobSystem::workerLoop(unsigned int workerIndex) {
+        t_ownerSystem = this;
+        t_workerIndex = static_cast<int>(workerIndex);
+
+        while (true) {
+            if (JobRecord* job = findJob(static_cast<int>(workerIndex))) {
+                execute(job, static_cast<int>(workerIndex));
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(m_sleepMutex);
+            if (!m_running) break;
+            if (m_queuedJobs.load(std::memory_order_acquire) <= 0) {
+                m_workers[workerIndex]->sleeps.fetch_add(1, std::memory_order_relaxed);
+                m_wakeCondition.wait(lock, [this]() {
+                    return !m_running || m_queuedJobs.load(std::memory_order_acquire) > 0;
+                });
+            }
+            if (!m_running) break;
+        }
+
+        t_ownerSystem = nullptr;
+        t_workerIndex = -1;
+    }
+
+    void JobSystem::ioLoop() {
+        while (true) {
+            JobRecord* job = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(m_ioMutex);
+                m_ioCondition.wait(lock, [this]() { return !m_running || !m_ioQueue.empty(); });
+                if (m_ioQueue.empty()) break;
+                job = m_ioQueue.front();
+                m_ioQueue.pop_front();
+            }
+            execute(job, -1);
+            m_ioJobsExecuted.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void JobSystem::submit(JobRecord* job) {
+        if (m_workers.empty()) {
+            // No workers - execute inline so callers never deadlock
+            execute(job, -1);
+            return;
+        }
+
+        int workerIndex = getCurrentWorkerIndex();
+        if (workerIndex >= 0) {
+            m_workers[workerIndex]->deque.push(job);
+        } else {
+            std::lock_guard<std::mutex> lock(m_injectionMutex);
+            m_injectionQueue.push_back(job);
+        }
+
+        {
+            // Publish under the sleep mutex so a worker can't miss the wake-up
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+            m_queuedJobs.fetch_add(1, std::memory_order_release);
+        }
+        m_wakeCondition.notify_one();
+    }
+
+    JobRecord* JobSystem::findJob(int workerIndex) {
+        JobRecord* job = nullptr;
+        if (workerIndex >= 0) {
+            job = m_workers[workerIndex]->deque.pop();
+        }
+        if (!job) {
+            job = takeInjected();
+        }
+        if (!job) {
+            job = stealJob(workerIndex);
+            if (job && workerIndex >= 0) {
+                m_workers[workerIndex]->jobsStolen.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        if (job) {
+            m_queuedJobs.fetch_sub(1, std::memory_order_acq_rel);
+        }
+        return job;
+    }
+
+    JobRecord* JobSystem::takeInjected() {
+        std::lock_guard<std::mutex> lock(m_injectionMutex);
+        if (m_injectionQueue.empty()) return nullptr;
+
+        JobRecord* job = m_injectionQueue.front();
+        m_injectionQueue.pop_front();
+        return job;
+    }
+
+    JobRecord* JobSystem::stealJob(int thiefIndex) {
+        size_t workerCount = m_workers.size();
+        size_t start = thiefIndex >= 0 ? static_cast<size_t>(thiefIndex) + 1 : 0;
+
+        for (size_t offset = 0; offset < workerCount; ++offset) {
+            size_t victim = (start + offset) % workerCount;
+            if (static_cast<int>(victim) == thiefIndex) continue;
+
+            if (JobRecord* job = m_workers[victim]->deque.steal()) {
+                return job;
+            }
+        }
+        return nullptr;
+    }
+
+    bool JobSystem::tryRunPendingJob() {
+        if (m_workers.empty()) return false;
+
+        int workerIndex = getCurrentWorkerIndex();
+        JobRecord* job = findJob(workerIndex);
+        if (job) {
+            execute(job, workerIndex);
+        }
+        return job != nullptr;
+    }
+
+    void JobSystem::execute(JobRecord* job, int workerIndex) {
+        if (m_hooks.onJobBegin) m_hooks.onJobBegin(job->name, workerIndex);
+        if (job->function) {
+            job->function();
+        }
+        if (m_hooks.onJobEnd) m_hooks.onJobEnd(job->name, workerIndex);
+
+        if (workerIndex >= 0) {
+            m_workers[workerIndex]->jobsExecuted.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        JobCounter* counter = job->counter;
+        delete job;
+        finishJob(counter);
+    }
+
+    void JobSystem::finishJob(JobCounter* counter) {
+        if (!counter) return;
+
+        // m_finishing keeps waiters from destroying the counter while we still touch it
+        counter->m_finishing.fetch_add(1, std::memory_order_acq_rel);
+        if (counter->m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::vector<JobRecord*> continuations;
+            {
+                std::lock_guard<std::mutex> lock(counter->m_continuationMutex);
+                continuations.swap(counter->m_continuations);
+            }
+            for (JobRecord* continuation : continuations) {
+                submit(continuation);
+            }
+        }
+        counter->m_finishing.fetch_sub(1, std::memory_order_release);
+    }
+}
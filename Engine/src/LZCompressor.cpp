@@ -0,0 +1,161 @@
+#include "../include/LZCompressor.h"
+#include <cstdint>
+#include <cstring>
+
+namespace Sparky {
+
+    namespace {
+        const int kHashBits = 14;
+        const size_t kMinMatch = 4;
+        const size_t kMaxOffset = 65535;
+        // Matches never start in the last 12 bytes or run into the last 5,
+        // so the final sequence is always a literal run
+        const size_t kMatchStartMargin = 12;
+        const size_t kLastLiterals = 5;
+
+        inline uint32_t read32(const char* p) {
+            uint32_t value;
+            std::memcpy(&value, p, sizeof(value));
+            return value;
+        }
+
+        inline uint32_t hash4(uint32_t sequence) {
+            return (sequence * 2654435761u) >> (32 - kHashBits);
+        }
+
+        void writeLength(std::vector<char>& output, size_t length) {
+            while (length >= 255) {
+                output.push_back(static_cast<char>(255));
+                length -= 255;
+            }
+            output.push_back(static_cast<char>(length));
+        }
+
+        void emitSequence(std::vector<char>& output, const char* literals, size_t literalLength,
+                          size_t offset, size_t matchLength) {
+            size_t matchCode = matchLength >= kMinMatch ? matchLength - kMinMatch : 0;
+            uint8_t token = static_cast<uint8_t>((literalLength >= 15 ? 15 : literalLength) << 4);
+            if (offset != 0) {
+                token |= static_cast<uint8_t>(matchCode >= 15 ? 15 : matchCode);
+            }
+            output.push_back(static_cast<char>(token));
+
+            if (literalLength >= 15) {
+                writeLength(output, literalLength - 15);
+            }
+            output.insert(output.end(), literals, literals + literalLength);
+
+            if (offset != 0) {
+                output.push_back(static_cast<char>(offset & 0xFF));
+                output.push_back(static_cast<char>((offset >> 8) & 0xFF));
+                if (matchCode >= 15) {
+                    writeLength(output, matchCode - 15);
+                }
+            }
+        }
+
+        bool readLength(const uint8_t*& ip, const uint8_t* end, size_t& length) {
+            uint8_t byte;
+            do {
+                if (ip >= end) return false;
+                byte = *ip++;
+                length += byte;
+            } while (byte == 255);
+            return true;
+        }
+
+        bool decodeBlock(const char* data, size_t size, char* const outBegin, char* const outEnd) {
+            char* op = outBegin;
+
+            const uint8_t* ip = reinterpret_cast<const uint8_t*>(data);
+            const uint8_t* const end = ip + size;
+
+            while (ip < end) {
+                uint8_t token = *ip++;
+
+                size_t literalLength = token >> 4;
+                if (literalLength == 15 && !readLength(ip, end, literalLength)) return false;
+                if (literalLength > static_cast<size_t>(end - ip) || literalLength > static_cast<size_t>(outEnd - op)) {
+                    return false;
+                }
+                if (literalLength > 0) {
+                    std::memcpy(op, ip, literalLength);
+                }
+                ip += literalLength;
+                op += literalLength;
+
+                // The last sequence has no match
+                if (ip == end) break;
+
+                if (end - ip < 2) return false;
+                size_t offset = static_cast<size_t>(ip[0]) | (static_cast<size_t>(ip[1]) << 8);
+                ip += 2;
+                if (offset == 0 || offset > static_cast<size_t>(op - outBegin)) return false;
+
+                size_t matchLength = token & 0x0F;
+                if (matchLength == 15 && !readLength(ip, end, matchLength)) return false;
+                matchLength += kMinMatch;
+                if (matchLength > static_cast<size_t>(outEnd - op)) return false;
+
+                // Byte copy: overlapping matches (offset < length) repeat the pattern
+                const char* match = op - offset;
+                if (offset >= matchLength) {
+                    std::memcpy(op, match, matchLength);
+                } else {
+                    for (size_t i = 0; i < matchLength; ++i) op[i] = match[i];
+                }
+                op += matchLength;
+            }
+
+            return op == outEnd;
+        }
+    }
+
+    void LZCompressor::compress(const char* data, size_t size, std::vector<char>& output) {
+        output.reserve(output.size() + maxCompressedSize(size));
+
+        size_t anchor = 0;
+        if (size > kMatchStartMargin) {
+            // Positions are stored +1 so zero means empty
+            std::vector<uint32_t> table(static_cast<size_t>(1) << kHashBits, 0);
+            const size_t matchLimit = size - kMatchStartMargin;
+            const size_t extendLimit = size - kLastLiterals;
+
+            size_t i = 0;
+            while (i < matchLimit) {
+                uint32_t sequence = read32(data + i);
+                uint32_t& slot = table[hash4(sequence)];
+                size_t candidate = slot;
+                slot = static_cast<uint32_t>(i + 1);
+
+                if (candidate == 0 || i - (candidate - 1) > kMaxOffset || read32(data + candidate - 1) != sequence) {
+                    ++i;
+                    continue;
+                }
+                candidate -= 1;
+
+                size_t matchLength = kMinMatch;
+                while (i + matchLength < extendLimit && data[candidate + matchLength] == data[i + matchLength]) {
+                    ++matchLength;
+                }
+
+                emitSequence(output, data + anchor, i - anchor, i - candidate, matchLength);
+                i += matchLength;
+                anchor = i;
+            }
+        }
+
+        // Trailing literals
+        emitSequence(output, data + anchor, size - anchor, 0, 0);
+    }
+
+    bool LZCompressor::decompress(const char* data, size_t size, size_t expectedSize, std::vector<char>& output) {
+        size_t base = output.size();
+        output.resize(base + expectedSize);
+        if (!decodeBlock(data, size, output.data() + base, output.data() + base + expectedSize)) {
+            output.resize(base);
+            return false;
+        }
+        return true;
+    }
+}
@@ -261,9 +261,11 @@ namespace Sparky {
         // Move the object
         auto& objects = const_cast<std::vector<LevelObject>&>(currentLevel->getLevelObjects());
         if (selectedObjectIndex < static_cast<int>(objects.size())) {
+            notifyAreaChange(objects[selectedObjectIndex]);
             objects[selectedObjectIndex].position[0] = x;
             objects[selectedObjectIndex].position[1] = y;
             objects[selectedObjectIndex].position[2] = z;
+            notifyAreaChange(objects[selectedObjectIndex]);
             
             action.objectData = objects[selectedObjectIndex];
             recordAction(action);
@@ -291,9 +293,11 @@ namespace Sparky {
         // Rotate the object
         auto& objects = const_cast<std::vector<LevelObject>&>(currentLevel->getLevelObjects());
         if (selectedObjectIndex < static_cast<int>(objects.size())) {
+            notifyAreaChange(objects[selectedObjectIndex]);
             objects[selectedObjectIndex].rotation[0] = x;
             objects[selectedObjectIndex].rotation[1] = y;
             objects[selectedObjectIndex].rotation[2] = z;
+            notifyAreaChange(objects[selectedObjectIndex]);
             
             action.objectData = objects[selectedObjectIndex];
             recordAction(action);
@@ -321,9 +325,11 @@ namespace Sparky {
         // Scale the object
         auto& objects = const_cast<std::vector<LevelObject>&>(currentLevel->getLevelObjects());
         if (selectedObjectIndex < static_cast<int>(objects.size())) {
+            notifyAreaChange(objects[selectedObjectIndex]);
             objects[selectedObjectIndex].scale[0] = x;
             objects[selectedObjectIndex].scale[1] = y;
             objects[selectedObjectIndex].scale[2] = z;
+            notifyAreaChange(objects[selectedObjectIndex]);
             
             action.objectData = objects[selectedObjectIndex];
             recordAction(action);
@@ -373,6 +379,7 @@ namespace Sparky {
         
         // Add object to level
         const_cast<std::vector<LevelObject>&>(currentLevel->getLevelObjects()).push_back(obj);
+        notifyAreaChange(obj);
         
         // Notify callback
         if (onObjectModifyCallback) {
@@ -480,6 +487,7 @@ namespace Sparky {
         
         // Remove object from level
         auto& objects = const_cast<std::vector<LevelObject>&>(currentLevel->getLevelObjects());
+        notifyAreaChange(objects[index]);
         objects.erase(objects.begin() + index);
         
         // Adjust selection
@@ -517,6 +525,7 @@ namespace Sparky {
             case EditorAction::CREATE_OBJECT:
                 // Remove the created object
                 if (action.objectIndex < currentLevel->getLevelObjects().size()) {
+                    notifyAreaChange(currentLevel->getLevelObjects()[action.objectIndex]);
                     const_cast<std::vector<LevelObject>&>(currentLevel->getLevelObjects()).erase(
                         const_cast<std::vector<LevelObject>&>(currentLevel->getLevelObjects()).begin() + action.objectIndex);
                 }
@@ -527,6 +536,7 @@ namespace Sparky {
                 const_cast<std::vector<LevelObject>&>(currentLevel->getLevelObjects()).insert(
                     const_cast<std::vector<LevelObject>&>(currentLevel->getLevelObjects()).begin() + action.objectIndex,
                     action.objectData);
+                notifyAreaChange(action.objectData);
                 break;
                 
             case EditorAction::MODIFY_OBJECT:
@@ -535,7 +545,9 @@ namespace Sparky {
             case EditorAction::SCALE_OBJECT:
                 // Restore previous object state
                 if (action.objectIndex < currentLevel->getLevelObjects().size()) {
+                    notifyAreaChange(currentLevel->getLevelObjects()[action.objectIndex]);
                     const_cast<std::vector<LevelObject>&>(currentLevel->getLevelObjects())[action.objectIndex] = action.previousObjectData;
+                    notifyAreaChange(action.previousObjectData);
                 }
                 break;
         }
@@ -570,11 +582,13 @@ namespace Sparky {
                 const_cast<std::vector<LevelObject>&>(currentLevel->getLevelObjects()).insert(
                     const_cast<std::vector<LevelObject>&>(currentLevel->getLevelObjects()).begin() + action.objectIndex,
                     action.objectData);
+                notifyAreaChange(action.objectData);
                 break;
                 
             case EditorAction::DELETE_OBJECT:
                 // Delete the object again
                 if (action.objectIndex < currentLevel->getLevelObjects().size()) {
+                    notifyAreaChange(currentLevel->getLevelObjects()[action.objectIndex]);
                     const_cast<std::vector<LevelObject>&>(currentLevel->getLevelObjects()).erase(
                         const_cast<std::vector<LevelObject>&>(currentLevel->getLevelObjects()).begin() + action.objectIndex);
                 }
@@ -586,7 +600,9 @@ namespace Sparky {
             case EditorAction::SCALE_OBJECT:
                 // Apply object state
                 if (action.objectIndex < currentLevel->getLevelObjects().size()) {
+                    notifyAreaChange(currentLevel->getLevelObjects()[action.objectIndex]);
                     const_cast<std::vector<LevelObject>&>(currentLevel->getLevelObjects())[action.objectIndex] = action.objectData;
+                    notifyAreaChange(action.objectData);
                 }
                 break;
         }
@@ -645,6 +661,7 @@ namespace Sparky {
             
             // Add duplicated object to level
             const_cast<std::vector<LevelObject>&>(currentLevel->getLevelObjects()).push_back(original);
+            notifyAreaChange(original);
             
             // Select the new object
             selectedObjectIndex = static_cast<int>(currentLevel->getLevelObjects().size()) - 1;
@@ -685,6 +702,7 @@ namespace Sparky {
         
         // Add pasted object to level
         const_cast<std::vector<LevelObject>&>(currentLevel->getLevelObjects()).push_back(clipboardObject);
+        notifyAreaChange(clipboardObject);
         
         // Select the new object
         selectedObjectIndex = static_cast<int>(currentLevel->getLevelObjects().size()) - 1;
@@ -818,6 +836,21 @@ namespace Sparky {
         redoStack.clear();
     }
     
+    void LevelEditor::notifyAreaChange(const LevelObject& object) {
+        if (!onAreaChangeCallback) return;
+        
+        // Bounding sphere of the scaled unit cube, so any rotation fits
+        float halfExtent = 0.5f * std::sqrt(object.scale[0] * object.scale[0] +
+                                            object.scale[1] * object.scale[1] +
+                                            object.scale[2] * object.scale[2]);
+        EditorChangeBounds bounds;
+        for (int axis = 0; axis < 3; ++axis) {
+            bounds.min[axis] = object.position[axis] - halfExtent;
+            bounds.max[axis] = object.position[axis] + halfExtent;
+        }
+        onAreaChangeCallback(bounds);
+    }
+    
     void LevelEditor::clearUndoStack() {
         undoStack.clear();
         redoStack.clear();
@@ -30,6 +30,7 @@ namespace Sparky {
 
     void Logger::log(LogLevel level, const std::string& message) {
         if (static_cast<int>(level) >= static_cast<int>(currentLevel)) {
+            std::lock_guard<std::mutex> lock(logMutex);
             std::time_t now = std::time(nullptr);
             std::tm* localTime = std::localtime(&now);
             
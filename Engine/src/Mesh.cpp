@@ -1,5 +1,6 @@
 #include "../include/Mesh.h"
 #include "../include/Logger.h"
+#include <algorithm>
 #include <cmath>
 
 // Define M_PI if it's not already defined
@@ -59,7 +60,8 @@ namespace Sparky {
                tangent == other.tangent && bitangent == other.bitangent;
     }
 
-    Mesh::Mesh() : vertexBuffer(nullptr), vertexBufferMemory(nullptr), 
+    Mesh::Mesh() : boundsMin(0.0f), boundsMax(0.0f), boundsCenter(0.0f), boundsRadius(0.0f),
+                  vertexBuffer(nullptr), vertexBufferMemory(nullptr), 
                   indexBuffer(nullptr), indexBufferMemory(nullptr) {
     }
 
@@ -88,6 +90,29 @@ namespace Sparky {
         }
     }
 
+    void Mesh::computeBounds() {
+        if (vertices.empty()) {
+            boundsMin = boundsMax = boundsCenter = glm::vec3(0.0f);
+            boundsRadius = 0.0f;
+            return;
+        }
+
+        boundsMin = boundsMax = vertices[0].position;
+        for (const Vertex& vertex : vertices) {
+            boundsMin = glm::min(boundsMin, vertex.position);
+            boundsMax = glm::max(boundsMax, vertex.position);
+        }
+
+        // Sphere around the box centre, tightened to the furthest vertex
+        boundsCenter = (boundsMin + boundsMax) * 0.5f;
+        float radiusSquared = 0.0f;
+        for (const Vertex& vertex : vertices) {
+            glm::vec3 offset = vertex.position - boundsCenter;
+            radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+        }
+        boundsRadius = std::sqrt(radiusSquared);
+    }
+
     std::unique_ptr<Mesh> Mesh::createCube(float size) {
         auto mesh = std::make_unique<Mesh>();
         
@@ -142,6 +167,7 @@ namespace Sparky {
             20, 21, 22, 22, 23, 20    // Left
         };
         
+        mesh->computeBounds();
         return mesh;
     }
 
@@ -164,6 +190,7 @@ namespace Sparky {
             0, 1, 2, 2, 3, 0
         };
         
+        mesh->computeBounds();
         return mesh;
     }
 
@@ -224,6 +251,7 @@ namespace Sparky {
             }
         }
         
+        mesh->computeBounds();
         return mesh;
     }
 
@@ -243,6 +271,7 @@ namespace Sparky {
             0, 1, 2, 2, 3, 0
         };
         
+        mesh->computeBounds();
         return mesh;
     }
 }
\ No newline at end of file
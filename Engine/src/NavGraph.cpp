@@ -0,0 +1,351 @@
+#include "../include/NavGraph.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Sparky {
+
+    // NavGraph implementation
+    NavGraph::NavGraph() : m_minCostMultiplier(1.0f) {
+        m_edgeOffsets.push_back(0);
+    }
+
+    void NavGraph::clear() {
+        m_positions.clear();
+        m_walkable.clear();
+        m_edgeOffsets.assign(1, 0);
+        m_edgeTargets.clear();
+        m_edgeCosts.clear();
+        m_minCostMultiplier = 1.0f;
+    }
+
+    void NavGraph::build(const std::vector<glm::vec3>& positions, const std::vector<float>& costs,
+                         const std::vector<bool>& walkable, const std::vector<Edge>& edges) {
+        const int nodeCount = static_cast<int>(positions.size());
+        m_positions = positions;
+        m_walkable.assign(positions.size(), 1);
+        std::vector<float> multipliers(positions.size(), 1.0f);
+
+        m_minCostMultiplier = std::numeric_limits<float>::max();
+        for (int i = 0; i < nodeCount; ++i) {
+            if (i < static_cast<int>(walkable.size()) && !walkable[i]) {
+                m_walkable[i] = 0;
+            }
+            if (i < static_cast<int>(costs.size()) && costs[i] > 0.0f) {
+                multipliers[i] = costs[i];
+            }
+            m_minCostMultiplier = std::min(m_minCostMultiplier, multipliers[i]);
+        }
+        if (nodeCount == 0) {
+            m_minCostMultiplier = 1.0f;
+        }
+
+        // Counting sort of the edges by source node, then dedupe each row
+        std::vector<uint32_t> counts(positions.size() + 1, 0);
+        for (const auto& edge : edges) {
+            if (edge.from >= 0 && edge.from < nodeCount && edge.to >= 0 && edge.to < nodeCount && edge.from != edge.to) {
+                ++counts[edge.from + 1];
+            }
+        }
+        for (int i = 0; i < nodeCount; ++i) {
+            counts[i + 1] += counts[i];
+        }
+
+        std::vector<int> targets(counts[nodeCount]);
+        std::vector<uint32_t> cursor(counts.begin(), counts.end() - 1);
+        for (const auto& edge : edges) {
+            if (edge.from >= 0 && edge.from < nodeCount && edge.to >= 0 && edge.to < nodeCount && edge.from != edge.to) {
+                targets[cursor[edge.from]++] = edge.to;
+            }
+        }
+
+        m_edgeOffsets.assign(positions.size() + 1, 0);
+        m_edgeTargets.clear();
+        m_edgeCosts.clear();
+        m_edgeTargets.reserve(targets.size());
+        m_edgeCosts.reserve(targets.size());
+        for (int i = 0; i < nodeCount; ++i) {
+            auto rowBegin = targets.begin() + counts[i];
+            auto rowEnd = targets.begin() + counts[i + 1];
+            std::sort(rowBegin, rowEnd);
+            rowEnd = std::unique(rowBegin, rowEnd);
+            for (auto it = rowBegin; it != rowEnd; ++it) {
+                m_edgeTargets.push_back(*it);
+                m_edgeCosts.push_back(glm::distance(positions[i], positions[*it]) * multipliers[*it]);
+            }
+            m_edgeOffsets[i + 1] = static_cast<uint32_t>(m_edgeTargets.size());
+        }
+    }
+
+    // NavSpatialGrid implementation
+    NavSpatialGrid::NavSpatialGrid()
+        : m_origin(0.0f)
+        , m_cellSize(1.0f)
+        , m_inverseCellSize(1.0f)
+        , m_width(0)
+        , m_height(0) {
+    }
+
+    void NavSpatialGrid::clear() {
+        m_width = 0;
+        m_height = 0;
+        m_cellStart.clear();
+        m_cellNodes.clear();
+    }
+
+    int NavSpatialGrid::cellX(float x) const {
+        int cell = static_cast<int>(std::floor((x - m_origin.x) * m_inverseCellSize));
+        return std::min(std::max(cell, 0), m_width - 1);
+    }
+
+    int NavSpatialGrid::cellZ(float z) const {
+        int cell = static_cast<int>(std::floor((z - m_origin.y) * m_inverseCellSize));
+        return std::min(std::max(cell, 0), m_height - 1);
+    }
+
+    void NavSpatialGrid::build(const NavGraph& graph, float cellSize) {
+        clear();
+
+        glm::vec2 minBounds(std::numeric_limits<float>::max());
+        glm::vec2 maxBounds(-std::numeric_limits<float>::max());
+        // Blocked nodes are indexed too and skipped at query time, so
+        // NavGraph::setWalkable() does not need a rebuild
+        const int nodeCount = graph.getNodeCount();
+        for (int i = 0; i < nodeCount; ++i) {
+            const glm::vec3& position = graph.getPosition(i);
+            minBounds = glm::min(minBounds, glm::vec2(position.x, position.z));
+            maxBounds = glm::max(maxBounds, glm::vec2(position.x, position.z));
+        }
+        if (nodeCount == 0) {
+            return;
+        }
+
+        glm::vec2 extent = glm::max(maxBounds - minBounds, glm::vec2(1e-3f));
+        if (cellSize <= 0.0f) {
+            cellSize = std::sqrt(extent.x * extent.y * 2.0f / static_cast<float>(nodeCount));
+            cellSize = std::max(cellSize, 1e-3f);
+        }
+
+        // Keep the cell count proportional to the node count for degenerate layouts
+        const float maxCells = static_cast<float>(nodeCount) * 4.0f + 16.0f;
+        while ((extent.x / cellSize + 1.0f) * (extent.y / cellSize + 1.0f) > maxCells) {
+            cellSize *= 2.0f;
+        }
+
+        m_origin = minBounds;
+        m_cellSize = cellSize;
+        m_inverseCellSize = 1.0f / cellSize;
+        m_width = static_cast<int>(extent.x * m_inverseCellSize) + 1;
+        m_height = static_cast<int>(extent.y * m_inverseCellSize) + 1;
+
+        std::vector<int> nodeCells(graph.getNodeCount(), -1);
+        m_cellStart.assign(static_cast<size_t>(m_width) * m_height + 1, 0);
+        for (int i = 0; i < nodeCount; ++i) {
+            const glm::vec3& position = graph.getPosition(i);
+            nodeCells[i] = cellZ(position.z) * m_width + cellX(position.x);
+            ++m_cellStart[nodeCells[i] + 1];
+        }
+        for (size_t cell = 1; cell < m_cellStart.size(); ++cell) {
+            m_cellStart[cell] += m_cellStart[cell - 1];
+        }
+
+        m_cellNodes.resize(m_cellStart.back());
+        std::vector<uint32_t> cursor(m_cellStart.begin(), m_cellStart.end() - 1);
+        for (int i = 0; i < graph.getNodeCount(); ++i) {
+            if (nodeCells[i] >= 0) {
+                m_cellNodes[cursor[nodeCells[i]]++] = i;
+            }
+        }
+    }
+
+    int NavSpatialGrid::findNearest(const NavGraph& graph, const glm::vec3& position) const {
+        if (m_width == 0) {
+            return -1;
+        }
+
+        const int centerX = cellX(position.x);
+        const int centerZ = cellZ(position.z);
+        const int maxRing = std::max(m_width, m_height);
+
+        int best = -1;
+        float bestDistanceSq = std::numeric_limits<float>::max();
+
+        for (int ring = 0; ring <= maxRing; ++ring) {
+            // Cells in this ring or beyond are at least this far away in XZ
+            // (also for query points outside the grid, which clamp to the border)
+            if (ring > 0) {
+                float ringDistance = (ring - 1) * m_cellSize;
+                if (ringDistance * ringDistance > bestDistanceSq) {
+                    break;
+                }
+            }
+
+            const int minX = centerX - ring, maxX = centerX + ring;
+            const int minZ = centerZ - ring, maxZ = centerZ + ring;
+            for (int z = std::max(minZ, 0); z <= std::min(maxZ, m_height - 1); ++z) {
+                const bool edgeRow = z == minZ || z == maxZ;
+                const int step = edgeRow ? 1 : maxX - minX;
+                for (int x = minX; x <= maxX; x += (step > 0 ? step : 1)) {
+                    if (x < 0 || x >= m_width) continue;
+                    const int cell = z * m_width + x;
+                    for (uint32_t i = m_cellStart[cell]; i < m_cellStart[cell + 1]; ++i) {
+                        if (!graph.isWalkable(m_cellNodes[i])) continue;
+                        glm::vec3 offset = graph.getPosition(m_cellNodes[i]) - position;
+                        float distanceSq = glm::dot(offset, offset);
+                        if (distanceSq < bestDistanceSq) {
+                            bestDistanceSq = distanceSq;
+                            best = m_cellNodes[i];
+                        }
+                    }
+                }
+            }
+        }
+        return best;
+    }
+
+    // AStarSearch implementation
+    AStarSearch::AStarSearch() : m_generation(0), m_pathCost(0.0f), m_stats{} {
+    }
+
+    void AStarSearch::prepare(int nodeCount) {
+        if (static_cast<int>(m_nodes.size()) < nodeCount) {
+            m_nodes.resize(nodeCount, NodeState{0, 0.0f, -1, -1});
+        }
+        m_heap.clear();
+        if (++m_generation == 0) {
+            // Wrapped: stale stamps could now look current
+            for (auto& node : m_nodes) {
+                node.generation = 0;
+            }
+            m_generation = 1;
+        }
+    }
+
+    void AStarSearch::siftUp(int index) {
+        HeapEntry entry = m_heap[index];
+        while (index > 0) {
+            int parent = (index - 1) >> 1;
+            if (m_heap[parent].fCost <= entry.fCost) break;
+            m_heap[index] = m_heap[parent];
+            m_nodes[m_heap[index].node].heapIndex = index;
+            index = parent;
+        }
+        m_heap[index] = entry;
+        m_nodes[entry.node].heapIndex = index;
+    }
+
+    void AStarSearch::siftDown(int index) {
+        const int count = static_cast<int>(m_heap.size());
+        HeapEntry entry = m_heap[index];
+        while (true) {
+            int child = index * 2 + 1;
+            if (child >= count) break;
+            if (child + 1 < count && m_heap[child + 1].fCost < m_heap[child].fCost) {
+                ++child;
+            }
+            if (entry.fCost <= m_heap[child].fCost) break;
+            m_heap[index] = m_heap[child];
+            m_nodes[m_heap[index].node].heapIndex = index;
+            index = child;
+        }
+        m_heap[index] = entry;
+        m_nodes[entry.node].heapIndex = index;
+    }
+
+    void AStarSearch::heapPush(int node, float fCost) {
+        m_heap.push_back({fCost, node});
+        siftUp(static_cast<int>(m_heap.size()) - 1);
+    }
+
+    int AStarSearch::heapPop() {
+        int node = m_heap[0].node;
+        m_nodes[node].heapIndex = -1;
+        HeapEntry last = m_heap.back();
+        m_heap.pop_back();
+        if (!m_heap.empty()) {
+            m_heap[0] = last;
+            siftDown(0);
+        }
+        return node;
+    }
+
+    void AStarSearch::heapDecrease(int node, float fCost) {
+        int index = m_nodes[node].heapIndex;
+        m_heap[index].fCost = fCost;
+        siftUp(index);
+    }
+
+    bool AStarSearch::findPath(const NavGraph& graph, int start, int goal, std::vector<int>& path) {
+        return search(graph, start, goal, path, [](int) { return true; });
+    }
+
+    bool AStarSearch::findPathInRegion(const NavGraph& graph, int start, int goal, const std::vector<int>& nodeRegions,
+                                       int region, std::vector<int>& path) {
+        if (start < 0 || start >= static_cast<int>(nodeRegions.size()) ||
+            goal < 0 || goal >= static_cast<int>(nodeRegions.size()) ||
+            nodeRegions[start] != region || nodeRegions[goal] != region) {
+            path.clear();
+            m_stats = PathSearchStats{};
+            m_pathCost = 0.0f;
+            return false;
+        }
+        return search(graph, start, goal, path, [&nodeRegions, region](int node) {
+            return nodeRegions[node] == region;
+        });
+    }
+
+    template <typename NodeFilter>
+    bool AStarSearch::search(const NavGraph& graph, int start, int goal, std::vector<int>& path, NodeFilter allowed) {
+        path.clear();
+        m_stats = PathSearchStats{};
+        m_pathCost = 0.0f;
+
+        const int nodeCount = graph.getNodeCount();
+        if (start < 0 || start >= nodeCount || goal < 0 || goal >= nodeCount ||
+            !graph.isWalkable(start) || !graph.isWalkable(goal)) {
+            return false;
+        }
+
+        prepare(nodeCount);
+        const uint32_t generation = m_generation;
+
+        NodeState& startState = m_nodes[start];
+        startState = NodeState{generation, 0.0f, -1, -1};
+        heapPush(start, graph.heuristic(start, goal));
+        m_stats.nodesTouched = 1;
+
+        while (!m_heap.empty()) {
+            const int current = heapPop();
+            ++m_stats.nodesExpanded;
+
+            if (current == goal) {
+                m_pathCost = m_nodes[goal].gCost;
+                for (int node = goal; node != -1; node = m_nodes[node].parent) {
+                    path.push_back(node);
+                }
+                std::reverse(path.begin(), path.end());
+                return true;
+            }
+
+            const float currentCost = m_nodes[current].gCost;
+            for (uint32_t edge = graph.getEdgeBegin(current); edge < graph.getEdgeEnd(current); ++edge) {
+                const int neighbor = graph.getEdgeTarget(edge);
+                if (!graph.isWalkable(neighbor) || !allowed(neighbor)) continue;
+
+                const float cost = currentCost + graph.getEdgeCost(edge);
+                NodeState& state = m_nodes[neighbor];
+                if (state.generation != generation) {
+                    state = NodeState{generation, cost, current, -1};
+                    heapPush(neighbor, cost + graph.heuristic(neighbor, goal));
+                    ++m_stats.nodesTouched;
+                } else if (state.heapIndex >= 0 && cost < state.gCost) {
+                    state.gCost = cost;
+                    state.parent = current;
+                    heapDecrease(neighbor, cost + graph.heuristic(neighbor, goal));
+                }
+                // Closed nodes are final: the heuristic is consistent
+            }
+        }
+        return false;
+    }
+}
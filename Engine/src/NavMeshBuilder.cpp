@@ -0,0 +1,1443 @@
+#include "../include/NavMeshBuilder.h"
+#include "../include/JobSystem.h"
+#include "../include/Mesh.h"
+#include "../include/Scene.h"
+#include "../include/GameObject.h"
+#include "../include/RenderComponent.h"
+#include "../include/FileUtils.h"
+#include "../include/Logger.h"
+#include "../include/TimingUtils.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <unordered_map>
+
+namespace Sparky {
+
+    namespace {
+        // Neighbour offsets per direction: -X, +Z, +X, -Z
+        const int kDirX[4] = {-1, 0, 1, 0};
+        const int kDirZ[4] = {0, 1, 0, -1};
+
+        const uint8_t kNotConnected = 0xff;
+        const int kMaxSpanHeight = 0xffff;
+        const int kRasterBandRows = 16;
+        const int kMaxDetailSamples = 32;
+
+        // Bump when the builder's output for the same input changes, so old caches rebuild
+        const uint32_t kBuilderVersion = 1;
+
+        // --- Heightfield -------------------------------------------------------
+
+        struct Span {
+            uint16_t smin;
+            uint16_t smax;
+            uint8_t area; // 1 walkable, 0 not
+            int next;
+        };
+
+        // Solid heightfield. Columns are grouped into bands of rows that each own
+        // a span pool, so bands can be rasterized in parallel without locking.
+        struct Heightfield {
+            int width;
+            int height;
+            glm::vec3 bmin;
+            glm::vec3 bmax;
+            float cs;
+            float ch;
+            std::vector<int> columns; // First span per column, in its band's pool
+            std::vector<std::vector<Span>> bands;
+            std::vector<int> freeSpans;
+
+            std::vector<Span>& pool(int z) { return bands[z / kRasterBandRows]; }
+            const std::vector<Span>& pool(int z) const { return bands[z / kRasterBandRows]; }
+        };
+
+        // Inserts a span, merging it with any span it overlaps (rcAddSpan)
+        void addSpan(std::vector<Span>& pool, int& freeSpan, int& head, int smin, int smax, uint8_t area,
+                     int mergeThreshold) {
+            Span span = {static_cast<uint16_t>(smin), static_cast<uint16_t>(smax), area, -1};
+            int previous = -1;
+            int current = head;
+            while (current != -1) {
+                Span& existing = pool[current];
+                if (existing.smin > span.smax) {
+                    break;
+                }
+                if (existing.smax < span.smin) {
+                    previous = current;
+                    current = existing.next;
+                    continue;
+                }
+
+                span.smin = std::min(span.smin, existing.smin);
+                span.smax = std::max(span.smax, existing.smax);
+                if (std::abs(static_cast<int>(span.smax) - static_cast<int>(existing.smax)) <= mergeThreshold) {
+                    span.area = std::max(span.area, existing.area);
+                }
+
+                int next = existing.next;
+                existing.next = freeSpan;
+                freeSpan = current;
+                if (previous != -1) pool[previous].next = next; else head = next;
+                current = next;
+            }
+
+            int index;
+            if (freeSpan != -1) {
+                index = freeSpan;
+                freeSpan = pool[index].next;
+            } else {
+                index = static_cast<int>(pool.size());
+                pool.push_back(span);
+            }
+            span.next = current;
+            pool[index] = span;
+            if (previous != -1) pool[previous].next = index; else head = index;
+        }
+
+        // Splits a convex polygon along an axis-aligned plane (rcDividePoly).
+        // below gets the part with coordinate <= value, above the rest.
+        void dividePoly(const glm::vec3* in, int inCount, glm::vec3* below, int& belowCount,
+                        glm::vec3* above, int& aboveCount, float value, int axis) {
+            float d[12];
+            for (int i = 0; i < inCount; ++i) {
+                d[i] = value - in[i][axis];
+            }
+
+            belowCount = 0;
+            aboveCount = 0;
+            for (int i = 0, j = inCount - 1; i < inCount; j = i, ++i) {
+                bool inA = d[j] >= 0.0f;
+                bool inB = d[i] >= 0.0f;
+                if (inA != inB) {
+                    float s = d[j] / (d[j] - d[i]);
+                    glm::vec3 point = in[j] + (in[i] - in[j]) * s;
+                    below[belowCount++] = point;
+                    above[aboveCount++] = point;
+                    if (d[i] > 0.0f) {
+                        below[belowCount++] = in[i];
+                    } else if (d[i] < 0.0f) {
+                        above[aboveCount++] = in[i];
+                    }
+                } else {
+                    if (d[i] >= 0.0f) {
+                        below[belowCount++] = in[i];
+                        if (d[i] != 0.0f) continue;
+                    }
+                    above[aboveCount++] = in[i];
+                }
+            }
+        }
+
+        // Voxelizes the part of a triangle that falls in rows [rowBegin, rowEnd)
+        void rasterizeTriangle(const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2, uint8_t area,
+                               Heightfield& hf, int rowBegin, int rowEnd, int& freeSpan, int mergeThreshold) {
+            const float inverseCs = 1.0f / hf.cs;
+            const float inverseCh = 1.0f / hf.ch;
+            const float heightRange = hf.bmax.y - hf.bmin.y;
+
+            glm::vec3 buffers[4][12];
+            glm::vec3* in = buffers[0];
+            glm::vec3* row = buffers[1];
+            glm::vec3* cell = buffers[2];
+            glm::vec3* rest = buffers[3];
+            in[0] = v0;
+            in[1] = v1;
+            in[2] = v2;
+            int inCount = 3;
+
+            float minZ = std::min(v0.z, std::min(v1.z, v2.z));
+            float maxZ = std::max(v0.z, std::max(v1.z, v2.z));
+            int z0 = static_cast<int>((minZ - hf.bmin.z) * inverseCs);
+            int z1 = static_cast<int>((maxZ - hf.bmin.z) * inverseCs);
+            if (z1 < rowBegin || z0 >= rowEnd) {
+                return;
+            }
+            if (z0 < rowBegin) {
+                // Drop the part owned by the bands below
+                int restCount = 0;
+                dividePoly(in, inCount, rest, restCount, row, inCount, hf.bmin.z + rowBegin * hf.cs, 2);
+                std::swap(in, row);
+                z0 = rowBegin;
+            }
+            z1 = std::min(z1, rowEnd - 1);
+
+            for (int z = z0; z <= z1 && inCount >= 3; ++z) {
+                const float cellZ = hf.bmin.z + z * hf.cs;
+                int rowCount = 0;
+                dividePoly(in, inCount, row, rowCount, rest, inCount, cellZ + hf.cs, 2);
+                std::swap(in, rest);
+                if (rowCount < 3) continue;
+
+                float minX = row[0].x, maxX = row[0].x;
+                for (int i = 1; i < rowCount; ++i) {
+                    minX = std::min(minX, row[i].x);
+                    maxX = std::max(maxX, row[i].x);
+                }
+                int x0 = std::max(static_cast<int>((minX - hf.bmin.x) * inverseCs), 0);
+                int x1 = std::min(static_cast<int>((maxX - hf.bmin.x) * inverseCs), hf.width - 1);
+
+                for (int x = x0; x <= x1 && rowCount >= 3; ++x) {
+                    const float cellX = hf.bmin.x + x * hf.cs;
+                    int cellCount = 0;
+                    dividePoly(row, rowCount, cell, cellCount, rest, rowCount, cellX + hf.cs, 0);
+                    std::swap(row, rest);
+                    if (cellCount < 3) continue;
+
+                    float smin = cell[0].y, smax = cell[0].y;
+                    for (int i = 1; i < cellCount; ++i) {
+                        smin = std::min(smin, cell[i].y);
+                        smax = std::max(smax, cell[i].y);
+                    }
+                    smin -= hf.bmin.y;
+                    smax -= hf.bmin.y;
+                    if (smax < 0.0f || smin > heightRange) continue;
+                    smin = std::max(smin, 0.0f);
+                    smax = std::min(smax, heightRange);
+
+                    int spanMin = std::min(std::max(static_cast<int>(std::floor(smin * inverseCh)), 0), kMaxSpanHeight);
+                    int spanMax = std::min(std::max(static_cast<int>(std::ceil(smax * inverseCh)), spanMin + 1), kMaxSpanHeight);
+                    addSpan(hf.pool(z), freeSpan, hf.columns[x + z * hf.width], spanMin, spanMax, area, mergeThreshold);
+                }
+            }
+        }
+
+        // --- Compact heightfield -----------------------------------------------
+
+        // Open space above walkable spans, with neighbour links
+        struct CompactHeightfield {
+            int width;
+            int height;
+            std::vector<uint32_t> cells; // Spans of column c are [cells[c], cells[c + 1])
+            std::vector<uint16_t> y;     // Floor, in cells
+            std::vector<uint8_t> h;      // Clearance, in cells (clamped to 255)
+            std::vector<uint8_t> area;
+            std::vector<uint8_t> con;    // 4 per span: index within the neighbour column, or kNotConnected
+            std::vector<int> region;
+
+            int neighbor(int x, int z, int span, int dir) const {
+                uint8_t c = con[span * 4 + dir];
+                if (c == kNotConnected) return -1;
+                return static_cast<int>(cells[(x + kDirX[dir]) + (z + kDirZ[dir]) * width]) + c;
+            }
+        };
+
+        // --- Contours and polygons ---------------------------------------------
+
+        struct ContourVertex {
+            int x;
+            int y;
+            int z;
+            int r; // Neighbour region for raw vertices, raw index for simplified ones
+        };
+
+        int64_t area2(const ContourVertex& a, const ContourVertex& b, const ContourVertex& c) {
+            return static_cast<int64_t>(b.x - a.x) * (c.z - a.z) - static_cast<int64_t>(c.x - a.x) * (b.z - a.z);
+        }
+
+        bool left(const ContourVertex& a, const ContourVertex& b, const ContourVertex& c) { return area2(a, b, c) > 0; }
+        bool leftOn(const ContourVertex& a, const ContourVertex& b, const ContourVertex& c) { return area2(a, b, c) >= 0; }
+        bool collinear(const ContourVertex& a, const ContourVertex& b, const ContourVertex& c) { return area2(a, b, c) == 0; }
+        bool sameXZ(const ContourVertex& a, const ContourVertex& b) { return a.x == b.x && a.z == b.z; }
+
+        bool intersectProper(const ContourVertex& a, const ContourVertex& b, const ContourVertex& c, const ContourVertex& d) {
+            if (collinear(a, b, c) || collinear(a, b, d) || collinear(c, d, a) || collinear(c, d, b)) {
+                return false;
+            }
+            return (left(a, b, c) != left(a, b, d)) && (left(c, d, a) != left(c, d, b));
+        }
+
+        bool between(const ContourVertex& a, const ContourVertex& b, const ContourVertex& c) {
+            if (!collinear(a, b, c)) return false;
+            if (a.x != b.x) {
+                return (a.x <= c.x && c.x <= b.x) || (a.x >= c.x && c.x >= b.x);
+            }
+            return (a.z <= c.z && c.z <= b.z) || (a.z >= c.z && c.z >= b.z);
+        }
+
+        bool intersect(const ContourVertex& a, const ContourVertex& b, const ContourVertex& c, const ContourVertex& d) {
+            return intersectProper(a, b, c, d) ||
+                   between(a, b, c) || between(a, b, d) || between(c, d, a) || between(c, d, b);
+        }
+
+        // Squared XZ distance from p to segment a-b
+        float distanceToSegmentSq(int x, int z, int ax, int az, int bx, int bz) {
+            float dx = static_cast<float>(bx - ax), dz = static_cast<float>(bz - az);
+            float px = static_cast<float>(x - ax), pz = static_cast<float>(z - az);
+            float lengthSq = dx * dx + dz * dz;
+            float t = lengthSq > 0.0f ? (px * dx + pz * dz) / lengthSq : 0.0f;
+            t = std::min(std::max(t, 0.0f), 1.0f);
+            px -= t * dx;
+            pz -= t * dz;
+            return px * px + pz * pz;
+        }
+
+        // Ear clipping over a simple polygon with positive XZ area (O'Rourke's
+        // diagonal tests, shortest ear first, as in Recast's triangulate)
+        class Triangulator {
+        public:
+            Triangulator(const std::vector<ContourVertex>& vertices) : m_vertices(vertices) {}
+
+            bool triangulate(std::vector<int>& triangles) {
+                const int count = static_cast<int>(m_vertices.size());
+                m_indices.resize(count);
+                for (int i = 0; i < count; ++i) m_indices[i] = i;
+                m_ears.assign(count, 0);
+
+                int n = count;
+                for (int i = 0; i < n; ++i) {
+                    m_ears[next(i, n)] = diagonal(i, next(next(i, n), n), n, false) ? 1 : 0;
+                }
+
+                while (n > 3) {
+                    int64_t minLength = -1;
+                    int mini = -1;
+                    for (int i = 0; i < n; ++i) {
+                        int i1 = next(i, n);
+                        if (m_ears[i1]) {
+                            const ContourVertex& p0 = vertex(i);
+                            const ContourVertex& p2 = vertex(next(i1, n));
+                            int64_t dx = p2.x - p0.x, dz = p2.z - p0.z;
+                            int64_t length = dx * dx + dz * dz;
+                            if (minLength < 0 || length < minLength) {
+                                minLength = length;
+                                mini = i;
+                            }
+                        }
+                    }
+
+                    if (mini == -1) {
+                        // Simplification can leave touching edges; accept the
+                        // shortest diagonal that is only touched, not crossed
+                        for (int i = 0; i < n; ++i) {
+                            int i1 = next(i, n);
+                            int i2 = next(i1, n);
+                            if (diagonal(i, i2, n, true)) {
+                                const ContourVertex& p0 = vertex(i);
+                                const ContourVertex& p2 = vertex(i2);
+                                int64_t dx = p2.x - p0.x, dz = p2.z - p0.z;
+                                int64_t length = dx * dx + dz * dz;
+                                if (minLength < 0 || length < minLength) {
+                                    minLength = length;
+                                    mini = i;
+                                }
+                            }
+                        }
+                        if (mini == -1) {
+                            return false;
+                        }
+                    }
+
+                    int i = mini;
+                    int i1 = next(i, n);
+                    int i2 = next(i1, n);
+                    triangles.push_back(m_indices[i]);
+                    triangles.push_back(m_indices[i1]);
+                    triangles.push_back(m_indices[i2]);
+
+                    m_indices.erase(m_indices.begin() + i1);
+                    m_ears.erase(m_ears.begin() + i1);
+                    --n;
+                    if (i1 >= n) {
+                        i1 = 0;
+                        i = n - 1;
+                    }
+
+                    // Only the two vertices next to the clipped ear change
+                    m_ears[i] = diagonal(prev(i, n), i1, n, false) ? 1 : 0;
+                    m_ears[i1] = diagonal(i, next(i1, n), n, false) ? 1 : 0;
+                }
+
+                triangles.push_back(m_indices[0]);
+                triangles.push_back(m_indices[1]);
+                triangles.push_back(m_indices[2]);
+                return true;
+            }
+
+        private:
+            const std::vector<ContourVertex>& m_vertices;
+            std::vector<int> m_indices;
+            std::vector<uint8_t> m_ears;
+
+            static int next(int i, int n) { return i + 1 < n ? i + 1 : 0; }
+            static int prev(int i, int n) { return i > 0 ? i - 1 : n - 1; }
+            const ContourVertex& vertex(int i) const { return m_vertices[m_indices[i]]; }
+
+            bool inCone(int i, int j, int n, bool loose) const {
+                const ContourVertex& pi = vertex(i);
+                const ContourVertex& pj = vertex(j);
+                const ContourVertex& next1 = vertex(next(i, n));
+                const ContourVertex& prev1 = vertex(prev(i, n));
+                if (leftOn(prev1, pi, next1)) {
+                    return loose ? (leftOn(pi, pj, prev1) && leftOn(pj, pi, next1))
+                                 : (left(pi, pj, prev1) && left(pj, pi, next1));
+                }
+                return !(leftOn(pi, pj, next1) && leftOn(pj, pi, prev1));
+            }
+
+            // True if i-j crosses no polygon edge
+            bool diagonalie(int i, int j, int n, bool loose) const {
+                const ContourVertex& d0 = vertex(i);
+                const ContourVertex& d1 = vertex(j);
+                for (int k = 0; k < n; ++k) {
+                    int k1 = next(k, n);
+                    if (k == i || k1 == i || k == j || k1 == j) continue;
+                    const ContourVertex& p0 = vertex(k);
+                    const ContourVertex& p1 = vertex(k1);
+                    if (sameXZ(d0, p0) || sameXZ(d1, p0) || sameXZ(d0, p1) || sameXZ(d1, p1)) continue;
+                    if (loose ? intersectProper(d0, d1, p0, p1) : intersect(d0, d1, p0, p1)) return false;
+                }
+                return true;
+            }
+
+            bool diagonal(int i, int j, int n, bool loose) const {
+                return inCone(i, j, n, loose) && diagonalie(i, j, n, loose);
+            }
+        };
+
+        typedef std::array<int, NavPoly::MAX_VERTS> PolyIndices;
+
+        int polyVertexCount(const PolyIndices& poly) {
+            int count = 0;
+            while (count < NavPoly::MAX_VERTS && poly[count] != -1) ++count;
+            return count;
+        }
+
+        // Squared length of the shared edge if pa and pb can merge into a convex
+        // polygon of at most maxVerts vertices, else -1 (getPolyMergeValue)
+        int64_t getMergeValue(const PolyIndices& pa, const PolyIndices& pb, const std::vector<ContourVertex>& vertices,
+                              int maxVerts, int& ea, int& eb) {
+            const int na = polyVertexCount(pa);
+            const int nb = polyVertexCount(pb);
+            if (na + nb - 2 > maxVerts) return -1;
+
+            ea = -1;
+            eb = -1;
+            for (int i = 0; i < na && ea == -1; ++i) {
+                int a0 = pa[i], a1 = pa[(i + 1) % na];
+                for (int j = 0; j < nb; ++j) {
+                    if (pb[j] == a1 && pb[(j + 1) % nb] == a0) {
+                        ea = i;
+                        eb = j;
+                        break;
+                    }
+                }
+            }
+            if (ea == -1) return -1;
+
+            // The merged polygon must stay convex at both ends of the shared edge
+            if (!left(vertices[pa[(ea + na - 1) % na]], vertices[pa[ea]], vertices[pb[(eb + 2) % nb]])) return -1;
+            if (!left(vertices[pb[(eb + nb - 1) % nb]], vertices[pb[eb]], vertices[pa[(ea + 2) % na]])) return -1;
+
+            const ContourVertex& a = vertices[pa[ea]];
+            const ContourVertex& b = vertices[pa[(ea + 1) % na]];
+            int64_t dx = a.x - b.x, dz = a.z - b.z;
+            return dx * dx + dz * dz;
+        }
+
+        PolyIndices mergePolys(const PolyIndices& pa, const PolyIndices& pb, int ea, int eb) {
+            const int na = polyVertexCount(pa);
+            const int nb = polyVertexCount(pb);
+            PolyIndices merged;
+            merged.fill(-1);
+            int count = 0;
+            for (int i = 0; i < na - 1; ++i) merged[count++] = pa[(ea + 1 + i) % na];
+            for (int i = 0; i < nb - 1; ++i) merged[count++] = pb[(eb + 1 + i) % nb];
+            return merged;
+        }
+
+        // Greedily merges neighbouring polygons, longest shared edge first
+        void mergeRegionPolys(std::vector<PolyIndices>& polys, const std::vector<ContourVertex>& vertices, int maxVerts) {
+            std::unordered_map<uint64_t, int> edgeOwner;
+            for (;;) {
+                edgeOwner.clear();
+                int64_t bestValue = 0;
+                int bestA = -1, bestB = -1, bestEa = -1, bestEb = -1;
+                for (int p = 0; p < static_cast<int>(polys.size()); ++p) {
+                    const int n = polyVertexCount(polys[p]);
+                    for (int i = 0; i < n; ++i) {
+                        uint32_t v0 = static_cast<uint32_t>(polys[p][i]);
+                        uint32_t v1 = static_cast<uint32_t>(polys[p][(i + 1) % n]);
+                        uint64_t key = (static_cast<uint64_t>(std::min(v0, v1)) << 32) | std::max(v0, v1);
+                        auto found = edgeOwner.find(key);
+                        if (found == edgeOwner.end()) {
+                            edgeOwner[key] = p;
+                            continue;
+                        }
+                        int ea = -1, eb = -1;
+                        int64_t value = getMergeValue(polys[found->second], polys[p], vertices, maxVerts, ea, eb);
+                        if (value > bestValue) {
+                            bestValue = value;
+                            bestA = found->second;
+                            bestB = p;
+                            bestEa = ea;
+                            bestEb = eb;
+                        }
+                    }
+                }
+                if (bestA == -1) {
+                    break;
+                }
+                polys[bestA] = mergePolys(polys[bestA], polys[bestB], bestEa, bestEb);
+                polys.erase(polys.begin() + bestB);
+            }
+        }
+
+        // Polygons of one region, in heightfield cell coordinates
+        struct RegionPolys {
+            std::vector<ContourVertex> vertices;
+            std::vector<PolyIndices> polys;
+            bool failed;
+        };
+
+        uint64_t fnv1a(uint64_t hash, const void* data, size_t size) {
+            const unsigned char* bytes = static_cast<const unsigned char*>(data);
+            for (size_t i = 0; i < size; ++i) {
+                hash ^= bytes[i];
+                hash *= 1099511628211ULL;
+            }
+            return hash;
+        }
+    }
+
+    NavMeshBuilder::NavMeshBuilder() : m_jobSystem(nullptr), m_stats() {
+    }
+
+    void NavMeshBuilder::addTriangles(const std::vector<glm::vec3>& vertices, const std::vector<uint32_t>& indices) {
+        const uint32_t base = static_cast<uint32_t>(m_vertices.size());
+        m_vertices.insert(m_vertices.end(), vertices.begin(), vertices.end());
+        for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+            if (indices[i] >= vertices.size() || indices[i + 1] >= vertices.size() || indices[i + 2] >= vertices.size()) {
+                continue;
+            }
+            m_indices.push_back(base + indices[i]);
+            m_indices.push_back(base + indices[i + 1]);
+            m_indices.push_back(base + indices[i + 2]);
+        }
+    }
+
+    void NavMeshBuilder::addMesh(const Mesh& mesh, const glm::mat4& transform) {
+        const uint32_t base = static_cast<uint32_t>(m_vertices.size());
+        const glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(transform)));
+        for (const auto& vertex : mesh.vertices) {
+            m_vertices.push_back(glm::vec3(transform * glm::vec4(vertex.position, 1.0f)));
+        }
+
+        const size_t vertexCount = mesh.vertices.size();
+        for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+            uint32_t a = mesh.indices[i], b = mesh.indices[i + 1], c = mesh.indices[i + 2];
+            if (a >= vertexCount || b >= vertexCount || c >= vertexCount) {
+                continue;
+            }
+
+            // Engine meshes do not share one winding, but their normals say which way is up
+            const glm::vec3 geometric = glm::cross(m_vertices[base + b] - m_vertices[base + a],
+                                                   m_vertices[base + c] - m_vertices[base + a]);
+            const glm::vec3 declared = normalMatrix *
+                (mesh.vertices[a].normal + mesh.vertices[b].normal + mesh.vertices[c].normal);
+            if (glm::dot(geometric, declared) < 0.0f) {
+                std::swap(b, c);
+            }
+            m_indices.push_back(base + a);
+            m_indices.push_back(base + b);
+            m_indices.push_back(base + c);
+        }
+    }
+
+    void NavMeshBuilder::addScene(const Scene& scene) {
+        for (const auto& object : scene.getGameObjects()) {
+            const RenderComponent* render = object->getComponent<RenderComponent>();
+            if (render && render->getMesh()) {
+                addMesh(*render->getMesh(), object->getTransformMatrix());
+            }
+        }
+    }
+
+    void NavMeshBuilder::clearGeometry() {
+        m_vertices.clear();
+        m_indices.clear();
+    }
+
+    uint64_t NavMeshBuilder::computeInputHash(const NavMeshBuildConfig& config) const {
+        uint64_t hash = 14695981039346656037ULL;
+        hash = fnv1a(hash, &kBuilderVersion, sizeof(kBuilderVersion));
+        const float settings[] = {
+            config.cellSize, config.cellHeight, config.agentHeight, config.agentRadius, config.agentMaxClimb,
+            config.agentMaxSlope, static_cast<float>(config.minRegionArea), config.maxEdgeError,
+            static_cast<float>(config.maxVertsPerPoly), config.detailSampleDistance, config.detailSampleMaxError
+        };
+        hash = fnv1a(hash, settings, sizeof(settings));
+        hash = fnv1a(hash, m_vertices.data(), m_vertices.size() * sizeof(glm::vec3));
+        hash = fnv1a(hash, m_indices.data(), m_indices.size() * sizeof(uint32_t));
+        return hash;
+    }
+
+    std::shared_ptr<NavPolyMesh> NavMeshBuilder::buildCached(const NavMeshBuildConfig& config, const std::string& cachePath) {
+        const uint64_t hash = computeInputHash(config);
+        if (FileUtils::fileExists(cachePath)) {
+            auto mesh = std::make_shared<NavPolyMesh>();
+            if (mesh->loadFromFile(cachePath) && mesh->getSourceHash() == hash) {
+                m_stats = NavMeshBuildStats();
+                m_stats.triangleCount = getTriangleCount();
+                m_stats.polyCount = mesh->getPolyCount();
+                m_stats.detailTriangleCount = mesh->getDetailTriangles().size() / 3;
+                m_stats.loadedFromCache = true;
+                SPARKY_LOG_INFO("Loaded navigation mesh from " + cachePath);
+                return mesh;
+            }
+            SPARKY_LOG_INFO("Navigation mesh cache " + cachePath + " is stale, rebuilding");
+        }
+
+        std::shared_ptr<NavPolyMesh> mesh = build(config);
+        if (mesh && !mesh->saveToFile(cachePath)) {
+            SPARKY_LOG_WARNING("Failed to write navigation mesh cache " + cachePath);
+        }
+        return mesh;
+    }
+
+    std::shared_ptr<NavPolyMesh> NavMeshBuilder::build(const NavMeshBuildConfig& config) {
+        const auto buildStart = std::chrono::steady_clock::now();
+        m_stats = NavMeshBuildStats();
+        m_stats.triangleCount = getTriangleCount();
+
+        if (m_indices.empty() || config.cellSize <= 0.0f || config.cellHeight <= 0.0f) {
+            SPARKY_LOG_WARNING("Navigation mesh build has no geometry or an invalid cell size");
+            return nullptr;
+        }
+
+        JobSystem& jobs = m_jobSystem ? *m_jobSystem : JobSystem::getInstance();
+        const float cs = config.cellSize;
+        const float ch = config.cellHeight;
+        const int walkableHeight = static_cast<int>(std::ceil(config.agentHeight / ch));
+        const int walkableClimb = static_cast<int>(std::floor(config.agentMaxClimb / ch));
+        const int walkableRadius = static_cast<int>(std::ceil(config.agentRadius / cs));
+        const int maxVertsPerPoly = std::min(std::max(config.maxVertsPerPoly, 3), NavPoly::MAX_VERTS);
+        const float walkableSlopeCos = std::cos(glm::radians(config.agentMaxSlope));
+
+        // --- Rasterize -----------------------------------------------------------
+        auto stageStart = std::chrono::steady_clock::now();
+        Heightfield hf;
+        hf.bmin = m_vertices[m_indices[0]];
+        hf.bmax = hf.bmin;
+        for (uint32_t index : m_indices) {
+            hf.bmin = glm::min(hf.bmin, m_vertices[index]);
+            hf.bmax = glm::max(hf.bmax, m_vertices[index]);
+        }
+        hf.cs = cs;
+        hf.ch = ch;
+        hf.width = std::max(static_cast<int>(std::ceil((hf.bmax.x - hf.bmin.x) / cs)), 1);
+        hf.height = std::max(static_cast<int>(std::ceil((hf.bmax.z - hf.bmin.z) / cs)), 1);
+        hf.columns.assign(static_cast<size_t>(hf.width) * hf.height, -1);
+        const int bandCount = (hf.height + kRasterBandRows - 1) / kRasterBandRows;
+        hf.bands.resize(bandCount);
+        hf.freeSpans.assign(bandCount, -1);
+        m_stats.gridWidth = hf.width;
+        m_stats.gridHeight = hf.height;
+
+        // Slope test, then bin triangles by the bands they touch
+        const size_t triangleCount = m_indices.size() / 3;
+        std::vector<uint8_t> triangleAreas(triangleCount);
+        jobs.parallelFor(triangleCount, 0, [&](size_t begin, size_t end) {
+            for (size_t t = begin; t < end; ++t) {
+                const glm::vec3& v0 = m_vertices[m_indices[t * 3]];
+                glm::vec3 normal = glm::cross(m_vertices[m_indices[t * 3 + 1]] - v0, m_vertices[m_indices[t * 3 + 2]] - v0);
+                float length = glm::length(normal);
+                triangleAreas[t] = (length > 0.0f && normal.y / length > walkableSlopeCos) ? 1 : 0;
+            }
+        });
+
+        std::vector<std::vector<uint32_t>> bandTriangles(bandCount);
+        for (size_t t = 0; t < triangleCount; ++t) {
+            float minZ = std::min(m_vertices[m_indices[t * 3]].z,
+                                  std::min(m_vertices[m_indices[t * 3 + 1]].z, m_vertices[m_indices[t * 3 + 2]].z));
+            float maxZ = std::max(m_vertices[m_indices[t * 3]].z,
+                                  std::max(m_vertices[m_indices[t * 3 + 1]].z, m_vertices[m_indices[t * 3 + 2]].z));
+            int z0 = std::min(std::max(static_cast<int>((minZ - hf.bmin.z) / cs), 0), hf.height - 1);
+            int z1 = std::min(std::max(static_cast<int>((maxZ - hf.bmin.z) / cs), 0), hf.height - 1);
+            for (int band = z0 / kRasterBandRows; band <= z1 / kRasterBandRows; ++band) {
+                bandTriangles[band].push_back(static_cast<uint32_t>(t));
+            }
+        }
+
+        jobs.parallelFor(bandCount, 1, [&](size_t begin, size_t end) {
+            for (size_t band = begin; band < end; ++band) {
+                const int rowBegin = static_cast<int>(band) * kRasterBandRows;
+                const int rowEnd = std::min(rowBegin + kRasterBandRows, hf.height);
+                for (uint32_t t : bandTriangles[band]) {
+                    rasterizeTriangle(m_vertices[m_indices[t * 3]], m_vertices[m_indices[t * 3 + 1]],
+                                      m_vertices[m_indices[t * 3 + 2]], triangleAreas[t], hf,
+                                      rowBegin, rowEnd, hf.freeSpans[band], walkableClimb);
+                }
+            }
+        });
+        m_stats.rasterizeMs = elapsedMs(stageStart);
+
+        // --- Filter --------------------------------------------------------------
+        stageStart = std::chrono::steady_clock::now();
+        const size_t rowCount = static_cast<size_t>(hf.height);
+
+        // Low obstacles (kerbs, stairs) next to walkable spans become walkable
+        jobs.parallelFor(rowCount, 0, [&](size_t begin, size_t end) {
+            for (int z = static_cast<int>(begin); z < static_cast<int>(end); ++z) {
+                std::vector<Span>& pool = hf.pool(z);
+                for (int x = 0; x < hf.width; ++x) {
+                    bool previousWalkable = false;
+                    uint8_t previousArea = 0;
+                    int previousMax = 0;
+                    for (int s = hf.columns[x + z * hf.width]; s != -1; s = pool[s].next) {
+                        const bool walkable = pool[s].area != 0;
+                        if (!walkable && previousWalkable && std::abs(static_cast<int>(pool[s].smax) - previousMax) <= walkableClimb) {
+                            pool[s].area = previousArea;
+                        }
+                        previousWalkable = walkable;
+                        previousArea = pool[s].area;
+                        previousMax = pool[s].smax;
+                    }
+                }
+            }
+        });
+
+        // Ledges and spans without head room. Each span only writes its own area
+        // and reads neighbour geometry, so rows are independent.
+        jobs.parallelFor(rowCount, 0, [&](size_t begin, size_t end) {
+            for (int z = static_cast<int>(begin); z < static_cast<int>(end); ++z) {
+                std::vector<Span>& pool = hf.pool(z);
+                for (int x = 0; x < hf.width; ++x) {
+                    for (int s = hf.columns[x + z * hf.width]; s != -1; s = pool[s].next) {
+                        if (pool[s].area == 0) continue;
+
+                        const int bottom = pool[s].smax;
+                        const int top = pool[s].next != -1 ? pool[pool[s].next].smin : kMaxSpanHeight;
+                        if (top - bottom < walkableHeight) {
+                            pool[s].area = 0;
+                            continue;
+                        }
+
+                        int minDrop = kMaxSpanHeight;
+                        int accessibleMin = bottom, accessibleMax = bottom;
+                        for (int dir = 0; dir < 4; ++dir) {
+                            const int nx = x + kDirX[dir];
+                            const int nz = z + kDirZ[dir];
+                            if (nx < 0 || nz < 0 || nx >= hf.width || nz >= hf.height) {
+                                minDrop = std::min(minDrop, -walkableClimb - bottom);
+                                continue;
+                            }
+
+                            const std::vector<Span>& neighborPool = hf.pool(nz);
+                            int ns = hf.columns[nx + nz * hf.width];
+
+                            // Open space below the first neighbour span
+                            int neighborBottom = -walkableClimb;
+                            int neighborTop = ns != -1 ? neighborPool[ns].smin : kMaxSpanHeight;
+                            if (std::min(top, neighborTop) - std::max(bottom, neighborBottom) > walkableHeight) {
+                                minDrop = std::min(minDrop, neighborBottom - bottom);
+                            }
+
+                            for (; ns != -1; ns = neighborPool[ns].next) {
+                                neighborBottom = neighborPool[ns].smax;
+                                neighborTop = neighborPool[ns].next != -1 ? neighborPool[neighborPool[ns].next].smin : kMaxSpanHeight;
+                                if (std::min(top, neighborTop) - std::max(bottom, neighborBottom) > walkableHeight) {
+                                    minDrop = std::min(minDrop, neighborBottom - bottom);
+                                    if (std::abs(neighborBottom - bottom) <= walkableClimb) {
+                                        accessibleMin = std::min(accessibleMin, neighborBottom);
+                                        accessibleMax = std::max(accessibleMax, neighborBottom);
+                                    }
+                                }
+                            }
+                        }
+
+                        if (minDrop < -walkableClimb || accessibleMax - accessibleMin > walkableClimb) {
+                            pool[s].area = 0;
+                        }
+                    }
+                }
+            }
+        });
+
+        // Compact the open space above walkable spans
+        CompactHeightfield chf;
+        chf.width = hf.width;
+        chf.height = hf.height;
+        const size_t columnCount = static_cast<size_t>(hf.width) * hf.height;
+        chf.cells.assign(columnCount + 1, 0);
+        jobs.parallelFor(rowCount, 0, [&](size_t begin, size_t end) {
+            for (int z = static_cast<int>(begin); z < static_cast<int>(end); ++z) {
+                const std::vector<Span>& pool = hf.pool(z);
+                for (int x = 0; x < hf.width; ++x) {
+                    uint32_t count = 0;
+                    for (int s = hf.columns[x + z * hf.width]; s != -1; s = pool[s].next) {
+                        if (pool[s].area != 0) ++count;
+                    }
+                    chf.cells[x + z * hf.width + 1] = count;
+                }
+            }
+        });
+        for (size_t c = 1; c <= columnCount; ++c) {
+            chf.cells[c] += chf.cells[c - 1];
+        }
+        const size_t spanCount = chf.cells[columnCount];
+        m_stats.spanCount = spanCount;
+        chf.y.resize(spanCount);
+        chf.h.resize(spanCount);
+        chf.area.resize(spanCount);
+        chf.con.assign(spanCount * 4, kNotConnected);
+        chf.region.assign(spanCount, 0);
+
+        jobs.parallelFor(rowCount, 0, [&](size_t begin, size_t end) {
+            for (int z = static_cast<int>(begin); z < static_cast<int>(end); ++z) {
+                const std::vector<Span>& pool = hf.pool(z);
+                for (int x = 0; x < hf.width; ++x) {
+                    uint32_t index = chf.cells[x + z * hf.width];
+                    for (int s = hf.columns[x + z * hf.width]; s != -1; s = pool[s].next) {
+                        if (pool[s].area == 0) continue;
+                        const int bottom = pool[s].smax;
+                        const int top = pool[s].next != -1 ? pool[pool[s].next].smin : kMaxSpanHeight;
+                        chf.y[index] = static_cast<uint16_t>(bottom);
+                        chf.h[index] = static_cast<uint8_t>(std::min(std::max(top - bottom, 0), 0xff));
+                        chf.area[index] = pool[s].area;
+                        ++index;
+                    }
+                }
+            }
+        });
+        hf.columns.clear();
+        hf.bands.clear();
+
+        // Link spans an agent can step between
+        jobs.parallelFor(rowCount, 0, [&](size_t begin, size_t end) {
+            for (int z = static_cast<int>(begin); z < static_cast<int>(end); ++z) {
+                for (int x = 0; x < chf.width; ++x) {
+                    const int c = x + z * chf.width;
+                    for (uint32_t i = chf.cells[c]; i < chf.cells[c + 1]; ++i) {
+                        for (int dir = 0; dir < 4; ++dir) {
+                            const int nx = x + kDirX[dir];
+                            const int nz = z + kDirZ[dir];
+                            if (nx < 0 || nz < 0 || nx >= chf.width || nz >= chf.height) continue;
+                            const int nc = nx + nz * chf.width;
+                            for (uint32_t k = chf.cells[nc]; k < chf.cells[nc + 1]; ++k) {
+                                const int bottom = std::max(chf.y[i], chf.y[k]);
+                                const int top = std::min(chf.y[i] + chf.h[i], chf.y[k] + chf.h[k]);
+                                if (top - bottom >= walkableHeight &&
+                                    std::abs(static_cast<int>(chf.y[k]) - static_cast<int>(chf.y[i])) <= walkableClimb) {
+                                    const uint32_t offset = k - chf.cells[nc];
+                                    if (offset < kNotConnected) {
+                                        chf.con[i * 4 + dir] = static_cast<uint8_t>(offset);
+                                    }
+                                    break;
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        });
+
+        // Erode by the agent radius: two-pass chamfer distance to the nearest
+        // boundary (rcErodeWalkableArea), sequential by nature
+        if (walkableRadius > 0 && spanCount > 0) {
+            std::vector<uint8_t> distance(spanCount, 0xff);
+            jobs.parallelFor(rowCount, 0, [&](size_t begin, size_t end) {
+                for (int z = static_cast<int>(begin); z < static_cast<int>(end); ++z) {
+                    for (int x = 0; x < chf.width; ++x) {
+                        const int c = x + z * chf.width;
+                        for (uint32_t i = chf.cells[c]; i < chf.cells[c + 1]; ++i) {
+                            int connected = 0;
+                            for (int dir = 0; dir < 4; ++dir) {
+                                int ni = chf.neighbor(x, z, i, dir);
+                                if (ni != -1 && chf.area[ni] != 0) ++connected;
+                            }
+                            if (chf.area[i] == 0 || connected != 4) distance[i] = 0;
+                        }
+                    }
+                }
+            });
+
+            auto relax = [&](int x, int z, uint32_t i, int dir, int diagonalDir) {
+                int ni = chf.neighbor(x, z, i, dir);
+                if (ni == -1) return;
+                distance[i] = static_cast<uint8_t>(std::min<int>(distance[i], distance[ni] + 2));
+                int di = chf.neighbor(x + kDirX[dir], z + kDirZ[dir], ni, diagonalDir);
+                if (di != -1) {
+                    distance[i] = static_cast<uint8_t>(std::min<int>(distance[i], distance[di] + 3));
+                }
+            };
+            for (int z = 0; z < chf.height; ++z) {
+                for (int x = 0; x < chf.width; ++x) {
+                    const int c = x + z * chf.width;
+                    for (uint32_t i = chf.cells[c]; i < chf.cells[c + 1]; ++i) {
+                        relax(x, z, i, 0, 3); // (-1, 0) then (-1, -1)
+                        relax(x, z, i, 3, 2); // (0, -1) then (1, -1)
+                    }
+                }
+            }
+            for (int z = chf.height - 1; z >= 0; --z) {
+                for (int x = chf.width - 1; x >= 0; --x) {
+                    const int c = x + z * chf.width;
+                    for (uint32_t i = chf.cells[c]; i < chf.cells[c + 1]; ++i) {
+                        relax(x, z, i, 2, 1); // (1, 0) then (1, 1)
+                        relax(x, z, i, 1, 0); // (0, 1) then (-1, 1)
+                    }
+                }
+            }
+
+            const int threshold = walkableRadius * 2;
+            for (size_t i = 0; i < spanCount; ++i) {
+                if (distance[i] < threshold) chf.area[i] = 0;
+            }
+        }
+        m_stats.filterMs = elapsedMs(stageStart);
+
+        // --- Regions -------------------------------------------------------------
+        // Monotone partitioning (rcBuildRegionsMonotone): each row continues the
+        // region below a run when that run is its only continuation, so every
+        // region is one x-interval per row and has no holes.
+        stageStart = std::chrono::steady_clock::now();
+        std::vector<int>& region = chf.region;
+        int nextRegion = 1;
+        {
+            struct Sweep {
+                int id;
+                int samples;
+                int neighbor; // 0 none yet, -1 more than one
+            };
+            std::vector<Sweep> sweeps;
+            std::vector<int> previousCount;
+            for (int z = 0; z < chf.height; ++z) {
+                const uint32_t rowBegin = chf.cells[z * chf.width];
+                const uint32_t rowEnd = chf.cells[(z + 1) * chf.width];
+                sweeps.assign(rowEnd - rowBegin + 1, Sweep{0, 0, 0});
+                previousCount.assign(nextRegion + 1, 0);
+                int sweepId = 1;
+
+                for (int x = 0; x < chf.width; ++x) {
+                    const int c = x + z * chf.width;
+                    for (uint32_t i = chf.cells[c]; i < chf.cells[c + 1]; ++i) {
+                        if (chf.area[i] == 0) continue;
+
+                        int previous = 0;
+                        int ni = chf.neighbor(x, z, i, 0);
+                        if (ni != -1 && region[ni] != 0 && chf.area[ni] == chf.area[i]) {
+                            previous = region[ni];
+                        }
+                        if (previous == 0) {
+                            previous = sweepId++;
+                        }
+
+                        ni = chf.neighbor(x, z, i, 3);
+                        if (ni != -1 && region[ni] != 0 && chf.area[ni] == chf.area[i]) {
+                            const int below = region[ni];
+                            Sweep& sweep = sweeps[previous];
+                            if (sweep.neighbor == 0 || sweep.neighbor == below) {
+                                sweep.neighbor = below;
+                                ++sweep.samples;
+                                ++previousCount[below];
+                            } else {
+                                sweep.neighbor = -1;
+                            }
+                        }
+                        region[i] = previous;
+                    }
+                }
+
+                for (int s = 1; s < sweepId; ++s) {
+                    if (sweeps[s].neighbor > 0 && previousCount[sweeps[s].neighbor] == sweeps[s].samples) {
+                        sweeps[s].id = sweeps[s].neighbor;
+                    } else {
+                        sweeps[s].id = nextRegion++;
+                    }
+                }
+                for (uint32_t i = rowBegin; i < rowEnd; ++i) {
+                    if (region[i] > 0) region[i] = sweeps[region[i]].id;
+                }
+            }
+        }
+
+        // Drop islands smaller than minRegionArea, then renumber regions in scan
+        // order and note where each one starts
+        std::vector<int> regionParent(nextRegion);
+        std::vector<int> regionSpans(nextRegion, 0);
+        for (int r = 0; r < nextRegion; ++r) regionParent[r] = r;
+        auto findRoot = [&](int r) {
+            while (regionParent[r] != r) {
+                regionParent[r] = regionParent[regionParent[r]];
+                r = regionParent[r];
+            }
+            return r;
+        };
+        for (int z = 0; z < chf.height; ++z) {
+            for (int x = 0; x < chf.width; ++x) {
+                const int c = x + z * chf.width;
+                for (uint32_t i = chf.cells[c]; i < chf.cells[c + 1]; ++i) {
+                    if (region[i] == 0) continue;
+                    ++regionSpans[region[i]];
+                    for (int dir = 0; dir < 4; ++dir) {
+                        int ni = chf.neighbor(x, z, i, dir);
+                        if (ni != -1 && region[ni] != 0) {
+                            int a = findRoot(region[i]), b = findRoot(region[ni]);
+                            if (a != b) regionParent[std::max(a, b)] = std::min(a, b);
+                        }
+                    }
+                }
+            }
+        }
+        std::vector<int> islandSpans(nextRegion, 0);
+        for (int r = 1; r < nextRegion; ++r) islandSpans[findRoot(r)] += regionSpans[r];
+
+        struct RegionStart {
+            int x;
+            int z;
+            int span;
+            int spanCount;
+        };
+        std::vector<int> regionRemap(nextRegion, -1);
+        std::vector<RegionStart> regionStarts;
+        for (int z = 0; z < chf.height; ++z) {
+            for (int x = 0; x < chf.width; ++x) {
+                const int c = x + z * chf.width;
+                for (uint32_t i = chf.cells[c]; i < chf.cells[c + 1]; ++i) {
+                    const int r = region[i];
+                    if (r == 0) continue;
+                    if (islandSpans[findRoot(r)] < config.minRegionArea) {
+                        region[i] = 0;
+                        continue;
+                    }
+                    if (regionRemap[r] == -1) {
+                        regionRemap[r] = static_cast<int>(regionStarts.size()) + 1;
+                        regionStarts.push_back({x, z, static_cast<int>(i), regionSpans[r]});
+                    }
+                    region[i] = regionRemap[r];
+                }
+            }
+        }
+        const int regionCount = static_cast<int>(regionStarts.size());
+        m_stats.regionCount = regionCount;
+        m_stats.regionMs = elapsedMs(stageStart);
+        if (regionCount == 0) {
+            m_stats.totalMs = elapsedMs(buildStart);
+            SPARKY_LOG_WARNING("Navigation mesh build found no walkable area");
+            return nullptr;
+        }
+
+        // --- Contours ------------------------------------------------------------
+        stageStart = std::chrono::steady_clock::now();
+
+        // Bit dir is set where the span's edge in that direction borders another region
+        std::vector<uint8_t> edgeFlags(spanCount, 0);
+        jobs.parallelFor(rowCount, 0, [&](size_t begin, size_t end) {
+            for (int z = static_cast<int>(begin); z < static_cast<int>(end); ++z) {
+                for (int x = 0; x < chf.width; ++x) {
+                    const int c = x + z * chf.width;
+                    for (uint32_t i = chf.cells[c]; i < chf.cells[c + 1]; ++i) {
+                        if (region[i] == 0) continue;
+                        uint8_t flags = 0;
+                        for (int dir = 0; dir < 4; ++dir) {
+                            int ni = chf.neighbor(x, z, i, dir);
+                            if (ni == -1 || region[ni] != region[i]) flags |= static_cast<uint8_t>(1 << dir);
+                        }
+                        edgeFlags[i] = flags;
+                    }
+                }
+            }
+        });
+
+        // Floor height at a span corner: the highest of the spans sharing it
+        auto cornerHeight = [&](int x, int z, int i, int dir) {
+            int height = chf.y[i];
+            const int dirNext = (dir + 1) & 3;
+            int ni = chf.neighbor(x, z, i, dir);
+            if (ni != -1) {
+                height = std::max(height, static_cast<int>(chf.y[ni]));
+                int di = chf.neighbor(x + kDirX[dir], z + kDirZ[dir], ni, dirNext);
+                if (di != -1) height = std::max(height, static_cast<int>(chf.y[di]));
+            }
+            ni = chf.neighbor(x, z, i, dirNext);
+            if (ni != -1) {
+                height = std::max(height, static_cast<int>(chf.y[ni]));
+                int di = chf.neighbor(x + kDirX[dirNext], z + kDirZ[dirNext], ni, dir);
+                if (di != -1) height = std::max(height, static_cast<int>(chf.y[di]));
+            }
+            return height;
+        };
+
+        const float maxError = config.maxEdgeError / cs;
+        const float maxErrorSq = maxError * maxError;
+        std::vector<RegionPolys> regionPolys(regionCount);
+
+        // Trace, simplify and triangulate each region independently
+        jobs.parallelFor(static_cast<size_t>(regionCount), 1, [&](size_t begin, size_t end) {
+            std::vector<ContourVertex> raw;
+            std::vector<int> triangles;
+            for (size_t r = begin; r < end; ++r) {
+                RegionPolys& output = regionPolys[r];
+                output.failed = false;
+                const RegionStart& start = regionStarts[r];
+
+                // Walk the outline clockwise around the region's cells (walkContour)
+                raw.clear();
+                int x = start.x, z = start.z, i = start.span;
+                int dir = 0;
+                while (!(edgeFlags[i] & (1 << dir))) ++dir;
+                const int startDir = dir;
+                const int startSpan = i;
+                const int maxSteps = start.spanCount * 8 + 16;
+                for (int step = 0; step < maxSteps; ++step) {
+                    if (edgeFlags[i] & (1 << dir)) {
+                        ContourVertex vertex = {x, cornerHeight(x, z, i, dir), z, 0};
+                        if (dir == 0) {
+                            vertex.z += 1;
+                        } else if (dir == 1) {
+                            vertex.x += 1;
+                            vertex.z += 1;
+                        } else if (dir == 2) {
+                            vertex.x += 1;
+                        }
+                        int ni = chf.neighbor(x, z, i, dir);
+                        vertex.r = ni != -1 ? region[ni] : 0;
+                        raw.push_back(vertex);
+                        dir = (dir + 1) & 3;
+                    } else {
+                        int ni = chf.neighbor(x, z, i, dir);
+                        if (ni == -1) break;
+                        x += kDirX[dir];
+                        z += kDirZ[dir];
+                        i = ni;
+                        dir = (dir + 3) & 3;
+                    }
+                    if (i == startSpan && dir == startDir) break;
+                }
+                const int rawCount = static_cast<int>(raw.size());
+                if (rawCount < 3) continue;
+
+                // Keep the points where the neighbouring region changes...
+                std::vector<ContourVertex>& simplified = output.vertices;
+                for (int k = 0; k < rawCount; ++k) {
+                    if (raw[k].r != raw[(k + 1) % rawCount].r) {
+                        simplified.push_back({raw[k].x, raw[k].y, raw[k].z, k});
+                    }
+                }
+                if (simplified.empty()) {
+                    // ...or, for an island, its lower-left and upper-right points
+                    int lowerLeft = 0, upperRight = 0;
+                    for (int k = 1; k < rawCount; ++k) {
+                        if (raw[k].x < raw[lowerLeft].x || (raw[k].x == raw[lowerLeft].x && raw[k].z < raw[lowerLeft].z)) lowerLeft = k;
+                        if (raw[k].x > raw[upperRight].x || (raw[k].x == raw[upperRight].x && raw[k].z > raw[upperRight].z)) upperRight = k;
+                    }
+                    simplified.push_back({raw[lowerLeft].x, raw[lowerLeft].y, raw[lowerLeft].z, lowerLeft});
+                    simplified.push_back({raw[upperRight].x, raw[upperRight].y, raw[upperRight].z, upperRight});
+                }
+
+                // Then add the worst raw point of each wall edge until every raw
+                // point is within maxEdgeError. Segments are scanned in a fixed
+                // direction so both sides of a shared edge agree.
+                for (size_t k = 0; k < simplified.size();) {
+                    const size_t k1 = (k + 1) % simplified.size();
+                    int ax = simplified[k].x, az = simplified[k].z, ai = simplified[k].r;
+                    int bx = simplified[k1].x, bz = simplified[k1].z, bi = simplified[k1].r;
+
+                    int step, ci, endi;
+                    if (bx > ax || (bx == ax && bz > az)) {
+                        step = 1;
+                        ci = (ai + step) % rawCount;
+                        endi = bi;
+                    } else {
+                        step = rawCount - 1;
+                        ci = (bi + step) % rawCount;
+                        endi = ai;
+                        std::swap(ax, bx);
+                        std::swap(az, bz);
+                    }
+
+                    float maxDistance = 0.0f;
+                    int maxIndex = -1;
+                    if (raw[ci].r == 0) {
+                        while (ci != endi) {
+                            float distance = distanceToSegmentSq(raw[ci].x, raw[ci].z, ax, az, bx, bz);
+                            if (distance > maxDistance) {
+                                maxDistance = distance;
+                                maxIndex = ci;
+                            }
+                            ci = (ci + step) % rawCount;
+                        }
+                    }
+
+                    if (maxIndex != -1 && maxDistance > maxErrorSq) {
+                        simplified.insert(simplified.begin() + k + 1,
+                                          ContourVertex{raw[maxIndex].x, raw[maxIndex].y, raw[maxIndex].z, maxIndex});
+                    } else {
+                        ++k;
+                    }
+                }
+
+                // Drop repeated points, then orient with positive area
+                for (size_t k = 0; k < simplified.size() && simplified.size() > 1;) {
+                    if (sameXZ(simplified[k], simplified[(k + 1) % simplified.size()])) {
+                        simplified.erase(simplified.begin() + k);
+                    } else {
+                        ++k;
+                    }
+                }
+                if (simplified.size() < 3) {
+                    simplified.clear();
+                    continue;
+                }
+                int64_t area = 0;
+                for (size_t k = 0, j = simplified.size() - 1; k < simplified.size(); j = k++) {
+                    area += static_cast<int64_t>(simplified[j].x) * simplified[k].z -
+                            static_cast<int64_t>(simplified[k].x) * simplified[j].z;
+                }
+                if (area == 0) {
+                    simplified.clear();
+                    continue;
+                }
+                if (area < 0) {
+                    std::reverse(simplified.begin(), simplified.end());
+                }
+
+                triangles.clear();
+                Triangulator triangulator(simplified);
+                if (!triangulator.triangulate(triangles)) {
+                    output.failed = true;
+                }
+                for (size_t t = 0; t + 2 < triangles.size(); t += 3) {
+                    PolyIndices poly;
+                    poly.fill(-1);
+                    poly[0] = triangles[t];
+                    poly[1] = triangles[t + 1];
+                    poly[2] = triangles[t + 2];
+                    if (area2(simplified[poly[0]], simplified[poly[1]], simplified[poly[2]]) > 0) {
+                        output.polys.push_back(poly);
+                    }
+                }
+                if (maxVertsPerPoly > 3) {
+                    mergeRegionPolys(output.polys, simplified, maxVertsPerPoly);
+                }
+            }
+        });
+        m_stats.contourMs = elapsedMs(stageStart);
+
+        // --- Polygon mesh --------------------------------------------------------
+        // Weld region vertices (same cell corner, heights within two cells), then
+        // link polygons that share an edge
+        stageStart = std::chrono::steady_clock::now();
+        auto mesh = std::make_shared<NavPolyMesh>();
+        std::vector<ContourVertex> meshCellVertices;
+        std::unordered_map<uint64_t, std::vector<int>> vertexBuckets;
+        std::vector<int> vertexRemap;
+        int failedRegions = 0;
+        for (int r = 0; r < regionCount; ++r) {
+            const RegionPolys& source = regionPolys[r];
+            if (source.failed) ++failedRegions;
+
+            vertexRemap.assign(source.vertices.size(), -1);
+            for (size_t v = 0; v < source.vertices.size(); ++v) {
+                const ContourVertex& vertex = source.vertices[v];
+                uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(vertex.x)) << 32) | static_cast<uint32_t>(vertex.z);
+                std::vector<int>& bucket = vertexBuckets[key];
+                for (int candidate : bucket) {
+                    if (std::abs(meshCellVertices[candidate].y - vertex.y) <= 2) {
+                        vertexRemap[v] = candidate;
+                        break;
+                    }
+                }
+                if (vertexRemap[v] == -1) {
+                    vertexRemap[v] = static_cast<int>(meshCellVertices.size());
+                    bucket.push_back(vertexRemap[v]);
+                    meshCellVertices.push_back(vertex);
+                }
+            }
+
+            for (const PolyIndices& indices : source.polys) {
+                NavPoly poly;
+                poly.vertCount = 0;
+                poly.region = static_cast<uint16_t>(std::min(r + 1, 0xffff));
+                poly.detailTriangleStart = 0;
+                poly.detailTriangleCount = 0;
+                bool degenerate = false;
+                const int count = polyVertexCount(indices);
+                for (int k = 0; k < count; ++k) {
+                    int vertex = vertexRemap[indices[k]];
+                    for (int j = 0; j < k; ++j) {
+                        degenerate = degenerate || poly.verts[j] == vertex;
+                    }
+                    poly.verts[k] = vertex;
+                    poly.neighbors[k] = -1;
+                }
+                poly.vertCount = static_cast<uint8_t>(count);
+                if (!degenerate && count >= 3) {
+                    mesh->m_polys.push_back(poly);
+                }
+            }
+        }
+        if (failedRegions > 0) {
+            SPARKY_LOG_WARNING("Navigation mesh triangulation failed for " + std::to_string(failedRegions) + " regions");
+        }
+
+        mesh->m_vertices.reserve(meshCellVertices.size());
+        for (const ContourVertex& vertex : meshCellVertices) {
+            mesh->m_vertices.push_back(hf.bmin + glm::vec3(vertex.x * cs, vertex.y * ch, vertex.z * cs));
+        }
+
+        std::unordered_map<uint64_t, std::pair<int, int>> edges;
+        for (int p = 0; p < static_cast<int>(mesh->m_polys.size()); ++p) {
+            const NavPoly& poly = mesh->m_polys[p];
+            for (int k = 0; k < poly.vertCount; ++k) {
+                uint64_t key = (static_cast<uint64_t>(poly.verts[k]) << 32) |
+                               static_cast<uint32_t>(poly.verts[(k + 1) % poly.vertCount]);
+                edges[key] = std::make_pair(p, k);
+            }
+        }
+        for (int p = 0; p < static_cast<int>(mesh->m_polys.size()); ++p) {
+            NavPoly& poly = mesh->m_polys[p];
+            for (int k = 0; k < poly.vertCount; ++k) {
+                uint64_t reversed = (static_cast<uint64_t>(poly.verts[(k + 1) % poly.vertCount]) << 32) |
+                                    static_cast<uint32_t>(poly.verts[k]);
+                auto found = edges.find(reversed);
+                if (found != edges.end()) {
+                    poly.neighbors[k] = found->second.first;
+                }
+            }
+        }
+        m_stats.polyCount = mesh->getPolyCount();
+        m_stats.polyMs = elapsedMs(stageStart);
+
+        // --- Detail mesh ---------------------------------------------------------
+        // Fan-triangulate each polygon, then insert the heightfield samples that
+        // deviate most from it until the surface is within detailSampleMaxError
+        stageStart = std::chrono::steady_clock::now();
+        const int polyCount = mesh->getPolyCount();
+        std::vector<std::vector<glm::vec3>> detailVertices(polyCount);
+        std::vector<std::vector<uint32_t>> detailTriangles(polyCount);
+
+        // Walkable surface height in the column under position, nearest to the estimate
+        auto sampleHeight = [&](const glm::vec3& position, float estimate, float& height) {
+            const int x = static_cast<int>(std::floor((position.x - hf.bmin.x) / cs));
+            const int z = static_cast<int>(std::floor((position.z - hf.bmin.z) / cs));
+            if (x < 0 || z < 0 || x >= chf.width || z >= chf.height) return false;
+            const int c = x + z * chf.width;
+            float bestDelta = config.agentHeight;
+            bool found = false;
+            for (uint32_t i = chf.cells[c]; i < chf.cells[c + 1]; ++i) {
+                if (region[i] == 0) continue;
+                float y = hf.bmin.y + chf.y[i] * ch;
+                if (std::fabs(y - estimate) < bestDelta) {
+                    bestDelta = std::fabs(y - estimate);
+                    height = y;
+                    found = true;
+                }
+            }
+            return found;
+        };
+
+        jobs.parallelFor(static_cast<size_t>(polyCount), 0, [&](size_t begin, size_t end) {
+            std::vector<glm::vec3> samples;
+            for (size_t p = begin; p < end; ++p) {
+                const NavPoly& poly = mesh->m_polys[p];
+                std::vector<glm::vec3>& vertices = detailVertices[p];
+                std::vector<uint32_t>& triangles = detailTriangles[p];
+                glm::vec2 minBounds(std::numeric_limits<float>::max()), maxBounds(-std::numeric_limits<float>::max());
+                for (int k = 0; k < poly.vertCount; ++k) {
+                    const glm::vec3& vertex = mesh->m_vertices[poly.verts[k]];
+                    vertices.push_back(vertex);
+                    minBounds = glm::min(minBounds, glm::vec2(vertex.x, vertex.z));
+                    maxBounds = glm::max(maxBounds, glm::vec2(vertex.x, vertex.z));
+                }
+                for (int k = 1; k + 1 < poly.vertCount; ++k) {
+                    triangles.push_back(0);
+                    triangles.push_back(static_cast<uint32_t>(k));
+                    triangles.push_back(static_cast<uint32_t>(k + 1));
+                }
+
+                const float spacing = config.detailSampleDistance;
+                if (spacing <= 0.0f) continue;
+
+                // Interior grid samples, aligned to world space so neighbours agree
+                samples.clear();
+                for (float z = std::ceil(minBounds.y / spacing) * spacing; z < maxBounds.y; z += spacing) {
+                    for (float x = std::ceil(minBounds.x / spacing) * spacing; x < maxBounds.x; x += spacing) {
+                        glm::vec3 sample(x, 0.0f, z);
+                        bool inside = true;
+                        for (int k = 0, j = poly.vertCount - 1; k < poly.vertCount && inside; j = k++) {
+                            const glm::vec3& a = mesh->m_vertices[poly.verts[j]];
+                            const glm::vec3& b = mesh->m_vertices[poly.verts[k]];
+                            float edgeLength = std::sqrt((b.x - a.x) * (b.x - a.x) + (b.z - a.z) * (b.z - a.z));
+                            float cross = (b.x - a.x) * (z - a.z) - (b.z - a.z) * (x - a.x);
+                            inside = cross > edgeLength * cs * 0.5f;
+                        }
+                        if (inside) samples.push_back(sample);
+                    }
+                }
+
+                for (int added = 0; added < kMaxDetailSamples && !samples.empty(); ++added) {
+                    float worstError = config.detailSampleMaxError;
+                    int worstSample = -1, worstTriangle = -1;
+                    float worstHeight = 0.0f;
+                    for (size_t s = 0; s < samples.size(); ++s) {
+                        const glm::vec3& sample = samples[s];
+                        for (size_t t = 0; t < triangles.size(); t += 3) {
+                            const glm::vec3& a = vertices[triangles[t]];
+                            const glm::vec3& b = vertices[triangles[t + 1]];
+                            const glm::vec3& c = vertices[triangles[t + 2]];
+                            float area = (b.x - a.x) * (c.z - a.z) - (b.z - a.z) * (c.x - a.x);
+                            if (area <= 1e-8f) continue;
+                            float u = ((c.x - b.x) * (sample.z - b.z) - (c.z - b.z) * (sample.x - b.x)) / area;
+                            float v = ((a.x - c.x) * (sample.z - c.z) - (a.z - c.z) * (sample.x - c.x)) / area;
+                            float w = 1.0f - u - v;
+                            if (u < 0.01f || v < 0.01f || w < 0.01f) continue;
+
+                            float estimate = a.y * u + b.y * v + c.y * w;
+                            float height = 0.0f;
+                            if (sampleHeight(sample, estimate, height) && std::fabs(height - estimate) > worstError) {
+                                worstError = std::fabs(height - estimate);
+                                worstSample = static_cast<int>(s);
+                                worstTriangle = static_cast<int>(t);
+                                worstHeight = height;
+                            }
+                            break;
+                        }
+                    }
+                    if (worstSample == -1) break;
+
+                    // Split the containing triangle at the sample
+                    const uint32_t index = static_cast<uint32_t>(vertices.size());
+                    vertices.push_back(glm::vec3(samples[worstSample].x, worstHeight, samples[worstSample].z));
+                    const uint32_t a = triangles[worstTriangle];
+                    const uint32_t b = triangles[worstTriangle + 1];
+                    const uint32_t c = triangles[worstTriangle + 2];
+                    triangles[worstTriangle + 2] = index;
+                    triangles.insert(triangles.end(), {b, c, index, c, a, index});
+                    samples.erase(samples.begin() + worstSample);
+                }
+            }
+        });
+
+        for (int p = 0; p < polyCount; ++p) {
+            NavPoly& poly = mesh->m_polys[p];
+            const uint32_t base = static_cast<uint32_t>(mesh->m_detailVertices.size());
+            poly.detailTriangleStart = static_cast<uint32_t>(mesh->m_detailTriangles.size() / 3);
+            poly.detailTriangleCount = static_cast<uint32_t>(detailTriangles[p].size() / 3);
+            mesh->m_detailVertices.insert(mesh->m_detailVertices.end(), detailVertices[p].begin(), detailVertices[p].end());
+            for (uint32_t index : detailTriangles[p]) {
+                mesh->m_detailTriangles.push_back(base + index);
+            }
+        }
+        m_stats.detailTriangleCount = mesh->m_detailTriangles.size() / 3;
+        m_stats.detailMs = elapsedMs(stageStart);
+
+        mesh->setSourceHash(computeInputHash(config));
+        mesh->buildSearchIndex();
+        m_stats.totalMs = elapsedMs(buildStart);
+
+        if (polyCount == 0) {
+            SPARKY_LOG_WARNING("Navigation mesh build produced no polygons");
+            return nullptr;
+        }
+        SPARKY_LOG_INFO("Built navigation mesh: " + std::to_string(polyCount) + " polygons from " +
+                        std::to_string(m_stats.triangleCount) + " triangles in " +
+                        std::to_string(static_cast<int>(m_stats.totalMs)) + " ms");
+        return mesh;
+    }
+}
@@ -0,0 +1,444 @@
+#include "../include/NavPolyMesh.h"
+#include "../include/BinaryStream.h"
+#include "../include/SaveArchive.h"
+#include "../include/Logger.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace Sparky {
+
+    namespace {
+        const uint32_t kNavMeshChunk = SaveArchive::makeChunkId('N', 'A', 'V', 'M');
+        const uint16_t kNavMeshChunkVersion = 1;
+
+        // Twice the signed XZ area of (a, b, c); positive when c lies left of a -> b
+        // in the counter-clockwise-from-above convention used by NavPoly
+        float cross2D(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) {
+            return (b.x - a.x) * (c.z - a.z) - (b.z - a.z) * (c.x - a.x);
+        }
+
+        // Funnel orientation test: negative when c lies left of a -> b
+        float triArea2D(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) {
+            return -cross2D(a, b, c);
+        }
+
+        bool nearlyEqual2D(const glm::vec3& a, const glm::vec3& b) {
+            float dx = a.x - b.x, dz = a.z - b.z;
+            return dx * dx + dz * dz < 1e-8f;
+        }
+
+        // Closest point to p on segment a-b, in XZ, with Y interpolated along the segment
+        glm::vec3 closestPointOnSegment2D(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b) {
+            float dx = b.x - a.x, dz = b.z - a.z;
+            float lengthSq = dx * dx + dz * dz;
+            float t = lengthSq > 0.0f ? ((p.x - a.x) * dx + (p.z - a.z) * dz) / lengthSq : 0.0f;
+            t = std::min(std::max(t, 0.0f), 1.0f);
+            return a + (b - a) * t;
+        }
+    }
+
+    NavPolyMesh::NavPolyMesh()
+        : m_sourceHash(0)
+        , m_gridOrigin(0.0f)
+        , m_gridCellSize(1.0f)
+        , m_gridWidth(0)
+        , m_gridHeight(0) {
+    }
+
+    glm::vec3 NavPolyMesh::getPolyCenter(int poly) const {
+        const NavPoly& p = m_polys[poly];
+        glm::vec3 center(0.0f);
+        for (int i = 0; i < p.vertCount; ++i) {
+            center += m_vertices[p.verts[i]];
+        }
+        return center * (1.0f / static_cast<float>(p.vertCount));
+    }
+
+    bool NavPolyMesh::containsPoint(int poly, const glm::vec3& position) const {
+        const NavPoly& p = m_polys[poly];
+        for (int i = 0, j = p.vertCount - 1; i < p.vertCount; j = i++) {
+            if (cross2D(m_vertices[p.verts[j]], m_vertices[p.verts[i]], position) < -1e-4f) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool NavPolyMesh::getPolyHeight(int poly, const glm::vec3& position, float& height) const {
+        const NavPoly& p = m_polys[poly];
+        for (uint32_t t = 0; t < p.detailTriangleCount; ++t) {
+            const uint32_t* tri = &m_detailTriangles[(p.detailTriangleStart + t) * 3];
+            const glm::vec3& a = m_detailVertices[tri[0]];
+            const glm::vec3& b = m_detailVertices[tri[1]];
+            const glm::vec3& c = m_detailVertices[tri[2]];
+
+            float area = cross2D(a, b, c);
+            if (std::fabs(area) < 1e-8f) continue;
+            float u = cross2D(b, c, position) / area;
+            float v = cross2D(c, a, position) / area;
+            float w = 1.0f - u - v;
+            const float eps = -1e-4f;
+            if (u >= eps && v >= eps && w >= eps) {
+                height = a.y * u + b.y * v + c.y * w;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    glm::vec3 NavPolyMesh::closestPointOnPoly(int poly, const glm::vec3& position) const {
+        float height = 0.0f;
+        if (containsPoint(poly, position) && getPolyHeight(poly, position, height)) {
+            return glm::vec3(position.x, height, position.z);
+        }
+
+        const NavPoly& p = m_polys[poly];
+        glm::vec3 best = m_vertices[p.verts[0]];
+        float bestDistanceSq = std::numeric_limits<float>::max();
+        for (int i = 0, j = p.vertCount - 1; i < p.vertCount; j = i++) {
+            glm::vec3 candidate = closestPointOnSegment2D(position, m_vertices[p.verts[j]], m_vertices[p.verts[i]]);
+            float dx = candidate.x - position.x, dz = candidate.z - position.z;
+            if (dx * dx + dz * dz < bestDistanceSq) {
+                bestDistanceSq = dx * dx + dz * dz;
+                best = candidate;
+            }
+        }
+        return best;
+    }
+
+    void NavPolyMesh::buildSearchIndex() {
+        m_gridWidth = 0;
+        m_gridHeight = 0;
+        m_gridCellStart.clear();
+        m_gridPolys.clear();
+        if (m_polys.empty()) {
+            return;
+        }
+
+        std::vector<glm::vec2> polyMin(m_polys.size()), polyMax(m_polys.size());
+        glm::vec2 minBounds(std::numeric_limits<float>::max());
+        glm::vec2 maxBounds(-std::numeric_limits<float>::max());
+        float sizeSum = 0.0f;
+        for (size_t i = 0; i < m_polys.size(); ++i) {
+            polyMin[i] = glm::vec2(std::numeric_limits<float>::max());
+            polyMax[i] = glm::vec2(-std::numeric_limits<float>::max());
+            for (int v = 0; v < m_polys[i].vertCount; ++v) {
+                const glm::vec3& vertex = m_vertices[m_polys[i].verts[v]];
+                polyMin[i] = glm::min(polyMin[i], glm::vec2(vertex.x, vertex.z));
+                polyMax[i] = glm::max(polyMax[i], glm::vec2(vertex.x, vertex.z));
+            }
+            minBounds = glm::min(minBounds, polyMin[i]);
+            maxBounds = glm::max(maxBounds, polyMax[i]);
+            sizeSum += std::max(polyMax[i].x - polyMin[i].x, polyMax[i].y - polyMin[i].y);
+        }
+
+        // Cells about the size of an average polygon, capped to a few per polygon
+        glm::vec2 extent = glm::max(maxBounds - minBounds, glm::vec2(1e-3f));
+        m_gridCellSize = std::max(sizeSum / static_cast<float>(m_polys.size()), 1e-3f);
+        const float maxCells = static_cast<float>(m_polys.size()) * 4.0f + 16.0f;
+        while ((extent.x / m_gridCellSize + 1.0f) * (extent.y / m_gridCellSize + 1.0f) > maxCells) {
+            m_gridCellSize *= 2.0f;
+        }
+        m_gridOrigin = minBounds;
+        m_gridWidth = static_cast<int>(extent.x / m_gridCellSize) + 1;
+        m_gridHeight = static_cast<int>(extent.y / m_gridCellSize) + 1;
+
+        auto cellRange = [&](size_t poly, int& x0, int& z0, int& x1, int& z1) {
+            x0 = std::min(std::max(static_cast<int>((polyMin[poly].x - m_gridOrigin.x) / m_gridCellSize), 0), m_gridWidth - 1);
+            z0 = std::min(std::max(static_cast<int>((polyMin[poly].y - m_gridOrigin.y) / m_gridCellSize), 0), m_gridHeight - 1);
+            x1 = std::min(std::max(static_cast<int>((polyMax[poly].x - m_gridOrigin.x) / m_gridCellSize), 0), m_gridWidth - 1);
+            z1 = std::min(std::max(static_cast<int>((polyMax[poly].y - m_gridOrigin.y) / m_gridCellSize), 0), m_gridHeight - 1);
+        };
+
+        m_gridCellStart.assign(static_cast<size_t>(m_gridWidth) * m_gridHeight + 1, 0);
+        for (size_t i = 0; i < m_polys.size(); ++i) {
+            int x0, z0, x1, z1;
+            cellRange(i, x0, z0, x1, z1);
+            for (int z = z0; z <= z1; ++z) {
+                for (int x = x0; x <= x1; ++x) {
+                    ++m_gridCellStart[z * m_gridWidth + x + 1];
+                }
+            }
+        }
+        for (size_t cell = 1; cell < m_gridCellStart.size(); ++cell) {
+            m_gridCellStart[cell] += m_gridCellStart[cell - 1];
+        }
+        m_gridPolys.resize(m_gridCellStart.back());
+        std::vector<uint32_t> cursor(m_gridCellStart.begin(), m_gridCellStart.end() - 1);
+        for (size_t i = 0; i < m_polys.size(); ++i) {
+            int x0, z0, x1, z1;
+            cellRange(i, x0, z0, x1, z1);
+            for (int z = z0; z <= z1; ++z) {
+                for (int x = x0; x <= x1; ++x) {
+                    m_gridPolys[cursor[z * m_gridWidth + x]++] = static_cast<int>(i);
+                }
+            }
+        }
+    }
+
+    int NavPolyMesh::findPoly(const glm::vec3& position, float searchRadius) const {
+        if (m_gridWidth == 0) {
+            return -1;
+        }
+
+        const int cellX = static_cast<int>(std::floor((position.x - m_gridOrigin.x) / m_gridCellSize));
+        const int cellZ = static_cast<int>(std::floor((position.z - m_gridOrigin.y) / m_gridCellSize));
+
+        // Containing polygon, closest in height
+        int best = -1;
+        float bestHeightDelta = std::numeric_limits<float>::max();
+        if (cellX >= 0 && cellX < m_gridWidth && cellZ >= 0 && cellZ < m_gridHeight) {
+            const int cell = cellZ * m_gridWidth + cellX;
+            for (uint32_t i = m_gridCellStart[cell]; i < m_gridCellStart[cell + 1]; ++i) {
+                const int poly = m_gridPolys[i];
+                float height = 0.0f;
+                if (containsPoint(poly, position) && getPolyHeight(poly, position, height) &&
+                    std::fabs(height - position.y) < bestHeightDelta) {
+                    bestHeightDelta = std::fabs(height - position.y);
+                    best = poly;
+                }
+            }
+        }
+        if (best >= 0) {
+            return best;
+        }
+
+        // Otherwise the closest polygon within the search radius
+        const int reach = static_cast<int>(std::ceil(searchRadius / m_gridCellSize));
+        float bestDistanceSq = searchRadius * searchRadius;
+        for (int z = std::max(cellZ - reach, 0); z <= std::min(cellZ + reach, m_gridHeight - 1); ++z) {
+            for (int x = std::max(cellX - reach, 0); x <= std::min(cellX + reach, m_gridWidth - 1); ++x) {
+                const int cell = z * m_gridWidth + x;
+                for (uint32_t i = m_gridCellStart[cell]; i < m_gridCellStart[cell + 1]; ++i) {
+                    const int poly = m_gridPolys[i];
+                    glm::vec3 offset = closestPointOnPoly(poly, position) - position;
+                    float distanceSq = glm::dot(offset, offset);
+                    if (distanceSq < bestDistanceSq) {
+                        bestDistanceSq = distanceSq;
+                        best = poly;
+                    }
+                }
+            }
+        }
+        return best;
+    }
+
+    bool NavPolyMesh::getPortal(int from, int to, glm::vec3& left, glm::vec3& right) const {
+        const NavPoly& p = m_polys[from];
+        for (int i = 0; i < p.vertCount; ++i) {
+            if (p.neighbors[i] == to) {
+                // Leaving a counter-clockwise polygon, the edge end is on the left
+                right = m_vertices[p.verts[i]];
+                left = m_vertices[p.verts[(i + 1) % p.vertCount]];
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void NavPolyMesh::findStraightPath(const glm::vec3& start, const glm::vec3& end, const std::vector<int>& corridor,
+                                       std::vector<glm::vec3>& path) const {
+        path.clear();
+        path.push_back(start);
+        if (corridor.empty()) {
+            return;
+        }
+
+        std::vector<glm::vec3> lefts, rights;
+        lefts.reserve(corridor.size() + 1);
+        rights.reserve(corridor.size() + 1);
+        lefts.push_back(start);
+        rights.push_back(start);
+        for (size_t i = 0; i + 1 < corridor.size(); ++i) {
+            glm::vec3 left, right;
+            if (!getPortal(corridor[i], corridor[i + 1], left, right)) {
+                // Broken corridor: fall back to polygon centers from here on
+                for (size_t j = i + 1; j < corridor.size(); ++j) {
+                    path.push_back(getPolyCenter(corridor[j]));
+                }
+                path.push_back(end);
+                return;
+            }
+            lefts.push_back(left);
+            rights.push_back(right);
+        }
+        lefts.push_back(end);
+        rights.push_back(end);
+
+        // Simple stupid funnel algorithm (Mononen)
+        glm::vec3 apex = start, portalLeft = start, portalRight = start;
+        size_t apexIndex = 0, leftIndex = 0, rightIndex = 0;
+        const size_t portalCount = lefts.size();
+
+        for (size_t i = 1; i < portalCount; ++i) {
+            const glm::vec3& left = lefts[i];
+            const glm::vec3& right = rights[i];
+
+            // Narrow the right side
+            if (triArea2D(apex, portalRight, right) <= 0.0f) {
+                if (nearlyEqual2D(apex, portalRight) || triArea2D(apex, portalLeft, right) > 0.0f) {
+                    portalRight = right;
+                    rightIndex = i;
+                } else {
+                    // Right crossed over left: the left corner is on the path
+                    if (!nearlyEqual2D(path.back(), portalLeft)) path.push_back(portalLeft);
+                    apex = portalLeft;
+                    apexIndex = leftIndex;
+                    portalLeft = portalRight = apex;
+                    leftIndex = rightIndex = apexIndex;
+                    i = apexIndex;
+                    continue;
+                }
+            }
+
+            // Narrow the left side
+            if (triArea2D(apex, portalLeft, left) >= 0.0f) {
+                if (nearlyEqual2D(apex, portalLeft) || triArea2D(apex, portalRight, left) < 0.0f) {
+                    portalLeft = left;
+                    leftIndex = i;
+                } else {
+                    if (!nearlyEqual2D(path.back(), portalRight)) path.push_back(portalRight);
+                    apex = portalRight;
+                    apexIndex = rightIndex;
+                    portalLeft = portalRight = apex;
+                    leftIndex = rightIndex = apexIndex;
+                    i = apexIndex;
+                    continue;
+                }
+            }
+        }
+
+        if (!nearlyEqual2D(path.back(), end) || path.size() == 1) {
+            path.push_back(end);
+        }
+    }
+
+    void NavPolyMesh::writeTo(SaveArchive& archive) const {
+        BinaryWriter writer;
+        writer.writeU64(m_sourceHash);
+        writer.writeU32(static_cast<uint32_t>(m_vertices.size()));
+        for (const auto& vertex : m_vertices) {
+            writer.writeVec3(vertex);
+        }
+        writer.writeU32(static_cast<uint32_t>(m_polys.size()));
+        for (const auto& poly : m_polys) {
+            writer.writeU8(poly.vertCount);
+            writer.writeU16(poly.region);
+            for (int i = 0; i < poly.vertCount; ++i) {
+                writer.writeI32(poly.verts[i]);
+                writer.writeI32(poly.neighbors[i]);
+            }
+            writer.writeU32(poly.detailTriangleStart);
+            writer.writeU32(poly.detailTriangleCount);
+        }
+        writer.writeU32(static_cast<uint32_t>(m_detailVertices.size()));
+        for (const auto& vertex : m_detailVertices) {
+            writer.writeVec3(vertex);
+        }
+        writer.writeU32(static_cast<uint32_t>(m_detailTriangles.size()));
+        writer.writeBytes(m_detailTriangles.data(), m_detailTriangles.size() * sizeof(uint32_t));
+        archive.setChunk(kNavMeshChunk, kNavMeshChunkVersion, writer);
+    }
+
+    bool NavPolyMesh::readFrom(const SaveArchive& archive) {
+        const SaveChunk* chunk = archive.getChunk(kNavMeshChunk);
+        if (!chunk || chunk->version > kNavMeshChunkVersion) {
+            SPARKY_LOG_ERROR("Save archive does not contain a supported navigation mesh");
+            return false;
+        }
+
+        BinaryReader reader(chunk->data);
+        uint64_t sourceHash = 0;
+        uint32_t vertexCount = 0, polyCount = 0, detailVertexCount = 0, detailIndexCount = 0;
+        reader.readU64(sourceHash);
+        reader.readU32(vertexCount);
+        if (reader.hasError() || vertexCount > reader.remaining() / 12) {
+            SPARKY_LOG_ERROR("Corrupt navigation mesh vertices");
+            return false;
+        }
+        std::vector<glm::vec3> vertices(vertexCount);
+        for (auto& vertex : vertices) {
+            reader.readVec3(vertex);
+        }
+
+        reader.readU32(polyCount);
+        if (reader.hasError() || polyCount > reader.remaining() / 11) {
+            SPARKY_LOG_ERROR("Corrupt navigation mesh polygons");
+            return false;
+        }
+        std::vector<NavPoly> polys(polyCount);
+        for (auto& poly : polys) {
+            reader.readU8(poly.vertCount);
+            reader.readU16(poly.region);
+            if (poly.vertCount < 3 || poly.vertCount > NavPoly::MAX_VERTS) {
+                SPARKY_LOG_ERROR("Corrupt navigation mesh polygon");
+                return false;
+            }
+            for (int i = 0; i < poly.vertCount; ++i) {
+                int32_t vertex = -1, neighbor = -1;
+                reader.readI32(vertex);
+                reader.readI32(neighbor);
+                if (vertex < 0 || vertex >= static_cast<int32_t>(vertexCount) ||
+                    neighbor < -1 || neighbor >= static_cast<int32_t>(polyCount)) {
+                    SPARKY_LOG_ERROR("Corrupt navigation mesh polygon");
+                    return false;
+                }
+                poly.verts[i] = vertex;
+                poly.neighbors[i] = neighbor;
+            }
+            reader.readU32(poly.detailTriangleStart);
+            reader.readU32(poly.detailTriangleCount);
+        }
+
+        reader.readU32(detailVertexCount);
+        if (reader.hasError() || detailVertexCount > reader.remaining() / 12) {
+            SPARKY_LOG_ERROR("Corrupt navigation mesh detail vertices");
+            return false;
+        }
+        std::vector<glm::vec3> detailVertices(detailVertexCount);
+        for (auto& vertex : detailVertices) {
+            reader.readVec3(vertex);
+        }
+        reader.readU32(detailIndexCount);
+        const char* indexData = reader.view(static_cast<size_t>(detailIndexCount) * sizeof(uint32_t));
+        if (!indexData || reader.hasError() || detailIndexCount % 3 != 0) {
+            SPARKY_LOG_ERROR("Corrupt navigation mesh detail triangles");
+            return false;
+        }
+        std::vector<uint32_t> detailTriangles(detailIndexCount);
+        std::memcpy(detailTriangles.data(), indexData, detailIndexCount * sizeof(uint32_t));
+        for (uint32_t index : detailTriangles) {
+            if (index >= detailVertexCount) {
+                SPARKY_LOG_ERROR("Corrupt navigation mesh detail triangles");
+                return false;
+            }
+        }
+        for (const auto& poly : polys) {
+            if (static_cast<uint64_t>(poly.detailTriangleStart) + poly.detailTriangleCount > detailIndexCount / 3) {
+                SPARKY_LOG_ERROR("Corrupt navigation mesh detail range");
+                return false;
+            }
+        }
+
+        m_sourceHash = sourceHash;
+        m_vertices = std::move(vertices);
+        m_polys = std::move(polys);
+        m_detailVertices = std::move(detailVertices);
+        m_detailTriangles = std::move(detailTriangles);
+        buildSearchIndex();
+        return true;
+    }
+
+    bool NavPolyMesh::saveToFile(const std::string& filepath) const {
+        SaveArchive archive;
+        writeTo(archive);
+        return archive.saveToFile(filepath);
+    }
+
+    bool NavPolyMesh::loadFromFile(const std::string& filepath) {
+        SaveArchive archive;
+        return archive.loadFromFile(filepath) && readFrom(archive);
+    }
+}
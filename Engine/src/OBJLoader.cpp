@@ -13,6 +13,7 @@ namespace Sparky {
             SPARKY_LOG_ERROR("Failed to parse OBJ file: " + filepath);
             return nullptr;
         }
+        mesh->computeBounds();
         
         SPARKY_LOG_INFO("Loaded OBJ file: " + filepath + 
                        " with " + std::to_string(mesh->vertices.size()) + " vertices and " + 
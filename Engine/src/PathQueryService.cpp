@@ -0,0 +1,383 @@
+#include "../include/PathQueryService.h"
+#include "../include/AdvancedAI.h"
+#include "../include/JobSystem.h"
+#include "../include/Logger.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Sparky {
+    bool PathQueryService::CellKey::operator==(const CellKey& other) const {
+        return std::equal(cells, cells + 6, other.cells);
+    }
+
+    size_t PathQueryService::CellKeyHash::operator()(const CellKey& key) const {
+        // FNV-1a over the six cell coordinates
+        uint64_t hash = 14695981039346656037ULL;
+        for (int32_t cell : key.cells) {
+            hash ^= static_cast<uint32_t>(cell);
+            hash *= 1099511628211ULL;
+        }
+        return static_cast<size_t>(hash);
+    }
+
+    bool PathQueryService::QueueEntry::operator<(const QueueEntry& other) const {
+        // priority_queue pops the largest: highest priority, then oldest
+        if (priority != other.priority) {
+            return priority < other.priority;
+        }
+        return sequence > other.sequence;
+    }
+
+    PathQueryService::PathQueryService(NavigationMesh* navMesh, const PathQuerySettings& settings)
+        : m_navMesh(navMesh)
+        , m_jobSystem(nullptr)
+        , m_settings(settings)
+        , m_nextTicket(INVALID_PATH_TICKET + 1)
+        , m_nextSequence(0)
+        , m_queuedCount(0)
+        , m_inFlight(0)
+        , m_jobCounter(std::make_unique<JobCounter>())
+        , m_stats()
+        , m_totalLatencyMs(0.0)
+        , m_latencySamples(0) {
+        if (m_settings.cellSize <= 0.0f) {
+            SPARKY_LOG_WARNING("PathQueryService: cell size must be positive, using 0.5");
+            m_settings.cellSize = 0.5f;
+        }
+        m_settings.maxConcurrentQueries = std::max(m_settings.maxConcurrentQueries, 1);
+    }
+
+    PathQueryService::~PathQueryService() {
+        // Running jobs point back at this service
+        if (!m_jobCounter->isDone()) {
+            getJobSystem().wait(*m_jobCounter);
+        }
+    }
+
+    std::unique_ptr<PathQueryService> PathQueryService::create(NavigationMesh* navMesh, const PathQuerySettings& settings) {
+        return std::make_unique<PathQueryService>(navMesh, settings);
+    }
+
+    PathTicket PathQueryService::submit(const glm::vec3& start, const glm::vec3& end, PathQueryPriority priority) {
+        if (!m_navMesh) {
+            SPARKY_LOG_ERROR("PathQueryService: no navigation mesh to search");
+            return INVALID_PATH_TICKET;
+        }
+
+        CellKey key = makeKey(start, end);
+        uint32_t revision = m_navMesh->getRevision();
+        Clock::time_point now = Clock::now();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        PathTicket ticket = m_nextTicket++;
+        if (m_nextTicket == INVALID_PATH_TICKET) {
+            m_nextTicket++;
+        }
+
+        TicketState& state = m_tickets[ticket];
+        state.status = PathQueryStatus::PENDING;
+        state.start = start;
+        state.end = end;
+        state.key = key;
+        state.submitTime = now;
+        m_stats.submitted++;
+
+        CacheEntry* cached = nullptr;
+        if (lookupCache(key, revision, cached)) {
+            m_stats.cacheHits++;
+            deliver(state, cached->start, cached->end, cached->path, now);
+            return ticket;
+        }
+
+        auto requestIt = m_requests.find(key);
+        if (requestIt != m_requests.end()) {
+            Request& request = requestIt->second;
+            request.tickets.push_back(ticket);
+            m_stats.deduplicated++;
+
+            if (!request.dispatched && priority > request.priority) {
+                // The old heap entry goes stale and is skipped when popped
+                request.priority = priority;
+                m_queue.push(QueueEntry{priority, request.sequence, key});
+            }
+            return ticket;
+        }
+
+        Request& request = m_requests[key];
+        request.start = start;
+        request.end = end;
+        request.priority = priority;
+        request.sequence = m_nextSequence++;
+        request.revision = revision;
+        request.dispatched = false;
+        request.tickets.push_back(ticket);
+        m_queue.push(QueueEntry{priority, request.sequence, key});
+
+        m_queuedCount++;
+        m_stats.peakQueueDepth = std::max(m_stats.peakQueueDepth, m_queuedCount);
+        return ticket;
+    }
+
+    PathQueryStatus PathQueryService::getStatus(PathTicket ticket) const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_tickets.find(ticket);
+        return it != m_tickets.end() ? it->second.status : PathQueryStatus::UNKNOWN;
+    }
+
+    bool PathQueryService::takeResult(PathTicket ticket, std::vector<glm::vec3>& path) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        path.clear();
+
+        auto it = m_tickets.find(ticket);
+        if (it == m_tickets.end() || it->second.status == PathQueryStatus::PENDING) {
+            return false;
+        }
+
+        path.swap(it->second.path);
+        m_tickets.erase(it);
+        return true;
+    }
+
+    void PathQueryService::cancel(PathTicket ticket) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        auto it = m_tickets.find(ticket);
+        if (it == m_tickets.end()) {
+            return;
+        }
+
+        if (it->second.status == PathQueryStatus::PENDING) {
+            auto requestIt = m_requests.find(it->second.key);
+            if (requestIt != m_requests.end()) {
+                Request& request = requestIt->second;
+                request.tickets.erase(std::remove(request.tickets.begin(), request.tickets.end(), ticket),
+                                      request.tickets.end());
+
+                // A running search still finishes and fills the cache
+                if (request.tickets.empty() && !request.dispatched) {
+                    m_requests.erase(requestIt);
+                    m_queuedCount--;
+                }
+            }
+            m_stats.cancelled++;
+        }
+
+        m_tickets.erase(it);
+    }
+
+    void PathQueryService::update() {
+        Clock::time_point begin = Clock::now();
+
+        bool useWorkers = m_settings.mode == PathQueryMode::WORKER_THREADS && getJobSystem().getWorkerCount() > 0;
+        CellKey key;
+
+        if (useWorkers) {
+            for (;;) {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    if (m_inFlight >= static_cast<size_t>(m_settings.maxConcurrentQueries)) {
+                        break;
+                    }
+                }
+
+                if (!popRequest(key)) {
+                    break;
+                }
+
+                getJobSystem().run([this, key]() { runSearch(key); }, m_jobCounter.get(), "PathQuery");
+            }
+        } else {
+            // Always make progress, even if a single search is over budget
+            double budgetMs = m_settings.frameBudgetMs;
+            do {
+                if (!popRequest(key)) {
+                    break;
+                }
+                runSearch(key);
+            } while (std::chrono::duration<double, std::milli>(Clock::now() - begin).count() < budgetMs);
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.lastUpdateMs = std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+    }
+
+    void PathQueryService::flush() {
+        CellKey key;
+        while (popRequest(key)) {
+            runSearch(key);
+        }
+
+        if (!m_jobCounter->isDone()) {
+            getJobSystem().wait(*m_jobCounter);
+        }
+    }
+
+    void PathQueryService::invalidateCache() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_cache.clear();
+        m_cacheIndex.clear();
+    }
+
+    PathQueryStats PathQueryService::getStats() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        PathQueryStats stats = m_stats;
+        stats.queueDepth = m_queuedCount;
+        stats.inFlight = m_inFlight;
+        stats.averageLatencyMs = m_latencySamples > 0 ? m_totalLatencyMs / m_latencySamples : 0.0;
+        return stats;
+    }
+
+    void PathQueryService::resetStats() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats = PathQueryStats();
+        m_stats.peakQueueDepth = m_queuedCount;
+        m_totalLatencyMs = 0.0;
+        m_latencySamples = 0;
+    }
+
+    PathQueryService::CellKey PathQueryService::makeKey(const glm::vec3& start, const glm::vec3& end) const {
+        float inverseCell = 1.0f / m_settings.cellSize;
+        CellKey key;
+        for (int axis = 0; axis < 3; ++axis) {
+            key.cells[axis] = static_cast<int32_t>(std::floor(start[axis] * inverseCell));
+            key.cells[axis + 3] = static_cast<int32_t>(std::floor(end[axis] * inverseCell));
+        }
+        return key;
+    }
+
+    bool PathQueryService::popRequest(CellKey& key) {
+        uint32_t revision = m_navMesh ? m_navMesh->getRevision() : 0;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        while (!m_queue.empty()) {
+            QueueEntry entry = m_queue.top();
+            m_queue.pop();
+
+            auto it = m_requests.find(entry.key);
+            if (it == m_requests.end()) {
+                continue;
+            }
+
+            Request& request = it->second;
+            if (request.dispatched || request.sequence != entry.sequence || request.priority != entry.priority) {
+                continue;
+            }
+
+            request.dispatched = true;
+            request.revision = revision;
+            m_queuedCount--;
+            m_inFlight++;
+            key = entry.key;
+            return true;
+        }
+        return false;
+    }
+
+    void PathQueryService::runSearch(const CellKey& key) {
+        glm::vec3 start;
+        glm::vec3 end;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            const Request& request = m_requests.at(key);
+            start = request.start;
+            end = request.end;
+        }
+
+        std::vector<glm::vec3> path = m_navMesh->findPath(start, end);
+        completeRequest(key, path);
+    }
+
+    void PathQueryService::completeRequest(const CellKey& key, std::vector<glm::vec3>& path) {
+        Clock::time_point now = Clock::now();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        auto requestIt = m_requests.find(key);
+        if (requestIt == m_requests.end()) {
+            return;
+        }
+        Request& request = requestIt->second;
+
+        for (PathTicket ticket : request.tickets) {
+            auto it = m_tickets.find(ticket);
+            if (it != m_tickets.end()) {
+                deliver(it->second, request.start, request.end, path, now);
+            }
+        }
+
+        storeCache(key, request, path);
+
+        m_stats.completed++;
+        if (path.empty()) {
+            m_stats.failed++;
+        }
+
+        m_requests.erase(requestIt);
+        m_inFlight--;
+    }
+
+    void PathQueryService::deliver(TicketState& state, const glm::vec3& start, const glm::vec3& end,
+                                   const std::vector<glm::vec3>& path, Clock::time_point now) {
+        state.path = path;
+        state.status = path.empty() ? PathQueryStatus::FAILED : PathQueryStatus::READY;
+
+        // The search ran from a neighbour in the same cells; keep this ticket's own
+        // endpoints wherever the path kept the searched ones
+        if (!state.path.empty()) {
+            if (state.path.front() == start) {
+                state.path.front() = state.start;
+            }
+            if (state.path.size() > 1 && state.path.back() == end) {
+                state.path.back() = state.end;
+            }
+        }
+
+        double latencyMs = std::chrono::duration<double, std::milli>(now - state.submitTime).count();
+        m_totalLatencyMs += latencyMs;
+        m_latencySamples++;
+        m_stats.maxLatencyMs = std::max(m_stats.maxLatencyMs, latencyMs);
+    }
+
+    bool PathQueryService::lookupCache(const CellKey& key, uint32_t revision, CacheEntry*& entry) {
+        auto it = m_cacheIndex.find(key);
+        if (it == m_cacheIndex.end()) {
+            return false;
+        }
+
+        if (it->second->revision != revision) {
+            // The mesh changed since this path was found
+            m_cache.erase(it->second);
+            m_cacheIndex.erase(it);
+            return false;
+        }
+
+        m_cache.splice(m_cache.begin(), m_cache, it->second);
+        entry = &m_cache.front();
+        return true;
+    }
+
+    void PathQueryService::storeCache(const CellKey& key, const Request& request, const std::vector<glm::vec3>& path) {
+        if (m_settings.cacheCapacity == 0) {
+            return;
+        }
+
+        auto it = m_cacheIndex.find(key);
+        if (it != m_cacheIndex.end()) {
+            m_cache.erase(it->second);
+            m_cacheIndex.erase(it);
+        }
+
+        m_cache.push_front(CacheEntry{key, request.start, request.end, request.revision, path});
+        m_cacheIndex[key] = m_cache.begin();
+
+        if (m_cache.size() > m_settings.cacheCapacity) {
+            m_cacheIndex.erase(m_cache.back().key);
+            m_cache.pop_back();
+        }
+    }
+
+    JobSystem& PathQueryService::getJobSystem() const {
+        return m_jobSystem ? *m_jobSystem : JobSystem::getInstance();
+    }
+}
@@ -0,0 +1,400 @@
+#include "../include/PerceptionSystem.h"
+#include "../include/GameObject.h"
+#include "../include/JobSystem.h"
+#include "../include/Logger.h"
+#include "../include/SimdConfig.h"
+#include "../include/StaticBVH.h"
+#include "../include/TimingUtils.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace Sparky {
+    namespace {
+        const size_t kBatchSize = 32;   // Observers per culling job
+
+        float cosHalfAngle(float fieldOfView) {
+            return std::cos(glm::radians(std::min(std::max(fieldOfView, 0.0f), 360.0f) * 0.5f));
+        }
+
+        // Range and cone test without square roots. dot >= cos * |d| splits on
+        // the sign of cos: narrow cones need dot in front and dot^2 large enough,
+        // cones wider than 180 degrees only reject points behind and close to the axis.
+        bool inCone(float distanceSq, float dot, float rangeSq, float cosHalf, float cosHalfSq) {
+            if (distanceSq > rangeSq) return false;
+            if (cosHalf >= 0.0f) return dot >= 0.0f && dot * dot >= cosHalfSq * distanceSq;
+            return dot >= 0.0f || dot * dot <= cosHalfSq * distanceSq;
+        }
+    }
+
+    PerceptionSystem::PerceptionSystem()
+        : PerceptionSystem(PerceptionSettings()) {
+    }
+
+    PerceptionSystem::PerceptionSystem(const PerceptionSettings& settings)
+        : m_settings(settings)
+        , m_jobSystem(nullptr)
+        , m_occluders(nullptr)
+        , m_frame(0)
+        , m_observerCount(0)
+        , m_targetCount(0)
+        , m_gridOrigin(0.0f)
+        , m_cellSize(1.0f)
+        , m_gridWidth(0)
+        , m_gridHeight(0)
+        , m_stats() {
+        if (m_settings.cellSize <= 0.0f) {
+            SPARKY_LOG_WARNING("PerceptionSystem: cell size must be positive, using 16");
+            m_settings.cellSize = 16.0f;
+        }
+        if (m_settings.normalInterval < 1) {
+            SPARKY_LOG_WARNING("PerceptionSystem: normal interval must be at least 1, using 3");
+            m_settings.normalInterval = 3;
+        }
+        if (m_settings.lowInterval < 1) {
+            SPARKY_LOG_WARNING("PerceptionSystem: low interval must be at least 1, using 8");
+            m_settings.lowInterval = 8;
+        }
+    }
+
+    std::unique_ptr<PerceptionSystem> PerceptionSystem::create(const PerceptionSettings& settings) {
+        return std::make_unique<PerceptionSystem>(settings);
+    }
+
+    PerceptionObserverId PerceptionSystem::addObserver(const glm::vec3& position, const glm::vec3& forward, float range,
+                                                       float fieldOfView, PerceptionPriority priority, GameObject* object) {
+        int slot;
+        if (!m_freeObservers.empty()) {
+            slot = m_freeObservers.back();
+            m_freeObservers.pop_back();
+        } else {
+            slot = static_cast<int>(m_observerActive.size());
+            m_observerPosition.push_back(glm::vec3(0.0f));
+            m_observerForward.push_back(glm::vec3(0.0f));
+            m_observerRange.push_back(0.0f);
+            m_observerCosHalfFov.push_back(1.0f);
+            m_observerPriority.push_back(PerceptionPriority::NORMAL);
+            m_observerObject.push_back(nullptr);
+            m_observerActive.push_back(0);
+            m_visible.emplace_back();
+        }
+
+        m_observerPosition[slot] = position;
+        m_observerForward[slot] = forward;
+        m_observerRange[slot] = std::max(range, 0.0f);
+        m_observerCosHalfFov[slot] = cosHalfAngle(fieldOfView);
+        m_observerPriority[slot] = priority;
+        m_observerObject[slot] = object;
+        m_observerActive[slot] = 1;
+        m_visible[slot].clear();
+        ++m_observerCount;
+        return slot;
+    }
+
+    void PerceptionSystem::removeObserver(PerceptionObserverId observer) {
+        if (observer < 0 || observer >= static_cast<int>(m_observerActive.size()) || !m_observerActive[observer]) return;
+        m_observerActive[observer] = 0;
+        m_visible[observer].clear();
+        m_freeObservers.push_back(observer);
+        --m_observerCount;
+    }
+
+    void PerceptionSystem::setObserverTransform(PerceptionObserverId observer, const glm::vec3& position, const glm::vec3& forward) {
+        if (observer < 0 || observer >= static_cast<int>(m_observerActive.size())) return;
+        m_observerPosition[observer] = position;
+        m_observerForward[observer] = forward;
+    }
+
+    void PerceptionSystem::setObserverVision(PerceptionObserverId observer, float range, float fieldOfView) {
+        if (observer < 0 || observer >= static_cast<int>(m_observerActive.size())) return;
+        m_observerRange[observer] = std::max(range, 0.0f);
+        m_observerCosHalfFov[observer] = cosHalfAngle(fieldOfView);
+    }
+
+    void PerceptionSystem::setObserverPriority(PerceptionObserverId observer, PerceptionPriority priority) {
+        if (observer < 0 || observer >= static_cast<int>(m_observerActive.size())) return;
+        m_observerPriority[observer] = priority;
+    }
+
+    PerceptionTargetId PerceptionSystem::addTarget(const glm::vec3& position, GameObject* object) {
+        int slot;
+        if (!m_freeTargets.empty()) {
+            slot = m_freeTargets.back();
+            m_freeTargets.pop_back();
+        } else {
+            slot = static_cast<int>(m_targetActive.size());
+            m_targetPosition.push_back(glm::vec3(0.0f));
+            m_targetObject.push_back(nullptr);
+            m_targetActive.push_back(0);
+        }
+
+        m_targetPosition[slot] = position;
+        m_targetObject[slot] = object;
+        m_targetActive[slot] = 1;
+        ++m_targetCount;
+        return slot;
+    }
+
+    void PerceptionSystem::removeTarget(PerceptionTargetId target) {
+        if (target < 0 || target >= static_cast<int>(m_targetActive.size()) || !m_targetActive[target]) return;
+        m_targetActive[target] = 0;
+        m_targetObject[target] = nullptr;
+        m_freeTargets.push_back(target);
+        --m_targetCount;
+
+        // The slot will be reused, so it must not linger in anyone's visible set
+        for (std::vector<PerceptionTargetId>& visible : m_visible) {
+            visible.erase(std::remove(visible.begin(), visible.end(), target), visible.end());
+        }
+    }
+
+    void PerceptionSystem::setTargetPosition(PerceptionTargetId target, const glm::vec3& position) {
+        if (target < 0 || target >= static_cast<int>(m_targetActive.size())) return;
+        m_targetPosition[target] = position;
+    }
+
+    int PerceptionSystem::getInterval(PerceptionPriority priority) const {
+        switch (priority) {
+            case PerceptionPriority::HIGH:
+                return 1;
+            case PerceptionPriority::NORMAL:
+                return m_settings.normalInterval;
+            case PerceptionPriority::LOW:
+                return m_settings.lowInterval;
+        }
+        return 1;
+    }
+
+    void PerceptionSystem::update() {
+        ++m_frame;
+        m_stats = PerceptionStats();
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t target = 0; target < m_targetActive.size(); ++target) {
+            if (m_targetActive[target] && m_targetObject[target]) {
+                m_targetPosition[target] = m_targetObject[target]->getPosition();
+            }
+        }
+        rebuildGrid();
+        m_stats.gridMs = elapsedMs(start);
+
+        // Observers due this frame, staggered by id within their interval
+        start = std::chrono::steady_clock::now();
+        size_t batchCount = 0;
+        for (size_t observer = 0; observer < m_observerActive.size(); ++observer) {
+            if (!m_observerActive[observer]) continue;
+            uint32_t interval = static_cast<uint32_t>(getInterval(m_observerPriority[observer]));
+            if ((m_frame + static_cast<uint32_t>(observer)) % interval != 0) continue;
+
+            if (m_stats.observersUpdated % kBatchSize == 0) {
+                if (m_batches.size() <= batchCount) m_batches.emplace_back();
+                m_batches[batchCount].observers.clear();
+                ++batchCount;
+            }
+            m_batches[batchCount - 1].observers.push_back(static_cast<int>(observer));
+            ++m_stats.observersUpdated;
+        }
+
+        auto cullBatches = [this](size_t begin, size_t end) {
+            for (size_t index = begin; index < end; ++index) {
+                Batch& batch = m_batches[index];
+                batch.pairObserver.clear();
+                batch.pairTarget.clear();
+                batch.candidates = 0;
+                for (int observer : batch.observers) {
+                    cullObserver(observer, batch);
+                }
+            }
+        };
+        if (m_jobSystem && m_jobSystem->getWorkerCount() > 0 && batchCount > 1) {
+            m_jobSystem->parallelFor(batchCount, 1, cullBatches);
+        } else {
+            cullBatches(0, batchCount);
+        }
+        m_stats.cullMs = elapsedMs(start);
+
+        // One batch of line-of-sight segments for every pair that survived the cone
+        start = std::chrono::steady_clock::now();
+        m_rayFrom.clear();
+        m_rayTo.clear();
+        const glm::vec3 eyeOffset(0.0f, m_settings.eyeHeight, 0.0f);
+        const glm::vec3 targetOffset(0.0f, m_settings.targetHeight, 0.0f);
+        for (size_t index = 0; index < batchCount; ++index) {
+            const Batch& batch = m_batches[index];
+            m_stats.candidatePairs += batch.candidates;
+            for (size_t pair = 0; pair < batch.pairObserver.size(); ++pair) {
+                m_rayFrom.push_back(m_observerPosition[batch.pairObserver[pair]] + eyeOffset);
+                m_rayTo.push_back(m_targetPosition[batch.pairTarget[pair]] + targetOffset);
+            }
+        }
+        m_stats.conePairs = m_rayFrom.size();
+        m_rayOccluded.assign(m_rayFrom.size(), 0);
+        if (m_occluders && m_occluders->isBuilt()) {
+            m_occluders->isOccludedBatch(m_rayFrom.data(), m_rayTo.data(), m_rayFrom.size(), m_rayOccluded.data(), m_jobSystem);
+        }
+
+        size_t ray = 0;
+        for (size_t index = 0; index < batchCount; ++index) {
+            const Batch& batch = m_batches[index];
+            for (int observer : batch.observers) {
+                m_visible[observer].clear();
+            }
+            for (size_t pair = 0; pair < batch.pairObserver.size(); ++pair, ++ray) {
+                if (m_rayOccluded[ray]) {
+                    ++m_stats.occludedPairs;
+                } else {
+                    m_visible[batch.pairObserver[pair]].push_back(batch.pairTarget[pair]);
+                }
+            }
+            for (int observer : batch.observers) {
+                std::sort(m_visible[observer].begin(), m_visible[observer].end());
+            }
+        }
+        m_stats.raycastMs = elapsedMs(start);
+    }
+
+    void PerceptionSystem::rebuildGrid() {
+        glm::vec2 minBounds(0.0f), maxBounds(0.0f);
+        bool first = true;
+        for (size_t target = 0; target < m_targetActive.size(); ++target) {
+            if (!m_targetActive[target]) continue;
+            glm::vec2 position(m_targetPosition[target].x, m_targetPosition[target].z);
+            minBounds = first ? position : glm::min(minBounds, position);
+            maxBounds = first ? position : glm::max(maxBounds, position);
+            first = false;
+        }
+
+        // Coarser cells when targets are so spread out that cells would outnumber them
+        m_cellSize = m_settings.cellSize;
+        glm::vec2 extent = maxBounds - minBounds;
+        size_t cellLimit = std::max<size_t>(64, static_cast<size_t>(m_targetCount) * 4);
+        while ((static_cast<size_t>(extent.x / m_cellSize) + 1) * (static_cast<size_t>(extent.y / m_cellSize) + 1) > cellLimit) {
+            m_cellSize *= 2.0f;
+        }
+        m_gridOrigin = minBounds;
+        m_gridWidth = static_cast<int>(extent.x / m_cellSize) + 1;
+        m_gridHeight = static_cast<int>(extent.y / m_cellSize) + 1;
+
+        // Counting sort of targets by cell, copying positions out so each row
+        // of cells is one contiguous run per axis
+        size_t cellCount = static_cast<size_t>(m_gridWidth) * m_gridHeight;
+        m_cellStart.assign(cellCount + 1, 0);
+        std::vector<int> targetCell(m_targetActive.size(), -1);
+        for (size_t target = 0; target < m_targetActive.size(); ++target) {
+            if (!m_targetActive[target]) continue;
+            int cx = std::min(static_cast<int>((m_targetPosition[target].x - m_gridOrigin.x) / m_cellSize), m_gridWidth - 1);
+            int cz = std::min(static_cast<int>((m_targetPosition[target].z - m_gridOrigin.y) / m_cellSize), m_gridHeight - 1);
+            targetCell[target] = cz * m_gridWidth + cx;
+            ++m_cellStart[targetCell[target] + 1];
+        }
+        for (size_t cell = 0; cell < cellCount; ++cell) {
+            m_cellStart[cell + 1] += m_cellStart[cell];
+        }
+        m_cellX.resize(m_targetCount);
+        m_cellY.resize(m_targetCount);
+        m_cellZ.resize(m_targetCount);
+        m_cellTarget.resize(m_targetCount);
+        std::vector<uint32_t> cursor(m_cellStart.begin(), m_cellStart.end() - 1);
+        for (size_t target = 0; target < m_targetActive.size(); ++target) {
+            if (targetCell[target] < 0) continue;
+            uint32_t slot = cursor[targetCell[target]]++;
+            m_cellX[slot] = m_targetPosition[target].x;
+            m_cellY[slot] = m_targetPosition[target].y + m_settings.targetHeight;
+            m_cellZ[slot] = m_targetPosition[target].z;
+            m_cellTarget[slot] = static_cast<int>(target);
+        }
+    }
+
+    void PerceptionSystem::cullObserver(int observer, Batch& batch) const {
+        if (m_targetCount == 0) return;
+        const glm::vec3 eye = m_observerPosition[observer] + glm::vec3(0.0f, m_settings.eyeHeight, 0.0f);
+        const glm::vec3 forward = m_observerForward[observer];
+        const float range = m_observerRange[observer];
+        const float rangeSq = range * range;
+        const float cosHalf = m_observerCosHalfFov[observer];
+        const float cosHalfSq = cosHalf * cosHalf;
+        const GameObject* self = m_observerObject[observer];
+
+        // Cells overlapping the square around the vision circle
+        int minX = static_cast<int>(std::floor((eye.x - range - m_gridOrigin.x) / m_cellSize));
+        int maxX = static_cast<int>(std::floor((eye.x + range - m_gridOrigin.x) / m_cellSize));
+        int minZ = static_cast<int>(std::floor((eye.z - range - m_gridOrigin.y) / m_cellSize));
+        int maxZ = static_cast<int>(std::floor((eye.z + range - m_gridOrigin.y) / m_cellSize));
+        if (maxX < 0 || maxZ < 0 || minX >= m_gridWidth || minZ >= m_gridHeight) return;
+        minX = std::max(minX, 0);
+        minZ = std::max(minZ, 0);
+        maxX = std::min(maxX, m_gridWidth - 1);
+        maxZ = std::min(maxZ, m_gridHeight - 1);
+
+        auto accept = [&](uint32_t slot) {
+            int target = m_cellTarget[slot];
+            if (self && m_targetObject[target] == self) return;
+            batch.pairObserver.push_back(observer);
+            batch.pairTarget.push_back(target);
+        };
+
+#ifdef SPARKY_SSE
+        const __m128 eyeX = _mm_set1_ps(eye.x);
+        const __m128 eyeY = _mm_set1_ps(eye.y);
+        const __m128 eyeZ = _mm_set1_ps(eye.z);
+        const __m128 forwardX = _mm_set1_ps(forward.x);
+        const __m128 forwardY = _mm_set1_ps(forward.y);
+        const __m128 forwardZ = _mm_set1_ps(forward.z);
+        const __m128 range4 = _mm_set1_ps(rangeSq);
+        const __m128 cosHalf4 = _mm_set1_ps(cosHalfSq);
+        const __m128 zero = _mm_setzero_ps();
+#endif
+
+        for (int cz = minZ; cz <= maxZ; ++cz) {
+            uint32_t i = m_cellStart[cz * m_gridWidth + minX];
+            const uint32_t end = m_cellStart[cz * m_gridWidth + maxX + 1];
+            batch.candidates += end - i;
+
+#ifdef SPARKY_SSE
+            for (; i + 4 <= end; i += 4) {
+                __m128 dx = _mm_sub_ps(_mm_loadu_ps(&m_cellX[i]), eyeX);
+                __m128 dy = _mm_sub_ps(_mm_loadu_ps(&m_cellY[i]), eyeY);
+                __m128 dz = _mm_sub_ps(_mm_loadu_ps(&m_cellZ[i]), eyeZ);
+                __m128 distanceSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+                __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(forwardX, dx), _mm_mul_ps(forwardY, dy)), _mm_mul_ps(forwardZ, dz));
+                __m128 front = _mm_cmpge_ps(dot, zero);
+                __m128 dotSq = _mm_mul_ps(dot, dot);
+                __m128 limit = _mm_mul_ps(cosHalf4, distanceSq);
+                __m128 cone = cosHalf >= 0.0f ? _mm_and_ps(front, _mm_cmpge_ps(dotSq, limit))
+                                              : _mm_or_ps(front, _mm_cmple_ps(dotSq, limit));
+                int mask = _mm_movemask_ps(_mm_and_ps(cone, _mm_cmple_ps(distanceSq, range4)));
+                for (uint32_t lane = 0; mask != 0; ++lane, mask >>= 1) {
+                    if (mask & 1) accept(i + lane);
+                }
+            }
+#endif
+            for (; i < end; ++i) {
+                float dx = m_cellX[i] - eye.x;
+                float dy = m_cellY[i] - eye.y;
+                float dz = m_cellZ[i] - eye.z;
+                float distanceSq = dx * dx + dy * dy + dz * dz;
+                float dot = forward.x * dx + forward.y * dy + forward.z * dz;
+                if (inCone(distanceSq, dot, rangeSq, cosHalf, cosHalfSq)) accept(i);
+            }
+        }
+    }
+
+    const std::vector<PerceptionTargetId>& PerceptionSystem::getVisibleTargets(PerceptionObserverId observer) const {
+        static const std::vector<PerceptionTargetId> none;
+        if (observer < 0 || observer >= static_cast<int>(m_observerActive.size())) return none;
+        return m_visible[observer];
+    }
+
+    bool PerceptionSystem::canSee(PerceptionObserverId observer, PerceptionTargetId target) const {
+        const std::vector<PerceptionTargetId>& visible = getVisibleTargets(observer);
+        return std::binary_search(visible.begin(), visible.end(), target);
+    }
+
+    bool PerceptionSystem::canSee(PerceptionObserverId observer, const GameObject* object) const {
+        if (!object) return false;
+        for (PerceptionTargetId target : getVisibleTargets(observer)) {
+            if (m_targetObject[target] == object) return true;
+        }
+        return false;
+    }
+}
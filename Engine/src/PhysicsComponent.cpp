@@ -38,18 +38,22 @@ namespace Sparky {
 
     void PhysicsComponent::setVelocity(const glm::vec3& velocity) {
         this->velocity = velocity;
+        markOwnerDirty();
     }
 
     void PhysicsComponent::setAcceleration(const glm::vec3& acceleration) {
         this->acceleration = acceleration;
+        markOwnerDirty();
     }
 
     void PhysicsComponent::setMass(float mass) {
         this->mass = mass;
+        markOwnerDirty();
     }
 
     void PhysicsComponent::setGravity(const glm::vec3& gravity) {
         this->gravity = gravity;
+        markOwnerDirty();
     }
 
     void PhysicsComponent::setOnGround(bool onGround) {
@@ -59,5 +63,24 @@ namespace Sparky {
         if (onGround) {
             velocity.y = 0.0f;
         }
+        markOwnerDirty();
+    }
+
+    void PhysicsComponent::serialize(BinaryWriter& writer) const {
+        writer.writeVec3(velocity);
+        writer.writeVec3(acceleration);
+        writer.writeVec3(gravity);
+        writer.writeFloat(mass);
+        writer.writeBool(onGround);
+    }
+
+    bool PhysicsComponent::deserialize(BinaryReader& reader, uint16_t version) {
+        (void)version;
+        if (!reader.readVec3(velocity) || !reader.readVec3(acceleration) || !reader.readVec3(gravity) ||
+            !reader.readFloat(mass) || !reader.readBool(onGround)) {
+            return false;
+        }
+        markOwnerDirty();
+        return true;
     }
 }
\ No newline at end of file
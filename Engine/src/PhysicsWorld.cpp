@@ -214,19 +214,87 @@ namespace Sparky {
         return CollisionSystem::checkCollision(objA, objB);
     }
     
+    int PhysicsWorld::addStaticCollider(const glm::vec3& minBounds, const glm::vec3& maxBounds, GameObject* object) {
+        return staticGeometry.addBox(minBounds, maxBounds, object);
+    }
+    
+    void PhysicsWorld::clearStaticColliders() {
+        staticGeometry.clear();
+    }
+    
+    const StaticBVH& PhysicsWorld::getStaticGeometry() {
+        if (!staticGeometry.isBuilt()) {
+            staticGeometry.build();
+            SPARKY_LOG_DEBUG("Static geometry BVH built: " + std::to_string(staticGeometry.getBoxCount()) + " colliders, " +
+                            std::to_string(staticGeometry.getNodeCount()) + " nodes");
+        }
+        return staticGeometry;
+    }
+    
     RaycastHit PhysicsWorld::raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance) {
         RaycastHit result;
         result.hit = false;
         result.point = glm::vec3(0.0f);
         result.normal = glm::vec3(0.0f);
-        result.distance = 0.0f;
+        result.distance = maxDistance;
         result.object = nullptr;
         
-        // In a full implementation, we would check for intersections with all objects
-        // This is a simplified placeholder implementation
-        SPARKY_LOG_DEBUG("Raycast performed from (" + std::to_string(origin.x) + ", " + 
-                        std::to_string(origin.y) + ", " + std::to_string(origin.z) + ")");
+        // Static level geometry through the BVH
+        StaticBVHHit staticHit;
+        if (getStaticGeometry().raycast(origin, direction, maxDistance, staticHit)) {
+            result.hit = true;
+            result.normal = staticHit.normal;
+            result.distance = staticHit.distance;
+            result.object = staticGeometry.getBoxObject(staticHit.box);
+        }
         
+        // Moving objects are few enough to test directly against their boxes
+        for (PhysicsComponent* component : components) {
+            GameObject* object = component ? component->getOwner() : nullptr;
+            if (!object) continue;
+            
+            CollisionShapeData shape = CollisionSystem::getCollisionShapeData(object);
+            glm::vec3 halfSize = shape.size * 0.5f;
+            glm::vec3 minBounds = shape.position - halfSize;
+            glm::vec3 maxBounds = shape.position + halfSize;
+            
+            float entry = 0.0f;
+            float exit = result.distance;
+            int entryAxis = -1;
+            bool missed = false;
+            for (int axis = 0; axis < 3 && !missed; ++axis) {
+                if (std::abs(direction[axis]) < 1e-8f) {
+                    missed = origin[axis] < minBounds[axis] || origin[axis] > maxBounds[axis];
+                    continue;
+                }
+                float t1 = (minBounds[axis] - origin[axis]) / direction[axis];
+                float t2 = (maxBounds[axis] - origin[axis]) / direction[axis];
+                if (t1 > t2) std::swap(t1, t2);
+                if (t1 > entry) {
+                    entry = t1;
+                    entryAxis = axis;
+                }
+                exit = std::min(exit, t2);
+                missed = entry > exit;
+            }
+            if (missed || (result.hit && entry >= result.distance)) continue;
+            
+            result.hit = true;
+            result.distance = entry;
+            result.object = object;
+            result.normal = glm::vec3(0.0f);
+            if (entryAxis >= 0) {
+                result.normal[entryAxis] = direction[entryAxis] > 0.0f ? -1.0f : 1.0f;
+            } else {
+                result.normal = -direction;
+            }
+        }
+        
+        if (result.hit) {
+            result.point = origin + direction * result.distance;
+        } else {
+            result.distance = 0.0f;
+        }
         return result;
     }
     
@@ -0,0 +1,356 @@
+#include "../include/PoseRuntime.h"
+#include "../include/SimdConfig.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Sparky {
+    // The kernels read vectors, quaternions and matrices as packed floats (quaternions as x, y, z, w)
+    static_assert(sizeof(glm::vec3) == 3 * sizeof(float), "glm::vec3 must be three packed floats");
+    static_assert(sizeof(glm::quat) == 4 * sizeof(float), "glm::quat must be four packed floats");
+    static_assert(sizeof(glm::mat4) == 16 * sizeof(float), "glm::mat4 must be sixteen packed floats");
+
+    namespace {
+        float* floats(std::vector<glm::vec3>& values) { return &values[0].x; }
+        const float* floats(const std::vector<glm::vec3>& values) { return &values[0].x; }
+        float* floats(std::vector<glm::quat>& values) { return &values[0].x; }
+        const float* floats(const std::vector<glm::quat>& values) { return &values[0].x; }
+        float* floats(glm::mat4& matrix) { return &matrix[0][0]; }
+        const float* floats(const glm::mat4& matrix) { return &matrix[0][0]; }
+
+        void resizePose(AnimationPose& pose, int boneCount) {
+            pose.translations.resize(boneCount);
+            pose.rotations.resize(boneCount);
+            pose.scales.resize(boneCount);
+        }
+
+        // out = a + (b - a) * weight over count floats
+        void lerpFloats(const float* a, const float* b, float weight, float* out, int count) {
+            int i = 0;
+#ifdef SPARKY_SSE
+            const __m128 weight4 = _mm_set1_ps(weight);
+            for (; i + 4 <= count; i += 4) {
+                __m128 from = _mm_loadu_ps(a + i);
+                __m128 to = _mm_loadu_ps(b + i);
+                _mm_storeu_ps(out + i, _mm_add_ps(from, _mm_mul_ps(_mm_sub_ps(to, from), weight4)));
+            }
+#endif
+            for (; i < count; ++i) {
+                out[i] = a[i] + (b[i] - a[i]) * weight;
+            }
+        }
+
+        glm::quat nlerp(const glm::quat& a, const glm::quat& b, float weight) {
+            float sign = glm::dot(a, b) < 0.0f ? -1.0f : 1.0f;
+            return glm::normalize(a * (1.0f - weight) + b * (sign * weight));
+        }
+
+        glm::mat4 composeMatrix(const glm::vec3& translation, const glm::quat& rotation, const glm::vec3& scale) {
+            glm::mat4 matrix = glm::mat4_cast(rotation);
+            matrix[0] *= scale.x;
+            matrix[1] *= scale.y;
+            matrix[2] *= scale.z;
+            matrix[3] = glm::vec4(translation, 1.0f);
+            return matrix;
+        }
+
+#ifdef SPARKY_SSE
+        // 1/sqrt(x) with one Newton step, close to full float precision
+        __m128 reciprocalSqrt(__m128 x) {
+            __m128 estimate = _mm_rsqrt_ps(x);
+            __m128 correction = _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), x), _mm_mul_ps(estimate, estimate)));
+            return _mm_mul_ps(estimate, correction);
+        }
+
+        // Four quaternions from x, y, z, w order into one register per component, and back
+        struct Quat4 {
+            __m128 x, y, z, w;
+        };
+
+        Quat4 loadQuat4(const float* values) {
+            Quat4 q = {_mm_loadu_ps(values), _mm_loadu_ps(values + 4), _mm_loadu_ps(values + 8), _mm_loadu_ps(values + 12)};
+            _MM_TRANSPOSE4_PS(q.x, q.y, q.z, q.w);
+            return q;
+        }
+
+        void storeQuat4(Quat4 q, float* values) {
+            _MM_TRANSPOSE4_PS(q.x, q.y, q.z, q.w);
+            _mm_storeu_ps(values, q.x);
+            _mm_storeu_ps(values + 4, q.y);
+            _mm_storeu_ps(values + 8, q.z);
+            _mm_storeu_ps(values + 12, q.w);
+        }
+
+        Quat4 nlerp4(const Quat4& a, Quat4 b, __m128 weight) {
+            // Flip b where it is on the other hemisphere by copying the dot product's sign bit onto it
+            __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a.x, b.x), _mm_mul_ps(a.y, b.y)),
+                                    _mm_add_ps(_mm_mul_ps(a.z, b.z), _mm_mul_ps(a.w, b.w)));
+            __m128 sign = _mm_and_ps(dot, _mm_set1_ps(-0.0f));
+            b.x = _mm_xor_ps(b.x, sign);
+            b.y = _mm_xor_ps(b.y, sign);
+            b.z = _mm_xor_ps(b.z, sign);
+            b.w = _mm_xor_ps(b.w, sign);
+
+            Quat4 r;
+            r.x = _mm_add_ps(a.x, _mm_mul_ps(_mm_sub_ps(b.x, a.x), weight));
+            r.y = _mm_add_ps(a.y, _mm_mul_ps(_mm_sub_ps(b.y, a.y), weight));
+            r.z = _mm_add_ps(a.z, _mm_mul_ps(_mm_sub_ps(b.z, a.z), weight));
+            r.w = _mm_add_ps(a.w, _mm_mul_ps(_mm_sub_ps(b.w, a.w), weight));
+            __m128 lengthSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(r.x, r.x), _mm_mul_ps(r.y, r.y)),
+                                         _mm_add_ps(_mm_mul_ps(r.z, r.z), _mm_mul_ps(r.w, r.w)));
+            __m128 inverse = reciprocalSqrt(lengthSq);
+            r.x = _mm_mul_ps(r.x, inverse);
+            r.y = _mm_mul_ps(r.y, inverse);
+            r.z = _mm_mul_ps(r.z, inverse);
+            r.w = _mm_mul_ps(r.w, inverse);
+            return r;
+        }
+
+        Quat4 multiply4(const Quat4& p, const Quat4& q) {
+            Quat4 r;
+            r.w = _mm_sub_ps(_mm_sub_ps(_mm_mul_ps(p.w, q.w), _mm_mul_ps(p.x, q.x)), _mm_add_ps(_mm_mul_ps(p.y, q.y), _mm_mul_ps(p.z, q.z)));
+            r.x = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(p.w, q.x), _mm_mul_ps(p.x, q.w)), _mm_mul_ps(p.y, q.z)), _mm_mul_ps(p.z, q.y));
+            r.y = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(p.w, q.y), _mm_mul_ps(p.y, q.w)), _mm_mul_ps(p.z, q.x)), _mm_mul_ps(p.x, q.z));
+            r.z = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(p.w, q.z), _mm_mul_ps(p.z, q.w)), _mm_mul_ps(p.x, q.y)), _mm_mul_ps(p.y, q.x));
+            return r;
+        }
+
+        // Column-major out = a * b; out must not alias a or b
+        void multiplyMatrices(const float* a, const float* b, float* out) {
+            const __m128 a0 = _mm_loadu_ps(a);
+            const __m128 a1 = _mm_loadu_ps(a + 4);
+            const __m128 a2 = _mm_loadu_ps(a + 8);
+            const __m128 a3 = _mm_loadu_ps(a + 12);
+            for (int column = 0; column < 4; ++column) {
+                const float* b4 = b + column * 4;
+                __m128 result = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a0, _mm_set1_ps(b4[0])), _mm_mul_ps(a1, _mm_set1_ps(b4[1]))),
+                                           _mm_add_ps(_mm_mul_ps(a2, _mm_set1_ps(b4[2])), _mm_mul_ps(a3, _mm_set1_ps(b4[3]))));
+                _mm_storeu_ps(out + column * 4, result);
+            }
+        }
+#endif
+    }
+
+    void blendPoses(const AnimationPose& from, const AnimationPose& to, float weight, AnimationPose& result) {
+        const int boneCount = from.getBoneCount();
+        resizePose(result, boneCount);
+        if (boneCount == 0) return;
+
+        lerpFloats(floats(from.translations), floats(to.translations), weight, floats(result.translations), boneCount * 3);
+        lerpFloats(floats(from.scales), floats(to.scales), weight, floats(result.scales), boneCount * 3);
+
+        int bone = 0;
+#ifdef SPARKY_SSE
+        const __m128 weight4 = _mm_set1_ps(weight);
+        for (; bone + 4 <= boneCount; bone += 4) {
+            Quat4 a = loadQuat4(floats(from.rotations) + bone * 4);
+            Quat4 b = loadQuat4(floats(to.rotations) + bone * 4);
+            storeQuat4(nlerp4(a, b, weight4), floats(result.rotations) + bone * 4);
+        }
+#endif
+        for (; bone < boneCount; ++bone) {
+            result.rotations[bone] = nlerp(from.rotations[bone], to.rotations[bone], weight);
+        }
+    }
+
+    void makeAdditivePose(const AnimationPose& pose, const AnimationPose& reference, AnimationPose& additive) {
+        const int boneCount = pose.getBoneCount();
+        resizePose(additive, boneCount);
+        for (int bone = 0; bone < boneCount; ++bone) {
+            additive.translations[bone] = pose.translations[bone] - reference.translations[bone];
+            additive.rotations[bone] = glm::normalize(glm::conjugate(reference.rotations[bone]) * pose.rotations[bone]);
+            glm::vec3 referenceScale = reference.scales[bone];
+            for (int axis = 0; axis < 3; ++axis) {
+                additive.scales[bone][axis] = referenceScale[axis] != 0.0f ? pose.scales[bone][axis] / referenceScale[axis] : 1.0f;
+            }
+        }
+    }
+
+    void applyAdditivePose(const AnimationPose& base, const AnimationPose& additive, float weight, AnimationPose& result) {
+        const int boneCount = base.getBoneCount();
+        resizePose(result, boneCount);
+        if (boneCount == 0) return;
+
+        // translation + additive * weight and scale * (1 + (additive - 1) * weight), three floats per bone
+        const float* baseTranslations = floats(base.translations);
+        const float* addTranslations = floats(additive.translations);
+        const float* baseScales = floats(base.scales);
+        const float* addScales = floats(additive.scales);
+        float* outTranslations = floats(result.translations);
+        float* outScales = floats(result.scales);
+        const int count = boneCount * 3;
+        int i = 0;
+#ifdef SPARKY_SSE
+        const __m128 weight4 = _mm_set1_ps(weight);
+        const __m128 one = _mm_set1_ps(1.0f);
+        for (; i + 4 <= count; i += 4) {
+            __m128 translation = _mm_add_ps(_mm_loadu_ps(baseTranslations + i), _mm_mul_ps(_mm_loadu_ps(addTranslations + i), weight4));
+            __m128 factor = _mm_add_ps(one, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(addScales + i), one), weight4));
+            _mm_storeu_ps(outTranslations + i, translation);
+            _mm_storeu_ps(outScales + i, _mm_mul_ps(_mm_loadu_ps(baseScales + i), factor));
+        }
+#endif
+        for (; i < count; ++i) {
+            outTranslations[i] = baseTranslations[i] + addTranslations[i] * weight;
+            outScales[i] = baseScales[i] * (1.0f + (addScales[i] - 1.0f) * weight);
+        }
+
+        // base * nlerp(identity, additive, weight)
+        int bone = 0;
+#ifdef SPARKY_SSE
+        const Quat4 identity = {_mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps(), _mm_set1_ps(1.0f)};
+        for (; bone + 4 <= boneCount; bone += 4) {
+            Quat4 delta = nlerp4(identity, loadQuat4(floats(additive.rotations) + bone * 4), weight4);
+            Quat4 rotation = multiply4(loadQuat4(floats(base.rotations) + bone * 4), delta);
+            storeQuat4(rotation, floats(result.rotations) + bone * 4);
+        }
+#endif
+        for (; bone < boneCount; ++bone) {
+            glm::quat delta = nlerp(glm::quat(1.0f, 0.0f, 0.0f, 0.0f), additive.rotations[bone], weight);
+            result.rotations[bone] = base.rotations[bone] * delta;
+        }
+    }
+
+    AnimationSkeleton::AnimationSkeleton() {
+    }
+
+    void AnimationSkeleton::build(const std::vector<int>& parents, const std::vector<glm::mat4>& inverseBindPose) {
+        const int boneCount = static_cast<int>(parents.size());
+        m_parents = parents;
+        m_inverseBindPose = inverseBindPose;
+        m_inverseBindPose.resize(boneCount, glm::mat4(1.0f));
+
+        // Depth-first from the roots gives parents before children; whatever is left is in a cycle
+        std::vector<std::vector<int>> children(boneCount);
+        for (int bone = 0; bone < boneCount; ++bone) {
+            int parent = m_parents[bone];
+            if (parent >= 0 && parent < boneCount && parent != bone) {
+                children[parent].push_back(bone);
+            } else {
+                m_parents[bone] = -1;
+            }
+        }
+        std::vector<uint8_t> placed(boneCount, 0);
+        m_order.clear();
+        std::vector<int> stack;
+        for (int pass = 0; pass < 2; ++pass) {
+            for (int root = 0; root < boneCount; ++root) {
+                if (placed[root] || (pass == 0 && m_parents[root] >= 0)) continue;
+                if (pass == 1) m_parents[root] = -1;    // Breaks a cycle
+                stack.push_back(root);
+                while (!stack.empty()) {
+                    int bone = stack.back();
+                    stack.pop_back();
+                    if (placed[bone]) continue;
+                    placed[bone] = 1;
+                    m_order.push_back(bone);
+                    for (auto it = children[bone].rbegin(); it != children[bone].rend(); ++it) {
+                        stack.push_back(*it);
+                    }
+                }
+            }
+        }
+
+        // Keep id order when it is already valid, so the pass walks memory front to back
+        bool sorted = true;
+        for (int bone = 0; bone < boneCount && sorted; ++bone) {
+            sorted = m_parents[bone] < bone;
+        }
+        if (sorted) {
+            for (int bone = 0; bone < boneCount; ++bone) m_order[bone] = bone;
+        }
+    }
+
+    void AnimationSkeleton::computeModelTransforms(const AnimationPose& local, std::vector<glm::mat4>& model) const {
+        const int boneCount = std::min(getBoneCount(), local.getBoneCount());
+        model.resize(getBoneCount(), glm::mat4(1.0f));
+        for (int bone : m_order) {
+            if (bone >= boneCount) continue;
+            glm::mat4 transform = composeMatrix(local.translations[bone], local.rotations[bone], local.scales[bone]);
+            int parent = m_parents[bone];
+            if (parent < 0) {
+                model[bone] = transform;
+                continue;
+            }
+#ifdef SPARKY_SSE
+            multiplyMatrices(floats(model[parent]), floats(transform), floats(model[bone]));
+#else
+            model[bone] = model[parent] * transform;
+#endif
+        }
+    }
+
+    void AnimationSkeleton::computeSkinningMatrices(const std::vector<glm::mat4>& model, std::vector<glm::mat4>& skinning) const {
+        const int boneCount = std::min(getBoneCount(), static_cast<int>(model.size()));
+        skinning.resize(boneCount);
+        for (int bone = 0; bone < boneCount; ++bone) {
+#ifdef SPARKY_SSE
+            multiplyMatrices(floats(model[bone]), floats(m_inverseBindPose[bone]), floats(skinning[bone]));
+#else
+            skinning[bone] = model[bone] * m_inverseBindPose[bone];
+#endif
+        }
+    }
+
+    void skinVertices(const std::vector<Vertex>& bindVertices, const std::vector<VertexSkin>& skin,
+                      const std::vector<glm::mat4>& skinning, std::vector<Vertex>& skinned) {
+        const size_t vertexCount = std::min(bindVertices.size(), skin.size());
+        const int boneCount = static_cast<int>(skinning.size());
+        skinned.resize(vertexCount);
+        if (boneCount == 0) {
+            std::copy(bindVertices.begin(), bindVertices.begin() + vertexCount, skinned.begin());
+            return;
+        }
+
+        for (size_t v = 0; v < vertexCount; ++v) {
+            const Vertex& in = bindVertices[v];
+            const VertexSkin& influence = skin[v];
+            Vertex& out = skinned[v];
+            out.texCoord = in.texCoord;
+
+#ifdef SPARKY_SSE
+            // Weighted sum of the bone matrices, one column per register
+            __m128 column[4] = {_mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps()};
+            for (int i = 0; i < 4; ++i) {
+                if (influence.weights[i] == 0.0f) continue;
+                const float* matrix = floats(skinning[std::min<int>(influence.bones[i], boneCount - 1)]);
+                __m128 weight = _mm_set1_ps(influence.weights[i]);
+                for (int c = 0; c < 4; ++c) {
+                    column[c] = _mm_add_ps(column[c], _mm_mul_ps(_mm_loadu_ps(matrix + c * 4), weight));
+                }
+            }
+
+            float result[4];
+            auto transform = [&column, &result](const glm::vec3& value, bool point) {
+                __m128 sum = _mm_add_ps(_mm_add_ps(_mm_mul_ps(column[0], _mm_set1_ps(value.x)), _mm_mul_ps(column[1], _mm_set1_ps(value.y))),
+                                        _mm_mul_ps(column[2], _mm_set1_ps(value.z)));
+                if (point) sum = _mm_add_ps(sum, column[3]);
+                _mm_storeu_ps(result, sum);
+                return glm::vec3(result[0], result[1], result[2]);
+            };
+#else
+            glm::mat4 blended(0.0f);
+            for (int i = 0; i < 4; ++i) {
+                if (influence.weights[i] == 0.0f) continue;
+                const glm::mat4& matrix = skinning[std::min<int>(influence.bones[i], boneCount - 1)];
+                for (int c = 0; c < 4; ++c) {
+                    blended[c] += matrix[c] * influence.weights[i];
+                }
+            }
+            auto transform = [&blended](const glm::vec3& value, bool point) {
+                return glm::vec3(blended * glm::vec4(value, point ? 1.0f : 0.0f));
+            };
+#endif
+            // Directions are renormalized rather than using the inverse transpose, which is
+            // exact for rotations and uniform scale
+            auto direction = [&transform](const glm::vec3& value) {
+                glm::vec3 result = transform(value, false);
+                float lengthSq = glm::dot(result, result);
+                return lengthSq > 0.0f ? result * (1.0f / std::sqrt(lengthSq)) : result;
+            };
+            out.position = transform(in.position, true);
+            out.normal = direction(in.normal);
+            out.tangent = direction(in.tangent);
+            out.bitangent = direction(in.bitangent);
+        }
+    }
+}
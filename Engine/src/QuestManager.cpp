@@ -2,11 +2,17 @@
 #include "../include/Quest.h"
 #include "../include/FileUtils.h"
 #include "../include/Logger.h"
+#include "../include/SaveArchive.h"
 #include <fstream>
 #include <sstream>
 
 namespace Sparky {
 
+    namespace {
+        const uint32_t kQuestChunk = SaveArchive::makeChunkId('Q', 'U', 'S', 'T');
+        const uint16_t kQuestChunkVersion = 1;
+    }
+
     QuestManager::QuestManager() {
     }
 
@@ -107,40 +113,35 @@ namespace Sparky {
     bool QuestManager::saveToFile(const std::string& filepath) {
         SPARKY_LOG_DEBUG("Saving quests to file: " + filepath);
         
-        try {
-            std::ofstream file(filepath);
-            if (!file.is_open()) {
-                SPARKY_LOG_ERROR("Failed to open quests file for writing: " + filepath);
-                return false;
-            }
-
-            file << quests.size() << "\n";
+        BinaryWriter writer;
+        writer.writeU32(static_cast<uint32_t>(quests.size()));
+        for (auto& pair : quests) {
+            Quest* quest = pair.second.get();
+            writer.writeString(quest->getName());
+            writer.writeString(quest->getDescription());
+            writer.writeU8(static_cast<uint8_t>(quest->getStatus()));
+            writer.writeI32(quest->getRewardExperience());
+            writer.writeI32(quest->getRewardCurrency());
             
-            for (auto& pair : quests) {
-                Quest* quest = pair.second.get();
-                file << quest->getName() << "\n";
-                file << quest->getDescription() << "\n";
-                file << static_cast<int>(quest->getStatus()) << "\n";
-                file << quest->getRewardExperience() << "\n";
-                file << quest->getRewardCurrency() << "\n";
-                
-                // Save objectives
-                const auto& objectives = quest->getObjectives();
-                file << objectives.size() << "\n";
-                for (const auto& objective : objectives) {
-                    file << objective->getDescription() << "\n";
-                    file << objective->getRequiredAmount() << "\n";
-                    file << objective->getCurrentAmount() << "\n";
-                }
+            // Save objectives
+            const auto& objectives = quest->getObjectives();
+            writer.writeU32(static_cast<uint32_t>(objectives.size()));
+            for (const auto& objective : objectives) {
+                writer.writeString(objective->getDescription());
+                writer.writeI32(objective->getRequiredAmount());
+                writer.writeI32(objective->getCurrentAmount());
             }
-            
-            file.close();
-            SPARKY_LOG_DEBUG("Quests saved successfully");
-            return true;
-        } catch (const std::exception& e) {
-            SPARKY_LOG_ERROR("Failed to save quests: " + std::string(e.what()));
+        }
+        
+        SaveArchive archive;
+        archive.setChunk(kQuestChunk, kQuestChunkVersion, writer);
+        if (!archive.saveToFile(filepath)) {
+            SPARKY_LOG_ERROR("Failed to save quests: " + filepath);
             return false;
         }
+        
+        SPARKY_LOG_DEBUG("Quests saved successfully");
+        return true;
     }
 
     bool QuestManager::loadFromFile(const std::string& filepath) {
@@ -153,6 +154,11 @@ namespace Sparky {
             }
 
             std::vector<char> data = FileUtils::readFile(filepath);
+            if (SaveArchive::isArchive(data)) {
+                return readArchive(data);
+            }
+            
+            // Text format written before the save archive
             std::string content(data.begin(), data.end());
             
             std::istringstream iss(content);
@@ -219,6 +225,67 @@ namespace Sparky {
         }
     }
 
+    bool QuestManager::readArchive(const std::vector<char>& data) {
+        SaveArchive archive;
+        const SaveChunk* chunk = archive.decode(data) ? archive.getChunk(kQuestChunk) : nullptr;
+        if (!chunk || chunk->version > kQuestChunkVersion) {
+            SPARKY_LOG_ERROR("Invalid quests save archive");
+            return false;
+        }
+        
+        BinaryReader reader(chunk->data);
+        uint32_t questCount = 0;
+        if (!reader.readU32(questCount)) {
+            SPARKY_LOG_ERROR("Invalid quests file format");
+            return false;
+        }
+        
+        for (uint32_t i = 0; i < questCount; i++) {
+            std::string name, description;
+            uint8_t status = 0;
+            int32_t exp = 0, currency = 0;
+            uint32_t objectiveCount = 0;
+            if (!reader.readString(name) || !reader.readString(description) || !reader.readU8(status) ||
+                !reader.readI32(exp) || !reader.readI32(currency) || !reader.readU32(objectiveCount)) {
+                SPARKY_LOG_ERROR("Invalid quest data in file");
+                return false;
+            }
+            
+            auto quest = std::make_unique<Quest>(name, description);
+            quest->setRewardExperience(exp);
+            quest->setRewardCurrency(currency);
+            
+            for (uint32_t j = 0; j < objectiveCount; j++) {
+                std::string objDesc;
+                int32_t reqAmount = 0, curAmount = 0;
+                if (!reader.readString(objDesc) || !reader.readI32(reqAmount) || !reader.readI32(curAmount)) {
+                    SPARKY_LOG_ERROR("Invalid objective data in file");
+                    return false;
+                }
+                
+                auto objective = std::make_unique<QuestObjective>(objDesc, reqAmount);
+                objective->setCurrentAmount(curAmount);
+                quest->addObjective(std::move(objective));
+            }
+            
+            // Replay the status transitions; fresh quests have no callbacks yet
+            QuestStatus savedStatus = static_cast<QuestStatus>(status);
+            if (savedStatus != QuestStatus::NOT_STARTED) {
+                quest->start();
+            }
+            if (savedStatus == QuestStatus::COMPLETED) {
+                quest->complete();
+            } else if (savedStatus == QuestStatus::FAILED) {
+                quest->fail();
+            }
+            
+            quests[name] = std::move(quest);
+        }
+        
+        SPARKY_LOG_DEBUG("Quests loaded successfully");
+        return true;
+    }
+
     void QuestManager::update(float deltaTime) {
         // Update quest logic if needed
         // For now, just log that we're updating
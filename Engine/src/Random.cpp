@@ -0,0 +1,56 @@
+#include "../include/Random.h"
+
+namespace Sparky {
+
+    namespace {
+        // SplitMix64 finalizer: spreads nearby seeds (0, 1, 2...) across the state space
+        uint64_t mixSeed(uint64_t seed) {
+            uint64_t z = seed + 0x9E3779B97F4A7C15ull;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            return z ^ (z >> 31);
+        }
+    }
+
+    Random& Random::getInstance() {
+        static Random instance;
+        return instance;
+    }
+
+    std::unique_ptr<Random> Random::create(uint64_t seed) {
+        return std::make_unique<Random>(seed);
+    }
+
+    Random::Random() : m_seed(0), m_state(0), m_reseedCount(0) {
+        setSeed(0);
+        m_reseedCount = 0;
+    }
+
+    // Constructor for dependency injection
+    Random::Random(uint64_t seed) : m_seed(0), m_state(0), m_reseedCount(0) {
+        setSeed(seed);
+        m_reseedCount = 0;
+    }
+
+    void Random::setSeed(uint64_t seed) {
+        m_seed = seed;
+        setState(mixSeed(seed));
+        ++m_reseedCount;
+    }
+
+    uint64_t Random::nextU64() {
+        m_state ^= m_state >> 12;
+        m_state ^= m_state << 25;
+        m_state ^= m_state >> 27;
+        return m_state * 0x2545F4914F6CDD1Dull;
+    }
+
+    int Random::rangeInt(int min, int max) {
+        if (max <= min) {
+            return min;
+        }
+        // Multiply-shift instead of modulo: no division and no low-bit bias
+        uint64_t span = static_cast<uint64_t>(static_cast<int64_t>(max) - min);
+        return min + static_cast<int>((static_cast<uint64_t>(nextU32()) * span) >> 32);
+    }
+}
@@ -1,5 +1,6 @@
 #include "../include/RenderComponent.h"
 #include "../include/Logger.h"
+#include "../include/GameObject.h"
 
 #ifdef HAS_GLFW
 #include <vulkan/vulkan.h>
@@ -7,7 +8,7 @@
 
 namespace Sparky {
 
-    RenderComponent::RenderComponent() : Component(), visible(true) {
+    RenderComponent::RenderComponent() : Component(), visible(true), renderLayer(RenderLayer::OPAQUE_GEOMETRY) {
         SPARKY_LOG_DEBUG("RenderComponent created");
     }
 
@@ -27,14 +28,32 @@ namespace Sparky {
 
     void RenderComponent::setMesh(std::unique_ptr<Mesh> mesh) {
         this->mesh = std::move(mesh);
+        // Meshes filled in by hand may not have bounds yet
+        if (this->mesh && !this->mesh->vertices.empty() && this->mesh->boundsRadius == 0.0f) {
+            this->mesh->computeBounds();
+        }
+        // Culling refreshes an object's bounds when its revision changes
+        if (getOwner()) {
+            getOwner()->markDirty();
+        }
         SPARKY_LOG_DEBUG("Mesh set for RenderComponent");
     }
 
     void RenderComponent::setMaterial(std::unique_ptr<Material> mat) {
         this->material = std::move(mat);
+        if (getOwner()) {
+            getOwner()->markDirty();
+        }
         SPARKY_LOG_DEBUG("Material set for RenderComponent");
     }
 
+    void RenderComponent::setRenderLayer(RenderLayer layer) {
+        renderLayer = layer;
+        if (getOwner()) {
+            getOwner()->markDirty();
+        }
+    }
+
 #ifdef HAS_GLFW
     void RenderComponent::createVertexBuffer(VkPhysicalDevice physicalDevice, VkDevice device, VkCommandPool commandPool, VkQueue graphicsQueue) {
         if (!mesh) {
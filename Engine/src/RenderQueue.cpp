@@ -0,0 +1,195 @@
+#include "../include/RenderQueue.h"
+#include "../include/Mesh.h"
+#include <algorithm>
+#include <cassert>
+
+namespace Sparky {
+    namespace {
+        const int kDepthBits = 22;
+        const uint64_t kDepthMax = (1ull << kDepthBits) - 1;
+        const int kStateBits = 40;      // pipeline:8 | material:16 | mesh:16
+        const uint32_t kMaxPipeline = 0xFF;
+        const uint32_t kMaxId = 0xFFFF;
+
+        // Binds needed to go from the previous draw's state to this one; everything for the first
+        uint8_t stateChanges(const RenderItem& item, const RenderItem* previous) {
+            if (!previous) return RENDER_CHANGE_PIPELINE | RENDER_CHANGE_MATERIAL | RENDER_CHANGE_MESH;
+            uint8_t changes = 0;
+            if (item.pipeline != previous->pipeline) changes |= RENDER_CHANGE_PIPELINE;
+            if (item.material != previous->material) changes |= RENDER_CHANGE_MATERIAL;
+            if (item.mesh != previous->mesh) changes |= RENDER_CHANGE_MESH;
+            return changes;
+        }
+
+        int bindCount(const RenderItem& item, uint8_t changes) {
+            int binds = 0;
+            if (changes & RENDER_CHANGE_PIPELINE) ++binds;
+            if ((changes & RENDER_CHANGE_MATERIAL) && item.material) ++binds;
+            if (changes & RENDER_CHANGE_MESH) binds += item.mesh->getIndexCount() > 0 ? 2 : 1;
+            return binds;
+        }
+    }
+
+    RenderQueue::RenderQueue() : m_eye(0.0f), m_forward(0.0f, 0.0f, -1.0f), m_depthScale(1.0f) {
+    }
+
+    uint64_t RenderQueue::makeKey(RenderLayer layer, uint32_t pipeline, uint32_t materialId, uint32_t meshId, float depth) {
+        assert(pipeline <= kMaxPipeline && materialId <= kMaxId && meshId <= kMaxId && "sort key fields overflow");
+        
+        // Written so that NaN lands at the front rather than in an undefined conversion
+        float clamped = depth > 0.0f ? (depth < 1.0f ? depth : 1.0f) : 0.0f;
+        uint64_t quantized = static_cast<uint64_t>(clamped * static_cast<float>(kDepthMax));
+        uint64_t state = (static_cast<uint64_t>(pipeline & 0xFF) << 32) | (static_cast<uint64_t>(materialId & 0xFFFF) << 16) |
+                         static_cast<uint64_t>(meshId & 0xFFFF);
+
+        uint64_t key = static_cast<uint64_t>(layer) << (kDepthBits + kStateBits);
+        if (layer == RenderLayer::BACKGROUND || layer == RenderLayer::OPAQUE_GEOMETRY) {
+            key |= (state << kDepthBits) | quantized;
+        } else {
+            key |= ((kDepthMax - quantized) << kStateBits) | state;
+        }
+        return key;
+    }
+
+    void RenderQueue::begin(const glm::vec3& eye, const glm::vec3& forward, float farDistance) {
+        m_eye = eye;
+        m_forward = forward;
+        m_depthScale = farDistance > 0.0f ? 1.0f / farDistance : 0.0f;
+        m_items.clear();
+        m_keys.clear();
+    }
+
+    void RenderQueue::add(const RenderItem& item, const glm::vec3& center) {
+        float depth = glm::dot(center - m_eye, m_forward) * m_depthScale;
+        m_items.push_back(item);
+        m_keys.push_back(makeKey(item.layer, item.pipeline, item.materialId, item.meshId, depth));
+    }
+
+    void RenderQueue::sort() {
+        m_stats = RenderQueueStats();
+        m_stats.draws = static_cast<int>(m_items.size());
+        for (size_t i = 0; i < m_items.size(); ++i) {
+            m_stats.unsortedBinds += bindCount(m_items[i], stateChanges(m_items[i], i > 0 ? &m_items[i - 1] : nullptr));
+        }
+
+        radixSort();
+
+        m_draws.resize(m_items.size());
+        m_batches.clear();
+        const RenderItem* previous = nullptr;
+        for (size_t i = 0; i < m_sort.size(); ++i) {
+            RenderDraw& draw = m_draws[i];
+            draw.key = m_sort[i].key;
+            draw.item = m_items[m_sort[i].item];
+            draw.changes = stateChanges(draw.item, previous);
+            previous = &draw.item;
+
+            if (draw.changes) ++m_stats.stateChanges;
+            if (draw.changes & RENDER_CHANGE_PIPELINE) ++m_stats.pipelineBinds;
+            if ((draw.changes & RENDER_CHANGE_MATERIAL) && draw.item.material) ++m_stats.materialBinds;
+            if (draw.changes & RENDER_CHANGE_MESH) {
+                ++m_stats.vertexBufferBinds;
+                if (draw.item.mesh->getIndexCount() > 0) ++m_stats.indexBufferBinds;
+            }
+
+            // A draw that needs no binds draws the same thing as the one before, so it joins its batch
+            if (draw.changes) {
+                m_batches.push_back({static_cast<uint32_t>(i), 1});
+            } else {
+                ++m_batches.back().drawCount;
+            }
+        }
+
+        m_stats.batches = static_cast<int>(m_batches.size());
+        m_stats.collapsedDraws = m_stats.draws - m_stats.batches;
+    }
+
+    void RenderQueue::radixSort() {
+        const size_t count = m_keys.size();
+        m_sort.resize(count);
+        m_scratch.resize(count);
+        if (count == 0) return;
+
+        // Least significant byte first; each pass is stable, so earlier bytes keep their order
+        uint32_t histograms[8][256] = {};
+        for (size_t i = 0; i < count; ++i) {
+            const uint64_t key = m_keys[i];
+            m_sort[i] = {key, static_cast<uint32_t>(i)};
+            for (int byte = 0; byte < 8; ++byte) {
+                ++histograms[byte][(key >> (byte * 8)) & 0xFF];
+            }
+        }
+
+        for (int byte = 0; byte < 8; ++byte) {
+            const int shift = byte * 8;
+            uint32_t* histogram = histograms[byte];
+            if (histogram[(m_sort[0].key >> shift) & 0xFF] == count) continue;
+
+            uint32_t offset = 0;
+            for (int bucket = 0; bucket < 256; ++bucket) {
+                uint32_t bucketCount = histogram[bucket];
+                histogram[bucket] = offset;
+                offset += bucketCount;
+            }
+            for (size_t i = 0; i < count; ++i) {
+                m_scratch[histogram[(m_sort[i].key >> shift) & 0xFF]++] = m_sort[i];
+            }
+            m_sort.swap(m_scratch);
+            ++m_stats.sortPasses;
+        }
+    }
+
+    uint32_t RenderQueue::acquireMeshId(const Mesh* mesh) {
+        return m_meshIds.acquire(mesh);
+    }
+
+    void RenderQueue::releaseMeshId(const Mesh* mesh) {
+        m_meshIds.release(mesh);
+    }
+
+    uint32_t RenderQueue::acquireMaterialId(const Material* material) {
+        return m_materialIds.acquire(material);
+    }
+
+    void RenderQueue::releaseMaterialId(const Material* material) {
+        m_materialIds.release(material);
+    }
+
+    void RenderQueue::clearIds() {
+        m_meshIds.clear();
+        m_materialIds.clear();
+    }
+
+    uint32_t RenderQueue::IdTable::acquire(const void* resource) {
+        auto it = entries.find(resource);
+        if (it != entries.end()) {
+            ++it->second.holders;
+            return it->second.id;
+        }
+        uint32_t id = nextId;
+        if (freeIds.empty()) {
+            ++nextId;
+        } else {
+            id = freeIds.back();
+            freeIds.pop_back();
+        }
+        assert(id <= kMaxId && "more live meshes or materials than the sort key can tell apart");
+        entries.emplace(resource, Entry{id, 1});
+        return id;
+    }
+
+    void RenderQueue::IdTable::release(const void* resource) {
+        auto it = entries.find(resource);
+        if (it == entries.end()) return;
+        if (--it->second.holders == 0) {
+            freeIds.push_back(it->second.id);
+            entries.erase(it);
+        }
+    }
+
+    void RenderQueue::IdTable::clear() {
+        entries.clear();
+        freeIds.clear();
+        nextId = 0;
+    }
+}
@@ -7,7 +7,7 @@
 
 namespace Sparky {
 
-    RenderSystem::RenderSystem() : renderer(nullptr) {
+    RenderSystem::RenderSystem() : renderer(nullptr), cullingEnabled(true) {
         SPARKY_LOG_DEBUG("RenderSystem created");
     }
 
@@ -22,12 +22,19 @@ namespace Sparky {
 
     void RenderSystem::cleanup() {
         gameObjects.clear();
+        cullEntries.clear();
+        cullingBVH.clear();
+        visibleProxies.clear();
+        proxyItems.clear();
+        renderQueue.clearIds();
+        visibleObjects.clear();
         SPARKY_LOG_DEBUG("RenderSystem cleaned up");
     }
 
     void RenderSystem::registerGameObject(GameObject* gameObject) {
         if (std::find(gameObjects.begin(), gameObjects.end(), gameObject) == gameObjects.end()) {
             gameObjects.push_back(gameObject);
+            cullEntries.push_back({-1, 0, false});
             SPARKY_LOG_DEBUG("GameObject registered with RenderSystem: " + gameObject->getName());
         }
     }
@@ -35,6 +42,15 @@ namespace Sparky {
     void RenderSystem::unregisterGameObject(GameObject* gameObject) {
         auto it = std::find(gameObjects.begin(), gameObjects.end(), gameObject);
         if (it != gameObjects.end()) {
+            auto entry = cullEntries.begin() + (it - gameObjects.begin());
+            if (entry->proxy >= 0) {
+                // It may also sit in the last visible lists
+                visibleProxies.erase(std::remove(visibleProxies.begin(), visibleProxies.end(), entry->proxy), visibleProxies.end());
+                visibleObjects.erase(std::remove(visibleObjects.begin(), visibleObjects.end(), gameObject), visibleObjects.end());
+                releaseProxyItem(entry->proxy);
+                cullingBVH.removeProxy(entry->proxy);
+            }
+            cullEntries.erase(entry);
             gameObjects.erase(it);
             SPARKY_LOG_DEBUG("GameObject unregistered from RenderSystem: " + gameObject->getName());
         }
@@ -64,6 +80,98 @@ namespace Sparky {
         renderer->renderMeshes();
     }
 
+    void RenderSystem::cull(const glm::mat4& viewProjection) {
+        for (size_t i = 0; i < gameObjects.size(); ++i) {
+            refreshBounds(gameObjects[i], cullEntries[i]);
+        }
+        cullingBVH.update();
+        
+        if (cullingEnabled) {
+            cullingBVH.cull(Frustum::fromMatrix(viewProjection), visibleProxies, &cullingStats);
+        } else {
+            visibleProxies.clear();
+            for (const CullEntry& entry : cullEntries) {
+                if (entry.proxy >= 0) visibleProxies.push_back(entry.proxy);
+            }
+            cullingStats = CullingStats();
+            cullingStats.proxies = cullingBVH.getProxyCount();
+            cullingStats.visible = static_cast<int>(visibleProxies.size());
+        }
+        
+        visibleObjects.clear();
+        for (int proxy : visibleProxies) {
+            visibleObjects.push_back(cullingBVH.getProxyObject(proxy));
+        }
+    }
+
+    void RenderSystem::refreshBounds(GameObject* gameObject, CullEntry& entry) {
+        // Transforms, meshes and components all bump the revision, so unchanged objects cost one load
+        uint32_t revision = gameObject->getRevision();
+        if (entry.resolved && entry.revision == revision) {
+            return;
+        }
+        entry.resolved = true;
+        entry.revision = revision;
+        
+        RenderComponent* renderComponent = gameObject->getComponent<RenderComponent>();
+        Mesh* mesh = renderComponent ? renderComponent->getMesh() : nullptr;
+        if (!mesh) {
+            if (entry.proxy >= 0) {
+                releaseProxyItem(entry.proxy);
+                cullingBVH.removeProxy(entry.proxy);
+            }
+            entry.proxy = -1;
+            return;
+        }
+        
+        glm::vec3 worldMin, worldMax;
+        transformBounds(mesh->boundsMin, mesh->boundsMax, gameObject->getTransformMatrix(), worldMin, worldMax);
+        if (entry.proxy < 0) {
+            entry.proxy = cullingBVH.addProxy(worldMin, worldMax, gameObject);
+        } else {
+            cullingBVH.moveProxy(entry.proxy, worldMin, worldMax);
+        }
+        
+        if (entry.proxy >= static_cast<int>(proxyItems.size())) {
+            proxyItems.resize(entry.proxy + 1);
+        }
+        // Take the new ids before giving up the old ones, so an unchanged mesh keeps its id
+        RenderItem& item = proxyItems[entry.proxy];
+        Material* material = renderComponent->getMaterial();
+        uint32_t meshId = renderQueue.acquireMeshId(mesh);
+        uint32_t materialId = renderQueue.acquireMaterialId(material);
+        releaseProxyItem(entry.proxy);
+        item.object = gameObject;
+        item.mesh = mesh;
+        item.material = material;
+        item.pipeline = 0;      // The renderer has a single graphics pipeline
+        item.meshId = meshId;
+        item.materialId = materialId;
+        item.layer = renderComponent->getRenderLayer();
+    }
+    
+    void RenderSystem::releaseProxyItem(int proxy) {
+        if (proxy >= static_cast<int>(proxyItems.size())) {
+            return;
+        }
+        RenderItem& item = proxyItems[proxy];
+        if (item.mesh) {
+            renderQueue.releaseMeshId(item.mesh);
+            renderQueue.releaseMaterialId(item.material);
+        }
+        item = RenderItem();
+    }
+
+    void RenderSystem::buildRenderQueue(const glm::vec3& eye, const glm::vec3& forward, float farDistance) {
+        renderQueue.begin(eye, forward, farDistance);
+        for (int proxy : visibleProxies) {
+            glm::vec3 minBounds, maxBounds;
+            cullingBVH.getProxyBounds(proxy, minBounds, maxBounds);
+            renderQueue.add(proxyItems[proxy], (minBounds + maxBounds) * 0.5f);
+        }
+        renderQueue.sort();
+    }
+
     void RenderSystem::renderGameObject(GameObject* gameObject) {
         if (!gameObject) {
             return;
@@ -0,0 +1,433 @@
+#include "../include/Replay.h"
+#include "../include/BinaryStream.h"
+#include "../include/Random.h"
+#include "../include/SaveArchive.h"
+#include "../include/Scene.h"
+#include "../include/GameObject.h"
+#include "../include/SnapshotSerializable.h"
+#include "../include/Logger.h"
+#include <chrono>
+#include <cstring>
+
+namespace Sparky {
+
+    namespace {
+        const uint32_t kReplayChunk = SaveArchive::makeChunkId('R', 'P', 'L', 'Y');
+        const uint16_t kReplayChunkVersion = 1;
+        const uint32_t kTicksPerBlock = 256;
+        // One hour at 60 ticks per second
+        const uint32_t kDefaultCapacity = 60 * 60 * 60;
+
+        // Tick record flags
+        const uint8_t kTickDeltaTime = 1 << 0;
+        const uint8_t kTickKeys = 1 << 1;
+        const uint8_t kTickButtons = 1 << 2;
+        const uint8_t kTickMouse = 1 << 3;
+        const uint8_t kTickScroll = 1 << 4;
+        const uint8_t kTickRandomState = 1 << 5;
+        const uint8_t kTickStateHash = 1 << 6;
+
+        const uint64_t kFnvOffset = 14695981039346656037ull;
+        const uint64_t kFnvPrime = 1099511628211ull;
+
+        uint64_t hashBytes(uint64_t hash, const void* data, size_t size) {
+            const unsigned char* bytes = static_cast<const unsigned char*>(data);
+            for (size_t i = 0; i < size; ++i) {
+                hash = (hash ^ bytes[i]) * kFnvPrime;
+            }
+            return hash;
+        }
+
+        void clearFrame(InputFrame& frame) {
+            std::memset(&frame, 0, sizeof(frame));
+        }
+    }
+
+    // ReplayLog implementation
+    ReplayLog::ReplayLog()
+        : m_seed(0)
+        , m_maxTicks(kDefaultCapacity)
+        , m_nextTick(0)
+        , m_blockOpen(false)
+        , m_lastDeltaTime(0.0f) {
+        clearFrame(m_lastInput);
+    }
+
+    ReplayLog::~ReplayLog() {
+    }
+
+    void ReplayLog::clear() {
+        m_blocks.clear();
+        m_nextTick = 0;
+        m_blockOpen = false;
+    }
+
+    size_t ReplayLog::getByteSize() const {
+        size_t bytes = 0;
+        for (const auto& block : m_blocks) {
+            bytes += block.data.size();
+        }
+        return bytes;
+    }
+
+    void ReplayLog::append(const ReplayTick& tick) {
+        if (!m_blockOpen || m_blocks.back().tickCount >= kTicksPerBlock) {
+            m_blocks.push_back({m_nextTick, 0, {}});
+            m_blockOpen = true;
+            clearFrame(m_lastInput);
+            m_lastDeltaTime = 0.0f;
+
+            // Drop whole blocks from the front while enough ticks remain
+            while (m_blocks.size() > 1 && m_nextTick - m_blocks[1].firstTick >= m_maxTicks) {
+                m_blocks.pop_front();
+            }
+        }
+
+        Block& block = m_blocks.back();
+        const InputFrame& input = tick.input;
+
+        uint16_t toggledKeys[InputFrame::KEY_WORDS * 32];
+        uint16_t toggledCount = 0;
+        for (int word = 0; word < InputFrame::KEY_WORDS; ++word) {
+            uint32_t changed = input.keys[word] ^ m_lastInput.keys[word];
+            for (int bit = 0; changed != 0 && bit < 32; ++bit) {
+                if ((changed >> bit) & 1u) {
+                    toggledKeys[toggledCount++] = static_cast<uint16_t>(word * 32 + bit);
+                }
+            }
+        }
+
+        // The first tick of a block always restores Random, so the block decodes on its own
+        bool writeRandomState = tick.hasRandomState || block.tickCount == 0;
+
+        uint8_t flags = 0;
+        if (tick.deltaTime != m_lastDeltaTime) flags |= kTickDeltaTime;
+        if (toggledCount > 0) flags |= kTickKeys;
+        if (input.mouseButtons != m_lastInput.mouseButtons) flags |= kTickButtons;
+        if (input.mouseX != m_lastInput.mouseX || input.mouseY != m_lastInput.mouseY) flags |= kTickMouse;
+        if (input.scrollX != m_lastInput.scrollX || input.scrollY != m_lastInput.scrollY) flags |= kTickScroll;
+        if (writeRandomState) flags |= kTickRandomState;
+        if (tick.hasStateHash) flags |= kTickStateHash;
+
+        BinaryWriter writer;
+        writer.writeU8(flags);
+        if (flags & kTickDeltaTime) writer.writeFloat(tick.deltaTime);
+        if (flags & kTickKeys) {
+            writer.writeU16(toggledCount);
+            writer.writeBytes(toggledKeys, toggledCount * sizeof(uint16_t));
+        }
+        if (flags & kTickButtons) writer.writeU8(input.mouseButtons);
+        if (flags & kTickMouse) {
+            writer.writeFloat(input.mouseX);
+            writer.writeFloat(input.mouseY);
+        }
+        if (flags & kTickScroll) {
+            writer.writeFloat(input.scrollX);
+            writer.writeFloat(input.scrollY);
+        }
+        if (flags & kTickRandomState) writer.writeU64(tick.randomState);
+        if (flags & kTickStateHash) writer.writeU64(tick.stateHash);
+
+        const std::vector<char>& bytes = writer.getBuffer();
+        block.data.insert(block.data.end(), bytes.begin(), bytes.end());
+        ++block.tickCount;
+        ++m_nextTick;
+
+        m_lastInput = input;
+        m_lastDeltaTime = tick.deltaTime;
+    }
+
+    bool ReplayLog::decodeBlock(const Block& block, const std::function<bool(const ReplayTick&)>& visitor) {
+        BinaryReader reader(block.data);
+        ReplayTick tick{};
+        clearFrame(tick.input);
+
+        for (uint32_t i = 0; i < block.tickCount; ++i) {
+            uint8_t flags = 0;
+            if (!reader.readU8(flags)) return false;
+
+            tick.index = block.firstTick + i;
+            if (flags & kTickDeltaTime) reader.readFloat(tick.deltaTime);
+            if (flags & kTickKeys) {
+                uint16_t count = 0;
+                reader.readU16(count);
+                for (uint16_t k = 0; k < count; ++k) {
+                    uint16_t key = 0;
+                    if (!reader.readU16(key) || key >= InputFrame::KEY_WORDS * 32) return false;
+                    tick.input.keys[key >> 5] ^= 1u << (key & 31);
+                }
+            }
+            if (flags & kTickButtons) reader.readU8(tick.input.mouseButtons);
+            if (flags & kTickMouse) {
+                reader.readFloat(tick.input.mouseX);
+                reader.readFloat(tick.input.mouseY);
+            }
+            if (flags & kTickScroll) {
+                reader.readFloat(tick.input.scrollX);
+                reader.readFloat(tick.input.scrollY);
+            }
+            tick.hasRandomState = (flags & kTickRandomState) != 0;
+            if (tick.hasRandomState) reader.readU64(tick.randomState);
+            tick.hasStateHash = (flags & kTickStateHash) != 0;
+            if (tick.hasStateHash) reader.readU64(tick.stateHash);
+
+            if (reader.hasError()) return false;
+            if (!visitor(tick)) return true;
+        }
+        return true;
+    }
+
+    bool ReplayLog::forEachTick(const std::function<bool(const ReplayTick&)>& visitor) const {
+        bool keepGoing = true;
+        auto guardedVisitor = [&](const ReplayTick& tick) {
+            keepGoing = visitor(tick);
+            return keepGoing;
+        };
+
+        for (const auto& block : m_blocks) {
+            if (!decodeBlock(block, guardedVisitor)) {
+                SPARKY_LOG_ERROR("Corrupt replay block at tick " + std::to_string(block.firstTick));
+                return false;
+            }
+            if (!keepGoing) break;
+        }
+        return true;
+    }
+
+    void ReplayLog::writeTo(SaveArchive& archive) const {
+        BinaryWriter writer;
+        writer.writeU64(m_seed);
+        writer.writeU32(m_maxTicks);
+        writer.writeU32(static_cast<uint32_t>(m_blocks.size()));
+        for (const auto& block : m_blocks) {
+            writer.writeU32(block.firstTick);
+            writer.writeU32(block.tickCount);
+            writer.writeU32(static_cast<uint32_t>(block.data.size()));
+            writer.writeBytes(block.data.data(), block.data.size());
+        }
+        archive.setChunk(kReplayChunk, kReplayChunkVersion, writer);
+    }
+
+    bool ReplayLog::readFrom(const SaveArchive& archive) {
+        const SaveChunk* chunk = archive.getChunk(kReplayChunk);
+        if (!chunk) {
+            SPARKY_LOG_ERROR("Save archive does not contain a replay");
+            return false;
+        }
+        if (chunk->version > kReplayChunkVersion) {
+            SPARKY_LOG_ERROR("Replay version " + std::to_string(chunk->version) + " is newer than supported");
+            return false;
+        }
+
+        BinaryReader reader(chunk->data);
+        uint64_t seed = 0;
+        uint32_t maxTicks = 0, blockCount = 0;
+        if (!reader.readU64(seed) || !reader.readU32(maxTicks) || !reader.readU32(blockCount)) {
+            SPARKY_LOG_ERROR("Truncated replay header");
+            return false;
+        }
+
+        std::deque<Block> blocks;
+        for (uint32_t i = 0; i < blockCount; ++i) {
+            Block block;
+            uint32_t size = 0;
+            if (!reader.readU32(block.firstTick) || !reader.readU32(block.tickCount) || !reader.readU32(size)) {
+                SPARKY_LOG_ERROR("Truncated replay block header");
+                return false;
+            }
+            const char* data = reader.view(size);
+            if (!data || (!blocks.empty() && block.firstTick != blocks.back().firstTick + blocks.back().tickCount)) {
+                SPARKY_LOG_ERROR("Corrupt replay block");
+                return false;
+            }
+            block.data.assign(data, data + size);
+            blocks.push_back(std::move(block));
+        }
+
+        m_seed = seed;
+        m_maxTicks = maxTicks;
+        m_blocks = std::move(blocks);
+        m_nextTick = m_blocks.empty() ? 0 : m_blocks.back().firstTick + m_blocks.back().tickCount;
+        // Appending after a load starts a fresh block
+        m_blockOpen = false;
+        return true;
+    }
+
+    bool ReplayLog::saveToFile(const std::string& filepath) const {
+        SaveArchive archive;
+        writeTo(archive);
+        return archive.saveToFile(filepath);
+    }
+
+    bool ReplayLog::loadFromFile(const std::string& filepath) {
+        SaveArchive archive;
+        return archive.loadFromFile(filepath) && readFrom(archive);
+    }
+
+    // ReplayRecorder implementation
+    ReplayRecorder::ReplayRecorder()
+        : m_random(nullptr)
+        , m_scene(nullptr)
+        , m_hashInterval(60)
+        , m_recording(false)
+        , m_tickOpen(false)
+        , m_reseedCount(0)
+        , m_pendingTick{} {
+    }
+
+    ReplayRecorder::~ReplayRecorder() {
+    }
+
+    Random& ReplayRecorder::getRandom() const {
+        return m_random ? *m_random : Random::getInstance();
+    }
+
+    void ReplayRecorder::start(uint64_t seed) {
+        Random& random = getRandom();
+        random.setSeed(seed);
+
+        m_log.clear();
+        m_log.setSeed(seed);
+        m_reseedCount = random.getReseedCount();
+        m_recording = true;
+        m_tickOpen = false;
+        SPARKY_LOG_INFO("Replay recording started with seed " + std::to_string(seed));
+    }
+
+    void ReplayRecorder::stop() {
+        if (!m_recording) {
+            return;
+        }
+        // A tick that never finished would replay without its simulation
+        m_recording = false;
+        m_tickOpen = false;
+        SPARKY_LOG_INFO("Replay recording stopped after " + std::to_string(m_log.getTickCount()) + " ticks (" +
+                        std::to_string(m_log.getByteSize()) + " bytes)");
+    }
+
+    void ReplayRecorder::beginTick(float deltaTime, const InputManager& input) {
+        if (!m_recording) {
+            return;
+        }
+
+        Random& random = getRandom();
+        m_pendingTick.deltaTime = deltaTime;
+        input.captureFrame(m_pendingTick.input);
+        // Reseeded outside the simulation since the last tick
+        m_pendingTick.hasRandomState = random.getReseedCount() != m_reseedCount;
+        m_pendingTick.randomState = random.getState();
+        m_pendingTick.hasStateHash = false;
+        m_tickOpen = true;
+    }
+
+    void ReplayRecorder::endTick() {
+        if (!m_recording || !m_tickOpen) {
+            return;
+        }
+
+        Random& random = getRandom();
+        uint32_t index = m_log.getFirstTick() + m_log.getTickCount();
+        if (m_scene && m_hashInterval > 0 && (index + 1) % m_hashInterval == 0) {
+            m_pendingTick.hasStateHash = true;
+            m_pendingTick.stateHash = computeStateHash(*m_scene, random.getState());
+        }
+
+        m_log.append(m_pendingTick);
+        m_reseedCount = random.getReseedCount();
+        m_tickOpen = false;
+    }
+
+    uint64_t ReplayRecorder::computeStateHash(const Scene& scene, uint64_t randomState) {
+        uint64_t hash = hashBytes(kFnvOffset, &randomState, sizeof(randomState));
+
+        BinaryWriter writer;
+        for (const auto& object : scene.getGameObjects()) {
+            const std::string& name = object->getName();
+            hash = hashBytes(hash, name.data(), name.size());
+
+            writer.clear();
+            writer.writeVec3(object->getPosition());
+            writer.writeVec3(object->getRotation());
+            writer.writeVec3(object->getScale());
+            for (const auto& component : object->getComponents()) {
+                const SnapshotSerializable* serializable = dynamic_cast<const SnapshotSerializable*>(component.get());
+                if (serializable) {
+                    writer.writeU32(serializable->getSnapshotTypeId());
+                    serializable->serialize(writer);
+                }
+            }
+            const std::vector<char>& bytes = writer.getBuffer();
+            hash = hashBytes(hash, bytes.data(), bytes.size());
+        }
+        return hash;
+    }
+
+    // ReplayPlayer implementation
+    ReplayPlayer::ReplayPlayer()
+        : m_random(nullptr)
+        , m_input(nullptr)
+        , m_stopOnDivergence(true) {
+    }
+
+    ReplayPlayer::~ReplayPlayer() {
+    }
+
+    ReplayResult ReplayPlayer::play(const ReplayLog& log, Scene& scene) {
+        using Clock = std::chrono::high_resolution_clock;
+
+        Random& random = m_random ? *m_random : Random::getInstance();
+        InputManager& input = m_input ? *m_input : InputManager::getInstance();
+
+        ReplayResult result{};
+        result.minTickMs = 0.0;
+
+        bool wasPlayback = input.isPlaybackEnabled();
+        input.setPlaybackEnabled(true);
+
+        log.forEachTick([&](const ReplayTick& tick) {
+            if (tick.hasRandomState) {
+                random.setState(tick.randomState);
+            }
+            // Same order as the engine loop: events land, then InputManager::update()
+            input.applyFrame(tick.input);
+            input.update();
+
+            auto tickStart = Clock::now();
+            if (m_tickFunction) {
+                m_tickFunction(scene, tick);
+            } else {
+                scene.update(tick.deltaTime);
+            }
+            double tickMs = std::chrono::duration<double, std::milli>(Clock::now() - tickStart).count();
+
+            result.totalMs += tickMs;
+            if (result.ticksPlayed == 0 || tickMs < result.minTickMs) {
+                result.minTickMs = tickMs;
+            }
+            if (tickMs > result.maxTickMs) {
+                result.maxTickMs = tickMs;
+                result.slowestTick = tick.index;
+            }
+            ++result.ticksPlayed;
+
+            if (tick.hasStateHash) {
+                ++result.hashesChecked;
+                uint64_t hash = ReplayRecorder::computeStateHash(scene, random.getState());
+                if (hash != tick.stateHash && !result.diverged) {
+                    result.diverged = true;
+                    result.divergedTick = tick.index;
+                    result.expectedHash = tick.stateHash;
+                    result.actualHash = hash;
+                    SPARKY_LOG_WARNING("Replay diverged at tick " + std::to_string(tick.index));
+                    return !m_stopOnDivergence;
+                }
+            }
+            return true;
+        });
+
+        input.setPlaybackEnabled(wasPlayback);
+
+        result.ticksPerSecond = result.totalMs > 0.0 ? result.ticksPlayed * 1000.0 / result.totalMs : 0.0;
+        return result;
+    }
+}
@@ -64,34 +64,42 @@ namespace Sparky {
         } else if (type == BodyType::KINEMATIC) {
             inverseMass = 0.0f;
         }
+        markOwnerDirty();
     }
 
     void RigidBodyComponent::setLinearVelocity(const glm::vec3& velocity) {
         linearVelocity = velocity;
+        markOwnerDirty();
     }
 
     void RigidBodyComponent::setAngularVelocity(const glm::vec3& velocity) {
         angularVelocity = velocity;
+        markOwnerDirty();
     }
 
     void RigidBodyComponent::setLinearDamping(float damping) {
         linearDamping = damping;
+        markOwnerDirty();
     }
 
     void RigidBodyComponent::setAngularDamping(float damping) {
         angularDamping = damping;
+        markOwnerDirty();
     }
 
     void RigidBodyComponent::setRestitution(float restitution) {
         this->restitution = restitution;
+        markOwnerDirty();
     }
 
     void RigidBodyComponent::setFriction(float friction) {
         this->friction = friction;
+        markOwnerDirty();
     }
 
     void RigidBodyComponent::setAffectedByGravity(bool affected) {
         affectedByGravity = affected;
+        markOwnerDirty();
     }
 
     void RigidBodyComponent::applyForce(const glm::vec3& force) {
@@ -142,4 +150,35 @@ namespace Sparky {
         // Integrate velocity to position is done in update()
         // This method is kept for potential future enhancements
     }
+
+    void RigidBodyComponent::serialize(BinaryWriter& writer) const {
+        PhysicsComponent::serialize(writer);
+        writer.writeU8(static_cast<uint8_t>(bodyType));
+        writer.writeVec3(linearVelocity);
+        writer.writeVec3(angularVelocity);
+        writer.writeFloat(linearDamping);
+        writer.writeFloat(angularDamping);
+        writer.writeFloat(restitution);
+        writer.writeFloat(friction);
+        writer.writeBool(affectedByGravity);
+        writer.writeFloat(inverseMass);
+    }
+
+    bool RigidBodyComponent::deserialize(BinaryReader& reader, uint16_t version) {
+        if (!PhysicsComponent::deserialize(reader, version)) {
+            return false;
+        }
+
+        uint8_t type = 0;
+        if (!reader.readU8(type) || type > static_cast<uint8_t>(BodyType::DYNAMIC) ||
+            !reader.readVec3(linearVelocity) || !reader.readVec3(angularVelocity) ||
+            !reader.readFloat(linearDamping) || !reader.readFloat(angularDamping) ||
+            !reader.readFloat(restitution) || !reader.readFloat(friction) ||
+            !reader.readBool(affectedByGravity) || !reader.readFloat(inverseMass)) {
+            return false;
+        }
+        bodyType = static_cast<BodyType>(type);
+        clearForces();
+        return true;
+    }
 }
\ No newline at end of file
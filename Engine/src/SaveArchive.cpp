@@ -0,0 +1,204 @@
+#include "../include/SaveArchive.h"
+#include "../include/LZCompressor.h"
+#include "../include/FileUtils.h"
+#include "../include/JobSystem.h"
+#include "../include/Logger.h"
+#include <cstring>
+#include <stdexcept>
+
+namespace Sparky {
+
+    namespace {
+        const char kArchiveMagic[4] = {'S', 'P', 'K', 'A'};
+        const uint16_t kArchiveFormatVersion = 1;
+        const uint16_t kChunkFlagCompressed = 1;
+        // Small chunks rarely shrink enough to pay for the decode
+        const size_t kMinCompressSize = 64;
+
+        struct Crc32Table {
+            uint32_t entries[256];
+
+            Crc32Table() {
+                for (uint32_t i = 0; i < 256; ++i) {
+                    uint32_t crc = i;
+                    for (int bit = 0; bit < 8; ++bit) {
+                        crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+                    }
+                    entries[i] = crc;
+                }
+            }
+        };
+    }
+
+    SaveArchive::SaveArchive() : m_compressionEnabled(true) {
+    }
+
+    SaveArchive::~SaveArchive() {
+    }
+
+    uint32_t SaveArchive::crc32(const char* data, size_t size) {
+        static const Crc32Table table;
+        uint32_t crc = 0xFFFFFFFFu;
+        for (size_t i = 0; i < size; ++i) {
+            crc = table.entries[(crc ^ static_cast<uint8_t>(data[i])) & 0xFF] ^ (crc >> 8);
+        }
+        return crc ^ 0xFFFFFFFFu;
+    }
+
+    void SaveArchive::setChunk(uint32_t id, uint16_t version, std::vector<char> data) {
+        for (auto& chunk : m_chunks) {
+            if (chunk.id == id) {
+                chunk.version = version;
+                chunk.data = std::move(data);
+                return;
+            }
+        }
+        m_chunks.push_back({id, version, std::move(data)});
+    }
+
+    const SaveChunk* SaveArchive::getChunk(uint32_t id) const {
+        for (const auto& chunk : m_chunks) {
+            if (chunk.id == id) {
+                return &chunk;
+            }
+        }
+        return nullptr;
+    }
+
+    void SaveArchive::encode(std::vector<char>& output) const {
+        BinaryWriter writer;
+        writer.writeBytes(kArchiveMagic, sizeof(kArchiveMagic));
+        writer.writeU16(kArchiveFormatVersion);
+        writer.writeU16(0);
+        writer.writeU32(static_cast<uint32_t>(m_chunks.size()));
+        output = writer.takeBuffer();
+
+        std::vector<char> compressed;
+        for (const auto& chunk : m_chunks) {
+            const std::vector<char>* stored = &chunk.data;
+            uint16_t flags = 0;
+            if (m_compressionEnabled && chunk.data.size() >= kMinCompressSize) {
+                compressed.clear();
+                LZCompressor::compress(chunk.data.data(), chunk.data.size(), compressed);
+                if (compressed.size() < chunk.data.size()) {
+                    stored = &compressed;
+                    flags |= kChunkFlagCompressed;
+                }
+            }
+
+            BinaryWriter header;
+            header.writeU32(chunk.id);
+            header.writeU16(chunk.version);
+            header.writeU16(flags);
+            header.writeU32(static_cast<uint32_t>(chunk.data.size()));
+            header.writeU32(static_cast<uint32_t>(stored->size()));
+            header.writeU32(crc32(chunk.data.data(), chunk.data.size()));
+
+            const std::vector<char>& headerBytes = header.getBuffer();
+            output.insert(output.end(), headerBytes.begin(), headerBytes.end());
+            output.insert(output.end(), stored->begin(), stored->end());
+        }
+    }
+
+    bool SaveArchive::isArchive(const std::vector<char>& data) {
+        return data.size() >= sizeof(kArchiveMagic) && std::memcmp(data.data(), kArchiveMagic, sizeof(kArchiveMagic)) == 0;
+    }
+
+    bool SaveArchive::decode(const std::vector<char>& input) {
+        m_chunks.clear();
+
+        if (!isArchive(input)) {
+            SPARKY_LOG_ERROR("Not a save archive");
+            return false;
+        }
+
+        BinaryReader reader(input);
+        uint16_t formatVersion = 0, reserved = 0;
+        uint32_t chunkCount = 0;
+        reader.skip(sizeof(kArchiveMagic));
+        if (!reader.readU16(formatVersion) || !reader.readU16(reserved) || !reader.readU32(chunkCount)) {
+            SPARKY_LOG_ERROR("Truncated save archive header");
+            return false;
+        }
+        if (formatVersion > kArchiveFormatVersion) {
+            SPARKY_LOG_ERROR("Save archive format " + std::to_string(formatVersion) + " is newer than supported");
+            return false;
+        }
+
+        std::vector<SaveChunk> chunks;
+        for (uint32_t i = 0; i < chunkCount; ++i) {
+            SaveChunk chunk{};
+            uint16_t flags = 0;
+            uint32_t rawSize = 0, storedSize = 0, crc = 0;
+            if (!reader.readU32(chunk.id) || !reader.readU16(chunk.version) || !reader.readU16(flags) ||
+                !reader.readU32(rawSize) || !reader.readU32(storedSize) || !reader.readU32(crc)) {
+                SPARKY_LOG_ERROR("Truncated save archive chunk header");
+                return false;
+            }
+
+            const char* stored = reader.view(storedSize);
+            if (!stored) {
+                SPARKY_LOG_ERROR("Truncated save archive chunk");
+                return false;
+            }
+
+            if (flags & kChunkFlagCompressed) {
+                // An LZ sequence expands at most ~255x; larger claims are corrupt
+                if (static_cast<uint64_t>(rawSize) > static_cast<uint64_t>(storedSize) * 255 + 16 ||
+                    !LZCompressor::decompress(stored, storedSize, rawSize, chunk.data)) {
+                    SPARKY_LOG_ERROR("Corrupt compressed save archive chunk");
+                    return false;
+                }
+            } else {
+                if (rawSize != storedSize) {
+                    SPARKY_LOG_ERROR("Corrupt save archive chunk size");
+                    return false;
+                }
+                chunk.data.assign(stored, stored + storedSize);
+            }
+
+            if (crc32(chunk.data.data(), chunk.data.size()) != crc) {
+                SPARKY_LOG_ERROR("Save archive chunk failed CRC check");
+                return false;
+            }
+            chunks.push_back(std::move(chunk));
+        }
+
+        m_chunks = std::move(chunks);
+        return true;
+    }
+
+    bool SaveArchive::saveToFile(const std::string& filepath) const {
+        std::vector<char> data;
+        encode(data);
+        return FileUtils::writeFileAtomic(filepath, data);
+    }
+
+    bool SaveArchive::loadFromFile(const std::string& filepath) {
+        std::vector<char> data;
+        try {
+            data = FileUtils::readFile(filepath);
+        } catch (const std::exception& e) {
+            SPARKY_LOG_ERROR("Failed to read save archive: " + std::string(e.what()));
+            return false;
+        }
+
+        if (!decode(data)) {
+            SPARKY_LOG_ERROR("Failed to decode save archive: " + filepath);
+            return false;
+        }
+        return true;
+    }
+
+    void SaveArchive::saveToFileAsync(std::shared_ptr<const SaveArchive> archive, const std::string& filepath,
+                                      JobCounter* counter, std::function<void(bool)> onComplete,
+                                      JobSystem* jobSystem) {
+        JobSystem& jobs = jobSystem ? *jobSystem : JobSystem::getInstance();
+        jobs.runIO([archive, filepath, onComplete]() {
+            bool result = archive->saveToFile(filepath);
+            if (onComplete) {
+                onComplete(result);
+            }
+        }, counter, "SaveArchiveWrite");
+    }
+}
@@ -5,9 +5,9 @@
 #include "../include/Player.h"
 #include "../include/HealthComponent.h"
 #include "../include/Inventory.h"
+#include "../include/SaveArchive.h"
 #include <fstream>
 #include <sstream>
-#include <iomanip>
 #include <filesystem>
 
 #ifdef _WIN32
@@ -17,12 +17,23 @@
 
 namespace Sparky {
 
+    namespace {
+        const uint32_t kPlayerChunk = SaveArchive::makeChunkId('P', 'L', 'Y', 'R');
+        const uint32_t kGameStateChunk = SaveArchive::makeChunkId('G', 'A', 'M', 'E');
+        const uint32_t kInventoryChunk = SaveArchive::makeChunkId('I', 'T', 'M', 'S');
+        const uint32_t kSettingsChunk = SaveArchive::makeChunkId('S', 'E', 'T', 'T');
+        const uint16_t kPlayerChunkVersion = 1;
+        const uint16_t kGameStateChunkVersion = 1;
+        const uint16_t kInventoryChunkVersion = 1;
+        const uint16_t kSettingsChunkVersion = 1;
+    }
+
     SaveGameManager& SaveGameManager::getInstance() {
         static SaveGameManager instance;
         return instance;
     }
     
-    SaveGameManager::SaveGameManager() : autoSave(false) {
+    SaveGameManager::SaveGameManager() : lastSaveSequence(0), nextSaveSequence(0), autoSave(false) {
         // Set default save directory
 #ifdef _WIN32
         // Get user's Documents folder
@@ -104,7 +115,6 @@ namespace Sparky {
         // Save the data
         bool result = saveGame(saveName, data);
         if (result) {
-            lastSave = saveName;
             SPARKY_LOG_INFO("Game saved successfully: " + saveName);
         } else {
             SPARKY_LOG_ERROR("Failed to save game: " + saveName);
@@ -115,18 +125,16 @@ namespace Sparky {
     
     bool SaveGameManager::saveGame(const std::string& saveName, const GameSaveData& data) {
         // Serialize the data
-        std::vector<char> buffer;
-        if (!serializeSaveData(data, buffer)) {
-            SPARKY_LOG_ERROR("Failed to serialize save data");
-            return false;
-        }
+        SaveArchive archive;
+        buildSaveArchive(data, archive);
         
         // Write to file
         std::string savePath = getSaveFilePath(saveName);
-        bool result = FileUtils::writeFile(savePath, buffer);
+        uint64_t sequence = ++nextSaveSequence;
+        bool result = archive.saveToFile(savePath);
         
         if (result) {
-            lastSave = saveName;
+            setLastSave(saveName, sequence);
             SPARKY_LOG_INFO("Game saved successfully to: " + savePath);
         } else {
             SPARKY_LOG_ERROR("Failed to write save file: " + savePath);
@@ -135,6 +143,22 @@ namespace Sparky {
         return result;
     }
     
+    void SaveGameManager::saveGameAsync(const std::string& saveName, const GameSaveData& data, JobCounter* counter) {
+        auto archive = std::make_shared<SaveArchive>();
+        buildSaveArchive(data, *archive);
+        
+        std::string savePath = getSaveFilePath(saveName);
+        uint64_t sequence = ++nextSaveSequence;
+        SaveArchive::saveToFileAsync(archive, savePath, counter, [this, saveName, savePath, sequence](bool result) {
+            if (result) {
+                setLastSave(saveName, sequence);
+                SPARKY_LOG_INFO("Game saved successfully to: " + savePath);
+            } else {
+                SPARKY_LOG_ERROR("Failed to write save file: " + savePath);
+            }
+        });
+    }
+    
     bool SaveGameManager::loadGame(const std::string& saveName, Player* player, Level* level, Inventory* inventory) {
         if (!player) {
             SPARKY_LOG_ERROR("Cannot load game: Player is null");
@@ -185,13 +209,21 @@ namespace Sparky {
             return false;
         }
         
-        // Deserialize the data
-        if (!deserializeSaveData(buffer, data)) {
+        // Deserialize the data; saves from before the archive format are key=value text
+        bool result = false;
+        if (SaveArchive::isArchive(buffer)) {
+            SaveArchive archive;
+            result = archive.decode(buffer) && readSaveArchive(archive, data);
+        } else {
+            result = deserializeLegacySaveData(buffer, data);
+        }
+        
+        if (!result) {
             SPARKY_LOG_ERROR("Failed to deserialize save data from: " + savePath);
             return false;
         }
         
-        lastSave = saveName;
+        setLastSave(saveName, ++nextSaveSequence);
         SPARKY_LOG_INFO("Game loaded successfully from: " + savePath);
         return true;
     }
@@ -261,58 +293,117 @@ namespace Sparky {
         return saveDirectory + "/" + saveName + ".sav";
     }
     
-    bool SaveGameManager::serializeSaveData(const GameSaveData& data, std::vector<char>& buffer) const {
-        try {
-            // Create a string stream to serialize the data
-            std::ostringstream oss;
-            oss << std::fixed << std::setprecision(6);
-            
-            // Serialize player data
-            oss << "playerHealth=" << data.playerHealth << "\n";
-            oss << "playerMaxHealth=" << data.playerMaxHealth << "\n";
-            oss << "playerPosition=" << data.playerPosition[0] << "," << data.playerPosition[1] << "," << data.playerPosition[2] << "\n";
-            oss << "playerRotation=" << data.playerRotation[0] << "," << data.playerRotation[1] << "," << data.playerRotation[2] << "\n";
-            
-            // Serialize game state
-            oss << "currentLevel=" << data.currentLevel << "\n";
-            oss << "score=" << data.score << "\n";
-            oss << "playTime=" << data.playTime << "\n";
-            
-            // Serialize inventory data
-            oss << "inventoryItems=";
-            for (size_t i = 0; i < data.inventoryItems.size(); ++i) {
-                if (i > 0) oss << ";";
-                oss << data.inventoryItems[i];
-            }
-            oss << "\n";
-            
-            oss << "inventoryQuantities=";
-            for (size_t i = 0; i < data.inventoryQuantities.size(); ++i) {
-                if (i > 0) oss << ";";
-                oss << data.inventoryQuantities[i];
+    std::string SaveGameManager::getLastSave() const {
+        std::lock_guard<std::mutex> lock(lastSaveMutex);
+        return lastSave;
+    }
+    
+    void SaveGameManager::setLastSave(const std::string& saveName, uint64_t sequence) {
+        std::lock_guard<std::mutex> lock(lastSaveMutex);
+        if (sequence > lastSaveSequence) {
+            lastSave = saveName;
+            lastSaveSequence = sequence;
+        }
+    }
+    
+    void SaveGameManager::buildSaveArchive(const GameSaveData& data, SaveArchive& archive) const {
+        BinaryWriter player;
+        player.writeFloat(data.playerHealth);
+        player.writeFloat(data.playerMaxHealth);
+        player.writeVec3(glm::vec3(data.playerPosition[0], data.playerPosition[1], data.playerPosition[2]));
+        player.writeVec3(glm::vec3(data.playerRotation[0], data.playerRotation[1], data.playerRotation[2]));
+        archive.setChunk(kPlayerChunk, kPlayerChunkVersion, player);
+        
+        BinaryWriter gameState;
+        gameState.writeI32(data.currentLevel);
+        gameState.writeI32(data.score);
+        gameState.writeFloat(data.playTime);
+        archive.setChunk(kGameStateChunk, kGameStateChunkVersion, gameState);
+        
+        BinaryWriter inventory;
+        inventory.writeU32(static_cast<uint32_t>(data.inventoryItems.size()));
+        for (size_t i = 0; i < data.inventoryItems.size(); ++i) {
+            inventory.writeString(data.inventoryItems[i]);
+            inventory.writeI32(i < data.inventoryQuantities.size() ? data.inventoryQuantities[i] : 1);
+        }
+        archive.setChunk(kInventoryChunk, kInventoryChunkVersion, inventory);
+        
+        BinaryWriter settings;
+        settings.writeFloat(data.masterVolume);
+        settings.writeFloat(data.musicVolume);
+        settings.writeFloat(data.sfxVolume);
+        settings.writeBool(data.fullscreen);
+        settings.writeI32(data.resolutionWidth);
+        settings.writeI32(data.resolutionHeight);
+        archive.setChunk(kSettingsChunk, kSettingsChunkVersion, settings);
+    }
+    
+    bool SaveGameManager::readSaveArchive(const SaveArchive& archive, GameSaveData& data) const {
+        const SaveChunk* player = archive.getChunk(kPlayerChunk);
+        const SaveChunk* gameState = archive.getChunk(kGameStateChunk);
+        const SaveChunk* inventory = archive.getChunk(kInventoryChunk);
+        const SaveChunk* settings = archive.getChunk(kSettingsChunk);
+        if (!player || !gameState || !inventory || !settings) {
+            SPARKY_LOG_ERROR("Save archive is missing required chunks");
+            return false;
+        }
+        // Written by a newer build; there is no way to read it back
+        if (player->version > kPlayerChunkVersion || gameState->version > kGameStateChunkVersion ||
+            inventory->version > kInventoryChunkVersion || settings->version > kSettingsChunkVersion) {
+            SPARKY_LOG_ERROR("Save archive has chunks from a newer version of the game");
+            return false;
+        }
+        
+        data = GameSaveData();
+        
+        BinaryReader playerReader(player->data);
+        glm::vec3 position(0.0f), rotation(0.0f);
+        if (!playerReader.readFloat(data.playerHealth) || !playerReader.readFloat(data.playerMaxHealth) ||
+            !playerReader.readVec3(position) || !playerReader.readVec3(rotation)) {
+            SPARKY_LOG_ERROR("Corrupt player chunk in save archive");
+            return false;
+        }
+        for (int i = 0; i < 3; ++i) {
+            data.playerPosition[i] = position[i];
+            data.playerRotation[i] = rotation[i];
+        }
+        
+        BinaryReader gameStateReader(gameState->data);
+        if (!gameStateReader.readI32(data.currentLevel) || !gameStateReader.readI32(data.score) ||
+            !gameStateReader.readFloat(data.playTime)) {
+            SPARKY_LOG_ERROR("Corrupt game state chunk in save archive");
+            return false;
+        }
+        
+        BinaryReader inventoryReader(inventory->data);
+        uint32_t itemCount = 0;
+        if (!inventoryReader.readU32(itemCount)) {
+            SPARKY_LOG_ERROR("Corrupt inventory chunk in save archive");
+            return false;
+        }
+        for (uint32_t i = 0; i < itemCount; ++i) {
+            std::string item;
+            int32_t quantity = 0;
+            if (!inventoryReader.readString(item) || !inventoryReader.readI32(quantity)) {
+                SPARKY_LOG_ERROR("Corrupt inventory chunk in save archive");
+                return false;
             }
-            oss << "\n";
-            
-            // Serialize settings
-            oss << "masterVolume=" << data.masterVolume << "\n";
-            oss << "musicVolume=" << data.musicVolume << "\n";
-            oss << "sfxVolume=" << data.sfxVolume << "\n";
-            oss << "fullscreen=" << (data.fullscreen ? "true" : "false") << "\n";
-            oss << "resolutionWidth=" << data.resolutionWidth << "\n";
-            oss << "resolutionHeight=" << data.resolutionHeight << "\n";
-            
-            // Convert to vector of chars
-            std::string str = oss.str();
-            buffer.assign(str.begin(), str.end());
-            
-            return true;
-        } catch (const std::exception& e) {
-            SPARKY_LOG_ERROR("Failed to serialize save data: " + std::string(e.what()));
+            data.inventoryItems.push_back(item);
+            data.inventoryQuantities.push_back(quantity);
+        }
+        
+        BinaryReader settingsReader(settings->data);
+        if (!settingsReader.readFloat(data.masterVolume) || !settingsReader.readFloat(data.musicVolume) ||
+            !settingsReader.readFloat(data.sfxVolume) || !settingsReader.readBool(data.fullscreen) ||
+            !settingsReader.readI32(data.resolutionWidth) || !settingsReader.readI32(data.resolutionHeight)) {
+            SPARKY_LOG_ERROR("Corrupt settings chunk in save archive");
             return false;
         }
+        
+        return true;
     }
     
-    bool SaveGameManager::deserializeSaveData(const std::vector<char>& buffer, GameSaveData& data) const {
+    bool SaveGameManager::deserializeLegacySaveData(const std::vector<char>& buffer, GameSaveData& data) const {
         try {
             // Convert vector of chars to string
             std::string str(buffer.begin(), buffer.end());
@@ -7,7 +7,8 @@
 
 namespace Sparky {
 
-    Scene::Scene() : renderSystem(nullptr), physicsWorld(nullptr), active(true), physicsEnabled(true), gravity(0.0f, -9.81f, 0.0f) {
+    Scene::Scene() : renderSystem(nullptr), physicsWorld(nullptr), active(true), physicsEnabled(true), gravity(0.0f, -9.81f, 0.0f),
+        updateScheduler(std::make_unique<UpdateScheduler>()), parallelUpdateEnabled(false) {
     }
 
     Scene::~Scene() {
@@ -28,8 +29,12 @@ namespace Sparky {
         if (!active) return;
         
         // Update all game objects
-        for (auto& object : gameObjects) {
-            object->update(deltaTime);
+        if (parallelUpdateEnabled) {
+            updateScheduler->update(gameObjects, deltaTime);
+        } else {
+            for (auto& object : gameObjects) {
+                object->update(deltaTime);
+            }
         }
         
         // Update physics if enabled
@@ -100,6 +105,21 @@ namespace Sparky {
         return gravity;
     }
 
+    void Scene::setParallelUpdateEnabled(bool enabled) {
+        parallelUpdateEnabled = enabled;
+        
+        // Objects go back to updating every component themselves when disabled
+        if (!enabled) {
+            for (auto& object : gameObjects) {
+                object->setPhasedUpdate(false);
+            }
+        }
+    }
+
+    bool Scene::isParallelUpdateEnabled() const {
+        return parallelUpdateEnabled;
+    }
+
     void Scene::setTag(const std::string& tag) {
         this->tag = tag;
     }
@@ -0,0 +1,430 @@
+#include "../include/SceneSnapshot.h"
+#include "../include/Scene.h"
+#include "../include/JobSystem.h"
+#include "../include/SaveArchive.h"
+#include "../include/FileUtils.h"
+#include "../include/Logger.h"
+#include "../include/HealthComponent.h"
+#include "../include/PhysicsComponent.h"
+#include "../include/RigidBodyComponent.h"
+#include <chrono>
+#include <stdexcept>
+
+namespace Sparky {
+
+    namespace {
+        const uint32_t kSnapshotHeaderChunk = SaveArchive::makeChunkId('S', 'N', 'A', 'P');
+        const uint32_t kSnapshotObjectsChunk = SaveArchive::makeChunkId('O', 'B', 'J', 'S');
+        const uint16_t kSnapshotChunkVersion = 1;
+
+        void buildArchive(const SceneSnapshot& snapshot, SaveArchive& archive) {
+            BinaryWriter header;
+            header.writeBool(snapshot.delta);
+            header.writeU32(snapshot.sequence);
+            header.writeU32(snapshot.baseSequence);
+            header.writeU32(static_cast<uint32_t>(snapshot.objects.size()));
+            archive.setChunk(kSnapshotHeaderChunk, kSnapshotChunkVersion, header);
+
+            BinaryWriter records;
+            for (const auto& record : snapshot.objects) {
+                records.writeString(record.name);
+                records.writeU32(record.revision);
+                records.writeBool(record.removed);
+                if (!record.removed) {
+                    uint32_t size = record.data ? static_cast<uint32_t>(record.data->size()) : 0;
+                    records.writeU32(size);
+                    if (size > 0) {
+                        records.writeBytes(record.data->data(), size);
+                    }
+                }
+            }
+            archive.setChunk(kSnapshotObjectsChunk, kSnapshotChunkVersion, records);
+        }
+
+        SnapshotSerializable* findSerializable(GameObject& object, uint32_t typeId) {
+            for (const auto& component : object.getComponents()) {
+                SnapshotSerializable* serializable = dynamic_cast<SnapshotSerializable*>(component.get());
+                if (serializable && serializable->getSnapshotTypeId() == typeId) {
+                    return serializable;
+                }
+            }
+            return nullptr;
+        }
+    }
+
+    SnapshotManager::SnapshotManager()
+        : m_jobSystem(&JobSystem::getInstance()), m_sequence(0), m_stats(),
+          m_writeCounter(std::make_unique<JobCounter>()),
+          m_lastWriteSucceeded(std::make_shared<std::atomic<bool>>(true)) {
+        registerComponentType<HealthComponent>();
+        registerComponentType<PhysicsComponent>();
+        registerComponentType<RigidBodyComponent>();
+    }
+
+    SnapshotManager::~SnapshotManager() {
+        waitForWrites();
+    }
+
+    std::shared_ptr<const std::vector<char>> SnapshotManager::serializeObject(const GameObject& object) {
+        BinaryWriter writer;
+        writer.writeVec3(object.getPosition());
+        writer.writeVec3(object.getRotation());
+        writer.writeVec3(object.getScale());
+
+        size_t countPosition = writer.reserveU32();
+        uint32_t componentCount = 0;
+        for (const auto& component : object.getComponents()) {
+            const SnapshotSerializable* serializable = dynamic_cast<const SnapshotSerializable*>(component.get());
+            if (!serializable) continue;
+
+            writer.writeU32(serializable->getSnapshotTypeId());
+            writer.writeU16(serializable->getSnapshotVersion());
+            size_t sizePosition = writer.reserveU32();
+            size_t start = writer.size();
+            serializable->serialize(writer);
+            writer.patchU32(sizePosition, static_cast<uint32_t>(writer.size() - start));
+            ++componentCount;
+        }
+        writer.patchU32(countPosition, componentCount);
+
+        return std::make_shared<const std::vector<char>>(writer.takeBuffer());
+    }
+
+    std::shared_ptr<const SceneSnapshot> SnapshotManager::capture(const Scene& scene, SnapshotMode mode) {
+        auto startTime = std::chrono::high_resolution_clock::now();
+
+        auto snapshot = std::make_shared<SceneSnapshot>();
+        snapshot->delta = mode == SnapshotMode::DELTA;
+        snapshot->baseSequence = m_sequence;
+        snapshot->sequence = ++m_sequence;
+
+        SnapshotStats stats{};
+
+        for (auto& entry : m_cache) {
+            entry.second.seen = false;
+        }
+
+        // Classify objects; only changed ones are serialized below
+        struct PendingObject {
+            size_t recordIndex;
+            const GameObject* object;
+            CachedObject* entry;
+        };
+        std::vector<PendingObject> pending;
+
+        const auto& objects = scene.getGameObjects();
+        snapshot->objects.reserve(objects.size());
+        for (const auto& object : objects) {
+            auto result = m_cache.emplace(object->getName(), CachedObject{nullptr, 0, nullptr, false});
+            CachedObject& entry = result.first->second;
+            if (entry.seen) {
+                // Saves and loads match objects by name, so one of the two would be lost or restored into the other.
+                // Entries may already point at this capture's objects, so the next capture starts from scratch.
+                SPARKY_LOG_ERROR("Snapshot capture failed, duplicate object name: " + object->getName());
+                m_cache.clear();
+                m_sequence = snapshot->baseSequence;
+                return nullptr;
+            }
+            entry.seen = true;
+
+            uint32_t revision = object->getRevision();
+            bool changed = result.second || !entry.data || entry.object != object.get() || entry.revision != revision;
+            if (!changed && snapshot->delta) {
+                continue;
+            }
+
+            if (changed) {
+                entry.object = object.get();
+                entry.revision = revision;
+                pending.push_back({snapshot->objects.size(), object.get(), &entry});
+            } else {
+                stats.objectsReused++;
+            }
+            snapshot->objects.push_back({object->getName(), revision, false, entry.data});
+        }
+
+        // Objects serialize independently, so large captures spread across workers
+        auto serializeRange = [&snapshot, &pending](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                auto data = serializeObject(*pending[i].object);
+                pending[i].entry->data = data;
+                snapshot->objects[pending[i].recordIndex].data = data;
+            }
+        };
+        if (m_jobSystem && pending.size() > 64) {
+            m_jobSystem->parallelFor(pending.size(), 32, serializeRange);
+        } else {
+            serializeRange(0, pending.size());
+        }
+        stats.objectsSerialized = pending.size();
+
+        // Objects that disappeared since the previous capture
+        for (auto it = m_cache.begin(); it != m_cache.end();) {
+            if (it->second.seen) {
+                ++it;
+                continue;
+            }
+            if (snapshot->delta) {
+                snapshot->objects.push_back({it->first, 0, true, nullptr});
+            }
+            stats.objectsRemoved++;
+            it = m_cache.erase(it);
+        }
+
+        for (const auto& record : snapshot->objects) {
+            if (record.data) {
+                stats.payloadBytes += record.data->size();
+            }
+        }
+        stats.captureMs = std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - startTime).count();
+        m_stats = stats;
+
+        return snapshot;
+    }
+
+    void SnapshotManager::encode(const SceneSnapshot& snapshot, std::vector<char>& output) {
+        SaveArchive archive;
+        buildArchive(snapshot, archive);
+        archive.encode(output);
+    }
+
+    std::shared_ptr<SceneSnapshot> SnapshotManager::decode(const std::vector<char>& input) {
+        SaveArchive archive;
+        if (!archive.decode(input)) {
+            return nullptr;
+        }
+
+        const SaveChunk* headerChunk = archive.getChunk(kSnapshotHeaderChunk);
+        const SaveChunk* objectsChunk = archive.getChunk(kSnapshotObjectsChunk);
+        if (!headerChunk || !objectsChunk) {
+            SPARKY_LOG_ERROR("Save archive is not a scene snapshot");
+            return nullptr;
+        }
+        if (headerChunk->version > kSnapshotChunkVersion || objectsChunk->version > kSnapshotChunkVersion) {
+            SPARKY_LOG_ERROR("Unsupported scene snapshot version: " + std::to_string(headerChunk->version));
+            return nullptr;
+        }
+
+        auto snapshot = std::make_shared<SceneSnapshot>();
+        BinaryReader header(headerChunk->data);
+        uint32_t objectCount = 0;
+        if (!header.readBool(snapshot->delta) || !header.readU32(snapshot->sequence) ||
+            !header.readU32(snapshot->baseSequence) || !header.readU32(objectCount)) {
+            SPARKY_LOG_ERROR("Corrupt scene snapshot header");
+            return nullptr;
+        }
+
+        BinaryReader records(objectsChunk->data);
+        snapshot->objects.reserve(objectCount);
+        for (uint32_t i = 0; i < objectCount; ++i) {
+            SnapshotObject record{};
+            if (!records.readString(record.name) || !records.readU32(record.revision) || !records.readBool(record.removed)) {
+                SPARKY_LOG_ERROR("Corrupt scene snapshot record");
+                return nullptr;
+            }
+            if (!record.removed) {
+                uint32_t size = 0;
+                const char* data = records.readU32(size) ? records.view(size) : nullptr;
+                if (!data) {
+                    SPARKY_LOG_ERROR("Corrupt scene snapshot record: " + record.name);
+                    return nullptr;
+                }
+                record.data = std::make_shared<const std::vector<char>>(data, data + size);
+            }
+            snapshot->objects.push_back(std::move(record));
+        }
+        return snapshot;
+    }
+
+    bool SnapshotManager::writeSnapshotFile(const SceneSnapshot& snapshot, const std::string& filepath) {
+        SaveArchive archive;
+        buildArchive(snapshot, archive);
+        return archive.saveToFile(filepath);
+    }
+
+    void SnapshotManager::saveAsync(const Scene& scene, const std::string& filepath, SnapshotMode mode) {
+        std::shared_ptr<const SceneSnapshot> snapshot = capture(scene, mode);
+        if (!snapshot) {
+            // Earlier writes finishing later must not report this save as a success
+            if (m_jobSystem) {
+                m_jobSystem->wait(*m_writeCounter);
+            }
+            m_lastWriteSucceeded->store(false);
+            return;
+        }
+        std::shared_ptr<std::atomic<bool>> succeeded = m_lastWriteSucceeded;
+
+        Job write = [snapshot, filepath, succeeded]() {
+            succeeded->store(writeSnapshotFile(*snapshot, filepath));
+        };
+
+        if (m_jobSystem) {
+            m_jobSystem->runIO(std::move(write), m_writeCounter.get(), "SceneSnapshotWrite");
+        } else {
+            write();
+        }
+    }
+
+    bool SnapshotManager::save(const Scene& scene, const std::string& filepath, SnapshotMode mode) {
+        std::shared_ptr<const SceneSnapshot> snapshot = capture(scene, mode);
+        if (!snapshot) {
+            return false;
+        }
+        if (!writeSnapshotFile(*snapshot, filepath)) {
+            SPARKY_LOG_ERROR("Failed to write scene snapshot: " + filepath);
+            return false;
+        }
+        return true;
+    }
+
+    void SnapshotManager::waitForWrites() {
+        if (m_jobSystem) {
+            m_jobSystem->wait(*m_writeCounter);
+        }
+        if (!m_lastWriteSucceeded->load()) {
+            SPARKY_LOG_ERROR("Background scene snapshot write failed");
+        }
+    }
+
+    bool SnapshotManager::didLastWriteSucceed() const {
+        return m_lastWriteSucceeded->load();
+    }
+
+    bool SnapshotManager::load(Scene& scene, const std::vector<std::string>& filepaths) {
+        if (filepaths.empty()) {
+            return false;
+        }
+
+        // Decode and validate the whole chain before touching the scene
+        std::vector<std::shared_ptr<SceneSnapshot>> chain;
+        for (const auto& filepath : filepaths) {
+            std::vector<char> data;
+            try {
+                data = FileUtils::readFile(filepath);
+            } catch (const std::exception& e) {
+                SPARKY_LOG_ERROR("Failed to read scene snapshot: " + std::string(e.what()));
+                return false;
+            }
+
+            std::shared_ptr<SceneSnapshot> snapshot = decode(data);
+            if (!snapshot) {
+                SPARKY_LOG_ERROR("Failed to decode scene snapshot: " + filepath);
+                return false;
+            }
+
+            bool expectDelta = !chain.empty();
+            if (snapshot->delta != expectDelta ||
+                (expectDelta && snapshot->baseSequence != chain.back()->sequence)) {
+                SPARKY_LOG_ERROR("Scene snapshot does not continue the chain: " + filepath);
+                return false;
+            }
+            chain.push_back(snapshot);
+        }
+
+        bool success = true;
+        for (const auto& snapshot : chain) {
+            success = apply(*snapshot, scene) && success;
+        }
+
+        // The loaded state becomes the base for the next delta
+        m_cache.clear();
+        capture(scene, SnapshotMode::FULL);
+        m_sequence = chain.back()->sequence;
+
+        SPARKY_LOG_INFO("Scene snapshot loaded from " + std::to_string(chain.size()) + " file(s)");
+        return success;
+    }
+
+    bool SnapshotManager::apply(const SceneSnapshot& snapshot, Scene& scene) {
+        // Scene lookups are linear, so index the objects once per snapshot
+        std::unordered_map<std::string, GameObject*> index;
+        index.reserve(scene.getGameObjectCount());
+        for (const auto& object : scene.getGameObjects()) {
+            if (!index.emplace(object->getName(), object.get()).second) {
+                SPARKY_LOG_ERROR("Cannot apply scene snapshot, duplicate object name: " + object->getName());
+                return false;
+            }
+        }
+
+        bool success = true;
+        for (const auto& record : snapshot.objects) {
+            success = applyObject(record, scene, index) && success;
+        }
+        return success;
+    }
+
+    bool SnapshotManager::applyObject(const SnapshotObject& record, Scene& scene,
+                                      std::unordered_map<std::string, GameObject*>& index) {
+        if (record.removed) {
+            scene.removeGameObject(record.name);
+            index.erase(record.name);
+            return true;
+        }
+        if (!record.data) {
+            return false;
+        }
+
+        auto found = index.find(record.name);
+        GameObject* object = found != index.end() ? found->second : nullptr;
+        std::unique_ptr<GameObject> created;
+        if (!object) {
+            created = std::make_unique<GameObject>(record.name);
+            object = created.get();
+        }
+
+        BinaryReader reader(*record.data);
+        glm::vec3 position, rotation, scale;
+        uint32_t componentCount = 0;
+        if (!reader.readVec3(position) || !reader.readVec3(rotation) || !reader.readVec3(scale) ||
+            !reader.readU32(componentCount)) {
+            SPARKY_LOG_ERROR("Corrupt snapshot data for object: " + record.name);
+            return false;
+        }
+        object->setPosition(position);
+        object->setRotation(rotation);
+        object->setScale(scale);
+
+        bool success = true;
+        for (uint32_t i = 0; i < componentCount; ++i) {
+            uint32_t typeId = 0, size = 0;
+            uint16_t version = 0;
+            const char* bytes = nullptr;
+            if (!reader.readU32(typeId) || !reader.readU16(version) || !reader.readU32(size) ||
+                !(bytes = reader.view(size))) {
+                SPARKY_LOG_ERROR("Corrupt component data for object: " + record.name);
+                success = false;
+                break;
+            }
+
+            SnapshotSerializable* target = findSerializable(*object, typeId);
+            if (!target) {
+                auto factory = m_factories.find(typeId);
+                if (factory == m_factories.end()) {
+                    SPARKY_LOG_WARNING("Skipping unregistered snapshot component on object: " + record.name);
+                    continue;
+                }
+                target = factory->second(*object);
+            }
+
+            // Each component reads from its own bounded view, so a version mismatch
+            // cannot desynchronize the records that follow
+            BinaryReader componentReader(bytes, size);
+            if (!target->deserialize(componentReader, version)) {
+                SPARKY_LOG_WARNING("Failed to restore component " + std::string(target->getSnapshotTypeName()) +
+                                   " on object: " + record.name);
+                success = false;
+            }
+        }
+
+        if (created) {
+            index[record.name] = object;
+            scene.addGameObject(std::move(created));
+        }
+        return success;
+    }
+
+    void SnapshotManager::invalidate() {
+        m_cache.clear();
+    }
+}
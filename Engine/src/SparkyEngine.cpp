@@ -1,5 +1,6 @@
 #include "../include/SparkyEngine.h"
 #include "../include/Logger.h"
+#include "../include/JobSystem.h"
 
 #ifdef HAS_GLFW
 #include <GLFW/glfw3.h>
@@ -7,7 +8,7 @@
 
 namespace Sparky {
 
-    Engine::Engine() : logger(), isRunning(false) {
+    Engine::Engine() : logger(), activeScene(nullptr), isRunning(false) {
     }
 
     Engine::~Engine() {
@@ -17,6 +18,10 @@ namespace Sparky {
     bool Engine::initialize(int windowWidth, int windowHeight, const char* windowTitle) {
         SPARKY_LOG_INFO("Initializing Sparky Engine...");
         
+        // Start worker threads before any subsystem wants to submit jobs
+        SPARKY_LOG_INFO("Initializing job system...");
+        JobSystem::getInstance().initialize();
+        
         // Initialize window manager
         SPARKY_LOG_INFO("Initializing window manager...");
         if (!windowManager.initialize(windowWidth, windowHeight, windowTitle)) {
@@ -49,6 +54,11 @@ namespace Sparky {
         return true;
     }
 
+    void Engine::setScene(Scene* scene) {
+        activeScene = scene;
+        replayRecorder.setScene(scene);
+    }
+
     void Engine::run() {
         SPARKY_LOG_INFO("Starting game loop...");
         float lastTime = 0.0f;
@@ -88,6 +98,9 @@ namespace Sparky {
             // Poll events
             windowManager.pollEvents();
             
+            // Record what the window delivered this tick, before it is consumed
+            replayRecorder.beginTick(deltaTime, inputManager);
+            
             // Update input
             inputManager.update();
             
@@ -99,6 +112,8 @@ namespace Sparky {
             
             // Render frame
             renderer.render();
+            
+            replayRecorder.endTick();
         }
         
         SPARKY_LOG_INFO("Game loop ended after " + std::to_string(frameCount) + " frames");
@@ -107,9 +122,11 @@ namespace Sparky {
     void Engine::shutdown() {
         if (isRunning) {
             SPARKY_LOG_INFO("Shutting down Sparky Engine...");
+            replayRecorder.stop();
             renderSystem.cleanup();
             renderer.cleanup();
             windowManager.cleanup();
+            JobSystem::getInstance().shutdown();
             isRunning = false;
             SPARKY_LOG_INFO("Sparky Engine shut down");
         }
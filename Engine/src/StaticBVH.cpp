@@ -0,0 +1,269 @@
+#include "../include/StaticBVH.h"
+#include "../include/JobSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace Sparky {
+    namespace {
+        const float kInfinity = std::numeric_limits<float>::infinity();
+        const uint32_t kMaxLeafBoxes = 4;
+        const int kSplitBins = 8;
+        const int kMaxStackDepth = 64;
+        const size_t kOcclusionGrain = 64;   // Segments per job
+
+        float surfaceArea(const glm::vec3& minBounds, const glm::vec3& maxBounds) {
+            glm::vec3 extent = maxBounds - minBounds;
+            return extent.x * extent.y + extent.y * extent.z + extent.z * extent.x;
+        }
+
+        // Zero components would turn the slab test into 0 * inf; a huge finite
+        // reciprocal keeps rays that run along a face well defined.
+        glm::vec3 safeInverse(const glm::vec3& direction) {
+            glm::vec3 inverse;
+            for (int axis = 0; axis < 3; ++axis) {
+                inverse[axis] = std::abs(direction[axis]) > 1e-20f ? 1.0f / direction[axis]
+                                                                 : std::copysign(1e20f, direction[axis]);
+            }
+            return inverse;
+        }
+
+        // Entry distance of the ray into the box, or infinity when it misses
+        // or only enters at or beyond maxT. Rays starting inside enter at 0.
+        float slabEntry(const glm::vec3& minBounds, const glm::vec3& maxBounds, const glm::vec3& origin,
+                        const glm::vec3& inverse, float maxT, int* entryAxis) {
+            glm::vec3 t1 = (minBounds - origin) * inverse;
+            glm::vec3 t2 = (maxBounds - origin) * inverse;
+            glm::vec3 tNear = glm::min(t1, t2);
+            glm::vec3 tFar = glm::max(t1, t2);
+            float entry = std::max(std::max(tNear.x, tNear.y), tNear.z);
+            float exit = std::min(std::min(tFar.x, tFar.y), tFar.z);
+            if (exit < entry || exit < 0.0f || entry >= maxT) return kInfinity;
+            if (entryAxis) {
+                *entryAxis = entry == tNear.x ? 0 : (entry == tNear.y ? 1 : 2);
+                if (entry < 0.0f) *entryAxis = -1;
+            }
+            return std::max(entry, 0.0f);
+        }
+    }
+
+    StaticBVH::StaticBVH() : m_dirty(false) {
+    }
+
+    int StaticBVH::addBox(const glm::vec3& minBounds, const glm::vec3& maxBounds, GameObject* object) {
+        m_boxMin.push_back(glm::min(minBounds, maxBounds));
+        m_boxMax.push_back(glm::max(minBounds, maxBounds));
+        m_boxObject.push_back(object);
+        m_dirty = true;
+        return static_cast<int>(m_boxMin.size()) - 1;
+    }
+
+    void StaticBVH::clear() {
+        m_boxMin.clear();
+        m_boxMax.clear();
+        m_boxObject.clear();
+        m_order.clear();
+        m_nodes.clear();
+        m_dirty = false;
+    }
+
+    void StaticBVH::build() {
+        m_nodes.clear();
+        m_order.resize(m_boxMin.size());
+        std::iota(m_order.begin(), m_order.end(), 0u);
+        m_dirty = false;
+        if (m_boxMin.empty()) return;
+
+        std::vector<glm::vec3> centroids(m_boxMin.size());
+        for (size_t box = 0; box < m_boxMin.size(); ++box) {
+            centroids[box] = (m_boxMin[box] + m_boxMax[box]) * 0.5f;
+        }
+
+        // A binary tree over N leaves never needs more than 2N - 1 nodes
+        m_nodes.reserve(m_boxMin.size() * 2);
+        Node root;
+        root.leftOrFirst = 0;
+        root.count = static_cast<uint32_t>(m_boxMin.size());
+        m_nodes.push_back(root);
+        subdivide(0, 1, centroids);
+    }
+
+    void StaticBVH::subdivide(uint32_t nodeIndex, int depth, std::vector<glm::vec3>& centroids) {
+        const uint32_t first = m_nodes[nodeIndex].leftOrFirst;
+        const uint32_t count = m_nodes[nodeIndex].count;
+
+        glm::vec3 minBounds(kInfinity), maxBounds(-kInfinity);
+        glm::vec3 centroidMin(kInfinity), centroidMax(-kInfinity);
+        for (uint32_t i = first; i < first + count; ++i) {
+            uint32_t box = m_order[i];
+            minBounds = glm::min(minBounds, m_boxMin[box]);
+            maxBounds = glm::max(maxBounds, m_boxMax[box]);
+            centroidMin = glm::min(centroidMin, centroids[box]);
+            centroidMax = glm::max(centroidMax, centroids[box]);
+        }
+        m_nodes[nodeIndex].minBounds = minBounds;
+        m_nodes[nodeIndex].maxBounds = maxBounds;
+        // Depth is capped so traversal never pushes more than one far child per level
+        if (count <= kMaxLeafBoxes || depth >= kMaxStackDepth) return;
+
+        // Binned SAH: bucket centroids along each axis and take the cheapest plane
+        float bestCost = surfaceArea(minBounds, maxBounds) * count;
+        int bestAxis = -1;
+        int bestBin = 0;
+        for (int axis = 0; axis < 3; ++axis) {
+            float extent = centroidMax[axis] - centroidMin[axis];
+            if (extent <= 0.0f) continue;
+            float scale = kSplitBins / extent;
+
+            uint32_t binCount[kSplitBins] = {};
+            glm::vec3 binMin[kSplitBins], binMax[kSplitBins];
+            std::fill(binMin, binMin + kSplitBins, glm::vec3(kInfinity));
+            std::fill(binMax, binMax + kSplitBins, glm::vec3(-kInfinity));
+            for (uint32_t i = first; i < first + count; ++i) {
+                uint32_t box = m_order[i];
+                int bin = std::min(kSplitBins - 1, static_cast<int>((centroids[box][axis] - centroidMin[axis]) * scale));
+                ++binCount[bin];
+                binMin[bin] = glm::min(binMin[bin], m_boxMin[box]);
+                binMax[bin] = glm::max(binMax[bin], m_boxMax[box]);
+            }
+
+            // Left sweep stores the cost of everything below each plane
+            float leftCost[kSplitBins - 1];
+            glm::vec3 sweepMin(kInfinity), sweepMax(-kInfinity);
+            uint32_t sweepCount = 0;
+            for (int plane = 0; plane < kSplitBins - 1; ++plane) {
+                sweepCount += binCount[plane];
+                sweepMin = glm::min(sweepMin, binMin[plane]);
+                sweepMax = glm::max(sweepMax, binMax[plane]);
+                leftCost[plane] = sweepCount ? surfaceArea(sweepMin, sweepMax) * sweepCount : 0.0f;
+            }
+            sweepMin = glm::vec3(kInfinity);
+            sweepMax = glm::vec3(-kInfinity);
+            sweepCount = 0;
+            for (int plane = kSplitBins - 2; plane >= 0; --plane) {
+                sweepCount += binCount[plane + 1];
+                sweepMin = glm::min(sweepMin, binMin[plane + 1]);
+                sweepMax = glm::max(sweepMax, binMax[plane + 1]);
+                if (sweepCount == 0 || sweepCount == count) continue;
+                float cost = leftCost[plane] + surfaceArea(sweepMin, sweepMax) * sweepCount;
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestBin = plane;
+                }
+            }
+        }
+        if (bestAxis < 0) return;
+
+        float scale = kSplitBins / (centroidMax[bestAxis] - centroidMin[bestAxis]);
+        auto middle = std::partition(m_order.begin() + first, m_order.begin() + first + count, [&](uint32_t box) {
+            int bin = std::min(kSplitBins - 1, static_cast<int>((centroids[box][bestAxis] - centroidMin[bestAxis]) * scale));
+            return bin <= bestBin;
+        });
+        uint32_t leftCount = static_cast<uint32_t>(middle - (m_order.begin() + first));
+        if (leftCount == 0 || leftCount == count) return;
+
+        uint32_t leftIndex = static_cast<uint32_t>(m_nodes.size());
+        Node left;
+        left.leftOrFirst = first;
+        left.count = leftCount;
+        Node right;
+        right.leftOrFirst = first + leftCount;
+        right.count = count - leftCount;
+        m_nodes.push_back(left);
+        m_nodes.push_back(right);
+        m_nodes[nodeIndex].leftOrFirst = leftIndex;
+        m_nodes[nodeIndex].count = 0;
+
+        subdivide(leftIndex, depth + 1, centroids);
+        subdivide(leftIndex + 1, depth + 1, centroids);
+    }
+
+    template <bool AnyHit>
+    bool StaticBVH::traverse(const glm::vec3& origin, const glm::vec3& direction, float maxT, StaticBVHHit* hit) const {
+        if (m_nodes.empty()) return false;
+        const glm::vec3 inverse = safeInverse(direction);
+        if (slabEntry(m_nodes[0].minBounds, m_nodes[0].maxBounds, origin, inverse, maxT, nullptr) == kInfinity) {
+            return false;
+        }
+
+        uint32_t stack[kMaxStackDepth];
+        int stackSize = 0;
+        uint32_t nodeIndex = 0;
+        float best = maxT;
+        int bestBox = -1;
+        int bestAxis = -1;
+        while (true) {
+            const Node& node = m_nodes[nodeIndex];
+            if (node.count > 0) {
+                for (uint32_t i = node.leftOrFirst; i < node.leftOrFirst + node.count; ++i) {
+                    uint32_t box = m_order[i];
+                    int axis;
+                    float t = slabEntry(m_boxMin[box], m_boxMax[box], origin, inverse, best, &axis);
+                    if (t == kInfinity) continue;
+                    if (AnyHit) return true;
+                    best = t;
+                    bestBox = static_cast<int>(box);
+                    bestAxis = axis;
+                }
+            } else {
+                uint32_t nearChild = node.leftOrFirst;
+                uint32_t farChild = nearChild + 1;
+                float nearT = slabEntry(m_nodes[nearChild].minBounds, m_nodes[nearChild].maxBounds, origin, inverse, best, nullptr);
+                float farT = slabEntry(m_nodes[farChild].minBounds, m_nodes[farChild].maxBounds, origin, inverse, best, nullptr);
+                if (farT < nearT) {
+                    std::swap(nearChild, farChild);
+                    std::swap(nearT, farT);
+                }
+                if (nearT != kInfinity) {
+                    if (farT != kInfinity) stack[stackSize++] = farChild;
+                    nodeIndex = nearChild;
+                    continue;
+                }
+            }
+
+            // Pop, skipping subtrees that now start beyond the closest hit
+            bool found = false;
+            while (stackSize > 0 && !found) {
+                nodeIndex = stack[--stackSize];
+                found = slabEntry(m_nodes[nodeIndex].minBounds, m_nodes[nodeIndex].maxBounds, origin, inverse, best, nullptr) != kInfinity;
+            }
+            if (!found) break;
+        }
+
+        if (bestBox < 0) return false;
+        hit->distance = best;
+        hit->box = bestBox;
+        hit->normal = glm::vec3(0.0f);
+        if (bestAxis >= 0) {
+            hit->normal[bestAxis] = direction[bestAxis] > 0.0f ? -1.0f : 1.0f;
+        } else {
+            hit->normal = -direction;
+        }
+        return true;
+    }
+
+    bool StaticBVH::raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, StaticBVHHit& hit) const {
+        return traverse<false>(origin, direction, maxDistance, &hit);
+    }
+
+    bool StaticBVH::isOccluded(const glm::vec3& from, const glm::vec3& to) const {
+        // Parametrised over the segment, so t runs from 0 to 1
+        return traverse<true>(from, to - from, 1.0f, nullptr);
+    }
+
+    void StaticBVH::isOccludedBatch(const glm::vec3* from, const glm::vec3* to, size_t count, uint8_t* occluded,
+                                    JobSystem* jobSystem) const {
+        auto testRange = [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                occluded[i] = isOccluded(from[i], to[i]) ? 1 : 0;
+            }
+        };
+        if (jobSystem && jobSystem->getWorkerCount() > 0 && count > kOcclusionGrain) {
+            jobSystem->parallelFor(count, kOcclusionGrain, testRange);
+        } else {
+            testRange(0, count);
+        }
+    }
+}
@@ -0,0 +1,184 @@
+#include "../include/UpdateScheduler.h"
+#include "../include/GameObject.h"
+#include "../include/JobSystem.h"
+#include <algorithm>
+
+namespace Sparky {
+
+    UpdateScheduler::UpdateScheduler() : m_jobSystem(nullptr), m_batchSize(64), m_stats() {
+        // Default access declarations for the built-in phases
+        m_phases[static_cast<size_t>(UpdatePhase::INPUT)] =
+            {"Input", RESOURCE_INPUT, RESOURCE_INPUT | RESOURCE_GAMEPLAY};
+        // AI moves agents directly (flow field steering, character controllers)
+        m_phases[static_cast<size_t>(UpdatePhase::AI)] =
+            {"AI", RESOURCE_TRANSFORM | RESOURCE_GAMEPLAY | RESOURCE_AI,
+             RESOURCE_AI | RESOURCE_PHYSICS | RESOURCE_TRANSFORM};
+        m_phases[static_cast<size_t>(UpdatePhase::ANIMATION)] =
+            {"Animation", RESOURCE_POSE | RESOURCE_GAMEPLAY, RESOURCE_POSE};
+        m_phases[static_cast<size_t>(UpdatePhase::PHYSICS)] =
+            {"Physics", RESOURCE_PHYSICS | RESOURCE_TRANSFORM, RESOURCE_PHYSICS | RESOURCE_TRANSFORM};
+        m_phases[static_cast<size_t>(UpdatePhase::LATE_UPDATE)] =
+            {"LateUpdate", RESOURCE_ALL, RESOURCE_ALL};
+        m_phases[static_cast<size_t>(UpdatePhase::RENDER_PREP)] =
+            {"RenderPrep", RESOURCE_TRANSFORM | RESOURCE_POSE | RESOURCE_RENDER, RESOURCE_RENDER};
+
+        buildWaves();
+    }
+
+    UpdateScheduler::~UpdateScheduler() {
+    }
+
+    void UpdateScheduler::setPhaseAccess(UpdatePhase phase, uint32_t reads, uint32_t writes) {
+        if (phase == UpdatePhase::COUNT) return;
+
+        UpdatePhaseDesc& desc = m_phases[static_cast<size_t>(phase)];
+        desc.reads = reads;
+        desc.writes = writes;
+        buildWaves();
+    }
+
+    const UpdatePhaseDesc& UpdateScheduler::getPhaseDesc(UpdatePhase phase) const {
+        return m_phases[static_cast<size_t>(phase)];
+    }
+
+    void UpdateScheduler::update(const std::vector<std::unique_ptr<GameObject>>& objects, float deltaTime) {
+        m_stats = UpdateSchedulerStats();
+        m_stats.waveCount = m_waves.size();
+
+        for (const auto& wave : m_waves) {
+            // Gathered per wave: an earlier wave (late update, death callbacks)
+            // may have removed components or objects
+            gatherComponents(objects, wave);
+
+            if (wave.size() == 1) {
+                runPhase(wave.front(), objects, deltaTime);
+                continue;
+            }
+
+            // Independent phases overlap; each one still batches internally
+            JobCounter counter;
+            for (UpdatePhase phase : wave) {
+                jobSystem().run([this, phase, &objects, deltaTime]() {
+                    runPhase(phase, objects, deltaTime);
+                }, &counter);
+            }
+            jobSystem().wait(counter);
+        }
+
+        // Each phase wrote only its own counters, so aggregate once everything is done
+        for (const PhaseCounters& counters : m_phaseCounters) {
+            m_stats.parallelComponents += counters.parallelComponents;
+            m_stats.serialComponents += counters.serialComponents;
+            m_stats.batchCount += counters.batchCount;
+        }
+    }
+
+    void UpdateScheduler::buildWaves() {
+        // A phase lands in the wave after the latest earlier phase it conflicts with
+        m_waves.clear();
+        std::array<size_t, static_cast<size_t>(UpdatePhase::COUNT)> waveOf{};
+
+        for (size_t i = 0; i < static_cast<size_t>(UpdatePhase::COUNT); ++i) {
+            size_t wave = 0;
+            for (size_t j = 0; j < i; ++j) {
+                if (phasesConflict(static_cast<UpdatePhase>(j), static_cast<UpdatePhase>(i))) {
+                    wave = std::max(wave, waveOf[j] + 1);
+                }
+            }
+            waveOf[i] = wave;
+
+            if (m_waves.size() <= wave) {
+                m_waves.resize(wave + 1);
+            }
+            m_waves[wave].push_back(static_cast<UpdatePhase>(i));
+        }
+    }
+
+    bool UpdateScheduler::phasesConflict(UpdatePhase a, UpdatePhase b) const {
+        const UpdatePhaseDesc& first = m_phases[static_cast<size_t>(a)];
+        const UpdatePhaseDesc& second = m_phases[static_cast<size_t>(b)];
+
+        return (first.writes & (second.reads | second.writes)) != 0 ||
+               (second.writes & first.reads) != 0;
+    }
+
+    void UpdateScheduler::gatherComponents(const std::vector<std::unique_ptr<GameObject>>& objects,
+                                           const std::vector<UpdatePhase>& wave) {
+        // Buckets keep their capacity between frames to avoid reallocating
+        std::array<bool, static_cast<size_t>(UpdatePhase::COUNT)> inWave{};
+        for (UpdatePhase phase : wave) {
+            inWave[static_cast<size_t>(phase)] = true;
+            for (auto& group : m_buckets[static_cast<size_t>(phase)].groups) {
+                group.components.clear();
+            }
+        }
+
+        for (const auto& object : objects) {
+            if (!object) continue;
+            object->setPhasedUpdate(true);
+
+            for (const auto& component : object->getComponents()) {
+                UpdatePhase phase = component->getUpdatePhase();
+                size_t phaseIndex = static_cast<size_t>(phase);
+                if (phase == UpdatePhase::LATE_UPDATE || phaseIndex >= m_buckets.size() || !inWave[phaseIndex]) {
+                    // Late update goes through GameObject::update so overrides still run;
+                    // other waves gather their own phases when they start
+                    continue;
+                }
+
+                PhaseBucket& bucket = m_buckets[phaseIndex];
+                std::type_index type(typeid(*component));
+                auto it = bucket.groupLookup.find(type);
+                if (it == bucket.groupLookup.end()) {
+                    it = bucket.groupLookup.emplace(type, bucket.groups.size()).first;
+                    bucket.groups.push_back({type, component->supportsParallelUpdate(), {}});
+                }
+                bucket.groups[it->second].components.push_back(component.get());
+            }
+        }
+    }
+
+    void UpdateScheduler::runPhase(UpdatePhase phase, const std::vector<std::unique_ptr<GameObject>>& objects, float deltaTime) {
+        size_t phaseIndex = static_cast<size_t>(phase);
+        PhaseCounters& counters = m_phaseCounters[phaseIndex];
+        counters = PhaseCounters();
+
+        if (phase == UpdatePhase::LATE_UPDATE) {
+            for (const auto& object : objects) {
+                if (object) {
+                    object->update(deltaTime);
+                }
+            }
+            m_stats.componentsPerPhase[phaseIndex] = objects.size();
+            return;
+        }
+
+        size_t componentCount = 0;
+        for (TypeGroup& group : m_buckets[phaseIndex].groups) {
+            std::vector<Component*>& components = group.components;
+            componentCount += components.size();
+            if (components.empty()) continue;
+
+            if (!group.parallel) {
+                for (Component* component : components) {
+                    component->update(deltaTime);
+                }
+                counters.serialComponents += components.size();
+                continue;
+            }
+
+            jobSystem().parallelFor(components.size(), m_batchSize, [&components, deltaTime](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    components[i]->update(deltaTime);
+                }
+            });
+            counters.parallelComponents += components.size();
+            counters.batchCount += (components.size() + m_batchSize - 1) / m_batchSize;
+        }
+        m_stats.componentsPerPhase[phaseIndex] = componentCount;
+    }
+
+    JobSystem& UpdateScheduler::jobSystem() {
+        return m_jobSystem ? *m_jobSystem : JobSystem::getInstance();
+    }
+}
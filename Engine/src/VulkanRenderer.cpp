@@ -98,7 +98,7 @@ namespace Sparky {
     VulkanRenderer::VulkanRenderer() : instance(nullptr), physicalDevice(nullptr), device(nullptr), 
                                        graphicsQueue(nullptr), presentQueue(nullptr), surface(nullptr), 
                                        swapChain(nullptr), renderPass(nullptr), pipelineLayout(nullptr), 
-                                       graphicsPipeline(nullptr), commandPool(nullptr), windowHandle(nullptr),
+                                       graphicsPipeline(nullptr), instancedPipeline(nullptr), commandPool(nullptr), windowHandle(nullptr),
                                        currentFrame(0), imageAvailableSemaphore(nullptr), renderFinishedSemaphore(nullptr),
                                        inFlightFence(nullptr), descriptorSetLayout(nullptr), depthImage(nullptr),
                                        depthImageMemory(nullptr), depthImageView(nullptr), debugMessenger(nullptr),
@@ -171,6 +171,7 @@ namespace Sparky {
         cleanupSwapChain();
         
         cleanupUniformBuffers();
+        cleanupInstanceBuffers();
         
         // Cleanup material descriptor pool
         if (materialDescriptorPool) {
@@ -235,6 +236,11 @@ namespace Sparky {
             vkDestroyPipeline(device, graphicsPipeline, nullptr);
         }
         
+        if (instancedPipeline) {
+            vkDestroyPipeline(device, instancedPipeline, nullptr);
+            instancedPipeline = nullptr;
+        }
+        
         if (pipelineLayout) {
             vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
         }
@@ -1138,6 +1144,53 @@ namespace Sparky {
         }
         SPARKY_LOG_INFO("Graphics pipeline creation succeeded");
 
+        // Instanced variant of the same pipeline, taking the model matrix per instance from vertex binding 1
+        // instead of a push constant. Without its compiled shader objects are drawn one at a time.
+        instancedPipeline = nullptr;
+        std::string instancedVertPath = loadVertPath.substr(0, loadVertPath.size() - std::string(".vert.spv").size()) + "_instanced.vert.spv";
+        if (Sparky::FileUtils::fileExists(instancedVertPath)) {
+            try {
+                std::vector<uint32_t> instancedVertCode = ShaderCompiler::loadSPIRVFromFile(instancedVertPath);
+                VkShaderModule instancedVertModule = createShaderModule(instancedVertCode);
+                
+                VkPipelineShaderStageCreateInfo instancedStages[] = {vertShaderStageInfo, fragShaderStageInfo};
+                instancedStages[0].module = instancedVertModule;
+                
+                auto instanceBinding = InstanceData::getBindingDescription();
+                auto instanceAttributes = InstanceData::getAttributeDescriptions();
+                VkVertexInputBindingDescription instancedBindings[] = {bindingDescription, instanceBinding};
+                std::vector<VkVertexInputAttributeDescription> instancedAttributes = attributeDescriptions;
+                instancedAttributes.insert(instancedAttributes.end(), instanceAttributes.begin(), instanceAttributes.end());
+                
+                VkPipelineVertexInputStateCreateInfo instancedVertexInput = vertexInputInfo;
+                instancedVertexInput.vertexBindingDescriptionCount = 2;
+                instancedVertexInput.pVertexBindingDescriptions = instancedBindings;
+                instancedVertexInput.vertexAttributeDescriptionCount = static_cast<uint32_t>(instancedAttributes.size());
+                instancedVertexInput.pVertexAttributeDescriptions = instancedAttributes.data();
+                
+                // The fallbacks above only change state to the same values, so the first configuration is reused
+                VkGraphicsPipelineCreateInfo instancedPipelineInfo = pipelineInfo;
+                instancedPipelineInfo.pStages = instancedStages;
+                instancedPipelineInfo.pVertexInputState = &instancedVertexInput;
+                instancedPipelineInfo.pColorBlendState = &colorBlending;
+                
+                result = vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &instancedPipelineInfo, nullptr, &instancedPipeline);
+                if (result != VK_SUCCESS) {
+                    SPARKY_LOG_WARNING("Failed to create instanced pipeline, drawing without instancing. Result code: " + std::to_string(result));
+                    instancedPipeline = nullptr;
+                } else {
+                    SPARKY_LOG_INFO("Instanced pipeline created from: " + instancedVertPath);
+                }
+                
+                vkDestroyShaderModule(device, instancedVertModule, nullptr);
+            } catch (const std::exception& e) {
+                SPARKY_LOG_WARNING("Failed to load instanced vertex shader: " + instancedVertPath + ". Error: " + std::string(e.what()));
+                instancedPipeline = nullptr;
+            }
+        } else {
+            SPARKY_LOG_WARNING("No instanced vertex shader at " + instancedVertPath + " (built by the SparkyShaders target when glslc is found), drawing without instancing");
+        }
+
         // Cleanup
         vkDestroyShaderModule(device, fragShaderModule, nullptr);
         vkDestroyShaderModule(device, vertShaderModule, nullptr);
@@ -1551,10 +1604,6 @@ namespace Sparky {
         
         SPARKY_LOG_DEBUG("Render pass begun");
         
-        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
-        
-        SPARKY_LOG_DEBUG("Pipeline bound");
-        
         // Set Viewport
         VkViewport viewport{};
         viewport.x = 0.0f;
@@ -1585,87 +1634,125 @@ namespace Sparky {
         if (engine) {
             RenderSystem& renderSystem = engine->getRenderSystem();
             
-            // Render all registered game objects
-            const auto& gameObjects = renderSystem.getGameObjects();
+            // Cull against the camera, then draw what it sees in render queue order
+            Camera& camera = engine->getCamera();
+            renderSystem.cull(camera.GetProjectionMatrix(swapChainExtent.width / (float) swapChainExtent.height) * camera.GetViewMatrix());
+            renderSystem.buildRenderQueue(camera.getPosition(), camera.getFront(), 1000.0f);
+            const RenderQueue& renderQueue = renderSystem.getRenderQueue();
             
             // Debug: Log the number of objects to render
             static int frameCount = 0;
             frameCount++;
             if (frameCount % 60 == 0) { // Log every 60 frames
-                SPARKY_LOG_DEBUG("VulkanRenderer attempting to render " + std::to_string(gameObjects.size()) + " game objects");
+                SPARKY_LOG_DEBUG("VulkanRenderer attempting to render " + std::to_string(renderQueue.getDraws().size()) + " of " +
+                                 std::to_string(renderSystem.getGameObjects().size()) + " game objects after culling");
             }
             
+            // With the instanced pipeline every object's transform goes into this image's instance buffer in
+            // draw order, so each batch is one draw whose first instance is its first draw
+            const std::vector<RenderDraw>& draws = renderQueue.getDraws();
+            bool instanced = instancedPipeline != VK_NULL_HANDLE && !draws.empty();
+            if (instanced) {
+                ensureInstanceBuffer(imageIndex, draws.size());
+                InstanceData* instances = static_cast<InstanceData*>(instanceBuffersMapped[imageIndex]);
+                for (size_t i = 0; i < draws.size(); i++) {
+                    instances[i].model = draws[i].item.object->getTransformMatrix();
+                }
+                
+                VkBuffer frameInstanceBuffers[] = {instanceBuffers[imageIndex]};
+                VkDeviceSize offsets[] = {0};
+                vkCmdBindVertexBuffers(commandBuffer, 1, 1, frameInstanceBuffers, offsets);
+            }
+            
+            // The queue marks the binds each batch needs; buffers are looked up only when the mesh changes
             int objectsRendered = 0;
-            for (GameObject* gameObject : gameObjects) {
-                if (gameObject) {
-                    RenderComponent* renderComponent = gameObject->getComponent<RenderComponent>();
-                    if (renderComponent && renderComponent->getMesh()) {
-                        const Mesh* mesh = renderComponent->getMesh();
-                        
-                        // Debug: Log mesh info
-                        if (frameCount % 60 == 0) {
-                            SPARKY_LOG_DEBUG("VulkanRenderer rendering object: " + gameObject->getName() + 
-                                           ", Vertices: " + std::to_string(mesh->getVertices().size()) + 
-                                           ", Indices: " + std::to_string(mesh->getIndices().size()));
-                        }
-                        
-                        // Create and pass Push Constant for this object's model matrix
-                        PushConstantData pushData;
-                        pushData.model = gameObject->getTransformMatrix(); // Get the object's transform matrix
-
-                        vkCmdPushConstants(
-                            commandBuffer,
-                            pipelineLayout,
-                            VK_SHADER_STAGE_VERTEX_BIT,
-                            0,
-                            sizeof(PushConstantData),
-                            &pushData
-                        );
-                        
-                        // Get the vertex and index buffers from the mesh renderer for this specific mesh
-                        VkBuffer vertexBuffer = meshRenderer.getVertexBuffer(*mesh);
-                        VkBuffer indexBuffer = meshRenderer.getIndexBuffer(*mesh);
+            int drawCalls = 0;
+            VkBuffer vertexBuffer = VK_NULL_HANDLE;
+            VkBuffer indexBuffer = VK_NULL_HANDLE;
+            for (const RenderBatch& batch : renderQueue.getBatches()) {
+                const RenderDraw& first = draws[batch.firstDraw];
+                const Mesh* mesh = first.item.mesh;
+                
+                if (first.changes & RENDER_CHANGE_PIPELINE) {
+                    // Every item uses pipeline 0, the one graphics pipeline or its instanced variant
+                    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, instanced ? instancedPipeline : graphicsPipeline);
+                }
+                
+                if ((first.changes & RENDER_CHANGE_MATERIAL) && first.item.material &&
+                    first.item.material->descriptorSets.size() > imageIndex) {
+                    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 1, 1,
+                                            &first.item.material->descriptorSets[imageIndex], 0, nullptr);
+                }
+                
+                if (first.changes & RENDER_CHANGE_MESH) {
+                    vertexBuffer = meshRenderer.getVertexBuffer(*mesh);
+                    indexBuffer = meshRenderer.getIndexBuffer(*mesh);
+                    
+                    if (vertexBuffer != VK_NULL_HANDLE) {
+                        VkBuffer vertexBuffers[] = {vertexBuffer};
+                        VkDeviceSize offsets[] = {0};
+                        vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
                         
-                        // Debug: Log buffer handles
-                        if (frameCount % 60 == 0) {
-                            SPARKY_LOG_DEBUG("Buffer handles - Vertex: " + std::to_string(reinterpret_cast<uint64_t>(vertexBuffer)) + 
-                                           ", Index: " + std::to_string(reinterpret_cast<uint64_t>(indexBuffer)));
+                        if (indexBuffer != VK_NULL_HANDLE && mesh->getIndices().size() > 0) {
+                            vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
                         }
-                        
-                        if (vertexBuffer != VK_NULL_HANDLE) {
-                            // Bind vertex buffer
-                            VkBuffer vertexBuffers[] = {vertexBuffer};
-                            VkDeviceSize offsets[] = {0};
-                            vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+                    } else if (frameCount % 60 == 0) {
+                        SPARKY_LOG_DEBUG("Skipping " + first.item.object->getName() + " - vertex buffer is null");
+                    }
+                }
+                
+                if (vertexBuffer == VK_NULL_HANDLE) {
+                    continue;
+                }
+                
+                bool indexed = indexBuffer != VK_NULL_HANDLE && mesh->getIndices().size() > 0;
+                if (!indexed && mesh->getVertices().size() == 0) {
+                    continue;
+                }
+                
+                if (instanced) {
+                    if (indexed) {
+                        vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(mesh->getIndices().size()), batch.drawCount, 0, 0, batch.firstDraw);
+                    } else {
+                        vkCmdDraw(commandBuffer, static_cast<uint32_t>(mesh->getVertices().size()), batch.drawCount, 0, batch.firstDraw);
+                    }
+                    objectsRendered += batch.drawCount;
+                    drawCalls++;
+                    continue;
+                }
+                
+                for (uint32_t i = batch.firstDraw; i < batch.firstDraw + batch.drawCount; i++) {
+                    // Create and pass Push Constant for this object's model matrix
+                    PushConstantData pushData;
+                    pushData.model = draws[i].item.object->getTransformMatrix();
+                    vkCmdPushConstants(
+                        commandBuffer,
+                        pipelineLayout,
+                        VK_SHADER_STAGE_VERTEX_BIT,
+                        0,
+                        sizeof(PushConstantData),
+                        &pushData
+                    );
                     
-                            // Bind index buffer if it exists
-                            if (indexBuffer != VK_NULL_HANDLE && mesh->getIndices().size() > 0) {
-                                vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
-                                vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(mesh->getIndices().size()), 1, 0, 0, 0);
-                                objectsRendered++;
-                                if (frameCount % 60 == 0) {
-                                    SPARKY_LOG_DEBUG("DrawIndexed called for " + gameObject->getName());
-                                }
-                            } else if (mesh->getVertices().size() > 0) {
-                                // Draw without index buffer
-                                vkCmdDraw(commandBuffer, static_cast<uint32_t>(mesh->getVertices().size()), 1, 0, 0);
-                                objectsRendered++;
-                                if (frameCount % 60 == 0) {
-                                    SPARKY_LOG_DEBUG("Draw called for " + gameObject->getName());
-                                }
-                            }
-                        } else {
-                            if (frameCount % 60 == 0) {
-                                SPARKY_LOG_DEBUG("Skipping " + gameObject->getName() + " - vertex buffer is null");
-                            }
-                        }
+                    if (indexed) {
+                        vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(mesh->getIndices().size()), 1, 0, 0, 0);
+                    } else {
+                        // Draw without index buffer
+                        vkCmdDraw(commandBuffer, static_cast<uint32_t>(mesh->getVertices().size()), 1, 0, 0);
                     }
+                    objectsRendered++;
+                    drawCalls++;
                 }
             }
             
             // Debug: Log how many objects were actually rendered
             if (frameCount % 60 == 0) {
-                SPARKY_LOG_DEBUG("VulkanRenderer successfully rendered " + std::to_string(objectsRendered) + " objects");
+                const RenderQueueStats& stats = renderQueue.getStats();
+                SPARKY_LOG_DEBUG("VulkanRenderer successfully rendered " + std::to_string(objectsRendered) + " objects in " +
+                                 std::to_string(drawCalls) + " draw calls" + (instanced ? " (" + std::to_string(stats.collapsedDraws) +
+                                 " collapsed by instancing)" : std::string()) + " with " + std::to_string(stats.getBinds()) +
+                                 " binds (" + std::to_string(stats.unsortedBinds) + " unsorted), " +
+                                 std::to_string(stats.stateChanges) + " state changes");
             }
         } else {
             SPARKY_LOG_DEBUG("VulkanRenderer has no engine reference");
@@ -1736,6 +1823,78 @@ namespace Sparky {
         SPARKY_LOG_INFO("Uniform buffers cleaned up");
     }
     
+    VkVertexInputBindingDescription InstanceData::getBindingDescription() {
+        VkVertexInputBindingDescription bindingDescription{};
+        bindingDescription.binding = 1;
+        bindingDescription.stride = sizeof(InstanceData);
+        bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+        return bindingDescription;
+    }
+    
+    std::vector<VkVertexInputAttributeDescription> InstanceData::getAttributeDescriptions() {
+        // A mat4 takes one location per column, after the five Vertex attributes
+        std::vector<VkVertexInputAttributeDescription> attributeDescriptions(4);
+        for (uint32_t column = 0; column < 4; column++) {
+            attributeDescriptions[column].binding = 1;
+            attributeDescriptions[column].location = 5 + column;
+            attributeDescriptions[column].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+            attributeDescriptions[column].offset = offsetof(InstanceData, model) + sizeof(glm::vec4) * column;
+        }
+        return attributeDescriptions;
+    }
+    
+    void VulkanRenderer::ensureInstanceBuffer(uint32_t imageIndex, size_t instanceCount) {
+        if (instanceBuffers.size() <= imageIndex) {
+            instanceBuffers.resize(imageIndex + 1, nullptr);
+            instanceBuffersMemory.resize(imageIndex + 1, nullptr);
+            instanceBuffersMapped.resize(imageIndex + 1, nullptr);
+            instanceBufferCapacities.resize(imageIndex + 1, 0);
+        }
+        if (instanceBufferCapacities[imageIndex] >= instanceCount) {
+            return;
+        }
+        
+        // The fence wait in render() means this image's last command buffer has finished with the old buffer
+        if (instanceBuffersMemory[imageIndex]) {
+            vkUnmapMemory(device, instanceBuffersMemory[imageIndex]);
+            vkFreeMemory(device, instanceBuffersMemory[imageIndex], nullptr);
+        }
+        if (instanceBuffers[imageIndex]) {
+            vkDestroyBuffer(device, instanceBuffers[imageIndex], nullptr);
+        }
+        
+        size_t capacity = std::max<size_t>(instanceBufferCapacities[imageIndex], 256);
+        while (capacity < instanceCount) {
+            capacity *= 2;
+        }
+        VkDeviceSize bufferSize = sizeof(InstanceData) * capacity;
+        createBuffer(bufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                    instanceBuffers[imageIndex], instanceBuffersMemory[imageIndex]);
+        vkMapMemory(device, instanceBuffersMemory[imageIndex], 0, bufferSize, 0, &instanceBuffersMapped[imageIndex]);
+        instanceBufferCapacities[imageIndex] = capacity;
+        
+        SPARKY_LOG_DEBUG("Instance buffer " + std::to_string(imageIndex) + " grown to " + std::to_string(capacity) + " instances");
+    }
+    
+    void VulkanRenderer::cleanupInstanceBuffers() {
+        for (size_t i = 0; i < instanceBuffers.size(); i++) {
+            if (instanceBuffersMemory[i]) {
+                vkUnmapMemory(device, instanceBuffersMemory[i]);
+                vkFreeMemory(device, instanceBuffersMemory[i], nullptr);
+            }
+            
+            if (instanceBuffers[i]) {
+                vkDestroyBuffer(device, instanceBuffers[i], nullptr);
+            }
+        }
+        
+        instanceBuffers.clear();
+        instanceBuffersMemory.clear();
+        instanceBuffersMapped.clear();
+        instanceBufferCapacities.clear();
+    }
+    
     void VulkanRenderer::updateUniformBuffer(uint32_t currentImage) {
         if (!engine) return; // Check that we have a reference to the engine
 
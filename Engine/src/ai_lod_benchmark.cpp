@@ -0,0 +1,255 @@
+#include "../include/AILODScheduler.h"
+#include "../include/TimingUtils.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace Sparky;
+
+// 10000 agents spread over a 1 km square around the viewer, each costing a
+// few microseconds per update. Checks the level rules, that every level
+// keeps its interval and agents receive all elapsed time, that updates
+// spread evenly over frames, that a budget below the frame's work defers
+// agents without starving anyone, and that callbacks can remove agents,
+// deferred ones included. Then compares frame times with every agent
+// updating every frame.
+
+namespace {
+    const int kAgentCount = 10000;
+    const float kArea = 1000.0f;
+    const float kTimeStep = 1.0f / 60.0f;
+    const int kFrames = 120;
+
+    // Stand-in for perception, steering and decisions
+    float think(float seed) {
+        float value = seed;
+        for (int i = 0; i < 96; ++i) {
+            value = std::sin(value) * 1.0001f + 0.5f;
+        }
+        return value;
+    }
+
+    struct Agent {
+        glm::vec3 position;
+        bool inCombat;
+        int updates;
+        float receivedTime;
+        int lastFrame;
+        int longestWait;    // Frames between updates
+        float state;
+    };
+
+    std::vector<Agent> makeAgents(std::mt19937& rng) {
+        std::uniform_real_distribution<float> coordinate(-kArea * 0.5f, kArea * 0.5f);
+        std::vector<Agent> agents(kAgentCount);
+        for (int i = 0; i < kAgentCount; ++i) {
+            agents[i] = {glm::vec3(coordinate(rng), 0.0f, coordinate(rng)), i % 50 == 0, 0, 0.0f, 0, 0, 1.0f};
+        }
+        return agents;
+    }
+
+    void addAgents(AILODScheduler& scheduler, std::vector<Agent>& agents, const int& frame) {
+        for (Agent& agent : agents) {
+            Agent* self = &agent;
+            AILODAgentId id = scheduler.addAgent(agent.position, [self, &frame](float deltaTime, AILODLevel) {
+                ++self->updates;
+                self->receivedTime += deltaTime;
+                self->longestWait = std::max(self->longestWait, frame - self->lastFrame);
+                self->lastFrame = frame;
+                self->state = think(self->state + deltaTime);
+            });
+            scheduler.setAgentState(id, agent.position, agent.inCombat);
+        }
+    }
+
+    void setViewer(AILODScheduler& scheduler) {
+        scheduler.setViewer(glm::vec3(0.0f), glm::vec3(1.0f, 0.0f, 0.0f), 90.0f);
+    }
+
+    bool checkLevels() {
+        AILODScheduler scheduler;
+        setViewer(scheduler);
+        auto none = [](float, AILODLevel) {};
+        AILODAgentId near = scheduler.addAgent(glm::vec3(10.0f, 0.0f, 0.0f), none);
+        AILODAgentId middleBehind = scheduler.addAgent(glm::vec3(-50.0f, 0.0f, 0.0f), none);
+        AILODAgentId farAhead = scheduler.addAgent(glm::vec3(300.0f, 0.0f, 10.0f), none);
+        AILODAgentId farBehind = scheduler.addAgent(glm::vec3(-300.0f, 0.0f, 0.0f), none);
+        AILODAgentId fighting = scheduler.addAgent(glm::vec3(-300.0f, 0.0f, 0.0f), none);
+        scheduler.setAgentState(fighting, glm::vec3(-300.0f, 0.0f, 0.0f), true);
+        scheduler.update(kTimeStep);
+        bool levels = scheduler.getAgentLevel(near) == AILODLevel::FULL &&
+                      scheduler.getAgentLevel(middleBehind) == AILODLevel::REDUCED &&
+                      scheduler.getAgentLevel(farAhead) == AILODLevel::REDUCED &&
+                      scheduler.getAgentLevel(farBehind) == AILODLevel::LOW &&
+                      scheduler.getAgentLevel(fighting) == AILODLevel::FULL;
+
+        // Stepping just past the threshold keeps the finer level; well past it drops
+        scheduler.setAgentState(near, glm::vec3(26.0f, 0.0f, 0.0f), false);
+        scheduler.update(kTimeStep);
+        bool kept = scheduler.getAgentLevel(near) == AILODLevel::FULL;
+        scheduler.setAgentState(near, glm::vec3(-30.0f, 0.0f, 0.0f), false);
+        scheduler.update(kTimeStep);
+        return levels && kept && scheduler.getAgentLevel(near) == AILODLevel::REDUCED;
+    }
+
+    // A budget so small that one agent runs per frame, with a callback that removes a deferred agent and itself
+    bool checkRemovalDuringUpdate() {
+        AILODSettings settings;
+        settings.frameBudgetMs = 1e-6;
+        AILODScheduler scheduler(settings);
+        setViewer(scheduler);
+
+        const int agentCount = 8;
+        std::vector<int> updates(agentCount + 1, 0);
+        std::vector<AILODAgentId> ids;
+        for (int i = 0; i < agentCount; ++i) {
+            ids.push_back(scheduler.addAgent(glm::vec3(0.0f), [&updates, i](float, AILODLevel) {
+                ++updates[i];
+                think(static_cast<float>(i));
+            }));
+        }
+        AILODAgentId remover = ids[1];
+        AILODAgentId victim = ids[5];
+        scheduler.removeAgent(remover);
+        remover = scheduler.addAgent(glm::vec3(0.0f), [&](float, AILODLevel) {
+            ++updates[1];
+            scheduler.removeAgent(victim);
+            scheduler.removeAgent(remover);
+        });
+
+        // Frame 1 runs one agent and carries the rest; frame 2 runs the remover first
+        bool correct = true;
+        for (int frame = 0; frame < 2; ++frame) {
+            scheduler.update(kTimeStep);
+            const AILODStats& stats = scheduler.getStats();
+            correct = correct && stats.agentsUpdated == 1 && stats.agentsDeferred > 0;
+        }
+        correct = correct && updates[1] == 1 && updates[5] == 0 && scheduler.getAgentCount() == agentCount - 2;
+
+        // The freed slots are reused and every remaining agent still gets its turn
+        AILODAgentId added = scheduler.addAgent(glm::vec3(0.0f), [&updates, agentCount](float, AILODLevel) {
+            ++updates[agentCount];
+        });
+        for (int frame = 0; frame < 4 * agentCount; ++frame) {
+            scheduler.update(kTimeStep);
+            const AILODStats& stats = scheduler.getStats();
+            correct = correct && stats.agentsUpdated + stats.agentsDeferred == stats.agentsDue;
+        }
+        correct = correct && (added == victim || added == remover) && updates[1] == 1 && updates[5] == 0;
+        for (int i = 0; i <= agentCount; ++i) {
+            if (i != 1 && i != 5) correct = correct && updates[i] > 0;
+        }
+        return correct;
+    }
+}
+
+int main() {
+    std::cout << "AI LOD Benchmark" << std::endl;
+    std::mt19937 rng(21);
+    bool allCorrect = true;
+
+    bool levels = checkLevels();
+    std::cout << "Levels follow distance, view and combat with hysteresis: " << (levels ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && levels;
+
+    bool removal = checkRemovalDuringUpdate();
+    std::cout << "Callbacks remove deferred agents and themselves: " << (removal ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && removal;
+
+    // Unlimited budget: exact intervals, all time delivered, even frames
+    int frame = 0;
+    AILODSettings unlimited;
+    unlimited.frameBudgetMs = 0.0;
+    AILODScheduler scheduler(unlimited);
+    setViewer(scheduler);
+    std::vector<Agent> agents = makeAgents(rng);
+    addAgents(scheduler, agents, frame);
+    double lodMs = 0.0, lodPeakMs = 0.0;
+    int minUpdated = kAgentCount, maxUpdated = 0;
+    for (frame = 1; frame <= kFrames; ++frame) {
+        auto start = std::chrono::steady_clock::now();
+        scheduler.update(kTimeStep);
+        double ms = elapsedMs(start);
+        lodMs += ms;
+        lodPeakMs = std::max(lodPeakMs, ms);
+        minUpdated = std::min(minUpdated, scheduler.getStats().agentsUpdated);
+        maxUpdated = std::max(maxUpdated, scheduler.getStats().agentsUpdated);
+    }
+    const AILODStats& stats = scheduler.getStats();
+
+    bool intervals = true;
+    bool timeDelivered = true;
+    for (int i = 0; i < kAgentCount; ++i) {
+        int interval = scheduler.getInterval(scheduler.getAgentLevel(i));
+        intervals = intervals && agents[i].updates == kFrames / interval;
+        float total = kFrames * kTimeStep;
+        timeDelivered = timeDelivered && agents[i].receivedTime <= total + 1e-3f &&
+                        agents[i].receivedTime > total - interval * kTimeStep - 1e-3f;
+    }
+    std::cout << "Each level updates at its interval: " << (intervals ? "ok" : "FAILED") << std::endl;
+    std::cout << "Agents receive all elapsed time: " << (timeDelivered ? "ok" : "FAILED") << std::endl;
+    // Agents leaving a level free their phase without rebalancing the others, so allow a little slack
+    bool even = maxUpdated - minUpdated <= (maxUpdated + minUpdated) / 2 / 30;
+    std::cout << "Updates spread evenly over frames (" << minUpdated << "-" << maxUpdated << " per frame): "
+              << (even ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && intervals && timeDelivered && even;
+
+    // Every agent every frame, as without the scheduler
+    std::vector<Agent> everyFrame = makeAgents(rng);
+    double fullMs = 0.0;
+    for (int f = 0; f < kFrames; ++f) {
+        auto start = std::chrono::steady_clock::now();
+        for (Agent& agent : everyFrame) {
+            agent.state = think(agent.state + kTimeStep);
+        }
+        fullMs += elapsedMs(start);
+    }
+
+    // Budget too small for the due agents: due agents are either run or carried over, nobody starves, time is
+    // kept. Frame times depend on the machine's load, so they are reported rather than checked.
+    AILODSettings tight;
+    tight.frameBudgetMs = 1.0;
+    AILODScheduler budgeted(tight);
+    setViewer(budgeted);
+    std::vector<Agent> budgetAgents = makeAgents(rng);
+    frame = 0;
+    addAgents(budgeted, budgetAgents, frame);
+    double budgetMs = 0.0, budgetPeakMs = 0.0;
+    int maxDeferred = 0;
+    bool accounted = true;
+    for (frame = 1; frame <= kFrames; ++frame) {
+        budgeted.update(kTimeStep);
+        const AILODStats& budgetStats = budgeted.getStats();
+        budgetMs += budgetStats.updateMs;
+        budgetPeakMs = std::max(budgetPeakMs, budgetStats.updateMs);
+        maxDeferred = std::max(maxDeferred, budgetStats.agentsDeferred);
+        accounted = accounted && budgetStats.agentsUpdated + budgetStats.agentsDeferred == budgetStats.agentsDue &&
+                    (budgetStats.agentsDue == 0 || budgetStats.agentsUpdated > 0);
+    }
+    budgetMs /= kFrames;
+    bool noStarvation = true;
+    bool budgetTime = true;
+    int longestWait = 0;
+    for (const Agent& agent : budgetAgents) {
+        noStarvation = noStarvation && agent.updates > 0;
+        longestWait = std::max(longestWait, agent.longestWait);
+        budgetTime = budgetTime && agent.receivedTime <= kFrames * kTimeStep + 1e-3f;
+    }
+    std::cout << "Due agents run or carried over (up to " << maxDeferred << " deferred): " << (accounted ? "ok" : "FAILED")
+              << std::endl;
+    std::cout << "Deferred agents catch up (longest wait " << longestWait << " frames): "
+              << (noStarvation && budgetTime ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && accounted && noStarvation && budgetTime;
+
+    std::cout << kAgentCount << " agents: " << stats.levelCounts[0] << " FULL, " << stats.levelCounts[1] << " REDUCED, "
+              << stats.levelCounts[2] << " LOW" << std::endl;
+    std::cout << "Per frame: every agent " << fullMs / kFrames << " ms; LOD " << lodMs / kFrames << " ms (peak "
+              << lodPeakMs << " ms); " << tight.frameBudgetMs << " ms budget " << budgetMs << " ms (peak " << budgetPeakMs
+              << " ms)" << std::endl;
+
+    std::cout << (allCorrect ? "AI LOD benchmark passed!" : "AI LOD benchmark FAILED!") << std::endl;
+    return allCorrect ? 0 : 1;
+}
@@ -0,0 +1,189 @@
+#include "../include/AnimationCompression.h"
+#include "../include/AdvancedAnimationSystem.h"
+#include "../include/TimingUtils.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace Sparky;
+
+// A 60-bone skeleton (spine, head and nine six-bone limb and finger chains)
+// with mocap-like 1000-key clips: the root walks and bobs, bones keep their
+// length, joints rotate on smooth curves and a quarter of them barely move.
+// Checks that compression shrinks the clips at least 5x, that every bone
+// stays within the rotation tolerance plus quantization, that the
+// model-space error at the end of every chain stays under a millimetre, and
+// that keys and segments are actually dropped and used. Then compares
+// sampling speed with the uncompressed cursor sampler.
+
+namespace {
+    const int kBoneCount = 60;
+    const int kKeyCount = 1000;
+    const int kClipCount = 4;
+    const int kCharacterCount = 100;
+    const float kKeyInterval = 1.0f / 30.0f;
+    const float kBoneLength = 0.1f;
+    const float kPi = 3.14159265f;
+    const int kFrames = 120;
+
+    std::vector<int> makeParents() {
+        std::vector<int> parents(kBoneCount, -1);
+        for (int bone = 1; bone <= 5; ++bone) {
+            parents[bone] = bone - 1;           // Spine and head
+        }
+        const int chainRoots[9] = {4, 4, 0, 0, 5, 3, 3, 1, 1};
+        for (int chain = 0; chain < 9; ++chain) {
+            int first = 6 + chain * 6;
+            parents[first] = chainRoots[chain];
+            for (int bone = first + 1; bone < first + 6; ++bone) {
+                parents[bone] = bone - 1;
+            }
+        }
+        return parents;
+    }
+
+    struct Motion {
+        glm::vec3 axis;
+        float amplitude;
+        float frequency;
+        float phase;
+    };
+
+    std::unique_ptr<AnimationClip> makeClip(int index, std::mt19937& rng) {
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        std::uniform_real_distribution<float> amplitude(0.05f, 0.6f);
+        std::uniform_real_distribution<float> frequency(0.2f, 1.2f);
+        std::vector<Motion> motions(kBoneCount * 2);
+        for (int i = 0; i < kBoneCount * 2; ++i) {
+            bool still = (i / 2) % 4 == 3;
+            motions[i] = {glm::normalize(glm::vec3(unit(rng), unit(rng), unit(rng))), still ? 0.0f : amplitude(rng) / (1 + i % 2),
+                          frequency(rng) * (1 + i % 2), unit(rng) * kPi};
+        }
+
+        std::unique_ptr<AnimationClip> clip(new AnimationClip("mocap" + std::to_string(index)));
+        for (int bone = 0; bone < kBoneCount; ++bone) {
+            for (int key = 0; key < kKeyCount; ++key) {
+                float time = key * kKeyInterval;
+                glm::quat rotation;
+                for (int harmonic = 0; harmonic < 2; ++harmonic) {
+                    const Motion& motion = motions[bone * 2 + harmonic];
+                    float angle = motion.amplitude * std::sin(2.0f * kPi * motion.frequency * time + motion.phase);
+                    rotation = rotation * glm::angleAxis(angle, motion.axis);
+                }
+                glm::vec3 position = bone == 0 ? glm::vec3(0.0f, 1.0f + 0.03f * std::sin(4.0f * kPi * time), 1.4f * time)
+                                               : glm::vec3(0.0f, kBoneLength, 0.0f);
+                Keyframe keyframe;
+                keyframe.time = time;
+                keyframe.position[0] = position.x;
+                keyframe.position[1] = position.y;
+                keyframe.position[2] = position.z;
+                keyframe.rotation[0] = rotation.x;
+                keyframe.rotation[1] = rotation.y;
+                keyframe.rotation[2] = rotation.z;
+                keyframe.rotation[3] = rotation.w;
+                keyframe.scale[0] = keyframe.scale[1] = keyframe.scale[2] = 1.0f;
+                clip->addKeyframe(bone, keyframe);
+            }
+        }
+        return clip;
+    }
+}
+
+int main() {
+    std::cout << "Animation Compression Benchmark" << std::endl;
+    std::mt19937 rng(42);
+    bool allCorrect = true;
+
+    std::vector<int> parents = makeParents();
+    std::vector<std::unique_ptr<AnimationClip>> clips;
+    for (int i = 0; i < kClipCount; ++i) {
+        clips.push_back(makeClip(i, rng));
+    }
+
+    std::unique_ptr<AnimationCompressor> compressor = AnimationCompressor::create();
+    const AnimationCompressionSettings& settings = compressor->getSettings();
+    std::vector<std::unique_ptr<CompressedAnimationClip>> compressed;
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& clip : clips) {
+        compressed.push_back(compressor->compress(*clip));
+    }
+    double compressMs = elapsedMs(start);
+
+    size_t originalBytes = 0, compressedBytes = 0;
+    int originalKeys = 0, storedKeys = 0;
+    float maxModelError = 0.0f, maxRotationError = 0.0f, maxTranslationError = 0.0f;
+    AnimationCompressionReport firstReport;
+    for (int i = 0; i < kClipCount; ++i) {
+        AnimationCompressionReport report = compressor->measureError(*clips[i], *compressed[i], parents);
+        originalBytes += report.originalBytes;
+        compressedBytes += report.compressedBytes;
+        originalKeys += report.originalKeys;
+        storedKeys += report.storedKeys;
+        maxModelError = std::max(maxModelError, report.maxModelError);
+        for (const AnimationBoneError& error : report.bones) {
+            maxRotationError = std::max(maxRotationError, error.rotationError);
+            maxTranslationError = std::max(maxTranslationError, error.translationError);
+        }
+        if (i == 0) firstReport = report;
+    }
+
+    double ratio = static_cast<double>(originalBytes) / compressedBytes;
+    bool smaller = ratio >= 5.0;
+    std::cout << "Memory " << originalBytes / 1024 << " KB -> " << compressedBytes / 1024 << " KB (" << ratio
+              << "x), keys " << originalKeys << " -> " << storedKeys << ": " << (smaller ? "ok" : "FAILED") << std::endl;
+
+    // Quantization adds a little to the key reduction tolerance
+    bool local = maxRotationError <= settings.rotationTolerance * 2.0f && maxTranslationError <= settings.translationTolerance * 2.0f;
+    std::cout << "Local error within tolerance (rotation " << maxRotationError << " rad, translation " << maxTranslationError
+              << "): " << (local ? "ok" : "FAILED") << std::endl;
+    bool model = maxModelError < 0.001f;
+    std::cout << "Model-space error under 1 mm (" << maxModelError * 1000.0f << " mm): " << (model ? "ok" : "FAILED") << std::endl;
+    bool segmented = compressed[0]->getSegmentCount() == static_cast<int>(std::ceil(clips[0]->getDuration() / settings.segmentDuration));
+    std::cout << "Clips split into " << compressed[0]->getSegmentCount() << " segments: " << (segmented ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && smaller && local && model && segmented;
+
+    // Error report per chain, measured at each chain's last bone
+    std::cout << "Chain errors for " << clips[0]->getName() << " (mm):";
+    for (int bone = 0; bone < kBoneCount; ++bone) {
+        bool leaf = std::find(parents.begin(), parents.end(), bone) == parents.end();
+        if (leaf) std::cout << " " << firstReport.bones[bone].modelError * 1000.0f;
+    }
+    std::cout << "; worst bone " << firstReport.worstBone << std::endl;
+
+    // Sampling 100 characters per frame from raw and compressed clips
+    std::uniform_real_distribution<float> offset(0.0f, kKeyCount * kKeyInterval);
+    std::vector<float> times(kCharacterCount);
+    std::vector<AnimationSampler> samplers(kCharacterCount);
+    std::vector<AnimationPose> poses(kCharacterCount);
+    for (int i = 0; i < kCharacterCount; ++i) {
+        times[i] = offset(rng);
+        samplers[i].bind(clips[i % kClipCount].get());
+        poses[i].reset(kBoneCount);
+    }
+    double rawMs = 0.0, compressedMs = 0.0;
+    for (int frame = 0; frame < kFrames; ++frame) {
+        for (float& time : times) {
+            time += 1.0f / 60.0f;
+        }
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < kCharacterCount; ++i) {
+            samplers[i].sample(times[i], poses[i]);
+        }
+        rawMs += elapsedMs(start);
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < kCharacterCount; ++i) {
+            compressed[i % kClipCount]->sample(times[i], poses[i]);
+        }
+        compressedMs += elapsedMs(start);
+    }
+    std::cout << "Compressing " << kClipCount << " clips: " << compressMs << " ms" << std::endl;
+    std::cout << kCharacterCount << " characters per frame: raw " << rawMs / kFrames << " ms, compressed "
+              << compressedMs / kFrames << " ms" << std::endl;
+
+    std::cout << (allCorrect ? "Animation compression benchmark passed!" : "Animation compression benchmark FAILED!") << std::endl;
+    return allCorrect ? 0 : 1;
+}
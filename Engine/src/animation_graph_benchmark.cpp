@@ -0,0 +1,420 @@
+#include "../include/AnimationGraph.h"
+#include "../include/AdvancedAnimationSystem.h"
+#include "../include/JobSystem.h"
+#include "../include/TimingUtils.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <vector>
+
+using namespace Sparky;
+
+// Checks the compiled graph's semantics (conditions, triggers, any-state
+// transitions, 1D and 2D blend weights, cross-fades, compile errors and the
+// AdvancedAnimationController hookup), then runs 500 characters through a
+// locomotion graph for 600 ticks: once with AdvancedAnimationController's
+// string parameters and std::function conditions, polled each tick with
+// setState() as callers have to, and once in an AnimationGraphBatch, which
+// must not allocate while it updates.
+
+namespace {
+    const int kCharacterCount = 500;
+    const int kTicks = 600;
+    const float kTimeStep = 1.0f / 60.0f;
+
+    std::atomic<long long> g_allocations(0);
+
+    AdvancedAnimationController::BlendTreeNode clipNode(const std::string& clip, glm::vec2 position) {
+        AdvancedAnimationController::BlendTreeNode node;
+        node.type = AdvancedAnimationController::BlendTreeNode::NodeType::CLIP;
+        node.clipName = clip;
+        node.position = position;
+        return node;
+    }
+
+    // Idle, Move (1D over speed), Aim (2D over aimX, aimY), Jump and Fall
+    void buildLocomotion(AnimationGraphCompiler& compiler) {
+        compiler.addParameter("speed", AnimationParameterType::FLOAT);
+        compiler.addParameter("aimX", AnimationParameterType::FLOAT);
+        compiler.addParameter("aimY", AnimationParameterType::FLOAT);
+        compiler.addParameter("grounded", AnimationParameterType::BOOL, 1.0f);
+        compiler.addParameter("stance", AnimationParameterType::INT);
+        compiler.addParameter("jump", AnimationParameterType::TRIGGER);
+
+        AdvancedAnimationController::BlendTreeNode move;
+        move.type = AdvancedAnimationController::BlendTreeNode::NodeType::BLEND_1D;
+        move.parameterX = "speed";
+        move.children = {clipNode("run", glm::vec2(6.0f, 0.0f)), clipNode("walk", glm::vec2(1.5f, 0.0f)),
+                         clipNode("jog", glm::vec2(3.0f, 0.0f))};
+        AdvancedAnimationController::BlendTreeNode aim;
+        aim.type = AdvancedAnimationController::BlendTreeNode::NodeType::BLEND_2D;
+        aim.parameterX = "aimX";
+        aim.parameterY = "aimY";
+        aim.children = {clipNode("aim_up", glm::vec2(0.0f, 1.0f)), clipNode("aim_down", glm::vec2(0.0f, -1.0f)),
+                        clipNode("aim_left", glm::vec2(-1.0f, 0.0f)), clipNode("aim_right", glm::vec2(1.0f, 0.0f))};
+
+        compiler.addState("Idle", "idle");
+        compiler.addBlendTreeState("Move", move);
+        compiler.addBlendTreeState("Aim", aim);
+        compiler.addState("Jump", "jump", false);
+        compiler.addState("Fall", "fall");
+
+        compiler.addAnyStateTransition("Jump", 0.1f, "jump && grounded");
+        compiler.addTransition("Idle", "Aim", 0.1f, "stance == 1");
+        compiler.addTransition("Idle", "Move", 0.2f, "speed > 0.1");
+        compiler.addTransition("Move", "Aim", 0.1f, "stance == 1");
+        compiler.addTransition("Move", "Idle", 0.25f, "speed <= 0.1");
+        compiler.addTransition("Aim", "Idle", 0.2f, "stance != 1");
+        compiler.addTransition("Jump", "Fall", 0.2f, "stateTime > 0.4 && !grounded");
+        compiler.addTransition("Jump", "Idle", 0.2f, "stateTime > 0.4 && grounded");
+        compiler.addTransition("Fall", "Idle", 0.15f, "grounded");
+    }
+
+    // Per-tick inputs of a character
+    struct Input {
+        float speed;
+        float aimX, aimY;
+        bool grounded;
+        int stance;
+        bool jump;
+    };
+
+    Input inputFor(int character, int tick) {
+        Input input;
+        input.speed = std::max(0.0f, 2.0f + 3.5f * std::sin(tick * 0.012f + character));
+        input.aimX = std::sin(tick * 0.05f + character);
+        input.aimY = std::cos(tick * 0.031f + character * 0.5f);
+        int sinceJump = (tick + character * 7) % 240;
+        input.jump = sinceJump == 0;
+        input.grounded = sinceJump < 5 || sinceJump >= 45;
+        input.stance = (tick / 120 + character) % 5 == 0 ? 1 : 0;
+        return input;
+    }
+
+    bool near(float a, float b) {
+        return std::fabs(a - b) < 1e-4f;
+    }
+
+    bool checkSemantics(const std::shared_ptr<const CompiledAnimationGraph>& graph) {
+        bool ok = true;
+        AnimationGraphBatch batch(graph);
+        int c = batch.addController();
+        const int speed = graph->findParameter("speed"), grounded = graph->findParameter("grounded");
+        const int stance = graph->findParameter("stance"), jump = graph->findParameter("jump");
+        const int aimX = graph->findParameter("aimX"), aimY = graph->findParameter("aimY");
+        auto clip = [&](const char* name) {
+            for (int i = 0; i < graph->getClipCount(); ++i) {
+                if (graph->getClipName(i) == name) return batch.getClipWeights(c)[i];
+            }
+            return -1.0f;
+        };
+        auto tick = [&](int count) {
+            for (int i = 0; i < count; ++i) batch.updateController(c, kTimeStep);
+        };
+
+        // Comparison starts a cross-fade that blends linearly and then finishes
+        bool idle = graph->getStateName(batch.getCurrentState(c)) == "Idle" && near(clip("idle"), 1.0f);
+        batch.setFloat(c, speed, 3.0f);
+        tick(1);
+        bool started = batch.getNextState(c) == graph->findState("Move") && near(clip("idle"), 1.0f);
+        tick(6);
+        bool halfway = near(batch.getTransitionProgress(c), 0.5f) && near(clip("idle"), 0.5f) && near(clip("jog"), 0.5f);
+        tick(6);
+        bool moving = batch.getCurrentState(c) == graph->findState("Move") && batch.getNextState(c) == -1 && near(clip("jog"), 1.0f);
+        std::cout << "Transitions cross-fade and finish: " << (idle && started && halfway && moving ? "ok" : "FAILED") << std::endl;
+        ok = ok && idle && started && halfway && moving;
+
+        // 1D between sorted thresholds, clamped past the ends
+        batch.setFloat(c, speed, 4.5f);
+        tick(1);
+        bool between = near(clip("jog"), 0.5f) && near(clip("run"), 0.5f) && near(clip("walk"), 0.0f);
+        batch.setFloat(c, speed, 10.0f);
+        tick(1);
+        bool clamped = near(clip("run"), 1.0f);
+        batch.setFloat(c, speed, 2.0f);
+        tick(1);
+        bool low = near(clip("walk"), 2.0f / 3.0f) && near(clip("jog"), 1.0f / 3.0f);
+        std::cout << "1D blend weights: " << (between && clamped && low ? "ok" : "FAILED") << std::endl;
+        ok = ok && between && clamped && low;
+
+        // Int comparison into the 2D state: exact on a sample, symmetric between two
+        batch.setInt(c, stance, 1);
+        tick(7);
+        batch.setFloat(c, aimX, 1.0f);
+        batch.setFloat(c, aimY, 0.0f);
+        tick(1);
+        bool onSample = batch.getCurrentState(c) == graph->findState("Aim") && near(clip("aim_right"), 1.0f);
+        batch.setFloat(c, aimX, 0.5f);
+        batch.setFloat(c, aimY, 0.5f);
+        tick(1);
+        float sum = clip("aim_up") + clip("aim_down") + clip("aim_left") + clip("aim_right");
+        bool symmetric = near(clip("aim_up"), clip("aim_right")) && clip("aim_up") > 0.4f && near(sum, 1.0f);
+        std::cout << "2D blend weights: " << (onSample && symmetric ? "ok" : "FAILED") << std::endl;
+        ok = ok && onSample && symmetric;
+
+        // Any-state transition on a trigger, which it clears; stateTime gates the way out
+        batch.setTrigger(c, jump);
+        tick(1);
+        bool jumped = batch.getNextState(c) == graph->findState("Jump") && batch.getFloat(c, jump) == 0.0f;
+        batch.setBool(c, grounded, false);
+        tick(20);
+        bool held = batch.getCurrentState(c) == graph->findState("Jump") && batch.getNextState(c) == -1;
+        tick(20);
+        bool fell = batch.getNextState(c) == graph->findState("Fall") || batch.getCurrentState(c) == graph->findState("Fall");
+        batch.setTrigger(c, jump);
+        tick(20);
+        bool blocked = batch.getCurrentState(c) == graph->findState("Fall") && batch.getFloat(c, jump) == 1.0f;
+        std::cout << "Triggers, any-state transitions and stateTime: " << (jumped && held && fell && blocked ? "ok" : "FAILED")
+                  << std::endl;
+        ok = ok && jumped && held && fell && blocked;
+
+        // Broken graphs do not compile
+        const char* badConditions[] = {"speed >", "sped > 1", "(speed > 1", "speed > 1 1", "speed & grounded"};
+        bool rejected = true;
+        for (const char* condition : badConditions) {
+            AnimationGraphCompiler compiler;
+            buildLocomotion(compiler);
+            compiler.addTransition("Idle", "Fall", 0.1f, condition);
+            rejected = rejected && !compiler.compile();
+        }
+        AnimationGraphCompiler unknownState;
+        buildLocomotion(unknownState);
+        unknownState.addTransition("Idle", "Swim", 0.1f);
+        rejected = rejected && !unknownState.compile();
+        std::cout << "Malformed graphs are rejected: " << (rejected ? "ok" : "FAILED") << std::endl;
+        ok = ok && rejected;
+        return ok;
+    }
+
+    std::unique_ptr<AnimationClip> makeClip(const std::string& name) {
+        std::unique_ptr<AnimationClip> clip(new AnimationClip(name));
+        for (int key = 0; key < 2; ++key) {
+            Keyframe keyframe;
+            keyframe.time = key * 1.0f;
+            keyframe.position[0] = keyframe.position[1] = keyframe.position[2] = 0.0f;
+            keyframe.rotation[0] = keyframe.rotation[1] = keyframe.rotation[2] = 0.0f;
+            keyframe.rotation[3] = 1.0f;
+            keyframe.scale[0] = keyframe.scale[1] = keyframe.scale[2] = 1.0f;
+            clip->addKeyframe(0, keyframe);
+        }
+        return clip;
+    }
+
+    // The string-keyed controller drives the same SkeletalAnimation calls from the graph
+    bool checkController(const std::shared_ptr<const CompiledAnimationGraph>& graph) {
+        GameObject object("character");
+        SkeletalAnimation* animation = object.addComponent<SkeletalAnimation>();
+        SkeletalAnimation::Bone bone;
+        bone.name = "root";
+        bone.id = 0;
+        bone.parentId = -1;
+        bone.offsetMatrix = glm::mat4(1.0f);
+        bone.finalTransformation = glm::mat4(1.0f);
+        animation->addBone(bone);
+        for (int i = 0; i < graph->getClipCount(); ++i) {
+            animation->addAnimationClip(makeClip(graph->getClipName(i)));
+        }
+        AdvancedAnimationController* controller = object.addComponent<AdvancedAnimationController>();
+        controller->initialize();
+
+        AnimationGraphBatch batch(graph);
+        controller->setAnimationGraphBatch(&batch);
+        controller->setFloatParameter("speed", 4.0f);
+        for (int i = 0; i < 60; ++i) {
+            batch.update(kTimeStep);
+            controller->update(kTimeStep);
+            animation->update(kTimeStep);
+        }
+        bool driven = controller->getCurrentState() == "Move" && controller->getFloatParameter("speed") == 4.0f &&
+                      animation->getCurrentAnimation() == "jog";
+        controller->setAnimationGraphBatch(nullptr);
+        bool left = batch.getControllerCount() == 0 && controller->getCurrentState() == "Default";
+        std::cout << "AdvancedAnimationController runs in a batch: " << (driven && left ? "ok" : "FAILED") << std::endl;
+        return driven && left;
+    }
+
+    // The string-keyed version of the same graph; conditions read parameters by name
+    struct Reference {
+        std::unique_ptr<GameObject> object;
+        AdvancedAnimationController* controller;
+        float stateTime;
+        std::string lastState;
+    };
+
+    void buildReference(Reference& reference, int index) {
+        reference.object.reset(new GameObject("character" + std::to_string(index)));
+        AdvancedAnimationController* controller = reference.object->addComponent<AdvancedAnimationController>();
+        controller->initialize();
+        reference.controller = controller;
+        reference.stateTime = 0.0f;
+
+        const char* clips[][2] = {{"Idle", "idle"}, {"Move", "jog"}, {"Aim", "aim_up"}, {"Jump", "jump"}, {"Fall", "fall"}};
+        for (const auto& entry : clips) {
+            controller->addState({entry[0], entry[1], true, 1.0f});
+        }
+        float* stateTime = &reference.stateTime;
+        auto add = [controller](const char* from, const char* to, float time, std::function<bool()> condition) {
+            controller->addTransition({from, to, time, condition});
+        };
+        add("Default", "Idle", 0.0f, nullptr);
+        const char* states[] = {"Idle", "Move", "Aim", "Fall"};
+        for (const char* from : states) {
+            add(from, "Jump", 0.1f, [controller] { return controller->getBoolParameter("jump") && controller->getBoolParameter("grounded"); });
+        }
+        add("Idle", "Aim", 0.1f, [controller] { return controller->getIntParameter("stance") == 1; });
+        add("Idle", "Move", 0.2f, [controller] { return controller->getFloatParameter("speed") > 0.1f; });
+        add("Move", "Aim", 0.1f, [controller] { return controller->getIntParameter("stance") == 1; });
+        add("Move", "Idle", 0.25f, [controller] { return controller->getFloatParameter("speed") <= 0.1f; });
+        add("Aim", "Idle", 0.2f, [controller] { return controller->getIntParameter("stance") != 1; });
+        add("Jump", "Fall", 0.2f, [controller, stateTime] { return *stateTime > 0.4f && !controller->getBoolParameter("grounded"); });
+        add("Jump", "Idle", 0.2f, [controller, stateTime] { return *stateTime > 0.4f && controller->getBoolParameter("grounded"); });
+        add("Fall", "Idle", 0.15f, [controller] { return controller->getBoolParameter("grounded"); });
+        controller->setState("Idle");
+        reference.lastState = controller->getCurrentState();
+    }
+
+    // Offers every state as a target, which runs the conditions of the current state's transitions
+    void tickReference(Reference& reference, const Input& input) {
+        static const char* states[] = {"Jump", "Idle", "Move", "Aim", "Fall"};
+        AdvancedAnimationController* controller = reference.controller;
+        controller->setFloatParameter("speed", input.speed);
+        controller->setFloatParameter("aimX", input.aimX);
+        controller->setFloatParameter("aimY", input.aimY);
+        controller->setBoolParameter("grounded", input.grounded);
+        controller->setIntParameter("stance", input.stance);
+        if (input.jump) controller->setBoolParameter("jump", true);
+        for (const char* state : states) {
+            if (controller->getCurrentState() != state) controller->setState(state);
+        }
+        controller->advance(kTimeStep);
+        if (controller->getCurrentState() != reference.lastState) {
+            reference.lastState = controller->getCurrentState();
+            reference.stateTime = 0.0f;
+            controller->setBoolParameter("jump", false);
+        }
+        reference.stateTime += kTimeStep;
+    }
+
+    void setInputs(AnimationGraphBatch& batch, const int* parameters, int controller, const Input& input) {
+        batch.setFloat(controller, parameters[0], input.speed);
+        batch.setFloat(controller, parameters[1], input.aimX);
+        batch.setFloat(controller, parameters[2], input.aimY);
+        batch.setBool(controller, parameters[3], input.grounded);
+        batch.setInt(controller, parameters[4], input.stance);
+        if (input.jump) batch.setTrigger(controller, parameters[5]);
+    }
+}
+
+// Counts heap allocations, to show the batch update makes none. Every replaceable form goes
+// to the aligned ones, which are not replaced, so allocations and frees always pair up.
+namespace {
+    const std::align_val_t kAlignment = std::align_val_t(alignof(std::max_align_t));
+
+    void* allocate(std::size_t size, bool nothrow) {
+        ++g_allocations;
+        return nothrow ? ::operator new(size, kAlignment, std::nothrow) : ::operator new(size, kAlignment);
+    }
+}
+
+void* operator new(std::size_t size) { return allocate(size, false); }
+void* operator new[](std::size_t size) { return allocate(size, false); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return allocate(size, true); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return allocate(size, true); }
+void operator delete(void* memory) noexcept { ::operator delete(memory, kAlignment); }
+void operator delete[](void* memory) noexcept { ::operator delete(memory, kAlignment); }
+void operator delete(void* memory, std::size_t) noexcept { ::operator delete(memory, kAlignment); }
+void operator delete[](void* memory, std::size_t) noexcept { ::operator delete(memory, kAlignment); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept { ::operator delete(memory, kAlignment); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { ::operator delete(memory, kAlignment); }
+
+int main() {
+    std::cout << "Animation Graph Benchmark" << std::endl;
+    bool allCorrect = true;
+
+    AnimationGraphCompiler compiler;
+    buildLocomotion(compiler);
+    std::shared_ptr<const CompiledAnimationGraph> graph = compiler.compile();
+    if (!graph) {
+        std::cout << "Locomotion graph did not compile" << std::endl << "Animation graph benchmark FAILED!" << std::endl;
+        return 1;
+    }
+    allCorrect = checkSemantics(graph) && allCorrect;
+    allCorrect = checkController(graph) && allCorrect;
+
+    // String-keyed controllers
+    std::vector<Reference> references(kCharacterCount);
+    for (int i = 0; i < kCharacterCount; ++i) {
+        buildReference(references[i], i);
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (int tick = 0; tick < kTicks; ++tick) {
+        for (int i = 0; i < kCharacterCount; ++i) {
+            tickReference(references[i], inputFor(i, tick));
+        }
+    }
+    double referenceMs = elapsedMs(start);
+
+    // One batch, serial and on workers
+    const char* names[] = {"speed", "aimX", "aimY", "grounded", "stance", "jump"};
+    int parameters[6];
+    for (int i = 0; i < 6; ++i) {
+        parameters[i] = graph->findParameter(names[i]);
+    }
+    AnimationGraphBatch serial(graph), parallel(graph);
+    std::unique_ptr<JobSystem> jobSystem = JobSystem::create(2, 0);
+    parallel.setJobSystem(jobSystem.get());
+    for (int i = 0; i < kCharacterCount; ++i) {
+        serial.addController();
+        parallel.addController();
+    }
+
+    double batchMs = 0.0;
+    long long transitions = 0, allocations = 0;
+    int stateTicks[5] = {};
+    bool identical = true;
+    for (int tick = 0; tick < kTicks; ++tick) {
+        for (int i = 0; i < kCharacterCount; ++i) {
+            Input input = inputFor(i, tick);
+            setInputs(serial, parameters, i, input);
+            setInputs(parallel, parameters, i, input);
+        }
+        long long before = g_allocations.load();
+        start = std::chrono::steady_clock::now();
+        serial.update(kTimeStep);
+        batchMs += elapsedMs(start);
+        allocations += g_allocations.load() - before;
+        parallel.update(kTimeStep);
+
+        transitions += serial.getTransitionsStarted();
+        for (int i = 0; i < kCharacterCount; ++i) {
+            ++stateTicks[serial.getCurrentState(i)];
+            identical = identical && serial.getCurrentState(i) == parallel.getCurrentState(i) &&
+                        serial.getNextState(i) == parallel.getNextState(i) &&
+                        std::equal(serial.getClipWeights(i), serial.getClipWeights(i) + graph->getClipCount(), parallel.getClipWeights(i));
+        }
+    }
+
+    bool everyState = true;
+    std::cout << "Ticks per state:";
+    for (int state = 0; state < graph->getStateCount(); ++state) {
+        std::cout << " " << graph->getStateName(state) << " " << stateTicks[state];
+        everyState = everyState && stateTicks[state] > 0;
+    }
+    std::cout << std::endl;
+    bool busy = everyState && transitions > kCharacterCount;
+    std::cout << transitions << " transitions, every state visited: " << (busy ? "ok" : "FAILED") << std::endl;
+    std::cout << "Allocations while updating: " << allocations << ": " << (allocations == 0 ? "ok" : "FAILED") << std::endl;
+    std::cout << "Same states and weights on workers: " << (identical ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && busy && allocations == 0 && identical;
+
+    std::cout << kCharacterCount << " controllers x " << kTicks << " ticks: string controller " << referenceMs << " ms ("
+              << referenceMs * 1e6 / (kCharacterCount * kTicks) << " ns each), compiled batch " << batchMs << " ms ("
+              << batchMs * 1e6 / (kCharacterCount * kTicks) << " ns each, " << referenceMs / batchMs << "x)" << std::endl;
+
+    std::cout << (allCorrect ? "Animation graph benchmark passed!" : "Animation graph benchmark FAILED!") << std::endl;
+    return allCorrect ? 0 : 1;
+}
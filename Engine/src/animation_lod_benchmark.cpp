@@ -0,0 +1,231 @@
+#include "../include/AnimationSystem.h"
+#include "../include/AdvancedAnimationSystem.h"
+#include "../include/Camera.h"
+#include "../include/TimingUtils.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+using namespace Sparky;
+
+// 1000 walking characters, each a 40-bone skeleton with an IK chain, spread
+// from 3 m to 200 m in front of a camera, with every fifth one behind it.
+// The same crowd runs through an AnimationSystem without a camera (full
+// detail) and one with it. Checks that far characters drop to the reduced
+// rates, lose their leaf bones and IK, that characters behind the camera are
+// culled and pick up where they should once the camera turns to them, and
+// that interpolated characters move without the jumps a held pose would
+// show. Then compares evaluated bones and frame times.
+
+namespace {
+    const int kCharacterCount = 1000;
+    const int kBoneCount = 40;
+    const int kKeyCount = 240;
+    const float kKeyInterval = 1.0f / 30.0f;
+    const int kFrames = 240;
+    const float kDeltaTime = 1.0f / 60.0f;
+    const int kTrackedBone = 39;
+
+    int parentOf(int bone) {
+        if (bone < 8) return bone - 1;                  // Spine and head
+        if (bone < 24) return 4 + (bone - 8) / 4;       // Four-bone limbs off the spine
+        return bone % 4 == 0 ? 7 : bone - 1;            // Four-bone fingers off the head
+    }
+
+    std::unique_ptr<AnimationClip> makeClip(float phase) {
+        std::unique_ptr<AnimationClip> clip(new AnimationClip("walk"));
+        for (int bone = 0; bone < kBoneCount; ++bone) {
+            glm::vec3 axis = glm::normalize(glm::vec3(std::sin(bone * 1.3f), 1.0f, std::cos(bone * 0.7f)));
+            for (int key = 0; key < kKeyCount; ++key) {
+                float time = key * kKeyInterval;
+                glm::quat rotation = glm::angleAxis(0.5f * std::sin(3.0f * time + phase + bone * 0.3f), axis);
+                Keyframe keyframe;
+                keyframe.time = time;
+                keyframe.position[0] = 0.0f;
+                keyframe.position[1] = bone == 0 ? 1.0f : 0.1f;
+                keyframe.position[2] = 0.0f;
+                keyframe.rotation[0] = rotation.x;
+                keyframe.rotation[1] = rotation.y;
+                keyframe.rotation[2] = rotation.z;
+                keyframe.rotation[3] = rotation.w;
+                keyframe.scale[0] = keyframe.scale[1] = keyframe.scale[2] = 1.0f;
+                clip->addKeyframe(bone, keyframe);
+            }
+        }
+        return clip;
+    }
+
+    glm::vec3 placement(int index) {
+        float distance = 3.0f + 197.0f * index / (kCharacterCount - 1);
+        float side = std::sin(index * 2.4f) * distance * 0.3f;
+        return index % 5 == 4 ? glm::vec3(side, 0.0f, distance) : glm::vec3(side, 0.0f, -distance);
+    }
+
+    struct Crowd {
+        std::vector<std::unique_ptr<GameObject>> objects;
+        std::vector<SkeletalAnimation*> animations;
+        std::vector<AnimatorId> animators;
+        std::unique_ptr<AnimationSystem> system = AnimationSystem::create();
+    };
+
+    void buildCrowd(Crowd& crowd) {
+        for (int i = 0; i < kCharacterCount; ++i) {
+            std::unique_ptr<GameObject> object(new GameObject("character" + std::to_string(i)));
+            object->setPosition(placement(i));
+            SkeletalAnimation* animation = object->addComponent<SkeletalAnimation>();
+            for (int bone = 0; bone < kBoneCount; ++bone) {
+                SkeletalAnimation::Bone entry;
+                entry.name = "bone" + std::to_string(bone);
+                entry.id = bone;
+                entry.parentId = parentOf(bone);
+                entry.offsetMatrix = glm::mat4(1.0f);
+                entry.finalTransformation = glm::mat4(1.0f);
+                animation->addBone(entry);
+            }
+            animation->addAnimationClip(makeClip(i * 0.1f));
+            animation->playAnimation("walk");
+
+            InverseKinematics* ik = object->addComponent<InverseKinematics>();
+            ik->initialize();
+            InverseKinematics::IKChain chain;
+            for (int bone = 9; bone < 11; ++bone) {
+                chain.joints.push_back({bone, 0.0f, 1.0f, glm::vec3(1.0f, 0.0f, 0.0f)});
+            }
+            chain.effectorBoneId = 11;
+            chain.targetBoneId = -1;
+            chain.poleBoneId = -1;
+            ik->addIKChain(chain);
+            ik->setTargetPosition(0, glm::vec3(0.3f, 0.5f, 0.2f));
+
+            crowd.animators.push_back(crowd.system->addAnimator(object.get()));
+            crowd.animations.push_back(animation);
+            crowd.objects.push_back(std::move(object));
+        }
+    }
+
+    glm::vec3 bonePosition(const SkeletalAnimation& animation) {
+        return glm::vec3(animation.getBoneModelTransform(kTrackedBone)[3]);
+    }
+
+    // First character in front of the camera at least this far away
+    int characterBeyond(float distance) {
+        for (int i = 0; i < kCharacterCount; ++i) {
+            if (i % 5 != 4 && glm::length(placement(i)) >= distance) return i;
+        }
+        return -1;
+    }
+}
+
+int main() {
+    std::cout << "Animation LOD Benchmark" << std::endl;
+    bool allCorrect = true;
+
+    Crowd full, lod;
+    buildCrowd(full);
+    buildCrowd(lod);
+    Camera camera(glm::vec3(0.0f, 1.0f, 0.0f));
+    lod.system->setCamera(&camera);
+    const AnimationSystemSettings& settings = lod.system->getSettings();
+
+    int innerBones = 0;
+    for (int bone = 0; bone < kBoneCount; ++bone) {
+        bool parent = false;
+        for (int child = 0; child < kBoneCount; ++child) {
+            parent = parent || parentOf(child) == bone;
+        }
+        innerBones += parent ? 1 : 0;
+    }
+
+    // Near, 1/2, 1/4 and 1/8 rate characters to follow
+    const int tracked[4] = {characterBeyond(5.0f), characterBeyond(25.0f), characterBeyond(55.0f), characterBeyond(100.0f)};
+    float maxStep[4][2] = {}, maxLag[4] = {};
+    glm::vec3 last[4][2];
+    bool leafSkipping = true, fullNear = true;
+
+    double fullMs = 0.0, lodMs = 0.0;
+    long long fullBones = 0, lodBones = 0, totalBones = 0;
+    AnimationSystemStats stats = AnimationSystemStats();
+    for (int frame = 0; frame < kFrames; ++frame) {
+        auto start = std::chrono::steady_clock::now();
+        full.system->update(kDeltaTime);
+        fullMs += elapsedMs(start);
+        start = std::chrono::steady_clock::now();
+        lod.system->update(kDeltaTime);
+        lodMs += elapsedMs(start);
+
+        fullBones += full.system->getStats().bonesEvaluated;
+        lodBones += lod.system->getStats().bonesEvaluated;
+        totalBones += lod.system->getStats().bonesTotal;
+        stats = lod.system->getStats();
+
+        for (int t = 0; t < 4; ++t) {
+            glm::vec3 positions[2] = {bonePosition(*full.animations[tracked[t]]), bonePosition(*lod.animations[tracked[t]])};
+            for (int world = 0; world < 2; ++world) {
+                if (frame > 8) maxStep[t][world] = std::max(maxStep[t][world], glm::length(positions[world] - last[t][world]));
+                last[t][world] = positions[world];
+            }
+            if (frame > 8) maxLag[t] = std::max(maxLag[t], glm::length(positions[1] - positions[0]));
+        }
+
+        // Leaf bones go past their distance, and only there
+        for (int t = 0; t < 4; ++t) {
+            int evaluated = lod.animations[tracked[t]]->getEvaluatedBoneCount();
+            if (evaluated == 0) continue;
+            if (glm::length(placement(tracked[t])) > settings.leafBoneDistance) {
+                leafSkipping = leafSkipping && evaluated == innerBones;
+            } else {
+                fullNear = fullNear && evaluated == kBoneCount;
+            }
+        }
+    }
+
+    bool rates = true;
+    for (int t = 0; t < 4; ++t) {
+        rates = rates && lod.system->getAnimatorInterval(lod.animators[tracked[t]]) == (1 << t);
+    }
+    rates = rates && stats.rateCounts[0] > 0 && stats.rateCounts[1] > 0 && stats.rateCounts[2] > 0 && stats.rateCounts[3] > 0;
+    std::cout << "Rates by distance (full " << stats.rateCounts[0] << ", 1/2 " << stats.rateCounts[1] << ", 1/4 "
+              << stats.rateCounts[2] << ", 1/8 " << stats.rateCounts[3] << "): " << (rates ? "ok" : "FAILED") << std::endl;
+    std::cout << "Leaf bones skipped beyond " << settings.leafBoneDistance << " m (" << innerBones << " of " << kBoneCount
+              << " sampled): " << (leafSkipping && fullNear ? "ok" : "FAILED") << std::endl;
+    bool ikCutoff = stats.ikSolved > 0 && stats.ikSolved < stats.animatorsEvaluated;
+    std::cout << "IK only up close (" << stats.ikSolved << " of " << stats.animatorsEvaluated << " evaluated): "
+              << (ikCutoff ? "ok" : "FAILED") << std::endl;
+    int behind = kCharacterCount / 5;
+    bool culled = stats.animatorsCulled >= behind && stats.animatorsEvaluated + stats.animatorsCulled <= kCharacterCount;
+    std::cout << "Culled " << stats.animatorsCulled << " (" << behind << " behind the camera): " << (culled ? "ok" : "FAILED") << std::endl;
+
+    // Interpolated steps stay close to the full-rate ones; a held pose would jump by the whole interval
+    bool smooth = true;
+    for (int t = 1; t < 4; ++t) {
+        smooth = smooth && maxStep[t][1] <= maxStep[t][0] * 1.25f + 1e-4f;
+        std::cout << "1/" << (1 << t) << " rate: largest step " << maxStep[t][1] * 1000.0f << " mm (full rate "
+                  << maxStep[t][0] * 1000.0f << " mm), lag up to " << maxLag[t] * 1000.0f << " mm" << std::endl;
+    }
+    bool exact = maxLag[0] < 1e-5f;
+    std::cout << "Interpolation without jumps, full rate exact: " << (smooth && exact ? "ok" : "FAILED") << std::endl;
+
+    // Turn around: the characters behind have kept their clocks
+    int hidden = 4;
+    camera.setYaw(90.0f);
+    full.system->update(kDeltaTime);
+    lod.system->update(kDeltaTime);
+    bool caughtUp = lod.system->getAnimatorInterval(lod.animators[hidden]) == 1 &&
+                    std::fabs(lod.animations[hidden]->getCurrentTime() - full.animations[hidden]->getCurrentTime()) < 1e-3f;
+    std::cout << "Culled characters resume in step: " << (caughtUp ? "ok" : "FAILED") << std::endl;
+
+    double boneRatio = static_cast<double>(lodBones) / static_cast<double>(fullBones);
+    bool fewer = boneRatio < 0.4 && fullBones == totalBones;
+    std::cout << "Bones evaluated: " << lodBones / kFrames << " of " << totalBones / kFrames << " per frame (" << boneRatio * 100.0
+              << "%): " << (fewer ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && rates && leafSkipping && fullNear && ikCutoff && culled && smooth && exact && caughtUp && fewer;
+
+    std::cout << kCharacterCount << " characters per frame: full detail " << fullMs / kFrames << " ms, LOD " << lodMs / kFrames
+              << " ms (" << fullMs / lodMs << "x)" << std::endl;
+
+    std::cout << (allCorrect ? "Animation LOD benchmark passed!" : "Animation LOD benchmark FAILED!") << std::endl;
+    return allCorrect ? 0 : 1;
+}
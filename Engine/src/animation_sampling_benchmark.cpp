@@ -0,0 +1,277 @@
+#include "../include/AdvancedAnimationSystem.h"
+#include "../include/AnimationSampler.h"
+#include "../include/TimingUtils.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+using namespace Sparky;
+
+// 100 characters with 60-bone skeletons playing 1000-key clips at different
+// offsets and speeds. Checks that cursor sampling matches
+// AnimationClip::evaluate during playback, across loop wraps and on random
+// seeks, that bones the clip does not animate are left alone, and that
+// SkeletalAnimation and the cursor overload of AnimationTrack agree with the
+// reference. Then compares frame times with the previous linear keyframe
+// scan into a map.
+
+namespace {
+    const int kCharacterCount = 100;
+    const int kBoneCount = 60;
+    const int kKeyCount = 1000;
+    const int kClipCount = 4;
+    const float kKeyInterval = 1.0f / 30.0f;
+    const float kTimeStep = 1.0f / 60.0f;
+    const int kFrames = 120;
+
+    Keyframe makeKeyframe(float time, std::mt19937& rng) {
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        glm::quat rotation = glm::normalize(glm::quat(unit(rng) + 2.0f, unit(rng), unit(rng), unit(rng)));
+        Keyframe keyframe;
+        keyframe.time = time;
+        keyframe.position[0] = unit(rng);
+        keyframe.position[1] = unit(rng);
+        keyframe.position[2] = unit(rng);
+        keyframe.rotation[0] = rotation.x;
+        keyframe.rotation[1] = rotation.y;
+        keyframe.rotation[2] = rotation.z;
+        keyframe.rotation[3] = rotation.w;
+        keyframe.scale[0] = keyframe.scale[1] = keyframe.scale[2] = 1.0f + 0.1f * unit(rng);
+        return keyframe;
+    }
+
+    // Every bone but the last is animated, so one bone checks the untouched path
+    std::unique_ptr<AnimationClip> makeClip(int index, std::mt19937& rng) {
+        std::unique_ptr<AnimationClip> clip(new AnimationClip("clip" + std::to_string(index)));
+        for (int bone = 0; bone < kBoneCount - 1; ++bone) {
+            for (int key = 0; key < kKeyCount; ++key) {
+                clip->addKeyframe(bone, makeKeyframe(key * kKeyInterval, rng));
+            }
+        }
+        return clip;
+    }
+
+    // The previous AnimationClip::evaluate: a linear scan per bone into a map
+    void evaluateLinear(const AnimationClip& clip, float time, std::unordered_map<int, glm::mat4>& boneTransforms) {
+        float evalTime = std::fmod(time, clip.getDuration());
+        for (int bone : clip.getBoneIds()) {
+            const std::vector<Keyframe>& keyframes = clip.getKeyframes(bone);
+            const Keyframe* prev = nullptr;
+            const Keyframe* next = nullptr;
+            for (const Keyframe& keyframe : keyframes) {
+                if (keyframe.time <= evalTime) {
+                    prev = &keyframe;
+                } else {
+                    next = &keyframe;
+                    break;
+                }
+            }
+            if (!next) next = prev;
+            if (!prev) prev = next;
+            float t = prev != next ? (evalTime - prev->time) / (next->time - prev->time) : 0.0f;
+            glm::quat rotation = glm::slerp(glm::quat(prev->rotation[3], prev->rotation[0], prev->rotation[1], prev->rotation[2]),
+                                            glm::quat(next->rotation[3], next->rotation[0], next->rotation[1], next->rotation[2]), t);
+            glm::vec3 position(prev->position[0] + (next->position[0] - prev->position[0]) * t,
+                               prev->position[1] + (next->position[1] - prev->position[1]) * t,
+                               prev->position[2] + (next->position[2] - prev->position[2]) * t);
+            glm::vec3 scale(prev->scale[0] + (next->scale[0] - prev->scale[0]) * t,
+                            prev->scale[1] + (next->scale[1] - prev->scale[1]) * t,
+                            prev->scale[2] + (next->scale[2] - prev->scale[2]) * t);
+            boneTransforms[bone] = glm::translate(glm::mat4(1.0f), position) * glm::mat4_cast(rotation) *
+                                   glm::scale(glm::mat4(1.0f), scale);
+        }
+    }
+
+    float maxDifference(const glm::mat4& a, const glm::mat4& b) {
+        float difference = 0.0f;
+        for (int column = 0; column < 4; ++column) {
+            for (int row = 0; row < 4; ++row) {
+                difference = std::max(difference, std::fabs(a[column][row] - b[column][row]));
+            }
+        }
+        return difference;
+    }
+
+    // Largest difference between a sampled pose and AnimationClip::evaluate
+    float poseError(const AnimationClip& clip, float time, const AnimationPose& pose) {
+        std::unordered_map<int, glm::mat4> reference;
+        clip.evaluate(time, reference);
+        float error = 0.0f;
+        for (const auto& pair : reference) {
+            error = std::max(error, maxDifference(pose.getMatrix(pair.first), pair.second));
+        }
+        return error;
+    }
+
+    struct Character {
+        int clip;
+        float time;
+        float speed;
+        AnimationSampler sampler;
+        AnimationPose pose;
+        std::vector<glm::mat4> matrices;
+        std::unordered_map<int, glm::mat4> boneTransforms;
+    };
+
+    bool checkSkeletalAnimation(std::mt19937& rng) {
+        SkeletalAnimation skeleton;
+        for (int bone = 0; bone < kBoneCount; ++bone) {
+            SkeletalAnimation::Bone entry;
+            entry.name = "bone" + std::to_string(bone);
+            entry.id = bone;
+            entry.parentId = bone - 1;
+            entry.offsetMatrix = glm::mat4(1.0f);
+            entry.finalTransformation = glm::mat4(1.0f);
+            skeleton.addBone(entry);
+        }
+        std::unique_ptr<AnimationClip> clip(new AnimationClip("walk"));
+        for (int bone = 0; bone < kBoneCount - 1; ++bone) {
+            for (int key = 0; key < 50; ++key) {
+                clip->addKeyframe(bone, makeKeyframe(key * kKeyInterval, rng));
+            }
+        }
+        const AnimationClip* walk = clip.get();
+        skeleton.addAnimationClip(std::move(clip));
+        skeleton.playAnimation("walk");
+
+        float error = 0.0f;
+        for (int frame = 0; frame < 200; ++frame) {
+            skeleton.update(kTimeStep);
+            std::unordered_map<int, glm::mat4> reference;
+            walk->evaluate(skeleton.getCurrentTime(), reference);
+            for (int bone = 0; bone < kBoneCount - 1; ++bone) {
+                error = std::max(error, maxDifference(skeleton.getLocalPose().getMatrix(bone), reference[bone]));
+            }
+        }
+        return error < 1e-4f && maxDifference(skeleton.getLocalPose().getMatrix(kBoneCount - 1), glm::mat4(1.0f)) == 0.0f;
+    }
+
+    bool checkTrackCursor(std::mt19937& rng) {
+        AnimationTrack track("root");
+        for (int key = 1; key < kKeyCount; ++key) {
+            track.addKeyframe(makeKeyframe(key * kKeyInterval, rng));
+        }
+        std::uniform_real_distribution<float> seek(-1.0f, kKeyCount * kKeyInterval + 1.0f);
+        int cursor = 0;
+        float time = 0.0f;
+        for (int i = 0; i < 2000; ++i) {
+            time = i % 100 == 0 ? seek(rng) : time + kTimeStep;
+            Keyframe cached = track.getKeyframeAtTime(time, cursor);
+            Keyframe searched = track.getKeyframeAtTime(time);
+            for (int c = 0; c < 3; ++c) {
+                if (cached.position[c] != searched.position[c]) return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main() {
+    std::cout << "Animation Sampling Benchmark" << std::endl;
+    std::mt19937 rng(41);
+    bool allCorrect = true;
+
+    std::vector<std::unique_ptr<AnimationClip>> clips;
+    for (int i = 0; i < kClipCount; ++i) {
+        clips.push_back(makeClip(i, rng));
+    }
+
+    std::uniform_real_distribution<float> offset(0.0f, kKeyCount * kKeyInterval);
+    std::uniform_real_distribution<float> speed(0.8f, 1.5f);
+    std::vector<Character> characters(kCharacterCount);
+    for (int i = 0; i < kCharacterCount; ++i) {
+        Character& character = characters[i];
+        character.clip = i % kClipCount;
+        character.time = offset(rng);
+        character.speed = speed(rng);
+        character.sampler.bind(clips[character.clip].get());
+        character.pose.reset(kBoneCount);
+        character.matrices.resize(kBoneCount);
+    }
+
+    // Playback, long enough for some characters to wrap
+    float playbackError = 0.0f;
+    for (int frame = 0; frame < 30 * 60; ++frame) {
+        for (int i = 0; i < 10; ++i) {
+            Character& character = characters[i];
+            character.time += kTimeStep * character.speed * 10.0f;
+            character.sampler.sample(character.time, character.pose);
+            playbackError = std::max(playbackError, poseError(*clips[character.clip], character.time, character.pose));
+        }
+    }
+    bool playback = playbackError < 1e-4f;
+    std::cout << "Playback matches evaluate across loops (max error " << playbackError << "): "
+              << (playback ? "ok" : "FAILED") << std::endl;
+
+    // Random seeks in both directions
+    float seekError = 0.0f;
+    std::uniform_real_distribution<float> seek(-2.0f, kKeyCount * kKeyInterval * 3.0f);
+    for (int i = 0; i < 500; ++i) {
+        Character& character = characters[i % kCharacterCount];
+        float time = seek(rng);
+        character.sampler.sample(time, character.pose);
+        seekError = std::max(seekError, poseError(*clips[character.clip], time, character.pose));
+    }
+    bool seeks = seekError < 1e-4f;
+    std::cout << "Seeks match evaluate (max error " << seekError << "): " << (seeks ? "ok" : "FAILED") << std::endl;
+
+    bool untouched = true;
+    for (const Character& character : characters) {
+        untouched = untouched && maxDifference(character.pose.getMatrix(kBoneCount - 1), glm::mat4(1.0f)) == 0.0f;
+    }
+    std::cout << "Bones without keyframes are left alone: " << (untouched ? "ok" : "FAILED") << std::endl;
+
+    bool skeletal = checkSkeletalAnimation(rng);
+    std::cout << "SkeletalAnimation matches evaluate: " << (skeletal ? "ok" : "FAILED") << std::endl;
+    bool trackCursor = checkTrackCursor(rng);
+    std::cout << "AnimationTrack cursor matches search: " << (trackCursor ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && playback && seeks && untouched && skeletal && trackCursor;
+
+    // Frame times: every character samples its full skeleton into matrices
+    double linearMs = 0.0, evaluateMs = 0.0, samplerMs = 0.0;
+    for (int frame = 0; frame < kFrames; ++frame) {
+        for (Character& character : characters) {
+            character.time += kTimeStep * character.speed;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (Character& character : characters) {
+            character.boneTransforms.clear();
+            evaluateLinear(*clips[character.clip], character.time, character.boneTransforms);
+        }
+        linearMs += elapsedMs(start);
+
+        start = std::chrono::steady_clock::now();
+        for (Character& character : characters) {
+            character.boneTransforms.clear();
+            clips[character.clip]->evaluate(character.time, character.boneTransforms);
+        }
+        evaluateMs += elapsedMs(start);
+
+        start = std::chrono::steady_clock::now();
+        for (Character& character : characters) {
+            character.sampler.sample(character.time, character.pose);
+            for (int bone = 0; bone < kBoneCount; ++bone) {
+                character.matrices[bone] = character.pose.getMatrix(bone);
+            }
+        }
+        samplerMs += elapsedMs(start);
+    }
+    linearMs /= kFrames;
+    evaluateMs /= kFrames;
+    samplerMs /= kFrames;
+
+    bool faster = samplerMs * 2.0 < linearMs;
+    std::cout << kCharacterCount << " characters x " << kBoneCount << " bones x " << kKeyCount << " keys per frame: linear scan "
+              << linearMs << " ms, evaluate " << evaluateMs << " ms, cursors " << samplerMs << " ms" << std::endl;
+    std::cout << "Cursor sampling beats the linear scan: " << (faster ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && faster;
+
+    std::cout << (allCorrect ? "Animation sampling benchmark passed!" : "Animation sampling benchmark FAILED!") << std::endl;
+    return allCorrect ? 0 : 1;
+}
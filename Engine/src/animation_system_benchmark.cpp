@@ -0,0 +1,240 @@
+#include "../include/AnimationSystem.h"
+#include "../include/AdvancedAnimationSystem.h"
+#include "../include/JobSystem.h"
+#include "../include/TimingUtils.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace Sparky;
+
+// A crowd of 400 characters, each with a 40-bone skeleton, walk and run
+// clips with footstep events, a state machine switching between them and
+// an IK chain on one limb. The same crowd is built three times: one updated
+// component by component as before, one through the AnimationSystem on the
+// calling thread and one through it on the JobSystem. Checks that all three
+// publish identical skinning matrices every frame, that footsteps reach
+// their callbacks on the main thread in the same order everywhere, and that
+// the published arena is left alone while the next frame evaluates. Then
+// compares frame times.
+
+namespace {
+    const int kCharacterCount = 400;
+    const int kBoneCount = 40;
+    const int kKeyCount = 240;
+    const float kKeyInterval = 1.0f / 30.0f;
+    const int kFrames = 240;
+    const float kDeltaTime = 1.0f / 60.0f;
+
+    std::unique_ptr<AnimationClip> makeClip(const std::string& name, float speed, float phase) {
+        std::unique_ptr<AnimationClip> clip(new AnimationClip(name));
+        for (int bone = 0; bone < kBoneCount; ++bone) {
+            glm::vec3 axis = glm::normalize(glm::vec3(std::sin(bone * 1.3f), 1.0f, std::cos(bone * 0.7f)));
+            for (int key = 0; key < kKeyCount; ++key) {
+                float time = key * kKeyInterval;
+                glm::quat rotation = glm::angleAxis(0.4f * std::sin(speed * time + phase + bone * 0.3f), axis);
+                Keyframe keyframe;
+                keyframe.time = time;
+                keyframe.position[0] = 0.0f;
+                keyframe.position[1] = bone == 0 ? 1.0f : 0.1f;
+                keyframe.position[2] = bone == 0 ? speed * time : 0.0f;
+                keyframe.rotation[0] = rotation.x;
+                keyframe.rotation[1] = rotation.y;
+                keyframe.rotation[2] = rotation.z;
+                keyframe.rotation[3] = rotation.w;
+                keyframe.scale[0] = keyframe.scale[1] = keyframe.scale[2] = 1.0f;
+                clip->addKeyframe(bone, keyframe);
+            }
+        }
+        for (float time = 0.25f; time < clip->getDuration(); time += 0.5f) {
+            clip->addEvent({time, "footstep", nullptr});
+        }
+        return clip;
+    }
+
+    struct Crowd {
+        std::vector<std::unique_ptr<GameObject>> objects;
+        std::vector<SkeletalAnimation*> animations;
+        std::vector<AdvancedAnimationController*> controllers;
+        std::vector<InverseKinematics*> solvers;
+        std::vector<std::pair<int, float>> footsteps;   // Character and its clip time
+        bool offMainThread = false;
+    };
+
+    void buildCrowd(Crowd& crowd, std::thread::id mainThread) {
+        for (int i = 0; i < kCharacterCount; ++i) {
+            std::unique_ptr<GameObject> object(new GameObject("character" + std::to_string(i)));
+            SkeletalAnimation* animation = object->addComponent<SkeletalAnimation>();
+            for (int bone = 0; bone < kBoneCount; ++bone) {
+                SkeletalAnimation::Bone entry;
+                entry.name = "bone" + std::to_string(bone);
+                entry.id = bone;
+                entry.parentId = bone < 8 ? bone - 1 : (bone < 24 ? 4 + (bone - 8) / 4 : bone - 1);
+                entry.offsetMatrix = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -0.1f * bone, 0.0f));
+                entry.finalTransformation = glm::mat4(1.0f);
+                animation->addBone(entry);
+            }
+            animation->addAnimationClip(makeClip("walk", 2.0f, i * 0.1f));
+            animation->addAnimationClip(makeClip("run", 5.0f, i * 0.1f));
+            animation->setAnimationEventCallback("footstep", [&crowd, animation, i, mainThread]() {
+                crowd.footsteps.push_back(std::make_pair(i, animation->getCurrentTime()));
+                if (std::this_thread::get_id() != mainThread) crowd.offMainThread = true;
+            });
+            animation->initialize();
+
+            AdvancedAnimationController* controller = object->addComponent<AdvancedAnimationController>();
+            controller->initialize();
+            controller->addState({"Walk", "walk", true, 1.0f});
+            controller->addState({"Run", "run", true, 1.0f});
+            controller->addTransition({"Default", "Walk", 0.0f, nullptr});
+            controller->addTransition({"Walk", "Run", 0.3f, nullptr});
+            controller->addTransition({"Run", "Walk", 0.3f, nullptr});
+
+            InverseKinematics* ik = object->addComponent<InverseKinematics>();
+            ik->initialize();
+            InverseKinematics::IKChain chain;
+            for (int bone = 36; bone < 39; ++bone) {
+                chain.joints.push_back({bone, 0.0f, 1.0f, glm::vec3(1.0f, 0.0f, 0.0f)});
+            }
+            chain.effectorBoneId = 39;
+            chain.targetBoneId = -1;
+            chain.poleBoneId = -1;
+            ik->addIKChain(chain);
+            ik->setTargetPosition(0, glm::vec3(0.3f, 0.5f, 0.2f));
+
+            crowd.animations.push_back(animation);
+            crowd.controllers.push_back(controller);
+            crowd.solvers.push_back(ik);
+            crowd.objects.push_back(std::move(object));
+        }
+    }
+
+    // Gameplay input, identical for every crowd
+    void drive(Crowd& crowd, int frame) {
+        for (int i = 0; i < kCharacterCount; ++i) {
+            if (frame == 0) {
+                crowd.controllers[i]->setState("Walk");
+            } else if ((frame + i * 7) % 90 == 0) {
+                crowd.controllers[i]->setState(crowd.controllers[i]->getCurrentState() == "Run" ? "Walk" : "Run");
+            }
+        }
+    }
+
+    // The order the system uses: state machine, pose, then IK
+    void updateComponents(Crowd& crowd, float deltaTime) {
+        for (int i = 0; i < kCharacterCount; ++i) {
+            crowd.controllers[i]->update(deltaTime);
+            crowd.animations[i]->update(deltaTime);
+            crowd.solvers[i]->update(deltaTime);
+        }
+    }
+
+    bool arenaMatches(const AnimationSystem& system, const std::vector<AnimatorId>& animators, const Crowd& reference) {
+        for (int i = 0; i < kCharacterCount; ++i) {
+            int boneCount = 0;
+            const glm::mat4* matrices = system.getSkinningMatrices(animators[i], boneCount);
+            const std::vector<glm::mat4>& expected = reference.animations[i]->getSkinningMatrices();
+            if (boneCount != static_cast<int>(expected.size())) return false;
+            if (boneCount > 0 && std::memcmp(matrices, expected.data(), boneCount * sizeof(glm::mat4)) != 0) return false;
+        }
+        return true;
+    }
+}
+
+int main() {
+    std::cout << "Animation System Benchmark" << std::endl;
+    const std::thread::id mainThread = std::this_thread::get_id();
+    bool allCorrect = true;
+
+    unsigned int workers = std::max(2u, std::thread::hardware_concurrency() - 1);
+    std::unique_ptr<JobSystem> jobSystem = JobSystem::create(workers);
+
+    Crowd classic, serial, parallel;
+    buildCrowd(classic, mainThread);
+    buildCrowd(serial, mainThread);
+    buildCrowd(parallel, mainThread);
+
+    std::unique_ptr<AnimationSystem> serialSystem = AnimationSystem::create();
+    std::unique_ptr<AnimationSystem> parallelSystem = AnimationSystem::create();
+    parallelSystem->setJobSystem(jobSystem.get());
+    std::vector<AnimatorId> serialIds, parallelIds;
+    for (int i = 0; i < kCharacterCount; ++i) {
+        serialIds.push_back(serialSystem->addAnimator(serial.objects[i].get()));
+        parallelIds.push_back(parallelSystem->addAnimator(parallel.objects[i].get()));
+    }
+
+    bool identical = true, untouched = true;
+    double classicMs = 0.0, serialMs = 0.0, parallelMs = 0.0;
+    int batches = 0;
+    std::vector<glm::mat4> published;
+    for (int frame = 0; frame < kFrames; ++frame) {
+        drive(classic, frame);
+        drive(serial, frame);
+        drive(parallel, frame);
+
+        auto start = std::chrono::steady_clock::now();
+        updateComponents(classic, kDeltaTime);
+        classicMs += elapsedMs(start);
+
+        start = std::chrono::steady_clock::now();
+        serialSystem->update(kDeltaTime);
+        serialMs += elapsedMs(start);
+
+        // Keep a copy of what rendering would be reading while the next frame runs
+        const std::vector<glm::mat4>& front = parallelSystem->getPoseArena();
+        published.assign(front.begin(), front.end());
+        const glm::mat4* frontData = front.data();
+        size_t frontSize = front.size();
+
+        start = std::chrono::steady_clock::now();
+        parallelSystem->update(kDeltaTime);
+        parallelMs += elapsedMs(start);
+        batches = parallelSystem->getStats().batches;
+
+        if (frame > 0) {
+            untouched = untouched && frontSize == published.size() && frontData != parallelSystem->getPoseArena().data() &&
+                        std::memcmp(frontData, published.data(), frontSize * sizeof(glm::mat4)) == 0;
+        }
+        identical = identical && arenaMatches(*serialSystem, serialIds, classic) && arenaMatches(*parallelSystem, parallelIds, classic);
+    }
+
+    std::cout << "Serial and parallel arenas match component updates: " << (identical ? "ok" : "FAILED") << std::endl;
+    std::cout << "Published arena untouched by the next update: " << (untouched ? "ok" : "FAILED") << std::endl;
+    bool ordered = !classic.footsteps.empty() && serial.footsteps == classic.footsteps && parallel.footsteps == classic.footsteps;
+    std::cout << "Footsteps fire in the same order (" << classic.footsteps.size() << " events): " << (ordered ? "ok" : "FAILED")
+              << std::endl;
+    bool mainThreadOnly = !classic.offMainThread && !serial.offMainThread && !parallel.offMainThread;
+    std::cout << "Event callbacks run on the main thread: " << (mainThreadOnly ? "ok" : "FAILED") << std::endl;
+
+    // Registered components leave their own update() alone
+    float time = serial.animations[0]->getCurrentTime();
+    serial.animations[0]->update(kDeltaTime);
+    bool handedOver = serial.animations[0]->getCurrentTime() == time && serial.animations[0]->isUpdatedBySystem() &&
+                      serial.controllers[0]->isUpdatedBySystem() && serial.solvers[0]->isUpdatedBySystem();
+    std::cout << "Registered components defer to the system: " << (handedOver ? "ok" : "FAILED") << std::endl;
+
+    // Removing an animator hands the components back and drops it from the arena
+    parallelSystem->removeAnimator(parallelIds[0]);
+    parallelSystem->update(kDeltaTime);
+    int boneCount = -1;
+    bool removed = parallelSystem->getSkinningMatrices(parallelIds[0], boneCount) == nullptr && boneCount == 0 &&
+                   !parallel.animations[0]->isUpdatedBySystem() && parallelSystem->getAnimatorCount() == kCharacterCount - 1;
+    std::cout << "Removed animators return to component updates: " << (removed ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && handedOver && identical && untouched && ordered && mainThreadOnly && removed;
+
+    const AnimationSystemStats& stats = parallelSystem->getStats();
+    std::cout << kCharacterCount << " characters per frame: components " << classicMs / kFrames << " ms, system serial "
+              << serialMs / kFrames << " ms, system on " << workers << " workers " << parallelMs / kFrames << " ms in "
+              << batches << " batches (" << serialMs / parallelMs << "x)" << std::endl;
+    std::cout << "Last frame: evaluate " << stats.evaluateMs << " ms, publish " << stats.publishMs << " ms for "
+              << stats.bonesTotal << " bones, events " << stats.eventMs << " ms" << std::endl;
+
+    std::cout << (allCorrect ? "Animation system benchmark passed!" : "Animation system benchmark FAILED!") << std::endl;
+    return allCorrect ? 0 : 1;
+}
@@ -0,0 +1,403 @@
+#include "../include/CompiledBehaviorTree.h"
+#include "../include/BehaviorTree.h"
+#include "../include/AdvancedBehaviorTree.h"
+#include "../include/JobSystem.h"
+#include "../include/TimingUtils.h"
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace Sparky;
+
+// Checks the compiled runtime's node semantics (resuming, reactive
+// selectors, repeaters, timers, parallel nodes, compile errors), then ticks
+// 2000 guards on one shared tree against the same logic built from
+// BehaviorTree nodes with a string-keyed Blackboard per guard.
+
+namespace {
+    const int kGuardCount = 2000;
+    const int kTicks = 300;
+    const float kTimeStep = 1.0f / 30.0f;
+
+    // Small probes for the semantic checks: each counts its calls
+    struct Probe {
+        int calls[4];
+        int runFor;     // Ticks the RUNNING task takes before succeeding
+    };
+
+    NodeStatus countSuccess(BehaviorTaskContext& context) {
+        ++static_cast<Probe*>(context.agentData)->calls[0];
+        return NodeStatus::SUCCESS;
+    }
+
+    NodeStatus runThenSucceed(BehaviorTaskContext& context) {
+        Probe* probe = static_cast<Probe*>(context.agentData);
+        return ++probe->calls[1] % probe->runFor == 0 ? NodeStatus::SUCCESS : NodeStatus::RUNNING;
+    }
+
+    NodeStatus alwaysRunning(BehaviorTaskContext& context) {
+        ++static_cast<Probe*>(context.agentData)->calls[2];
+        return NodeStatus::RUNNING;
+    }
+
+    NodeStatus countFailure(BehaviorTaskContext& context) {
+        ++static_cast<Probe*>(context.agentData)->calls[3];
+        return NodeStatus::FAILURE;
+    }
+
+    void registerProbes(BehaviorTreeCompiler& compiler) {
+        compiler.registerTask("Count", countSuccess);
+        compiler.registerTask("RunThenSucceed", runThenSucceed);
+        compiler.registerTask("Running", alwaysRunning);
+        compiler.registerTask("Fail", countFailure);
+    }
+
+    bool checkSemantics() {
+        bool ok = true;
+
+        // Sequence resumes at its running child instead of re-running the first
+        {
+            BehaviorTreeCompiler compiler;
+            registerProbes(compiler);
+            compiler.sequence().task("Count").task("RunThenSucceed").end();
+            BehaviorTreeBatch batch(compiler.compile());
+            Probe probe = {{0, 0, 0, 0}, 5};
+            batch.addAgent(&probe);
+            for (int tick = 0; tick < 5; ++tick) batch.tickAgent(0, kTimeStep);
+            bool resumed = probe.calls[0] == 1 && probe.calls[1] == 5 && batch.getLastStatus(0) == NodeStatus::SUCCESS;
+            std::cout << "Sequence resumes at the running child: " << (resumed ? "ok" : "FAILED") << std::endl;
+            ok = ok && resumed;
+        }
+
+        // Reactive selector drops a running branch when a higher one passes
+        {
+            BehaviorTreeCompiler compiler;
+            registerProbes(compiler);
+            compiler.reactiveSelector()
+                        .sequence().checkBool("alert").task("Count").end()
+                        .task("Running")
+                    .end();
+            std::shared_ptr<const CompiledBehaviorTree> tree = compiler.compile();
+            BehaviorTreeBatch batch(tree);
+            Probe probe = {{0, 0, 0, 0}, 1};
+            batch.addAgent(&probe);
+            BlackboardKey alert = tree->getLayout().find("alert");
+            for (int tick = 0; tick < 3; ++tick) batch.tickAgent(0, kTimeStep);
+            batch.getBlackboard(0).setBool(alert, true);
+            batch.tickAgent(0, kTimeStep);
+            bool interrupted = probe.calls[2] == 3 && probe.calls[0] == 1 && batch.getLastStatus(0) == NodeStatus::SUCCESS;
+            std::cout << "Reactive selector interrupts a running branch: " << (interrupted ? "ok" : "FAILED") << std::endl;
+            ok = ok && interrupted;
+        }
+
+        // Blackboard checks ahead of a running task stop it once they fail; tasks ahead are not re-run
+        {
+            BehaviorTreeCompiler compiler;
+            registerProbes(compiler);
+            compiler.selector()
+                        .sequence().checkBool("alert").task("Count").task("Running").end()
+                        .task("Fail")
+                    .end();
+            std::shared_ptr<const CompiledBehaviorTree> tree = compiler.compile();
+            BehaviorTreeBatch batch(tree);
+            Probe probe = {{0, 0, 0, 0}, 1};
+            batch.addAgent(&probe);
+            BlackboardKey alert = tree->getLayout().find("alert");
+            batch.getBlackboard(0).setBool(alert, true);
+            for (int tick = 0; tick < 3; ++tick) batch.tickAgent(0, kTimeStep);
+            batch.getBlackboard(0).setBool(alert, false);
+            batch.tickAgent(0, kTimeStep);
+            bool guarded = probe.calls[0] == 1 && probe.calls[2] == 3 && probe.calls[3] == 1 &&
+                           batch.getLastStatus(0) == NodeStatus::FAILURE;
+            std::cout << "Blackboard checks guard a running branch: " << (guarded ? "ok" : "FAILED") << std::endl;
+            ok = ok && guarded;
+        }
+
+        // Repeater runs one iteration per tick; timer keeps ticking its child until time is up
+        {
+            BehaviorTreeCompiler compiler;
+            registerProbes(compiler);
+            compiler.sequence().repeater(3).task("Count").end().timer(0.1f).task("Fail").end().end();
+            BehaviorTreeBatch batch(compiler.compile());
+            Probe probe = {{0, 0, 0, 0}, 1};
+            batch.addAgent(&probe);
+            int ticks = 0;
+            do {
+                batch.tickAgent(0, 0.04f);
+                ++ticks;
+            } while (batch.getLastStatus(0) == NodeStatus::RUNNING && ticks < 100);
+            bool decorated = probe.calls[0] == 3 && probe.calls[3] == 3 && ticks == 5 &&
+                             batch.getLastStatus(0) == NodeStatus::SUCCESS;
+            std::cout << "Repeater and timer step once per tick: " << (decorated ? "ok" : "FAILED") << std::endl;
+            ok = ok && decorated;
+        }
+
+        // Parallel children resume independently; REQUIRE_ALL waits for the slowest
+        {
+            BehaviorTreeCompiler compiler;
+            registerProbes(compiler);
+            compiler.parallel(ParallelPolicy::REQUIRE_ALL)
+                        .sequence().task("Count").task("RunThenSucceed").end()
+                        .repeater(4).task("Count").end()
+                    .end();
+            BehaviorTreeBatch batch(compiler.compile());
+            Probe probe = {{0, 0, 0, 0}, 6};
+            batch.addAgent(&probe);
+            int ticks = 0;
+            do {
+                batch.tickAgent(0, kTimeStep);
+                ++ticks;
+            } while (batch.getLastStatus(0) == NodeStatus::RUNNING && ticks < 100);
+            bool parallel = ticks == 6 && probe.calls[0] == 5 && probe.calls[1] == 6;
+            std::cout << "Parallel children keep their own resume points: " << (parallel ? "ok" : "FAILED") << std::endl;
+            ok = ok && parallel;
+        }
+
+        // Malformed trees are rejected
+        {
+            BehaviorTreeCompiler missingTask;
+            missingTask.sequence().task("Nope").end();
+            BehaviorTreeCompiler openNode;
+            openNode.sequence().checkBool("a");
+            BehaviorTreeCompiler badDecorator;
+            badDecorator.inverter().checkBool("a").checkBool("b").end();
+            BehaviorTreeCompiler keyClash;
+            keyClash.sequence().checkBool("a").checkFloatLess("a", 1.0f).end();
+            bool rejected = !missingTask.compile() && !openNode.compile() && !badDecorator.compile() && !keyClash.compile();
+            std::cout << "Malformed trees are rejected: " << (rejected ? "ok" : "FAILED") << std::endl;
+            ok = ok && rejected;
+        }
+        return ok;
+    }
+
+    // Guard world state, shared by both runtimes
+    struct Guard {
+        float health;
+        float enemyDistance;
+        bool enemyVisible;
+        float patrolLeft;
+        int attacks;
+        int patrols;
+        uint32_t seed;
+    };
+
+    // Cheap per-guard noise so both runtimes see the same world
+    float nextNoise(Guard& guard) {
+        guard.seed = guard.seed * 1664525u + 1013904223u;
+        return static_cast<float>(guard.seed >> 8) / 16777216.0f;
+    }
+
+    // Enemies come and go every few seconds; returns true when one is spotted
+    bool senseWorld(Guard& guard) {
+        if (nextNoise(guard) >= 0.02f) return false;
+        guard.enemyVisible = !guard.enemyVisible;
+        if (!guard.enemyVisible) return false;
+        guard.enemyDistance = 3.0f + 10.0f * nextNoise(guard);
+        return true;
+    }
+
+    struct GuardKeys {
+        BlackboardKey health;
+        BlackboardKey enemyVisible;
+        BlackboardKey enemyDistance;
+        BlackboardKey patrolLeft;
+    };
+    GuardKeys guardKeys;
+
+    NodeStatus flee(BehaviorTaskContext& context) {
+        context.blackboard.setFloat(guardKeys.health, context.blackboard.getFloat(guardKeys.health) + 1.0f);
+        return NodeStatus::SUCCESS;
+    }
+
+    NodeStatus attack(BehaviorTaskContext& context) {
+        ++static_cast<Guard*>(context.agentData)->attacks;
+        return NodeStatus::SUCCESS;
+    }
+
+    NodeStatus chase(BehaviorTaskContext& context) {
+        float distance = context.blackboard.getFloat(guardKeys.enemyDistance) - 4.0f * context.deltaTime;
+        context.blackboard.setFloat(guardKeys.enemyDistance, distance);
+        return NodeStatus::RUNNING;
+    }
+
+    NodeStatus pickPatrolPoint(BehaviorTaskContext& context) {
+        context.blackboard.setFloat(guardKeys.patrolLeft, 0.5f);
+        return NodeStatus::SUCCESS;
+    }
+
+    NodeStatus moveToPatrolPoint(BehaviorTaskContext& context) {
+        float left = context.blackboard.getFloat(guardKeys.patrolLeft) - context.deltaTime;
+        context.blackboard.setFloat(guardKeys.patrolLeft, left);
+        if (left > 0.0f) return NodeStatus::RUNNING;
+        ++static_cast<Guard*>(context.agentData)->patrols;
+        return NodeStatus::SUCCESS;
+    }
+
+    std::shared_ptr<const CompiledBehaviorTree> compileGuardTree() {
+        BehaviorTreeCompiler compiler;
+        compiler.registerTask("Flee", flee);
+        compiler.registerTask("Attack", attack);
+        compiler.registerTask("Chase", chase);
+        compiler.registerTask("PickPatrolPoint", pickPatrolPoint);
+        compiler.registerTask("MoveToPatrolPoint", moveToPatrolPoint);
+        compiler.reactiveSelector()
+                    .sequence().checkFloatLess("health", 25.0f).task("Flee").end()
+                    .sequence().checkBool("enemyVisible").checkFloatLess("enemyDistance", 2.0f).task("Attack").end()
+                    .sequence().checkBool("enemyVisible").task("Chase").end()
+                    .sequence().task("PickPatrolPoint").task("MoveToPatrolPoint").end()
+                .end();
+        // Only the tasks use this one, so the tree's nodes never declare it
+        compiler.declareKey("patrolLeft", BlackboardType::FLOAT);
+        std::shared_ptr<const CompiledBehaviorTree> tree = compiler.compile();
+        guardKeys.health = tree->getLayout().find("health");
+        guardKeys.enemyVisible = tree->getLayout().find("enemyVisible");
+        guardKeys.enemyDistance = tree->getLayout().find("enemyDistance");
+        guardKeys.patrolLeft = tree->getLayout().find("patrolLeft");
+        return tree;
+    }
+
+    // The same guard built from BehaviorTree nodes, one tree and Blackboard per guard
+    std::unique_ptr<BehaviorTree> buildClassicGuard(Guard& guard, Blackboard& blackboard) {
+        Blackboard* bb = &blackboard;
+        Guard* self = &guard;
+        auto flee = std::make_unique<SequenceNode>();
+        flee->addChild(std::make_unique<ConditionNode>([bb]() { return bb->getFloat("health") < 25.0f; }));
+        flee->addChild(std::make_unique<ActionNode>([bb](float) {
+            bb->setFloat("health", bb->getFloat("health") + 1.0f);
+            return NodeStatus::SUCCESS;
+        }));
+        auto attack = std::make_unique<SequenceNode>();
+        attack->addChild(std::make_unique<ConditionNode>([bb]() { return bb->getBool("enemyVisible"); }));
+        attack->addChild(std::make_unique<ConditionNode>([bb]() { return bb->getFloat("enemyDistance") < 2.0f; }));
+        attack->addChild(std::make_unique<ActionNode>([self](float) {
+            ++self->attacks;
+            return NodeStatus::SUCCESS;
+        }));
+        auto chase = std::make_unique<SequenceNode>();
+        chase->addChild(std::make_unique<ConditionNode>([bb]() { return bb->getBool("enemyVisible"); }));
+        chase->addChild(std::make_unique<ActionNode>([bb](float deltaTime) {
+            bb->setFloat("enemyDistance", bb->getFloat("enemyDistance") - 4.0f * deltaTime);
+            return NodeStatus::RUNNING;
+        }));
+        auto patrol = std::make_unique<SequenceNode>();
+        patrol->addChild(std::make_unique<ActionNode>([bb](float) {
+            if (bb->getFloat("patrolLeft") <= 0.0f) bb->setFloat("patrolLeft", 0.5f);
+            return NodeStatus::SUCCESS;
+        }));
+        patrol->addChild(std::make_unique<ActionNode>([bb, self](float deltaTime) {
+            float left = bb->getFloat("patrolLeft") - deltaTime;
+            bb->setFloat("patrolLeft", left);
+            if (left > 0.0f) return NodeStatus::RUNNING;
+            ++self->patrols;
+            return NodeStatus::SUCCESS;
+        }));
+        auto root = std::make_unique<SelectorNode>();
+        root->addChild(std::move(flee));
+        root->addChild(std::move(attack));
+        root->addChild(std::move(chase));
+        root->addChild(std::move(patrol));
+        std::unique_ptr<BehaviorTree> tree = std::make_unique<BehaviorTree>();
+        tree->setRootNode(std::move(root));
+        return tree;
+    }
+
+    std::vector<Guard> makeGuards() {
+        std::vector<Guard> guards(kGuardCount);
+        for (int i = 0; i < kGuardCount; ++i) {
+            guards[i] = {100.0f - static_cast<float>(i % 100), 20.0f, false, 0.0f, 0, 0, static_cast<uint32_t>(i * 7919 + 1)};
+        }
+        return guards;
+    }
+
+    double runCompiled(std::vector<Guard>& guards, JobSystem* jobSystem) {
+        BehaviorTreeBatch batch(compileGuardTree());
+        batch.setJobSystem(jobSystem);
+        for (Guard& guard : guards) {
+            int agent = batch.addAgent(&guard);
+            FlatBlackboard blackboard = batch.getBlackboard(agent);
+            blackboard.setFloat(guardKeys.health, guard.health);
+            blackboard.setFloat(guardKeys.enemyDistance, guard.enemyDistance);
+        }
+        double totalMs = 0.0;
+        for (int tick = 0; tick < kTicks; ++tick) {
+            for (int agent = 0; agent < kGuardCount; ++agent) {
+                bool spotted = senseWorld(guards[agent]);
+                FlatBlackboard blackboard = batch.getBlackboard(agent);
+                blackboard.setBool(guardKeys.enemyVisible, guards[agent].enemyVisible);
+                if (spotted) blackboard.setFloat(guardKeys.enemyDistance, guards[agent].enemyDistance);
+            }
+            auto start = std::chrono::steady_clock::now();
+            batch.tick(kTimeStep);
+            totalMs += elapsedMs(start);
+        }
+        for (int agent = 0; agent < kGuardCount; ++agent) {
+            guards[agent].health = batch.getBlackboard(agent).getFloat(guardKeys.health);
+        }
+        return totalMs;
+    }
+
+    double runClassic(std::vector<Guard>& guards) {
+        std::vector<Blackboard> blackboards(kGuardCount);
+        std::vector<std::unique_ptr<BehaviorTree>> trees;
+        for (int i = 0; i < kGuardCount; ++i) {
+            blackboards[i].setFloat("health", guards[i].health);
+            blackboards[i].setFloat("enemyDistance", guards[i].enemyDistance);
+            trees.push_back(buildClassicGuard(guards[i], blackboards[i]));
+        }
+        double totalMs = 0.0;
+        for (int tick = 0; tick < kTicks; ++tick) {
+            for (int i = 0; i < kGuardCount; ++i) {
+                bool spotted = senseWorld(guards[i]);
+                blackboards[i].setBool("enemyVisible", guards[i].enemyVisible);
+                if (spotted) blackboards[i].setFloat("enemyDistance", guards[i].enemyDistance);
+            }
+            auto start = std::chrono::steady_clock::now();
+            for (std::unique_ptr<BehaviorTree>& tree : trees) {
+                tree->update(kTimeStep);
+            }
+            totalMs += elapsedMs(start);
+        }
+        return totalMs;
+    }
+}
+
+int main() {
+    std::cout << "Behavior Tree Benchmark" << std::endl;
+    bool allCorrect = checkSemantics();
+    std::unique_ptr<JobSystem> jobSystem = JobSystem::create(4, 0);
+
+    std::vector<Guard> serialGuards = makeGuards();
+    std::vector<Guard> parallelGuards = makeGuards();
+    std::vector<Guard> classicGuards = makeGuards();
+    double compiledMs = runCompiled(serialGuards, nullptr);
+    double parallelMs = runCompiled(parallelGuards, jobSystem.get());
+    double classicMs = runClassic(classicGuards);
+
+    bool parallelMatches = true;
+    int attacks = 0, patrols = 0, classicAttacks = 0, classicPatrols = 0;
+    for (int i = 0; i < kGuardCount; ++i) {
+        parallelMatches = parallelMatches && serialGuards[i].attacks == parallelGuards[i].attacks &&
+                          serialGuards[i].patrols == parallelGuards[i].patrols &&
+                          serialGuards[i].health == parallelGuards[i].health;
+        attacks += serialGuards[i].attacks;
+        patrols += serialGuards[i].patrols;
+        classicAttacks += classicGuards[i].attacks;
+        classicPatrols += classicGuards[i].patrols;
+    }
+    std::cout << "Parallel batch matches serial: " << (parallelMatches ? "ok" : "FAILED") << std::endl;
+    bool busy = attacks > 0 && patrols > 0;
+    std::cout << "Guards attack and patrol: " << (busy ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && parallelMatches && busy;
+
+    double ticksPerGuard = static_cast<double>(kTicks) * kGuardCount;
+    std::cout << kGuardCount << " guards x " << kTicks << " ticks: compiled " << compiledMs << " ms ("
+              << compiledMs * 1e6 / ticksPerGuard << " ns/tick), " << parallelMs << " ms on "
+              << jobSystem->getWorkerCount() << " workers; BehaviorTree + Blackboard " << classicMs << " ms ("
+              << classicMs * 1e6 / ticksPerGuard << " ns/tick)" << std::endl;
+    std::cout << "Compiled: " << attacks << " attacks, " << patrols << " patrols; classic: " << classicAttacks
+              << " attacks, " << classicPatrols << " patrols" << std::endl;
+
+    std::cout << (allCorrect ? "Behavior tree benchmark passed!" : "Behavior tree benchmark FAILED!") << std::endl;
+    return allCorrect ? 0 : 1;
+}
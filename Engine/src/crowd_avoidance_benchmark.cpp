@@ -0,0 +1,208 @@
+#include "../include/CrowdAvoidance.h"
+#include "../include/JobSystem.h"
+#include "../include/TimingUtils.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace Sparky;
+
+// 5000 agents cross a square towards random goals. Compares overlaps with
+// and without ORCA avoidance, checks grid neighbours against a brute force
+// search and parallel steps against serial ones, and times a step against
+// the O(N^2) neighbour search it replaces.
+
+namespace {
+    const int kAgentCount = 5000;
+    const float kArea = 200.0f;
+    const float kRadius = 0.5f;
+    const float kSpeed = 1.5f;
+    const float kTimeStep = 0.1f;
+
+    struct Scenario {
+        std::vector<glm::vec3> positions;
+        std::vector<glm::vec3> goals;
+    };
+
+    // Jittered lattice starts, goals 60-100 units away in any direction
+    Scenario buildScenario(std::mt19937& rng) {
+        const int side = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(kAgentCount))));
+        const float spacing = kArea / side;
+        std::uniform_real_distribution<float> jitter(-0.25f * spacing, 0.25f * spacing);
+        std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+        std::uniform_real_distribution<float> reach(60.0f, 100.0f);
+        Scenario scenario;
+        for (int i = 0; i < kAgentCount; ++i) {
+            glm::vec3 position((i % side + 0.5f) * spacing + jitter(rng), 0.0f, (i / side + 0.5f) * spacing + jitter(rng));
+            glm::vec3 goal;
+            do {
+                float heading = angle(rng);
+                goal = position + reach(rng) * glm::vec3(std::cos(heading), 0.0f, std::sin(heading));
+            } while (goal.x < 0.0f || goal.x > kArea || goal.z < 0.0f || goal.z > kArea);
+            scenario.positions.push_back(position);
+            scenario.goals.push_back(goal);
+        }
+        return scenario;
+    }
+
+    glm::vec3 preferredVelocity(const glm::vec3& position, const glm::vec3& goal) {
+        glm::vec3 toGoal = goal - position;
+        float distance = glm::length(toGoal);
+        if (distance < 0.05f) return glm::vec3(0.0f);
+        return toGoal * (std::min(distance / kTimeStep, kSpeed) / distance);
+    }
+
+    // Pairs closer than their combined radius, minus a small tolerance
+    int countOverlaps(CrowdAvoidance& crowd, const std::vector<glm::vec3>& positions, std::vector<CrowdAgentId>& scratch) {
+        int overlaps = 0;
+        for (int agent = 0; agent < static_cast<int>(positions.size()); ++agent) {
+            crowd.findNeighbors(agent, scratch);
+            for (CrowdAgentId other : scratch) {
+                if (other > agent && glm::distance(positions[agent], positions[other]) < 2.0f * kRadius - 0.05f) {
+                    ++overlaps;
+                }
+            }
+        }
+        return overlaps;
+    }
+
+    struct RunResult {
+        int worstOverlaps;
+        int arrived;
+        double averageStepMs;
+        int fallbackSolves;
+    };
+
+    RunResult run(const Scenario& scenario, JobSystem* jobSystem, bool avoid, int steps) {
+        CrowdAvoidanceSettings settings;
+        std::unique_ptr<CrowdAvoidance> crowd = CrowdAvoidance::create(settings);
+        crowd->setJobSystem(jobSystem);
+        std::vector<glm::vec3> positions = scenario.positions;
+        for (const glm::vec3& position : positions) {
+            crowd->addAgent(position, kRadius, kSpeed);
+        }
+
+        RunResult result = {0, 0, 0.0, 0};
+        std::vector<glm::vec3> velocities(positions.size(), glm::vec3(0.0f));
+        std::vector<CrowdAgentId> scratch;
+        double totalMs = 0.0;
+        for (int step = 0; step < steps; ++step) {
+            for (int agent = 0; agent < kAgentCount; ++agent) {
+                crowd->setAgentState(agent, positions[agent], velocities[agent]);
+                crowd->setPreferredVelocity(agent, preferredVelocity(positions[agent], scenario.goals[agent]));
+            }
+            auto start = std::chrono::steady_clock::now();
+            crowd->step(kTimeStep);
+            totalMs += elapsedMs(start);
+            result.fallbackSolves += crowd->getStats().fallbackSolves;
+
+            for (int agent = 0; agent < kAgentCount; ++agent) {
+                velocities[agent] = avoid ? crowd->getAvoidanceVelocity(agent)
+                                          : preferredVelocity(positions[agent], scenario.goals[agent]);
+                positions[agent] += velocities[agent] * kTimeStep;
+            }
+            if (step % 10 == 0) {
+                result.worstOverlaps = std::max(result.worstOverlaps, countOverlaps(*crowd, positions, scratch));
+            }
+        }
+        for (int agent = 0; agent < kAgentCount; ++agent) {
+            if (glm::distance(positions[agent], scenario.goals[agent]) < 2.0f) ++result.arrived;
+        }
+        result.averageStepMs = totalMs / steps;
+        return result;
+    }
+}
+
+int main() {
+    std::cout << "Crowd Avoidance Benchmark" << std::endl;
+    std::mt19937 rng(5);
+    bool allCorrect = true;
+    Scenario scenario = buildScenario(rng);
+    std::unique_ptr<JobSystem> jobSystem = JobSystem::create(4, 0);
+
+    // Grid neighbours against brute force
+    CrowdAvoidance probe;
+    for (const glm::vec3& position : scenario.positions) {
+        probe.addAgent(position, kRadius, kSpeed);
+    }
+    probe.step(kTimeStep);
+    CrowdAvoidanceSettings defaults;
+    bool neighborsMatch = true;
+    std::vector<CrowdAgentId> found;
+    for (int agent = 0; agent < kAgentCount && neighborsMatch; agent += 37) {
+        std::vector<std::pair<float, int>> expected;
+        for (int other = 0; other < kAgentCount; ++other) {
+            glm::vec3 offset = scenario.positions[other] - scenario.positions[agent];
+            float distanceSq = offset.x * offset.x + offset.z * offset.z;
+            if (other != agent && distanceSq < defaults.neighborRadius * defaults.neighborRadius) {
+                expected.push_back(std::make_pair(distanceSq, other));
+            }
+        }
+        std::sort(expected.begin(), expected.end());
+        expected.resize(std::min<size_t>(expected.size(), defaults.maxNeighbors));
+        probe.findNeighbors(agent, found);
+        neighborsMatch = found.size() == expected.size();
+        for (size_t i = 0; i < found.size() && neighborsMatch; ++i) {
+            neighborsMatch = found[i] == expected[i].second;
+        }
+    }
+    std::cout << "Grid neighbours match brute force: " << (neighborsMatch ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && neighborsMatch;
+
+    // Brute-force neighbour search alone, for scale
+    auto start = std::chrono::steady_clock::now();
+    size_t bruteFound = 0;
+    for (int agent = 0; agent < kAgentCount; ++agent) {
+        for (int other = 0; other < kAgentCount; ++other) {
+            glm::vec3 offset = scenario.positions[other] - scenario.positions[agent];
+            if (other != agent && offset.x * offset.x + offset.z * offset.z < defaults.neighborRadius * defaults.neighborRadius) {
+                ++bruteFound;
+            }
+        }
+    }
+    double bruteMs = elapsedMs(start);
+
+    // Parallel steps give the same velocities as serial ones
+    CrowdAvoidance parallel;
+    parallel.setJobSystem(jobSystem.get());
+    for (const glm::vec3& position : scenario.positions) {
+        parallel.addAgent(position, kRadius, kSpeed);
+    }
+    bool parallelMatches = true;
+    for (int agent = 0; agent < kAgentCount; ++agent) {
+        glm::vec3 preferred = preferredVelocity(scenario.positions[agent], scenario.goals[agent]);
+        probe.setPreferredVelocity(agent, preferred);
+        parallel.setPreferredVelocity(agent, preferred);
+    }
+    probe.step(kTimeStep);
+    parallel.step(kTimeStep);
+    for (int agent = 0; agent < kAgentCount && parallelMatches; ++agent) {
+        parallelMatches = probe.getAvoidanceVelocity(agent) == parallel.getAvoidanceVelocity(agent);
+    }
+    std::cout << "Parallel step matches serial: " << (parallelMatches ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && parallelMatches;
+
+    // Everyone crosses at once
+    const int steps = 800;
+    RunResult ignoring = run(scenario, jobSystem.get(), false, steps);
+    RunResult avoiding = run(scenario, jobSystem.get(), true, steps);
+    std::cout << "Without avoidance: worst overlapping pairs " << ignoring.worstOverlaps << ", arrived "
+              << ignoring.arrived << "/" << kAgentCount << std::endl;
+    std::cout << "With ORCA: worst overlapping pairs " << avoiding.worstOverlaps << ", arrived " << avoiding.arrived
+              << "/" << kAgentCount << ", infeasible solves " << avoiding.fallbackSolves << std::endl;
+    bool avoided = ignoring.worstOverlaps > 100 && avoiding.worstOverlaps * 20 < ignoring.worstOverlaps;
+    bool arrived = avoiding.arrived >= kAgentCount * 95 / 100;
+    std::cout << "Crowd crosses without piling up: " << (avoided ? "ok" : "FAILED") << std::endl;
+    std::cout << "Agents reach their goals: " << (arrived ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && avoided && arrived;
+
+    std::cout << kAgentCount << " agents: step avg " << avoiding.averageStepMs << " ms on "
+              << jobSystem->getWorkerCount() << " workers; brute-force neighbour search alone " << bruteMs << " ms ("
+              << bruteFound << " pairs)" << std::endl;
+
+    std::cout << (allCorrect ? "Crowd avoidance benchmark passed!" : "Crowd avoidance benchmark FAILED!") << std::endl;
+    return allCorrect ? 0 : 1;
+}
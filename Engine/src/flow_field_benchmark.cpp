@@ -0,0 +1,330 @@
+#include "../include/FlowField.h"
+#include "../include/AdvancedAI.h"
+#include "../include/AIComponent.h"
+#include "../include/GameObject.h"
+#include "../include/JobSystem.h"
+#include "../include/TimingUtils.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <queue>
+#include <random>
+#include <vector>
+
+using namespace Sparky;
+
+// A horde closes in on a moving player. Checks the tiled solve against a
+// plain fast-marching reference, parallel against serial, incremental
+// against full recomputes, and that agents following the field arrive.
+// Compares the cost of one field plus thousands of samples with per-agent A*.
+
+namespace {
+    const int kGridSize = 256;
+    const int kAgentCount = 5000;
+    const float kInfinity = std::numeric_limits<float>::infinity();
+
+    // Rectangular crates and a few long walls with gaps; cost 3 mud patches
+    void buildLevel(std::vector<uint8_t>& costs, std::mt19937& rng) {
+        costs.assign(kGridSize * kGridSize, 1);
+        std::uniform_int_distribution<int> coordinate(0, kGridSize - 1);
+        std::uniform_int_distribution<int> extent(2, 12);
+        for (int i = 0; i < 220; ++i) {
+            int x0 = coordinate(rng), z0 = coordinate(rng);
+            int w = extent(rng), h = extent(rng);
+            uint8_t value = i % 4 == 0 ? 3 : FlowField::BLOCKED;
+            for (int z = z0; z < std::min(z0 + h, kGridSize); ++z) {
+                for (int x = x0; x < std::min(x0 + w, kGridSize); ++x) {
+                    costs[z * kGridSize + x] = value;
+                }
+            }
+        }
+        for (int wall = 1; wall < 4; ++wall) {
+            int z = wall * kGridSize / 4;
+            for (int x = 0; x < kGridSize; ++x) {
+                if (x % 64 > 4) costs[z * kGridSize + x] = FlowField::BLOCKED;
+            }
+        }
+    }
+
+    void applyCosts(FlowField& field, const std::vector<uint8_t>& costs) {
+        field.resize(glm::vec3(0.0f), glm::vec3(static_cast<float>(kGridSize), 0.0f, static_cast<float>(kGridSize)));
+        for (int z = 0; z < kGridSize; ++z) {
+            for (int x = 0; x < kGridSize; ++x) {
+                field.setCellCost(x, z, costs[z * kGridSize + x]);
+            }
+        }
+    }
+
+    // Reference: fast marching with a heap over the whole grid
+    void fastMarching(const std::vector<uint8_t>& costs, int goal, std::vector<float>& distances) {
+        distances.assign(costs.size(), kInfinity);
+        std::vector<bool> accepted(costs.size(), false);
+        typedef std::pair<float, int> Entry;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+        distances[goal] = 0.0f;
+        heap.push(Entry(0.0f, goal));
+        auto valueAt = [&](int x, int z) {
+            if (x < 0 || x >= kGridSize || z < 0 || z >= kGridSize) return kInfinity;
+            int cell = z * kGridSize + x;
+            return accepted[cell] ? distances[cell] : kInfinity;
+        };
+        while (!heap.empty()) {
+            Entry top = heap.top();
+            heap.pop();
+            if (accepted[top.second] || top.first > distances[top.second]) continue;
+            accepted[top.second] = true;
+            int cx = top.second % kGridSize, cz = top.second / kGridSize;
+            const int offsets[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+            for (const auto& offset : offsets) {
+                int x = cx + offset[0], z = cz + offset[1];
+                if (x < 0 || x >= kGridSize || z < 0 || z >= kGridSize) continue;
+                int cell = z * kGridSize + x;
+                if (accepted[cell] || costs[cell] == FlowField::BLOCKED) continue;
+                float a = std::min(valueAt(x - 1, z), valueAt(x + 1, z));
+                float b = std::min(valueAt(x, z - 1), valueAt(x, z + 1));
+                if (a > b) std::swap(a, b);
+                float f = static_cast<float>(costs[cell]);
+                float value = b - a >= f ? a + f : 0.5f * (a + b + std::sqrt(2.0f * f * f - (b - a) * (b - a)));
+                if (value < distances[cell]) {
+                    distances[cell] = value;
+                    heap.push(Entry(value, cell));
+                }
+            }
+        }
+    }
+
+    // Largest difference, counting reachable-vs-unreachable as infinite
+    float compare(const FlowField& field, const std::vector<float>& expected) {
+        float worst = 0.0f;
+        for (int z = 0; z < kGridSize; ++z) {
+            for (int x = 0; x < kGridSize; ++x) {
+                float got = field.getDistance(x, z);
+                float want = expected[z * kGridSize + x];
+                bool gotReachable = got >= 0.0f;
+                bool wantReachable = want != kInfinity;
+                if (gotReachable != wantReachable) return kInfinity;
+                if (gotReachable) worst = std::max(worst, std::fabs(got - want));
+            }
+        }
+        return worst;
+    }
+
+    float compare(const FlowField& field, const FlowField& other) {
+        std::vector<float> expected(kGridSize * kGridSize);
+        for (int z = 0; z < kGridSize; ++z) {
+            for (int x = 0; x < kGridSize; ++x) {
+                float distance = other.getDistance(x, z);
+                expected[z * kGridSize + x] = distance >= 0.0f ? distance : kInfinity;
+            }
+        }
+        return compare(field, expected);
+    }
+
+    glm::vec3 pickOpenPoint(const std::vector<uint8_t>& costs, const FlowField& field, std::mt19937& rng) {
+        std::uniform_int_distribution<int> coordinate(0, kGridSize - 1);
+        int x, z;
+        do {
+            x = coordinate(rng);
+            z = coordinate(rng);
+        } while (costs[z * kGridSize + x] == FlowField::BLOCKED || field.getDistance(x, z) < 0.0f);
+        return field.cellCenter(x, z);
+    }
+
+    bool isOpen(const std::vector<uint8_t>& costs, const FlowField& field, const glm::vec3& position) {
+        int x, z;
+        return field.worldToCell(position, x, z) && costs[z * kGridSize + x] != FlowField::BLOCKED;
+    }
+}
+
+int main() {
+    std::cout << "Flow Field Benchmark" << std::endl;
+    std::mt19937 rng(11);
+    bool allCorrect = true;
+
+    std::vector<uint8_t> costs;
+    buildLevel(costs, rng);
+
+    FlowFieldSettings settings;
+    std::unique_ptr<FlowField> serial = FlowField::create(settings);
+    applyCosts(*serial, costs);
+
+    std::unique_ptr<JobSystem> jobSystem = JobSystem::create(4, 0);
+    std::unique_ptr<FlowField> parallel = FlowField::create(settings);
+    parallel->setJobSystem(jobSystem.get());
+    applyCosts(*parallel, costs);
+
+    FlowFieldSettings fullSettings;
+    fullSettings.incremental = false;
+    std::unique_ptr<FlowField> full = FlowField::create(fullSettings);
+    full->setJobSystem(jobSystem.get());
+    applyCosts(*full, costs);
+
+    // Full solve against the reference
+    glm::vec3 player = glm::vec3(128.5f, 0.0f, 100.5f);
+    while (!isOpen(costs, *serial, player)) player.x += 1.0f;
+    int gx, gz;
+    serial->worldToCell(player, gx, gz);
+
+    std::vector<float> reference;
+    auto start = std::chrono::steady_clock::now();
+    fastMarching(costs, gz * kGridSize + gx, reference);
+    double referenceMs = elapsedMs(start);
+
+    serial->setGoal(player);
+    FlowFieldStats serialStats = serial->getStats();
+    float referenceError = compare(*serial, reference);
+    bool matchesReference = referenceError < 0.05f;
+    std::cout << "Tiled solve matches fast marching: " << (matchesReference ? "ok" : "FAILED")
+              << " (max error " << referenceError << ")" << std::endl;
+    allCorrect = allCorrect && matchesReference;
+
+    parallel->setGoal(player);
+    FlowFieldStats parallelStats = parallel->getStats();
+    bool parallelMatches = compare(*parallel, *serial) == 0.0f;
+    std::cout << "Parallel solve matches serial: " << (parallelMatches ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && parallelMatches;
+    std::cout << "Full solve " << kGridSize << "x" << kGridSize << ": fast marching " << referenceMs
+              << " ms, serial " << serialStats.computeMs << " ms, " << jobSystem->getWorkerCount()
+              << " workers " << parallelStats.computeMs << " ms (" << parallelStats.rounds << " rounds, "
+              << parallelStats.tileSolves << " tile solves)" << std::endl;
+
+    // The player walks; incremental recomputes track full ones
+    full->setGoal(player);
+    double incrementalMs = 0.0, fullMs = 0.0, worstDrift = 0.0;
+    int moves = 0, sameCell = 0;
+    for (int step = 0; step < 60; ++step) {
+        glm::vec3 next = player + glm::vec3(0.35f, 0.0f, 0.2f);
+        if (!isOpen(costs, *parallel, next)) next = player + glm::vec3(0.0f, 0.0f, 0.35f);
+        if (!isOpen(costs, *parallel, next)) break;
+        player = next;
+        int before = parallel->getStats().recomputes;
+        parallel->setGoal(player);
+        full->setGoal(player);
+        if (parallel->getStats().recomputes == before) {
+            ++sameCell;
+            continue;
+        }
+        ++moves;
+        incrementalMs += parallel->getStats().computeMs;
+        fullMs += full->getStats().computeMs;
+        worstDrift = std::max(worstDrift, static_cast<double>(compare(*parallel, *full)));
+    }
+    bool tracks = moves > 10 && sameCell > 0 && worstDrift < 0.05;
+    std::cout << "Incremental recompute matches full: " << (tracks ? "ok" : "FAILED") << " (max drift "
+              << worstDrift << " over " << moves << " cell changes, " << sameCell << " free moves)" << std::endl;
+    std::cout << "Goal moves: incremental avg " << incrementalMs / std::max(moves, 1) << " ms, full avg "
+              << fullMs / std::max(moves, 1) << " ms" << std::endl;
+    allCorrect = allCorrect && tracks;
+
+    // The horde: every agent samples the same field each step
+    std::vector<glm::vec3> agents;
+    for (int i = 0; i < kAgentCount; ++i) {
+        agents.push_back(pickOpenPoint(costs, *parallel, rng));
+    }
+    const float step = 0.4f;
+    double sampleMs = 0.0;
+    int arrived = 0;
+    std::vector<bool> done(agents.size(), false);
+    for (int frame = 0; frame < 2000 && arrived < kAgentCount; ++frame) {
+        start = std::chrono::steady_clock::now();
+        std::vector<glm::vec3> directions(agents.size());
+        for (size_t i = 0; i < agents.size(); ++i) {
+            directions[i] = parallel->sampleDirection(agents[i]);
+        }
+        sampleMs += elapsedMs(start);
+        for (size_t i = 0; i < agents.size(); ++i) {
+            if (done[i]) continue;
+            // Slide along walls the way a character controller would
+            glm::vec3 next = agents[i] + directions[i] * step;
+            if (!isOpen(costs, *parallel, next)) {
+                glm::vec3 alongX = agents[i] + glm::vec3(directions[i].x * step, 0.0f, 0.0f);
+                glm::vec3 alongZ = agents[i] + glm::vec3(0.0f, 0.0f, directions[i].z * step);
+                next = isOpen(costs, *parallel, alongX) ? alongX : isOpen(costs, *parallel, alongZ) ? alongZ : agents[i];
+            }
+            agents[i] = next;
+            if (glm::distance(agents[i], player) < 1.0f) {
+                done[i] = true;
+                ++arrived;
+            }
+        }
+    }
+    bool allArrived = arrived == kAgentCount;
+    std::cout << "Agents following the field arrive: " << (allArrived ? "ok" : "FAILED") << " (" << arrived << "/"
+              << kAgentCount << ")" << std::endl;
+    allCorrect = allCorrect && allArrived;
+
+    // Per-agent A* over the same level for comparison
+    NavigationMesh mesh;
+    for (int z = 0; z < kGridSize; ++z) {
+        for (int x = 0; x < kGridSize; ++x) {
+            NavNode node;
+            node.position = glm::vec3(x + 0.5f, 0.0f, z + 0.5f);
+            node.cost = static_cast<float>(costs[z * kGridSize + x]);
+            node.walkable = costs[z * kGridSize + x] != FlowField::BLOCKED;
+            mesh.addNode(node);
+        }
+    }
+    for (int z = 0; z < kGridSize; ++z) {
+        for (int x = 0; x < kGridSize; ++x) {
+            if (x + 1 < kGridSize) {
+                mesh.addConnection(z * kGridSize + x, z * kGridSize + x + 1);
+                mesh.addConnection(z * kGridSize + x + 1, z * kGridSize + x);
+            }
+            if (z + 1 < kGridSize) {
+                mesh.addConnection(z * kGridSize + x, (z + 1) * kGridSize + x);
+                mesh.addConnection((z + 1) * kGridSize + x, z * kGridSize + x);
+            }
+        }
+    }
+    mesh.getGraph();
+    const int searched = 100;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < searched; ++i) {
+        mesh.findPath(pickOpenPoint(costs, *parallel, rng), player);
+    }
+    double perAgentMs = elapsedMs(start) / searched;
+    std::cout << kAgentCount << " agents: per-agent A* ~" << perAgentMs * kAgentCount << " ms, one field "
+              << parallelStats.computeMs << " ms + " << sampleMs * 1000.0 / (static_cast<double>(kAgentCount) * 2000.0)
+              << " us per sample" << std::endl;
+
+    // The navigation mesh rasterizes back to the level's costs
+    FlowField rasterized(settings);
+    rasterized.rasterize(mesh, glm::vec3(0.0f), glm::vec3(static_cast<float>(kGridSize), 0.0f, static_cast<float>(kGridSize)));
+    bool rasterMatches = rasterized.getWidth() == kGridSize && rasterized.getHeight() == kGridSize;
+    for (int z = 0; z < kGridSize && rasterMatches; ++z) {
+        for (int x = 0; x < kGridSize; ++x) {
+            if (rasterized.getCellCost(x, z) != costs[z * kGridSize + x]) {
+                rasterMatches = false;
+                break;
+            }
+        }
+    }
+    std::cout << "Rasterized navigation mesh: " << (rasterMatches ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && rasterMatches;
+
+    // The same field drives a chasing AIComponent
+    GameObject playerObject("Player");
+    playerObject.setPosition(player);
+    GameObject enemy("Enemy");
+    enemy.setPosition(player + glm::vec3(-6.0f, 0.0f, 0.0f));
+    while (!isOpen(costs, *parallel, enemy.getPosition())) {
+        enemy.setPosition(enemy.getPosition() + glm::vec3(0.0f, 0.0f, 1.0f));
+    }
+    AIComponent* ai = enemy.addComponent<AIComponent>();
+    ai->setTarget(&playerObject);
+    ai->setFlowField(parallel.get());
+    ai->setState(AIState::CHASE);
+    float startDistance = ai->getDistanceToTarget();
+    for (int frame = 0; frame < 10; ++frame) {
+        ai->update(0.1f);
+    }
+    bool chased = ai->getDistanceToTarget() < startDistance;
+    std::cout << "AIComponent chases along the field: " << (chased ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && chased;
+
+    std::cout << (allCorrect ? "Flow field benchmark passed!" : "Flow field benchmark FAILED!") << std::endl;
+    return allCorrect ? 0 : 1;
+}
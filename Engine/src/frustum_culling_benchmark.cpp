@@ -0,0 +1,253 @@
+#include "../include/CullingBVH.h"
+#include "../include/Camera.h"
+#include "../include/TimingUtils.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace Sparky;
+
+// 100k boxes of random size, rotation and scale scattered over a large
+// level, seen by a camera turning on the spot while a tenth of the boxes
+// drift every frame. Each frame the BVH is refitted and culled, and its
+// visible set checked against testing every box with Frustum::intersectsBox(),
+// which is what drawing every registered object amounted to. Boxes are also
+// added and removed along the way, through the pending list and rebuilds.
+
+namespace {
+    const int kObjectCount = 100000;
+    const float kWorldSize = 2000.0f;
+    const int kFrames = 120;
+    const int kMoversPerFrame = kObjectCount / 10;
+    const float kAspectRatio = 16.0f / 9.0f;
+
+    struct Object {
+        glm::vec3 localMin;
+        glm::vec3 localMax;
+        glm::vec3 position;
+        glm::vec3 rotation;     // Degrees, as GameObject
+        glm::vec3 scale;
+        glm::vec3 worldMin;
+        glm::vec3 worldMax;
+        int proxy;
+    };
+
+    glm::mat4 transformOf(const Object& object) {
+        glm::mat4 transform = glm::translate(glm::mat4(1.0f), object.position);
+        transform = glm::rotate(transform, glm::radians(object.rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
+        transform = glm::rotate(transform, glm::radians(object.rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
+        transform = glm::rotate(transform, glm::radians(object.rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
+        return glm::scale(transform, object.scale);
+    }
+
+    void updateBounds(Object& object) {
+        transformBounds(object.localMin, object.localMax, transformOf(object), object.worldMin, object.worldMax);
+    }
+
+    // The box around the eight transformed corners, to check transformBounds() against
+    void cornerBounds(const Object& object, glm::vec3& worldMin, glm::vec3& worldMax) {
+        glm::mat4 transform = transformOf(object);
+        worldMin = glm::vec3(1e30f);
+        worldMax = glm::vec3(-1e30f);
+        for (int corner = 0; corner < 8; ++corner) {
+            glm::vec3 local((corner & 1) ? object.localMax.x : object.localMin.x,
+                            (corner & 2) ? object.localMax.y : object.localMin.y,
+                            (corner & 4) ? object.localMax.z : object.localMin.z);
+            glm::vec3 world = glm::vec3(transform * glm::vec4(local, 1.0f));
+            worldMin = glm::min(worldMin, world);
+            worldMax = glm::max(worldMax, world);
+        }
+    }
+
+    Object randomObject(std::mt19937& rng) {
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        Object object;
+        glm::vec3 half(0.25f + 2.0f * unit(rng), 0.25f + 2.0f * unit(rng), 0.25f + 2.0f * unit(rng));
+        glm::vec3 offset = (glm::vec3(unit(rng), unit(rng), unit(rng)) - 0.5f) * half;
+        object.localMin = offset - half;
+        object.localMax = offset + half;
+        object.position = glm::vec3((unit(rng) - 0.5f) * kWorldSize, unit(rng) * 40.0f, (unit(rng) - 0.5f) * kWorldSize);
+        object.rotation = glm::vec3(unit(rng), unit(rng), unit(rng)) * 360.0f;
+        object.scale = glm::vec3(0.5f + unit(rng));
+        object.proxy = -1;
+        updateBounds(object);
+        return object;
+    }
+
+    // Every live object's proxy the frustum touches, by testing each box
+    void bruteForce(const std::vector<Object>& objects, const Frustum& frustum, std::vector<int>& visible) {
+        visible.clear();
+        for (const Object& object : objects) {
+            if (object.proxy >= 0 && frustum.intersectsBox(object.worldMin, object.worldMax)) {
+                visible.push_back(object.proxy);
+            }
+        }
+    }
+
+    bool sameSet(std::vector<int> a, std::vector<int> b) {
+        std::sort(a.begin(), a.end());
+        std::sort(b.begin(), b.end());
+        return a == b;
+    }
+}
+
+int main() {
+    std::cout << "Frustum Culling Benchmark" << std::endl;
+    bool allCorrect = true;
+    std::mt19937 rng(48);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    // Frustum planes from a camera: in front is inside, behind and beside are not
+    Camera camera(glm::vec3(0.0f, 20.0f, 0.0f));
+    Frustum frustum = Frustum::fromMatrix(camera.GetProjectionMatrix(kAspectRatio) * camera.GetViewMatrix());
+    glm::vec3 ahead = camera.getPosition() + camera.getFront() * 50.0f;
+    bool planesCorrect = frustum.intersectsBox(ahead - 1.0f, ahead + 1.0f) &&
+                         !frustum.intersectsBox(camera.getPosition() - camera.getFront() * 50.0f - 1.0f,
+                                                camera.getPosition() - camera.getFront() * 50.0f + 1.0f) &&
+                         !frustum.intersectsBox(ahead + camera.getRight() * 200.0f - 1.0f, ahead + camera.getRight() * 200.0f + 1.0f) &&
+                         !frustum.intersectsBox(camera.getPosition() + camera.getFront() * 1200.0f - 1.0f,
+                                                camera.getPosition() + camera.getFront() * 1200.0f + 1.0f);
+    std::cout << "Frustum planes: " << (planesCorrect ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && planesCorrect;
+
+    std::vector<Object> objects;
+    objects.reserve(kObjectCount);
+    bool boundsCorrect = true;
+    for (int i = 0; i < kObjectCount; ++i) {
+        objects.push_back(randomObject(rng));
+        glm::vec3 cornerMin, cornerMax;
+        cornerBounds(objects.back(), cornerMin, cornerMax);
+        float error = std::max(glm::length(cornerMin - objects.back().worldMin), glm::length(cornerMax - objects.back().worldMax));
+        boundsCorrect = boundsCorrect && error < 1e-3f;
+    }
+    std::cout << "World bounds match the transformed corners: " << (boundsCorrect ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && boundsCorrect;
+
+    CullingBVH bvh;
+    auto start = std::chrono::steady_clock::now();
+    for (Object& object : objects) {
+        object.proxy = bvh.addProxy(object.worldMin, object.worldMax);
+    }
+    bvh.update();
+    double buildMs = elapsedMs(start);
+    std::cout << kObjectCount << " proxies built into " << bvh.getNodeCount() << " nodes in " << buildMs << " ms" << std::endl;
+
+    // A camera far above looking down sees everything, mostly as whole subtrees
+    std::vector<int> visible, expected;
+    CullingStats stats;
+    Camera overhead(glm::vec3(0.0f, 900.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f), -90.0f, -89.0f);
+    overhead.setFOV(120.0f);
+    Frustum everything = Frustum::fromMatrix(overhead.GetProjectionMatrix(1.0f) * overhead.GetViewMatrix());
+    bvh.cull(everything, visible, &stats);
+    bruteForce(objects, everything, expected);
+    bool wholeCorrect = sameSet(visible, expected) && stats.subtreesAccepted > 0 && stats.boxesTested < kObjectCount;
+    std::cout << "Overhead view: " << stats.visible << " visible, " << stats.subtreesAccepted << " subtrees taken whole, "
+              << stats.boxesTested << " boxes tested: " << (wholeCorrect ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && wholeCorrect;
+
+    // Turn on the spot while a tenth of the boxes drift each frame. Every 20th frame
+    // some boxes are removed and others added, which the BVH takes as pending proxies.
+    double bruteMs = 0.0, updateMs = 0.0, cullMs = 0.0;
+    long long visibleTotal = 0, nodesTotal = 0, boxesTotal = 0;
+    bool framesCorrect = true;
+    std::uniform_int_distribution<int> pick(0, kObjectCount - 1);
+    for (int frame = 0; frame < kFrames; ++frame) {
+        if (frame % 20 == 10) {
+            for (int i = 0; i < 500; ++i) {
+                Object& removed = objects[pick(rng)];
+                if (removed.proxy < 0) continue;
+                bvh.removeProxy(removed.proxy);
+                removed.proxy = -1;
+            }
+            for (int i = 0; i < 200; ++i) {
+                Object& added = objects[pick(rng)];
+                if (added.proxy >= 0) continue;
+                added.proxy = bvh.addProxy(added.worldMin, added.worldMax);
+            }
+        }
+
+        for (int i = 0; i < kMoversPerFrame; ++i) {
+            Object& object = objects[pick(rng)];
+            object.position += glm::vec3(unit(rng) - 0.5f, 0.0f, unit(rng) - 0.5f);
+            object.rotation.y += 5.0f;
+            updateBounds(object);
+            if (object.proxy >= 0) bvh.moveProxy(object.proxy, object.worldMin, object.worldMax);
+        }
+
+        camera.setYaw(-90.0f + frame * 3.0f);
+        camera.setPitch(-10.0f + 10.0f * std::sin(frame * 0.1f));
+        frustum = Frustum::fromMatrix(camera.GetProjectionMatrix(kAspectRatio) * camera.GetViewMatrix());
+
+        start = std::chrono::steady_clock::now();
+        bruteForce(objects, frustum, expected);
+        bruteMs += elapsedMs(start);
+
+        start = std::chrono::steady_clock::now();
+        bvh.update();
+        updateMs += elapsedMs(start);
+
+        start = std::chrono::steady_clock::now();
+        bvh.cull(frustum, visible, &stats);
+        cullMs += elapsedMs(start);
+
+        framesCorrect = framesCorrect && sameSet(visible, expected) && stats.proxies == bvh.getProxyCount();
+        visibleTotal += stats.visible;
+        nodesTotal += stats.nodesTested;
+        boxesTotal += stats.boxesTested;
+    }
+    std::cout << "Same visible set as testing every box, " << kFrames << " frames: " << (framesCorrect ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && framesCorrect;
+
+    // Removing a third of the proxies, then adding them back, rebuilds the tree each time
+    int rebuildsBefore = bvh.getRebuildCount();
+    std::vector<int> removed;
+    for (size_t i = 0; i < objects.size(); i += 3) {
+        if (objects[i].proxy < 0) continue;
+        bvh.removeProxy(objects[i].proxy);
+        objects[i].proxy = -1;
+        removed.push_back(static_cast<int>(i));
+    }
+    bvh.update();
+    bool removalRebuilt = bvh.getRebuildCount() == rebuildsBefore + 1;
+    for (int i : removed) {
+        objects[i].proxy = bvh.addProxy(objects[i].worldMin, objects[i].worldMax);
+    }
+    int pendingBeforeUpdate = bvh.getPendingCount();
+    bvh.update();
+    bvh.cull(frustum, visible, &stats);
+    bruteForce(objects, frustum, expected);
+    bool pendingHandled = removalRebuilt && pendingBeforeUpdate == static_cast<int>(removed.size()) &&
+                          bvh.getRebuildCount() == rebuildsBefore + 2 && bvh.getPendingCount() == 0 && sameSet(visible, expected);
+    std::cout << "Rebuilt after removing and adding " << removed.size() << " proxies: " << (pendingHandled ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && pendingHandled;
+
+    // Scatter every box far from where it was built: the refit degrades, so the tree is rebuilt
+    rebuildsBefore = bvh.getRebuildCount();
+    for (Object& object : objects) {
+        object.position = glm::vec3((unit(rng) - 0.5f) * kWorldSize, unit(rng) * 40.0f, (unit(rng) - 0.5f) * kWorldSize);
+        updateBounds(object);
+        if (object.proxy >= 0) bvh.moveProxy(object.proxy, object.worldMin, object.worldMax);
+    }
+    bvh.update();
+    bvh.cull(frustum, visible, &stats);
+    bruteForce(objects, frustum, expected);
+    bool scatterCorrect = bvh.getRebuildCount() == rebuildsBefore + 1 && sameSet(visible, expected);
+    std::cout << "Rebuilt after scattering: " << (scatterCorrect ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && scatterCorrect;
+
+    std::cout << "Per frame, " << visibleTotal / kFrames << " of " << bvh.getProxyCount() << " visible, "
+              << nodesTotal / kFrames << " nodes and " << boxesTotal / kFrames << " boxes tested" << std::endl;
+    std::cout << "Per frame: every box " << bruteMs / kFrames << " ms, BVH refit " << updateMs / kFrames << " ms + cull "
+              << cullMs / kFrames << " ms (" << bruteMs / (updateMs + cullMs) << "x)" << std::endl;
+
+    if (allCorrect) {
+        std::cout << "Frustum culling benchmark passed!" << std::endl;
+        return 0;
+    }
+    std::cout << "Frustum culling benchmark FAILED!" << std::endl;
+    return 1;
+}
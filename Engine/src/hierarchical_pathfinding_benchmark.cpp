@@ -0,0 +1,284 @@
+#include "../include/AdvancedAI.h"
+#include "../include/HierarchicalPathfinder.h"
+#include "../include/NavGraph.h"
+#include "../include/TimingUtils.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace Sparky;
+
+// Compares HPA* with flat A* on a generated 512x512 outdoor grid: query
+// time, time to the first refined segment, path quality and agreement on
+// reachability, then drops dynamic obstacles and compares the incremental
+// cluster update with a full rebuild.
+
+namespace {
+    const int kWorldSize = 512;
+    const int kQueryCount = 100;
+
+    int nodeIndex(int x, int z) {
+        return z * kWorldSize + x;
+    }
+
+    // Open terrain with rock fields and long walls that have gaps
+    std::vector<bool> generateWorld(std::mt19937& rng) {
+        std::vector<bool> blocked(static_cast<size_t>(kWorldSize) * kWorldSize, false);
+        std::uniform_int_distribution<int> coordinate(0, kWorldSize - 1);
+        std::uniform_int_distribution<int> rockSize(1, 6);
+        std::uniform_int_distribution<int> wallLength(20, 120);
+        std::uniform_int_distribution<int> gapEvery(10, 40);
+
+        for (int rock = 0; rock < 3000; ++rock) {
+            int cx = coordinate(rng), cz = coordinate(rng), radius = rockSize(rng);
+            for (int z = std::max(cz - radius, 0); z <= std::min(cz + radius, kWorldSize - 1); ++z) {
+                for (int x = std::max(cx - radius, 0); x <= std::min(cx + radius, kWorldSize - 1); ++x) {
+                    if ((x - cx) * (x - cx) + (z - cz) * (z - cz) <= radius * radius) {
+                        blocked[nodeIndex(x, z)] = true;
+                    }
+                }
+            }
+        }
+        for (int wall = 0; wall < 120; ++wall) {
+            int x = coordinate(rng), z = coordinate(rng), length = wallLength(rng), gap = gapEvery(rng);
+            bool horizontal = (wall & 1) == 0;
+            for (int i = 0; i < length; ++i) {
+                int wx = horizontal ? x + i : x, wz = horizontal ? z : z + i;
+                if (wx >= kWorldSize || wz >= kWorldSize) break;
+                if (i % gap < gap - 3) {
+                    blocked[nodeIndex(wx, wz)] = true;
+                }
+            }
+        }
+        return blocked;
+    }
+
+    void buildMesh(NavigationMesh& mesh, const std::vector<bool>& blocked) {
+        for (int z = 0; z < kWorldSize; ++z) {
+            for (int x = 0; x < kWorldSize; ++x) {
+                NavNode node;
+                node.position = glm::vec3(static_cast<float>(x), 0.0f, static_cast<float>(z));
+                node.cost = 1.0f;
+                node.walkable = !blocked[nodeIndex(x, z)];
+                for (int dz = -1; dz <= 1; ++dz) {
+                    for (int dx = -1; dx <= 1; ++dx) {
+                        int nx = x + dx, nz = z + dz;
+                        if ((dx || dz) && nx >= 0 && nx < kWorldSize && nz >= 0 && nz < kWorldSize) {
+                            node.connections.push_back(nodeIndex(nx, nz));
+                        }
+                    }
+                }
+                mesh.addNode(node);
+            }
+        }
+    }
+
+    // Sum of edge costs, or -1 if consecutive nodes are not joined by an edge or a node is blocked
+    float pathCost(const NavGraph& graph, const std::vector<int>& path) {
+        float cost = 0.0f;
+        for (size_t i = 0; i < path.size(); ++i) {
+            if (!graph.isWalkable(path[i])) return -1.0f;
+            if (i == 0) continue;
+            bool joined = false;
+            for (uint32_t edge = graph.getEdgeBegin(path[i - 1]); edge < graph.getEdgeEnd(path[i - 1]); ++edge) {
+                if (graph.getEdgeTarget(edge) == path[i]) {
+                    cost += graph.getEdgeCost(edge);
+                    joined = true;
+                    break;
+                }
+            }
+            if (!joined) return -1.0f;
+        }
+        return cost;
+    }
+
+    struct Comparison {
+        bool correct;
+        double flatMs;
+        double hierarchicalMs;
+        double firstSegmentMs;
+        double averageRatio;
+        double worstRatio;
+        int reachable;
+    };
+
+    Comparison compare(NavigationMesh& mesh, HierarchicalPathfinder& hierarchical,
+                       const std::vector<std::pair<int, int>>& queries) {
+        const NavGraph& graph = mesh.getGraph();
+        Comparison result = {true, 0.0, 0.0, 0.0, 0.0, 0.0, 0};
+        std::vector<int> flatPath;
+        std::vector<int> hierarchicalPath;
+        std::vector<float> flatCosts;
+        std::vector<bool> flatFound;
+
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& query : queries) {
+            flatFound.push_back(mesh.findNodePath(query.first, query.second, flatPath));
+            flatCosts.push_back(flatFound.back() ? pathCost(graph, flatPath) : -1.0f);
+        }
+        result.flatMs = elapsedMs(start);
+
+        start = std::chrono::steady_clock::now();
+        HierarchicalPath abstractPath;
+        std::vector<int> firstSegment;
+        for (const auto& query : queries) {
+            firstSegment.clear();
+            if (hierarchical.findAbstractPath(query.first, query.second, abstractPath)) {
+                hierarchical.refineNextSegment(abstractPath, firstSegment);
+            }
+        }
+        result.firstSegmentMs = elapsedMs(start);
+
+        double ratioSum = 0.0;
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < queries.size(); ++i) {
+            bool found = hierarchical.findNodePath(queries[i].first, queries[i].second, hierarchicalPath);
+            if (found != flatFound[i]) {
+                result.correct = false;
+                continue;
+            }
+            if (!found) continue;
+
+            float cost = pathCost(graph, hierarchicalPath);
+            if (cost < 0.0f || hierarchicalPath.front() != queries[i].first || hierarchicalPath.back() != queries[i].second ||
+                cost + 1e-3f < flatCosts[i]) {
+                result.correct = false;
+                continue;
+            }
+            double ratio = flatCosts[i] > 0.0f ? cost / flatCosts[i] : 1.0;
+            ratioSum += ratio;
+            result.worstRatio = std::max(result.worstRatio, ratio);
+            ++result.reachable;
+        }
+        result.hierarchicalMs = elapsedMs(start);
+        result.averageRatio = result.reachable > 0 ? ratioSum / result.reachable : 1.0;
+        return result;
+    }
+
+    void report(const char* label, const Comparison& result, size_t queryCount) {
+        std::cout << label << ": " << queryCount << " queries (" << result.reachable << " reachable), flat A* "
+                  << result.flatMs << " ms, HPA* " << result.hierarchicalMs << " ms ("
+                  << result.flatMs / std::max(result.hierarchicalMs, 1e-6) << "x), first segment "
+                  << result.firstSegmentMs << " ms" << std::endl;
+        std::cout << "  Path length vs optimal: avg " << result.averageRatio << ", worst " << result.worstRatio << std::endl;
+    }
+}
+
+int main() {
+    std::cout << "Hierarchical Pathfinding Benchmark" << std::endl;
+    std::mt19937 rng(512);
+    bool allCorrect = true;
+
+    std::vector<bool> blocked = generateWorld(rng);
+    NavigationMesh mesh;
+    auto start = std::chrono::steady_clock::now();
+    buildMesh(mesh, blocked);
+    const NavGraph& graph = mesh.getGraph();
+    std::cout << "World " << kWorldSize << "x" << kWorldSize << ": " << graph.getNodeCount() << " nodes, "
+              << graph.getEdgeCount() << " edges in " << elapsedMs(start) << " ms" << std::endl;
+
+    HierarchicalPathfinder hierarchical(&mesh);
+    hierarchical.build();
+    const HierarchicalPathStats& stats = hierarchical.getStats();
+    std::cout << "Abstract graph: " << stats.clusterCount << " clusters, " << stats.entranceCount << " entrances, "
+              << stats.abstractEdgeCount << " edges, built in " << stats.buildMs << " ms" << std::endl;
+
+    // Long queries between walkable nodes
+    std::uniform_int_distribution<int> pickNode(0, graph.getNodeCount() - 1);
+    auto pickWalkable = [&]() {
+        int node;
+        do {
+            node = pickNode(rng);
+        } while (!graph.isWalkable(node));
+        return node;
+    };
+    std::vector<std::pair<int, int>> queries;
+    while (static_cast<int>(queries.size()) < kQueryCount) {
+        int from = pickWalkable(), to = pickWalkable();
+        if (glm::distance(graph.getPosition(from), graph.getPosition(to)) > kWorldSize * 0.4f) {
+            queries.push_back({from, to});
+        }
+    }
+
+    Comparison before = compare(mesh, hierarchical, queries);
+    report("Static world", before, queries.size());
+    bool quality = before.correct && before.worstRatio < 1.3;
+    std::cout << "Valid paths, same reachability, bounded detour: " << (quality ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && quality;
+
+    // Dynamic obstacles across the first few flat paths
+    std::vector<int> flatPath;
+    std::vector<int> obstacleNodes;
+    glm::vec3 areaMin(static_cast<float>(kWorldSize));
+    glm::vec3 areaMax(-1.0f);
+    for (int q = 0; q < 5; ++q) {
+        if (!mesh.findNodePath(queries[q].first, queries[q].second, flatPath)) continue;
+        const glm::vec3 center = graph.getPosition(flatPath[flatPath.size() / 2]);
+        for (int dz = -4; dz <= 4; ++dz) {
+            for (int dx = -4; dx <= 4; ++dx) {
+                int x = static_cast<int>(center.x) + dx, z = static_cast<int>(center.z) + dz;
+                if (x < 0 || x >= kWorldSize || z < 0 || z >= kWorldSize) continue;
+                int node = nodeIndex(x, z);
+                if (node == queries[q].first || node == queries[q].second || !graph.isWalkable(node)) continue;
+                mesh.setNodeWalkable(node, false);
+                obstacleNodes.push_back(node);
+                hierarchical.markNodeChanged(node);
+            }
+        }
+    }
+
+    // Keep queries whose endpoints are still open
+    std::vector<std::pair<int, int>> openQueries;
+    for (const auto& query : queries) {
+        if (graph.isWalkable(query.first) && graph.isWalkable(query.second)) {
+            openQueries.push_back(query);
+        }
+    }
+
+    int updated = hierarchical.update();
+    double updateMs = stats.updateMs;
+    std::cout << "Dynamic obstacles: " << obstacleNodes.size() << " nodes blocked, " << updated
+              << " clusters updated in " << updateMs << " ms (full build " << stats.buildMs << " ms)" << std::endl;
+
+    Comparison after = compare(mesh, hierarchical, openQueries);
+    report("After obstacles", after, openQueries.size());
+    bool incremental = after.correct && after.worstRatio < 1.3 && updated < stats.clusterCount;
+    std::cout << "Incremental update matches the edited world: " << (incremental ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && incremental;
+
+    // A fresh build must agree with the incrementally updated one
+    HierarchicalPathfinder rebuilt(&mesh);
+    rebuilt.build();
+    std::vector<int> incrementalPath;
+    std::vector<int> rebuiltPath;
+    int disagreements = 0;
+    for (const auto& query : openQueries) {
+        bool a = hierarchical.findNodePath(query.first, query.second, incrementalPath);
+        bool b = rebuilt.findNodePath(query.first, query.second, rebuiltPath);
+        if (a != b || (a && std::fabs(pathCost(graph, incrementalPath) - pathCost(graph, rebuiltPath)) > 1e-3f)) {
+            ++disagreements;
+        }
+    }
+    bool consistent = disagreements == 0 && rebuilt.getStats().entranceCount == stats.entranceCount &&
+                      rebuilt.getStats().abstractEdgeCount == stats.abstractEdgeCount;
+    std::cout << "Incremental update equals full rebuild: " << (consistent ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && consistent;
+
+    // Removing the obstacles again by area
+    for (int node : obstacleNodes) {
+        mesh.setNodeWalkable(node, true);
+        areaMin = glm::min(areaMin, graph.getPosition(node));
+        areaMax = glm::max(areaMax, graph.getPosition(node));
+    }
+    hierarchical.markAreaChanged(areaMin, areaMax);
+    Comparison restored = compare(mesh, hierarchical, queries);
+    bool reopened = restored.correct && std::fabs(restored.averageRatio - before.averageRatio) < 1e-6;
+    std::cout << "Area update restores the original paths: " << (reopened ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && reopened;
+
+    std::cout << (allCorrect ? "Hierarchical pathfinding benchmark passed!" : "Hierarchical pathfinding benchmark FAILED!") << std::endl;
+    return allCorrect ? 0 : 1;
+}
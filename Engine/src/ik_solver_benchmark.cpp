@@ -0,0 +1,384 @@
+#include "../include/IKSolvers.h"
+#include "../include/AdvancedAnimationSystem.h"
+#include "../include/TimingUtils.h"
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtx/quaternion.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace Sparky;
+
+// Batches of two-bone legs and four-bone chains with random targets, solved
+// by the closed-form and FABRIK solvers and, for comparison, by CCD on the
+// same position buffers. Checks that targets are reached with bone lengths
+// kept, that legs bend towards their pole, that bend limits hold and that
+// targets out of reach straighten the chain. Then 500 characters with a leg
+// and a tail run through InverseKinematics, against the CCD solver it
+// replaces: ten passes reading every joint's model transform back from the
+// skeleton, both as it was (its rotations were never applied) and with the
+// rotations written, which rebuilds the transforms after every joint.
+
+namespace {
+    const int kLegCount = 4000;
+    const int kChainCount = 4000;
+    const int kChainBones = 4;
+    const float kLegBone = 0.45f;
+    const float kChainBone = 0.2f;
+    const float kBendLimit = 0.8f;
+    const int kCharacterCount = 500;
+    const int kFrames = 60;
+    const float kDeltaTime = 1.0f / 60.0f;
+
+    glm::vec3 randomTarget(std::mt19937& rng, const glm::vec3& root, float minReach, float maxReach) {
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        glm::vec3 dir;
+        do {
+            dir = glm::vec3(unit(rng), unit(rng), unit(rng));
+        } while (glm::length(dir) < 0.1f || glm::length(dir) > 1.0f);
+        float reach = minReach + (maxReach - minReach) * (unit(rng) * 0.5f + 0.5f);
+        return root + glm::normalize(dir) * reach;
+    }
+
+    bool lengthsKept(const IKChainBatch& batch, int chain) {
+        const int offset = batch.offsets[chain];
+        for (int i = 0; i + 1 < batch.counts[chain]; ++i) {
+            float length = glm::length(batch.positions[offset + i + 1] - batch.positions[offset + i]);
+            if (std::fabs(length - batch.lengths[offset + i]) > 1e-3f) return false;
+        }
+        return true;
+    }
+
+    float largestBend(const IKChainBatch& batch, int chain) {
+        const glm::vec3* p = batch.positions.data() + batch.offsets[chain];
+        float largest = 0.0f;
+        for (int i = 1; i + 1 < batch.counts[chain]; ++i) {
+            float cosine = glm::dot(glm::normalize(p[i] - p[i - 1]), glm::normalize(p[i + 1] - p[i]));
+            largest = std::max(largest, std::acos(std::min(std::max(cosine, -1.0f), 1.0f)));
+        }
+        return largest;
+    }
+
+    // CCD over a position buffer: each joint, end first, turns the rest of the chain onto the target
+    int solveCCD(glm::vec3* positions, int count, const glm::vec3& target, const IKSolverSettings& settings, float& error) {
+        int iteration = 0;
+        error = glm::length(positions[count - 1] - target);
+        while (iteration < settings.maxIterations && error > settings.tolerance) {
+            ++iteration;
+            for (int i = count - 2; i >= 0; --i) {
+                glm::vec3 toEnd = positions[count - 1] - positions[i];
+                glm::vec3 toTarget = target - positions[i];
+                if (glm::length(toEnd) < 1e-6f || glm::length(toTarget) < 1e-6f) continue;
+                glm::quat turn = glm::rotation(glm::normalize(toEnd), glm::normalize(toTarget));
+                for (int j = i + 1; j < count; ++j) {
+                    positions[j] = positions[i] + turn * (positions[j] - positions[i]);
+                }
+            }
+            error = glm::length(positions[count - 1] - target);
+        }
+        return iteration;
+    }
+
+    // Skeleton: pelvis, a leg (hip, knee, ankle) and a tail of four joints and a tip
+    const int kBoneCount = 9;
+    const int kHip = 1, kAnkle = 3, kTail = 4, kTip = 8;
+
+    std::unique_ptr<AnimationClip> makeClip(float phase) {
+        std::unique_ptr<AnimationClip> clip(new AnimationClip("idle"));
+        const glm::vec3 offsets[kBoneCount] = {
+            glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.1f, 0.0f, 0.0f), glm::vec3(0.0f, -kLegBone, 0.0f),
+            glm::vec3(0.0f, -kLegBone, 0.0f), glm::vec3(0.0f, 0.0f, -0.1f), glm::vec3(0.0f, 0.0f, -kChainBone),
+            glm::vec3(0.0f, 0.0f, -kChainBone), glm::vec3(0.0f, 0.0f, -kChainBone), glm::vec3(0.0f, 0.0f, -kChainBone)};
+        for (int bone = 0; bone < kBoneCount; ++bone) {
+            for (int key = 0; key < 30; ++key) {
+                float time = key / 30.0f;
+                float swing = 0.2f + 0.15f * std::sin(6.0f * time + phase + bone);
+                glm::quat rotation = glm::angleAxis(swing, bone == 2 ? glm::vec3(-1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f));
+                Keyframe keyframe;
+                keyframe.time = time;
+                keyframe.position[0] = offsets[bone].x;
+                keyframe.position[1] = offsets[bone].y;
+                keyframe.position[2] = offsets[bone].z;
+                keyframe.rotation[0] = rotation.x;
+                keyframe.rotation[1] = rotation.y;
+                keyframe.rotation[2] = rotation.z;
+                keyframe.rotation[3] = rotation.w;
+                keyframe.scale[0] = keyframe.scale[1] = keyframe.scale[2] = 1.0f;
+                clip->addKeyframe(bone, keyframe);
+            }
+        }
+        return clip;
+    }
+
+    struct Character {
+        std::unique_ptr<GameObject> object;
+        SkeletalAnimation* animation;
+        InverseKinematics* ik;
+        InverseKinematics::IKChain chains[2];
+        glm::vec3 targets[2];
+    };
+
+    void buildCharacter(Character& character, int index) {
+        character.object.reset(new GameObject("character" + std::to_string(index)));
+        character.animation = character.object->addComponent<SkeletalAnimation>();
+        const int parents[kBoneCount] = {-1, 0, 1, 2, 0, 4, 5, 6, 7};
+        for (int bone = 0; bone < kBoneCount; ++bone) {
+            SkeletalAnimation::Bone entry;
+            entry.name = "bone" + std::to_string(bone);
+            entry.id = bone;
+            entry.parentId = parents[bone];
+            entry.offsetMatrix = glm::mat4(1.0f);
+            entry.finalTransformation = glm::mat4(1.0f);
+            character.animation->addBone(entry);
+        }
+        character.animation->addAnimationClip(makeClip(index * 0.37f));
+        character.animation->playAnimation("idle");
+
+        character.ik = character.object->addComponent<InverseKinematics>();
+        character.ik->initialize();
+        InverseKinematics::IKChain& leg = character.chains[0];
+        leg.joints = {{kHip, 1.0f, 0.0f, glm::vec3(1.0f, 0.0f, 0.0f)}, {2, 0.05f, 2.5f, glm::vec3(1.0f, 0.0f, 0.0f)}};
+        leg.effectorBoneId = kAnkle;
+        leg.targetBoneId = -1;
+        leg.poleBoneId = -1;
+        InverseKinematics::IKChain& tail = character.chains[1];
+        for (int bone = kTail; bone < kTip; ++bone) {
+            tail.joints.push_back({bone, 0.0f, kBendLimit, glm::vec3(1.0f, 0.0f, 0.0f)});
+        }
+        tail.effectorBoneId = kTip;
+        tail.targetBoneId = -1;
+        tail.poleBoneId = -1;
+        character.targets[0] = glm::vec3(0.15f, 0.25f + 0.1f * std::sin(index * 0.5f), 0.2f);
+        character.targets[1] = glm::vec3(0.25f * std::cos(index * 0.3f), 1.2f, -0.7f);
+        for (int chain = 0; chain < 2; ++chain) {
+            character.ik->addIKChain(character.chains[chain]);
+            character.ik->setTargetPosition(chain, character.targets[chain]);
+        }
+        character.ik->setPolePosition(0, glm::vec3(0.1f, 0.5f, 1.0f));
+    }
+
+    glm::vec3 bonePosition(const SkeletalAnimation& animation, int bone) {
+        return glm::vec3(animation.getBoneModelTransform(bone) * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+    }
+
+    // What the CCD solver did per chain: up to ten passes, each reading the effector and every
+    // joint back from the skeleton. Its rotations were never written, so it always ran all ten.
+    float replayCCD(const SkeletalAnimation& animation, const InverseKinematics::IKChain& chain, const glm::vec3& target) {
+        float checksum = 0.0f;
+        for (int iteration = 0; iteration < 10; ++iteration) {
+            glm::vec3 effectorPos = bonePosition(animation, chain.effectorBoneId);
+            if (glm::distance(effectorPos, target) < 0.01f) break;
+            for (int i = static_cast<int>(chain.joints.size()) - 1; i >= 0; --i) {
+                glm::vec3 jointPos = bonePosition(animation, chain.joints[i].boneId);
+                glm::vec3 toEffector = glm::normalize(effectorPos - jointPos);
+                glm::vec3 toTarget = glm::normalize(target - jointPos);
+                float angle = std::acos(glm::clamp(glm::dot(toEffector, toTarget), -1.0f, 1.0f));
+                angle = glm::clamp(angle, chain.joints[i].minAngle, chain.joints[i].maxAngle);
+                if (angle > 0.01f) {
+                    glm::quat rotation = glm::angleAxis(angle, glm::normalize(glm::cross(toEffector, toTarget)));
+                    checksum += rotation.w;
+                }
+            }
+        }
+        return checksum;
+    }
+
+    // The same CCD with its rotations written into the pose, which means rebuilding the model
+    // transforms after every joint to read the effector back. Returns the distance left.
+    float skeletonCCD(SkeletalAnimation& animation, const InverseKinematics::IKChain& chain, const glm::vec3& target) {
+        AnimationPose& pose = animation.getOutputPose();
+        float distance = glm::distance(bonePosition(animation, chain.effectorBoneId), target);
+        for (int iteration = 0; iteration < 10 && distance >= 0.01f; ++iteration) {
+            for (int i = static_cast<int>(chain.joints.size()) - 1; i >= 0; --i) {
+                int boneId = chain.joints[i].boneId;
+                glm::vec3 jointPos = bonePosition(animation, boneId);
+                glm::vec3 toEffector = bonePosition(animation, chain.effectorBoneId) - jointPos;
+                glm::vec3 toTarget = target - jointPos;
+                if (glm::length(toEffector) < 1e-6f || glm::length(toTarget) < 1e-6f) continue;
+                glm::quat turn = glm::rotation(glm::normalize(toEffector), glm::normalize(toTarget));
+
+                // Model-space turn into the joint's local rotation
+                glm::mat3 parent(animation.getBoneModelTransform(animation.getBone(boneId)->parentId));
+                for (int axis = 0; axis < 3; ++axis) {
+                    parent[axis] = glm::normalize(parent[axis]);
+                }
+                glm::quat parentRotation = glm::quat_cast(parent);
+                pose.rotations[boneId] = glm::normalize(glm::inverse(parentRotation) * turn * parentRotation * pose.rotations[boneId]);
+                animation.rebuildBoneMatrices();
+            }
+            distance = glm::distance(bonePosition(animation, chain.effectorBoneId), target);
+        }
+        return distance;
+    }
+}
+
+int main() {
+    std::cout << "IK Solver Benchmark" << std::endl;
+    bool allCorrect = true;
+    std::mt19937 rng(46);
+    IKSolverSettings settings;
+
+    // Legs: hip, knee, ankle, bent slightly forward, poles in front
+    IKChainBatch legs;
+    const glm::vec3 hip(0.0f, 1.0f, 0.0f);
+    const glm::vec3 legPoints[3] = {hip, hip + glm::vec3(0.0f, -kLegBone, 0.05f), hip + glm::vec3(0.0f, -2.0f * kLegBone, 0.0f)};
+    const glm::vec3 pole = hip + glm::vec3(0.0f, -0.5f, 1.0f);
+    const float legMin[3] = {1.0f, 0.0f, 1.0f}, legMax[3] = {0.0f, 2.8f, 0.0f};
+    for (int i = 0; i < kLegCount; ++i) {
+        legs.addChain(legPoints, 3, randomTarget(rng, hip, 0.25f, 1.8f * kLegBone), &pole, legMin, legMax);
+    }
+
+    // Chains: four bones, curling gently, once free and once with bend limits
+    IKChainBatch chains, limited;
+    glm::vec3 chainPoints[kChainBones + 1];
+    float freeMin[kChainBones + 1], freeMax[kChainBones + 1], limitMin[kChainBones + 1], limitMax[kChainBones + 1];
+    for (int i = 0; i <= kChainBones; ++i) {
+        chainPoints[i] = glm::vec3(0.0f, kChainBone * i, 0.02f * i * i);
+        freeMin[i] = 1.0f;
+        freeMax[i] = 0.0f;
+        limitMin[i] = 0.0f;
+        limitMax[i] = kBendLimit;
+    }
+    std::vector<glm::vec3> chainTargets;
+    for (int i = 0; i < kChainCount; ++i) {
+        chainTargets.push_back(randomTarget(rng, chainPoints[0], 0.2f, 0.95f * kChainBones * kChainBone));
+        chains.addChain(chainPoints, kChainBones + 1, chainTargets.back(), nullptr, freeMin, freeMax);
+        limited.addChain(chainPoints, kChainBones + 1, chainTargets.back(), nullptr, limitMin, limitMax);
+    }
+    IKChainBatch ccd = chains;
+
+    IKSolveStats legStats = IKSolveStats(), chainStats = IKSolveStats(), limitedStats = IKSolveStats();
+    auto start = std::chrono::steady_clock::now();
+    solveIKBatch(legs, settings, legStats);
+    double legMs = elapsedMs(start);
+    start = std::chrono::steady_clock::now();
+    solveIKBatch(chains, settings, chainStats);
+    double fabrikMs = elapsedMs(start);
+    solveIKBatch(limited, settings, limitedStats);
+
+    int ccdIterations = 0, ccdConverged = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kChainCount; ++i) {
+        float error;
+        ccdIterations += solveCCD(ccd.positions.data() + ccd.offsets[i], ccd.counts[i], chainTargets[i], settings, error);
+        ccdConverged += error <= settings.tolerance ? 1 : 0;
+    }
+    double ccdMs = elapsedMs(start);
+
+    bool legLengths = true, towardsPole = true;
+    for (int i = 0; i < kLegCount; ++i) {
+        legLengths = legLengths && lengthsKept(legs, i);
+        const glm::vec3* p = legs.positions.data() + legs.offsets[i];
+        glm::vec3 axis = glm::normalize(p[2] - p[0]);
+        glm::vec3 knee = (p[1] - p[0]) - axis * glm::dot(p[1] - p[0], axis);
+        glm::vec3 front = (pole - p[0]) - axis * glm::dot(pole - p[0], axis);
+        towardsPole = towardsPole && glm::dot(knee, front) >= -1e-4f;
+    }
+    bool legsSolved = legStats.twoBoneChains == kLegCount && legStats.converged == kLegCount && legStats.iterations == kLegCount;
+    std::cout << "Two-bone legs reached (" << legStats.converged << " of " << kLegCount << ", max error " << legStats.maxError
+              << "): " << (legsSolved && legLengths ? "ok" : "FAILED") << std::endl;
+    std::cout << "Knees bend towards the pole: " << (towardsPole ? "ok" : "FAILED") << std::endl;
+
+    bool chainLengths = true;
+    for (int i = 0; i < kChainCount; ++i) {
+        chainLengths = chainLengths && lengthsKept(chains, i) && lengthsKept(limited, i);
+    }
+    bool fabrikSolved = chainStats.fabrikChains == kChainCount && chainStats.converged >= kChainCount * 95 / 100;
+    std::cout << "FABRIK chains reached (" << chainStats.converged << " of " << kChainCount << ", "
+              << static_cast<float>(chainStats.iterations) / kChainCount << " passes each): "
+              << (fabrikSolved && chainLengths ? "ok" : "FAILED") << std::endl;
+    std::cout << "CCD on the same chains: " << ccdConverged << " reached, " << static_cast<float>(ccdIterations) / kChainCount
+              << " passes each" << std::endl;
+
+    float worstBend = 0.0f;
+    for (int i = 0; i < kChainCount; ++i) {
+        worstBend = std::max(worstBend, largestBend(limited, i));
+    }
+    bool limitsHeld = worstBend <= kBendLimit + 1e-3f;
+    std::cout << "Bend limits held (largest " << worstBend << " of " << kBendLimit << " rad, " << limitedStats.converged
+              << " still reached): " << (limitsHeld ? "ok" : "FAILED") << std::endl;
+
+    // Targets out of reach: the chain points straight at them
+    IKChainBatch far;
+    const glm::vec3 farTarget(2.0f, 1.0f, 0.0f);
+    far.addChain(chainPoints, kChainBones + 1, farTarget, nullptr, freeMin, freeMax);
+    far.addChain(legPoints, 3, farTarget, &pole, legMin, legMax);
+    IKSolveStats farStats = IKSolveStats();
+    solveIKBatch(far, settings, farStats);
+    bool straight = farStats.unreachable == 2 && farStats.converged == 0;
+    for (int i = 0; i < far.getChainCount(); ++i) {
+        const glm::vec3* p = far.positions.data() + far.offsets[i];
+        float total = 0.0f;
+        for (int j = 0; j + 1 < far.counts[i]; ++j) {
+            total += far.lengths[far.offsets[i] + j];
+        }
+        straight = straight && std::fabs(far.errors[i] - (glm::length(farTarget - p[0]) - total)) < 1e-3f;
+    }
+    std::cout << "Out of reach targets straighten the chain: " << (straight ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && legsSolved && legLengths && towardsPole && fabrikSolved && chainLengths && limitsHeld && straight;
+
+    std::cout << kLegCount << " two-bone chains: " << legMs << " ms; " << kChainCount << " four-bone chains: FABRIK "
+              << fabrikMs << " ms, CCD " << ccdMs << " ms" << std::endl;
+
+    // Characters: the solved pose has to put the effectors on their targets
+    std::vector<Character> characters(kCharacterCount), ccdCharacters(kCharacterCount);
+    for (int i = 0; i < kCharacterCount; ++i) {
+        buildCharacter(characters[i], i);
+        buildCharacter(ccdCharacters[i], i);
+    }
+    double replayMs = 0.0, ccdSkeletonMs = 0.0, solveMs = 0.0;
+    float checksum = 0.0f, legError = 0.0f, tailError = 0.0f, ccdError = 0.0f;
+    int moved = 0;
+    for (int frame = 0; frame < kFrames; ++frame) {
+        for (int i = 0; i < kCharacterCount; ++i) {
+            characters[i].animation->update(kDeltaTime);
+            ccdCharacters[i].animation->update(kDeltaTime);
+        }
+        start = std::chrono::steady_clock::now();
+        for (Character& character : characters) {
+            for (int chain = 0; chain < 2; ++chain) {
+                checksum += replayCCD(*character.animation, character.chains[chain], character.targets[chain]);
+            }
+        }
+        replayMs += elapsedMs(start);
+
+        start = std::chrono::steady_clock::now();
+        for (Character& character : ccdCharacters) {
+            for (int chain = 0; chain < 2; ++chain) {
+                ccdError = std::max(ccdError, skeletonCCD(*character.animation, character.chains[chain], character.targets[chain]));
+            }
+        }
+        ccdSkeletonMs += elapsedMs(start);
+
+        glm::vec3 before = bonePosition(*characters[0].animation, kAnkle);
+        start = std::chrono::steady_clock::now();
+        for (Character& character : characters) {
+            character.ik->update(kDeltaTime);
+        }
+        solveMs += elapsedMs(start);
+        moved += glm::length(bonePosition(*characters[0].animation, kAnkle) - before) > 1e-3f ? 1 : 0;
+
+        for (const Character& character : characters) {
+            legError = std::max(legError, glm::length(bonePosition(*character.animation, kAnkle) - character.targets[0]));
+            tailError = std::max(tailError, glm::length(bonePosition(*character.animation, kTip) - character.targets[1]));
+        }
+    }
+    const IKSolveStats& characterStats = characters[0].ik->getStats();
+    bool reached = legError < 1e-3f && tailError < 1e-2f && moved == kFrames && characterStats.chainsSolved == 2 &&
+                   characterStats.twoBoneChains == 1 && characterStats.fabrikChains == 1;
+    std::cout << "Skeleton effectors on target (leg " << legError * 1000.0f << " mm, tail " << tailError * 1000.0f
+              << " mm): " << (reached ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && reached;
+
+    std::cout << kCharacterCount << " characters per frame: previous CCD " << replayMs / kFrames << " ms (poses unchanged, "
+              << checksum / kFrames << "), CCD through the skeleton " << ccdSkeletonMs / kFrames << " ms (up to "
+              << ccdError * 1000.0f << " mm off), batched solve and write back " << solveMs / kFrames << " ms ("
+              << ccdSkeletonMs / solveMs << "x)" << std::endl;
+
+    std::cout << (allCorrect ? "IK solver benchmark passed!" : "IK solver benchmark FAILED!") << std::endl;
+    return allCorrect ? 0 : 1;
+}
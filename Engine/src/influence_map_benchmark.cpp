@@ -0,0 +1,299 @@
+#include "../include/InfluenceMap.h"
+#include "../include/StaticBVH.h"
+#include "../include/JobSystem.h"
+#include "../include/TimingUtils.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace Sparky;
+
+// A 256x256 cell (512 m) level with 4000 wall blocks and 16 moving threats.
+// Checks cover probes on a hand-made wall, incremental visibility and
+// threat against full recomputes, parallel against serial updates, batched
+// against single scoring, and the cover and flank queries.
+
+namespace {
+    const int kGridSize = 256;
+    const float kCellSize = 2.0f;
+    const int kWallCount = 4000;
+    const int kThreatCount = 16;
+    const int kUpdates = 60;
+
+    InfluenceMapSettings levelSettings() {
+        InfluenceMapSettings settings;
+        settings.cellSize = kCellSize;
+        settings.width = kGridSize;
+        settings.height = kGridSize;
+        return settings;
+    }
+
+    struct Threats {
+        std::vector<glm::vec3> position;
+        std::vector<glm::vec3> velocity;
+    };
+
+    Threats makeThreats(std::mt19937& rng) {
+        std::uniform_real_distribution<float> coordinate(20.0f, kGridSize * kCellSize - 20.0f);
+        std::uniform_real_distribution<float> speed(-0.25f, 0.25f);   // Metres per update
+        Threats threats;
+        for (int i = 0; i < kThreatCount; ++i) {
+            threats.position.push_back(glm::vec3(coordinate(rng), 0.0f, coordinate(rng)));
+            threats.velocity.push_back(glm::vec3(speed(rng), 0.0f, speed(rng)));
+        }
+        return threats;
+    }
+
+    void moveThreats(Threats& threats) {
+        for (size_t i = 0; i < threats.position.size(); ++i) {
+            threats.position[i] += threats.velocity[i];
+        }
+    }
+
+    std::unique_ptr<InfluenceMap> buildMap(const StaticBVH& walls, const Threats& threats, JobSystem* jobSystem) {
+        std::unique_ptr<InfluenceMap> map = InfluenceMap::create(levelSettings());
+        map->setJobSystem(jobSystem);
+        map->setOccluders(&walls);
+        map->buildCover(walls);
+        for (const glm::vec3& position : threats.position) {
+            map->addThreatSource(position);
+        }
+        return map;
+    }
+
+    // The same propagation over every cell each step
+    void propagateFull(const InfluenceMap& map, const Threats& threats, std::vector<float>& threat, int steps) {
+        const InfluenceMapSettings& settings = map.getSettings();
+        const float edge = std::exp(-settings.threatDecay * settings.cellSize);
+        const float diagonal = std::exp(-settings.threatDecay * settings.cellSize * 1.41421356f);
+        std::vector<uint8_t> blocked(threat.size());
+        for (size_t cell = 0; cell < threat.size(); ++cell) {
+            blocked[cell] = map.isBlocked(map.getCellCenter(static_cast<int>(cell))) ? 1 : 0;
+        }
+        std::vector<float> source(threat.size(), 0.0f);
+        for (const glm::vec3& position : threats.position) {
+            int cell = map.getCell(position);
+            if (cell >= 0 && !map.isBlocked(position)) source[cell] = 1.0f;
+        }
+        std::vector<float> next(threat.size());
+        for (int step = 0; step < steps; ++step) {
+            for (int z = 0; z < kGridSize; ++z) {
+                for (int x = 0; x < kGridSize; ++x) {
+                    int cell = z * kGridSize + x;
+                    if (blocked[cell]) {
+                        next[cell] = 0.0f;
+                        continue;
+                    }
+                    float best = source[cell];
+                    for (int dz = -1; dz <= 1; ++dz) {
+                        for (int dx = -1; dx <= 1; ++dx) {
+                            int nx = x + dx, nz = z + dz;
+                            if ((dx == 0 && dz == 0) || nx < 0 || nz < 0 || nx >= kGridSize || nz >= kGridSize) continue;
+                            best = std::max(best, threat[nz * kGridSize + nx] * (dx != 0 && dz != 0 ? diagonal : edge));
+                        }
+                    }
+                    float value = best + (threat[cell] - best) * settings.threatMomentum;
+                    next[cell] = value < 0.01f ? 0.0f : value;
+                }
+            }
+            threat.swap(next);
+        }
+    }
+
+    bool checkCoverProbes() {
+        InfluenceMapSettings settings;
+        settings.width = 16;
+        settings.height = 16;
+        settings.cellSize = 1.0f;
+        InfluenceMap map(settings);
+        StaticBVH wall;
+        wall.addBox(glm::vec3(8.0f, 0.0f, 4.0f), glm::vec3(9.0f, 2.0f, 12.0f));     // Wall along Z at x = 8..9
+        wall.build();
+        map.buildCover(wall);
+
+        glm::vec3 west(7.5f, 0.0f, 8.5f);
+        glm::vec3 east(9.5f, 0.0f, 8.5f);
+        glm::vec3 inside(8.5f, 0.0f, 8.5f);
+        glm::vec3 open(2.5f, 0.0f, 2.5f);
+        return (map.getCoverMask(west) & 1) && (map.getCoverMask(east) & 16) && map.isBlocked(inside) &&
+               !map.isBlocked(west) && map.getCoverMask(open) == 0 &&
+               map.hasCoverFrom(west, glm::vec3(14.0f, 0.0f, 8.5f)) && !map.hasCoverFrom(west, glm::vec3(1.0f, 0.0f, 8.5f)) &&
+               map.sample(InfluenceLayer::COVER, inside) == 0.0f;
+    }
+}
+
+int main() {
+    std::cout << "Influence Map Benchmark" << std::endl;
+    std::mt19937 rng(5);
+    bool allCorrect = true;
+    std::unique_ptr<JobSystem> jobSystem = JobSystem::create(4, 0);
+
+    bool probes = checkCoverProbes();
+    std::cout << "Cover probes find walls and blocked cells: " << (probes ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && probes;
+
+    StaticBVH walls;
+    std::uniform_real_distribution<float> coordinate(0.0f, kGridSize * kCellSize);
+    std::uniform_real_distribution<float> length(2.0f, 10.0f);
+    std::uniform_real_distribution<float> height(1.5f, 4.0f);
+    for (int i = 0; i < kWallCount; ++i) {
+        glm::vec3 corner(coordinate(rng), 0.0f, coordinate(rng));
+        bool alongX = i % 2 == 0;
+        walls.addBox(corner, corner + glm::vec3(alongX ? length(rng) : 0.6f, height(rng), alongX ? 0.6f : length(rng)));
+    }
+    walls.build();
+    Threats threats = makeThreats(rng);
+
+    auto start = std::chrono::steady_clock::now();
+    std::unique_ptr<InfluenceMap> serial = buildMap(walls, threats, nullptr);
+    double coverMs = elapsedMs(start);
+    std::unique_ptr<InfluenceMap> parallel = buildMap(walls, threats, jobSystem.get());
+
+    // Threats move every update; both maps follow them
+    std::vector<float> reference(static_cast<size_t>(kGridSize) * kGridSize, 0.0f);
+    double serialMs = 0.0, parallelMs = 0.0, fullMs = 0.0, visibilityMs = 0.0;
+    int tilesPropagated = 0;
+    size_t visibilityRays = 0;
+    bool parallelMatches = true;
+    float maxThreatError = 0.0f;
+    for (int update = 0; update < kUpdates; ++update) {
+        if (update > 0) {
+            moveThreats(threats);
+            for (int i = 0; i < kThreatCount; ++i) {
+                serial->setThreatSourcePosition(i, threats.position[i]);
+                parallel->setThreatSourcePosition(i, threats.position[i]);
+            }
+        }
+        start = std::chrono::steady_clock::now();
+        serial->update();
+        serialMs += elapsedMs(start);
+        tilesPropagated += serial->getStats().tilesPropagated;
+        visibilityRays += serial->getStats().visibilityRays;
+        visibilityMs += serial->getStats().visibilityMs;
+
+        start = std::chrono::steady_clock::now();
+        parallel->update();
+        parallelMs += elapsedMs(start);
+
+        start = std::chrono::steady_clock::now();
+        propagateFull(*serial, threats, reference, serial->getSettings().propagationSteps);
+        fullMs += elapsedMs(start);
+
+        for (int cell = 0; cell < kGridSize * kGridSize; ++cell) {
+            glm::vec3 center = serial->getCellCenter(cell);
+            for (int layer = 0; layer < 3 && parallelMatches; ++layer) {
+                parallelMatches = serial->sample(static_cast<InfluenceLayer>(layer), center) ==
+                                  parallel->sample(static_cast<InfluenceLayer>(layer), center);
+            }
+            maxThreatError = std::max(maxThreatError, std::abs(serial->sample(InfluenceLayer::THREAT, center) - reference[cell]));
+        }
+    }
+    bool threatMatches = maxThreatError < 0.05f;   // Tiles stop once they change less than the settle threshold
+    std::cout << "Incremental threat matches full propagation (max error " << maxThreatError << "): "
+              << (threatMatches ? "ok" : "FAILED") << std::endl;
+    std::cout << "Parallel updates match serial: " << (parallelMatches ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && threatMatches && parallelMatches;
+
+    // Visibility after many moves, against rays to every cell
+    const InfluenceMapSettings& settings = serial->getSettings();
+    bool visibilityMatches = true;
+    for (int cell = 0; cell < kGridSize * kGridSize && visibilityMatches; ++cell) {
+        glm::vec3 center = serial->getCellCenter(cell);
+        float expected = 0.0f;
+        if (!serial->isBlocked(center)) {
+            for (const glm::vec3& threat : threats.position) {
+                glm::vec3 position = serial->getCellCenter(serial->getCell(threat));
+                glm::vec3 offset = center - position;
+                if (offset.x * offset.x + offset.z * offset.z > 30.0f * 30.0f) continue;
+                if (walls.isOccluded(position + glm::vec3(0.0f, settings.eyeHeight, 0.0f),
+                                     center + glm::vec3(0.0f, settings.targetHeight, 0.0f))) continue;
+                expected += 1.0f;
+            }
+        }
+        visibilityMatches = std::abs(serial->sample(InfluenceLayer::VISIBILITY, center) - expected) < 1e-4f;
+    }
+    std::cout << "Incremental visibility matches fresh raycasts: " << (visibilityMatches ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && visibilityMatches;
+
+    // Static threats settle and stop costing anything
+    int settleUpdates = 0;
+    while (settleUpdates < 200) {
+        serial->update();
+        ++settleUpdates;
+        if (serial->getStats().tilesPropagated == 0) break;
+    }
+    start = std::chrono::steady_clock::now();
+    serial->update();
+    double settledMs = elapsedMs(start);
+    bool settles = serial->getStats().tilesPropagated == 0;
+    std::cout << "Static threats settle after " << settleUpdates << " updates: " << (settles ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && settles;
+
+    // Batched scoring gives the same scores as one position at a time
+    TacticalQuery query = TacticalQuery::cover(threats.position[0] + glm::vec3(12.0f, 0.0f, 0.0f), threats.position[0], 40.0f);
+    std::vector<glm::vec3> candidates;
+    for (int i = 0; i < 10000; ++i) {
+        candidates.push_back(glm::vec3(coordinate(rng), 0.0f, coordinate(rng)));
+    }
+    std::vector<float> batchScores(candidates.size());
+    start = std::chrono::steady_clock::now();
+    serial->scorePositions(query, candidates.data(), candidates.size(), batchScores.data());
+    double batchMs = elapsedMs(start);
+    bool scoresMatch = true;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < candidates.size() && scoresMatch; ++i) {
+        float single;
+        serial->scorePositions(query, &candidates[i], 1, &single);
+        scoresMatch = single == batchScores[i];
+    }
+    double singleMs = elapsedMs(start);
+    std::cout << "Batched scores match single scores: " << (scoresMatch ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && scoresMatch;
+
+    // Cover and flank queries around every threat
+    bool coverFound = true;
+    bool flankFound = true;
+    int coverCount = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kThreatCount; ++i) {
+        glm::vec3 threat = threats.position[i];
+        glm::vec3 self = threat + glm::vec3(10.0f, 0.0f, 6.0f);
+        glm::vec3 cover;
+        if (serial->findCoverPosition(self, threat, 15.0f, cover)) {
+            ++coverCount;
+            coverFound = coverFound && serial->hasCoverFrom(cover, threat) && glm::distance(cover, self) <= 15.0f + kCellSize;
+        }
+        glm::vec3 flank;
+        if (serial->findFlankPosition(self, threat, 25.0f, flank)) {
+            glm::vec3 a = glm::normalize(self - threat);
+            glm::vec3 b = glm::normalize(flank - threat);
+            float angle = glm::degrees(std::acos(std::min(std::max(glm::dot(a, b), -1.0f), 1.0f)));
+            flankFound = flankFound && angle > 45.0f && angle < 135.0f;
+        } else {
+            flankFound = false;
+        }
+    }
+    double queryMs = elapsedMs(start) / (kThreatCount * 2);
+    coverFound = coverFound && coverCount > kThreatCount / 2;
+    std::cout << "Cover queries pick points covered from the threat (" << coverCount << "/" << kThreatCount << "): "
+              << (coverFound ? "ok" : "FAILED") << std::endl;
+    std::cout << "Flank queries pick points to the target's side: " << (flankFound ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && coverFound && flankFound;
+
+    std::cout << kGridSize << "x" << kGridSize << " cells, " << serial->getCoverPointCount() << " cover points precomputed in "
+              << coverMs << " ms" << std::endl;
+    std::cout << kUpdates << " updates with " << kThreatCount << " moving threats: " << serialMs / kUpdates
+              << " ms each serial (" << tilesPropagated / kUpdates << " of " << (kGridSize / 16) * (kGridSize / 16) * 2
+              << " tile steps, " << visibilityRays / kUpdates << " visibility rays in " << visibilityMs / kUpdates
+              << " ms), " << parallelMs / kUpdates << " ms on "
+              << jobSystem->getWorkerCount() << " workers; full propagation " << fullMs / kUpdates << " ms; settled "
+              << settledMs << " ms" << std::endl;
+    std::cout << "Scoring 10000 positions: " << batchMs << " ms batched, " << singleMs << " ms one at a time; "
+              << queryMs << " ms per cover or flank query" << std::endl;
+
+    std::cout << (allCorrect ? "Influence map benchmark passed!" : "Influence map benchmark FAILED!") << std::endl;
+    return allCorrect ? 0 : 1;
+}
@@ -0,0 +1,189 @@
+#include "../include/RenderQueue.h"
+#include "../include/GameObject.h"
+#include "../include/Mesh.h"
+#include "../include/Material.h"
+#include "../include/TimingUtils.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+using namespace Sparky;
+
+// Forests of identical crates, enemies and debris: many objects over a handful
+// of meshes and materials, mostly opaque with some transparent ones. Checks
+// that the queue's batches cover the sorted draws in order, that each is a
+// whole run of draws sharing pipeline, material and mesh, and that expanding
+// every batch into instances as the instanced pipeline does (instance data in
+// draw order, first instance = first draw) draws the same objects with the
+// same transforms in the same order as drawing them one at a time. Then
+// counts the draw calls instancing collapses and times building the queue and
+// filling the instance data per frame.
+
+namespace {
+    const int kObjects = 20000;
+    const int kMeshCount = 6;
+    const int kMaterialCount = 4;
+    const int kFrames = 200;
+    const float kFarDistance = 1000.0f;
+
+    struct SceneObject {
+        std::unique_ptr<GameObject> object;
+        RenderItem item;
+    };
+
+    void buildQueue(RenderQueue& queue, const std::vector<SceneObject>& scene, const glm::vec3& eye) {
+        queue.begin(eye, glm::vec3(0.0f, 0.0f, -1.0f), kFarDistance);
+        for (const SceneObject& object : scene) {
+            queue.add(object.item, object.object->getPosition());
+        }
+        queue.sort();
+    }
+}
+
+int main() {
+    std::cout << "Instancing Benchmark" << std::endl;
+    bool allCorrect = true;
+    std::mt19937 rng(50);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    std::vector<std::unique_ptr<Mesh>> meshes;
+    for (int i = 0; i < kMeshCount; ++i) {
+        meshes.push_back(std::make_unique<Mesh>());
+        meshes.back()->vertices.resize(3);
+        meshes.back()->indices = {0, 1, 2};
+    }
+    std::vector<std::unique_ptr<Material>> materials;
+    for (int i = 0; i < kMaterialCount; ++i) {
+        materials.push_back(std::make_unique<Material>("material" + std::to_string(i)));
+    }
+
+    RenderQueue queue;
+    std::vector<SceneObject> scene(kObjects);
+    std::uniform_int_distribution<int> pickMesh(0, kMeshCount - 1), pickMaterial(0, kMaterialCount - 1);
+    for (int i = 0; i < kObjects; ++i) {
+        SceneObject& object = scene[i];
+        object.object = std::make_unique<GameObject>("object" + std::to_string(i));
+        object.object->setPosition(glm::vec3((unit(rng) - 0.5f) * 400.0f, unit(rng) * 20.0f, -unit(rng) * 600.0f));
+        object.object->setScale(glm::vec3(0.5f + unit(rng)));
+
+        object.item.object = object.object.get();
+        object.item.mesh = meshes[pickMesh(rng)].get();
+        object.item.material = materials[pickMaterial(rng)].get();
+        object.item.pipeline = 0;
+        object.item.meshId = queue.acquireMeshId(object.item.mesh);
+        object.item.materialId = queue.acquireMaterialId(object.item.material);
+        object.item.layer = unit(rng) < 0.9f ? RenderLayer::OPAQUE_GEOMETRY : RenderLayer::TRANSPARENT_GEOMETRY;
+    }
+
+    const glm::vec3 eye(0.0f, 2.0f, 0.0f);
+    buildQueue(queue, scene, eye);
+    const std::vector<RenderDraw>& draws = queue.getDraws();
+    const std::vector<RenderBatch>& batches = queue.getBatches();
+    const RenderQueueStats& stats = queue.getStats();
+
+    // Batches cover the draws in order, each a whole run sharing state
+    bool batchesCorrect = !batches.empty();
+    uint32_t next = 0;
+    for (size_t b = 0; b < batches.size() && batchesCorrect; ++b) {
+        const RenderBatch& batch = batches[b];
+        batchesCorrect = batch.firstDraw == next && batch.drawCount > 0 && draws[batch.firstDraw].changes != 0;
+        for (uint32_t i = batch.firstDraw + 1; i < batch.firstDraw + batch.drawCount && batchesCorrect; ++i) {
+            const RenderItem& a = draws[i - 1].item;
+            const RenderItem& c = draws[i].item;
+            batchesCorrect = draws[i].changes == 0 && a.pipeline == c.pipeline && a.material == c.material && a.mesh == c.mesh;
+        }
+        next = batch.firstDraw + batch.drawCount;
+    }
+    batchesCorrect = batchesCorrect && next == draws.size();
+    std::cout << "Batches cover the draws as runs of shared state: " << (batchesCorrect ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && batchesCorrect;
+
+    // One batch per opaque mesh and material pair, and the counter adds up
+    std::set<std::pair<const Material*, const Mesh*>> opaquePairs;
+    int opaqueBatches = 0;
+    for (const RenderBatch& batch : batches) {
+        const RenderItem& item = draws[batch.firstDraw].item;
+        if (item.layer != RenderLayer::OPAQUE_GEOMETRY) continue;
+        opaquePairs.insert({item.material, item.mesh});
+        ++opaqueBatches;
+    }
+    bool countsCorrect = opaqueBatches == static_cast<int>(opaquePairs.size()) &&
+                         stats.batches == static_cast<int>(batches.size()) && stats.collapsedDraws == stats.draws - stats.batches;
+    std::cout << "Draws " << stats.draws << " in " << stats.batches << " instanced draws (" << opaqueBatches << " opaque), "
+              << stats.collapsedDraws << " collapsed: " << (countsCorrect ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && countsCorrect;
+
+    // Instanced recording draws the same objects with the same transforms in the same order
+    std::vector<glm::mat4> instances(draws.size());
+    for (size_t i = 0; i < draws.size(); ++i) {
+        instances[i] = draws[i].item.object->getTransformMatrix();
+    }
+    bool instancesCorrect = true;
+    size_t drawn = 0;
+    for (const RenderBatch& batch : batches) {
+        const RenderItem& bound = draws[batch.firstDraw].item;
+        for (uint32_t instance = batch.firstDraw; instance < batch.firstDraw + batch.drawCount; ++instance) {
+            const RenderItem& expected = draws[drawn].item;
+            glm::mat4 pushed = expected.object->getTransformMatrix();
+            instancesCorrect = instancesCorrect && bound.mesh == expected.mesh && bound.material == expected.material &&
+                               std::memcmp(&instances[instance], &pushed, sizeof(glm::mat4)) == 0;
+            ++drawn;
+        }
+    }
+    instancesCorrect = instancesCorrect && drawn == draws.size();
+    std::cout << "Instanced draws match drawing one at a time: " << (instancesCorrect ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && instancesCorrect;
+
+    // Nothing to merge when every object has its own mesh
+    {
+        RenderQueue uniqueQueue;
+        std::vector<std::unique_ptr<Mesh>> uniqueMeshes;
+        uniqueQueue.begin(eye, glm::vec3(0.0f, 0.0f, -1.0f), kFarDistance);
+        for (int i = 0; i < 1000; ++i) {
+            uniqueMeshes.push_back(std::make_unique<Mesh>());
+            RenderItem item = scene[i].item;
+            item.mesh = uniqueMeshes.back().get();
+            item.meshId = uniqueQueue.acquireMeshId(item.mesh);
+            item.materialId = uniqueQueue.acquireMaterialId(item.material);
+            uniqueQueue.add(item, scene[i].object->getPosition());
+        }
+        uniqueQueue.sort();
+        bool uniqueCorrect = uniqueQueue.getStats().batches == 1000 && uniqueQueue.getStats().collapsedDraws == 0;
+        std::cout << "Unique meshes stay one draw each: " << (uniqueCorrect ? "ok" : "FAILED") << std::endl;
+        allCorrect = allCorrect && uniqueCorrect;
+    }
+
+    // Camera strafing across the scene; the queue and the instance data are rebuilt every frame
+    double queueMs = 0.0, instanceMs = 0.0;
+    int totalBatches = 0;
+    for (int frame = 0; frame < kFrames; ++frame) {
+        glm::vec3 frameEye = eye + glm::vec3(frame * 0.5f - 50.0f, 0.0f, 0.0f);
+
+        auto start = std::chrono::steady_clock::now();
+        buildQueue(queue, scene, frameEye);
+        queueMs += elapsedMs(start);
+
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < queue.getDraws().size(); ++i) {
+            instances[i] = queue.getDraws()[i].item.object->getTransformMatrix();
+        }
+        instanceMs += elapsedMs(start);
+        totalBatches += queue.getStats().batches;
+    }
+
+    std::cout << kObjects << " objects per frame: " << totalBatches / kFrames << " draw calls instead of " << kObjects
+              << " (" << static_cast<double>(kObjects) * kFrames / totalBatches << "x fewer), queue "
+              << queueMs / kFrames << " ms, instance data " << instanceMs / kFrames << " ms" << std::endl;
+
+    if (allCorrect) {
+        std::cout << "Instancing benchmark passed!" << std::endl;
+        return 0;
+    }
+    std::cout << "Instancing benchmark FAILED!" << std::endl;
+    return 1;
+}
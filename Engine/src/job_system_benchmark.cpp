@@ -0,0 +1,152 @@
+#include "../include/JobSystem.h"
+#include "../include/TimingUtils.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Sparky;
+
+// Benchmarks the job system against thread count:
+//  - recursive fib with one job per call above a cutoff
+//  - parallelFor over 10M elements
+//  - a layered dependency DAG built from continuations
+
+static long long fibSerial(int n) {
+    return n < 2 ? n : fibSerial(n - 1) + fibSerial(n - 2);
+}
+
+static long long fibJobs(JobSystem& jobs, int n) {
+    if (n < 20) return fibSerial(n);
+
+    long long left = 0;
+    JobCounter counter;
+    jobs.run([&jobs, &left, n]() { left = fibJobs(jobs, n - 1); }, &counter, "fib");
+    long long right = fibJobs(jobs, n - 2);
+    jobs.wait(counter);
+    return left + right;
+}
+
+struct BenchmarkResult {
+    double fibMs;
+    double parallelForMs;
+    double dagMs;
+    bool correct;
+};
+
+static BenchmarkResult runBenchmarks(unsigned int threadCount, std::vector<float>& data) {
+    // The calling thread helps while waiting, so threadCount - 1 workers
+    auto jobs = JobSystem::create(threadCount > 1 ? threadCount - 1 : 0, 0);
+    if (threadCount <= 1) {
+        jobs->shutdown();
+    }
+
+    BenchmarkResult result{};
+    result.correct = true;
+
+    // Fib
+    const int fibN = 32;
+    auto start = std::chrono::steady_clock::now();
+    long long fib = fibJobs(*jobs, fibN);
+    result.fibMs = elapsedMs(start);
+    result.correct = result.correct && fib == 2178309;
+
+    // parallelFor over 10M elements
+    start = std::chrono::steady_clock::now();
+    jobs->parallelFor(data.size(), 0, [&data](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            data[i] = std::sqrt(static_cast<float>(i)) * 0.5f + 1.0f;
+        }
+    });
+    result.parallelForMs = elapsedMs(start);
+    result.correct = result.correct && data[4] == 2.0f && data[data.size() - 1] > 1.0f;
+
+    // Dependency DAG: each layer starts when the previous layer finishes
+    const int layers = 64;
+    const int jobsPerLayer = 64;
+    std::atomic<int> executed(0);
+    std::atomic<int> orderViolations(0);
+    std::vector<std::unique_ptr<JobCounter>> layerCounters;
+    for (int layer = 0; layer < layers; ++layer) {
+        layerCounters.push_back(std::make_unique<JobCounter>());
+    }
+
+    start = std::chrono::steady_clock::now();
+    for (int layer = 0; layer < layers; ++layer) {
+        for (int i = 0; i < jobsPerLayer; ++i) {
+            Job work = [&executed, &orderViolations, layer, jobsPerLayer]() {
+                if (executed.load() < layer * jobsPerLayer) {
+                    orderViolations.fetch_add(1);
+                }
+                volatile float sink = 0.0f;
+                for (int k = 0; k < 2000; ++k) sink = sink + std::sin(static_cast<float>(k));
+                executed.fetch_add(1);
+            };
+            if (layer == 0) {
+                jobs->run(work, layerCounters[0].get(), "dag");
+            } else {
+                jobs->runAfter(*layerCounters[layer - 1], work, layerCounters[layer].get(), "dag");
+            }
+        }
+    }
+    jobs->wait(*layerCounters[layers - 1]);
+    result.dagMs = elapsedMs(start);
+    result.correct = result.correct && executed.load() == layers * jobsPerLayer && orderViolations.load() == 0;
+
+    jobs->shutdown();
+    return result;
+}
+
+int main() {
+    std::cout << "Job System Benchmark" << std::endl;
+
+    unsigned int hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    unsigned int maxThreads = std::max(4u, hardwareThreads);
+    std::cout << "Hardware threads: " << hardwareThreads << std::endl;
+
+    std::vector<float> data(10 * 1000 * 1000);
+    bool allCorrect = true;
+    double baseline[3] = {0.0, 0.0, 0.0};
+
+    std::cout << "threads | fib(32) ms | parallelFor(10M) ms | DAG(64x64) ms | speedup (fib/pfor/dag)" << std::endl;
+    for (unsigned int threads = 1; threads <= maxThreads; threads *= 2) {
+        BenchmarkResult result = runBenchmarks(threads, data);
+        if (threads == 1) {
+            baseline[0] = result.fibMs;
+            baseline[1] = result.parallelForMs;
+            baseline[2] = result.dagMs;
+        }
+
+        std::cout << threads << " | " << result.fibMs << " | " << result.parallelForMs << " | " << result.dagMs
+                  << " | " << baseline[0] / result.fibMs << "x / " << baseline[1] / result.parallelForMs
+                  << "x / " << baseline[2] / result.dagMs << "x"
+                  << (result.correct ? "" : "  (INCORRECT)") << std::endl;
+        allCorrect = allCorrect && result.correct;
+    }
+
+    // I/O threads and profiler hooks
+    auto jobs = JobSystem::create(2, 1);
+    std::atomic<int> hookCalls(0);
+    JobProfilerHooks hooks;
+    hooks.onJobBegin = [&hookCalls](const char*, int) { hookCalls.fetch_add(1); };
+    jobs->setProfilerHooks(hooks);
+
+    JobCounter ioCounter;
+    std::atomic<bool> ranOnWorker(false);
+    jobs->runIO([&jobs, &ranOnWorker]() { ranOnWorker = jobs->getCurrentWorkerIndex() >= 0; }, &ioCounter, "io");
+    jobs->wait(ioCounter);
+    JobSystemStats stats = jobs->getStats();
+    jobs->shutdown();
+
+    bool ioCorrect = !ranOnWorker && stats.ioJobsExecuted == 1 && hookCalls.load() == 1;
+    std::cout << "I/O thread isolation and profiler hooks: " << (ioCorrect ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && ioCorrect;
+
+    std::cout << (allCorrect ? "Job system benchmark passed!" : "Job system benchmark FAILED!") << std::endl;
+    return allCorrect ? 0 : 1;
+}
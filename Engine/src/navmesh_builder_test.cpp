@@ -0,0 +1,226 @@
+#include "../include/NavMeshBuilder.h"
+#include "../include/NavPolyMesh.h"
+#include "../include/AdvancedAI.h"
+#include "../include/JobSystem.h"
+#include "../include/Mesh.h"
+#include "../include/TimingUtils.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace Sparky;
+
+// Builds navmeshes from engine meshes (floor, wall, ramp up to a platform),
+// checks the polygons and the funnel-smoothed paths through them, the build
+// cache, and that a JobSystem build matches a single-threaded one.
+
+namespace {
+    glm::mat4 boxTransform(const glm::vec3& center, const glm::vec3& size) {
+        return glm::scale(glm::translate(glm::mat4(1.0f), center), size);
+    }
+
+    // Ramp from (x0, 0) up to (x1, height) across z0..z1, wound counter-clockwise from above
+    void addRamp(NavMeshBuilder& builder, float x0, float x1, float z0, float z1, float height) {
+        std::vector<glm::vec3> vertices = {
+            glm::vec3(x0, 0.0f, z0), glm::vec3(x1, height, z0), glm::vec3(x1, height, z1), glm::vec3(x0, 0.0f, z1)
+        };
+        builder.addTriangles(vertices, {0, 2, 1, 0, 3, 2});
+    }
+
+    void addLevel(NavMeshBuilder& builder) {
+        auto plane = Mesh::createPlane(40.0f, 40.0f);
+        auto cube = Mesh::createCube(1.0f);
+        builder.addMesh(*plane, glm::translate(glm::mat4(1.0f), glm::vec3(20.0f, 0.0f, 20.0f)));
+        builder.addMesh(*cube, boxTransform(glm::vec3(20.0f, 1.5f, 20.0f), glm::vec3(10.0f, 3.0f, 2.0f)));  // Wall
+        builder.addMesh(*cube, boxTransform(glm::vec3(34.0f, 1.0f, 6.0f), glm::vec3(8.0f, 2.0f, 8.0f)));    // Platform
+        addRamp(builder, 24.0f, 30.0f, 4.0f, 8.0f, 2.0f);
+    }
+
+    bool checkPolygons(const NavPolyMesh& mesh) {
+        for (int p = 0; p < mesh.getPolyCount(); ++p) {
+            const NavPoly& poly = mesh.getPoly(p);
+            if (poly.vertCount < 3 || poly.vertCount > NavPoly::MAX_VERTS) return false;
+            for (int i = 0; i < poly.vertCount; ++i) {
+                const glm::vec3& a = mesh.getVertex(poly.verts[i]);
+                const glm::vec3& b = mesh.getVertex(poly.verts[(i + 1) % poly.vertCount]);
+                const glm::vec3& c = mesh.getVertex(poly.verts[(i + 2) % poly.vertCount]);
+                if ((b.x - a.x) * (c.z - a.z) - (b.z - a.z) * (c.x - a.x) < -1e-4f) return false; // Convex
+                int neighbor = poly.neighbors[i];
+                if (neighbor >= 0) {
+                    glm::vec3 left, right;
+                    if (!mesh.getPortal(neighbor, p, left, right)) return false; // Symmetric
+                }
+            }
+            if (poly.detailTriangleCount == 0) return false;
+        }
+        return true;
+    }
+
+    float pathLength(const std::vector<glm::vec3>& path) {
+        float length = 0.0f;
+        for (size_t i = 1; i < path.size(); ++i) length += glm::distance(path[i - 1], path[i]);
+        return length;
+    }
+
+    // Every point along the path lies on some polygon
+    bool pathOnMesh(const NavPolyMesh& mesh, const std::vector<glm::vec3>& path) {
+        for (size_t i = 1; i < path.size(); ++i) {
+            float length = glm::distance(path[i - 1], path[i]);
+            int steps = static_cast<int>(length / 0.1f) + 1;
+            for (int s = 0; s <= steps; ++s) {
+                glm::vec3 point = path[i - 1] + (path[i] - path[i - 1]) * (static_cast<float>(s) / steps);
+                if (mesh.findPoly(point, 0.05f) == -1) return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main() {
+    std::cout << "NavMesh Builder Test" << std::endl;
+    bool allCorrect = true;
+    auto report = [&](const char* name, bool ok) {
+        std::cout << name << ": " << (ok ? "ok" : "FAILED") << std::endl;
+        allCorrect = allCorrect && ok;
+    };
+
+    JobSystem serial; // Never initialized: parallelFor runs inline
+    NavMeshBuildConfig config;
+
+    NavMeshBuilder builder;
+    builder.setJobSystem(&serial);
+    addLevel(builder);
+    std::shared_ptr<NavPolyMesh> polyMesh = builder.build(config);
+    if (!polyMesh) {
+        std::cout << "Build: FAILED" << std::endl;
+        return 1;
+    }
+    const NavMeshBuildStats& stats = builder.getStats();
+    std::cout << "Built " << stats.polyCount << " polygons, " << stats.regionCount << " regions, "
+              << stats.detailTriangleCount << " detail triangles from " << stats.spanCount << " spans in "
+              << stats.totalMs << " ms" << std::endl;
+    report("Convex linked polygons", checkPolygons(*polyMesh));
+
+    NavigationMesh navMesh;
+    navMesh.setPolyMesh(polyMesh);
+
+    // The floor stops at the wall: whatever lies inside the box (its top, the
+    // enclosed floor) cannot be reached from outside. The floor and the
+    // platform top are covered.
+    std::vector<int> corridor;
+    int floorPoly = polyMesh->findPoly(glm::vec3(5.0f, 0.0f, 30.0f), 0.0f);
+    bool wallClear = floorPoly != -1;
+    for (float x = 15.2f; x < 25.0f && wallClear; x += 0.5f) {
+        for (float z = 19.2f; z < 21.0f && wallClear; z += 0.4f) {
+            int poly = polyMesh->findPoly(glm::vec3(x, 0.0f, z), 0.0f);
+            wallClear = poly == -1 || !navMesh.findNodePath(floorPoly, poly, corridor);
+        }
+    }
+    float platformHeight = 0.0f;
+    int platformPoly = polyMesh->findPoly(glm::vec3(34.0f, 2.0f, 6.0f), 0.0f);
+    bool covered = platformPoly != -1 &&
+                   polyMesh->getPolyHeight(platformPoly, glm::vec3(34.0f, 2.0f, 6.0f), platformHeight) &&
+                   std::fabs(platformHeight - 2.0f) < 0.3f;
+    report("Walls cut out, floors covered", wallClear && covered);
+
+    // Around the wall: a handful of corners, not one waypoint per polygon
+    glm::vec3 start(20.0f, 0.0f, 10.0f), goal(20.0f, 0.0f, 30.0f);
+    std::vector<glm::vec3> path = navMesh.findPath(start, goal);
+    navMesh.findNodePath(polyMesh->findPoly(start), polyMesh->findPoly(goal), corridor);
+    std::vector<glm::vec3> centerPath(1, start);
+    for (int poly : corridor) centerPath.push_back(polyMesh->getPolyCenter(poly));
+    centerPath.push_back(goal);
+    std::cout << "Around the wall: " << path.size() << " waypoints, " << pathLength(path) << " m (polygon centers: "
+              << pathLength(centerPath) << " m)" << std::endl;
+    report("Smoothed path around wall",
+           path.size() >= 3 && path.size() <= 6 && pathOnMesh(*polyMesh, path) &&
+           pathLength(path) > 22.0f && pathLength(path) < 26.0f && pathLength(path) <= pathLength(centerPath) &&
+           glm::distance(path.back(), goal) < 0.3f);
+
+    // Up the ramp onto the platform
+    glm::vec3 platformGoal(34.0f, 2.0f, 6.0f);
+    path = navMesh.findPath(glm::vec3(20.0f, 0.0f, 6.0f), platformGoal);
+    bool usesRamp = false;
+    for (size_t i = 1; i < path.size(); ++i) {
+        glm::vec3 middle = (path[i - 1] + path[i]) * 0.5f;
+        usesRamp = usesRamp || (middle.x > 24.0f && middle.x < 30.0f && middle.z > 4.0f && middle.z < 8.0f);
+    }
+    report("Path up the ramp",
+           !path.empty() && pathOnMesh(*polyMesh, path) && std::fabs(path.back().y - 2.0f) < 0.3f &&
+           (usesRamp || path.size() == 2));
+
+    // Too steep to walk
+    NavMeshBuilder steep;
+    steep.setJobSystem(&serial);
+    addRamp(steep, 0.0f, 4.0f, 0.0f, 4.0f, 8.0f);
+    report("Steep slopes rejected", steep.build(config) == nullptr);
+
+    // Cache: the second build loads, changed geometry rebuilds
+    const std::string cachePath = "navmesh_builder_test.nav";
+    std::remove(cachePath.c_str());
+    auto built = builder.buildCached(config, cachePath);
+    bool firstBuilt = built && !builder.getStats().loadedFromCache;
+    auto cached = builder.buildCached(config, cachePath);
+    bool sameMesh = cached && builder.getStats().loadedFromCache && cached->getPolyCount() == built->getPolyCount() &&
+                    cached->getVertexCount() == built->getVertexCount() &&
+                    cached->getDetailTriangles() == built->getDetailTriangles();
+    for (size_t v = 0; sameMesh && v < built->getVertexCount(); ++v) {
+        sameMesh = cached->getVertex(static_cast<int>(v)) == built->getVertex(static_cast<int>(v));
+    }
+    addRamp(builder, 2.0f, 6.0f, 2.0f, 4.0f, 0.5f);
+    auto rebuilt = builder.buildCached(config, cachePath);
+    bool stale = rebuilt && !builder.getStats().loadedFromCache;
+    std::remove(cachePath.c_str());
+    report("Build cache", firstBuilt && sameMesh && stale);
+
+    // Bigger level: serial against the JobSystem, which must agree exactly
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> coordinate(5.0f, 195.0f);
+    std::uniform_real_distribution<float> extent(1.0f, 6.0f);
+    auto plane = Mesh::createPlane(200.0f, 200.0f);
+    auto cube = Mesh::createCube(1.0f);
+    NavMeshBuilder large;
+    large.addMesh(*plane, glm::translate(glm::mat4(1.0f), glm::vec3(100.0f, 0.0f, 100.0f)));
+    for (int i = 0; i < 400; ++i) {
+        float height = extent(rng) * 0.5f;
+        large.addMesh(*cube, boxTransform(glm::vec3(coordinate(rng), height * 0.5f, coordinate(rng)),
+                                          glm::vec3(extent(rng), height, extent(rng))));
+    }
+
+    large.setJobSystem(&serial);
+    auto serialMesh = large.build(config);
+    NavMeshBuildStats serialStats = large.getStats();
+
+    auto jobs = JobSystem::create(0);
+    large.setJobSystem(jobs.get());
+    auto startTime = std::chrono::steady_clock::now();
+    auto parallelMesh = large.build(config);
+    double parallelMs = elapsedMs(startTime);
+    NavMeshBuildStats parallelStats = large.getStats();
+
+    bool identical = serialMesh && parallelMesh && serialMesh->getPolyCount() == parallelMesh->getPolyCount() &&
+                     serialMesh->getVertexCount() == parallelMesh->getVertexCount() &&
+                     serialMesh->getDetailVertices().size() == parallelMesh->getDetailVertices().size();
+    for (size_t v = 0; identical && v < serialMesh->getVertexCount(); ++v) {
+        identical = serialMesh->getVertex(static_cast<int>(v)) == parallelMesh->getVertex(static_cast<int>(v));
+    }
+    std::cout << "200x200 m level, " << large.getTriangleCount() << " triangles, " << serialStats.gridWidth << "x"
+              << serialStats.gridHeight << " cells, " << serialStats.polyCount << " polygons" << std::endl;
+    std::cout << "  single thread: " << serialStats.totalMs << " ms (rasterize " << serialStats.rasterizeMs
+              << ", filter " << serialStats.filterMs << ", regions " << serialStats.regionMs << ", contours "
+              << serialStats.contourMs << ", polygons " << serialStats.polyMs << ", detail " << serialStats.detailMs
+              << ")" << std::endl;
+    std::cout << "  " << (jobs->getWorkerCount() + 1) << " threads:     " << parallelMs << " ms (rasterize "
+              << parallelStats.rasterizeMs << ", filter " << parallelStats.filterMs << ", regions "
+              << parallelStats.regionMs << ", contours " << parallelStats.contourMs << ", polygons "
+              << parallelStats.polyMs << ", detail " << parallelStats.detailMs << ")" << std::endl;
+    report("Parallel build matches serial", identical && checkPolygons(*parallelMesh));
+
+    jobs->shutdown();
+    std::cout << (allCorrect ? "NavMesh builder test passed!" : "NavMesh builder test FAILED!") << std::endl;
+    return allCorrect ? 0 : 1;
+}
@@ -0,0 +1,263 @@
+#include "../include/AdvancedAI.h"
+#include "../include/JobSystem.h"
+#include "../include/PathQueryService.h"
+#include "../include/TimingUtils.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace Sparky;
+
+// A squad of 50 agents repaths in the same frame. Compares the frame spike
+// of synchronous findPath calls with the time-sliced service, checks that
+// service results match findPath, and checks merging, caching, priorities,
+// cancellation, worker-thread mode and obstacle edits during worker searches.
+
+namespace {
+    const int kGridSize = 100;
+    const int kAgentCount = 50;
+
+    void buildGridMesh(NavigationMesh& mesh, std::mt19937& rng) {
+        std::uniform_real_distribution<float> roll(0.0f, 1.0f);
+        for (int z = 0; z < kGridSize; ++z) {
+            for (int x = 0; x < kGridSize; ++x) {
+                NavNode node;
+                node.position = glm::vec3(static_cast<float>(x), 0.0f, static_cast<float>(z));
+                node.cost = 1.0f;
+                node.walkable = roll(rng) <= 0.75f;
+                mesh.addNode(node);
+            }
+        }
+        for (int z = 0; z < kGridSize; ++z) {
+            for (int x = 0; x < kGridSize; ++x) {
+                for (int dz = -1; dz <= 1; ++dz) {
+                    for (int dx = -1; dx <= 1; ++dx) {
+                        int nx = x + dx, nz = z + dz;
+                        if ((dx || dz) && nx >= 0 && nx < kGridSize && nz >= 0 && nz < kGridSize) {
+                            mesh.addConnection(z * kGridSize + x, nz * kGridSize + nx);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // A point just off a walkable node, so every point in the node's query cell
+    // snaps to the same node
+    glm::vec3 pickPoint(const NavigationMesh& mesh, std::mt19937& rng) {
+        std::uniform_int_distribution<int> pickNode(0, mesh.getNodeCount() - 1);
+        std::uniform_real_distribution<float> jitter(0.0f, 0.2f);
+        int node;
+        do {
+            node = pickNode(rng);
+        } while (!mesh.getNode(node).walkable);
+        return mesh.getNode(node).position + glm::vec3(jitter(rng), 0.0f, jitter(rng));
+    }
+
+    // Runs frames until every ticket has an answer; returns false if one never came
+    bool collect(PathQueryService& service, const std::vector<PathTicket>& tickets,
+                 std::vector<std::vector<glm::vec3>>& paths, int& frames, double& worstFrameMs) {
+        paths.assign(tickets.size(), std::vector<glm::vec3>());
+        std::vector<bool> done(tickets.size(), false);
+        size_t remaining = tickets.size();
+        frames = 0;
+        worstFrameMs = 0.0;
+        while (remaining > 0 && frames < 100000) {
+            service.update();
+            worstFrameMs = std::max(worstFrameMs, service.getStats().lastUpdateMs);
+            ++frames;
+            for (size_t i = 0; i < tickets.size(); ++i) {
+                if (!done[i] && service.takeResult(tickets[i], paths[i])) {
+                    done[i] = true;
+                    --remaining;
+                }
+            }
+            if (remaining > 0 && service.getStats().inFlight > 0) {
+                std::this_thread::yield();
+            }
+        }
+        return remaining == 0;
+    }
+}
+
+int main() {
+    std::cout << "Path Query Benchmark" << std::endl;
+    std::mt19937 rng(7);
+    bool allCorrect = true;
+
+    NavigationMesh mesh;
+    buildGridMesh(mesh, rng);
+    mesh.getGraph();
+
+    // Squad members stand in pairs, and the squad heads for a few rally points
+    std::vector<glm::vec3> starts;
+    std::vector<glm::vec3> ends;
+    std::vector<glm::vec3> rallyPoints;
+    for (int i = 0; i < 8; ++i) {
+        rallyPoints.push_back(pickPoint(mesh, rng));
+    }
+    for (int i = 0; i < kAgentCount; ++i) {
+        if (i % 2 == 1) {
+            starts.push_back(starts.back() + glm::vec3(0.05f, 0.0f, 0.05f));
+            ends.push_back(ends.back());
+        } else {
+            starts.push_back(pickPoint(mesh, rng));
+            ends.push_back(rallyPoints[(i / 2) % rallyPoints.size()]);
+        }
+    }
+
+    // Synchronous: everyone searches in the same frame
+    std::vector<std::vector<glm::vec3>> expected(kAgentCount);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kAgentCount; ++i) {
+        expected[i] = mesh.findPath(starts[i], ends[i]);
+    }
+    double syncFrameMs = elapsedMs(start);
+
+    // Time-sliced on the main thread
+    PathQuerySettings slicedSettings;
+    slicedSettings.mode = PathQueryMode::TIME_SLICED;
+    slicedSettings.frameBudgetMs = 0.5f;
+    std::unique_ptr<PathQueryService> sliced = PathQueryService::create(&mesh, slicedSettings);
+
+    std::vector<PathTicket> tickets;
+    for (int i = 0; i < kAgentCount; ++i) {
+        tickets.push_back(sliced->submit(starts[i], ends[i]));
+    }
+    std::vector<std::vector<glm::vec3>> paths;
+    int frames = 0;
+    double worstFrameMs = 0.0;
+    bool answered = collect(*sliced, tickets, paths, frames, worstFrameMs);
+    bool matches = answered && paths == expected;
+    std::cout << "Time-sliced results match findPath: " << (matches ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && matches;
+
+    PathQueryStats stats = sliced->getStats();
+    std::cout << "Squad repath: synchronous frame " << syncFrameMs << " ms, time-sliced worst frame "
+              << worstFrameMs << " ms over " << frames << " frames" << std::endl;
+    std::cout << "Searches " << stats.completed << " for " << stats.submitted << " tickets, peak queue "
+              << stats.peakQueueDepth << ", latency avg " << stats.averageLatencyMs << " ms, max "
+              << stats.maxLatencyMs << " ms" << std::endl;
+    bool merged = stats.deduplicated == kAgentCount / 2 && stats.completed == kAgentCount / 2;
+    std::cout << "Duplicate requests merged: " << (merged ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && merged;
+
+    // The same orders again come from the cache
+    sliced->resetStats();
+    tickets.clear();
+    for (int i = 0; i < kAgentCount; ++i) {
+        tickets.push_back(sliced->submit(starts[i], ends[i]));
+    }
+    answered = collect(*sliced, tickets, paths, frames, worstFrameMs);
+    stats = sliced->getStats();
+    bool cached = answered && paths == expected && stats.cacheHits == kAgentCount && stats.completed == 0;
+    std::cout << "Repeated requests served from cache: " << (cached ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && cached;
+
+    // Editing the mesh retires cached paths
+    NavNode extra;
+    extra.position = glm::vec3(-50.0f, 0.0f, -50.0f);
+    extra.cost = 1.0f;
+    extra.walkable = true;
+    mesh.addNode(extra);
+    sliced->resetStats();
+    PathTicket afterEdit = sliced->submit(starts[0], ends[0]);
+    sliced->flush();
+    std::vector<glm::vec3> editedPath;
+    stats = sliced->getStats();
+    bool retired = sliced->takeResult(afterEdit, editedPath) && stats.cacheHits == 0 && stats.completed == 1 &&
+                   editedPath == expected[0];
+    std::cout << "Mesh edit retires cache: " << (retired ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && retired;
+
+    // Priorities: with no budget each update runs exactly one search
+    PathQuerySettings orderSettings;
+    orderSettings.mode = PathQueryMode::TIME_SLICED;
+    orderSettings.frameBudgetMs = 0.0f;
+    orderSettings.cacheCapacity = 0;
+    PathQueryService ordered(&mesh, orderSettings);
+    PathTicket low = ordered.submit(starts[0], ends[0], PathQueryPriority::LOW);
+    PathTicket normal = ordered.submit(starts[2], ends[2], PathQueryPriority::NORMAL);
+    PathTicket high = ordered.submit(starts[4], ends[4], PathQueryPriority::HIGH);
+    PathTicket bumped = ordered.submit(starts[0], ends[0], PathQueryPriority::HIGH);
+    ordered.update();
+    bool firstRound = ordered.getStatus(high) == PathQueryStatus::PENDING &&
+                      ordered.getStatus(low) != PathQueryStatus::PENDING &&
+                      ordered.getStatus(bumped) != PathQueryStatus::PENDING;
+    ordered.update();
+    bool secondRound = ordered.getStatus(high) != PathQueryStatus::PENDING &&
+                       ordered.getStatus(normal) == PathQueryStatus::PENDING;
+    ordered.update();
+    bool thirdRound = ordered.getStatus(normal) != PathQueryStatus::PENDING;
+    bool prioritized = firstRound && secondRound && thirdRound;
+    std::cout << "Priority order: " << (prioritized ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && prioritized;
+
+    // Cancelling the only ticket drops the search
+    ordered.resetStats();
+    PathTicket cancelled = ordered.submit(starts[6], ends[6]);
+    ordered.cancel(cancelled);
+    ordered.update();
+    std::vector<glm::vec3> unused;
+    stats = ordered.getStats();
+    bool dropped = ordered.getStatus(cancelled) == PathQueryStatus::UNKNOWN && !ordered.takeResult(cancelled, unused) &&
+                   stats.cancelled == 1 && stats.completed == 0 && stats.queueDepth == 0;
+    std::cout << "Cancel: " << (dropped ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && dropped;
+
+    // Worker threads
+    std::unique_ptr<JobSystem> jobSystem = JobSystem::create(2, 0);
+    PathQuerySettings workerSettings;
+    workerSettings.mode = PathQueryMode::WORKER_THREADS;
+    workerSettings.maxConcurrentQueries = 8;
+    {
+        PathQueryService threaded(&mesh, workerSettings);
+        threaded.setJobSystem(jobSystem.get());
+        tickets.clear();
+        for (int i = 0; i < kAgentCount; ++i) {
+            tickets.push_back(threaded.submit(starts[i], ends[i]));
+        }
+        answered = collect(threaded, tickets, paths, frames, worstFrameMs);
+        stats = threaded.getStats();
+        bool threadedMatches = answered && paths == expected;
+        std::cout << "Worker results match findPath: " << (threadedMatches ? "ok" : "FAILED") << std::endl;
+        std::cout << "Worker mode: worst frame " << worstFrameMs << " ms over " << frames
+                  << " frames, latency avg " << stats.averageLatencyMs << " ms" << std::endl;
+        allCorrect = allCorrect && threadedMatches;
+
+        // Obstacles toggled while searches the cache cannot answer are in flight
+        std::vector<int> blocked;
+        for (int node = 0; node < mesh.getNodeCount() && blocked.size() < 200; node += 37) {
+            if (mesh.getNode(node).walkable) blocked.push_back(node);
+        }
+        tickets.clear();
+        for (int i = 0; i < kAgentCount; ++i) {
+            tickets.push_back(threaded.submit(ends[i], starts[i]));
+        }
+        threaded.update();
+        for (int round = 0; round < 4; ++round) {
+            for (int node : blocked) {
+                mesh.setNodeWalkable(node, round % 2 == 0 ? false : true);
+            }
+        }
+        answered = collect(threaded, tickets, paths, frames, worstFrameMs);
+        bool restored = answered;
+        for (int i = 0; i < kAgentCount && restored; ++i) {
+            restored = mesh.findPath(starts[i], ends[i]) == expected[i];
+        }
+        std::cout << "Obstacles toggled during worker searches: " << (restored ? "ok" : "FAILED") << std::endl;
+        allCorrect = allCorrect && restored;
+
+        // Left in flight on purpose; the destructor waits for them
+        for (int i = 0; i < kAgentCount; ++i) {
+            threaded.submit(starts[i] + glm::vec3(0.0f, 1.0f, 0.0f), ends[i]);
+        }
+        threaded.update();
+    }
+
+    std::cout << (allCorrect ? "Path query benchmark passed!" : "Path query benchmark FAILED!") << std::endl;
+    return allCorrect ? 0 : 1;
+}
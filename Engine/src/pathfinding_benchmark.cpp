@@ -0,0 +1,168 @@
+#include "../include/AdvancedAI.h"
+#include "../include/NavGraph.h"
+#include "../include/TimingUtils.h"
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <queue>
+#include <random>
+#include <vector>
+
+using namespace Sparky;
+
+// Checks A* on NavigationMesh against a reference Dijkstra on a 10k-node
+// grid with obstacles and weighted terrain, checks the spatial grid against
+// a linear nearest-node scan, and reports query throughput.
+
+namespace {
+    const int kGridSize = 100;
+
+    void buildGridMesh(NavigationMesh& mesh, std::mt19937& rng) {
+        std::uniform_real_distribution<float> roll(0.0f, 1.0f);
+        for (int z = 0; z < kGridSize; ++z) {
+            for (int x = 0; x < kGridSize; ++x) {
+                float r = roll(rng);
+                NavNode node;
+                node.position = glm::vec3(static_cast<float>(x), 0.0f, static_cast<float>(z));
+                node.cost = r < 0.1f ? 3.0f : 1.0f; // Some mud
+                node.walkable = r <= 0.8f;
+                mesh.addNode(node);
+            }
+        }
+        for (int z = 0; z < kGridSize; ++z) {
+            for (int x = 0; x < kGridSize; ++x) {
+                for (int dz = -1; dz <= 1; ++dz) {
+                    for (int dx = -1; dx <= 1; ++dx) {
+                        int nx = x + dx, nz = z + dz;
+                        if ((dx || dz) && nx >= 0 && nx < kGridSize && nz >= 0 && nz < kGridSize) {
+                            mesh.addConnection(z * kGridSize + x, nz * kGridSize + nx);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Textbook Dijkstra with a lazy-deletion priority queue, as the reference
+    float referenceCost(const NavGraph& graph, int start, int goal) {
+        if (!graph.isWalkable(start) || !graph.isWalkable(goal)) return -1.0f;
+        std::vector<float> distance(graph.getNodeCount(), std::numeric_limits<float>::max());
+        using Entry = std::pair<float, int>;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+        distance[start] = 0.0f;
+        open.push({0.0f, start});
+        while (!open.empty()) {
+            Entry entry = open.top();
+            open.pop();
+            if (entry.first > distance[entry.second]) continue;
+            if (entry.second == goal) return entry.first;
+            for (uint32_t edge = graph.getEdgeBegin(entry.second); edge < graph.getEdgeEnd(entry.second); ++edge) {
+                int neighbor = graph.getEdgeTarget(edge);
+                float cost = entry.first + graph.getEdgeCost(edge);
+                if (graph.isWalkable(neighbor) && cost < distance[neighbor]) {
+                    distance[neighbor] = cost;
+                    open.push({cost, neighbor});
+                }
+            }
+        }
+        return -1.0f;
+    }
+}
+
+int main() {
+    std::cout << "Pathfinding Benchmark" << std::endl;
+    std::mt19937 rng(2024);
+    bool allCorrect = true;
+
+    NavigationMesh mesh;
+    auto start = std::chrono::steady_clock::now();
+    buildGridMesh(mesh, rng);
+    const NavGraph& graph = mesh.getGraph();
+    std::cout << "Built " << graph.getNodeCount() << " nodes, " << graph.getEdgeCount() << " edges in "
+              << elapsedMs(start) << " ms" << std::endl;
+
+    std::uniform_int_distribution<int> pickNode(0, graph.getNodeCount() - 1);
+
+    // Optimality against the reference
+    AStarSearch search;
+    std::vector<int> nodePath;
+    int mismatches = 0;
+    for (int i = 0; i < 200; ++i) {
+        int from = pickNode(rng), to = pickNode(rng);
+        float expected = referenceCost(graph, from, to);
+        bool found = search.findPath(graph, from, to, nodePath);
+        if (found != (expected >= 0.0f) ||
+            (found && std::fabs(search.getPathCost() - expected) > 1e-3f * (1.0f + expected)) ||
+            (found && (nodePath.front() != from || nodePath.back() != to))) {
+            ++mismatches;
+        }
+    }
+    std::cout << "Optimal paths: " << (mismatches == 0 ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && mismatches == 0;
+
+    // Nearest node against a linear scan
+    std::uniform_real_distribution<float> coordinate(-20.0f, kGridSize + 20.0f);
+    int nearestMismatches = 0;
+    for (int i = 0; i < 2000; ++i) {
+        glm::vec3 point(coordinate(rng), coordinate(rng) * 0.1f, coordinate(rng));
+        int node = mesh.findNearestNode(point);
+        float best = std::numeric_limits<float>::max();
+        for (int n = 0; n < graph.getNodeCount(); ++n) {
+            if (graph.isWalkable(n)) best = std::min(best, glm::distance(point, graph.getPosition(n)));
+        }
+        if (node < 0 || std::fabs(glm::distance(point, graph.getPosition(node)) - best) > 1e-4f) {
+            ++nearestMismatches;
+        }
+    }
+    std::cout << "Nearest node: " << (nearestMismatches == 0 ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && nearestMismatches == 0;
+
+    // Throughput through the public API
+    const int queryCount = 5000;
+    std::vector<std::pair<glm::vec3, glm::vec3>> queries;
+    for (int i = 0; i < queryCount; ++i) {
+        queries.push_back({glm::vec3(coordinate(rng), 0.0f, coordinate(rng)), glm::vec3(coordinate(rng), 0.0f, coordinate(rng))});
+    }
+    size_t waypoints = 0;
+    int reachable = 0;
+    start = std::chrono::steady_clock::now();
+    for (const auto& query : queries) {
+        std::vector<glm::vec3> path = mesh.findPath(query.first, query.second);
+        waypoints += path.size();
+        reachable += path.empty() ? 0 : 1;
+    }
+    double queryMs = elapsedMs(start);
+    std::cout << queryCount << " findPath queries in " << queryMs << " ms ("
+              << queryCount * 1000.0 / queryMs << " queries/s, " << reachable << " reachable, "
+              << static_cast<double>(waypoints) / std::max(reachable, 1) << " waypoints avg)" << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    int nearestSum = 0;
+    for (int i = 0; i < 100000; ++i) {
+        nearestSum += mesh.findNearestNode(queries[i % queryCount].first) & 1;
+    }
+    double nearestMs = elapsedMs(start);
+    std::cout << "100000 nearest-node lookups in " << nearestMs << " ms (checksum " << nearestSum << ")" << std::endl;
+
+    // Edits invalidate the search graph
+    NavigationMesh corridor;
+    for (int i = 0; i < 3; ++i) {
+        NavNode node;
+        node.position = glm::vec3(static_cast<float>(i), 0.0f, 0.0f);
+        node.cost = 1.0f;
+        node.walkable = true;
+        corridor.addNode(node);
+    }
+    corridor.addConnection(0, 1);
+    corridor.addConnection(1, 2);
+    bool before = corridor.findNodePath(0, 2, nodePath) && nodePath.size() == 3;
+    corridor.removeNode(1);
+    bool after = !corridor.findNodePath(0, 1, nodePath);
+    std::cout << "Rebuild after edit: " << (before && after ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && before && after;
+
+    std::cout << (allCorrect ? "Pathfinding benchmark passed!" : "Pathfinding benchmark FAILED!") << std::endl;
+    return allCorrect ? 0 : 1;
+}
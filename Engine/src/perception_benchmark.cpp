@@ -0,0 +1,227 @@
+#include "../include/PerceptionSystem.h"
+#include "../include/StaticBVH.h"
+#include "../include/JobSystem.h"
+#include "../include/TimingUtils.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace Sparky;
+
+// 1000 guards and 2000 targets in a 300x300 level with 3000 wall blocks.
+// Checks BVH occlusion against testing every box, batched visibility against
+// a brute-force pass over every pair, parallel against serial updates, and
+// that lower priorities spread observers over frames.
+
+namespace {
+    const int kObserverCount = 1000;
+    const int kTargetCount = 2000;
+    const int kWallCount = 3000;
+    const float kArea = 300.0f;
+    const float kVisionRange = 30.0f;
+    const float kFieldOfView = 120.0f;
+
+    struct Level {
+        std::vector<glm::vec3> wallMin;
+        std::vector<glm::vec3> wallMax;
+        std::vector<glm::vec3> observerPosition;
+        std::vector<glm::vec3> observerForward;
+        std::vector<glm::vec3> targetPosition;
+    };
+
+    Level buildLevel(std::mt19937& rng) {
+        std::uniform_real_distribution<float> coordinate(0.0f, kArea);
+        std::uniform_real_distribution<float> length(1.0f, 8.0f);
+        std::uniform_real_distribution<float> height(1.0f, 4.0f);
+        std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+        Level level;
+        for (int i = 0; i < kWallCount; ++i) {
+            glm::vec3 corner(coordinate(rng), 0.0f, coordinate(rng));
+            bool alongX = i % 2 == 0;
+            glm::vec3 size(alongX ? length(rng) : 0.5f, height(rng), alongX ? 0.5f : length(rng));
+            level.wallMin.push_back(corner);
+            level.wallMax.push_back(corner + size);
+        }
+        for (int i = 0; i < kObserverCount; ++i) {
+            float heading = angle(rng);
+            level.observerPosition.push_back(glm::vec3(coordinate(rng), 0.0f, coordinate(rng)));
+            level.observerForward.push_back(glm::vec3(std::cos(heading), 0.0f, std::sin(heading)));
+        }
+        for (int i = 0; i < kTargetCount; ++i) {
+            level.targetPosition.push_back(glm::vec3(coordinate(rng), 0.0f, coordinate(rng)));
+        }
+        return level;
+    }
+
+    // Segment against one box, the way every box would be tested without a BVH
+    bool segmentHitsBox(const glm::vec3& from, const glm::vec3& to, const glm::vec3& minBounds, const glm::vec3& maxBounds) {
+        glm::vec3 direction = to - from;
+        float entry = 0.0f;
+        float exit = 1.0f;
+        for (int axis = 0; axis < 3; ++axis) {
+            if (std::abs(direction[axis]) < 1e-20f) {
+                if (from[axis] < minBounds[axis] || from[axis] > maxBounds[axis]) return false;
+                continue;
+            }
+            float t1 = (minBounds[axis] - from[axis]) / direction[axis];
+            float t2 = (maxBounds[axis] - from[axis]) / direction[axis];
+            entry = std::max(entry, std::min(t1, t2));
+            exit = std::min(exit, std::max(t1, t2));
+        }
+        return entry <= exit && entry < 1.0f;
+    }
+
+    bool occludedBruteForce(const Level& level, const glm::vec3& from, const glm::vec3& to) {
+        for (size_t wall = 0; wall < level.wallMin.size(); ++wall) {
+            if (segmentHitsBox(from, to, level.wallMin[wall], level.wallMax[wall])) return true;
+        }
+        return false;
+    }
+
+    std::unique_ptr<PerceptionSystem> buildSystem(const Level& level, const StaticBVH& walls, PerceptionPriority priority,
+                                                  JobSystem* jobSystem) {
+        std::unique_ptr<PerceptionSystem> system = PerceptionSystem::create();
+        system->setOccluders(&walls);
+        system->setJobSystem(jobSystem);
+        for (int i = 0; i < kObserverCount; ++i) {
+            system->addObserver(level.observerPosition[i], level.observerForward[i], kVisionRange, kFieldOfView, priority);
+        }
+        for (const glm::vec3& position : level.targetPosition) {
+            system->addTarget(position);
+        }
+        return system;
+    }
+}
+
+int main() {
+    std::cout << "Perception Benchmark" << std::endl;
+    std::mt19937 rng(11);
+    bool allCorrect = true;
+    Level level = buildLevel(rng);
+    std::unique_ptr<JobSystem> jobSystem = JobSystem::create(4, 0);
+
+    StaticBVH walls;
+    for (int i = 0; i < kWallCount; ++i) {
+        walls.addBox(level.wallMin[i], level.wallMax[i]);
+    }
+    auto start = std::chrono::steady_clock::now();
+    walls.build();
+    double buildMs = elapsedMs(start);
+
+    // BVH occlusion and closest hits against every box
+    std::uniform_real_distribution<float> coordinate(0.0f, kArea);
+    std::uniform_real_distribution<float> eye(0.5f, 3.0f);
+    bool occlusionMatches = true;
+    bool closestMatches = true;
+    int occludedSegments = 0;
+    for (int i = 0; i < 5000 && occlusionMatches && closestMatches; ++i) {
+        glm::vec3 from(coordinate(rng), eye(rng), coordinate(rng));
+        glm::vec3 to = from + glm::vec3(coordinate(rng) - kArea * 0.5f, 0.0f, coordinate(rng) - kArea * 0.5f) * 0.2f;
+        bool expected = occludedBruteForce(level, from, to);
+        occlusionMatches = walls.isOccluded(from, to) == expected;
+        occludedSegments += expected ? 1 : 0;
+
+        glm::vec3 direction = glm::normalize(to - from);
+        float length = glm::length(to - from);
+        float closest = length;
+        for (int wall = 0; wall < kWallCount; ++wall) {
+            if (segmentHitsBox(from, to, level.wallMin[wall], level.wallMax[wall])) {
+                // Binary search the entry point along the segment
+                float low = 0.0f, high = 1.0f;
+                for (int step = 0; step < 40; ++step) {
+                    float middle = 0.5f * (low + high);
+                    if (segmentHitsBox(from, from + (to - from) * middle, level.wallMin[wall], level.wallMax[wall])) {
+                        high = middle;
+                    } else {
+                        low = middle;
+                    }
+                }
+                closest = std::min(closest, high * length);
+            }
+        }
+        StaticBVHHit hit;
+        bool found = walls.raycast(from, direction, length, hit);
+        closestMatches = found == expected && (!found || std::abs(hit.distance - closest) < 1e-3f);
+    }
+    std::cout << "BVH occlusion matches brute force (" << occludedSegments << "/5000 blocked): "
+              << (occlusionMatches ? "ok" : "FAILED") << std::endl;
+    std::cout << "BVH closest hit matches brute force: " << (closestMatches ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && occlusionMatches && closestMatches;
+
+    // Every observer at once, against every pair tested directly
+    std::unique_ptr<PerceptionSystem> serial = buildSystem(level, walls, PerceptionPriority::HIGH, nullptr);
+    start = std::chrono::steady_clock::now();
+    serial->update();
+    double serialMs = elapsedMs(start);
+    PerceptionStats stats = serial->getStats();
+
+    PerceptionSettings defaults;
+    const float cosHalf = std::cos(glm::radians(kFieldOfView * 0.5f));
+    start = std::chrono::steady_clock::now();
+    bool visibilityMatches = true;
+    size_t visiblePairs = 0;
+    std::vector<PerceptionTargetId> expected;
+    for (int observer = 0; observer < kObserverCount && visibilityMatches; ++observer) {
+        expected.clear();
+        glm::vec3 from = level.observerPosition[observer] + glm::vec3(0.0f, defaults.eyeHeight, 0.0f);
+        for (int target = 0; target < kTargetCount; ++target) {
+            glm::vec3 to = level.targetPosition[target] + glm::vec3(0.0f, defaults.targetHeight, 0.0f);
+            glm::vec3 offset = to - from;
+            float distance = glm::length(offset);
+            if (distance > kVisionRange) continue;
+            if (distance > 0.0f && glm::dot(offset / distance, level.observerForward[observer]) < cosHalf) continue;
+            if (occludedBruteForce(level, from, to)) continue;
+            expected.push_back(target);
+        }
+        visibilityMatches = serial->getVisibleTargets(observer) == expected;
+        visiblePairs += expected.size();
+    }
+    double bruteMs = elapsedMs(start);
+    std::cout << "Batched visibility matches brute force: " << (visibilityMatches ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && visibilityMatches;
+
+    // Parallel updates give the same visible sets
+    std::unique_ptr<PerceptionSystem> parallel = buildSystem(level, walls, PerceptionPriority::HIGH, jobSystem.get());
+    start = std::chrono::steady_clock::now();
+    parallel->update();
+    double parallelMs = elapsedMs(start);
+    bool parallelMatches = true;
+    for (int observer = 0; observer < kObserverCount && parallelMatches; ++observer) {
+        parallelMatches = parallel->getVisibleTargets(observer) == serial->getVisibleTargets(observer);
+    }
+    std::cout << "Parallel update matches serial: " << (parallelMatches ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && parallelMatches;
+
+    // NORMAL priority: a third of the observers per frame, all of them within three frames
+    std::unique_ptr<PerceptionSystem> amortized = buildSystem(level, walls, PerceptionPriority::NORMAL, jobSystem.get());
+    bool spread = true;
+    double amortizedMs = 0.0;
+    for (int frame = 0; frame < defaults.normalInterval; ++frame) {
+        start = std::chrono::steady_clock::now();
+        amortized->update();
+        amortizedMs += elapsedMs(start);
+        int updated = amortized->getStats().observersUpdated;
+        spread = spread && std::abs(updated - kObserverCount / defaults.normalInterval) <= 1;
+    }
+    amortizedMs /= defaults.normalInterval;
+    for (int observer = 0; observer < kObserverCount && spread; ++observer) {
+        spread = amortized->getVisibleTargets(observer) == serial->getVisibleTargets(observer);
+    }
+    std::cout << "NORMAL priority refreshes a third per frame and catches up: " << (spread ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && spread;
+
+    std::cout << "BVH over " << kWallCount << " walls: " << walls.getNodeCount() << " nodes in " << buildMs << " ms" << std::endl;
+    std::cout << kObserverCount << " observers x " << kTargetCount << " targets: " << stats.candidatePairs
+              << " grid candidates, " << stats.conePairs << " in cone, " << stats.occludedPairs << " occluded, "
+              << visiblePairs << " visible" << std::endl;
+    std::cout << "Full update: " << serialMs << " ms serial (grid " << stats.gridMs << ", cull " << stats.cullMs
+              << ", rays " << stats.raycastMs << "), " << parallelMs << " ms on " << jobSystem->getWorkerCount()
+              << " workers; NORMAL priority " << amortizedMs << " ms per frame" << std::endl;
+    std::cout << "Every pair against every wall: " << bruteMs << " ms" << std::endl;
+
+    std::cout << (allCorrect ? "Perception benchmark passed!" : "Perception benchmark FAILED!") << std::endl;
+    return allCorrect ? 0 : 1;
+}
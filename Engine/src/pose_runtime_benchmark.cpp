@@ -0,0 +1,331 @@
+#include "../include/PoseRuntime.h"
+#include "../include/AdvancedAnimationSystem.h"
+#include "../include/TimingUtils.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace Sparky;
+
+// 1000 skeletons of 60 bones, each blending two sampled poses, adding an
+// additive layer and concatenating down the hierarchy into skinning
+// matrices every frame. Checks the kernels against per-bone glm code
+// (including bone counts that leave a scalar tail), hierarchies whose ids
+// list children before parents, CPU skinning, and that SkeletalAnimation
+// really crossfades and concatenates. Then compares frame times with the
+// per-bone glm path and measures CPU skinning throughput.
+
+namespace {
+    const int kSkeletonCount = 1000;
+    const int kBoneCount = 60;
+    const int kVertexCount = 10000;
+    const int kFrames = 30;
+
+    glm::quat randomRotation(std::mt19937& rng) {
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        return glm::normalize(glm::quat(unit(rng), unit(rng), unit(rng), unit(rng)));
+    }
+
+    void randomPose(AnimationPose& pose, int boneCount, std::mt19937& rng) {
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        pose.reset(boneCount);
+        for (int bone = 0; bone < boneCount; ++bone) {
+            pose.translations[bone] = glm::vec3(unit(rng), unit(rng), unit(rng)) * 0.2f;
+            pose.rotations[bone] = randomRotation(rng);
+            pose.scales[bone] = glm::vec3(1.0f + 0.1f * unit(rng));
+        }
+    }
+
+    glm::quat nlerpReference(const glm::quat& a, const glm::quat& b, float t) {
+        glm::quat to = glm::dot(a, b) < 0.0f ? b * -1.0f : b;
+        return glm::normalize(a * (1.0f - t) + to * t);
+    }
+
+    float quatDifference(const glm::quat& a, const glm::quat& b) {
+        return std::max(std::max(std::fabs(a.x - b.x), std::fabs(a.y - b.y)), std::max(std::fabs(a.z - b.z), std::fabs(a.w - b.w)));
+    }
+
+    float vecDifference(const glm::vec3& a, const glm::vec3& b) {
+        return std::max(std::fabs(a.x - b.x), std::max(std::fabs(a.y - b.y), std::fabs(a.z - b.z)));
+    }
+
+    float matDifference(const glm::mat4& a, const glm::mat4& b) {
+        float difference = 0.0f;
+        for (int c = 0; c < 4; ++c) {
+            for (int r = 0; r < 4; ++r) {
+                difference = std::max(difference, std::fabs(a[c][r] - b[c][r]));
+            }
+        }
+        return difference;
+    }
+
+    glm::mat4 localMatrix(const AnimationPose& pose, int bone) {
+        return glm::translate(glm::mat4(1.0f), pose.translations[bone]) * glm::mat4_cast(pose.rotations[bone]) *
+               glm::scale(glm::mat4(1.0f), pose.scales[bone]);
+    }
+
+    glm::mat4 modelReference(const std::vector<int>& parents, const AnimationPose& pose, int bone) {
+        glm::mat4 local = localMatrix(pose, bone);
+        return parents[bone] < 0 ? local : modelReference(parents, pose, parents[bone]) * local;
+    }
+
+    std::vector<int> makeParents(int boneCount) {
+        std::vector<int> parents(boneCount, -1);
+        for (int bone = 1; bone < boneCount; ++bone) {
+            parents[bone] = bone % 6 == 1 ? (bone / 12) : bone - 1;
+        }
+        return parents;
+    }
+
+    bool checkKernels(std::mt19937& rng) {
+        bool ok = true;
+        for (int boneCount : {1, 4, 7, 61}) {
+            AnimationPose a, b, blended, additive, layered;
+            randomPose(a, boneCount, rng);
+            randomPose(b, boneCount, rng);
+            blendPoses(a, b, 0.3f, blended);
+            float error = 0.0f;
+            for (int bone = 0; bone < boneCount; ++bone) {
+                error = std::max(error, quatDifference(blended.rotations[bone], nlerpReference(a.rotations[bone], b.rotations[bone], 0.3f)));
+                error = std::max(error, vecDifference(blended.translations[bone], a.translations[bone] + (b.translations[bone] - a.translations[bone]) * 0.3f));
+                error = std::max(error, vecDifference(blended.scales[bone], a.scales[bone] + (b.scales[bone] - a.scales[bone]) * 0.3f));
+            }
+
+            // A full additive layer of (b - a) on a gives b; none gives a
+            makeAdditivePose(b, a, additive);
+            applyAdditivePose(a, additive, 1.0f, layered);
+            for (int bone = 0; bone < boneCount; ++bone) {
+                glm::quat rotation = layered.rotations[bone];
+                if (glm::dot(rotation, b.rotations[bone]) < 0.0f) rotation = rotation * -1.0f;
+                error = std::max(error, quatDifference(rotation, b.rotations[bone]));
+                error = std::max(error, vecDifference(layered.translations[bone], b.translations[bone]));
+                error = std::max(error, vecDifference(layered.scales[bone], b.scales[bone]));
+            }
+            applyAdditivePose(a, additive, 0.0f, layered);
+            for (int bone = 0; bone < boneCount; ++bone) {
+                error = std::max(error, quatDifference(layered.rotations[bone], a.rotations[bone]));
+                error = std::max(error, vecDifference(layered.translations[bone], a.translations[bone]));
+            }
+            ok = ok && error < 1e-5f;
+        }
+        return ok;
+    }
+
+    bool checkHierarchy(std::mt19937& rng) {
+        // Bone ids in reverse so every child's id is lower than its parent's
+        std::vector<int> forward = makeParents(kBoneCount);
+        std::vector<int> parents(kBoneCount);
+        for (int bone = 0; bone < kBoneCount; ++bone) {
+            parents[kBoneCount - 1 - bone] = forward[bone] < 0 ? -1 : kBoneCount - 1 - forward[bone];
+        }
+        std::vector<glm::mat4> inverseBind(kBoneCount);
+        AnimationPose bindPose, pose;
+        randomPose(bindPose, kBoneCount, rng);
+        randomPose(pose, kBoneCount, rng);
+        for (int bone = 0; bone < kBoneCount; ++bone) {
+            inverseBind[bone] = glm::inverse(modelReference(parents, bindPose, bone));
+        }
+
+        AnimationSkeleton skeleton;
+        skeleton.build(parents, inverseBind);
+        std::vector<glm::mat4> model, skinning;
+        skeleton.computeModelTransforms(pose, model);
+        skeleton.computeSkinningMatrices(model, skinning);
+        float error = 0.0f;
+        for (int bone = 0; bone < kBoneCount; ++bone) {
+            error = std::max(error, matDifference(model[bone], modelReference(parents, pose, bone)));
+        }
+
+        // The bind pose skins to identity
+        skeleton.computeModelTransforms(bindPose, model);
+        skeleton.computeSkinningMatrices(model, skinning);
+        for (int bone = 0; bone < kBoneCount; ++bone) {
+            error = std::max(error, matDifference(skinning[bone], glm::mat4(1.0f)));
+        }
+        return error < 1e-4f;
+    }
+
+    void makeMesh(std::vector<Vertex>& vertices, std::vector<VertexSkin>& skin, std::mt19937& rng) {
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        std::uniform_int_distribution<int> boneIndex(0, kBoneCount - 1);
+        vertices.resize(kVertexCount);
+        skin.resize(kVertexCount);
+        for (int v = 0; v < kVertexCount; ++v) {
+            Vertex& vertex = vertices[v];
+            vertex.position = glm::vec3(unit(rng), unit(rng), unit(rng));
+            vertex.normal = glm::normalize(glm::vec3(unit(rng), unit(rng), unit(rng)));
+            vertex.tangent = glm::normalize(glm::cross(vertex.normal, glm::vec3(0.0f, 1.0f, 0.0f)));
+            vertex.bitangent = glm::cross(vertex.normal, vertex.tangent);
+            vertex.texCoord = glm::vec2(unit(rng), unit(rng));
+            float weights[4] = {0.55f, 0.25f, 0.15f, 0.05f};
+            for (int i = 0; i < 4; ++i) {
+                skin[v].bones[i] = static_cast<uint16_t>(boneIndex(rng));
+                skin[v].weights[i] = weights[i];
+            }
+        }
+    }
+
+    bool checkSkinning(std::mt19937& rng) {
+        std::vector<Vertex> vertices, skinned;
+        std::vector<VertexSkin> skin;
+        makeMesh(vertices, skin, rng);
+        std::vector<glm::mat4> skinning(kBoneCount);
+        AnimationPose pose;
+        randomPose(pose, kBoneCount, rng);
+        for (int bone = 0; bone < kBoneCount; ++bone) {
+            skinning[bone] = localMatrix(pose, bone);
+        }
+        skinVertices(vertices, skin, skinning, skinned);
+
+        float error = 0.0f;
+        for (int v = 0; v < kVertexCount; v += 7) {
+            glm::vec3 position(0.0f);
+            for (int i = 0; i < 4; ++i) {
+                position += glm::vec3(skinning[skin[v].bones[i]] * glm::vec4(vertices[v].position, 1.0f)) * skin[v].weights[i];
+            }
+            error = std::max(error, vecDifference(position, skinned[v].position));
+            error = std::max(error, std::fabs(glm::dot(skinned[v].normal, skinned[v].normal) - 1.0f));
+        }
+        return error < 1e-4f;
+    }
+
+    Keyframe constantKeyframe(float time, const glm::quat& rotation) {
+        Keyframe keyframe;
+        keyframe.time = time;
+        keyframe.position[0] = 0.0f;
+        keyframe.position[1] = 1.0f;
+        keyframe.position[2] = 0.0f;
+        keyframe.rotation[0] = rotation.x;
+        keyframe.rotation[1] = rotation.y;
+        keyframe.rotation[2] = rotation.z;
+        keyframe.rotation[3] = rotation.w;
+        keyframe.scale[0] = keyframe.scale[1] = keyframe.scale[2] = 1.0f;
+        return keyframe;
+    }
+
+    bool checkSkeletalCrossfade() {
+        SkeletalAnimation skeleton;
+        for (int bone = 0; bone < 2; ++bone) {
+            SkeletalAnimation::Bone entry;
+            entry.name = "bone" + std::to_string(bone);
+            entry.id = bone;
+            entry.parentId = bone - 1;
+            entry.offsetMatrix = glm::mat4(1.0f);
+            entry.finalTransformation = glm::mat4(1.0f);
+            skeleton.addBone(entry);
+        }
+        glm::quat idle = glm::angleAxis(0.2f, glm::vec3(0.0f, 1.0f, 0.0f));
+        glm::quat run = glm::angleAxis(1.2f, glm::vec3(0.0f, 1.0f, 0.0f));
+        for (int clipIndex = 0; clipIndex < 2; ++clipIndex) {
+            std::unique_ptr<AnimationClip> clip(new AnimationClip(clipIndex == 0 ? "idle" : "run"));
+            for (int bone = 0; bone < 2; ++bone) {
+                clip->addKeyframe(bone, constantKeyframe(0.0f, clipIndex == 0 ? idle : run));
+                clip->addKeyframe(bone, constantKeyframe(1.0f, clipIndex == 0 ? idle : run));
+            }
+            skeleton.addAnimationClip(std::move(clip));
+        }
+        skeleton.playAnimation("idle");
+        skeleton.update(0.1f);
+        skeleton.blendToAnimation("run", 1.0f);
+        skeleton.update(0.25f);     // Samples at progress 0, then advances to 0.25
+        skeleton.update(0.25f);     // Samples at progress 0.25
+
+        glm::quat expected = nlerpReference(idle, run, 0.25f);
+        bool blended = quatDifference(skeleton.getLocalPose().rotations[1], expected) < 1e-5f;
+        glm::mat4 child = skeleton.getBoneModelTransform(1);
+        glm::mat4 reference = skeleton.getLocalPose().getMatrix(0) * skeleton.getLocalPose().getMatrix(1);
+        return blended && matDifference(child, reference) < 1e-5f && matDifference(skeleton.getBoneTransform(1), child) < 1e-6f;
+    }
+}
+
+int main() {
+    std::cout << "Pose Runtime Benchmark" << std::endl;
+    std::mt19937 rng(43);
+    bool allCorrect = true;
+
+    bool kernels = checkKernels(rng);
+    std::cout << "Blend and additive kernels match per-bone glm: " << (kernels ? "ok" : "FAILED") << std::endl;
+    bool hierarchy = checkHierarchy(rng);
+    std::cout << "Hierarchy concatenation with children before parents: " << (hierarchy ? "ok" : "FAILED") << std::endl;
+    bool skinning = checkSkinning(rng);
+    std::cout << "CPU skinning matches weighted transforms: " << (skinning ? "ok" : "FAILED") << std::endl;
+    bool crossfade = checkSkeletalCrossfade();
+    std::cout << "SkeletalAnimation crossfades and concatenates: " << (crossfade ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && kernels && hierarchy && skinning && crossfade;
+
+    // Per skeleton: two sampled poses and an additive layer
+    std::vector<int> parents = makeParents(kBoneCount);
+    std::vector<glm::mat4> inverseBind(kBoneCount, glm::mat4(1.0f));
+    AnimationSkeleton skeleton;
+    skeleton.build(parents, inverseBind);
+    std::vector<AnimationPose> walk(kSkeletonCount), run(kSkeletonCount), lean(kSkeletonCount);
+    for (int i = 0; i < kSkeletonCount; ++i) {
+        randomPose(walk[i], kBoneCount, rng);
+        randomPose(run[i], kBoneCount, rng);
+        AnimationPose leanPose;
+        randomPose(leanPose, kBoneCount, rng);
+        makeAdditivePose(leanPose, walk[i], lean[i]);
+    }
+
+    AnimationPose blended, layered;
+    std::vector<glm::mat4> model, skinningMatrices;
+    double kernelMs = 0.0;
+    for (int frame = 0; frame < kFrames; ++frame) {
+        float weight = (frame + 0.5f) / kFrames;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < kSkeletonCount; ++i) {
+            blendPoses(walk[i], run[i], weight, blended);
+            applyAdditivePose(blended, lean[i], 0.5f, layered);
+            skeleton.computeModelTransforms(layered, model);
+            skeleton.computeSkinningMatrices(model, skinningMatrices);
+        }
+        kernelMs += elapsedMs(start);
+    }
+
+    // The same work one bone at a time through glm, as SkeletalAnimation and AnimationBlender did it
+    std::vector<glm::mat4> referenceModel(kBoneCount), referenceSkinning(kBoneCount);
+    double glmMs = 0.0;
+    for (int frame = 0; frame < kFrames; ++frame) {
+        float weight = (frame + 0.5f) / kFrames;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < kSkeletonCount; ++i) {
+            for (int bone = 0; bone < kBoneCount; ++bone) {
+                glm::vec3 translation = walk[i].translations[bone] + (run[i].translations[bone] - walk[i].translations[bone]) * weight;
+                glm::quat rotation = glm::slerp(walk[i].rotations[bone], run[i].rotations[bone], weight);
+                glm::vec3 scale = walk[i].scales[bone] + (run[i].scales[bone] - walk[i].scales[bone]) * weight;
+                translation += lean[i].translations[bone] * 0.5f;
+                rotation = rotation * glm::slerp(glm::quat(1.0f, 0.0f, 0.0f, 0.0f), lean[i].rotations[bone], 0.5f);
+                glm::mat4 local = glm::translate(glm::mat4(1.0f), translation) * glm::mat4_cast(rotation) * glm::scale(glm::mat4(1.0f), scale);
+                referenceModel[bone] = parents[bone] < 0 ? local : referenceModel[parents[bone]] * local;
+                referenceSkinning[bone] = referenceModel[bone] * inverseBind[bone];
+            }
+        }
+        glmMs += elapsedMs(start);
+    }
+    kernelMs /= kFrames;
+    glmMs /= kFrames;
+
+    bool budget = kernelMs < 16.0;
+    std::cout << kSkeletonCount << " skeletons x " << kBoneCount << " bones per frame: kernels " << kernelMs << " ms, per-bone glm "
+              << glmMs << " ms (" << glmMs / kernelMs << "x)" << std::endl;
+    std::cout << "Fits a 60 Hz frame on one core: " << (budget ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && budget;
+
+    std::vector<Vertex> vertices, skinned;
+    std::vector<VertexSkin> skin;
+    makeMesh(vertices, skin, rng);
+    auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < kFrames; ++frame) {
+        skinVertices(vertices, skin, skinningMatrices, skinned);
+    }
+    double skinMs = elapsedMs(start) / kFrames;
+    std::cout << "CPU skinning: " << kVertexCount << " vertices in " << skinMs << " ms (" << kVertexCount / skinMs / 1000.0
+              << " M vertices/s)" << std::endl;
+
+    std::cout << (allCorrect ? "Pose runtime benchmark passed!" : "Pose runtime benchmark FAILED!") << std::endl;
+    return allCorrect ? 0 : 1;
+}
@@ -0,0 +1,249 @@
+#include "../include/RenderQueue.h"
+#include "../include/Mesh.h"
+#include "../include/Material.h"
+#include "../include/TimingUtils.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+using namespace Sparky;
+
+// A frame's worth of visible objects over a few dozen meshes and materials,
+// added in registration order as RenderSystem did, with some transparent,
+// overlay and background objects mixed in. Checks that the queue comes out
+// in key order (the same order a stable comparison sort gives), that layers
+// and depths run the right way, that every opaque mesh and material
+// combination is one contiguous run, and that recording only the binds the
+// queue asks for leaves the right state bound for every draw. Also checks
+// that mesh ids are recycled as meshes come and go, then times the radix
+// sort against std::sort over the same keys as the camera moves.
+
+namespace {
+    const int kDraws = 20000;
+    const int kMeshCount = 48;
+    const int kMaterialCount = 24;
+    const int kFrames = 200;
+    const float kFarDistance = 1000.0f;
+
+    struct SceneObject {
+        RenderItem item;
+        glm::vec3 center;
+    };
+
+    RenderLayer randomLayer(std::mt19937& rng) {
+        int roll = std::uniform_int_distribution<int>(0, 99)(rng);
+        if (roll < 2) return RenderLayer::BACKGROUND;
+        if (roll < 86) return RenderLayer::OPAQUE_GEOMETRY;
+        if (roll < 98) return RenderLayer::TRANSPARENT_GEOMETRY;
+        return RenderLayer::OVERLAY;
+    }
+
+    bool backToFront(RenderLayer layer) {
+        return layer == RenderLayer::TRANSPARENT_GEOMETRY || layer == RenderLayer::OVERLAY;
+    }
+
+    float depthOf(const glm::vec3& center, const glm::vec3& eye, const glm::vec3& forward) {
+        return glm::dot(center - eye, forward);
+    }
+}
+
+int main() {
+    std::cout << "Render Queue Benchmark" << std::endl;
+    bool allCorrect = true;
+    std::mt19937 rng(49);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    std::vector<std::unique_ptr<Mesh>> meshes;
+    for (int i = 0; i < kMeshCount; ++i) {
+        meshes.push_back(std::make_unique<Mesh>());
+        meshes.back()->vertices.resize(3);
+        // A few meshes draw without an index buffer
+        if (i % 8 != 0) meshes.back()->indices = {0, 1, 2};
+    }
+    std::vector<std::unique_ptr<Material>> materials;
+    for (int i = 0; i < kMaterialCount; ++i) {
+        materials.push_back(std::make_unique<Material>("material" + std::to_string(i)));
+    }
+
+    RenderQueue queue;
+    std::vector<SceneObject> scene;
+    std::uniform_int_distribution<int> pickMesh(0, kMeshCount - 1), pickMaterial(0, kMaterialCount - 1);
+    for (int i = 0; i < kDraws; ++i) {
+        SceneObject object;
+        object.item.object = nullptr;
+        object.item.mesh = meshes[pickMesh(rng)].get();
+        object.item.material = i % 50 == 0 ? nullptr : materials[pickMaterial(rng)].get();
+        object.item.pipeline = 0;
+        object.item.meshId = queue.acquireMeshId(object.item.mesh);
+        object.item.materialId = queue.acquireMaterialId(object.item.material);
+        object.item.layer = randomLayer(rng);
+        object.center = glm::vec3((unit(rng) - 0.5f) * 400.0f, unit(rng) * 20.0f, -unit(rng) * 600.0f);
+        scene.push_back(object);
+    }
+
+    const glm::vec3 eye(0.0f, 2.0f, 0.0f);
+    const glm::vec3 forward(0.0f, 0.0f, -1.0f);
+    queue.begin(eye, forward, kFarDistance);
+    for (const SceneObject& object : scene) {
+        queue.add(object.item, object.center);
+    }
+    queue.sort();
+    const std::vector<RenderDraw>& draws = queue.getDraws();
+    const RenderQueueStats& stats = queue.getStats();
+
+    // Radix order matches a stable sort of the keys in the order they were added
+    std::vector<std::pair<uint64_t, int>> reference;
+    for (int i = 0; i < kDraws; ++i) {
+        const RenderItem& item = scene[i].item;
+        float depth = depthOf(scene[i].center, eye, forward) * (1.0f / kFarDistance);
+        reference.push_back({RenderQueue::makeKey(item.layer, item.pipeline, item.materialId, item.meshId, depth), i});
+    }
+    std::stable_sort(reference.begin(), reference.end(),
+                     [](const std::pair<uint64_t, int>& a, const std::pair<uint64_t, int>& b) { return a.first < b.first; });
+    bool orderCorrect = static_cast<int>(draws.size()) == kDraws;
+    for (int i = 0; i < kDraws && orderCorrect; ++i) {
+        const RenderItem& expected = scene[reference[i].second].item;
+        orderCorrect = draws[i].key == reference[i].first && draws[i].item.mesh == expected.mesh &&
+                       draws[i].item.material == expected.material && draws[i].item.layer == expected.layer;
+    }
+    std::cout << "Same order as a stable sort (" << stats.sortPasses << " radix passes): " << (orderCorrect ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && orderCorrect;
+
+    // Layers in order; opaque front to back within a state, transparent back to front throughout
+    bool layersCorrect = true;
+    float quantum = kFarDistance / static_cast<float>((1 << 22) - 1);
+    for (int i = 1; i < kDraws; ++i) {
+        const RenderDraw& a = draws[i - 1];
+        const RenderDraw& b = draws[i];
+        if (a.item.layer > b.item.layer) layersCorrect = false;
+        if (a.item.layer != b.item.layer) continue;
+        float depthA = depthOf(scene[reference[i - 1].second].center, eye, forward);
+        float depthB = depthOf(scene[reference[i].second].center, eye, forward);
+        if (backToFront(b.item.layer)) {
+            if (depthB > depthA + quantum) layersCorrect = false;
+        } else if (a.item.mesh == b.item.mesh && a.item.material == b.item.material && depthB + quantum < depthA) {
+            layersCorrect = false;
+        }
+    }
+    std::cout << "Layers in order, opaque front to back, transparent back to front: " << (layersCorrect ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && layersCorrect;
+
+    // Every opaque mesh and material combination is drawn as one run
+    std::set<std::pair<const Material*, const Mesh*>> seen;
+    bool runsCorrect = true;
+    int opaqueRuns = 0;
+    for (int i = 0; i < kDraws; ++i) {
+        const RenderDraw& draw = draws[i];
+        if (draw.item.layer != RenderLayer::OPAQUE_GEOMETRY) continue;
+        bool newRun = i == 0 || draws[i - 1].item.layer != RenderLayer::OPAQUE_GEOMETRY ||
+                      draws[i - 1].item.mesh != draw.item.mesh || draws[i - 1].item.material != draw.item.material;
+        if (!newRun) continue;
+        ++opaqueRuns;
+        if (!seen.insert({draw.item.material, draw.item.mesh}).second) runsCorrect = false;
+    }
+    std::cout << "Opaque combinations each drawn as one run (" << opaqueRuns << "): " << (runsCorrect ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && runsCorrect;
+
+    // Record as VulkanRenderer does, binding only what the queue asks for
+    const Mesh* boundMesh = nullptr;
+    const Material* boundMaterial = nullptr;
+    int boundPipeline = -1;
+    int binds = 0;
+    bool stateCorrect = true;
+    for (const RenderDraw& draw : draws) {
+        if (draw.changes & RENDER_CHANGE_PIPELINE) {
+            boundPipeline = static_cast<int>(draw.item.pipeline);
+            ++binds;
+        }
+        if ((draw.changes & RENDER_CHANGE_MATERIAL) && draw.item.material) {
+            boundMaterial = draw.item.material;
+            ++binds;
+        }
+        if (draw.changes & RENDER_CHANGE_MESH) {
+            boundMesh = draw.item.mesh;
+            binds += draw.item.mesh->getIndexCount() > 0 ? 2 : 1;
+        }
+        stateCorrect = stateCorrect && boundPipeline == static_cast<int>(draw.item.pipeline) && boundMesh == draw.item.mesh &&
+                       (!draw.item.material || boundMaterial == draw.item.material);
+    }
+    bool bindsCorrect = stateCorrect && binds == stats.getBinds() && stats.draws == kDraws &&
+                        stats.getBinds() * 4 < stats.unsortedBinds;
+    std::cout << "Draws " << stats.draws << ", binds " << stats.getBinds() << " (pipeline " << stats.pipelineBinds << ", material "
+              << stats.materialBinds << ", vertex " << stats.vertexBufferBinds << ", index " << stats.indexBufferBinds << ") against "
+              << stats.unsortedBinds << " unsorted, " << stats.stateChanges << " state changes: " << (bindsCorrect ? "ok" : "FAILED")
+              << std::endl;
+    allCorrect = allCorrect && bindsCorrect;
+
+    // Ids of released resources are reused, so streaming meshes in and out
+    // never outgrows the key, and live resources never share an id
+    {
+        RenderQueue streaming;
+        std::vector<std::unique_ptr<Mesh>> resident;
+        bool idsCorrect = true;
+        for (int wave = 0; wave < 100 && idsCorrect; ++wave) {
+            std::set<uint32_t> ids;
+            for (int i = 0; i < 1000; ++i) {
+                resident.push_back(std::make_unique<Mesh>());
+                ids.insert(streaming.acquireMeshId(resident.back().get()));
+            }
+            // A second holder gets the same id and keeps it alive past the first release
+            uint32_t shared = streaming.acquireMeshId(resident[0].get());
+            streaming.releaseMeshId(resident[0].get());
+            idsCorrect = ids.size() == 1000 && *ids.rbegin() < 1000 && shared == streaming.acquireMeshId(resident[0].get());
+            streaming.releaseMeshId(resident[0].get());
+            for (const std::unique_ptr<Mesh>& mesh : resident) {
+                streaming.releaseMeshId(mesh.get());
+            }
+            resident.clear();
+            idsCorrect = idsCorrect && streaming.getMeshIdCount() == 0;
+        }
+        std::cout << "Released ids reused across 100000 streamed meshes: " << (idsCorrect ? "ok" : "FAILED") << std::endl;
+        allCorrect = allCorrect && idsCorrect;
+    }
+
+    // Camera strafing across the scene, rebuilding and sorting the queue each frame
+    double queueMs = 0.0, stdSortMs = 0.0;
+    std::vector<std::pair<uint64_t, uint32_t>> stdKeys(kDraws);
+    bool framesCorrect = true;
+    for (int frame = 0; frame < kFrames; ++frame) {
+        glm::vec3 frameEye = eye + glm::vec3(frame * 0.5f - 50.0f, 0.0f, 0.0f);
+
+        auto start = std::chrono::steady_clock::now();
+        queue.begin(frameEye, forward, kFarDistance);
+        for (const SceneObject& object : scene) {
+            queue.add(object.item, object.center);
+        }
+        queue.sort();
+        queueMs += elapsedMs(start);
+
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < kDraws; ++i) {
+            const RenderItem& item = scene[i].item;
+            float depth = depthOf(scene[i].center, frameEye, forward) * (1.0f / kFarDistance);
+            stdKeys[i] = {RenderQueue::makeKey(item.layer, item.pipeline, item.materialId, item.meshId, depth), static_cast<uint32_t>(i)};
+        }
+        std::sort(stdKeys.begin(), stdKeys.end());
+        stdSortMs += elapsedMs(start);
+
+        for (int i = 0; i < kDraws; ++i) {
+            framesCorrect = framesCorrect && queue.getDraws()[i].key == stdKeys[i].first;
+        }
+    }
+    std::cout << "Keys sorted every frame: " << (framesCorrect ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && framesCorrect;
+
+    std::cout << kDraws << " draws per frame: queue with radix sort " << queueMs / kFrames << " ms, keys with std::sort "
+              << stdSortMs / kFrames << " ms (" << stdSortMs / queueMs << "x)" << std::endl;
+
+    if (allCorrect) {
+        std::cout << "Render queue benchmark passed!" << std::endl;
+        return 0;
+    }
+    std::cout << "Render queue benchmark FAILED!" << std::endl;
+    return 1;
+}
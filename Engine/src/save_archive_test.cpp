@@ -0,0 +1,238 @@
+#include "../include/SaveArchive.h"
+#include "../include/SceneSnapshot.h"
+#include "../include/Scene.h"
+#include "../include/GameObject.h"
+#include "../include/JobSystem.h"
+#include "../include/Inventory.h"
+#include "../include/Quest.h"
+#include "../include/QuestManager.h"
+#include "../include/Config.h"
+#include "../include/FileUtils.h"
+#include "../include/HealthComponent.h"
+#include "../include/RigidBodyComponent.h"
+#include "../include/SaveGameManager.h"
+#include "../include/TimingUtils.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+
+using namespace Sparky;
+
+// Checks the chunked save archive (CRC, versioning, compression, atomic
+// writes), the subsystems and game saves migrated onto it, and reports
+// save/load latency for a large world.
+
+static bool report(const std::string& name, bool ok) {
+    std::cout << name << ": " << (ok ? "ok" : "FAILED") << std::endl;
+    return ok;
+}
+
+static bool testArchive() {
+    bool ok = report("CRC-32 check value", SaveArchive::crc32("123456789", 9) == 0xCBF43926u);
+
+    const uint32_t textChunk = SaveArchive::makeChunkId('T', 'E', 'X', 'T');
+    const uint32_t tinyChunk = SaveArchive::makeChunkId('T', 'I', 'N', 'Y');
+
+    SaveArchive archive;
+    std::string text;
+    for (int i = 0; i < 2000; ++i) text += "chunk payload " + std::to_string(i % 10) + "\n";
+    archive.setChunk(textChunk, 3, std::vector<char>(text.begin(), text.end()));
+    archive.setChunk(tinyChunk, 1, std::vector<char>{'h', 'i'});
+
+    std::vector<char> encoded;
+    archive.encode(encoded);
+
+    SaveArchive decoded;
+    const SaveChunk* chunk = decoded.decode(encoded) ? decoded.getChunk(textChunk) : nullptr;
+    ok = report("Round trip with versions", chunk && chunk->version == 3 &&
+                std::string(chunk->data.begin(), chunk->data.end()) == text &&
+                decoded.getChunk(tinyChunk) && decoded.getChunk(tinyChunk)->data.size() == 2) && ok;
+    ok = report("Compression", encoded.size() < text.size() / 4) && ok;
+
+    // A flipped byte in the payload and a truncated file must both be rejected
+    std::vector<char> corrupt = encoded;
+    corrupt[corrupt.size() - 1] ^= 0x40;
+    std::vector<char> truncated(encoded.begin(), encoded.begin() + encoded.size() / 2);
+    SaveArchive rejected;
+    ok = report("Corruption detected", !rejected.decode(corrupt) && !rejected.decode(truncated)) && ok;
+
+    // Atomic replace leaves no temporary file behind
+    const std::string path = "save_archive_test.bin";
+    bool written = archive.saveToFile(path) && archive.saveToFile(path);
+    SaveArchive reloaded;
+    ok = report("Atomic file write", written && !FileUtils::fileExists(path + ".tmp") &&
+                reloaded.loadFromFile(path) && reloaded.getChunks().size() == 2) && ok;
+    std::remove(path.c_str());
+    return ok;
+}
+
+static bool testSubsystems() {
+    bool ok = true;
+
+    // Inventory
+    const std::string inventoryPath = "save_archive_test_inventory.bin";
+    Inventory inventory(8);
+    auto potion = std::make_unique<Item>("Potion", 10);
+    potion->setQuantity(7);
+    inventory.addItem(std::move(potion));
+    inventory.addItem(std::make_unique<Item>("Key"));
+    Inventory restoredInventory(2);
+    bool inventoryOk = inventory.saveToFile(inventoryPath) && restoredInventory.loadFromFile(inventoryPath) &&
+                       restoredInventory.getSize() == 8 && restoredInventory.getItem("Potion") &&
+                       restoredInventory.getItem("Potion")->getQuantity() == 7 && restoredInventory.getItem("Key");
+    ok = report("Inventory archive", inventoryOk) && ok;
+    std::remove(inventoryPath.c_str());
+
+    // Quests, including status which the text format dropped
+    const std::string questPath = "save_archive_test_quests.bin";
+    QuestManager& quests = QuestManager::getInstance();
+    auto quest = std::make_unique<Quest>("Rescue", "Find the engineer");
+    quest->addObjective(std::make_unique<QuestObjective>("Search the depot", 3));
+    quests.addQuest(std::move(quest));
+    quests.startQuest("Rescue");
+    quests.addObjectiveProgress("Rescue", "Search the depot", 2);
+    bool questSaved = quests.saveToFile(questPath);
+    quests.removeQuest("Rescue");
+    Quest* loadedQuest = quests.loadFromFile(questPath) ? quests.getQuest("Rescue") : nullptr;
+    ok = report("Quest archive", questSaved && loadedQuest && loadedQuest->getStatus() == QuestStatus::IN_PROGRESS &&
+                loadedQuest->getObjectives().size() == 1 &&
+                loadedQuest->getObjectives()[0]->getCurrentAmount() == 2) && ok;
+    std::remove(questPath.c_str());
+
+    // Config keeps exact types, and hand-written text configs still load
+    const std::string configPath = "save_archive_test_config.bin";
+    auto config = Config::create();
+    config->setFloat("audio.masterVolume", 1.0f);
+    config->setInt("video.width", 1920);
+    config->setString("player.name", "Sparky");
+    config->setBool("video.vsync", true);
+    config->saveToFile(configPath);
+    auto loadedConfig = Config::create(configPath);
+    bool configOk = loadedConfig->getFloat("audio.masterVolume", 0.0f) == 1.0f &&
+                    loadedConfig->getInt("video.width") == 1920 &&
+                    loadedConfig->getString("player.name") == "Sparky" && loadedConfig->getBool("video.vsync");
+
+    {
+        std::ofstream text(configPath, std::ios::trunc);
+        text << "# comment\nvideo.height = 1080\n";
+    }
+    auto textConfig = Config::create(configPath);
+    configOk = configOk && textConfig->getInt("video.height") == 1080;
+    ok = report("Config archive and text fallback", configOk) && ok;
+    std::remove(configPath.c_str());
+
+    return ok;
+}
+
+// Game saves go through the global job system's I/O thread
+static bool testGameSaves() {
+    JobSystem& jobs = JobSystem::getInstance();
+    jobs.initialize(1, 1);
+    SaveGameManager& saves = SaveGameManager::getInstance();
+
+    GameSaveData data = GameSaveData();
+    data.playerHealth = 80.0f;
+    data.playerMaxHealth = 100.0f;
+    data.currentLevel = 3;
+    data.score = 1200;
+    data.inventoryItems = {"Potion"};
+    data.inventoryQuantities = {2};
+
+    JobCounter written;
+    saves.saveGameAsync("save_archive_test_slot", data, &written);
+    jobs.wait(written);
+    GameSaveData loaded = GameSaveData();
+    bool ok = report("Async game save", saves.getLastSave() == "save_archive_test_slot" &&
+                     saves.loadGame("save_archive_test_slot", loaded) && loaded.score == 1200 &&
+                     loaded.inventoryQuantities == data.inventoryQuantities);
+
+    // A write that fails does not become the last save
+    JobCounter failed;
+    saves.saveGameAsync("save_archive_test_missing/slot", data, &failed);
+    jobs.wait(failed);
+    ok = report("Failed async save keeps last save", saves.getLastSave() == "save_archive_test_slot") && ok;
+
+    // Chunks written by a newer build are refused
+    const uint32_t playerChunk = SaveArchive::makeChunkId('P', 'L', 'Y', 'R');
+    SaveArchive newer;
+    bool rewritten = newer.loadFromFile(saves.getSaveDirectory() + "/save_archive_test_slot.sav") && newer.getChunk(playerChunk);
+    if (rewritten) {
+        std::vector<char> player = newer.getChunk(playerChunk)->data;
+        newer.setChunk(playerChunk, 2, player);
+        rewritten = newer.saveToFile(saves.getSaveDirectory() + "/save_archive_test_newer.sav");
+    }
+    ok = report("Newer chunk version refused", rewritten && !saves.loadGame("save_archive_test_newer", loaded)) && ok;
+
+    saves.deleteSave("save_archive_test_slot");
+    saves.deleteSave("save_archive_test_newer");
+    jobs.shutdown();
+    return ok;
+}
+
+static bool testLargeWorld(JobSystem& jobs) {
+    const size_t objectCount = 100000;
+    Scene world;
+    for (size_t i = 0; i < objectCount; ++i) {
+        auto object = std::make_unique<GameObject>("Entity" + std::to_string(i));
+        object->setPosition(glm::vec3(static_cast<float>(i % 1000), 0.0f, static_cast<float>(i / 1000)));
+        object->addComponent<HealthComponent>(100.0f)->setHealth(50.0f + static_cast<float>(i % 50));
+        object->addComponent<RigidBodyComponent>()->setLinearVelocity(glm::vec3(1.0f, 0.0f, 0.0f));
+        world.addGameObject(std::move(object));
+    }
+
+    const std::string path = "save_archive_test_world.snap";
+    SnapshotManager snapshots;
+    snapshots.setJobSystem(&jobs);
+
+    auto start = std::chrono::steady_clock::now();
+    bool saved = snapshots.save(world, path, SnapshotMode::FULL);
+    double saveMs = elapsedMs(start);
+
+    std::vector<char> file = saved ? FileUtils::readFile(path) : std::vector<char>();
+    size_t rawBytes = snapshots.getStats().payloadBytes;
+
+    // Async: the main thread only pays for capturing what changed
+    for (size_t i = 0; i < objectCount; i += 100) {
+        world.getGameObject("Entity" + std::to_string(i))->getComponent<HealthComponent>()->takeDamage(1.0f);
+    }
+    start = std::chrono::steady_clock::now();
+    snapshots.saveAsync(world, path, SnapshotMode::FULL);
+    double asyncMainThreadMs = elapsedMs(start);
+    snapshots.waitForWrites();
+    double asyncTotalMs = elapsedMs(start);
+
+    Scene restored;
+    SnapshotManager loader;
+    loader.setJobSystem(&jobs);
+    start = std::chrono::steady_clock::now();
+    bool loaded = loader.load(restored, {path});
+    double loadMs = elapsedMs(start);
+
+    std::cout << "Large world (" << objectCount << " objects): " << rawBytes << " bytes raw, " << file.size()
+              << " bytes on disk" << std::endl;
+    std::cout << "  sync save " << saveMs << " ms, async save " << asyncMainThreadMs << " ms on main thread ("
+              << asyncTotalMs << " ms total), load " << loadMs << " ms" << std::endl;
+
+    GameObject* sample = restored.getGameObject("Entity500");
+    bool ok = saved && loaded && snapshots.didLastWriteSucceed() && restored.getGameObjectCount() == objectCount &&
+              sample && sample->getComponent<HealthComponent>()->getHealth() == 49.0f;
+    std::remove(path.c_str());
+    return report("Large world save/load", ok);
+}
+
+int main() {
+    std::cout << "Save Archive Test" << std::endl;
+
+    auto jobs = JobSystem::create(2, 1);
+    bool allCorrect = testArchive();
+    allCorrect = testSubsystems() && allCorrect;
+    allCorrect = testGameSaves() && allCorrect;
+    allCorrect = testLargeWorld(*jobs) && allCorrect;
+    jobs->shutdown();
+
+    std::cout << (allCorrect ? "Save archive test passed!" : "Save archive test FAILED!") << std::endl;
+    return allCorrect ? 0 : 1;
+}
@@ -0,0 +1,209 @@
+#include "../include/Scene.h"
+#include "../include/GameObject.h"
+#include "../include/JobSystem.h"
+#include "../include/SceneSnapshot.h"
+#include "../include/LZCompressor.h"
+#include "../include/HealthComponent.h"
+#include "../include/RigidBodyComponent.h"
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+
+using namespace Sparky;
+
+// Exercises LZ round trips, delta snapshot capture, async writes and
+// restoring a full + delta chain into an empty scene.
+
+static bool testCompressor() {
+    std::mt19937 rng(1234);
+    bool ok = true;
+
+    for (size_t size : {0u, 1u, 12u, 13u, 100u, 4096u, 300000u}) {
+        // Mix of repetitive and random bytes
+        std::vector<char> input(size);
+        for (size_t i = 0; i < size; ++i) {
+            input[i] = (i / 64) % 2 ? static_cast<char>(rng() & 0xFF) : static_cast<char>("snapshot"[i % 8]);
+        }
+
+        std::vector<char> compressed;
+        LZCompressor::compress(input.data(), input.size(), compressed);
+        std::vector<char> output;
+        bool decoded = LZCompressor::decompress(compressed.data(), compressed.size(), input.size(), output);
+        ok = ok && decoded && output == input && compressed.size() <= LZCompressor::maxCompressedSize(size);
+    }
+
+    // Truncated input must be rejected without touching the output
+    std::vector<char> input(10000, 'a');
+    std::vector<char> compressed;
+    LZCompressor::compress(input.data(), input.size(), compressed);
+    std::vector<char> output;
+    compressed.resize(compressed.size() / 2);
+    ok = ok && !LZCompressor::decompress(compressed.data(), compressed.size(), input.size(), output) && output.empty();
+
+    std::cout << "LZ round trips: " << (ok ? "ok" : "FAILED") << std::endl;
+    return ok;
+}
+
+static std::unique_ptr<Scene> buildWorld(size_t objectCount) {
+    auto scene = std::make_unique<Scene>();
+    for (size_t i = 0; i < objectCount; ++i) {
+        auto object = std::make_unique<GameObject>("Entity" + std::to_string(i));
+        object->setPosition(glm::vec3(static_cast<float>(i), 0.0f, static_cast<float>(i % 97)));
+        HealthComponent* health = object->addComponent<HealthComponent>(100.0f + static_cast<float>(i % 10));
+        health->setHealth(50.0f + static_cast<float>(i % 50));
+        RigidBodyComponent* body = object->addComponent<RigidBodyComponent>();
+        body->setLinearVelocity(glm::vec3(0.0f, static_cast<float>(i % 3), 1.0f));
+        body->setFriction(0.25f);
+        scene->addGameObject(std::move(object));
+    }
+    return scene;
+}
+
+static bool sameObject(GameObject& a, GameObject& b) {
+    HealthComponent* healthA = a.getComponent<HealthComponent>();
+    HealthComponent* healthB = b.getComponent<HealthComponent>();
+    RigidBodyComponent* bodyA = a.getComponent<RigidBodyComponent>();
+    RigidBodyComponent* bodyB = b.getComponent<RigidBodyComponent>();
+    return healthA && healthB && bodyA && bodyB &&
+           a.getPosition() == b.getPosition() && a.getRotation() == b.getRotation() && a.getScale() == b.getScale() &&
+           healthA->getHealth() == healthB->getHealth() && healthA->getMaxHealth() == healthB->getMaxHealth() &&
+           bodyA->getLinearVelocity() == bodyB->getLinearVelocity() && bodyA->getFriction() == bodyB->getFriction() &&
+           bodyA->getBodyType() == bodyB->getBodyType();
+}
+
+int main() {
+    std::cout << "Scene Snapshot Test" << std::endl;
+    bool allCorrect = testCompressor();
+
+    auto jobs = JobSystem::create(2, 1);
+    const size_t objectCount = 20000;
+    auto world = buildWorld(objectCount);
+
+    SnapshotManager snapshots;
+    snapshots.setJobSystem(jobs.get());
+
+    const std::string fullPath = "scene_snapshot_test_full.snap";
+    const std::string deltaPath = "scene_snapshot_test_delta.snap";
+
+    // Full save
+    bool saved = snapshots.save(*world, fullPath, SnapshotMode::FULL);
+    SnapshotStats fullStats = snapshots.getStats();
+    std::cout << "Full capture: " << fullStats.objectsSerialized << " objects, " << fullStats.payloadBytes
+              << " bytes, " << fullStats.captureMs << " ms" << std::endl;
+    allCorrect = allCorrect && saved && fullStats.objectsSerialized == objectCount;
+
+    // Change a few objects, remove two and add one
+    for (size_t i = 0; i < 100; ++i) {
+        GameObject* object = world->getGameObject("Entity" + std::to_string(i * 37));
+        object->getComponent<HealthComponent>()->takeDamage(5.0f);
+        if (i % 2 == 0) {
+            object->setPosition(object->getPosition() + glm::vec3(0.0f, 1.0f, 0.0f));
+        }
+    }
+    world->removeGameObject("Entity1");
+    world->removeGameObject("Entity2");
+    auto spawned = std::make_unique<GameObject>("Spawned");
+    spawned->addComponent<HealthComponent>(25.0f);
+    spawned->addComponent<RigidBodyComponent>()->setBodyType(BodyType::KINEMATIC);
+    world->addGameObject(std::move(spawned));
+
+    // Delta save on the I/O thread
+    auto start = std::chrono::high_resolution_clock::now();
+    snapshots.saveAsync(*world, deltaPath, SnapshotMode::DELTA);
+    double mainThreadMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    SnapshotStats deltaStats = snapshots.getStats();
+    snapshots.waitForWrites();
+    std::cout << "Delta capture: " << deltaStats.objectsSerialized << " objects, " << deltaStats.objectsRemoved
+              << " removed, " << deltaStats.captureMs << " ms (main thread " << mainThreadMs << " ms)" << std::endl;
+    allCorrect = allCorrect && snapshots.didLastWriteSucceed() &&
+                 deltaStats.objectsSerialized == 101 && deltaStats.objectsRemoved == 2;
+
+    // Unchanged objects share the blobs of the previous capture
+    auto previous = snapshots.capture(*world, SnapshotMode::FULL);
+    auto shared = snapshots.capture(*world, SnapshotMode::FULL);
+    bool structuralSharing = snapshots.getStats().objectsSerialized == 0 &&
+                             snapshots.getStats().objectsReused == world->getGameObjectCount() &&
+                             previous->objects[10].data == shared->objects[10].data;
+    std::cout << "Structural sharing: " << (structuralSharing ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && structuralSharing;
+
+    // Restore into an empty scene
+    Scene restored;
+    SnapshotManager loader;
+    loader.setJobSystem(jobs.get());
+    bool loaded = loader.load(restored, {fullPath, deltaPath});
+    bool matches = loaded && restored.getGameObjectCount() == world->getGameObjectCount() &&
+                   !restored.getGameObject("Entity1") && !restored.getGameObject("Entity2");
+    for (const auto& object : world->getGameObjects()) {
+        GameObject* copy = restored.getGameObject(object->getName());
+        if (!copy || !sameObject(*object, *copy)) {
+            matches = false;
+            break;
+        }
+    }
+    std::cout << "Full + delta restore: " << (matches ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && matches;
+
+    // Regenerated health marks its object changed, so the next delta carries it
+    Scene healing, healingCopy;
+    HealthComponent* regenerating = nullptr;
+    for (Scene* scene : {&healing, &healingCopy}) {
+        auto patient = std::make_unique<GameObject>("Patient");
+        HealthComponent* health = patient->addComponent<HealthComponent>(100.0f);
+        health->setHealth(50.0f);
+        health->setRegenerationRate(10.0f);
+        scene->addGameObject(std::move(patient));
+        regenerating = regenerating ? regenerating : health;
+    }
+    SnapshotManager healingSnapshots;
+    healingSnapshots.setJobSystem(jobs.get());
+    regenerating->update(0.1f); // The first tick only starts the regeneration clock
+    bool regenerated = healingSnapshots.capture(healing, SnapshotMode::FULL) != nullptr;
+    for (int tick = 0; tick < 3; ++tick) {
+        regenerating->update(0.1f);
+    }
+    auto healed = healingSnapshots.capture(healing, SnapshotMode::DELTA);
+    regenerated = regenerated && regenerating->getHealth() > 50.0f && healed && healed->objects.size() == 1 &&
+                  healed->objects[0].name == "Patient" && healingSnapshots.apply(*healed, healingCopy) &&
+                  healingCopy.getGameObject("Patient")->getComponent<HealthComponent>()->getHealth() == regenerating->getHealth();
+    std::cout << "Regenerated health in delta: " << (regenerated ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && regenerated;
+
+    // Objects are matched by name, so scenes with duplicate names are refused rather than half saved or restored
+    Scene twins;
+    for (int i = 0; i < 2; ++i) {
+        auto twin = std::make_unique<GameObject>("Twin");
+        twin->setPosition(glm::vec3(static_cast<float>(i), 0.0f, 0.0f));
+        twins.addGameObject(std::move(twin));
+    }
+    SnapshotManager twinSnapshots;
+    twinSnapshots.setJobSystem(jobs.get());
+    uint32_t sequence = twinSnapshots.getSequence();
+    bool refusedCapture = !twinSnapshots.capture(twins, SnapshotMode::FULL) &&
+                          !twinSnapshots.save(twins, fullPath + ".twins", SnapshotMode::FULL) &&
+                          twinSnapshots.getSequence() == sequence;
+    twinSnapshots.saveAsync(twins, fullPath + ".twins", SnapshotMode::FULL);
+    twinSnapshots.waitForWrites();
+    refusedCapture = refusedCapture && !twinSnapshots.didLastWriteSucceed();
+    auto single = snapshots.capture(*world, SnapshotMode::FULL);
+    bool refusedApply = !snapshots.apply(*single, twins) && twins.getGameObjectCount() == 2 &&
+                        twins.getGameObjects()[1]->getPosition().x == 1.0f;
+    std::cout << "Duplicate names refused: " << (refusedCapture && refusedApply ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && refusedCapture && refusedApply;
+
+    // A delta on its own is not a valid chain
+    Scene rejected;
+    bool rejectedOrphan = !loader.load(rejected, {deltaPath}) && rejected.getGameObjectCount() == 0;
+    std::cout << "Orphan delta rejected: " << (rejectedOrphan ? "ok" : "FAILED") << std::endl;
+    allCorrect = allCorrect && rejectedOrphan;
+
+    std::remove(fullPath.c_str());
+    std::remove(deltaPath.c_str());
+    jobs->shutdown();
+
+    std::cout << (allCorrect ? "Scene snapshot test passed!" : "Scene snapshot test FAILED!") << std::endl;
+    return allCorrect ? 0 : 1;
+}
@@ -0,0 +1,170 @@
+#include "../include/Scene.h"
+#include "../include/GameObject.h"
+#include "../include/JobSystem.h"
+#include "../include/UpdateScheduler.h"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+
+using namespace Sparky;
+
+// Integrates a simple spring on its owner; touches only owner state
+class SpringComponent : public Component {
+public:
+    SpringComponent() : velocity(0.0f) {}
+
+    void update(float deltaTime) override {
+        glm::vec3 position = owner->getPosition();
+        for (int i = 0; i < 200; ++i) {
+            glm::vec3 force = -position * 4.0f - velocity * 0.5f;
+            velocity += force * (deltaTime / 200.0f);
+            position += velocity * (deltaTime / 200.0f);
+        }
+        owner->setPosition(position);
+    }
+    void render() override {}
+    UpdatePhase getUpdatePhase() const override { return UpdatePhase::PHYSICS; }
+    bool supportsParallelUpdate() const override { return true; }
+
+private:
+    glm::vec3 velocity;
+};
+
+// Writes the owner's rotation from its position after physics
+class FollowComponent : public Component {
+public:
+    void update(float /*deltaTime*/) override {
+        glm::vec3 position = owner->getPosition();
+        owner->setRotation(glm::vec3(position.y, position.x, std::sin(position.z)));
+    }
+    void render() override {}
+    UpdatePhase getUpdatePhase() const override { return UpdatePhase::RENDER_PREP; }
+    bool supportsParallelUpdate() const override { return true; }
+};
+
+// Serial component in the default late phase, counts calls globally
+static int g_lateUpdates = 0;
+class CounterComponent : public Component {
+public:
+    void update(float /*deltaTime*/) override { ++g_lateUpdates; }
+    void render() override {}
+};
+
+// Late-phase component that strips another object's render-prep component
+class DetachComponent : public Component {
+public:
+    explicit DetachComponent(GameObject* target) : target(target) {}
+
+    void update(float /*deltaTime*/) override { target->removeComponent<FollowComponent>(); }
+    void render() override {}
+
+private:
+    GameObject* target;
+};
+
+static std::unique_ptr<Scene> buildScene(size_t objectCount) {
+    auto scene = std::make_unique<Scene>();
+    for (size_t i = 0; i < objectCount; ++i) {
+        auto object = std::make_unique<GameObject>("Object" + std::to_string(i));
+        object->setPosition(glm::vec3(static_cast<float>(i % 17), static_cast<float>(i % 5), static_cast<float>(i % 11)));
+        object->addComponent<SpringComponent>();
+        object->addComponent<FollowComponent>();
+        object->addComponent<CounterComponent>();
+        scene->addGameObject(std::move(object));
+    }
+    scene->setPhysicsEnabled(false);
+    return scene;
+}
+
+int main() {
+    std::cout << "Testing UpdateScheduler..." << std::endl;
+
+    JobSystem& jobSystem = JobSystem::getInstance();
+    jobSystem.initialize();
+    std::cout << "Worker threads: " << jobSystem.getWorkerCount() << std::endl;
+
+    const size_t objectCount = 20000;
+    const int frames = 10;
+    bool passed = true;
+
+    // Test 1: serial and phased updates produce identical results
+    auto serialScene = buildScene(objectCount);
+    auto parallelScene = buildScene(objectCount);
+    parallelScene->setParallelUpdateEnabled(true);
+
+    auto serialStart = std::chrono::high_resolution_clock::now();
+    for (int frame = 0; frame < frames; ++frame) {
+        serialScene->update(0.016f);
+    }
+    auto serialEnd = std::chrono::high_resolution_clock::now();
+
+    g_lateUpdates = 0;
+    auto parallelStart = std::chrono::high_resolution_clock::now();
+    for (int frame = 0; frame < frames; ++frame) {
+        parallelScene->update(0.016f);
+    }
+    auto parallelEnd = std::chrono::high_resolution_clock::now();
+
+    const auto& serialObjects = serialScene->getGameObjects();
+    const auto& parallelObjects = parallelScene->getGameObjects();
+    for (size_t i = 0; i < objectCount; ++i) {
+        if (serialObjects[i]->getPosition() != parallelObjects[i]->getPosition() ||
+            serialObjects[i]->getRotation() != parallelObjects[i]->getRotation()) {
+            std::cout << "Mismatch at object " << i << std::endl;
+            passed = false;
+            break;
+        }
+    }
+    std::cout << "Deterministic results: " << (passed ? "yes" : "no") << std::endl;
+
+    // Test 2: late-phase components still run exactly once per object per frame
+    if (g_lateUpdates != static_cast<int>(objectCount) * frames) {
+        std::cout << "Late update count wrong: " << g_lateUpdates << std::endl;
+        passed = false;
+    }
+
+    // Test 3: wave schedule and stats
+    const UpdateScheduler& scheduler = parallelScene->getUpdateScheduler();
+    std::cout << "Waves:" << std::endl;
+    for (const auto& wave : scheduler.getWaves()) {
+        std::cout << " ";
+        for (UpdatePhase phase : wave) {
+            std::cout << " " << scheduler.getPhaseDesc(phase).name;
+        }
+        std::cout << std::endl;
+    }
+    const UpdateSchedulerStats& stats = scheduler.getStats();
+    std::cout << "Parallel components: " << stats.parallelComponents
+              << ", batches: " << stats.batchCount << std::endl;
+    if (stats.parallelComponents != objectCount * 2) {
+        passed = false;
+    }
+
+    // Test 4: components removed during late update are not updated by render prep
+    Scene detachScene;
+    detachScene.setPhysicsEnabled(false);
+    detachScene.setParallelUpdateEnabled(true);
+    auto detached = std::make_unique<GameObject>("Detached");
+    detached->setPosition(glm::vec3(1.0f, 2.0f, 3.0f));
+    detached->addComponent<FollowComponent>();
+    auto detacher = std::make_unique<GameObject>("Detacher");
+    detacher->addComponent<DetachComponent>(detached.get());
+    GameObject* detachedObject = detached.get();
+    detachScene.addGameObject(std::move(detacher));
+    detachScene.addGameObject(std::move(detached));
+    detachScene.update(0.016f);
+    bool detachedSkipped = !detachedObject->getComponent<FollowComponent>() &&
+                           detachedObject->getRotation() == glm::vec3(0.0f);
+    std::cout << "Removed components skipped: " << (detachedSkipped ? "yes" : "no") << std::endl;
+    passed = passed && detachedSkipped;
+
+    double serialMs = std::chrono::duration<double, std::milli>(serialEnd - serialStart).count();
+    double parallelMs = std::chrono::duration<double, std::milli>(parallelEnd - parallelStart).count();
+    std::cout << "Serial: " << serialMs / frames << " ms/frame, phased: " << parallelMs / frames << " ms/frame" << std::endl;
+
+    jobSystem.shutdown();
+
+    std::cout << (passed ? "UpdateScheduler test passed!" : "UpdateScheduler test FAILED!") << std::endl;
+    return passed ? 0 : 1;
+}